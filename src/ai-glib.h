@@ -26,13 +26,31 @@
 #include "core/ai-config.h"
 #include "core/ai-provider.h"
 #include "core/ai-streamable.h"
+#include "core/ai-delta-buffer.h"
+#include "core/ai-stream.h"
 #include "core/ai-image-generator.h"
+#include "core/ai-retry.h"
+#include "core/ai-deadline.h"
+#include "core/ai-session-pool.h"
+#include "core/ai-rate-limiter.h"
+#include "core/ai-balancer.h"
+#include "core/ai-response-cache.h"
+#include "core/ai-json-writer.h"
+#include "core/ai-json-scanner.h"
+#include "core/ai-stream-reader.h"
+#include "core/ai-batch-runner.h"
+#include "core/ai-batch-job.h"
+#include "core/ai-hedged-provider.h"
+#include "core/ai-failover-provider.h"
+#include "core/ai-dispatcher.h"
 #include "core/ai-client.h"
 #include "core/ai-cli-client.h"
 #include "core/ai-prompt-scorer.h"
 
 /* Model classes */
 #include "model/ai-usage.h"
+#include "model/ai-timing.h"
+#include "model/ai-request-options.h"
 #include "model/ai-content-block.h"
 #include "model/ai-text-content.h"
 #include "model/ai-tool.h"
@@ -61,5 +79,6 @@
 #include "convenience/ai-bing-search.h"
 #include "convenience/ai-brave-search.h"
 #include "convenience/ai-tool-executor.h"
+#include "convenience/ai-router-provider.h"
 
 #undef AI_GLIB_INSIDE
@@ -15,6 +15,8 @@
 #include "convenience/ai-bing-search.h"
 #include "convenience/ai-search-provider.h"
 #include "core/ai-error.h"
+#include "core/ai-config.h"
+#include "core/ai-session-pool.h"
 
 #define BING_SEARCH_ENDPOINT "https://api.bing.microsoft.com/v7.0/search"
 #define BING_RESULT_COUNT    10
@@ -23,7 +25,7 @@ struct _AiBingSearch
 {
     GObject       parent_instance;
     gchar        *api_key;    /* owned */
-    SoupSession  *session;    /* owned */
+    SoupSession  *session;    /* owned, shared via the session pool */
 };
 
 static void ai_bing_search_iface_init (AiSearchProviderInterface *iface);
@@ -167,7 +169,10 @@ static void
 ai_bing_search_init (AiBingSearch *self)
 {
     self->api_key = NULL;
-    self->session = soup_session_new ();
+    self->session = ai_session_pool_get_session (
+        BING_SEARCH_ENDPOINT,
+        ai_config_get_timeout (ai_config_get_default ()),
+        ai_config_get_max_connections (ai_config_get_default ()));
 }
 
 AiBingSearch *
@@ -15,6 +15,8 @@
 #include "convenience/ai-brave-search.h"
 #include "convenience/ai-search-provider.h"
 #include "core/ai-error.h"
+#include "core/ai-config.h"
+#include "core/ai-session-pool.h"
 
 #define BRAVE_SEARCH_ENDPOINT "https://api.search.brave.com/res/v1/web/search"
 #define BRAVE_RESULT_COUNT    10
@@ -23,7 +25,7 @@ struct _AiBraveSearch
 {
     GObject       parent_instance;
     gchar        *api_key;    /* owned */
-    SoupSession  *session;    /* owned */
+    SoupSession  *session;    /* owned, shared via the session pool */
 };
 
 static void ai_brave_search_iface_init (AiSearchProviderInterface *iface);
@@ -169,7 +171,10 @@ static void
 ai_brave_search_init (AiBraveSearch *self)
 {
     self->api_key = NULL;
-    self->session = soup_session_new ();
+    self->session = ai_session_pool_get_session (
+        BRAVE_SEARCH_ENDPOINT,
+        ai_config_get_timeout (ai_config_get_default ()),
+        ai_config_get_max_connections (ai_config_get_default ()));
 }
 
 AiBraveSearch *
@@ -0,0 +1,888 @@
+/*
+ * ai-router-provider.c - Route requests to a model by prompt complexity
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "ai-glib.h"
+
+#include "convenience/ai-router-provider.h"
+#include "core/ai-client.h"
+#include "core/ai-cli-client.h"
+#include "core/ai-error.h"
+#include "model/ai-message.h"
+#include "providers/ai-claude-client.h"
+#include "providers/ai-openai-client.h"
+#include "providers/ai-gemini-client.h"
+#include "providers/ai-grok-client.h"
+#include "providers/ai-ollama-client.h"
+#include "providers/ai-claude-code-client.h"
+#include "providers/ai-opencode-client.h"
+
+#define N_TIERS (AI_PROMPT_TIER_REASONING + 1)
+
+struct _AiRouterProvider
+{
+    GObject parent_instance;
+
+    GMutex          lock;
+    AiProvider     *routes[N_TIERS];
+    gint            max_tokens[N_TIERS];
+    AiScorerConfig *scorer_config;      /* nullable, for the defaults */
+    GHashTable     *forwards;           /* AiProvider -> Forwards */
+};
+
+static void ai_router_provider_provider_init(AiProviderInterface *iface);
+static void ai_router_provider_streamable_init(AiStreamableInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(AiRouterProvider, ai_router_provider, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(AI_TYPE_PROVIDER,
+                                              ai_router_provider_provider_init)
+                        G_IMPLEMENT_INTERFACE(AI_TYPE_STREAMABLE,
+                                              ai_router_provider_streamable_init))
+
+/* Streaming signals forwarded from the routed provider */
+enum
+{
+    FORWARD_DELTA,
+    FORWARD_STREAM_START,
+    FORWARD_STREAM_END,
+    FORWARD_TOOL_USE,
+    FORWARD_TOOL_INPUT_DELTA,
+    N_FORWARDS
+};
+
+/*
+ * The handlers forwarding the signals of a provider that streams of the
+ * router run on. They are connected for the first of those streams and
+ * disconnected after the last, so concurrent streams on one provider
+ * share them and each event is re-emitted once.
+ */
+typedef struct
+{
+    gulong handlers[N_FORWARDS];
+    guint  n_streams;
+} Forwards;
+
+static void
+forwards_free(Forwards *forwards)
+{
+    g_slice_free(Forwards, forwards);
+}
+
+static void
+ai_router_provider_dispose(GObject *object)
+{
+    AiRouterProvider *self = AI_ROUTER_PROVIDER(object);
+    guint i;
+
+    for (i = 0; i < N_TIERS; i++)
+    {
+        g_clear_object(&self->routes[i]);
+    }
+
+    G_OBJECT_CLASS(ai_router_provider_parent_class)->dispose(object);
+}
+
+static void
+ai_router_provider_finalize(GObject *object)
+{
+    AiRouterProvider *self = AI_ROUTER_PROVIDER(object);
+
+    g_clear_pointer(&self->scorer_config, ai_scorer_config_free);
+    g_hash_table_unref(self->forwards);
+    g_mutex_clear(&self->lock);
+
+    G_OBJECT_CLASS(ai_router_provider_parent_class)->finalize(object);
+}
+
+static void
+ai_router_provider_class_init(AiRouterProviderClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->dispose = ai_router_provider_dispose;
+    object_class->finalize = ai_router_provider_finalize;
+}
+
+static void
+ai_router_provider_init(AiRouterProvider *self)
+{
+    g_mutex_init(&self->lock);
+    self->forwards = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                           (GDestroyNotify)forwards_free);
+}
+
+/**
+ * ai_router_provider_new:
+ *
+ * Creates a router without routes.
+ *
+ * Returns: (transfer full): a new #AiRouterProvider
+ */
+AiRouterProvider *
+ai_router_provider_new(void)
+{
+    return g_object_new(AI_TYPE_ROUTER_PROVIDER, NULL);
+}
+
+/*
+ * Creates the client of a configured route, as ai_simple_new() does for
+ * its default provider.
+ */
+static AiProvider *
+create_client(
+    AiConfig       *config,
+    AiProviderType  provider_type,
+    const gchar    *model
+){
+    GObject *client;
+
+    switch (provider_type)
+    {
+    case AI_PROVIDER_CLAUDE:
+        client = G_OBJECT(ai_claude_client_new_with_config(config));
+        break;
+    case AI_PROVIDER_OPENAI:
+        client = G_OBJECT(ai_openai_client_new_with_config(config));
+        break;
+    case AI_PROVIDER_GEMINI:
+        client = G_OBJECT(ai_gemini_client_new_with_config(config));
+        break;
+    case AI_PROVIDER_GROK:
+        client = G_OBJECT(ai_grok_client_new_with_config(config));
+        break;
+    case AI_PROVIDER_CLAUDE_CODE:
+        client = G_OBJECT(ai_claude_code_client_new_with_config(config));
+        break;
+    case AI_PROVIDER_OPENCODE:
+        client = G_OBJECT(ai_opencode_client_new_with_config(config));
+        break;
+    case AI_PROVIDER_OLLAMA:
+    default:
+        client = G_OBJECT(ai_ollama_client_new_with_config(config));
+        break;
+    }
+
+    if (model != NULL)
+    {
+        if (AI_IS_CLIENT(client))
+            ai_client_set_model(AI_CLIENT(client), model);
+        else
+            ai_cli_client_set_model(AI_CLI_CLIENT(client), model);
+    }
+
+    return AI_PROVIDER(client);
+}
+
+/**
+ * ai_router_provider_new_from_config:
+ * @config: (nullable): an #AiConfig, or %NULL for the default config
+ *
+ * Creates a router with a client for each route in @config.
+ *
+ * Returns: (transfer full): a new #AiRouterProvider
+ */
+AiRouterProvider *
+ai_router_provider_new_from_config(AiConfig *config)
+{
+    g_autoptr(GHashTable) clients = NULL;
+    AiRouterProvider *self;
+    AiProviderType provider_type;
+    const gchar *model;
+    gint max_tokens;
+    guint i;
+
+    g_return_val_if_fail(config == NULL || AI_IS_CONFIG(config), NULL);
+
+    if (config == NULL)
+    {
+        config = ai_config_get_default();
+    }
+
+    self = ai_router_provider_new();
+    clients = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_object_unref);
+
+    for (i = 0; i < N_TIERS; i++)
+    {
+        g_autofree gchar *key = NULL;
+        AiProvider *client;
+
+        if (!ai_config_get_route(config, (AiPromptTier)i, &provider_type, &model, &max_tokens))
+        {
+            continue;
+        }
+
+        /* Tiers sharing a provider and model share the client */
+        key = g_strdup_printf("%d/%s", provider_type, model != NULL ? model : "");
+        client = g_hash_table_lookup(clients, key);
+        if (client == NULL)
+        {
+            client = create_client(config, provider_type, model);
+            g_hash_table_insert(clients, g_steal_pointer(&key), client);
+        }
+
+        ai_router_provider_set_route(self, (AiPromptTier)i, client, max_tokens);
+    }
+
+    return self;
+}
+
+/**
+ * ai_router_provider_set_route:
+ * @self: an #AiRouterProvider
+ * @tier: the #AiPromptTier
+ * @provider: (nullable): the #AiProvider for @tier, or %NULL
+ * @max_tokens: the token limit for requests of @tier that set none,
+ *   or 0 for none
+ *
+ * Sets the provider requests of @tier go to.
+ */
+void
+ai_router_provider_set_route(
+    AiRouterProvider *self,
+    AiPromptTier      tier,
+    AiProvider       *provider,
+    gint              max_tokens
+){
+    g_return_if_fail(AI_IS_ROUTER_PROVIDER(self));
+    g_return_if_fail((guint)tier < N_TIERS);
+    g_return_if_fail(provider == NULL || AI_IS_PROVIDER(provider));
+    g_return_if_fail((gpointer)provider != (gpointer)self);
+    g_return_if_fail(max_tokens >= 0);
+
+    g_mutex_lock(&self->lock);
+    g_set_object(&self->routes[tier], provider);
+    self->max_tokens[tier] = max_tokens;
+    g_mutex_unlock(&self->lock);
+}
+
+/**
+ * ai_router_provider_get_route:
+ * @self: an #AiRouterProvider
+ * @tier: the #AiPromptTier
+ * @max_tokens: (out) (optional): return location for the token limit
+ *
+ * Gets the provider configured for @tier.
+ *
+ * Returns: (transfer none) (nullable): the #AiProvider
+ */
+AiProvider *
+ai_router_provider_get_route(
+    AiRouterProvider *self,
+    AiPromptTier      tier,
+    gint             *max_tokens
+){
+    AiProvider *provider;
+
+    g_return_val_if_fail(AI_IS_ROUTER_PROVIDER(self), NULL);
+    g_return_val_if_fail((guint)tier < N_TIERS, NULL);
+
+    g_mutex_lock(&self->lock);
+    provider = self->routes[tier];
+    if (max_tokens != NULL)
+    {
+        *max_tokens = self->max_tokens[tier];
+    }
+    g_mutex_unlock(&self->lock);
+
+    return provider;
+}
+
+/**
+ * ai_router_provider_set_scorer_config:
+ * @self: an #AiRouterProvider
+ * @config: (nullable): the #AiScorerConfig, or %NULL for the defaults
+ *
+ * Sets the scorer configuration used to classify requests.
+ */
+void
+ai_router_provider_set_scorer_config(
+    AiRouterProvider     *self,
+    const AiScorerConfig *config
+){
+    AiScorerConfig *copy;
+
+    g_return_if_fail(AI_IS_ROUTER_PROVIDER(self));
+
+    copy = config != NULL ? ai_scorer_config_copy(config) : NULL;
+
+    g_mutex_lock(&self->lock);
+    g_clear_pointer(&self->scorer_config, ai_scorer_config_free);
+    self->scorer_config = copy;
+    g_mutex_unlock(&self->lock);
+}
+
+/*
+ * The nearest tier with a route: @tier itself, else the next higher
+ * one, else the next lower one. Called with the lock held.
+ */
+static AiPromptTier
+resolve_tier(
+    AiRouterProvider *self,
+    AiPromptTier      tier
+){
+    gint t;
+
+    for (t = tier; t < N_TIERS; t++)
+    {
+        if (self->routes[t] != NULL)
+        {
+            return (AiPromptTier)t;
+        }
+    }
+
+    for (t = (gint)tier - 1; t >= 0; t--)
+    {
+        if (self->routes[t] != NULL)
+        {
+            return (AiPromptTier)t;
+        }
+    }
+
+    return tier;
+}
+
+/**
+ * ai_router_provider_select_tier:
+ * @self: an #AiRouterProvider
+ * @messages: (element-type AiMessage): the conversation messages
+ * @system_prompt: (nullable): the system prompt
+ * @result: (out) (optional) (transfer full): return location for the
+ *   scoring result
+ *
+ * Picks the tier a request is routed to.
+ *
+ * Returns: the #AiPromptTier whose route is used
+ */
+AiPromptTier
+ai_router_provider_select_tier(
+    AiRouterProvider  *self,
+    GList             *messages,
+    const gchar       *system_prompt,
+    AiScoringResult  **result
+){
+    g_autoptr(AiScoringResult) scoring = NULL;
+    g_autofree gchar *prompt = NULL;
+    g_autofree gchar *debug = NULL;
+    AiPromptTier tier;
+    GList *l;
+
+    g_return_val_if_fail(AI_IS_ROUTER_PROVIDER(self), AI_PROMPT_TIER_MODERATE);
+
+    /* Earlier turns were already answered; the newest question decides */
+    for (l = g_list_last(messages); l != NULL && prompt == NULL; l = l->prev)
+    {
+        if (ai_message_get_role(l->data) == AI_ROLE_USER)
+        {
+            prompt = ai_message_get_text(l->data);
+        }
+    }
+
+    g_mutex_lock(&self->lock);
+
+    scoring = ai_prompt_scorer_classify(prompt != NULL ? prompt : "", system_prompt,
+                                        self->scorer_config);
+    tier = ai_scoring_result_get_tier(scoring);
+
+    /* When unsure, err towards the more capable model */
+    if (ai_scoring_result_get_tier_is_ambiguous(scoring) && tier < AI_PROMPT_TIER_REASONING)
+    {
+        tier = (AiPromptTier)(tier + 1);
+    }
+
+    tier = resolve_tier(self, tier);
+
+    g_mutex_unlock(&self->lock);
+
+    debug = ai_scoring_result_format_debug(scoring);
+    g_debug("Routing to tier %s: %s", ai_prompt_tier_to_string(tier), debug);
+
+    if (result != NULL)
+    {
+        *result = g_steal_pointer(&scoring);
+    }
+
+    return tier;
+}
+
+/*
+ * Look up the provider for a request and apply the tier's max_tokens to
+ * @options, unless the caller set one. Returns a new reference, or %NULL
+ * with @error set if no tier has a route.
+ */
+static AiProvider *
+route_request(
+    AiRouterProvider  *self,
+    GList             *messages,
+    AiRequestOptions  *options,
+    GError           **error
+){
+    AiProvider *provider = NULL;
+    AiPromptTier tier;
+
+    tier = ai_router_provider_select_tier(self, messages,
+                                          ai_request_options_get_system_prompt(options),
+                                          NULL);
+
+    g_mutex_lock(&self->lock);
+    if (self->routes[tier] != NULL)
+    {
+        provider = g_object_ref(self->routes[tier]);
+        if (self->max_tokens[tier] > 0 && ai_request_options_get_max_tokens(options) <= 0)
+        {
+            ai_request_options_set_max_tokens(options, self->max_tokens[tier]);
+        }
+    }
+    g_mutex_unlock(&self->lock);
+
+    if (provider == NULL)
+    {
+        g_set_error(error, AI_ERROR, AI_ERROR_CONFIGURATION_ERROR,
+                    "No route is configured for any prompt tier");
+    }
+
+    return provider;
+}
+
+/*
+ * The provider behind the interface getters: the one a request of
+ * moderate complexity would go to.
+ */
+static AiProvider *
+get_default_route(AiRouterProvider *self)
+{
+    AiProvider *provider;
+
+    g_mutex_lock(&self->lock);
+    provider = self->routes[resolve_tier(self, AI_PROMPT_TIER_MODERATE)];
+    g_mutex_unlock(&self->lock);
+
+    return provider;
+}
+
+static AiProviderType
+ai_router_provider_get_provider_type(AiProvider *provider)
+{
+    AiProvider *route = get_default_route(AI_ROUTER_PROVIDER(provider));
+
+    return route != NULL ? ai_provider_get_provider_type(route) : AI_PROVIDER_CLAUDE;
+}
+
+static const gchar *
+ai_router_provider_get_name(AiProvider *provider)
+{
+    AiProvider *route = get_default_route(AI_ROUTER_PROVIDER(provider));
+
+    return route != NULL ? ai_provider_get_name(route) : "Router";
+}
+
+static const gchar *
+ai_router_provider_get_default_model(AiProvider *provider)
+{
+    AiProvider *route = get_default_route(AI_ROUTER_PROVIDER(provider));
+
+    return route != NULL ? ai_provider_get_default_model(route) : NULL;
+}
+
+static void
+on_chat_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    GError *error = NULL;
+    AiResponse *response;
+
+    response = ai_provider_chat_finish(AI_PROVIDER(source), result, &error);
+    if (response == NULL)
+    {
+        g_task_return_error(task, error);
+    }
+    else
+    {
+        g_task_return_pointer(task, response, g_object_unref);
+    }
+    g_object_unref(task);
+}
+
+static void
+ai_router_provider_chat_with_options_async(
+    AiProvider             *provider,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
+){
+    AiRouterProvider *self = AI_ROUTER_PROVIDER(provider);
+    g_autoptr(AiRequestOptions) routed = NULL;
+    g_autoptr(AiProvider) route = NULL;
+    GError *error = NULL;
+    GTask *task;
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_router_provider_chat_with_options_async);
+
+    routed = options != NULL ? ai_request_options_copy(options) : ai_request_options_new();
+    route = route_request(self, messages, routed, &error);
+    if (route == NULL)
+    {
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    ai_provider_chat_with_options_async(route, messages, routed, cancellable,
+                                        on_chat_done, task);
+}
+
+static void
+ai_router_provider_chat_async(
+    AiProvider          *provider,
+    GList               *messages,
+    const gchar         *system_prompt,
+    gint                 max_tokens,
+    GList               *tools,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    ai_router_provider_chat_with_options_async(provider, messages, options,
+                                               cancellable, callback, user_data);
+}
+
+static AiResponse *
+ai_router_provider_chat_finish(
+    AiProvider    *provider,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(g_task_is_valid(result, provider), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+on_list_models_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    GError *error = NULL;
+    GList *models;
+
+    models = ai_provider_list_models_finish(AI_PROVIDER(source), result, &error);
+    if (error != NULL)
+    {
+        g_task_return_error(task, error);
+    }
+    else
+    {
+        g_task_return_pointer(task, models, NULL);
+    }
+    g_object_unref(task);
+}
+
+static void
+ai_router_provider_list_models_async(
+    AiProvider          *provider,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    AiRouterProvider *self = AI_ROUTER_PROVIDER(provider);
+    AiProvider *route;
+    GTask *task;
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_router_provider_list_models_async);
+
+    route = get_default_route(self);
+    if (route == NULL)
+    {
+        g_task_return_new_error(task, AI_ERROR, AI_ERROR_CONFIGURATION_ERROR,
+                                "No route is configured for any prompt tier");
+        g_object_unref(task);
+        return;
+    }
+
+    ai_provider_list_models_async(route, cancellable, on_list_models_done, task);
+}
+
+static GList *
+ai_router_provider_list_models_finish(
+    AiProvider    *provider,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(g_task_is_valid(result, provider), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+on_route_delta(
+    AiStreamable *route,
+    const gchar  *text,
+    gpointer      user_data
+){
+    (void)route;
+
+    ai_streamable_emit_delta(user_data, text);
+}
+
+static void
+on_route_stream_start(
+    AiStreamable *route,
+    gpointer      user_data
+){
+    (void)route;
+
+    ai_streamable_emit_stream_start(user_data);
+}
+
+static void
+on_route_stream_end(
+    AiStreamable *route,
+    GObject      *response,
+    gpointer      user_data
+){
+    (void)route;
+
+    ai_streamable_emit_stream_end(user_data, AI_RESPONSE(response));
+}
+
+static void
+on_route_tool_use(
+    AiStreamable *route,
+    GObject      *tool_use,
+    gpointer      user_data
+){
+    (void)route;
+
+    ai_streamable_emit_tool_use(user_data, AI_TOOL_USE(tool_use));
+}
+
+static void
+on_route_tool_input_delta(
+    AiStreamable *route,
+    const gchar  *tool_id,
+    const gchar  *partial_json,
+    gpointer      user_data
+){
+    (void)route;
+
+    ai_streamable_emit_tool_input_delta(user_data, tool_id, partial_json);
+}
+
+static void
+hold_forwards(
+    AiRouterProvider *self,
+    AiProvider       *route
+){
+    Forwards *forwards;
+
+    g_mutex_lock(&self->lock);
+
+    forwards = g_hash_table_lookup(self->forwards, route);
+    if (forwards == NULL)
+    {
+        forwards = g_slice_new0(Forwards);
+        forwards->handlers[FORWARD_DELTA] =
+            g_signal_connect(route, "delta", G_CALLBACK(on_route_delta), self);
+        forwards->handlers[FORWARD_STREAM_START] =
+            g_signal_connect(route, "stream-start", G_CALLBACK(on_route_stream_start), self);
+        forwards->handlers[FORWARD_STREAM_END] =
+            g_signal_connect(route, "stream-end", G_CALLBACK(on_route_stream_end), self);
+        forwards->handlers[FORWARD_TOOL_USE] =
+            g_signal_connect(route, "tool-use", G_CALLBACK(on_route_tool_use), self);
+        forwards->handlers[FORWARD_TOOL_INPUT_DELTA] =
+            g_signal_connect(route, "tool-input-delta",
+                             G_CALLBACK(on_route_tool_input_delta), self);
+        g_hash_table_insert(self->forwards, route, forwards);
+    }
+    forwards->n_streams++;
+
+    g_mutex_unlock(&self->lock);
+}
+
+static void
+release_forwards(
+    AiRouterProvider *self,
+    AiProvider       *route
+){
+    Forwards *forwards;
+    guint i;
+
+    g_mutex_lock(&self->lock);
+
+    forwards = g_hash_table_lookup(self->forwards, route);
+    if (--forwards->n_streams == 0)
+    {
+        for (i = 0; i < N_FORWARDS; i++)
+        {
+            g_clear_signal_handler(&forwards->handlers[i], route);
+        }
+        g_hash_table_remove(self->forwards, route);
+    }
+
+    g_mutex_unlock(&self->lock);
+}
+
+/*
+ * The provider a streaming request was routed to, whose forwards it
+ * holds.
+ */
+typedef struct
+{
+    AiRouterProvider *router;
+    AiProvider       *provider;
+} StreamData;
+
+static void
+stream_data_free(StreamData *data)
+{
+    release_forwards(data->router, data->provider);
+    g_object_unref(data->provider);
+    g_object_unref(data->router);
+    g_slice_free(StreamData, data);
+}
+
+static void
+on_chat_stream_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    GError *error = NULL;
+    AiResponse *response;
+
+    response = ai_streamable_chat_stream_finish(AI_STREAMABLE(source), result, &error);
+
+    /* Stop forwarding before the caller hears the stream is over */
+    g_task_set_task_data(task, NULL, NULL);
+
+    if (response == NULL)
+    {
+        g_task_return_error(task, error);
+    }
+    else
+    {
+        g_task_return_pointer(task, response, g_object_unref);
+    }
+    g_object_unref(task);
+}
+
+static void
+ai_router_provider_chat_stream_with_options_async(
+    AiStreamable           *streamable,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
+){
+    AiRouterProvider *self = AI_ROUTER_PROVIDER(streamable);
+    g_autoptr(AiRequestOptions) routed = NULL;
+    StreamData *data;
+    AiProvider *route;
+    GError *error = NULL;
+    GTask *task;
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_router_provider_chat_stream_with_options_async);
+
+    routed = options != NULL ? ai_request_options_copy(options) : ai_request_options_new();
+    route = route_request(self, messages, routed, &error);
+    if (route == NULL)
+    {
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    if (!AI_IS_STREAMABLE(route))
+    {
+        g_task_return_new_error(task, AI_ERROR, AI_ERROR_NOT_SUPPORTED,
+                                "Provider %s does not support streaming",
+                                ai_provider_get_name(route));
+        g_object_unref(route);
+        g_object_unref(task);
+        return;
+    }
+
+    hold_forwards(self, route);
+    data = g_slice_new0(StreamData);
+    data->router = g_object_ref(self);
+    data->provider = route;
+    g_task_set_task_data(task, data, (GDestroyNotify)stream_data_free);
+
+    ai_streamable_chat_stream_with_options_async(AI_STREAMABLE(route), messages, routed,
+                                                 cancellable, on_chat_stream_done, task);
+}
+
+static void
+ai_router_provider_chat_stream_async(
+    AiStreamable        *streamable,
+    GList               *messages,
+    const gchar         *system_prompt,
+    gint                 max_tokens,
+    GList               *tools,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    ai_router_provider_chat_stream_with_options_async(streamable, messages, options,
+                                                      cancellable, callback, user_data);
+}
+
+static AiResponse *
+ai_router_provider_chat_stream_finish(
+    AiStreamable  *streamable,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(g_task_is_valid(result, streamable), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+ai_router_provider_provider_init(AiProviderInterface *iface)
+{
+    iface->get_provider_type = ai_router_provider_get_provider_type;
+    iface->get_name = ai_router_provider_get_name;
+    iface->get_default_model = ai_router_provider_get_default_model;
+    iface->chat_async = ai_router_provider_chat_async;
+    iface->chat_with_options_async = ai_router_provider_chat_with_options_async;
+    iface->chat_finish = ai_router_provider_chat_finish;
+    iface->list_models_async = ai_router_provider_list_models_async;
+    iface->list_models_finish = ai_router_provider_list_models_finish;
+}
+
+static void
+ai_router_provider_streamable_init(AiStreamableInterface *iface)
+{
+    iface->chat_stream_async = ai_router_provider_chat_stream_async;
+    iface->chat_stream_with_options_async = ai_router_provider_chat_stream_with_options_async;
+    iface->chat_stream_finish = ai_router_provider_chat_stream_finish;
+}
@@ -0,0 +1,143 @@
+/*
+ * ai-router-provider.h - Route requests to a model by prompt complexity
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * AiRouterProvider classifies each request with ai_prompt_scorer_classify()
+ * and sends it to the provider configured for the resulting tier, so
+ * trivial prompts go to a small fast model and hard ones to a large one.
+ * Routes come from the `routing` section of config.yaml or are set in
+ * code.
+ *
+ * Quick start:
+ *   g_autoptr(AiRouterProvider) router = ai_router_provider_new_from_config(NULL);
+ *
+ *   ai_provider_chat_async(AI_PROVIDER(router), messages, NULL, 1024, NULL,
+ *                          NULL, on_chat_done, NULL);
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include "core/ai-config.h"
+#include "core/ai-prompt-scorer.h"
+#include "core/ai-provider.h"
+#include "core/ai-streamable.h"
+
+G_BEGIN_DECLS
+
+#define AI_TYPE_ROUTER_PROVIDER (ai_router_provider_get_type())
+
+G_DECLARE_FINAL_TYPE(AiRouterProvider, ai_router_provider, AI, ROUTER_PROVIDER, GObject)
+
+/**
+ * ai_router_provider_new:
+ *
+ * Creates a router without routes. Add them with
+ * ai_router_provider_set_route().
+ *
+ * Returns: (transfer full): a new #AiRouterProvider
+ */
+AiRouterProvider *
+ai_router_provider_new(void);
+
+/**
+ * ai_router_provider_new_from_config:
+ * @config: (nullable): an #AiConfig, or %NULL for the default config
+ *
+ * Creates a router with a client for each route in @config (see
+ * ai_config_get_route()). Routes with the same provider and model
+ * share one client.
+ *
+ * Returns: (transfer full): a new #AiRouterProvider
+ */
+AiRouterProvider *
+ai_router_provider_new_from_config(AiConfig *config);
+
+/**
+ * ai_router_provider_set_route:
+ * @self: an #AiRouterProvider
+ * @tier: the #AiPromptTier
+ * @provider: (nullable): the #AiProvider for @tier, or %NULL to remove
+ *   the route
+ * @max_tokens: the token limit for requests of @tier that set none,
+ *   or 0 for none
+ *
+ * Sets the provider requests of @tier go to. The model is the one
+ * @provider is configured with.
+ */
+void
+ai_router_provider_set_route(
+    AiRouterProvider *self,
+    AiPromptTier      tier,
+    AiProvider       *provider,
+    gint              max_tokens
+);
+
+/**
+ * ai_router_provider_get_route:
+ * @self: an #AiRouterProvider
+ * @tier: the #AiPromptTier
+ * @max_tokens: (out) (optional): return location for the token limit
+ *
+ * Gets the provider configured for @tier.
+ *
+ * Returns: (transfer none) (nullable): the #AiProvider, or %NULL if
+ *   @tier has no route
+ */
+AiProvider *
+ai_router_provider_get_route(
+    AiRouterProvider *self,
+    AiPromptTier      tier,
+    gint             *max_tokens
+);
+
+/**
+ * ai_router_provider_set_scorer_config:
+ * @self: an #AiRouterProvider
+ * @config: (nullable): the #AiScorerConfig, or %NULL for the defaults
+ *
+ * Sets the scorer configuration used to classify requests. Its
+ * confidence threshold decides which classifications are ambiguous.
+ */
+void
+ai_router_provider_set_scorer_config(
+    AiRouterProvider     *self,
+    const AiScorerConfig *config
+);
+
+/**
+ * ai_router_provider_select_tier:
+ * @self: an #AiRouterProvider
+ * @messages: (element-type AiMessage): the conversation messages
+ * @system_prompt: (nullable): the system prompt
+ * @result: (out) (optional) (transfer full): return location for the
+ *   scoring result
+ *
+ * Picks the tier a request is routed to. The last user message and
+ * the system prompt are classified. The scorer reports an ambiguous
+ * classification as moderate; the router moves it one tier further up,
+ * so uncertain prompts get the more capable model. A tier without a
+ * route falls back to the next higher one that has a route, or else
+ * the next lower one.
+ *
+ * Returns: the #AiPromptTier whose route is used
+ */
+AiPromptTier
+ai_router_provider_select_tier(
+    AiRouterProvider  *self,
+    GList             *messages,
+    const gchar       *system_prompt,
+    AiScoringResult  **result
+);
+
+G_END_DECLS
@@ -122,7 +122,8 @@ ai_simple_create_provider(
  *
  * Internal helper that dispatches chat_sync to the correct base class
  * depending on whether the provider is an AiClient or AiCliClient.
- * Also sets the system prompt on the underlying provider before calling.
+ * An AiClient gets the system prompt with the request; an AiCliClient
+ * has it set on the provider before calling.
  *
  * Returns: (transfer full) (nullable): the #AiResponse
  */
@@ -133,13 +134,13 @@ ai_simple_do_chat_sync(
     GCancellable  *cancellable,
     GError       **error
 ){
-    /* Set system prompt on the underlying provider */
     if (AI_IS_CLIENT(self->provider))
     {
-        ai_client_set_system_prompt(
-            AI_CLIENT(self->provider), self->system_prompt);
-        return ai_client_chat_sync(
-            AI_CLIENT(self->provider), messages, cancellable, error);
+        g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+        ai_request_options_set_system_prompt(options, self->system_prompt);
+        return ai_client_chat_sync_with_options(
+            AI_CLIENT(self->provider), messages, options, cancellable, error);
     }
     else if (AI_IS_CLI_CLIENT(self->provider))
     {
@@ -9,20 +9,22 @@
 
 #include "ai-glib.h"
 
-#include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
-#include <sys/wait.h>
 #include <libsoup/soup.h>
 #include <json-glib/json-glib.h>
 
 #include "convenience/ai-tool-executor.h"
 #include "convenience/ai-search-provider.h"
 #include "core/ai-error.h"
+#include "core/ai-config.h"
+#include "core/ai-deadline.h"
+#include "core/ai-session-pool.h"
 #include "core/ai-enums.h"
 #include "core/ai-provider.h"
 #include "model/ai-content-block.h"
 #include "model/ai-message.h"
+#include "model/ai-request-options.h"
 #include "model/ai-response.h"
 #include "model/ai-tool.h"
 #include "model/ai-tool-use.h"
@@ -40,6 +42,7 @@ struct _AiToolExecutor
     GObject           parent_instance;
     GList            *tools;           /* GList<AiTool>, owned */
     AiSearchProvider *search_provider; /* nullable, ref'd */
+    SoupSession      *web_session;     /* nullable, pooled, for web_fetch */
 };
 
 G_DEFINE_TYPE(AiToolExecutor, ai_tool_executor, G_TYPE_OBJECT)
@@ -50,21 +53,49 @@ G_DEFINE_TYPE(AiToolExecutor, ai_tool_executor, G_TYPE_OBJECT)
 
 typedef struct
 {
-    GMainLoop      *loop;
-    AiToolExecutor *executor;
-    AiProvider     *provider;
-    GList          *messages;      /* owned, grows during loop */
-    const gchar    *system_prompt;
-    gint            max_tokens;
-    GCancellable   *cancellable;
-    gint            turn_count;
-    gchar          *result;        /* final text (transfer full to caller) */
-    GError         *error;         /* propagated to caller */
+    GMainLoop        *loop;
+    AiToolExecutor   *executor;
+    AiProvider       *provider;
+    GList            *messages;      /* owned, grows during loop */
+    AiRequestOptions *options;       /* owned, with the executor's tools */
+    AiDeadline       *deadline;      /* owned, bounds the whole run */
+    GCancellable     *cancellable;   /* the deadline's */
+    gint              turn_count;
+    gchar            *result;        /* final text (transfer full to caller) */
+    GError           *error;         /* propagated to caller */
 } RunContext;
 
 /* Forward declaration */
 static void run_context_send (RunContext *ctx);
 
+/*
+ * Append the model's turn to the conversation. tool_use blocks are kept
+ * along with the text so the provider can match them with our
+ * tool_result messages on the next turn.
+ */
+static void
+run_context_append_response (
+    RunContext *ctx,
+    AiResponse *response
+){
+    AiMessage *assistant_msg = ai_message_new (AI_ROLE_ASSISTANT);
+    GList     *iter;
+
+    for (iter = ai_response_get_content_blocks (response);
+         iter != NULL;
+         iter = iter->next)
+    {
+        AiContentBlock *block = iter->data;
+
+        ai_message_add_content_block (
+            assistant_msg,
+            (AiContentBlock *)g_object_ref (block)
+        );
+    }
+
+    ctx->messages = g_list_append (ctx->messages, assistant_msg);
+}
+
 static void
 on_run_response (
     GObject      *source,
@@ -80,6 +111,7 @@ on_run_response (
 
     if (err != NULL)
     {
+        ai_deadline_translate_error (ctx->deadline, &err);
         ctx->error = g_steal_pointer (&err);
         g_main_loop_quit (ctx->loop);
         return;
@@ -91,6 +123,7 @@ on_run_response (
     {
         /* Final answer — grab text and quit */
         ctx->result = ai_response_get_text (response);
+        run_context_append_response (ctx, response);
         g_main_loop_quit (ctx->loop);
         return;
     }
@@ -105,28 +138,7 @@ on_run_response (
         return;
     }
 
-    /*
-     * Reconstruct the assistant message from the response content blocks.
-     * We must include tool_use blocks (not just text) so the provider
-     * can match them with our tool_result messages on the next turn.
-     */
-    {
-        AiMessage *assistant_msg = ai_message_new (AI_ROLE_ASSISTANT);
-
-        for (iter = ai_response_get_content_blocks (response);
-             iter != NULL;
-             iter = iter->next)
-        {
-            AiContentBlock *block = iter->data;
-
-            ai_message_add_content_block (
-                assistant_msg,
-                (AiContentBlock *)g_object_ref (block)
-            );
-        }
-
-        ctx->messages = g_list_append (ctx->messages, assistant_msg);
-    }
+    run_context_append_response (ctx, response);
 
     /* Execute each tool use and append result messages */
     {
@@ -167,12 +179,18 @@ on_run_response (
 static void
 run_context_send (RunContext *ctx)
 {
-    ai_provider_chat_async (
+    /* Tools may have used up the time; do not start another turn */
+    if (!ai_deadline_check (ctx->deadline, &ctx->error))
+    {
+        g_prefix_error (&ctx->error, "After %d turns: ", ctx->turn_count);
+        g_main_loop_quit (ctx->loop);
+        return;
+    }
+
+    ai_provider_chat_with_options_async (
         ctx->provider,
         ctx->messages,
-        ctx->system_prompt,
-        ctx->max_tokens,
-        ctx->executor->tools,
+        ctx->options,
         ctx->cancellable,
         on_run_response,
         ctx
@@ -190,15 +208,15 @@ tool_bash (
     GCancellable    *cancellable,
     GError         **error
 ){
-    const gchar *command;
-    FILE        *fp;
-    GString     *output;
-    gchar        buf[4096];
-    int          exit_status;
-    gchar       *result;
+    const gchar            *command;
+    g_autoptr(GSubprocess)  proc   = NULL;
+    g_autoptr(GBytes)       output = NULL;
+    g_autoptr(GError)       local_error = NULL;
+    const gchar            *data;
+    gsize                   size;
+    gchar                  *result;
 
     (void)self;
-    (void)cancellable;
 
     command = ai_tool_use_get_input_string (tool_use, "command");
     if (command == NULL)
@@ -208,32 +226,31 @@ tool_bash (
         return NULL;
     }
 
+    proc = g_subprocess_new (G_SUBPROCESS_FLAGS_STDOUT_PIPE |
+                             G_SUBPROCESS_FLAGS_STDERR_MERGE,
+                             &local_error, "/bin/sh", "-c", command, NULL);
+    if (proc == NULL)
     {
-        g_autofree gchar *cmd_merged = g_strdup_printf ("%s 2>&1", command);
-        fp = popen (cmd_merged, "r");
+        g_set_error (error, AI_ERROR, AI_ERROR_TOOL_ERROR,
+                     "bash: failed to start shell: %s", local_error->message);
+        return NULL;
     }
 
-    if (fp == NULL)
+    /* A cancelled run, or one past its deadline, kills the command */
+    if (!g_subprocess_communicate (proc, NULL, cancellable, &output, NULL, error))
     {
-        g_set_error_literal (error, AI_ERROR, AI_ERROR_TOOL_ERROR,
-                             "bash: popen() failed");
+        g_subprocess_force_exit (proc);
         return NULL;
     }
 
-    output = g_string_new (NULL);
-    while (fgets (buf, (int)sizeof (buf), fp) != NULL)
-        g_string_append (output, buf);
-
-    exit_status = pclose (fp);
-
-    result = g_string_free (output, FALSE);
+    data   = output != NULL ? g_bytes_get_data (output, &size) : NULL;
+    result = data != NULL ? g_strndup (data, size) : g_strdup ("");
 
     /* Prefix with exit code on failure */
-    if (exit_status != 0 && exit_status != -1 && WIFEXITED (exit_status)
-        && WEXITSTATUS (exit_status) != 0)
+    if (g_subprocess_get_if_exited (proc) && g_subprocess_get_exit_status (proc) != 0)
     {
         gchar *prefixed = g_strdup_printf ("[exit code %d]\n%s",
-                                           WEXITSTATUS (exit_status), result);
+                                           g_subprocess_get_exit_status (proc), result);
         g_free (result);
         result = prefixed;
     }
@@ -614,15 +631,12 @@ tool_web_fetch (
     GError         **error
 ){
     const gchar           *url;
-    g_autoptr(SoupSession)  session = NULL;
     g_autoptr(SoupMessage)  msg     = NULL;
     g_autoptr(GBytes)       bytes   = NULL;
     guint        status_code;
     const gchar *data;
     gsize        size;
 
-    (void)self;
-
     url = ai_tool_use_get_input_string (tool_use, "url");
     if (url == NULL)
     {
@@ -631,8 +645,16 @@ tool_web_fetch (
         return NULL;
     }
 
-    session = soup_session_new ();
-    msg     = soup_message_new ("GET", url);
+    /* Held for the executor's lifetime so keep-alive spans turns */
+    if (self->web_session == NULL)
+    {
+        self->web_session = ai_session_pool_get_session (
+            NULL,
+            ai_config_get_timeout (ai_config_get_default ()),
+            ai_config_get_max_connections (ai_config_get_default ()));
+    }
+
+    msg = soup_message_new ("GET", url);
 
     if (msg == NULL)
     {
@@ -641,7 +663,7 @@ tool_web_fetch (
         return NULL;
     }
 
-    bytes = soup_session_send_and_read (session, msg, cancellable, error);
+    bytes = soup_session_send_and_read (self->web_session, msg, cancellable, error);
     if (bytes == NULL)
         return NULL;
 
@@ -728,6 +750,7 @@ ai_tool_executor_finalize (GObject *object)
     g_list_free_full (self->tools, g_object_unref);
     self->tools = NULL;
     g_clear_object (&self->search_provider);
+    g_clear_object (&self->web_session);
 
     G_OBJECT_CLASS (ai_tool_executor_parent_class)->finalize (object);
 }
@@ -745,6 +768,7 @@ ai_tool_executor_init (AiToolExecutor *self)
 {
     self->tools           = NULL;
     self->search_provider = NULL;
+    self->web_session     = NULL;
 }
 
 /* ================================================================
@@ -922,6 +946,26 @@ ai_tool_executor_run (
     gint             max_tokens,
     GCancellable    *cancellable,
     GError         **error
+){
+    g_autoptr(AiRequestOptions) options = NULL;
+
+    options = ai_request_options_new ();
+    ai_request_options_set_system_prompt (options, system_prompt);
+    ai_request_options_set_max_tokens (options, MAX (max_tokens, 0));
+
+    return ai_tool_executor_run_with_options (self, provider, messages, options,
+                                              NULL, cancellable, error);
+}
+
+gchar *
+ai_tool_executor_run_with_options (
+    AiToolExecutor          *self,
+    AiProvider              *provider,
+    GList                   *messages,
+    const AiRequestOptions  *options,
+    GList                  **transcript,
+    GCancellable            *cancellable,
+    GError                 **error
 ){
     RunContext  ctx;
     GList      *iter;
@@ -931,30 +975,43 @@ ai_tool_executor_run (
     g_return_val_if_fail (AI_IS_PROVIDER (provider), NULL);
     g_return_val_if_fail (messages != NULL, NULL);
 
-    ctx.loop          = g_main_loop_new (NULL, FALSE);
-    ctx.executor      = self;
-    ctx.provider      = provider;
-    ctx.messages      = NULL;
-    ctx.system_prompt = system_prompt;
-    ctx.max_tokens    = (max_tokens > 0) ? max_tokens : DEFAULT_MAX_TOKENS;
-    ctx.cancellable   = cancellable;
-    ctx.turn_count    = 0;
-    ctx.result        = NULL;
-    ctx.error         = NULL;
+    ctx.loop        = g_main_loop_new (NULL, FALSE);
+    ctx.executor    = self;
+    ctx.provider    = provider;
+    ctx.messages    = NULL;
+    ctx.options     = options != NULL ? ai_request_options_copy (options)
+                                      : ai_request_options_new ();
+    ctx.deadline    = ai_deadline_new (ai_request_options_get_deadline (ctx.options),
+                                       cancellable);
+    ctx.cancellable = ai_deadline_get_cancellable (ctx.deadline);
+    ctx.turn_count  = 0;
+    ctx.result      = NULL;
+    ctx.error       = NULL;
+
+    if (ai_request_options_get_max_tokens (ctx.options) == 0)
+        ai_request_options_set_max_tokens (ctx.options, DEFAULT_MAX_TOKENS);
+    ai_request_options_set_tools (ctx.options, self->tools);
 
     /* Shallow-copy the caller's messages so we can extend the list */
     for (iter = messages; iter != NULL; iter = iter->next)
         ctx.messages = g_list_append (ctx.messages, g_object_ref (iter->data));
 
     run_context_send (&ctx);
-    g_main_loop_run (ctx.loop);
+    if (ctx.error == NULL)
+        g_main_loop_run (ctx.loop);
     g_main_loop_unref (ctx.loop);
 
-    /* Free our message list (caller keeps ownership of their originals) */
+    ai_deadline_free (ctx.deadline);
+    ai_request_options_free (ctx.options);
+
+    /* The conversation so far is the partial result of a failed run */
+    if (transcript != NULL)
+        *transcript = g_steal_pointer (&ctx.messages);
     g_list_free_full (ctx.messages, g_object_unref);
 
     if (ctx.error != NULL)
     {
+        g_free (ctx.result);
         g_propagate_error (error, ctx.error);
         return NULL;
     }
@@ -35,6 +35,7 @@
 #include <gio/gio.h>
 
 #include "core/ai-provider.h"
+#include "model/ai-request-options.h"
 #include "model/ai-tool-use.h"
 #include "convenience/ai-search-provider.h"
 
@@ -142,4 +143,40 @@ ai_tool_executor_run (
     GError         **error
 );
 
+/**
+ * ai_tool_executor_run_with_options:
+ * @self: an #AiToolExecutor
+ * @provider: the #AiProvider to send requests to
+ * @messages: (element-type AiMessage): initial conversation messages
+ * @options: (nullable): the #AiRequestOptions for every turn
+ * @transcript: (out) (optional) (element-type AiMessage) (transfer full):
+ *   return location for the conversation, including the tool turns
+ * @cancellable: (nullable): a #GCancellable
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Like ai_tool_executor_run(), with the settings taken from @options.
+ * Its tools are replaced by the executor's, and a max-tokens of 0 means
+ * 4096.
+ *
+ * A deadline in @options bounds the whole run, not each turn: it stops
+ * the request in flight or the tool being executed, such as a bash
+ * command, and no turn is started after it. The run then fails with
+ * %AI_ERROR_TIMEOUT, and @transcript holds the turns completed so far.
+ * @transcript is set on success and on error; free it with
+ * g_list_free_full() and g_object_unref().
+ *
+ * Returns: (transfer full) (nullable): the final response text, or %NULL on
+ *   error. Free with g_free().
+ */
+gchar *
+ai_tool_executor_run_with_options (
+    AiToolExecutor          *self,
+    AiProvider              *provider,
+    GList                   *messages,
+    const AiRequestOptions  *options,
+    GList                  **transcript,
+    GCancellable            *cancellable,
+    GError                 **error
+);
+
 G_END_DECLS
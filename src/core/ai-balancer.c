@@ -0,0 +1,365 @@
+/*
+ * ai-balancer.c - Load balancing over API keys and endpoints
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include "core/ai-balancer.h"
+
+/* Weight of a new sample in the moving averages */
+#define LATENCY_ALPHA  0.3
+#define THROTTLE_ALPHA 0.3
+
+/* A fully throttled endpoint costs this many times more */
+#define THROTTLE_WEIGHT 4.0
+
+/* After a 429, an endpoint is only used if all others are as well */
+#define THROTTLE_COOLDOWN (2 * G_USEC_PER_SEC)
+#define COOLDOWN_PENALTY  1000.0
+
+typedef struct
+{
+    gchar   *api_key;
+    gchar   *base_url;
+    guint    in_flight;
+    gdouble  latency;           /* EWMA in microseconds, 0 before a sample */
+    gdouble  throttled;         /* EWMA of responses that were 429 */
+    gint64   throttled_until;
+} Endpoint;
+
+struct _AiBalancer
+{
+    GObject parent_instance;
+
+    GMutex    lock;
+    GArray   *endpoints;        /* element-type Endpoint */
+    guint     next;             /* where the search for an endpoint starts */
+};
+
+G_DEFINE_TYPE(AiBalancer, ai_balancer, G_TYPE_OBJECT)
+
+static void
+endpoint_clear(Endpoint *endpoint)
+{
+    g_free(endpoint->api_key);
+    g_free(endpoint->base_url);
+}
+
+static void
+ai_balancer_finalize(GObject *object)
+{
+    AiBalancer *self = AI_BALANCER(object);
+
+    g_array_unref(self->endpoints);
+    g_mutex_clear(&self->lock);
+
+    G_OBJECT_CLASS(ai_balancer_parent_class)->finalize(object);
+}
+
+static void
+ai_balancer_class_init(AiBalancerClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->finalize = ai_balancer_finalize;
+}
+
+static void
+ai_balancer_init(AiBalancer *self)
+{
+    g_mutex_init(&self->lock);
+    self->endpoints = g_array_new(FALSE, TRUE, sizeof(Endpoint));
+    g_array_set_clear_func(self->endpoints, (GDestroyNotify)endpoint_clear);
+}
+
+/**
+ * ai_balancer_new:
+ * @api_keys: (nullable) (array zero-terminated=1): the API keys
+ * @base_urls: (array zero-terminated=1): the base URLs
+ *
+ * Creates a balancer over every pair of a key and a URL.
+ *
+ * Returns: (transfer full): a new #AiBalancer
+ */
+AiBalancer *
+ai_balancer_new(
+    const gchar *const *api_keys,
+    const gchar *const *base_urls
+){
+    AiBalancer *self;
+    guint n_keys;
+    guint i;
+    guint j;
+
+    g_return_val_if_fail(base_urls != NULL && base_urls[0] != NULL, NULL);
+
+    n_keys = api_keys != NULL ? g_strv_length((gchar **)api_keys) : 0;
+    self = g_object_new(AI_TYPE_BALANCER, NULL);
+
+    /* Without keys there is still one endpoint per URL */
+    for (i = 0; i < MAX(n_keys, 1); i++)
+    {
+        for (j = 0; base_urls[j] != NULL; j++)
+        {
+            Endpoint endpoint = { 0 };
+
+            endpoint.api_key = g_strdup(n_keys > 0 ? api_keys[i] : NULL);
+            endpoint.base_url = g_strdup(base_urls[j]);
+            g_array_append_val(self->endpoints, endpoint);
+        }
+    }
+
+    return self;
+}
+
+/**
+ * ai_balancer_get_n_endpoints:
+ * @self: an #AiBalancer
+ *
+ * Gets the number of endpoints.
+ *
+ * Returns: the number of endpoints
+ */
+guint
+ai_balancer_get_n_endpoints(AiBalancer *self)
+{
+    g_return_val_if_fail(AI_IS_BALANCER(self), 0);
+
+    return self->endpoints->len;
+}
+
+/**
+ * ai_balancer_get_api_key:
+ * @self: an #AiBalancer
+ * @index: the endpoint
+ *
+ * Gets the API key of an endpoint.
+ *
+ * Returns: (transfer none) (nullable): the API key
+ */
+const gchar *
+ai_balancer_get_api_key(
+    AiBalancer *self,
+    guint       index
+){
+    g_return_val_if_fail(AI_IS_BALANCER(self), NULL);
+    g_return_val_if_fail(index < self->endpoints->len, NULL);
+
+    /* Endpoints never change after construction, so no lock */
+    return g_array_index(self->endpoints, Endpoint, index).api_key;
+}
+
+/**
+ * ai_balancer_get_base_url:
+ * @self: an #AiBalancer
+ * @index: the endpoint
+ *
+ * Gets the base URL of an endpoint.
+ *
+ * Returns: (transfer none): the base URL
+ */
+const gchar *
+ai_balancer_get_base_url(
+    AiBalancer *self,
+    guint       index
+){
+    g_return_val_if_fail(AI_IS_BALANCER(self), NULL);
+    g_return_val_if_fail(index < self->endpoints->len, NULL);
+
+    return g_array_index(self->endpoints, Endpoint, index).base_url;
+}
+
+/*
+ * The expected cost of sending one more request to @endpoint, in
+ * microseconds of queueing. Called with the lock held.
+ */
+static gdouble
+endpoint_cost(
+    const Endpoint *endpoint,
+    gdouble         default_latency,
+    gint64          now
+){
+    gdouble latency = endpoint->latency > 0 ? endpoint->latency : default_latency;
+    gdouble cost;
+
+    cost = (endpoint->in_flight + 1) * latency * (1.0 + THROTTLE_WEIGHT * endpoint->throttled);
+
+    if (now < endpoint->throttled_until)
+    {
+        cost *= COOLDOWN_PENALTY;
+    }
+
+    return cost;
+}
+
+/**
+ * ai_balancer_acquire:
+ * @self: an #AiBalancer
+ *
+ * Picks the endpoint for a request and counts the request as in
+ * flight there.
+ *
+ * Returns: the endpoint
+ */
+guint
+ai_balancer_acquire(AiBalancer *self)
+{
+    gint64 now = g_get_monotonic_time();
+    gdouble default_latency = 0;
+    gdouble best_cost = G_MAXDOUBLE;
+    guint n_sampled = 0;
+    guint best = 0;
+    guint n;
+    guint i;
+
+    g_return_val_if_fail(AI_IS_BALANCER(self), 0);
+
+    g_mutex_lock(&self->lock);
+
+    n = self->endpoints->len;
+
+    for (i = 0; i < n; i++)
+    {
+        Endpoint *endpoint = &g_array_index(self->endpoints, Endpoint, i);
+
+        if (endpoint->latency > 0)
+        {
+            default_latency += endpoint->latency;
+            n_sampled++;
+        }
+    }
+
+    /* Without any sample, fall back to least outstanding requests */
+    default_latency = n_sampled > 0 ? default_latency / n_sampled : 1.0;
+
+    for (i = 0; i < n; i++)
+    {
+        guint index = (self->next + i) % n;
+        gdouble cost = endpoint_cost(&g_array_index(self->endpoints, Endpoint, index),
+                                     default_latency, now);
+
+        if (cost < best_cost)
+        {
+            best = index;
+            best_cost = cost;
+        }
+    }
+
+    self->next = (self->next + 1) % n;
+    g_array_index(self->endpoints, Endpoint, best).in_flight++;
+
+    g_mutex_unlock(&self->lock);
+
+    return best;
+}
+
+/**
+ * ai_balancer_release:
+ * @self: an #AiBalancer
+ * @index: the endpoint returned by ai_balancer_acquire()
+ * @status: the HTTP status, or 0 if there was no response
+ * @latency: the request's latency in microseconds, or 0
+ *
+ * Ends a request and learns from its outcome.
+ */
+void
+ai_balancer_release(
+    AiBalancer *self,
+    guint       index,
+    guint       status,
+    gint64      latency
+){
+    Endpoint *endpoint;
+
+    g_return_if_fail(AI_IS_BALANCER(self));
+    g_return_if_fail(index < self->endpoints->len);
+
+    g_mutex_lock(&self->lock);
+
+    endpoint = &g_array_index(self->endpoints, Endpoint, index);
+
+    if (endpoint->in_flight > 0)
+    {
+        endpoint->in_flight--;
+    }
+
+    if (status != 0)
+    {
+        endpoint->throttled += ((status == 429 ? 1.0 : 0.0) - endpoint->throttled) * THROTTLE_ALPHA;
+    }
+
+    if (status == 429)
+    {
+        endpoint->throttled_until = g_get_monotonic_time() + THROTTLE_COOLDOWN;
+    }
+    else if (status >= 200 && status < 300 && latency > 0)
+    {
+        if (endpoint->latency > 0)
+        {
+            endpoint->latency += (latency - endpoint->latency) * LATENCY_ALPHA;
+        }
+        else
+        {
+            endpoint->latency = latency;
+        }
+    }
+
+    g_mutex_unlock(&self->lock);
+}
+
+/**
+ * ai_balancer_get_n_in_flight:
+ * @self: an #AiBalancer
+ * @index: the endpoint
+ *
+ * Gets the number of requests in flight at an endpoint.
+ *
+ * Returns: the number of requests
+ */
+guint
+ai_balancer_get_n_in_flight(
+    AiBalancer *self,
+    guint       index
+){
+    guint in_flight;
+
+    g_return_val_if_fail(AI_IS_BALANCER(self), 0);
+    g_return_val_if_fail(index < self->endpoints->len, 0);
+
+    g_mutex_lock(&self->lock);
+    in_flight = g_array_index(self->endpoints, Endpoint, index).in_flight;
+    g_mutex_unlock(&self->lock);
+
+    return in_flight;
+}
+
+/**
+ * ai_balancer_get_latency:
+ * @self: an #AiBalancer
+ * @index: the endpoint
+ *
+ * Gets the moving average of an endpoint's latency.
+ *
+ * Returns: the latency in microseconds, or 0 before the first sample
+ */
+gint64
+ai_balancer_get_latency(
+    AiBalancer *self,
+    guint       index
+){
+    gdouble latency;
+
+    g_return_val_if_fail(AI_IS_BALANCER(self), 0);
+    g_return_val_if_fail(index < self->endpoints->len, 0);
+
+    g_mutex_lock(&self->lock);
+    latency = g_array_index(self->endpoints, Endpoint, index).latency;
+    g_mutex_unlock(&self->lock);
+
+    return (gint64)latency;
+}
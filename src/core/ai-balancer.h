@@ -0,0 +1,158 @@
+/*
+ * ai-balancer.h - Load balancing over API keys and endpoints
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * An AiBalancer spreads the requests of one client over a pool of
+ * endpoints, each a pair of an API key and a base URL. Every request
+ * goes to the endpoint with the lowest expected wait: its requests in
+ * flight, plus the new one, times the moving average (EWMA) of its
+ * latency. Endpoints that recently answered 429 are weighted down, and
+ * avoided altogether for a short while after each 429.
+ *
+ * AiClient builds a balancer from the api_keys and base_urls pools of
+ * its #AiConfig; see ai_config_set_api_keys().
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define AI_TYPE_BALANCER (ai_balancer_get_type())
+
+G_DECLARE_FINAL_TYPE(AiBalancer, ai_balancer, AI, BALANCER, GObject)
+
+/**
+ * ai_balancer_new:
+ * @api_keys: (nullable) (array zero-terminated=1): the API keys, or
+ *   %NULL for requests without a key
+ * @base_urls: (array zero-terminated=1): the base URLs, at least one
+ *
+ * Creates a balancer over every pair of a key in @api_keys and a URL
+ * in @base_urls. Endpoints are numbered key by key, so with keys A and
+ * B and URLs X and Y they are A-X, A-Y, B-X, B-Y.
+ *
+ * Returns: (transfer full): a new #AiBalancer
+ */
+AiBalancer *
+ai_balancer_new(
+    const gchar *const *api_keys,
+    const gchar *const *base_urls
+);
+
+/**
+ * ai_balancer_get_n_endpoints:
+ * @self: an #AiBalancer
+ *
+ * Gets the number of endpoints.
+ *
+ * Returns: the number of endpoints
+ */
+guint
+ai_balancer_get_n_endpoints(AiBalancer *self);
+
+/**
+ * ai_balancer_get_api_key:
+ * @self: an #AiBalancer
+ * @index: the endpoint
+ *
+ * Gets the API key of an endpoint.
+ *
+ * Returns: (transfer none) (nullable): the API key
+ */
+const gchar *
+ai_balancer_get_api_key(
+    AiBalancer *self,
+    guint       index
+);
+
+/**
+ * ai_balancer_get_base_url:
+ * @self: an #AiBalancer
+ * @index: the endpoint
+ *
+ * Gets the base URL of an endpoint.
+ *
+ * Returns: (transfer none): the base URL
+ */
+const gchar *
+ai_balancer_get_base_url(
+    AiBalancer *self,
+    guint       index
+);
+
+/**
+ * ai_balancer_acquire:
+ * @self: an #AiBalancer
+ *
+ * Picks the endpoint for a request and counts the request as in flight
+ * there. Endpoints without a latency sample yet are assumed to be as
+ * fast as the average of the others, so new endpoints get traffic.
+ * Ties go round-robin.
+ *
+ * Every call must be matched by ai_balancer_release().
+ *
+ * Returns: the endpoint
+ */
+guint
+ai_balancer_acquire(AiBalancer *self);
+
+/**
+ * ai_balancer_release:
+ * @self: an #AiBalancer
+ * @index: the endpoint returned by ai_balancer_acquire()
+ * @status: the HTTP status of the response, or 0 if there was none
+ * @latency: how long the request took, in microseconds, or 0 if it was
+ *   not sent
+ *
+ * Ends a request. A successful response adds @latency to the
+ * endpoint's average; a 429 marks the endpoint as throttled.
+ */
+void
+ai_balancer_release(
+    AiBalancer *self,
+    guint       index,
+    guint       status,
+    gint64      latency
+);
+
+/**
+ * ai_balancer_get_n_in_flight:
+ * @self: an #AiBalancer
+ * @index: the endpoint
+ *
+ * Gets the number of requests in flight at an endpoint.
+ *
+ * Returns: the number of requests
+ */
+guint
+ai_balancer_get_n_in_flight(
+    AiBalancer *self,
+    guint       index
+);
+
+/**
+ * ai_balancer_get_latency:
+ * @self: an #AiBalancer
+ * @index: the endpoint
+ *
+ * Gets the moving average of an endpoint's latency.
+ *
+ * Returns: the latency in microseconds, or 0 before the first sample
+ */
+gint64
+ai_balancer_get_latency(
+    AiBalancer *self,
+    guint       index
+);
+
+G_END_DECLS
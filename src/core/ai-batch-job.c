@@ -0,0 +1,1674 @@
+/*
+ * ai-batch-job.c - Provider batch API jobs
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "core/ai-batch-job.h"
+#include "core/ai-error.h"
+#include "core/ai-json-writer.h"
+
+#define CLAUDE_BATCHES_ENDPOINT "/v1/messages/batches"
+#define OPENAI_FILES_ENDPOINT "/v1/files"
+#define OPENAI_BATCHES_ENDPOINT "/v1/batches"
+#define OPENAI_BATCH_REQUEST_URL "/v1/chat/completions"
+
+static const GEnumValue batch_status_values[] = {
+    { AI_BATCH_STATUS_NEW,         "AI_BATCH_STATUS_NEW",         "new" },
+    { AI_BATCH_STATUS_IN_PROGRESS, "AI_BATCH_STATUS_IN_PROGRESS", "in-progress" },
+    { AI_BATCH_STATUS_CANCELING,   "AI_BATCH_STATUS_CANCELING",   "canceling" },
+    { AI_BATCH_STATUS_ENDED,       "AI_BATCH_STATUS_ENDED",       "ended" },
+    { AI_BATCH_STATUS_FAILED,      "AI_BATCH_STATUS_FAILED",      "failed" },
+    { 0, NULL, NULL }
+};
+
+GType
+ai_batch_status_get_type(void)
+{
+    static GType type = 0;
+
+    if (g_once_init_enter(&type))
+    {
+        GType t = g_enum_register_static("AiBatchStatus", batch_status_values);
+        g_once_init_leave(&type, t);
+    }
+
+    return type;
+}
+
+/*
+ * One request in the batch and its outcome.
+ */
+typedef struct
+{
+    gchar      *custom_id;
+    JsonNode   *params;         /* from the client's build_request */
+
+    AiResponse *response;
+    GError     *error;
+} BatchItem;
+
+struct _AiBatchJob
+{
+    GObject parent_instance;
+
+    AiClient      *client;
+    gchar         *base_url;
+    guint          poll_interval;
+    guint          max_poll_interval;
+
+    GPtrArray     *items;           /* element-type BatchItem */
+    GHashTable    *items_by_id;     /* custom_id -> index + 1 */
+
+    /* Provider-side state, from the last status response */
+    gchar         *id;
+    AiBatchStatus  status;
+    gchar         *failure;
+    gchar         *results_url;     /* Claude */
+    gchar         *output_file_id;  /* OpenAI */
+    gchar         *error_file_id;   /* OpenAI */
+};
+
+G_DEFINE_TYPE(AiBatchJob, ai_batch_job, G_TYPE_OBJECT)
+
+enum
+{
+    PROP_0,
+    PROP_CLIENT,
+    PROP_BASE_URL,
+    PROP_ID,
+    PROP_STATUS,
+    N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
+enum
+{
+    SIGNAL_REQUEST_FINISHED,
+    N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
+/*
+ * State of a wait: the current poll delay, and the result files still
+ * to download once the batch has ended.
+ */
+typedef struct
+{
+    guint      delay_ms;
+    GPtrArray *result_urls;     /* element-type utf8 */
+    guint      next_url;
+} WaitData;
+
+static void
+batch_item_free(BatchItem *item)
+{
+    g_free(item->custom_id);
+    g_clear_pointer(&item->params, json_node_unref);
+    g_clear_object(&item->response);
+    g_clear_error(&item->error);
+    g_slice_free(BatchItem, item);
+}
+
+static void
+wait_data_free(WaitData *data)
+{
+    g_clear_pointer(&data->result_urls, g_ptr_array_unref);
+    g_slice_free(WaitData, data);
+}
+
+static void
+ai_batch_job_finalize(GObject *object)
+{
+    AiBatchJob *self = AI_BATCH_JOB(object);
+
+    g_clear_object(&self->client);
+    g_clear_pointer(&self->base_url, g_free);
+    g_clear_pointer(&self->items, g_ptr_array_unref);
+    g_clear_pointer(&self->items_by_id, g_hash_table_unref);
+    g_clear_pointer(&self->id, g_free);
+    g_clear_pointer(&self->failure, g_free);
+    g_clear_pointer(&self->results_url, g_free);
+    g_clear_pointer(&self->output_file_id, g_free);
+    g_clear_pointer(&self->error_file_id, g_free);
+
+    G_OBJECT_CLASS(ai_batch_job_parent_class)->finalize(object);
+}
+
+static void
+ai_batch_job_get_property(
+    GObject    *object,
+    guint       prop_id,
+    GValue     *value,
+    GParamSpec *pspec
+){
+    AiBatchJob *self = AI_BATCH_JOB(object);
+
+    switch (prop_id)
+    {
+        case PROP_CLIENT:
+            g_value_set_object(value, self->client);
+            break;
+        case PROP_BASE_URL:
+            g_value_set_string(value, self->base_url);
+            break;
+        case PROP_ID:
+            g_value_set_string(value, self->id);
+            break;
+        case PROP_STATUS:
+            g_value_set_enum(value, self->status);
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+static void
+ai_batch_job_set_property(
+    GObject      *object,
+    guint         prop_id,
+    const GValue *value,
+    GParamSpec   *pspec
+){
+    AiBatchJob *self = AI_BATCH_JOB(object);
+
+    switch (prop_id)
+    {
+        case PROP_CLIENT:
+            g_clear_object(&self->client);
+            self->client = g_value_dup_object(value);
+            break;
+        case PROP_BASE_URL:
+            ai_batch_job_set_base_url(self, g_value_get_string(value));
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+static void
+ai_batch_job_class_init(AiBatchJobClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->finalize = ai_batch_job_finalize;
+    object_class->get_property = ai_batch_job_get_property;
+    object_class->set_property = ai_batch_job_set_property;
+
+    /**
+     * AiBatchJob:client:
+     *
+     * The client requests are serialized and results parsed with.
+     */
+    properties[PROP_CLIENT] =
+        g_param_spec_object("client",
+                            "Client",
+                            "The client requests are serialized and results parsed with",
+                            AI_TYPE_CLIENT,
+                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+                            G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiBatchJob:base-url:
+     *
+     * Overrides the base URL of the batch endpoints.
+     */
+    properties[PROP_BASE_URL] =
+        g_param_spec_string("base-url",
+                            "Base URL",
+                            "Overrides the base URL of the batch endpoints",
+                            NULL,
+                            G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                            G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiBatchJob:id:
+     *
+     * The provider's ID for the batch, once submitted.
+     */
+    properties[PROP_ID] =
+        g_param_spec_string("id",
+                            "ID",
+                            "The provider's ID for the batch",
+                            NULL,
+                            G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiBatchJob:status:
+     *
+     * The batch status as of the last request to the provider.
+     */
+    properties[PROP_STATUS] =
+        g_param_spec_enum("status",
+                          "Status",
+                          "The batch status",
+                          AI_TYPE_BATCH_STATUS,
+                          AI_BATCH_STATUS_NEW,
+                          G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
+    g_object_class_install_properties(object_class, N_PROPS, properties);
+
+    /**
+     * AiBatchJob::request-finished:
+     * @self: the #AiBatchJob
+     * @index: the index of the request
+     *
+     * Emitted while results are downloaded, for each request whose
+     * result is available from ai_batch_job_get_response() or
+     * ai_batch_job_get_error(). Results arrive in any order.
+     */
+    signals[SIGNAL_REQUEST_FINISHED] =
+        g_signal_new("request-finished",
+                     G_TYPE_FROM_CLASS(klass),
+                     G_SIGNAL_RUN_LAST,
+                     0,
+                     NULL, NULL,
+                     NULL,
+                     G_TYPE_NONE, 1,
+                     G_TYPE_UINT);
+}
+
+static void
+ai_batch_job_init(AiBatchJob *self)
+{
+    self->poll_interval = AI_BATCH_JOB_DEFAULT_POLL_INTERVAL;
+    self->max_poll_interval = AI_BATCH_JOB_DEFAULT_MAX_POLL_INTERVAL;
+    self->status = AI_BATCH_STATUS_NEW;
+    self->items = g_ptr_array_new_with_free_func((GDestroyNotify)batch_item_free);
+    self->items_by_id = g_hash_table_new(g_str_hash, g_str_equal);
+}
+
+/*
+ * Which batch API the client speaks: AI_PROVIDER_CLAUDE,
+ * AI_PROVIDER_OPENAI, or -1 for none.
+ */
+static gint
+get_batch_api(AiBatchJob *self)
+{
+    AiProviderType type;
+
+    if (!AI_IS_PROVIDER(self->client))
+    {
+        return -1;
+    }
+
+    type = ai_provider_get_provider_type(AI_PROVIDER(self->client));
+    if (type == AI_PROVIDER_CLAUDE || type == AI_PROVIDER_OPENAI)
+    {
+        return type;
+    }
+
+    return -1;
+}
+
+static gchar *
+build_url(
+    AiBatchJob  *self,
+    const gchar *path
+){
+    const gchar *base_url = self->base_url;
+
+    if (base_url == NULL)
+    {
+        base_url = ai_config_get_base_url(ai_client_get_config(self->client),
+                                          (AiProviderType)get_batch_api(self));
+    }
+
+    return g_strconcat(base_url, path, NULL);
+}
+
+/*
+ * Send @msg through the client, with its retries and auth headers.
+ * Takes ownership of @task, which @callback receives as user data.
+ */
+static void
+send_message(
+    AiBatchJob          *self,
+    SoupMessage         *msg,
+    GBytes              *body,
+    GTask               *task,
+    GAsyncReadyCallback  callback
+){
+    AI_CLIENT_GET_CLASS(self->client)->add_auth_headers(self->client, msg);
+
+    ai_client_send_and_read_async(self->client, msg, body,
+                                  g_task_get_cancellable(task),
+                                  callback, task);
+}
+
+/*
+ * Create a request to @path, or to @url when it is absolute. Fails
+ * @task and returns %NULL when the URL is invalid.
+ */
+static SoupMessage *
+new_message(
+    AiBatchJob  *self,
+    const gchar *method,
+    const gchar *path,
+    GTask       *task
+){
+    g_autofree gchar *url = NULL;
+    SoupMessage *msg;
+
+    url = g_uri_is_valid(path, G_URI_FLAGS_NONE, NULL) ? g_strdup(path)
+                                                       : build_url(self, path);
+    msg = soup_message_new(method, url);
+    if (msg == NULL)
+    {
+        g_task_return_new_error(task, AI_ERROR, AI_ERROR_CONFIGURATION_ERROR,
+                                "Invalid batch URL: %s", url);
+        g_object_unref(task);
+    }
+
+    return msg;
+}
+
+static void
+send_json(
+    AiBatchJob          *self,
+    const gchar         *method,
+    const gchar         *path,
+    GBytes              *body,
+    GTask               *task,
+    GAsyncReadyCallback  callback
+){
+    g_autoptr(SoupMessage) msg = NULL;
+
+    msg = new_message(self, method, path, task);
+    if (msg == NULL)
+    {
+        return;
+    }
+
+    if (body != NULL)
+    {
+        soup_message_headers_append(soup_message_get_request_headers(msg),
+                                    "Content-Type", "application/json");
+    }
+
+    send_message(self, msg, body, task, callback);
+}
+
+/*
+ * Parse a response body that must be a JSON object.
+ */
+static JsonNode *
+parse_object(
+    GBytes  *bytes,
+    GError **error
+){
+    g_autoptr(JsonParser) parser = NULL;
+    const gchar *data;
+    gsize len;
+    JsonNode *root;
+
+    data = g_bytes_get_data(bytes, &len);
+    parser = json_parser_new();
+
+    if (!json_parser_load_from_data(parser, data, len, error))
+    {
+        return NULL;
+    }
+
+    root = json_parser_get_root(parser);
+    if (root == NULL || !JSON_NODE_HOLDS_OBJECT(root))
+    {
+        g_set_error(error, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
+                    "Expected a JSON object from the batch API");
+        return NULL;
+    }
+
+    return json_node_copy(root);
+}
+
+static void
+replace_string(
+    gchar       **field,
+    const gchar  *value
+){
+    if (value != NULL)
+    {
+        g_free(*field);
+        *field = g_strdup(value);
+    }
+}
+
+static AiBatchStatus
+parse_claude_status(const gchar *status)
+{
+    if (g_strcmp0(status, "canceling") == 0)
+    {
+        return AI_BATCH_STATUS_CANCELING;
+    }
+    if (g_strcmp0(status, "ended") == 0)
+    {
+        return AI_BATCH_STATUS_ENDED;
+    }
+
+    return AI_BATCH_STATUS_IN_PROGRESS;
+}
+
+static AiBatchStatus
+parse_openai_status(const gchar *status)
+{
+    if (g_strcmp0(status, "cancelling") == 0)
+    {
+        return AI_BATCH_STATUS_CANCELING;
+    }
+    if (g_strcmp0(status, "completed") == 0 ||
+        g_strcmp0(status, "cancelled") == 0 ||
+        g_strcmp0(status, "expired") == 0)
+    {
+        return AI_BATCH_STATUS_ENDED;
+    }
+    if (g_strcmp0(status, "failed") == 0)
+    {
+        return AI_BATCH_STATUS_FAILED;
+    }
+
+    /* validating, in_progress, finalizing */
+    return AI_BATCH_STATUS_IN_PROGRESS;
+}
+
+/*
+ * Take the ID, status and result locations from a batch object.
+ */
+static void
+update_from_batch(
+    AiBatchJob *self,
+    JsonObject *obj
+){
+    const gchar *id;
+    AiBatchStatus status;
+
+    id = json_object_get_string_member_with_default(obj, "id", NULL);
+    if (id != NULL && g_strcmp0(id, self->id) != 0)
+    {
+        replace_string(&self->id, id);
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_ID]);
+    }
+
+    if (get_batch_api(self) == AI_PROVIDER_CLAUDE)
+    {
+        status = parse_claude_status(
+            json_object_get_string_member_with_default(obj, "processing_status", NULL));
+        replace_string(&self->results_url,
+            json_object_get_string_member_with_default(obj, "results_url", NULL));
+    }
+    else
+    {
+        status = parse_openai_status(
+            json_object_get_string_member_with_default(obj, "status", NULL));
+        replace_string(&self->output_file_id,
+            json_object_get_string_member_with_default(obj, "output_file_id", NULL));
+        replace_string(&self->error_file_id,
+            json_object_get_string_member_with_default(obj, "error_file_id", NULL));
+
+        if (status == AI_BATCH_STATUS_FAILED && json_object_has_member(obj, "errors"))
+        {
+            JsonNode *errors = json_object_get_member(obj, "errors");
+            JsonArray *data = NULL;
+
+            if (JSON_NODE_HOLDS_OBJECT(errors) &&
+                json_object_has_member(json_node_get_object(errors), "data"))
+            {
+                data = json_object_get_array_member(json_node_get_object(errors), "data");
+            }
+            if (data != NULL && json_array_get_length(data) > 0)
+            {
+                replace_string(&self->failure,
+                    json_object_get_string_member_with_default(
+                        json_array_get_object_element(data, 0), "message", NULL));
+            }
+        }
+    }
+
+    if (status != self->status)
+    {
+        self->status = status;
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_STATUS]);
+    }
+}
+
+/*
+ * Finish a send whose response is a batch object, updating the job.
+ */
+static gboolean
+finish_batch_response(
+    AiBatchJob    *self,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_autoptr(GBytes) bytes = NULL;
+    g_autoptr(JsonNode) node = NULL;
+
+    bytes = ai_client_send_and_read_finish(self->client, result, error);
+    if (bytes == NULL)
+    {
+        return FALSE;
+    }
+
+    node = parse_object(bytes, error);
+    if (node == NULL)
+    {
+        return FALSE;
+    }
+
+    update_from_batch(self, json_node_get_object(node));
+
+    if (self->id == NULL)
+    {
+        g_set_error(error, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
+                    "Batch response has no ID");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * ai_batch_job_new:
+ * @client: an #AiClaudeClient or #AiOpenAIClient
+ *
+ * Creates a new, empty batch job for @client.
+ *
+ * Returns: (transfer full): a new #AiBatchJob
+ */
+AiBatchJob *
+ai_batch_job_new(AiClient *client)
+{
+    g_return_val_if_fail(AI_IS_CLIENT(client), NULL);
+
+    return g_object_new(AI_TYPE_BATCH_JOB,
+                        "client", client,
+                        NULL);
+}
+
+/**
+ * ai_batch_job_get_client:
+ * @self: an #AiBatchJob
+ *
+ * Gets the client the job serializes requests and parses results with.
+ *
+ * Returns: (transfer none): the #AiClient
+ */
+AiClient *
+ai_batch_job_get_client(AiBatchJob *self)
+{
+    g_return_val_if_fail(AI_IS_BATCH_JOB(self), NULL);
+
+    return self->client;
+}
+
+/**
+ * ai_batch_job_get_base_url:
+ * @self: an #AiBatchJob
+ *
+ * Gets the base URL override for the batch endpoints.
+ *
+ * Returns: (transfer none) (nullable): the base URL, or %NULL
+ */
+const gchar *
+ai_batch_job_get_base_url(AiBatchJob *self)
+{
+    g_return_val_if_fail(AI_IS_BATCH_JOB(self), NULL);
+
+    return self->base_url;
+}
+
+/**
+ * ai_batch_job_set_base_url:
+ * @self: an #AiBatchJob
+ * @base_url: (nullable): the base URL, or %NULL for the default
+ *
+ * Overrides the base URL of the batch endpoints.
+ */
+void
+ai_batch_job_set_base_url(
+    AiBatchJob  *self,
+    const gchar *base_url
+){
+    g_return_if_fail(AI_IS_BATCH_JOB(self));
+
+    if (g_strcmp0(self->base_url, base_url) != 0)
+    {
+        g_free(self->base_url);
+        self->base_url = g_strdup(base_url);
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_BASE_URL]);
+    }
+}
+
+/**
+ * ai_batch_job_set_poll_interval:
+ * @self: an #AiBatchJob
+ * @interval_ms: the delay before the first poll, in milliseconds
+ * @max_interval_ms: the upper bound for the delay, in milliseconds
+ *
+ * Sets how often ai_batch_job_wait_async() polls the batch status.
+ */
+void
+ai_batch_job_set_poll_interval(
+    AiBatchJob *self,
+    guint       interval_ms,
+    guint       max_interval_ms
+){
+    g_return_if_fail(AI_IS_BATCH_JOB(self));
+
+    self->poll_interval = interval_ms;
+    self->max_poll_interval = MAX(interval_ms, max_interval_ms);
+}
+
+/**
+ * ai_batch_job_add_request:
+ * @self: an #AiBatchJob
+ * @custom_id: (nullable): an ID for the request, unique in the batch,
+ *   or %NULL to generate one
+ * @messages: (element-type AiMessage): the conversation messages
+ * @system_prompt: (nullable): the system prompt
+ * @max_tokens: the maximum number of tokens to generate
+ * @tools: (element-type AiTool) (nullable): the available tools
+ *
+ * Adds a request to the batch, serialized with the client's
+ * build_request virtual method.
+ *
+ * Returns: the index of the request, used to look up its result
+ */
+guint
+ai_batch_job_add_request(
+    AiBatchJob  *self,
+    const gchar *custom_id,
+    GList       *messages,
+    const gchar *system_prompt,
+    gint         max_tokens,
+    GList       *tools
+){
+    AiClientClass *klass;
+    BatchItem *item;
+
+    g_return_val_if_fail(AI_IS_BATCH_JOB(self), 0);
+    g_return_val_if_fail(self->status == AI_BATCH_STATUS_NEW, 0);
+    g_return_val_if_fail(custom_id == NULL ||
+                         !g_hash_table_contains(self->items_by_id, custom_id), 0);
+
+    klass = AI_CLIENT_GET_CLASS(self->client);
+
+    item = g_slice_new0(BatchItem);
+    item->custom_id = custom_id != NULL ? g_strdup(custom_id)
+                                        : g_strdup_printf("request-%u", self->items->len);
+    item->params = klass->build_request(self->client, messages, system_prompt,
+                                        max_tokens, tools);
+
+    g_ptr_array_add(self->items, item);
+    g_hash_table_insert(self->items_by_id, item->custom_id,
+                        GUINT_TO_POINTER(self->items->len));
+
+    return self->items->len - 1;
+}
+
+/**
+ * ai_batch_job_get_n_requests:
+ * @self: an #AiBatchJob
+ *
+ * Gets the number of requests in the batch.
+ *
+ * Returns: the number of requests
+ */
+guint
+ai_batch_job_get_n_requests(AiBatchJob *self)
+{
+    g_return_val_if_fail(AI_IS_BATCH_JOB(self), 0);
+
+    return self->items->len;
+}
+
+/**
+ * ai_batch_job_get_id:
+ * @self: an #AiBatchJob
+ *
+ * Gets the provider's ID for the batch.
+ *
+ * Returns: (transfer none) (nullable): the batch ID
+ */
+const gchar *
+ai_batch_job_get_id(AiBatchJob *self)
+{
+    g_return_val_if_fail(AI_IS_BATCH_JOB(self), NULL);
+
+    return self->id;
+}
+
+/**
+ * ai_batch_job_get_status:
+ * @self: an #AiBatchJob
+ *
+ * Gets the batch status as of the last request to the provider.
+ *
+ * Returns: the #AiBatchStatus
+ */
+AiBatchStatus
+ai_batch_job_get_status(AiBatchJob *self)
+{
+    g_return_val_if_fail(AI_IS_BATCH_JOB(self), AI_BATCH_STATUS_NEW);
+
+    return self->status;
+}
+
+/*
+ * Write one request as the provider's batch entry: Claude takes the
+ * Messages API parameters under "params", OpenAI a full request line.
+ */
+static void
+write_request(
+    AiBatchJob   *self,
+    AiJsonWriter *writer,
+    BatchItem    *item
+){
+    ai_json_writer_begin_object(writer);
+
+    ai_json_writer_set_member_name(writer, "custom_id");
+    ai_json_writer_add_string_value(writer, item->custom_id);
+
+    if (get_batch_api(self) == AI_PROVIDER_CLAUDE)
+    {
+        ai_json_writer_set_member_name(writer, "params");
+        ai_json_writer_add_node(writer, item->params);
+    }
+    else
+    {
+        ai_json_writer_set_member_name(writer, "method");
+        ai_json_writer_add_string_value(writer, "POST");
+        ai_json_writer_set_member_name(writer, "url");
+        ai_json_writer_add_string_value(writer, OPENAI_BATCH_REQUEST_URL);
+        ai_json_writer_set_member_name(writer, "body");
+        ai_json_writer_add_node(writer, item->params);
+    }
+
+    ai_json_writer_end_object(writer);
+}
+
+static GBytes *
+build_claude_batch(AiBatchJob *self)
+{
+    AiJsonWriter *writer;
+    guint i;
+
+    writer = ai_json_writer_new(self->items->len * 512);
+
+    ai_json_writer_begin_object(writer);
+    ai_json_writer_set_member_name(writer, "requests");
+    ai_json_writer_begin_array(writer);
+
+    for (i = 0; i < self->items->len; i++)
+    {
+        write_request(self, writer, g_ptr_array_index(self->items, i));
+    }
+
+    ai_json_writer_end_array(writer);
+    ai_json_writer_end_object(writer);
+
+    return ai_json_writer_free_to_bytes(writer);
+}
+
+/*
+ * The OpenAI input file: one request object per line.
+ */
+static GBytes *
+build_openai_input_file(AiBatchJob *self)
+{
+    GString *jsonl;
+    guint i;
+
+    jsonl = g_string_sized_new(self->items->len * 512);
+
+    for (i = 0; i < self->items->len; i++)
+    {
+        g_autoptr(AiJsonWriter) writer = ai_json_writer_new(512);
+        const gchar *line;
+        gsize len;
+
+        write_request(self, writer, g_ptr_array_index(self->items, i));
+        line = ai_json_writer_get_data(writer, &len);
+
+        g_string_append_len(jsonl, line, len);
+        g_string_append_c(jsonl, '\n');
+    }
+
+    return g_string_free_to_bytes(jsonl);
+}
+
+static void
+on_submit_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    AiBatchJob *self = g_task_get_source_object(task);
+    GError *error = NULL;
+
+    if (!finish_batch_response(self, result, &error))
+    {
+        g_task_return_error(task, error);
+    }
+    else
+    {
+        g_task_return_boolean(task, TRUE);
+    }
+
+    g_object_unref(task);
+}
+
+static void
+on_input_file_uploaded(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    AiBatchJob *self = g_task_get_source_object(task);
+    g_autoptr(GBytes) bytes = NULL;
+    g_autoptr(JsonNode) node = NULL;
+    g_autoptr(AiJsonWriter) writer = NULL;
+    g_autoptr(GBytes) body = NULL;
+    GError *error = NULL;
+    const gchar *file_id;
+
+    bytes = ai_client_send_and_read_finish(self->client, result, &error);
+    if (bytes != NULL)
+    {
+        node = parse_object(bytes, &error);
+    }
+    if (node == NULL)
+    {
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    file_id = json_object_get_string_member_with_default(
+        json_node_get_object(node), "id", NULL);
+    if (file_id == NULL)
+    {
+        g_task_return_new_error(task, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
+                                "File upload response has no ID");
+        g_object_unref(task);
+        return;
+    }
+
+    writer = ai_json_writer_new(128);
+    ai_json_writer_begin_object(writer);
+    ai_json_writer_set_member_name(writer, "input_file_id");
+    ai_json_writer_add_string_value(writer, file_id);
+    ai_json_writer_set_member_name(writer, "endpoint");
+    ai_json_writer_add_string_value(writer, OPENAI_BATCH_REQUEST_URL);
+    ai_json_writer_set_member_name(writer, "completion_window");
+    ai_json_writer_add_string_value(writer, "24h");
+    ai_json_writer_end_object(writer);
+    body = ai_json_writer_free_to_bytes(g_steal_pointer(&writer));
+
+    send_json(self, "POST", OPENAI_BATCHES_ENDPOINT, body, task, on_submit_done);
+}
+
+static void
+submit_openai(
+    AiBatchJob *self,
+    GTask      *task
+){
+    g_autoptr(SoupMultipart) multipart = NULL;
+    g_autoptr(SoupMessage) msg = NULL;
+    g_autoptr(GBytes) input = NULL;
+    g_autoptr(GBytes) body = NULL;
+
+    msg = new_message(self, "POST", OPENAI_FILES_ENDPOINT, task);
+    if (msg == NULL)
+    {
+        return;
+    }
+
+    input = build_openai_input_file(self);
+
+    multipart = soup_multipart_new(SOUP_FORM_MIME_TYPE_MULTIPART);
+    soup_multipart_append_form_string(multipart, "purpose", "batch");
+    soup_multipart_append_form_file(multipart, "file", "batch.jsonl",
+                                    "application/jsonl", input);
+
+    /* Sets the multipart Content-Type, which send_message() keeps */
+    soup_multipart_to_message(multipart, soup_message_get_request_headers(msg), &body);
+
+    send_message(self, msg, body, task, on_input_file_uploaded);
+}
+
+/**
+ * ai_batch_job_submit_async:
+ * @self: an #AiBatchJob
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call when the batch is submitted
+ * @user_data: user data for @callback
+ *
+ * Submits the batch. For Claude this is a single Message Batches
+ * request; for OpenAI the requests are first uploaded as a JSONL file.
+ */
+void
+ai_batch_job_submit_async(
+    AiBatchJob          *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    GTask *task;
+
+    g_return_if_fail(AI_IS_BATCH_JOB(self));
+    g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_batch_job_submit_async);
+
+    if (get_batch_api(self) < 0)
+    {
+        g_task_return_new_error(task, AI_ERROR, AI_ERROR_NOT_SUPPORTED,
+                                "The client has no batch API");
+        g_object_unref(task);
+        return;
+    }
+
+    if (self->status != AI_BATCH_STATUS_NEW)
+    {
+        g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_PENDING,
+                                "The batch was already submitted");
+        g_object_unref(task);
+        return;
+    }
+
+    if (self->items->len == 0)
+    {
+        g_task_return_new_error(task, AI_ERROR, AI_ERROR_INVALID_REQUEST,
+                                "The batch has no requests");
+        g_object_unref(task);
+        return;
+    }
+
+    if (get_batch_api(self) == AI_PROVIDER_CLAUDE)
+    {
+        g_autoptr(GBytes) body = build_claude_batch(self);
+
+        send_json(self, "POST", CLAUDE_BATCHES_ENDPOINT, body, task, on_submit_done);
+    }
+    else
+    {
+        submit_openai(self, task);
+    }
+}
+
+/**
+ * ai_batch_job_submit_finish:
+ * @self: an #AiBatchJob
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a submission started with ai_batch_job_submit_async().
+ *
+ * Returns: %TRUE if the batch was submitted
+ */
+gboolean
+ai_batch_job_submit_finish(
+    AiBatchJob    *self,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(AI_IS_BATCH_JOB(self), FALSE);
+    g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+static AiError
+error_code_for_status(gint64 status)
+{
+    if (status == 401 || status == 403)
+    {
+        return AI_ERROR_INVALID_API_KEY;
+    }
+    if (status == 429)
+    {
+        return AI_ERROR_RATE_LIMITED;
+    }
+    if (status >= 500)
+    {
+        return AI_ERROR_SERVER_ERROR;
+    }
+
+    return AI_ERROR_INVALID_REQUEST;
+}
+
+static AiError
+error_code_for_type(const gchar *type)
+{
+    if (g_strcmp0(type, "invalid_request_error") == 0)
+    {
+        return AI_ERROR_INVALID_REQUEST;
+    }
+    if (g_strcmp0(type, "authentication_error") == 0 ||
+        g_strcmp0(type, "permission_error") == 0)
+    {
+        return AI_ERROR_INVALID_API_KEY;
+    }
+    if (g_strcmp0(type, "rate_limit_error") == 0)
+    {
+        return AI_ERROR_RATE_LIMITED;
+    }
+    if (g_strcmp0(type, "overloaded_error") == 0)
+    {
+        return AI_ERROR_SERVICE_UNAVAILABLE;
+    }
+
+    return AI_ERROR_SERVER_ERROR;
+}
+
+/*
+ * Set @error from an API error object, either bare or wrapped in an
+ * {"error": ...} envelope.
+ */
+static void
+set_error_from_object(
+    GError     **error,
+    JsonObject  *obj,
+    gint64       status
+){
+    const gchar *message;
+    AiError code;
+
+    if (obj != NULL && json_object_has_member(obj, "error") &&
+        JSON_NODE_HOLDS_OBJECT(json_object_get_member(obj, "error")))
+    {
+        obj = json_object_get_object_member(obj, "error");
+    }
+
+    message = obj != NULL
+        ? json_object_get_string_member_with_default(obj, "message", NULL)
+        : NULL;
+
+    if (status > 0)
+    {
+        code = error_code_for_status(status);
+    }
+    else
+    {
+        code = error_code_for_type(obj != NULL
+            ? json_object_get_string_member_with_default(obj, "type", NULL)
+            : NULL);
+    }
+
+    g_set_error(error, AI_ERROR, code, "%s",
+                message != NULL ? message : "Batch request failed");
+}
+
+static JsonObject *
+get_object_member(
+    JsonObject  *obj,
+    const gchar *name
+){
+    JsonNode *node;
+
+    if (obj == NULL || !json_object_has_member(obj, name))
+    {
+        return NULL;
+    }
+
+    node = json_object_get_member(obj, name);
+    return JSON_NODE_HOLDS_OBJECT(node) ? json_node_get_object(node) : NULL;
+}
+
+/*
+ * Turn a Claude result into a response or an error.
+ */
+static AiResponse *
+parse_claude_result(
+    AiBatchJob  *self,
+    JsonObject  *line,
+    GError     **error
+){
+    JsonObject *result = get_object_member(line, "result");
+    const gchar *type;
+
+    type = result != NULL
+        ? json_object_get_string_member_with_default(result, "type", NULL)
+        : NULL;
+
+    if (g_strcmp0(type, "succeeded") == 0 && json_object_has_member(result, "message"))
+    {
+        return AI_CLIENT_GET_CLASS(self->client)->parse_response(
+            self->client, json_object_get_member(result, "message"), error);
+    }
+    if (g_strcmp0(type, "errored") == 0)
+    {
+        set_error_from_object(error, get_object_member(result, "error"), 0);
+        return NULL;
+    }
+    if (g_strcmp0(type, "canceled") == 0)
+    {
+        g_set_error(error, AI_ERROR, AI_ERROR_CANCELLED,
+                    "The request was canceled before it was processed");
+        return NULL;
+    }
+    if (g_strcmp0(type, "expired") == 0)
+    {
+        g_set_error(error, AI_ERROR, AI_ERROR_TIMEOUT,
+                    "The batch expired before the request was processed");
+        return NULL;
+    }
+
+    g_set_error(error, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
+                "Unknown batch result type: %s", type != NULL ? type : "(none)");
+    return NULL;
+}
+
+/*
+ * Turn an OpenAI output or error file line into a response or an error.
+ */
+static AiResponse *
+parse_openai_result(
+    AiBatchJob  *self,
+    JsonObject  *line,
+    GError     **error
+){
+    JsonObject *response = get_object_member(line, "response");
+    JsonObject *line_error = get_object_member(line, "error");
+    gint64 status = 0;
+
+    if (line_error != NULL)
+    {
+        set_error_from_object(error, line_error, 0);
+        return NULL;
+    }
+
+    if (response != NULL)
+    {
+        status = json_object_get_int_member_with_default(response, "status_code", 0);
+    }
+
+    if (response == NULL || !json_object_has_member(response, "body"))
+    {
+        g_set_error(error, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
+                    "Batch result has no response body");
+        return NULL;
+    }
+
+    if (status < 200 || status >= 300)
+    {
+        set_error_from_object(error, get_object_member(response, "body"), status);
+        return NULL;
+    }
+
+    return AI_CLIENT_GET_CLASS(self->client)->parse_response(
+        self->client, json_object_get_member(response, "body"), error);
+}
+
+/*
+ * Match one result line to its request and store the outcome.
+ */
+static void
+apply_result_line(
+    AiBatchJob  *self,
+    JsonParser  *parser,
+    const gchar *line,
+    gsize        len
+){
+    JsonNode *root;
+    JsonObject *obj;
+    BatchItem *item;
+    gpointer slot;
+    guint index;
+
+    if (!json_parser_load_from_data(parser, line, len, NULL))
+    {
+        g_debug("Ignoring malformed batch result line");
+        return;
+    }
+
+    root = json_parser_get_root(parser);
+    if (root == NULL || !JSON_NODE_HOLDS_OBJECT(root))
+    {
+        return;
+    }
+
+    obj = json_node_get_object(root);
+    slot = g_hash_table_lookup(self->items_by_id,
+        json_object_get_string_member_with_default(obj, "custom_id", ""));
+    if (slot == NULL)
+    {
+        g_debug("Ignoring batch result for an unknown request");
+        return;
+    }
+
+    index = GPOINTER_TO_UINT(slot) - 1;
+    item = g_ptr_array_index(self->items, index);
+    g_clear_object(&item->response);
+    g_clear_error(&item->error);
+
+    if (get_batch_api(self) == AI_PROVIDER_CLAUDE)
+    {
+        item->response = parse_claude_result(self, obj, &item->error);
+    }
+    else
+    {
+        item->response = parse_openai_result(self, obj, &item->error);
+    }
+
+    if (item->response == NULL && item->error == NULL)
+    {
+        g_set_error(&item->error, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
+                    "Failed to parse batch result");
+    }
+
+    g_signal_emit(self, signals[SIGNAL_REQUEST_FINISHED], 0, index);
+}
+
+static void
+apply_results(
+    AiBatchJob *self,
+    GBytes     *bytes
+){
+    g_autoptr(JsonParser) parser = json_parser_new();
+    const gchar *data;
+    const gchar *end;
+    gsize len;
+
+    data = g_bytes_get_data(bytes, &len);
+    end = data + len;
+
+    while (data < end)
+    {
+        const gchar *newline = memchr(data, '\n', end - data);
+        const gchar *line_end = newline != NULL ? newline : end;
+
+        if (line_end > data)
+        {
+            apply_result_line(self, parser, data, line_end - data);
+        }
+
+        data = line_end + 1;
+    }
+}
+
+static void poll_status(GTask *task);
+static void download_next_result(GTask *task);
+
+static void
+on_result_downloaded(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    AiBatchJob *self = g_task_get_source_object(task);
+    g_autoptr(GBytes) bytes = NULL;
+    GError *error = NULL;
+
+    bytes = ai_client_send_and_read_finish(self->client, result, &error);
+    if (bytes == NULL)
+    {
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    apply_results(self, bytes);
+    download_next_result(task);
+}
+
+/*
+ * Download the result files one at a time, then fail the requests no
+ * file had a result for.
+ */
+static void
+download_next_result(GTask *task)
+{
+    AiBatchJob *self = g_task_get_source_object(task);
+    WaitData *data = g_task_get_task_data(task);
+    g_autoptr(SoupMessage) msg = NULL;
+    guint i;
+
+    if (data->next_url < data->result_urls->len)
+    {
+        const gchar *url = g_ptr_array_index(data->result_urls, data->next_url++);
+
+        msg = new_message(self, "GET", url, task);
+        if (msg != NULL)
+        {
+            send_message(self, msg, NULL, task, on_result_downloaded);
+        }
+        return;
+    }
+
+    for (i = 0; i < self->items->len; i++)
+    {
+        BatchItem *item = g_ptr_array_index(self->items, i);
+
+        if (item->response == NULL && item->error == NULL)
+        {
+            g_set_error(&item->error, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
+                        "The batch has no result for request %s", item->custom_id);
+            g_signal_emit(self, signals[SIGNAL_REQUEST_FINISHED], 0, i);
+        }
+    }
+
+    g_task_return_boolean(task, TRUE);
+    g_object_unref(task);
+}
+
+static void
+start_downloads(GTask *task)
+{
+    AiBatchJob *self = g_task_get_source_object(task);
+    WaitData *data = g_task_get_task_data(task);
+
+    data->result_urls = g_ptr_array_new_with_free_func(g_free);
+
+    if (get_batch_api(self) == AI_PROVIDER_CLAUDE)
+    {
+        if (self->results_url != NULL)
+        {
+            g_ptr_array_add(data->result_urls, g_strdup(self->results_url));
+        }
+    }
+    else
+    {
+        if (self->output_file_id != NULL)
+        {
+            g_ptr_array_add(data->result_urls,
+                g_strdup_printf(OPENAI_FILES_ENDPOINT "/%s/content", self->output_file_id));
+        }
+        if (self->error_file_id != NULL)
+        {
+            g_ptr_array_add(data->result_urls,
+                g_strdup_printf(OPENAI_FILES_ENDPOINT "/%s/content", self->error_file_id));
+        }
+    }
+
+    download_next_result(task);
+}
+
+static gboolean
+on_poll_delay_done(gpointer user_data)
+{
+    GTask *task = G_TASK(user_data);
+
+    if (g_task_return_error_if_cancelled(task))
+    {
+        g_object_unref(task);
+        return G_SOURCE_REMOVE;
+    }
+
+    poll_status(task);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+schedule_poll(GTask *task)
+{
+    WaitData *data = g_task_get_task_data(task);
+    GCancellable *cancellable = g_task_get_cancellable(task);
+    GSource *source;
+
+    /* Wake up on either the delay or cancellation */
+    source = g_timeout_source_new(data->delay_ms);
+    if (cancellable != NULL)
+    {
+        GSource *cancel_source = g_cancellable_source_new(cancellable);
+
+        g_source_set_dummy_callback(cancel_source);
+        g_source_add_child_source(source, cancel_source);
+        g_source_unref(cancel_source);
+    }
+
+    g_source_set_callback(source, on_poll_delay_done, task, NULL);
+    g_source_attach(source, g_task_get_context(task));
+    g_source_unref(source);
+}
+
+static void
+on_poll_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    AiBatchJob *self = g_task_get_source_object(task);
+    WaitData *data = g_task_get_task_data(task);
+    GError *error = NULL;
+
+    if (!finish_batch_response(self, result, &error))
+    {
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    switch (self->status)
+    {
+        case AI_BATCH_STATUS_ENDED:
+            start_downloads(task);
+            break;
+        case AI_BATCH_STATUS_FAILED:
+            g_task_return_new_error(task, AI_ERROR, AI_ERROR_SERVER_ERROR,
+                                    "Batch %s failed: %s", self->id,
+                                    self->failure != NULL ? self->failure : "unknown error");
+            g_object_unref(task);
+            break;
+        default:
+            schedule_poll(task);
+            data->delay_ms = MIN(data->delay_ms + data->delay_ms / 2 + 1,
+                                 self->max_poll_interval);
+            break;
+    }
+}
+
+static void
+poll_status(GTask *task)
+{
+    AiBatchJob *self = g_task_get_source_object(task);
+    g_autofree gchar *path = NULL;
+
+    if (get_batch_api(self) == AI_PROVIDER_CLAUDE)
+    {
+        path = g_strdup_printf(CLAUDE_BATCHES_ENDPOINT "/%s", self->id);
+    }
+    else
+    {
+        path = g_strdup_printf(OPENAI_BATCHES_ENDPOINT "/%s", self->id);
+    }
+
+    send_json(self, "GET", path, NULL, task, on_poll_done);
+}
+
+/**
+ * ai_batch_job_wait_async:
+ * @self: an #AiBatchJob
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call when all results are in
+ * @user_data: user data for @callback
+ *
+ * Polls the batch status until processing has ended, then downloads
+ * and parses the results. The first poll is immediate; later polls
+ * back off from the poll interval by half each time, up to the maximum.
+ */
+void
+ai_batch_job_wait_async(
+    AiBatchJob          *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    WaitData *data;
+    GTask *task;
+
+    g_return_if_fail(AI_IS_BATCH_JOB(self));
+    g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_batch_job_wait_async);
+
+    if (self->id == NULL)
+    {
+        g_task_return_new_error(task, AI_ERROR, AI_ERROR_INVALID_REQUEST,
+                                "The batch has not been submitted");
+        g_object_unref(task);
+        return;
+    }
+
+    data = g_slice_new0(WaitData);
+    data->delay_ms = self->poll_interval;
+    g_task_set_task_data(task, data, (GDestroyNotify)wait_data_free);
+
+    poll_status(task);
+}
+
+/**
+ * ai_batch_job_wait_finish:
+ * @self: an #AiBatchJob
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a wait started with ai_batch_job_wait_async().
+ *
+ * Returns: %TRUE if the results were retrieved, %FALSE if the wait was
+ *   cancelled, a request to the provider failed, or the batch failed
+ */
+gboolean
+ai_batch_job_wait_finish(
+    AiBatchJob    *self,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(AI_IS_BATCH_JOB(self), FALSE);
+    g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+/**
+ * ai_batch_job_cancel_async:
+ * @self: an #AiBatchJob
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call when the cancellation was requested
+ * @user_data: user data for @callback
+ *
+ * Asks the provider to cancel the batch.
+ */
+void
+ai_batch_job_cancel_async(
+    AiBatchJob          *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autofree gchar *path = NULL;
+    GTask *task;
+
+    g_return_if_fail(AI_IS_BATCH_JOB(self));
+    g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_batch_job_cancel_async);
+
+    if (self->id == NULL)
+    {
+        g_task_return_new_error(task, AI_ERROR, AI_ERROR_INVALID_REQUEST,
+                                "The batch has not been submitted");
+        g_object_unref(task);
+        return;
+    }
+
+    if (get_batch_api(self) == AI_PROVIDER_CLAUDE)
+    {
+        path = g_strdup_printf(CLAUDE_BATCHES_ENDPOINT "/%s/cancel", self->id);
+    }
+    else
+    {
+        path = g_strdup_printf(OPENAI_BATCHES_ENDPOINT "/%s/cancel", self->id);
+    }
+
+    send_json(self, "POST", path, NULL, task, on_submit_done);
+}
+
+/**
+ * ai_batch_job_cancel_finish:
+ * @self: an #AiBatchJob
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a cancellation started with ai_batch_job_cancel_async().
+ *
+ * Returns: %TRUE if the cancellation was accepted
+ */
+gboolean
+ai_batch_job_cancel_finish(
+    AiBatchJob    *self,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(AI_IS_BATCH_JOB(self), FALSE);
+    g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+/**
+ * ai_batch_job_get_response:
+ * @self: an #AiBatchJob
+ * @index: the request index
+ *
+ * Gets the response to the request at @index.
+ *
+ * Returns: (transfer none) (nullable): the #AiResponse, or %NULL if the
+ *   request failed or its result has not been retrieved
+ */
+AiResponse *
+ai_batch_job_get_response(
+    AiBatchJob *self,
+    guint       index
+){
+    BatchItem *item;
+
+    g_return_val_if_fail(AI_IS_BATCH_JOB(self), NULL);
+    g_return_val_if_fail(index < self->items->len, NULL);
+
+    item = g_ptr_array_index(self->items, index);
+    return item->response;
+}
+
+/**
+ * ai_batch_job_get_error:
+ * @self: an #AiBatchJob
+ * @index: the request index
+ *
+ * Gets the error of the request at @index.
+ *
+ * Returns: (transfer none) (nullable): the #GError, or %NULL if the
+ *   request succeeded or its result has not been retrieved
+ */
+const GError *
+ai_batch_job_get_error(
+    AiBatchJob *self,
+    guint       index
+){
+    BatchItem *item;
+
+    g_return_val_if_fail(AI_IS_BATCH_JOB(self), NULL);
+    g_return_val_if_fail(index < self->items->len, NULL);
+
+    item = g_ptr_array_index(self->items, index);
+    return item->error;
+}
@@ -0,0 +1,339 @@
+/*
+ * ai-batch-job.h - Provider batch API jobs
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * AiBatchJob submits many requests through a provider's asynchronous
+ * batch endpoint (Claude Message Batches, OpenAI Batch) instead of
+ * sending them one by one. Batches are cheaper and have higher
+ * throughput, but results arrive minutes to hours later.
+ *
+ * Requests are serialized with the client's build_request virtual
+ * method and results parsed with its parse_response virtual method, so
+ * they are the same as for ai_provider_chat_async().
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include "core/ai-client.h"
+#include "model/ai-response.h"
+
+G_BEGIN_DECLS
+
+/**
+ * AiBatchStatus:
+ * @AI_BATCH_STATUS_NEW: not yet submitted
+ * @AI_BATCH_STATUS_IN_PROGRESS: submitted and being processed
+ * @AI_BATCH_STATUS_CANCELING: cancellation requested, still processing
+ * @AI_BATCH_STATUS_ENDED: processing ended; results are available
+ * @AI_BATCH_STATUS_FAILED: the batch as a whole failed
+ *
+ * Processing status of an #AiBatchJob.
+ */
+typedef enum
+{
+    AI_BATCH_STATUS_NEW = 0,
+    AI_BATCH_STATUS_IN_PROGRESS,
+    AI_BATCH_STATUS_CANCELING,
+    AI_BATCH_STATUS_ENDED,
+    AI_BATCH_STATUS_FAILED
+} AiBatchStatus;
+
+GType ai_batch_status_get_type(void) G_GNUC_CONST;
+#define AI_TYPE_BATCH_STATUS (ai_batch_status_get_type())
+
+/**
+ * AI_BATCH_JOB_DEFAULT_POLL_INTERVAL:
+ *
+ * Default delay before the first status poll, in milliseconds.
+ */
+#define AI_BATCH_JOB_DEFAULT_POLL_INTERVAL (10000)
+
+/**
+ * AI_BATCH_JOB_DEFAULT_MAX_POLL_INTERVAL:
+ *
+ * Default upper bound for the delay between status polls, in milliseconds.
+ */
+#define AI_BATCH_JOB_DEFAULT_MAX_POLL_INTERVAL (300000)
+
+#define AI_TYPE_BATCH_JOB (ai_batch_job_get_type())
+
+G_DECLARE_FINAL_TYPE(AiBatchJob, ai_batch_job, AI, BATCH_JOB, GObject)
+
+/**
+ * ai_batch_job_new:
+ * @client: an #AiClaudeClient or #AiOpenAIClient
+ *
+ * Creates a new, empty batch job for @client. Other clients have no
+ * batch endpoint; submitting a job for them fails with
+ * %AI_ERROR_NOT_SUPPORTED.
+ *
+ * Returns: (transfer full): a new #AiBatchJob
+ */
+AiBatchJob *
+ai_batch_job_new(AiClient *client);
+
+/**
+ * ai_batch_job_get_client:
+ * @self: an #AiBatchJob
+ *
+ * Gets the client the job serializes requests and parses results with.
+ *
+ * Returns: (transfer none): the #AiClient
+ */
+AiClient *
+ai_batch_job_get_client(AiBatchJob *self);
+
+/**
+ * ai_batch_job_get_base_url:
+ * @self: an #AiBatchJob
+ *
+ * Gets the base URL override for the batch endpoints.
+ *
+ * Returns: (transfer none) (nullable): the base URL, or %NULL to use
+ *   the client's configured base URL
+ */
+const gchar *
+ai_batch_job_get_base_url(AiBatchJob *self);
+
+/**
+ * ai_batch_job_set_base_url:
+ * @self: an #AiBatchJob
+ * @base_url: (nullable): the base URL, or %NULL for the default
+ *
+ * Overrides the base URL of the batch endpoints, e.g. to talk to a
+ * compatible local server.
+ */
+void
+ai_batch_job_set_base_url(
+    AiBatchJob  *self,
+    const gchar *base_url
+);
+
+/**
+ * ai_batch_job_set_poll_interval:
+ * @self: an #AiBatchJob
+ * @interval_ms: the delay before the first poll, in milliseconds
+ * @max_interval_ms: the upper bound for the delay, in milliseconds
+ *
+ * Sets how often ai_batch_job_wait_async() polls the batch status.
+ * The delay grows by half after each poll, up to @max_interval_ms.
+ */
+void
+ai_batch_job_set_poll_interval(
+    AiBatchJob *self,
+    guint       interval_ms,
+    guint       max_interval_ms
+);
+
+/**
+ * ai_batch_job_add_request:
+ * @self: an #AiBatchJob
+ * @custom_id: (nullable): an ID for the request, unique in the batch,
+ *   or %NULL to generate one
+ * @messages: (element-type AiMessage): the conversation messages
+ * @system_prompt: (nullable): the system prompt
+ * @max_tokens: the maximum number of tokens to generate
+ * @tools: (element-type AiTool) (nullable): the available tools
+ *
+ * Adds a request to the batch. The request is serialized immediately,
+ * using the client's current model and settings. Requests cannot be
+ * added once the batch is submitted.
+ *
+ * Returns: the index of the request, used to look up its result
+ */
+guint
+ai_batch_job_add_request(
+    AiBatchJob  *self,
+    const gchar *custom_id,
+    GList       *messages,
+    const gchar *system_prompt,
+    gint         max_tokens,
+    GList       *tools
+);
+
+/**
+ * ai_batch_job_get_n_requests:
+ * @self: an #AiBatchJob
+ *
+ * Gets the number of requests in the batch.
+ *
+ * Returns: the number of requests
+ */
+guint
+ai_batch_job_get_n_requests(AiBatchJob *self);
+
+/**
+ * ai_batch_job_get_id:
+ * @self: an #AiBatchJob
+ *
+ * Gets the provider's ID for the batch.
+ *
+ * Returns: (transfer none) (nullable): the batch ID, or %NULL if the
+ *   batch has not been submitted
+ */
+const gchar *
+ai_batch_job_get_id(AiBatchJob *self);
+
+/**
+ * ai_batch_job_get_status:
+ * @self: an #AiBatchJob
+ *
+ * Gets the batch status as of the last request to the provider.
+ *
+ * Returns: the #AiBatchStatus
+ */
+AiBatchStatus
+ai_batch_job_get_status(AiBatchJob *self);
+
+/**
+ * ai_batch_job_submit_async:
+ * @self: an #AiBatchJob
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call when the batch is submitted
+ * @user_data: user data for @callback
+ *
+ * Submits the batch to the provider.
+ */
+void
+ai_batch_job_submit_async(
+    AiBatchJob          *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+);
+
+/**
+ * ai_batch_job_submit_finish:
+ * @self: an #AiBatchJob
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a submission started with ai_batch_job_submit_async().
+ *
+ * Returns: %TRUE if the batch was submitted
+ */
+gboolean
+ai_batch_job_submit_finish(
+    AiBatchJob    *self,
+    GAsyncResult  *result,
+    GError       **error
+);
+
+/**
+ * ai_batch_job_wait_async:
+ * @self: an #AiBatchJob
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call when all results are in
+ * @user_data: user data for @callback
+ *
+ * Polls the batch status with backoff until processing has ended, then
+ * downloads the results. #AiBatchJob::request-finished is emitted for
+ * each result as it is parsed. Cancelling @cancellable stops waiting;
+ * it does not cancel the batch (see ai_batch_job_cancel_async()).
+ */
+void
+ai_batch_job_wait_async(
+    AiBatchJob          *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+);
+
+/**
+ * ai_batch_job_wait_finish:
+ * @self: an #AiBatchJob
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a wait started with ai_batch_job_wait_async(). Failures of
+ * individual requests do not fail the wait; check them with
+ * ai_batch_job_get_error().
+ *
+ * Returns: %TRUE if the results were retrieved
+ */
+gboolean
+ai_batch_job_wait_finish(
+    AiBatchJob    *self,
+    GAsyncResult  *result,
+    GError       **error
+);
+
+/**
+ * ai_batch_job_cancel_async:
+ * @self: an #AiBatchJob
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call when the cancellation was requested
+ * @user_data: user data for @callback
+ *
+ * Asks the provider to cancel the batch. Requests already processed
+ * keep their results, which ai_batch_job_wait_async() still retrieves.
+ */
+void
+ai_batch_job_cancel_async(
+    AiBatchJob          *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+);
+
+/**
+ * ai_batch_job_cancel_finish:
+ * @self: an #AiBatchJob
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a cancellation started with ai_batch_job_cancel_async().
+ *
+ * Returns: %TRUE if the cancellation was accepted
+ */
+gboolean
+ai_batch_job_cancel_finish(
+    AiBatchJob    *self,
+    GAsyncResult  *result,
+    GError       **error
+);
+
+/**
+ * ai_batch_job_get_response:
+ * @self: an #AiBatchJob
+ * @index: the request index
+ *
+ * Gets the response to the request at @index.
+ *
+ * Returns: (transfer none) (nullable): the #AiResponse, or %NULL if the
+ *   request failed or its result has not been retrieved
+ */
+AiResponse *
+ai_batch_job_get_response(
+    AiBatchJob *self,
+    guint       index
+);
+
+/**
+ * ai_batch_job_get_error:
+ * @self: an #AiBatchJob
+ * @index: the request index
+ *
+ * Gets the error of the request at @index.
+ *
+ * Returns: (transfer none) (nullable): the #GError, or %NULL if the
+ *   request succeeded or its result has not been retrieved
+ */
+const GError *
+ai_batch_job_get_error(
+    AiBatchJob *self,
+    guint       index
+);
+
+G_END_DECLS
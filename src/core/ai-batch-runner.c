@@ -0,0 +1,603 @@
+/*
+ * ai-batch-runner.c - Bounded-concurrency fan-out of chat requests
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include "core/ai-batch-runner.h"
+#include "core/ai-error.h"
+
+/*
+ * One request in the batch and its outcome.
+ */
+typedef struct
+{
+    GList      *messages;       /* element-type AiMessage, owned refs */
+    gchar      *system_prompt;
+    gint        max_tokens;
+    GList      *tools;          /* element-type AiTool, owned refs */
+
+    AiResponse *response;
+    GError     *error;
+} BatchItem;
+
+struct _AiBatchRunner
+{
+    GObject parent_instance;
+
+    AiProvider *provider;
+    guint       max_in_flight;
+    GPtrArray  *items;          /* element-type BatchItem */
+
+    /* State of the current run */
+    GTask      *task;
+    guint       next;
+    guint       in_flight;
+    guint       n_failed;
+};
+
+G_DEFINE_TYPE(AiBatchRunner, ai_batch_runner, G_TYPE_OBJECT)
+
+enum
+{
+    PROP_0,
+    PROP_PROVIDER,
+    PROP_MAX_IN_FLIGHT,
+    N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
+enum
+{
+    SIGNAL_REQUEST_FINISHED,
+    N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
+/*
+ * Data for one request in flight.
+ */
+typedef struct
+{
+    AiBatchRunner *runner;
+    guint          index;
+} ItemData;
+
+static void
+batch_item_clear_result(BatchItem *item)
+{
+    g_clear_object(&item->response);
+    g_clear_error(&item->error);
+}
+
+static void
+batch_item_free(BatchItem *item)
+{
+    g_list_free_full(item->messages, g_object_unref);
+    g_list_free_full(item->tools, g_object_unref);
+    g_free(item->system_prompt);
+    batch_item_clear_result(item);
+    g_slice_free(BatchItem, item);
+}
+
+static void
+ai_batch_runner_finalize(GObject *object)
+{
+    AiBatchRunner *self = AI_BATCH_RUNNER(object);
+
+    g_clear_object(&self->provider);
+    g_clear_pointer(&self->items, g_ptr_array_unref);
+
+    G_OBJECT_CLASS(ai_batch_runner_parent_class)->finalize(object);
+}
+
+static void
+ai_batch_runner_get_property(
+    GObject    *object,
+    guint       prop_id,
+    GValue     *value,
+    GParamSpec *pspec
+){
+    AiBatchRunner *self = AI_BATCH_RUNNER(object);
+
+    switch (prop_id)
+    {
+        case PROP_PROVIDER:
+            g_value_set_object(value, self->provider);
+            break;
+        case PROP_MAX_IN_FLIGHT:
+            g_value_set_uint(value, self->max_in_flight);
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+static void
+ai_batch_runner_set_property(
+    GObject      *object,
+    guint         prop_id,
+    const GValue *value,
+    GParamSpec   *pspec
+){
+    AiBatchRunner *self = AI_BATCH_RUNNER(object);
+
+    switch (prop_id)
+    {
+        case PROP_PROVIDER:
+            g_clear_object(&self->provider);
+            self->provider = g_value_dup_object(value);
+            break;
+        case PROP_MAX_IN_FLIGHT:
+            self->max_in_flight = g_value_get_uint(value);
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+static void
+ai_batch_runner_class_init(AiBatchRunnerClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->finalize = ai_batch_runner_finalize;
+    object_class->get_property = ai_batch_runner_get_property;
+    object_class->set_property = ai_batch_runner_set_property;
+
+    /**
+     * AiBatchRunner:provider:
+     *
+     * The provider requests are sent through.
+     */
+    properties[PROP_PROVIDER] =
+        g_param_spec_object("provider",
+                            "Provider",
+                            "The provider requests are sent through",
+                            AI_TYPE_PROVIDER,
+                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+                            G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiBatchRunner:max-in-flight:
+     *
+     * The maximum number of requests in flight at once.
+     */
+    properties[PROP_MAX_IN_FLIGHT] =
+        g_param_spec_uint("max-in-flight",
+                          "Max In Flight",
+                          "The maximum number of requests in flight at once",
+                          1, G_MAXUINT,
+                          AI_BATCH_RUNNER_DEFAULT_MAX_IN_FLIGHT,
+                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT |
+                          G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_STRINGS);
+
+    g_object_class_install_properties(object_class, N_PROPS, properties);
+
+    /**
+     * AiBatchRunner::request-finished:
+     * @self: the #AiBatchRunner
+     * @index: the index of the request
+     *
+     * Emitted when a request of the running batch has finished, with
+     * its result available from ai_batch_runner_get_response() or
+     * ai_batch_runner_get_error(). Requests finish in any order.
+     */
+    signals[SIGNAL_REQUEST_FINISHED] =
+        g_signal_new("request-finished",
+                     G_TYPE_FROM_CLASS(klass),
+                     G_SIGNAL_RUN_LAST,
+                     0,
+                     NULL, NULL,
+                     NULL,
+                     G_TYPE_NONE, 1,
+                     G_TYPE_UINT);
+}
+
+static void
+ai_batch_runner_init(AiBatchRunner *self)
+{
+    self->max_in_flight = AI_BATCH_RUNNER_DEFAULT_MAX_IN_FLIGHT;
+    self->items = g_ptr_array_new_with_free_func((GDestroyNotify)batch_item_free);
+}
+
+/**
+ * ai_batch_runner_new:
+ * @provider: the #AiProvider to send requests through
+ *
+ * Creates a new, empty batch for @provider.
+ *
+ * Returns: (transfer full): a new #AiBatchRunner
+ */
+AiBatchRunner *
+ai_batch_runner_new(AiProvider *provider)
+{
+    g_return_val_if_fail(AI_IS_PROVIDER(provider), NULL);
+
+    return g_object_new(AI_TYPE_BATCH_RUNNER,
+                        "provider", provider,
+                        NULL);
+}
+
+/**
+ * ai_batch_runner_get_provider:
+ * @self: an #AiBatchRunner
+ *
+ * Gets the provider requests are sent through.
+ *
+ * Returns: (transfer none): the #AiProvider
+ */
+AiProvider *
+ai_batch_runner_get_provider(AiBatchRunner *self)
+{
+    g_return_val_if_fail(AI_IS_BATCH_RUNNER(self), NULL);
+
+    return self->provider;
+}
+
+/**
+ * ai_batch_runner_get_max_in_flight:
+ * @self: an #AiBatchRunner
+ *
+ * Gets the maximum number of requests in flight at once.
+ *
+ * Returns: the limit
+ */
+guint
+ai_batch_runner_get_max_in_flight(AiBatchRunner *self)
+{
+    g_return_val_if_fail(AI_IS_BATCH_RUNNER(self), 0);
+
+    return self->max_in_flight;
+}
+
+/**
+ * ai_batch_runner_set_max_in_flight:
+ * @self: an #AiBatchRunner
+ * @max_in_flight: the limit, at least 1
+ *
+ * Sets the maximum number of requests in flight at once. Takes effect
+ * for requests started after the call.
+ */
+void
+ai_batch_runner_set_max_in_flight(
+    AiBatchRunner *self,
+    guint          max_in_flight
+){
+    g_return_if_fail(AI_IS_BATCH_RUNNER(self));
+    g_return_if_fail(max_in_flight > 0);
+
+    if (self->max_in_flight != max_in_flight)
+    {
+        self->max_in_flight = max_in_flight;
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_MAX_IN_FLIGHT]);
+    }
+}
+
+/**
+ * ai_batch_runner_add_request:
+ * @self: an #AiBatchRunner
+ * @messages: (element-type AiMessage): the conversation messages
+ * @system_prompt: (nullable): the system prompt
+ * @max_tokens: the maximum number of tokens to generate
+ * @tools: (element-type AiTool) (nullable): the available tools
+ *
+ * Adds a request to the batch. The batch keeps references to the
+ * messages and tools. Requests cannot be added while the batch runs.
+ *
+ * Returns: the index of the request, used to look up its result
+ */
+guint
+ai_batch_runner_add_request(
+    AiBatchRunner *self,
+    GList         *messages,
+    const gchar   *system_prompt,
+    gint           max_tokens,
+    GList         *tools
+){
+    BatchItem *item;
+
+    g_return_val_if_fail(AI_IS_BATCH_RUNNER(self), 0);
+    g_return_val_if_fail(self->task == NULL, 0);
+
+    item = g_slice_new0(BatchItem);
+    item->messages = g_list_copy_deep(messages, (GCopyFunc)g_object_ref, NULL);
+    item->system_prompt = g_strdup(system_prompt);
+    item->max_tokens = max_tokens;
+    item->tools = g_list_copy_deep(tools, (GCopyFunc)g_object_ref, NULL);
+
+    g_ptr_array_add(self->items, item);
+
+    return self->items->len - 1;
+}
+
+/**
+ * ai_batch_runner_add_prompt:
+ * @self: an #AiBatchRunner
+ * @prompt: the user prompt
+ * @system_prompt: (nullable): the system prompt
+ * @max_tokens: the maximum number of tokens to generate
+ *
+ * Adds a single-message request to the batch.
+ *
+ * Returns: the index of the request, used to look up its result
+ */
+guint
+ai_batch_runner_add_prompt(
+    AiBatchRunner *self,
+    const gchar   *prompt,
+    const gchar   *system_prompt,
+    gint           max_tokens
+){
+    g_autoptr(AiMessage) msg = NULL;
+    GList messages = { NULL, NULL, NULL };
+
+    g_return_val_if_fail(AI_IS_BATCH_RUNNER(self), 0);
+    g_return_val_if_fail(prompt != NULL, 0);
+
+    msg = ai_message_new_user(prompt);
+    messages.data = msg;
+
+    return ai_batch_runner_add_request(self, &messages, system_prompt,
+                                       max_tokens, NULL);
+}
+
+/**
+ * ai_batch_runner_get_n_requests:
+ * @self: an #AiBatchRunner
+ *
+ * Gets the number of requests in the batch.
+ *
+ * Returns: the number of requests
+ */
+guint
+ai_batch_runner_get_n_requests(AiBatchRunner *self)
+{
+    g_return_val_if_fail(AI_IS_BATCH_RUNNER(self), 0);
+
+    return self->items->len;
+}
+
+static void start_requests(AiBatchRunner *self);
+
+static void
+on_request_finished(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    ItemData *data = user_data;
+    AiBatchRunner *self = data->runner;
+    BatchItem *item = g_ptr_array_index(self->items, data->index);
+
+    item->response = ai_provider_chat_finish(AI_PROVIDER(source), result, &item->error);
+    if (item->response == NULL)
+    {
+        if (item->error == NULL)
+        {
+            g_set_error(&item->error, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
+                        "Provider returned no response");
+        }
+        self->n_failed++;
+    }
+
+    self->in_flight--;
+
+    g_signal_emit(self, signals[SIGNAL_REQUEST_FINISHED], 0, data->index);
+
+    start_requests(self);
+
+    g_object_unref(data->runner);
+    g_slice_free(ItemData, data);
+}
+
+/*
+ * Fill the free in-flight slots, and complete the run once nothing is
+ * left to start or wait for.
+ */
+static void
+start_requests(AiBatchRunner *self)
+{
+    GCancellable *cancellable;
+    GTask *task;
+
+    cancellable = g_task_get_cancellable(self->task);
+
+    /* Requests not yet started fail with the cancellation */
+    if (g_cancellable_is_cancelled(cancellable))
+    {
+        while (self->next < self->items->len)
+        {
+            BatchItem *item = g_ptr_array_index(self->items, self->next);
+
+            g_cancellable_set_error_if_cancelled(cancellable, &item->error);
+            self->n_failed++;
+            self->next++;
+        }
+    }
+
+    while (self->in_flight < self->max_in_flight &&
+           self->next < self->items->len)
+    {
+        BatchItem *item = g_ptr_array_index(self->items, self->next);
+        ItemData *data;
+
+        data = g_slice_new0(ItemData);
+        data->runner = g_object_ref(self);
+        data->index = self->next;
+
+        self->next++;
+        self->in_flight++;
+
+        ai_provider_chat_async(self->provider,
+                               item->messages,
+                               item->system_prompt,
+                               item->max_tokens,
+                               item->tools,
+                               cancellable,
+                               on_request_finished,
+                               data);
+    }
+
+    if (self->in_flight > 0 || self->next < self->items->len)
+    {
+        return;
+    }
+
+    task = g_steal_pointer(&self->task);
+
+    if (!g_task_return_error_if_cancelled(task))
+    {
+        g_task_return_boolean(task, TRUE);
+    }
+
+    g_object_unref(task);
+}
+
+/**
+ * ai_batch_runner_run_async:
+ * @self: an #AiBatchRunner
+ * @cancellable: (nullable): a #GCancellable for the whole batch
+ * @callback: callback to call when every request has finished
+ * @user_data: user data for @callback
+ *
+ * Sends all requests in the batch through the provider, keeping at
+ * most #AiBatchRunner:max-in-flight of them in flight; connections are
+ * shared through the provider's session. Results from a previous run
+ * are discarded. Cancelling @cancellable aborts the requests in flight
+ * and fails the ones not yet started.
+ */
+void
+ai_batch_runner_run_async(
+    AiBatchRunner       *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    GTask *task;
+    guint i;
+
+    g_return_if_fail(AI_IS_BATCH_RUNNER(self));
+    g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_batch_runner_run_async);
+
+    if (self->task != NULL)
+    {
+        g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_PENDING,
+                                "The batch is already running");
+        g_object_unref(task);
+        return;
+    }
+
+    for (i = 0; i < self->items->len; i++)
+    {
+        batch_item_clear_result(g_ptr_array_index(self->items, i));
+    }
+
+    self->task = task;
+    self->next = 0;
+    self->in_flight = 0;
+    self->n_failed = 0;
+
+    start_requests(self);
+}
+
+/**
+ * ai_batch_runner_run_finish:
+ * @self: an #AiBatchRunner
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a batch run. Failures of individual requests do not fail
+ * the batch; check them with ai_batch_runner_get_error().
+ *
+ * Returns: %TRUE if the batch ran to completion, %FALSE if it was
+ *   cancelled or could not be started
+ */
+gboolean
+ai_batch_runner_run_finish(
+    AiBatchRunner  *self,
+    GAsyncResult   *result,
+    GError        **error
+){
+    g_return_val_if_fail(AI_IS_BATCH_RUNNER(self), FALSE);
+    g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+/**
+ * ai_batch_runner_get_response:
+ * @self: an #AiBatchRunner
+ * @index: the request index
+ *
+ * Gets the response to the request at @index.
+ *
+ * Returns: (transfer none) (nullable): the #AiResponse, or %NULL if the
+ *   request failed or has not finished
+ */
+AiResponse *
+ai_batch_runner_get_response(
+    AiBatchRunner *self,
+    guint          index
+){
+    BatchItem *item;
+
+    g_return_val_if_fail(AI_IS_BATCH_RUNNER(self), NULL);
+    g_return_val_if_fail(index < self->items->len, NULL);
+
+    item = g_ptr_array_index(self->items, index);
+    return item->response;
+}
+
+/**
+ * ai_batch_runner_get_error:
+ * @self: an #AiBatchRunner
+ * @index: the request index
+ *
+ * Gets the error of the request at @index.
+ *
+ * Returns: (transfer none) (nullable): the #GError, or %NULL if the
+ *   request succeeded or has not finished
+ */
+const GError *
+ai_batch_runner_get_error(
+    AiBatchRunner *self,
+    guint          index
+){
+    BatchItem *item;
+
+    g_return_val_if_fail(AI_IS_BATCH_RUNNER(self), NULL);
+    g_return_val_if_fail(index < self->items->len, NULL);
+
+    item = g_ptr_array_index(self->items, index);
+    return item->error;
+}
+
+/**
+ * ai_batch_runner_get_n_failed:
+ * @self: an #AiBatchRunner
+ *
+ * Gets the number of requests that failed in the last run.
+ *
+ * Returns: the number of failed requests
+ */
+guint
+ai_batch_runner_get_n_failed(AiBatchRunner *self)
+{
+    g_return_val_if_fail(AI_IS_BATCH_RUNNER(self), 0);
+
+    return self->n_failed;
+}
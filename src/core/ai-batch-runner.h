@@ -0,0 +1,234 @@
+/*
+ * ai-batch-runner.h - Bounded-concurrency fan-out of chat requests
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * AiBatchRunner sends many independent chat requests through one
+ * provider with a cap on the number in flight. Results are kept in
+ * input order, and a failed request does not fail the batch.
+ *
+ * Quick start:
+ *   g_autoptr(AiBatchRunner) batch = ai_batch_runner_new(provider);
+ *
+ *   ai_batch_runner_set_max_in_flight(batch, 8);
+ *   for (i = 0; i < n_docs; i++)
+ *       ai_batch_runner_add_prompt(batch, docs[i], "Classify the text.", 64);
+ *
+ *   ai_batch_runner_run_async(batch, NULL, on_batch_done, NULL);
+ *
+ *   // in on_batch_done:
+ *   ai_batch_runner_run_finish(batch, result, &error);
+ *   response = ai_batch_runner_get_response(batch, i);
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include "core/ai-provider.h"
+#include "model/ai-message.h"
+#include "model/ai-response.h"
+
+G_BEGIN_DECLS
+
+/**
+ * AI_BATCH_RUNNER_DEFAULT_MAX_IN_FLIGHT:
+ *
+ * Default number of requests a batch keeps in flight.
+ */
+#define AI_BATCH_RUNNER_DEFAULT_MAX_IN_FLIGHT (4)
+
+#define AI_TYPE_BATCH_RUNNER (ai_batch_runner_get_type())
+
+G_DECLARE_FINAL_TYPE(AiBatchRunner, ai_batch_runner, AI, BATCH_RUNNER, GObject)
+
+/**
+ * ai_batch_runner_new:
+ * @provider: the #AiProvider to send requests through
+ *
+ * Creates a new, empty batch for @provider.
+ *
+ * Returns: (transfer full): a new #AiBatchRunner
+ */
+AiBatchRunner *
+ai_batch_runner_new(AiProvider *provider);
+
+/**
+ * ai_batch_runner_get_provider:
+ * @self: an #AiBatchRunner
+ *
+ * Gets the provider requests are sent through.
+ *
+ * Returns: (transfer none): the #AiProvider
+ */
+AiProvider *
+ai_batch_runner_get_provider(AiBatchRunner *self);
+
+/**
+ * ai_batch_runner_get_max_in_flight:
+ * @self: an #AiBatchRunner
+ *
+ * Gets the maximum number of requests in flight at once.
+ *
+ * Returns: the limit
+ */
+guint
+ai_batch_runner_get_max_in_flight(AiBatchRunner *self);
+
+/**
+ * ai_batch_runner_set_max_in_flight:
+ * @self: an #AiBatchRunner
+ * @max_in_flight: the limit, at least 1
+ *
+ * Sets the maximum number of requests in flight at once. Takes effect
+ * for requests started after the call.
+ */
+void
+ai_batch_runner_set_max_in_flight(
+    AiBatchRunner *self,
+    guint          max_in_flight
+);
+
+/**
+ * ai_batch_runner_add_request:
+ * @self: an #AiBatchRunner
+ * @messages: (element-type AiMessage): the conversation messages
+ * @system_prompt: (nullable): the system prompt
+ * @max_tokens: the maximum number of tokens to generate
+ * @tools: (element-type AiTool) (nullable): the available tools
+ *
+ * Adds a request to the batch. The batch keeps references to the
+ * messages and tools.
+ *
+ * Returns: the index of the request, used to look up its result
+ */
+guint
+ai_batch_runner_add_request(
+    AiBatchRunner *self,
+    GList         *messages,
+    const gchar   *system_prompt,
+    gint           max_tokens,
+    GList         *tools
+);
+
+/**
+ * ai_batch_runner_add_prompt:
+ * @self: an #AiBatchRunner
+ * @prompt: the user prompt
+ * @system_prompt: (nullable): the system prompt
+ * @max_tokens: the maximum number of tokens to generate
+ *
+ * Adds a single-message request to the batch.
+ *
+ * Returns: the index of the request, used to look up its result
+ */
+guint
+ai_batch_runner_add_prompt(
+    AiBatchRunner *self,
+    const gchar   *prompt,
+    const gchar   *system_prompt,
+    gint           max_tokens
+);
+
+/**
+ * ai_batch_runner_get_n_requests:
+ * @self: an #AiBatchRunner
+ *
+ * Gets the number of requests in the batch.
+ *
+ * Returns: the number of requests
+ */
+guint
+ai_batch_runner_get_n_requests(AiBatchRunner *self);
+
+/**
+ * ai_batch_runner_run_async:
+ * @self: an #AiBatchRunner
+ * @cancellable: (nullable): a #GCancellable for the whole batch
+ * @callback: callback to call when every request has finished
+ * @user_data: user data for @callback
+ *
+ * Sends all requests in the batch, keeping at most
+ * #AiBatchRunner:max-in-flight of them in flight. Results from a
+ * previous run are discarded. Cancelling @cancellable aborts the
+ * requests in flight and fails the ones not yet started.
+ */
+void
+ai_batch_runner_run_async(
+    AiBatchRunner       *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+);
+
+/**
+ * ai_batch_runner_run_finish:
+ * @self: an #AiBatchRunner
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a batch run. Failures of individual requests do not fail
+ * the batch; check them with ai_batch_runner_get_error().
+ *
+ * Returns: %TRUE if the batch ran to completion, %FALSE if it was
+ *   cancelled or could not be started
+ */
+gboolean
+ai_batch_runner_run_finish(
+    AiBatchRunner  *self,
+    GAsyncResult   *result,
+    GError        **error
+);
+
+/**
+ * ai_batch_runner_get_response:
+ * @self: an #AiBatchRunner
+ * @index: the request index
+ *
+ * Gets the response to the request at @index.
+ *
+ * Returns: (transfer none) (nullable): the #AiResponse, or %NULL if the
+ *   request failed or has not finished
+ */
+AiResponse *
+ai_batch_runner_get_response(
+    AiBatchRunner *self,
+    guint          index
+);
+
+/**
+ * ai_batch_runner_get_error:
+ * @self: an #AiBatchRunner
+ * @index: the request index
+ *
+ * Gets the error of the request at @index.
+ *
+ * Returns: (transfer none) (nullable): the #GError, or %NULL if the
+ *   request succeeded or has not finished
+ */
+const GError *
+ai_batch_runner_get_error(
+    AiBatchRunner *self,
+    guint          index
+);
+
+/**
+ * ai_batch_runner_get_n_failed:
+ * @self: an #AiBatchRunner
+ *
+ * Gets the number of requests that failed in the last run.
+ *
+ * Returns: the number of failed requests
+ */
+guint
+ai_batch_runner_get_n_failed(AiBatchRunner *self);
+
+G_END_DECLS
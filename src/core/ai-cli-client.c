@@ -984,6 +984,11 @@ ai_cli_client_chat_sync(
                                        &stderr_data,
                                        error))
     {
+        /* Cancelled, possibly at a deadline: the CLI must not run on */
+        if (g_cancellable_is_cancelled(cancellable))
+        {
+            g_subprocess_force_exit(subprocess);
+        }
         return NULL;
     }
 
@@ -9,20 +9,45 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include "core/ai-client.h"
+#include "core/ai-balancer.h"
+#include "core/ai-deadline.h"
+#include "core/ai-delta-buffer.h"
 #include "core/ai-error.h"
+#include "core/ai-json-writer.h"
+#include "core/ai-prompt-scorer.h"
+#include "core/ai-rate-limiter.h"
+#include "core/ai-response-cache.h"
+#include "core/ai-retry.h"
+#include "core/ai-session-pool.h"
 
 /*
  * Private data for AiClient.
  */
 typedef struct
 {
-    AiConfig    *config;
-    SoupSession *session;
-    gchar       *model;
-    gchar       *system_prompt;
-    gint         max_tokens;
-    gdouble      temperature;
+    AiConfig        *config;
+    SoupSession     *session;
+    AiRateLimiter   *rate_limiter;
+    gsize            rate_limiter_init;
+    AiBalancer      *balancer;
+    GPtrArray       *endpoint_limiters;     /* element-type AiRateLimiter */
+    SoupSession    **endpoint_sessions;     /* one per endpoint, filled on first use */
+    gsize            balancer_init;
+    AiResponseCache *response_cache;
+    gboolean         coalesce_requests;
+    guint            delta_min_bytes;
+    guint            delta_max_delay;
+    gboolean         delta_flush_on_newline;
+    GMutex           flights_lock;
+    GHashTable      *flights;
+    gchar           *model;
+    gchar           *system_prompt;
+    gint             max_tokens;
+    gdouble          temperature;
+    gint             retry_count;
 } AiClientPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE(AiClient, ai_client, G_TYPE_OBJECT)
@@ -38,11 +63,27 @@ enum
     PROP_MAX_TOKENS,
     PROP_TEMPERATURE,
     PROP_SYSTEM_PROMPT,
+    PROP_RESPONSE_CACHE,
+    PROP_COALESCE_REQUESTS,
+    PROP_DELTA_MIN_BYTES,
+    PROP_DELTA_MAX_DELAY,
+    PROP_DELTA_FLUSH_ON_NEWLINE,
     N_PROPS
 };
 
 static GParamSpec *properties[N_PROPS];
 
+/*
+ * Signal IDs.
+ */
+enum
+{
+    SIGNAL_RETRY,
+    N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
 static void
 ai_client_finalize(GObject *object)
 {
@@ -51,6 +92,22 @@ ai_client_finalize(GObject *object)
 
     g_clear_object(&priv->config);
     g_clear_object(&priv->session);
+    g_clear_object(&priv->rate_limiter);
+    if (priv->endpoint_sessions != NULL)
+    {
+        guint i;
+
+        for (i = 0; i < ai_balancer_get_n_endpoints(priv->balancer); i++)
+        {
+            g_clear_object(&priv->endpoint_sessions[i]);
+        }
+        g_clear_pointer(&priv->endpoint_sessions, g_free);
+    }
+    g_clear_object(&priv->balancer);
+    g_clear_pointer(&priv->endpoint_limiters, g_ptr_array_unref);
+    g_clear_object(&priv->response_cache);
+    g_clear_pointer(&priv->flights, g_hash_table_unref);
+    g_mutex_clear(&priv->flights_lock);
     g_clear_pointer(&priv->model, g_free);
     g_clear_pointer(&priv->system_prompt, g_free);
 
@@ -84,6 +141,21 @@ ai_client_get_property(
         case PROP_SYSTEM_PROMPT:
             g_value_set_string(value, priv->system_prompt);
             break;
+        case PROP_RESPONSE_CACHE:
+            g_value_set_object(value, priv->response_cache);
+            break;
+        case PROP_COALESCE_REQUESTS:
+            g_value_set_boolean(value, priv->coalesce_requests);
+            break;
+        case PROP_DELTA_MIN_BYTES:
+            g_value_set_uint(value, priv->delta_min_bytes);
+            break;
+        case PROP_DELTA_MAX_DELAY:
+            g_value_set_uint(value, priv->delta_max_delay);
+            break;
+        case PROP_DELTA_FLUSH_ON_NEWLINE:
+            g_value_set_boolean(value, priv->delta_flush_on_newline);
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
@@ -120,6 +192,21 @@ ai_client_set_property(
             g_clear_pointer(&priv->system_prompt, g_free);
             priv->system_prompt = g_value_dup_string(value);
             break;
+        case PROP_RESPONSE_CACHE:
+            ai_client_set_response_cache(self, g_value_get_object(value));
+            break;
+        case PROP_COALESCE_REQUESTS:
+            ai_client_set_coalesce_requests(self, g_value_get_boolean(value));
+            break;
+        case PROP_DELTA_MIN_BYTES:
+            ai_client_set_delta_min_bytes(self, g_value_get_uint(value));
+            break;
+        case PROP_DELTA_MAX_DELAY:
+            ai_client_set_delta_max_delay(self, g_value_get_uint(value));
+            break;
+        case PROP_DELTA_FLUSH_ON_NEWLINE:
+            ai_client_set_delta_flush_on_newline(self, g_value_get_boolean(value));
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
@@ -140,9 +227,77 @@ ai_client_constructed(GObject *object)
         priv->config = ai_config_new();
     }
 
-    /* Create soup session */
-    priv->session = soup_session_new();
-    soup_session_set_timeout(priv->session, ai_config_get_timeout(priv->config));
+    /*
+     * The HTTP session is taken from the shared pool on first use, once
+     * the subclass can report its endpoint.
+     */
+
+    if (ai_config_get_prewarm(priv->config) &&
+        AI_CLIENT_GET_CLASS(self)->get_endpoint_url != NULL)
+    {
+        ai_client_prewarm_async(self, NULL, NULL, NULL);
+    }
+}
+
+/*
+ * Default implementation of build_request_body.
+ * Serializes the tree from build_request; subclasses override this to
+ * write the request straight from the messages instead.
+ */
+static GBytes *
+ai_client_real_build_request_body(
+    AiClient               *self,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    gboolean                stream
+){
+    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
+    g_autoptr(JsonNode) request_json = NULL;
+    g_autoptr(AiJsonWriter) writer = NULL;
+
+    if (klass->build_request == NULL)
+    {
+        return NULL;
+    }
+
+    request_json = klass->build_request(self, messages,
+                                        ai_request_options_get_system_prompt(options),
+                                        ai_request_options_get_max_tokens(options),
+                                        ai_request_options_get_tools(options));
+    if (request_json == NULL)
+    {
+        return NULL;
+    }
+
+    if (stream && JSON_NODE_HOLDS_OBJECT(request_json))
+    {
+        json_object_set_boolean_member(json_node_get_object(request_json),
+                                       "stream", TRUE);
+    }
+
+    writer = ai_json_writer_new(0);
+    ai_json_writer_add_node(writer, request_json);
+
+    return ai_json_writer_free_to_bytes(g_steal_pointer(&writer));
+}
+
+static gchar *
+ai_client_real_get_request_url(
+    AiClient               *self,
+    const AiRequestOptions *options,
+    gboolean                stream
+){
+    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
+
+    (void)options;
+    (void)stream;
+
+    if (klass->get_endpoint_url == NULL)
+    {
+        return NULL;
+    }
+
+    return klass->get_endpoint_url(self);
 }
 
 static void
@@ -161,6 +316,8 @@ ai_client_class_init(AiClientClass *klass)
     klass->get_endpoint_url = NULL;
     klass->add_auth_headers = NULL;
     klass->parse_stream_chunk = NULL;
+    klass->build_request_body = ai_client_real_build_request_body;
+    klass->get_request_url = ai_client_real_get_request_url;
 
     /**
      * AiClient:config:
@@ -223,7 +380,97 @@ ai_client_class_init(AiClientClass *klass)
                             NULL,
                             G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+    /**
+     * AiClient:response-cache:
+     *
+     * The cache chat responses are answered from, or %NULL.
+     */
+    properties[PROP_RESPONSE_CACHE] =
+        g_param_spec_object("response-cache",
+                            "Response Cache",
+                            "The cache chat responses are answered from",
+                            AI_TYPE_RESPONSE_CACHE,
+                            G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                            G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiClient:coalesce-requests:
+     *
+     * Whether identical concurrent chat requests share one HTTP request.
+     */
+    properties[PROP_COALESCE_REQUESTS] =
+        g_param_spec_boolean("coalesce-requests",
+                             "Coalesce Requests",
+                             "Whether identical concurrent chat requests share one HTTP request",
+                             FALSE,
+                             G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                             G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiClient:delta-min-bytes:
+     *
+     * How many bytes of streamed text are joined into one delta signal,
+     * or 0 to emit every delta as it arrives.
+     */
+    properties[PROP_DELTA_MIN_BYTES] =
+        g_param_spec_uint("delta-min-bytes",
+                          "Delta Min Bytes",
+                          "How many bytes of streamed text are joined into one delta signal",
+                          0, G_MAXUINT, 0,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiClient:delta-max-delay:
+     *
+     * How long, in milliseconds, joined text may wait for
+     * #AiClient:delta-min-bytes, or 0 for no limit.
+     */
+    properties[PROP_DELTA_MAX_DELAY] =
+        g_param_spec_uint("delta-max-delay",
+                          "Delta Max Delay",
+                          "How long joined text may wait, in milliseconds",
+                          0, G_MAXUINT, 50,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiClient:delta-flush-on-newline:
+     *
+     * Whether joined text is emitted at the end of each line.
+     */
+    properties[PROP_DELTA_FLUSH_ON_NEWLINE] =
+        g_param_spec_boolean("delta-flush-on-newline",
+                             "Delta Flush On Newline",
+                             "Whether joined text is emitted at the end of each line",
+                             TRUE,
+                             G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                             G_PARAM_STATIC_STRINGS);
+
     g_object_class_install_properties(object_class, N_PROPS, properties);
+
+    /**
+     * AiClient::retry:
+     * @self: the object that received the signal
+     * @attempt: the retry attempt about to be made, starting at 1
+     * @delay_ms: the delay in milliseconds before the attempt
+     * @error: the error that caused the retry
+     *
+     * Emitted when a request failed with a retryable error and will be
+     * sent again after @delay_ms. The number of retries per request is
+     * bounded by #AiConfig:max-retries.
+     */
+    signals[SIGNAL_RETRY] =
+        g_signal_new("retry",
+                     G_TYPE_FROM_CLASS(klass),
+                     G_SIGNAL_RUN_LAST,
+                     0,
+                     NULL, NULL,
+                     NULL,
+                     G_TYPE_NONE, 3,
+                     G_TYPE_UINT,
+                     G_TYPE_UINT,
+                     G_TYPE_ERROR);
 }
 
 static void
@@ -237,6 +484,11 @@ ai_client_init(AiClient *self)
     priv->system_prompt = NULL;
     priv->max_tokens = 4096;
     priv->temperature = 1.0;
+    priv->retry_count = 0;
+    priv->delta_max_delay = 50;
+    priv->delta_flush_on_newline = TRUE;
+    g_mutex_init(&priv->flights_lock);
+    priv->flights = g_hash_table_new(g_str_hash, g_str_equal);
 }
 
 /**
@@ -424,160 +676,2559 @@ ai_client_set_system_prompt(
     g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_SYSTEM_PROMPT]);
 }
 
+/*
+ * Get the pooled session for @url and keep it in @slot. In a thread
+ * with sessions of its own (a dispatcher worker), the session is looked
+ * up each time, since the client may be shared with other threads.
+ */
+static SoupSession *
+pool_session(
+    AiClient     *self,
+    SoupSession **slot,
+    const gchar  *url
+){
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+    SoupSession *session;
+
+    session = ai_session_pool_get_session(url,
+                                          ai_config_get_timeout(priv->config),
+                                          ai_config_get_max_connections(priv->config));
+
+    if (ai_session_pool_get_thread_local())
+    {
+        /* The thread's own table keeps the session alive */
+        g_object_unref(session);
+        return session;
+    }
+
+    if (!g_atomic_pointer_compare_and_exchange(slot, NULL, session))
+    {
+        /* Another thread got there first */
+        g_object_unref(session);
+        session = g_atomic_pointer_get(slot);
+    }
+
+    return session;
+}
+
+/*
+ * Get the pooled session for this client's endpoint, acquiring it on
+ * first use.
+ */
+static SoupSession *
+ensure_session(AiClient *self)
+{
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
+    g_autofree gchar *url = NULL;
+    SoupSession *session;
+
+    if (!ai_session_pool_get_thread_local())
+    {
+        session = g_atomic_pointer_get(&priv->session);
+        if (session != NULL)
+        {
+            return session;
+        }
+    }
+
+    if (klass->get_endpoint_url != NULL)
+    {
+        url = klass->get_endpoint_url(self);
+    }
+
+    return pool_session(self, &priv->session, url);
+}
+
 /**
  * ai_client_get_soup_session:
  * @self: an #AiClient
  *
- * Gets the SoupSession used for HTTP requests.
+ * Gets the SoupSession used for HTTP requests. The session comes from
+ * the process-wide pool and is shared with other clients talking to the
+ * same endpoint with the same timeout and connection limit, so it must
+ * not be reconfigured. In an #AiDispatcher worker thread, this is the
+ * worker's own session. With a pool of base URLs, this is the session
+ * of ai_config_get_base_url(); each URL has a session of its own.
  *
  * Returns: (transfer none): the #SoupSession
  */
 SoupSession *
 ai_client_get_soup_session(AiClient *self)
 {
-    AiClientPrivate *priv;
-
     g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
 
-    priv = ai_client_get_instance_private(self);
-    return priv->session;
+    return ensure_session(self);
+}
+
+/*
+ * Get the shared rate limiter of one provider account, with the limits
+ * from the config if any are set.
+ */
+static AiRateLimiter *
+get_account_rate_limiter(
+    AiClient       *self,
+    AiProviderType  type,
+    const gchar    *api_key
+){
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+    guint rpm = ai_config_get_requests_per_minute(priv->config);
+    guint itpm = ai_config_get_input_tokens_per_minute(priv->config);
+    guint otpm = ai_config_get_output_tokens_per_minute(priv->config);
+    AiRateLimiter *limiter;
+
+    limiter = ai_rate_limiter_get_shared(type, api_key);
+
+    if (rpm > 0 || itpm > 0 || otpm > 0)
+    {
+        ai_rate_limiter_set_limits(limiter, rpm, itpm, otpm);
+    }
+
+    return limiter;
+}
+
+/*
+ * Get the shared rate limiter for this client's provider account,
+ * looking it up on first use. Clients that are not providers (and so
+ * have no account) are not rate limited.
+ */
+static AiRateLimiter *
+ensure_rate_limiter(AiClient *self)
+{
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+
+    if (g_once_init_enter(&priv->rate_limiter_init))
+    {
+        if (AI_IS_PROVIDER(self))
+        {
+            AiProviderType type = ai_provider_get_provider_type(AI_PROVIDER(self));
+
+            priv->rate_limiter = get_account_rate_limiter(
+                self, type, ai_config_get_api_key(priv->config, type));
+        }
+
+        g_once_init_leave(&priv->rate_limiter_init, 1);
+    }
+
+    return priv->rate_limiter;
 }
 
 /**
- * ai_client_chat_sync:
+ * ai_client_get_rate_limiter:
  * @self: an #AiClient
- * @messages: (element-type AiMessage): the conversation messages
- * @cancellable: (nullable): a #GCancellable
- * @error: (out) (optional): return location for a #GError
  *
- * Performs a synchronous chat completion request.
- * This is a convenience method that calls the async methods internally.
+ * Gets the rate limiter requests from this client wait on. It is
+ * shared by all clients of the same provider and API key.
  *
- * Returns: (transfer full) (nullable): the #AiResponse, or %NULL on error
+ * Returns: (transfer none) (nullable): the #AiRateLimiter, or %NULL if
+ *   the client is not a provider and is not rate limited
  */
-AiResponse *
-ai_client_chat_sync(
-    AiClient      *self,
-    GList         *messages,
-    GCancellable  *cancellable,
-    GError       **error
-){
-    AiClientClass *klass;
-    AiClientPrivate *priv;
-    g_autoptr(JsonNode) request_json = NULL;
-    g_autoptr(SoupMessage) msg = NULL;
-    g_autofree gchar *url = NULL;
-    g_autofree gchar *request_body = NULL;
-    g_autoptr(GBytes) response_bytes = NULL;
-    g_autoptr(JsonParser) parser = NULL;
-    JsonNode *response_json;
-    const gchar *response_data;
-    gsize response_len;
-
+AiRateLimiter *
+ai_client_get_rate_limiter(AiClient *self)
+{
     g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
 
-    klass = AI_CLIENT_GET_CLASS(self);
-    priv = ai_client_get_instance_private(self);
+    return ensure_rate_limiter(self);
+}
 
-    g_return_val_if_fail(klass->build_request != NULL, NULL);
-    g_return_val_if_fail(klass->parse_response != NULL, NULL);
-    g_return_val_if_fail(klass->get_endpoint_url != NULL, NULL);
+/*
+ * Build the balancer on first use, if the config pools more than one
+ * key or base URL for this client's provider. Each endpoint waits on
+ * the rate limiter of its own key.
+ */
+static AiBalancer *
+ensure_balancer(AiClient *self)
+{
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
 
-    /* Build request */
-    request_json = klass->build_request(self, messages, priv->system_prompt,
-                                        priv->max_tokens, NULL);
-    if (request_json == NULL)
+    if (g_once_init_enter(&priv->balancer_init))
     {
-        g_set_error(error, AI_ERROR, AI_ERROR_INVALID_REQUEST,
-                    "Failed to build request");
-        return NULL;
+        if (AI_IS_PROVIDER(self))
+        {
+            AiProviderType type = ai_provider_get_provider_type(AI_PROVIDER(self));
+            const gchar *const *api_keys = ai_config_get_api_keys(priv->config, type);
+            const gchar *const *base_urls = ai_config_get_base_urls(priv->config, type);
+            const gchar *one_key[] = { ai_config_get_api_key(priv->config, type), NULL };
+            const gchar *one_url[] = { ai_config_get_base_url(priv->config, type), NULL };
+            AiBalancer *balancer = NULL;
+            guint i;
+
+            if ((api_keys != NULL || base_urls != NULL) && one_url[0] != NULL)
+            {
+                balancer = ai_balancer_new(api_keys != NULL ? api_keys : one_key,
+                                           base_urls != NULL ? base_urls : one_url);
+            }
+
+            if (balancer != NULL && ai_balancer_get_n_endpoints(balancer) > 1)
+            {
+                priv->balancer = g_steal_pointer(&balancer);
+                priv->endpoint_limiters = g_ptr_array_new_with_free_func(g_object_unref);
+                priv->endpoint_sessions = g_new0(SoupSession *,
+                                                 ai_balancer_get_n_endpoints(priv->balancer));
+
+                for (i = 0; i < ai_balancer_get_n_endpoints(priv->balancer); i++)
+                {
+                    g_ptr_array_add(priv->endpoint_limiters,
+                                    get_account_rate_limiter(
+                                        self, type,
+                                        ai_balancer_get_api_key(priv->balancer, i)));
+                }
+            }
+
+            g_clear_object(&balancer);
+        }
+
+        g_once_init_leave(&priv->balancer_init, 1);
     }
 
-    /* Serialize to JSON string */
+    return priv->balancer;
+}
+
+/**
+ * ai_client_get_balancer:
+ * @self: an #AiClient
+ *
+ * Gets the balancer requests are spread over the config's pooled keys
+ * and base URLs with.
+ *
+ * Returns: (transfer none) (nullable): the #AiBalancer, or %NULL if
+ *   there is only one endpoint
+ */
+AiBalancer *
+ai_client_get_balancer(AiClient *self)
+{
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+
+    return ensure_balancer(self);
+}
+
+/*
+ * The balancer endpoint a message is routed to, plus one, so 0 means
+ * it still has the config's own key and base URL.
+ */
+static GQuark
+message_endpoint_quark(void)
+{
+    return g_quark_from_static_string("ai-client-message-endpoint");
+}
+
+static guint
+get_message_endpoint(SoupMessage *msg)
+{
+    return GPOINTER_TO_UINT(g_object_get_qdata(G_OBJECT(msg), message_endpoint_quark()));
+}
+
+/*
+ * Point @msg at balancer endpoint @index. The base URL it was built
+ * with is a prefix of its URI and is swapped for the endpoint's; the
+ * key goes through the set_api_key hook, which knows where the
+ * provider passes it.
+ */
+static void
+route_message(
+    AiClient    *self,
+    SoupMessage *msg,
+    guint        index
+){
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
+    AiProviderType type = ai_provider_get_provider_type(AI_PROVIDER(self));
+    guint current = get_message_endpoint(msg);
+    g_autofree gchar *uri = NULL;
+    const gchar *from_url;
+    const gchar *to_key;
+    const gchar *to_url;
+    GUri *parsed;
+
+    if (current == index + 1)
     {
-        g_autoptr(JsonGenerator) gen = json_generator_new();
-        json_generator_set_root(gen, request_json);
-        request_body = json_generator_to_data(gen, NULL);
+        return;
     }
 
-    /* Get endpoint URL */
-    url = klass->get_endpoint_url(self);
-    if (url == NULL)
+    if (current == 0)
     {
-        g_set_error(error, AI_ERROR, AI_ERROR_CONFIGURATION_ERROR,
-                    "Failed to get endpoint URL");
-        return NULL;
+        from_url = ai_config_get_base_url(priv->config, type);
     }
-
-    /* Create HTTP request */
-    msg = soup_message_new("POST", url);
-    if (msg == NULL)
+    else
     {
-        g_set_error(error, AI_ERROR, AI_ERROR_INVALID_REQUEST,
-                    "Failed to create HTTP request for URL: %s", url);
-        return NULL;
+        from_url = ai_balancer_get_base_url(priv->balancer, current - 1);
     }
+    to_key = ai_balancer_get_api_key(priv->balancer, index);
+    to_url = ai_balancer_get_base_url(priv->balancer, index);
 
-    /* Set headers */
-    soup_message_headers_append(soup_message_get_request_headers(msg),
-                                "Content-Type", "application/json");
-
-    /* Add auth headers */
-    if (klass->add_auth_headers != NULL)
+    uri = g_uri_to_string(soup_message_get_uri(msg));
+    if (from_url != NULL && g_strcmp0(from_url, to_url) != 0 &&
+        g_str_has_prefix(uri, from_url))
     {
-        klass->add_auth_headers(self, msg);
-    }
+        g_autofree gchar *routed = g_strconcat(to_url, uri + strlen(from_url), NULL);
 
-    /* Set request body */
-    soup_message_set_request_body_from_bytes(msg, "application/json",
-        g_bytes_new(request_body, strlen(request_body)));
+        parsed = g_uri_parse(routed, SOUP_HTTP_URI_FLAGS, NULL);
+        if (parsed != NULL)
+        {
+            soup_message_set_uri(msg, parsed);
+            g_uri_unref(parsed);
+        }
+    }
 
-    /* Send request */
-    response_bytes = soup_session_send_and_read(priv->session, msg, cancellable, error);
-    if (response_bytes == NULL)
+    if (to_key != NULL && klass->set_api_key != NULL)
     {
-        return NULL;
+        klass->set_api_key(self, msg, to_key);
     }
 
-    /* Check HTTP status */
-    if (!SOUP_STATUS_IS_SUCCESSFUL(soup_message_get_status(msg)))
-    {
-        guint status = soup_message_get_status(msg);
+    g_object_set_qdata(G_OBJECT(msg), message_endpoint_quark(), GUINT_TO_POINTER(index + 1));
+}
 
-        if (status == 401 || status == 403)
-        {
-            g_set_error(error, AI_ERROR, AI_ERROR_INVALID_API_KEY,
-                        "Authentication failed (HTTP %u)", status);
-        }
-        else if (status == 429)
-        {
-            g_set_error(error, AI_ERROR, AI_ERROR_RATE_LIMITED,
-                        "Rate limited (HTTP %u)", status);
-        }
-        else if (status >= 500)
-        {
-            g_set_error(error, AI_ERROR, AI_ERROR_SERVER_ERROR,
-                        "Server error (HTTP %u)", status);
-        }
-        else
-        {
-            g_set_error(error, AI_ERROR, AI_ERROR_NETWORK_ERROR,
-                        "Request failed (HTTP %u)", status);
-        }
+/*
+ * Pick the endpoint for the next attempt of @msg and route it there.
+ */
+static void
+balance_message(
+    AiClient    *self,
+    SoupMessage *msg
+){
+    AiBalancer *balancer = ensure_balancer(self);
 
-        return NULL;
+    if (balancer != NULL)
+    {
+        route_message(self, msg, ai_balancer_acquire(balancer));
     }
+}
 
-    /* Parse response */
-    response_data = g_bytes_get_data(response_bytes, &response_len);
-    parser = json_parser_new();
+/*
+ * End the attempt of @msg at its endpoint. @sent_at is when it went to
+ * the network, or 0 if it never did.
+ */
+static void
+release_message_endpoint(
+    AiClient    *self,
+    SoupMessage *msg,
+    gint64       sent_at
+){
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+    guint endpoint = get_message_endpoint(msg);
 
-    if (!json_parser_load_from_data(parser, response_data, response_len, error))
+    if (endpoint == 0)
     {
-        return NULL;
+        return;
     }
 
-    response_json = json_parser_get_root(parser);
+    ai_balancer_release(priv->balancer, endpoint - 1,
+                        soup_message_get_status(msg),
+                        sent_at != 0 ? g_get_monotonic_time() - sent_at : 0);
+}
+
+/*
+ * The rate limiter an attempt of @msg waits on: that of the key it is
+ * routed to.
+ */
+static AiRateLimiter *
+get_message_rate_limiter(
+    AiClient    *self,
+    SoupMessage *msg
+){
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+    guint endpoint = get_message_endpoint(msg);
+
+    if (endpoint == 0)
+    {
+        return ensure_rate_limiter(self);
+    }
+
+    return g_ptr_array_index(priv->endpoint_limiters, endpoint - 1);
+}
+
+/*
+ * The session an attempt of @msg is sent on: that of the base URL it is
+ * routed to, so each URL of the pool has its own connection limit.
+ */
+static SoupSession *
+get_message_session(
+    AiClient    *self,
+    SoupMessage *msg
+){
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+    guint endpoint = get_message_endpoint(msg);
+    SoupSession *session;
+
+    if (endpoint == 0)
+    {
+        return ensure_session(self);
+    }
+
+    if (!ai_session_pool_get_thread_local())
+    {
+        session = g_atomic_pointer_get(&priv->endpoint_sessions[endpoint - 1]);
+        if (session != NULL)
+        {
+            return session;
+        }
+    }
+
+    return pool_session(self, &priv->endpoint_sessions[endpoint - 1],
+                        ai_balancer_get_base_url(priv->balancer, endpoint - 1));
+}
+
+/*
+ * Feed a response's rate-limit headers back to the limiter.
+ */
+static void
+update_rate_limits(
+    AiClient    *self,
+    SoupMessage *msg
+){
+    AiRateLimiter *limiter = get_message_rate_limiter(self, msg);
+
+    if (limiter != NULL && soup_message_get_status(msg) != SOUP_STATUS_NONE)
+    {
+        ai_rate_limiter_update_from_headers(limiter, soup_message_get_response_headers(msg));
+    }
+}
+
+static gint get_message_max_tokens(SoupMessage *msg);
+
+/*
+ * Estimate what a request costs against the token limits: its body
+ * for input, and its max_tokens for output, which providers also
+ * reserve up front. Messages not built by ai_client_create_request()
+ * fall back to the client's max_tokens.
+ */
+static void
+estimate_request_cost(
+    AiClient    *self,
+    SoupMessage *msg,
+    GBytes      *body,
+    guint       *input_tokens,
+    guint       *output_tokens
+){
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+    gint max_tokens;
+
+    if (body == NULL)
+    {
+        *input_tokens = 0;
+        *output_tokens = 0;
+        return;
+    }
+
+    max_tokens = get_message_max_tokens(msg);
+    if (max_tokens <= 0)
+    {
+        max_tokens = priv->max_tokens;
+    }
+
+    *input_tokens = ai_prompt_estimate_tokens(g_bytes_get_size(body));
+    *output_tokens = (guint)MAX(max_tokens, 0);
+}
+
+/**
+ * ai_client_get_response_cache:
+ * @self: an #AiClient
+ *
+ * Gets the cache chat responses are answered from.
+ *
+ * Returns: (transfer none) (nullable): the #AiResponseCache, or %NULL
+ */
+AiResponseCache *
+ai_client_get_response_cache(AiClient *self)
+{
+    AiClientPrivate *priv;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+
+    priv = ai_client_get_instance_private(self);
+    return priv->response_cache;
+}
+
+/**
+ * ai_client_set_response_cache:
+ * @self: an #AiClient
+ * @cache: (nullable): an #AiResponseCache, or %NULL to disable caching
+ *
+ * Sets the cache chat responses are answered from. Only successful
+ * responses to the client's chat endpoint are cached; streaming
+ * requests always go to the network.
+ */
+void
+ai_client_set_response_cache(
+    AiClient        *self,
+    AiResponseCache *cache
+){
+    AiClientPrivate *priv;
+
+    g_return_if_fail(AI_IS_CLIENT(self));
+    g_return_if_fail(cache == NULL || AI_IS_RESPONSE_CACHE(cache));
+
+    priv = ai_client_get_instance_private(self);
+
+    if (g_set_object(&priv->response_cache, cache))
+    {
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_RESPONSE_CACHE]);
+    }
+}
+
+/**
+ * ai_client_get_coalesce_requests:
+ * @self: an #AiClient
+ *
+ * Gets whether identical concurrent chat requests share one HTTP request.
+ *
+ * Returns: %TRUE if requests are coalesced
+ */
+gboolean
+ai_client_get_coalesce_requests(AiClient *self)
+{
+    AiClientPrivate *priv;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), FALSE);
+
+    priv = ai_client_get_instance_private(self);
+    return priv->coalesce_requests;
+}
+
+/**
+ * ai_client_set_coalesce_requests:
+ * @self: an #AiClient
+ * @coalesce: whether to coalesce identical requests
+ *
+ * Sets whether identical concurrent chat requests share one HTTP
+ * request. Requests already in flight are not affected.
+ */
+void
+ai_client_set_coalesce_requests(
+    AiClient *self,
+    gboolean  coalesce
+){
+    AiClientPrivate *priv;
+
+    g_return_if_fail(AI_IS_CLIENT(self));
+
+    priv = ai_client_get_instance_private(self);
+    coalesce = !!coalesce;
+
+    if (priv->coalesce_requests != coalesce)
+    {
+        priv->coalesce_requests = coalesce;
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_COALESCE_REQUESTS]);
+    }
+}
+
+/**
+ * ai_client_get_delta_min_bytes:
+ * @self: an #AiClient
+ *
+ * Gets how many bytes of streamed text are joined into one delta.
+ *
+ * Returns: the number of bytes, or 0 if deltas are not joined
+ */
+guint
+ai_client_get_delta_min_bytes(AiClient *self)
+{
+    AiClientPrivate *priv;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), 0);
+
+    priv = ai_client_get_instance_private(self);
+    return priv->delta_min_bytes;
+}
+
+/**
+ * ai_client_set_delta_min_bytes:
+ * @self: an #AiClient
+ * @min_bytes: the number of bytes, or 0 to emit every delta
+ *
+ * Sets how many bytes of streamed text are joined into one delta.
+ * Streams already running are not affected.
+ */
+void
+ai_client_set_delta_min_bytes(
+    AiClient *self,
+    guint     min_bytes
+){
+    AiClientPrivate *priv;
+
+    g_return_if_fail(AI_IS_CLIENT(self));
+
+    priv = ai_client_get_instance_private(self);
+
+    if (priv->delta_min_bytes != min_bytes)
+    {
+        priv->delta_min_bytes = min_bytes;
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_DELTA_MIN_BYTES]);
+    }
+}
+
+/**
+ * ai_client_get_delta_max_delay:
+ * @self: an #AiClient
+ *
+ * Gets how long joined text may wait.
+ *
+ * Returns: the delay in milliseconds, or 0 for no limit
+ */
+guint
+ai_client_get_delta_max_delay(AiClient *self)
+{
+    AiClientPrivate *priv;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), 0);
+
+    priv = ai_client_get_instance_private(self);
+    return priv->delta_max_delay;
+}
+
+/**
+ * ai_client_set_delta_max_delay:
+ * @self: an #AiClient
+ * @delay_ms: the delay in milliseconds, or 0 for no limit
+ *
+ * Sets how long joined text may wait.
+ */
+void
+ai_client_set_delta_max_delay(
+    AiClient *self,
+    guint     delay_ms
+){
+    AiClientPrivate *priv;
+
+    g_return_if_fail(AI_IS_CLIENT(self));
+
+    priv = ai_client_get_instance_private(self);
+
+    if (priv->delta_max_delay != delay_ms)
+    {
+        priv->delta_max_delay = delay_ms;
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_DELTA_MAX_DELAY]);
+    }
+}
+
+/**
+ * ai_client_get_delta_flush_on_newline:
+ * @self: an #AiClient
+ *
+ * Gets whether joined text is emitted at the end of each line.
+ *
+ * Returns: %TRUE if a newline emits the joined text
+ */
+gboolean
+ai_client_get_delta_flush_on_newline(AiClient *self)
+{
+    AiClientPrivate *priv;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), FALSE);
+
+    priv = ai_client_get_instance_private(self);
+    return priv->delta_flush_on_newline;
+}
+
+/**
+ * ai_client_set_delta_flush_on_newline:
+ * @self: an #AiClient
+ * @flush: whether a newline emits the joined text
+ *
+ * Sets whether joined text is emitted at the end of each line.
+ */
+void
+ai_client_set_delta_flush_on_newline(
+    AiClient *self,
+    gboolean  flush
+){
+    AiClientPrivate *priv;
+
+    g_return_if_fail(AI_IS_CLIENT(self));
+
+    priv = ai_client_get_instance_private(self);
+    flush = !!flush;
+
+    if (priv->delta_flush_on_newline != flush)
+    {
+        priv->delta_flush_on_newline = flush;
+        g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_DELTA_FLUSH_ON_NEWLINE]);
+    }
+}
+
+/**
+ * ai_client_create_delta_buffer:
+ * @self: an #AiClient that implements #AiStreamable
+ * @options: (nullable): the request's #AiRequestOptions
+ *
+ * Creates the buffer one stream emits its events through, set up from
+ * the client's delta-* properties and routed to the stream in @options.
+ *
+ * Returns: (transfer full): a new #AiDeltaBuffer
+ */
+AiDeltaBuffer *
+ai_client_create_delta_buffer(
+    AiClient               *self,
+    const AiRequestOptions *options
+){
+    AiClientPrivate *priv;
+    AiDeltaBuffer *buffer;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+    g_return_val_if_fail(AI_IS_STREAMABLE(self), NULL);
+
+    priv = ai_client_get_instance_private(self);
+
+    buffer = ai_delta_buffer_new(AI_STREAMABLE(self),
+                                 priv->delta_min_bytes,
+                                 priv->delta_max_delay,
+                                 priv->delta_flush_on_newline);
+    if (options != NULL)
+    {
+        ai_delta_buffer_set_stream(buffer, ai_request_options_get_stream(options));
+    }
+
+    return buffer;
+}
+
+/*
+ * Get the key identifying @msg for the response cache and request
+ * coalescing, or %NULL if neither applies. Only POSTs to the chat
+ * endpoint qualify, so batch submissions, uploads and image requests
+ * sent through the same path are never replayed or shared.
+ */
+static gchar *
+get_request_key(
+    AiClient    *self,
+    SoupMessage *msg,
+    GBytes      *body
+){
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
+    g_autofree gchar *url = NULL;
+    g_autoptr(GUri) endpoint = NULL;
+
+    if ((priv->response_cache == NULL && !priv->coalesce_requests) ||
+        body == NULL || klass->get_endpoint_url == NULL ||
+        g_strcmp0(soup_message_get_method(msg), SOUP_METHOD_POST) != 0)
+    {
+        return NULL;
+    }
+
+    url = klass->get_endpoint_url(self);
+    if (url == NULL)
+    {
+        return NULL;
+    }
+
+    endpoint = g_uri_parse(url, SOUP_HTTP_URI_FLAGS, NULL);
+    if (endpoint == NULL || !soup_uri_equal(endpoint, soup_message_get_uri(msg)))
+    {
+        return NULL;
+    }
+
+    return ai_response_cache_compute_key(url, body);
+}
+
+/*
+ * Extract a human-readable message from a provider error body.
+ * Handles {"error": {"message": ...}}, {"error": "..."} and {"message": ...}.
+ */
+static gchar *
+extract_error_message(GBytes *body)
+{
+    g_autoptr(JsonParser) parser = NULL;
+    const gchar *data;
+    gsize len;
+    JsonNode *root;
+    JsonObject *obj;
+
+    if (body == NULL)
+    {
+        return NULL;
+    }
+
+    data = g_bytes_get_data(body, &len);
+    if (len == 0)
+    {
+        return NULL;
+    }
+
+    parser = json_parser_new();
+    if (!json_parser_load_from_data(parser, data, len, NULL))
+    {
+        return NULL;
+    }
+
+    root = json_parser_get_root(parser);
+    if (root == NULL || !JSON_NODE_HOLDS_OBJECT(root))
+    {
+        return NULL;
+    }
+
+    obj = json_node_get_object(root);
+
+    if (json_object_has_member(obj, "error"))
+    {
+        JsonNode *err = json_object_get_member(obj, "error");
+
+        if (JSON_NODE_HOLDS_OBJECT(err))
+        {
+            return g_strdup(json_object_get_string_member_with_default(
+                json_node_get_object(err), "message", NULL));
+        }
+
+        if (JSON_NODE_HOLDS_VALUE(err) && json_node_get_value_type(err) == G_TYPE_STRING)
+        {
+            return g_strdup(json_node_get_string(err));
+        }
+    }
+
+    return g_strdup(json_object_get_string_member_with_default(obj, "message", NULL));
+}
+
+/*
+ * Map a non-2xx HTTP status to an AI_ERROR.
+ */
+static void
+set_http_error(
+    GError **error,
+    guint    status,
+    GBytes  *body
+){
+    g_autofree gchar *detail = NULL;
+    const gchar *what;
+    AiError code;
+
+    if (status == 401 || status == 403)
+    {
+        code = AI_ERROR_INVALID_API_KEY;
+        what = "Authentication failed";
+    }
+    else if (status == 429)
+    {
+        code = AI_ERROR_RATE_LIMITED;
+        what = "Rate limited";
+    }
+    else if (status == 503 || status == 529)
+    {
+        code = AI_ERROR_SERVICE_UNAVAILABLE;
+        what = "Service unavailable";
+    }
+    else if (status >= 500)
+    {
+        code = AI_ERROR_SERVER_ERROR;
+        what = "Server error";
+    }
+    else
+    {
+        code = AI_ERROR_NETWORK_ERROR;
+        what = "Request failed";
+    }
+
+    detail = extract_error_message(body);
+    if (detail != NULL)
+    {
+        g_set_error(error, AI_ERROR, code, "%s (HTTP %u): %s", what, status, detail);
+    }
+    else
+    {
+        g_set_error(error, AI_ERROR, code, "%s (HTTP %u)", what, status);
+    }
+}
+
+/*
+ * Check whether a failed attempt may be retried.
+ */
+static gboolean
+should_retry(
+    AiClient     *self,
+    guint         attempt,
+    guint         status,
+    const GError *error
+){
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+
+    if (attempt >= ai_config_get_max_retries(priv->config))
+    {
+        return FALSE;
+    }
+
+    if (status == SOUP_STATUS_NONE)
+    {
+        return ai_retry_is_retryable_error(error, status);
+    }
+
+    return ai_retry_is_retryable_status(status);
+}
+
+/*
+ * Record a retry and emit AiClient::retry.
+ */
+static void
+notify_retry(
+    AiClient     *self,
+    guint         attempt,
+    guint         delay_ms,
+    const GError *error
+){
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+
+    g_atomic_int_inc(&priv->retry_count);
+
+    g_debug("Retrying request (attempt %u) in %u ms: %s",
+            attempt, delay_ms, error != NULL ? error->message : "unknown error");
+
+    g_signal_emit(self, signals[SIGNAL_RETRY], 0, attempt, delay_ms, error);
+}
+
+/*
+ * The deadline of the request a message was built for. It travels on
+ * the message so the send functions, which only see the message, know
+ * when retrying is no longer worth it.
+ */
+static GQuark
+message_deadline_quark(void)
+{
+    return g_quark_from_static_string("ai-client-message-deadline");
+}
+
+static void
+set_message_deadline(
+    SoupMessage *msg,
+    gint64       deadline
+){
+    gint64 *value = g_new(gint64, 1);
+
+    *value = deadline;
+    g_object_set_qdata_full(G_OBJECT(msg), message_deadline_quark(), value, g_free);
+}
+
+static gint64
+get_message_deadline(SoupMessage *msg)
+{
+    gint64 *value = g_object_get_qdata(G_OBJECT(msg), message_deadline_quark());
+
+    return value != NULL ? *value : 0;
+}
+
+/*
+ * The max_tokens the request was built with, after the router tier or
+ * the caller's options, for the output side of the token limits.
+ */
+static GQuark
+message_max_tokens_quark(void)
+{
+    return g_quark_from_static_string("ai-client-message-max-tokens");
+}
+
+static void
+set_message_max_tokens(
+    SoupMessage *msg,
+    gint         max_tokens
+){
+    g_object_set_qdata(G_OBJECT(msg), message_max_tokens_quark(),
+                       GINT_TO_POINTER(max_tokens));
+}
+
+static gint
+get_message_max_tokens(SoupMessage *msg)
+{
+    return GPOINTER_TO_INT(g_object_get_qdata(G_OBJECT(msg), message_max_tokens_quark()));
+}
+
+/*
+ * Check whether waiting @delay_ms for a retry would run into @deadline.
+ */
+static gboolean
+retry_misses_deadline(
+    gint64 deadline,
+    guint  delay_ms
+){
+    return deadline != 0 &&
+           g_get_monotonic_time() + (gint64)delay_ms * 1000 >= deadline;
+}
+
+/*
+ * Create a fresh message with the same method, URI, headers and flags.
+ * A message that has been sent carries response state, so each retry
+ * goes out on a copy.
+ */
+static SoupMessage *
+copy_message(SoupMessage *msg)
+{
+    SoupMessage *copy;
+    SoupMessageHeadersIter iter;
+    const gchar *name;
+    const gchar *value;
+
+    copy = soup_message_new_from_uri(soup_message_get_method(msg),
+                                     soup_message_get_uri(msg));
+
+    soup_message_headers_iter_init(&iter, soup_message_get_request_headers(msg));
+    while (soup_message_headers_iter_next(&iter, &name, &value))
+    {
+        soup_message_headers_append(soup_message_get_request_headers(copy), name, value);
+    }
+
+    soup_message_set_flags(copy, soup_message_get_flags(msg));
+
+    if (get_message_deadline(msg) != 0)
+    {
+        set_message_deadline(copy, get_message_deadline(msg));
+    }
+    set_message_max_tokens(copy, get_message_max_tokens(msg));
+
+    /* The copy is where the message was routed to, until routed again */
+    g_object_set_qdata(G_OBJECT(copy), message_endpoint_quark(),
+                       GUINT_TO_POINTER(get_message_endpoint(msg)));
+
+    return copy;
+}
+
+/*
+ * Wait @delay_ms before retrying, returning early if @cancellable fires.
+ */
+static gboolean
+wait_for_retry(
+    guint          delay_ms,
+    GCancellable  *cancellable,
+    GError       **error
+){
+    GPollFD pollfd;
+
+    if (cancellable != NULL && g_cancellable_make_pollfd(cancellable, &pollfd))
+    {
+        g_poll(&pollfd, 1, (gint)delay_ms);
+        g_cancellable_release_fd(cancellable);
+    }
+    else
+    {
+        g_usleep((gulong)delay_ms * 1000);
+    }
+
+    return !g_cancellable_set_error_if_cancelled(cancellable, error);
+}
+
+/*
+ * State for one retrying send.
+ */
+typedef struct
+{
+    SoupMessage *msg;
+    GBytes      *body;
+    gboolean     read_body;
+    guint        attempt;
+    guint        input_tokens;
+    guint        output_tokens;
+    gchar       *cache_key;
+    AiTiming    *timing;
+    gint64       deadline;      /* 0 for none */
+    gint64       sent_at;       /* when the attempt went to the network */
+} SendData;
+
+/*
+ * Attach the request body for an attempt. Bodies default to JSON, but a
+ * Content-Type set by the caller (e.g. a multipart upload) is kept.
+ */
+static void
+set_request_body(
+    SoupMessage *msg,
+    GBytes      *body
+){
+    SoupMessageHeaders *headers = soup_message_get_request_headers(msg);
+    const gchar *content_type = NULL;
+
+    if (soup_message_headers_get_one(headers, "Content-Type") == NULL)
+    {
+        content_type = "application/json";
+    }
+
+    soup_message_set_request_body_from_bytes(msg, content_type, body);
+}
+
+/*
+ * The length of a libsoup metrics interval, or 0 if it did not happen.
+ */
+static gint64
+metrics_span(
+    guint64 start,
+    guint64 end
+){
+    if (start == 0 || end < start)
+    {
+        return 0;
+    }
+
+    return (gint64)(end - start);
+}
+
+/*
+ * Fill the network phases of @timing from the metrics of the attempt
+ * that produced the response. libsoup stamps its metrics with
+ * g_get_monotonic_time(), the clock @timing starts on.
+ */
+static void
+fill_timing(
+    AiTiming    *timing,
+    SoupMessage *msg
+){
+    SoupMessageMetrics *metrics = soup_message_get_metrics(msg);
+    guint64 network_start;
+    guint64 tls_start;
+    guint64 connect_end;
+
+    if (metrics == NULL)
+    {
+        return;
+    }
+
+    network_start = soup_message_metrics_get_dns_start(metrics);
+    if (network_start == 0)
+    {
+        network_start = soup_message_metrics_get_connect_start(metrics);
+    }
+    if (network_start == 0)
+    {
+        network_start = soup_message_metrics_get_request_start(metrics);
+    }
+    if (network_start != 0)
+    {
+        ai_timing_set_duration(timing, AI_TIMING_QUEUED,
+                               (gint64)network_start - ai_timing_get_start_time(timing));
+    }
+
+    ai_timing_set_duration(timing, AI_TIMING_DNS,
+                           metrics_span(soup_message_metrics_get_dns_start(metrics),
+                                        soup_message_metrics_get_dns_end(metrics)));
+
+    /* connect_end includes the TLS handshake */
+    tls_start = soup_message_metrics_get_tls_start(metrics);
+    connect_end = soup_message_metrics_get_connect_end(metrics);
+    ai_timing_set_duration(timing, AI_TIMING_CONNECT,
+                           metrics_span(soup_message_metrics_get_connect_start(metrics),
+                                        tls_start != 0 ? tls_start : connect_end));
+    ai_timing_set_duration(timing, AI_TIMING_TLS, metrics_span(tls_start, connect_end));
+
+    ai_timing_set_duration(timing, AI_TIMING_FIRST_BYTE,
+                           metrics_span(soup_message_metrics_get_request_start(metrics),
+                                        soup_message_metrics_get_response_start(metrics)));
+    ai_timing_set_duration(timing, AI_TIMING_DOWNLOAD,
+                           metrics_span(soup_message_metrics_get_response_start(metrics),
+                                        soup_message_metrics_get_response_end(metrics)));
+
+    ai_timing_set_bytes(timing,
+                        soup_message_metrics_get_request_header_bytes_sent(metrics) +
+                        soup_message_metrics_get_request_body_bytes_sent(metrics),
+                        soup_message_metrics_get_response_header_bytes_received(metrics) +
+                        soup_message_metrics_get_response_body_bytes_received(metrics));
+}
+
+static void
+send_data_free(SendData *data)
+{
+    g_clear_object(&data->msg);
+    g_clear_pointer(&data->body, g_bytes_unref);
+    g_clear_pointer(&data->cache_key, g_free);
+    g_clear_pointer(&data->timing, ai_timing_free);
+    g_slice_free(SendData, data);
+}
+
+static void send_attempt(GTask *task);
+
+static gboolean
+on_retry_delay_done(gpointer user_data)
+{
+    GTask *task = G_TASK(user_data);
+
+    if (g_task_return_error_if_cancelled(task))
+    {
+        g_object_unref(task);
+        return G_SOURCE_REMOVE;
+    }
+
+    send_attempt(task);
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * Either schedule another attempt or fail the task.
+ * Takes ownership of @error and of the caller's reference to @task.
+ */
+static void
+retry_or_fail(
+    GTask  *task,
+    GError *error
+){
+    AiClient *self = g_task_get_source_object(task);
+    SendData *data = g_task_get_task_data(task);
+    GCancellable *cancellable = g_task_get_cancellable(task);
+    SoupMessage *next;
+    GSource *source;
+    guint delay_ms;
+
+    if (!should_retry(self, data->attempt, soup_message_get_status(data->msg), error))
+    {
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    delay_ms = ai_retry_get_delay(data->msg, data->attempt);
+    if (retry_misses_deadline(data->deadline, delay_ms))
+    {
+        g_task_return_new_error(task, AI_ERROR, AI_ERROR_TIMEOUT,
+                                "Deadline exceeded: %s", error->message);
+        g_error_free(error);
+        g_object_unref(task);
+        return;
+    }
+
+    data->attempt++;
+
+    notify_retry(self, data->attempt, delay_ms, error);
+    g_error_free(error);
+
+    next = copy_message(data->msg);
+    g_object_unref(data->msg);
+    data->msg = next;
+
+    /* Wake up on either the delay or cancellation */
+    source = g_timeout_source_new(delay_ms);
+    if (cancellable != NULL)
+    {
+        GSource *cancel_source = g_cancellable_source_new(cancellable);
+
+        g_source_set_dummy_callback(cancel_source);
+        g_source_add_child_source(source, cancel_source);
+        g_source_unref(cancel_source);
+    }
+
+    g_source_set_callback(source, on_retry_delay_done, task, NULL);
+    g_source_attach(source, g_task_get_context(task));
+    g_source_unref(source);
+}
+
+static void
+on_send_and_read_ready(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    SendData *data = g_task_get_task_data(task);
+    g_autoptr(GBytes) bytes = NULL;
+    GError *error = NULL;
+    AiResponseCache *cache;
+    guint status;
+
+    bytes = soup_session_send_and_read_finish(SOUP_SESSION(source), result, &error);
+    update_rate_limits(g_task_get_source_object(task), data->msg);
+    release_message_endpoint(g_task_get_source_object(task), data->msg, data->sent_at);
+
+    if (bytes == NULL)
+    {
+        retry_or_fail(task, error);
+        return;
+    }
+
+    status = soup_message_get_status(data->msg);
+    if (!SOUP_STATUS_IS_SUCCESSFUL(status))
+    {
+        set_http_error(&error, status, bytes);
+        retry_or_fail(task, error);
+        return;
+    }
+
+    fill_timing(data->timing, data->msg);
+
+    cache = ai_client_get_response_cache(g_task_get_source_object(task));
+    if (data->cache_key != NULL && cache != NULL)
+    {
+        ai_response_cache_store(cache, data->cache_key, bytes);
+    }
+
+    g_task_return_pointer(task, g_steal_pointer(&bytes), (GDestroyNotify)g_bytes_unref);
+    g_object_unref(task);
+}
+
+static void
+on_send_ready(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    SendData *data = g_task_get_task_data(task);
+    g_autoptr(GInputStream) stream = NULL;
+    GError *error = NULL;
+    guint status;
+
+    stream = soup_session_send_finish(SOUP_SESSION(source), result, &error);
+    update_rate_limits(g_task_get_source_object(task), data->msg);
+    release_message_endpoint(g_task_get_source_object(task), data->msg, data->sent_at);
+
+    if (stream == NULL)
+    {
+        retry_or_fail(task, error);
+        return;
+    }
+
+    status = soup_message_get_status(data->msg);
+    if (!SOUP_STATUS_IS_SUCCESSFUL(status))
+    {
+        set_http_error(&error, status, NULL);
+        retry_or_fail(task, error);
+        return;
+    }
+
+    fill_timing(data->timing, data->msg);
+
+    g_task_return_pointer(task, g_steal_pointer(&stream), g_object_unref);
+    g_object_unref(task);
+}
+
+static void
+send_now(GTask *task)
+{
+    AiClient *self = g_task_get_source_object(task);
+    SendData *data = g_task_get_task_data(task);
+    SoupSession *session = get_message_session(self, data->msg);
+
+    soup_message_add_flags(data->msg, SOUP_MESSAGE_COLLECT_METRICS);
+    if (data->body != NULL)
+    {
+        set_request_body(data->msg, data->body);
+    }
+
+    data->sent_at = g_get_monotonic_time();
+
+    if (data->read_body)
+    {
+        soup_session_send_and_read_async(session,
+                                         data->msg,
+                                         g_task_get_priority(task),
+                                         g_task_get_cancellable(task),
+                                         on_send_and_read_ready,
+                                         task);
+    }
+    else
+    {
+        soup_session_send_async(session,
+                                data->msg,
+                                g_task_get_priority(task),
+                                g_task_get_cancellable(task),
+                                on_send_ready,
+                                task);
+    }
+}
+
+static void
+on_rate_limit_admitted(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    SendData *data = g_task_get_task_data(task);
+    GError *error = NULL;
+
+    if (!ai_rate_limiter_acquire_finish(AI_RATE_LIMITER(source), result, &error))
+    {
+        release_message_endpoint(g_task_get_source_object(task), data->msg, 0);
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    send_now(task);
+}
+
+/*
+ * Start an attempt once the rate limiter admits it. Every attempt,
+ * retries included, counts against the limits, and is balanced anew,
+ * so a retry after a 429 goes to another key if there is one.
+ */
+static void
+send_attempt(GTask *task)
+{
+    AiClient *self = g_task_get_source_object(task);
+    SendData *data = g_task_get_task_data(task);
+    AiRateLimiter *limiter;
+
+    balance_message(self, data->msg);
+    limiter = get_message_rate_limiter(self, data->msg);
+
+    if (limiter == NULL)
+    {
+        send_now(task);
+        return;
+    }
+
+    ai_rate_limiter_acquire_async(limiter,
+                                  data->input_tokens,
+                                  data->output_tokens,
+                                  g_task_get_cancellable(task),
+                                  on_rate_limit_admitted,
+                                  task);
+}
+
+/*
+ * An HTTP request shared by identical concurrent callers. It runs
+ * with its own cancellable, cancelled only once every caller has
+ * given up, so one caller cancelling does not fail the others.
+ */
+typedef struct
+{
+    gchar        *key;
+    GCancellable *cancellable;
+    GQueue        waiters;      /* element-type FlightWaiter */
+} Flight;
+
+typedef struct
+{
+    GTask   *task;
+    GSource *cancel_source;
+} FlightWaiter;
+
+static void
+flight_waiter_free(FlightWaiter *waiter)
+{
+    if (waiter->cancel_source != NULL)
+    {
+        g_source_destroy(waiter->cancel_source);
+        g_source_unref(waiter->cancel_source);
+    }
+    g_clear_object(&waiter->task);
+    g_slice_free(FlightWaiter, waiter);
+}
+
+static void
+flight_free(Flight *flight)
+{
+    g_queue_clear_full(&flight->waiters, (GDestroyNotify)flight_waiter_free);
+    g_clear_object(&flight->cancellable);
+    g_free(flight->key);
+    g_slice_free(Flight, flight);
+}
+
+static gint
+compare_flight_waiter_task(
+    gconstpointer a,
+    gconstpointer b
+){
+    return ((const FlightWaiter *)a)->task == b ? 0 : 1;
+}
+
+static gboolean
+on_flight_waiter_cancelled(
+    GCancellable *cancellable,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    AiClient *self = g_task_get_source_object(task);
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+    SendData *data = g_task_get_task_data(task);
+    FlightWaiter *waiter = NULL;
+    Flight *flight;
+
+    (void)cancellable;
+
+    /* Whoever removes the waiter under the lock completes it */
+    g_mutex_lock(&priv->flights_lock);
+    flight = g_hash_table_lookup(priv->flights, data->cache_key);
+    if (flight != NULL)
+    {
+        GList *link = g_queue_find_custom(&flight->waiters, task, compare_flight_waiter_task);
+
+        if (link != NULL)
+        {
+            waiter = link->data;
+            g_queue_delete_link(&flight->waiters, link);
+        }
+
+        /* Nobody is left to want the response: abandon the request */
+        if (waiter != NULL && g_queue_is_empty(&flight->waiters))
+        {
+            g_hash_table_remove(priv->flights, flight->key);
+            g_cancellable_cancel(flight->cancellable);
+        }
+    }
+    g_mutex_unlock(&priv->flights_lock);
+
+    if (waiter != NULL)
+    {
+        g_task_return_error_if_cancelled(waiter->task);
+        flight_waiter_free(waiter);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+add_flight_waiter(
+    Flight *flight,
+    GTask  *task
+){
+    FlightWaiter *waiter = g_slice_new0(FlightWaiter);
+    GCancellable *cancellable = g_task_get_cancellable(task);
+
+    waiter->task = task;
+
+    if (cancellable != NULL)
+    {
+        waiter->cancel_source = g_cancellable_source_new(cancellable);
+        g_source_set_callback(waiter->cancel_source,
+                              (GSourceFunc)(GCallback)on_flight_waiter_cancelled,
+                              g_object_ref(task), g_object_unref);
+        g_source_attach(waiter->cancel_source, g_task_get_context(task));
+    }
+
+    g_queue_push_tail(&flight->waiters, waiter);
+}
+
+static void
+on_flight_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    AiClient *self = AI_CLIENT(source);
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+    Flight *flight = user_data;
+    SendData *flight_data = g_task_get_task_data(G_TASK(result));
+    g_autoptr(GBytes) bytes = NULL;
+    g_autoptr(GError) error = NULL;
+    GQueue waiters = G_QUEUE_INIT;
+    FlightWaiter *waiter;
+
+    bytes = g_task_propagate_pointer(G_TASK(result), &error);
+
+    g_mutex_lock(&priv->flights_lock);
+    if (g_hash_table_lookup(priv->flights, flight->key) == flight)
+    {
+        g_hash_table_remove(priv->flights, flight->key);
+    }
+    waiters = flight->waiters;
+    g_queue_init(&flight->waiters);
+    g_mutex_unlock(&priv->flights_lock);
+
+    /*
+     * Every caller gets the same body and parses its own AiResponse,
+     * so no caller can modify another's result.
+     */
+    while ((waiter = g_queue_pop_head(&waiters)) != NULL)
+    {
+        if (bytes != NULL)
+        {
+            SendData *data = g_task_get_task_data(waiter->task);
+
+            /* Every caller is timed against its own start */
+            fill_timing(data->timing, flight_data->msg);
+            g_task_return_pointer(waiter->task, g_bytes_ref(bytes),
+                                  (GDestroyNotify)g_bytes_unref);
+        }
+        else
+        {
+            g_task_return_error(waiter->task, g_error_copy(error));
+        }
+        flight_waiter_free(waiter);
+    }
+
+    flight_free(flight);
+}
+
+/*
+ * Attach @task to the flight for its key, starting the request if no
+ * identical one is in flight.
+ */
+static void
+join_flight(
+    AiClient *self,
+    GTask    *task
+){
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+    SendData *data = g_task_get_task_data(task);
+    SendData *flight_data;
+    Flight *flight;
+    GTask *flight_task;
+
+    g_mutex_lock(&priv->flights_lock);
+
+    flight = g_hash_table_lookup(priv->flights, data->cache_key);
+    if (flight != NULL)
+    {
+        add_flight_waiter(flight, task);
+        g_mutex_unlock(&priv->flights_lock);
+        return;
+    }
+
+    flight = g_slice_new0(Flight);
+    flight->key = g_strdup(data->cache_key);
+    flight->cancellable = g_cancellable_new();
+    g_queue_init(&flight->waiters);
+    add_flight_waiter(flight, task);
+    g_hash_table_insert(priv->flights, flight->key, flight);
+
+    g_mutex_unlock(&priv->flights_lock);
+
+    flight_data = g_slice_new0(SendData);
+    flight_data->msg = g_object_ref(data->msg);
+    flight_data->body = g_bytes_ref(data->body);
+    flight_data->read_body = TRUE;
+    flight_data->input_tokens = data->input_tokens;
+    flight_data->output_tokens = data->output_tokens;
+    flight_data->cache_key = g_strdup(data->cache_key);
+    flight_data->timing = ai_timing_new();
+    flight_data->deadline = data->deadline;
+
+    flight_task = g_task_new(self, flight->cancellable, on_flight_done, flight);
+    g_task_set_source_tag(flight_task, join_flight);
+    g_task_set_task_data(flight_task, flight_data, (GDestroyNotify)send_data_free);
+
+    send_attempt(flight_task);
+}
+
+static void
+start_send(
+    AiClient            *self,
+    SoupMessage         *msg,
+    GBytes              *body,
+    gboolean             read_body,
+    gpointer             source_tag,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    AiClientPrivate *priv = ai_client_get_instance_private(self);
+    GTask *task;
+    SendData *data;
+
+    data = g_slice_new0(SendData);
+    data->msg = g_object_ref(msg);
+    data->body = body != NULL ? g_bytes_ref(body) : NULL;
+    data->read_body = read_body;
+    data->attempt = 0;
+    data->timing = ai_timing_new();
+    data->deadline = get_message_deadline(msg);
+    estimate_request_cost(self, msg, body, &data->input_tokens, &data->output_tokens);
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, source_tag);
+    g_task_set_task_data(task, data, (GDestroyNotify)send_data_free);
+
+    if (read_body)
+    {
+        data->cache_key = get_request_key(self, msg, body);
+    }
+
+    if (data->cache_key != NULL && priv->response_cache != NULL)
+    {
+        g_autoptr(GBytes) cached = NULL;
+
+        cached = ai_response_cache_lookup(priv->response_cache, data->cache_key);
+        if (cached != NULL)
+        {
+            g_task_return_pointer(task, g_steal_pointer(&cached), (GDestroyNotify)g_bytes_unref);
+            g_object_unref(task);
+            return;
+        }
+    }
+
+    if (data->cache_key != NULL && priv->coalesce_requests)
+    {
+        join_flight(self, task);
+        return;
+    }
+
+    send_attempt(task);
+}
+
+/**
+ * ai_client_get_retry_count:
+ * @self: an #AiClient
+ *
+ * Gets the total number of retries this client has made across all
+ * requests.
+ *
+ * Returns: the retry count
+ */
+guint
+ai_client_get_retry_count(AiClient *self)
+{
+    AiClientPrivate *priv;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), 0);
+
+    priv = ai_client_get_instance_private(self);
+    return (guint)g_atomic_int_get(&priv->retry_count);
+}
+
+/*
+ * The blocking send behind ai_client_send_and_read(). On success the
+ * network phases of @timing, if given, are filled in.
+ */
+static GBytes *
+send_and_read_sync(
+    AiClient      *self,
+    SoupMessage   *msg,
+    GBytes        *body,
+    AiTiming      *timing,
+    GCancellable  *cancellable,
+    GError       **error
+){
+    SoupSession *session;
+    AiRateLimiter *limiter;
+    g_autoptr(SoupMessage) current = NULL;
+    g_autofree gchar *cache_key = NULL;
+    guint attempt = 0;
+    guint input_tokens;
+    guint output_tokens;
+
+    cache_key = get_request_key(self, msg, body);
+    if (cache_key != NULL && ai_client_get_response_cache(self) != NULL)
+    {
+        GBytes *cached = ai_response_cache_lookup(ai_client_get_response_cache(self), cache_key);
+
+        if (cached != NULL)
+        {
+            return cached;
+        }
+    }
+
+    current = g_object_ref(msg);
+    estimate_request_cost(self, msg, body, &input_tokens, &output_tokens);
+
+    for (;;)
+    {
+        g_autoptr(GBytes) bytes = NULL;
+        GError *local_error = NULL;
+        SoupMessage *next;
+        gint64 sent_at;
+        guint status;
+        guint delay_ms;
+
+        balance_message(self, current);
+        limiter = get_message_rate_limiter(self, current);
+        session = get_message_session(self, current);
+
+        if (limiter != NULL &&
+            !ai_rate_limiter_acquire(limiter, input_tokens, output_tokens,
+                                     cancellable, error))
+        {
+            release_message_endpoint(self, current, 0);
+            return NULL;
+        }
+
+        soup_message_add_flags(current, SOUP_MESSAGE_COLLECT_METRICS);
+        if (body != NULL)
+        {
+            set_request_body(current, body);
+        }
+
+        sent_at = g_get_monotonic_time();
+        bytes = soup_session_send_and_read(session, current, cancellable, &local_error);
+        status = soup_message_get_status(current);
+        update_rate_limits(self, current);
+        release_message_endpoint(self, current, sent_at);
+
+        if (bytes != NULL)
+        {
+            if (SOUP_STATUS_IS_SUCCESSFUL(status))
+            {
+                if (timing != NULL)
+                {
+                    fill_timing(timing, current);
+                }
+                if (cache_key != NULL && ai_client_get_response_cache(self) != NULL)
+                {
+                    ai_response_cache_store(ai_client_get_response_cache(self), cache_key, bytes);
+                }
+                return g_steal_pointer(&bytes);
+            }
+
+            set_http_error(&local_error, status, bytes);
+        }
+
+        if (!should_retry(self, attempt, status, local_error))
+        {
+            g_propagate_error(error, local_error);
+            return NULL;
+        }
+
+        delay_ms = ai_retry_get_delay(current, attempt);
+        if (retry_misses_deadline(get_message_deadline(msg), delay_ms))
+        {
+            g_set_error(error, AI_ERROR, AI_ERROR_TIMEOUT,
+                        "Deadline exceeded: %s", local_error->message);
+            g_error_free(local_error);
+            return NULL;
+        }
+
+        attempt++;
+
+        notify_retry(self, attempt, delay_ms, local_error);
+        g_error_free(local_error);
+
+        if (!wait_for_retry(delay_ms, cancellable, error))
+        {
+            return NULL;
+        }
+
+        next = copy_message(current);
+        g_object_unref(current);
+        current = next;
+    }
+}
+
+/**
+ * ai_client_send_and_read:
+ * @self: an #AiClient
+ * @msg: the #SoupMessage to send
+ * @body: (nullable): the request body, sent as application/json unless @msg
+ *   already has a Content-Type
+ * @cancellable: (nullable): a #GCancellable
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Sends @msg on the client's session and reads the whole response body,
+ * retrying retryable failures as configured by #AiConfig:max-retries.
+ * @body is attached to each attempt. Non-2xx responses are reported as
+ * #AI_ERROR errors.
+ *
+ * Returns: (transfer full) (nullable): the response body, or %NULL on error
+ */
+GBytes *
+ai_client_send_and_read(
+    AiClient      *self,
+    SoupMessage   *msg,
+    GBytes        *body,
+    GCancellable  *cancellable,
+    GError       **error
+){
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+    g_return_val_if_fail(SOUP_IS_MESSAGE(msg), NULL);
+
+    return send_and_read_sync(self, msg, body, NULL, cancellable, error);
+}
+
+/**
+ * ai_client_send_and_read_async:
+ * @self: an #AiClient
+ * @msg: the #SoupMessage to send
+ * @body: (nullable): the request body, sent as application/json unless @msg
+ *   already has a Content-Type
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): callback to call when complete
+ * @user_data: (closure): user data for @callback
+ *
+ * Asynchronously sends @msg and reads the whole response body, retrying
+ * retryable failures with backoff. See ai_client_send_and_read().
+ */
+void
+ai_client_send_and_read_async(
+    AiClient            *self,
+    SoupMessage         *msg,
+    GBytes              *body,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_return_if_fail(AI_IS_CLIENT(self));
+    g_return_if_fail(SOUP_IS_MESSAGE(msg));
+
+    start_send(self, msg, body, TRUE, ai_client_send_and_read_async,
+               cancellable, callback, user_data);
+}
+
+/**
+ * ai_client_send_and_read_finish:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes an asynchronous send started with
+ * ai_client_send_and_read_async().
+ *
+ * Returns: (transfer full) (nullable): the response body, or %NULL on error
+ */
+GBytes *
+ai_client_send_and_read_finish(
+    AiClient      *self,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+    g_return_val_if_fail(g_task_is_valid(result, self), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+/**
+ * ai_client_send_async:
+ * @self: an #AiClient
+ * @msg: the #SoupMessage to send
+ * @body: (nullable): the request body, sent as application/json unless @msg
+ *   already has a Content-Type
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): callback to call when complete
+ * @user_data: (closure): user data for @callback
+ *
+ * Asynchronously sends @msg and returns the response body as a stream,
+ * for streaming responses. Retries happen only while waiting for the
+ * response headers; once a 2xx response arrives the stream is handed
+ * to the caller.
+ */
+void
+ai_client_send_async(
+    AiClient            *self,
+    SoupMessage         *msg,
+    GBytes              *body,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_return_if_fail(AI_IS_CLIENT(self));
+    g_return_if_fail(SOUP_IS_MESSAGE(msg));
+
+    start_send(self, msg, body, FALSE, ai_client_send_async,
+               cancellable, callback, user_data);
+}
+
+/**
+ * ai_client_send_finish:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes an asynchronous send started with ai_client_send_async().
+ *
+ * Returns: (transfer full) (nullable): the response stream, or %NULL on error
+ */
+GInputStream *
+ai_client_send_finish(
+    AiClient      *self,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+    g_return_val_if_fail(g_task_is_valid(result, self), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+on_preconnect_ready(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    SendData *data = g_task_get_task_data(task);
+    GError *error = NULL;
+
+    if (!soup_session_preconnect_finish(SOUP_SESSION(source), result, &error))
+    {
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    fill_timing(data->timing, data->msg);
+    ai_timing_mark(data->timing, AI_TIMING_TOTAL);
+
+    g_task_return_boolean(task, TRUE);
+    g_object_unref(task);
+}
+
+/**
+ * ai_client_prewarm_async:
+ * @self: an #AiClient
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async) (nullable): callback to call when complete
+ * @user_data: (closure): user data for @callback
+ *
+ * Opens a connection to the client's endpoint without sending a
+ * request. libsoup keeps it in the session's pool for the first
+ * request to reuse.
+ */
+void
+ai_client_prewarm_async(
+    AiClient            *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    AiClientClass *klass;
+    g_autofree gchar *url = NULL;
+    SendData *data;
+    GTask *task;
+
+    g_return_if_fail(AI_IS_CLIENT(self));
+
+    klass = AI_CLIENT_GET_CLASS(self);
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_client_prewarm_async);
+
+    if (klass->get_endpoint_url != NULL)
+    {
+        url = klass->get_endpoint_url(self);
+    }
+
+    data = g_slice_new0(SendData);
+    data->timing = ai_timing_new();
+    data->msg = url != NULL ? soup_message_new(SOUP_METHOD_POST, url) : NULL;
+    g_task_set_task_data(task, data, (GDestroyNotify)send_data_free);
+
+    if (data->msg == NULL)
+    {
+        g_task_return_new_error(task, AI_ERROR, AI_ERROR_CONFIGURATION_ERROR,
+                                "No valid endpoint to connect to: %s",
+                                url != NULL ? url : "(none)");
+        g_object_unref(task);
+        return;
+    }
+
+    soup_message_add_flags(data->msg, SOUP_MESSAGE_COLLECT_METRICS);
+    soup_session_preconnect_async(ensure_session(self), data->msg, G_PRIORITY_DEFAULT,
+                                  cancellable, on_preconnect_ready, task);
+}
+
+/**
+ * ai_client_prewarm_finish:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a pre-warm started with ai_client_prewarm_async().
+ *
+ * Returns: %TRUE if a connection was opened
+ */
+gboolean
+ai_client_prewarm_finish(
+    AiClient      *self,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(AI_IS_CLIENT(self), FALSE);
+    g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+/**
+ * ai_client_get_timing:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult of ai_client_send_and_read_async(),
+ *   ai_client_send_async() or ai_client_prewarm_async()
+ *
+ * Gets the latency breakdown of a finished send.
+ *
+ * Returns: (transfer full) (nullable): the #AiTiming, or %NULL if the
+ *   send failed
+ */
+AiTiming *
+ai_client_get_timing(
+    AiClient     *self,
+    GAsyncResult *result
+){
+    SendData *data;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+    g_return_val_if_fail(g_task_is_valid(result, self), NULL);
+    g_return_val_if_fail(g_task_get_source_tag(G_TASK(result)) == ai_client_send_and_read_async ||
+                         g_task_get_source_tag(G_TASK(result)) == ai_client_send_async ||
+                         g_task_get_source_tag(G_TASK(result)) == ai_client_prewarm_async, NULL);
+
+    if (g_task_had_error(G_TASK(result)))
+    {
+        return NULL;
+    }
+
+    data = g_task_get_task_data(G_TASK(result));
+
+    return ai_timing_copy(data->timing);
+}
+
+/*
+ * Parse a chat response body, timing the JSON parse, and attach @timing.
+ */
+static AiResponse *
+parse_chat_response(
+    AiClient  *self,
+    GBytes    *bytes,
+    AiTiming  *timing,
+    GError   **error
+){
+    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
+    g_autoptr(JsonParser) parser = NULL;
+    AiResponse *response;
+    const gchar *data;
+    gsize len;
+    gint64 parse_start;
+
+    g_return_val_if_fail(klass->parse_response != NULL, NULL);
+
+    data = g_bytes_get_data(bytes, &len);
+    parser = json_parser_new();
+    parse_start = g_get_monotonic_time();
+
+    if (!json_parser_load_from_data(parser, data, len, error))
+    {
+        return NULL;
+    }
+
+    response = klass->parse_response(self, json_parser_get_root(parser), error);
+    if (response == NULL)
+    {
+        return NULL;
+    }
+
+    if (timing != NULL)
+    {
+        ai_timing_set_duration(timing, AI_TIMING_PARSE, g_get_monotonic_time() - parse_start);
+        ai_timing_mark(timing, AI_TIMING_TOTAL);
+        ai_response_set_timing(response, timing);
+    }
+
+    return response;
+}
+
+/**
+ * ai_client_parse_chat_result:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult of ai_client_send_and_read_async()
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a chat request sent with ai_client_send_and_read_async(),
+ * parsing the body and attaching the request's #AiTiming.
+ *
+ * Returns: (transfer full) (nullable): the #AiResponse, or %NULL on error
+ */
+AiResponse *
+ai_client_parse_chat_result(
+    AiClient      *self,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_autoptr(GBytes) bytes = NULL;
+    SendData *data;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+    g_return_val_if_fail(g_task_is_valid(result, self), NULL);
+    g_return_val_if_fail(g_task_get_source_tag(G_TASK(result)) == ai_client_send_and_read_async,
+                         NULL);
+
+    bytes = g_task_propagate_pointer(G_TASK(result), error);
+    if (bytes == NULL)
+    {
+        return NULL;
+    }
+
+    data = g_task_get_task_data(G_TASK(result));
+
+    return parse_chat_response(self, bytes, data->timing, error);
+}
+
+/*
+ * Data for parsing one response, owned by the parse task.
+ */
+typedef struct
+{
+    GBytes   *bytes;
+    AiTiming *timing;
+} ParseData;
+
+static void
+parse_data_free(ParseData *data)
+{
+    g_clear_pointer(&data->bytes, g_bytes_unref);
+    g_clear_pointer(&data->timing, ai_timing_free);
+    g_slice_free(ParseData, data);
+}
+
+/*
+ * Runs in a GTask worker thread for large bodies, or in place for
+ * small ones. parse_response only reads the client, so it is safe to
+ * call from any thread.
+ */
+static void
+parse_chat_thread(
+    GTask        *task,
+    gpointer      source_object,
+    gpointer      task_data,
+    GCancellable *cancellable
+){
+    ParseData *data = task_data;
+    GError *error = NULL;
+    AiResponse *response;
+
+    (void)cancellable;
+
+    response = parse_chat_response(AI_CLIENT(source_object), data->bytes, data->timing, &error);
+    if (response == NULL)
+    {
+        g_task_return_error(task, error);
+        return;
+    }
+
+    g_task_return_pointer(task, response, g_object_unref);
+}
+
+/**
+ * ai_client_parse_chat_result_async:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult of ai_client_send_and_read_async()
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): callback to call when done
+ * @user_data: user data for the callback
+ *
+ * Like ai_client_parse_chat_result(), but bodies of at least
+ * #AiConfig:parse-thread-threshold bytes are parsed in a worker
+ * thread. @callback is called in the thread-default main context of
+ * the caller.
+ */
+void
+ai_client_parse_chat_result_async(
+    AiClient            *self,
+    GAsyncResult        *result,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    AiClientPrivate *priv;
+    SendData *send_data;
+    ParseData *data;
+    GError *error = NULL;
+    GBytes *bytes;
+    GTask *task;
+    gsize threshold;
+
+    g_return_if_fail(AI_IS_CLIENT(self));
+    g_return_if_fail(g_task_is_valid(result, self));
+    g_return_if_fail(g_task_get_source_tag(G_TASK(result)) == ai_client_send_and_read_async);
+
+    priv = ai_client_get_instance_private(self);
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_client_parse_chat_result_async);
+
+    bytes = g_task_propagate_pointer(G_TASK(result), &error);
+    if (bytes == NULL)
+    {
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    /* The send result may be gone before a worker gets to the parse */
+    send_data = g_task_get_task_data(G_TASK(result));
+
+    data = g_slice_new0(ParseData);
+    data->bytes = bytes;
+    data->timing = send_data->timing != NULL ? ai_timing_copy(send_data->timing) : NULL;
+    g_task_set_task_data(task, data, (GDestroyNotify)parse_data_free);
+
+    threshold = ai_config_get_parse_thread_threshold(priv->config);
+    if (threshold > 0 && g_bytes_get_size(bytes) >= threshold)
+    {
+        g_task_run_in_thread(task, parse_chat_thread);
+    }
+    else
+    {
+        parse_chat_thread(task, self, data, cancellable);
+    }
+
+    g_object_unref(task);
+}
+
+/**
+ * ai_client_parse_chat_result_finish:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a parse started with ai_client_parse_chat_result_async().
+ *
+ * Returns: (transfer full) (nullable): the #AiResponse, or %NULL on error
+ */
+AiResponse *
+ai_client_parse_chat_result_finish(
+    AiClient      *self,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+    g_return_val_if_fail(g_task_is_valid(result, self), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+/**
+ * ai_client_resolve_options:
+ * @self: an #AiClient
+ * @options: (nullable): the request's #AiRequestOptions
+ *
+ * Copies @options and fills in what it leaves unset from the client's
+ * properties.
+ *
+ * Returns: (transfer full): the resolved #AiRequestOptions
+ */
+AiRequestOptions *
+ai_client_resolve_options(
+    AiClient               *self,
+    const AiRequestOptions *options
+){
+    AiClientPrivate *priv;
+    AiRequestOptions *resolved;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+
+    priv = ai_client_get_instance_private(self);
+
+    resolved = options != NULL ? ai_request_options_copy(options) : ai_request_options_new();
+
+    if (ai_request_options_get_model(resolved) == NULL)
+    {
+        ai_request_options_set_model(resolved, priv->model);
+    }
+    if (!ai_request_options_has_system_prompt(resolved))
+    {
+        ai_request_options_set_system_prompt(resolved, priv->system_prompt);
+    }
+    if (ai_request_options_get_max_tokens(resolved) == 0)
+    {
+        ai_request_options_set_max_tokens(resolved, priv->max_tokens);
+    }
+    if (!ai_request_options_has_temperature(resolved))
+    {
+        ai_request_options_set_temperature(resolved, priv->temperature);
+    }
+
+    return resolved;
+}
+
+/**
+ * ai_client_build_request_body:
+ * @self: an #AiClient
+ * @messages: (element-type AiMessage): the conversation messages
+ * @system_prompt: (nullable): the system prompt
+ * @max_tokens: the maximum number of tokens to generate
+ * @tools: (element-type AiTool) (nullable): the available tools
+ * @stream: whether to request a streaming response
+ *
+ * Serializes the request body for the provider. Providers that override
+ * the build_request_body virtual method write the body straight from the
+ * messages into one growable buffer, which is handed over without a
+ * copy; large transcripts are never duplicated into a #JsonNode tree.
+ *
+ * Returns: (transfer full) (nullable): the JSON request body, or %NULL on error
+ */
+GBytes *
+ai_client_build_request_body(
+    AiClient    *self,
+    GList       *messages,
+    const gchar *system_prompt,
+    gint         max_tokens,
+    GList       *tools,
+    gboolean     stream
+){
+    g_autoptr(AiRequestOptions) options = NULL;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+
+    options = ai_request_options_new();
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    return ai_client_build_request_body_with_options(self, messages, options, stream);
+}
+
+/**
+ * ai_client_build_request_body_with_options:
+ * @self: an #AiClient
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the #AiRequestOptions
+ * @stream: whether to request a streaming response
+ *
+ * Serializes the request body for @options.
+ *
+ * Returns: (transfer full) (nullable): the JSON request body, or %NULL on error
+ */
+GBytes *
+ai_client_build_request_body_with_options(
+    AiClient               *self,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    gboolean                stream
+){
+    AiClientClass *klass;
+    g_autoptr(AiRequestOptions) resolved = NULL;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+
+    klass = AI_CLIENT_GET_CLASS(self);
+    g_return_val_if_fail(klass->build_request_body != NULL, NULL);
+
+    resolved = ai_client_resolve_options(self, options);
+
+    return klass->build_request_body(self, messages, resolved, stream);
+}
+
+/**
+ * ai_client_create_request:
+ * @self: an #AiClient
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the #AiRequestOptions
+ * @stream: whether to request a streaming response
+ * @body: (out) (transfer full): return location for the request body
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Builds the HTTP request for a chat completion. The deadline of
+ * @options goes with the message, so sending it does not schedule
+ * retries past the deadline.
+ *
+ * Returns: (transfer full) (nullable): the #SoupMessage, or %NULL on error
+ */
+SoupMessage *
+ai_client_create_request(
+    AiClient                *self,
+    GList                   *messages,
+    const AiRequestOptions  *options,
+    gboolean                 stream,
+    GBytes                 **body,
+    GError                 **error
+){
+    AiClientClass *klass;
+    g_autoptr(AiRequestOptions) resolved = NULL;
+    g_autoptr(GBytes) request_body = NULL;
+    g_autofree gchar *url = NULL;
+    SoupMessage *msg;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+    g_return_val_if_fail(body != NULL, NULL);
+
+    klass = AI_CLIENT_GET_CLASS(self);
+    resolved = ai_client_resolve_options(self, options);
+
+    request_body = klass->build_request_body(self, messages, resolved, stream);
+    if (request_body == NULL)
+    {
+        g_set_error(error, AI_ERROR, AI_ERROR_INVALID_REQUEST,
+                    "Failed to build request");
+        return NULL;
+    }
+
+    url = klass->get_request_url(self, resolved, stream);
+    if (url == NULL)
+    {
+        g_set_error(error, AI_ERROR, AI_ERROR_CONFIGURATION_ERROR,
+                    "Failed to get endpoint URL");
+        return NULL;
+    }
+
+    msg = soup_message_new("POST", url);
+    if (msg == NULL)
+    {
+        g_set_error(error, AI_ERROR, AI_ERROR_INVALID_REQUEST,
+                    "Failed to create HTTP request for URL: %s", url);
+        return NULL;
+    }
+
+    soup_message_headers_append(soup_message_get_request_headers(msg),
+                                "Content-Type", "application/json");
+
+    if (klass->add_auth_headers != NULL)
+    {
+        klass->add_auth_headers(self, msg);
+    }
+
+    if (ai_request_options_get_deadline(resolved) != 0)
+    {
+        set_message_deadline(msg, ai_request_options_get_deadline(resolved));
+    }
+    set_message_max_tokens(msg, ai_request_options_get_max_tokens(resolved));
+
+    *body = g_steal_pointer(&request_body);
+
+    return msg;
+}
+
+/**
+ * ai_client_chat_sync:
+ * @self: an #AiClient
+ * @messages: (element-type AiMessage): the conversation messages
+ * @cancellable: (nullable): a #GCancellable
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Performs a synchronous chat completion request with the client's
+ * settings.
+ *
+ * Returns: (transfer full) (nullable): the #AiResponse, or %NULL on error
+ */
+AiResponse *
+ai_client_chat_sync(
+    AiClient      *self,
+    GList         *messages,
+    GCancellable  *cancellable,
+    GError       **error
+){
+    return ai_client_chat_sync_with_options(self, messages, NULL, cancellable, error);
+}
+
+/**
+ * ai_client_chat_sync_with_options:
+ * @self: an #AiClient
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the #AiRequestOptions
+ * @cancellable: (nullable): a #GCancellable
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Performs a synchronous chat completion request with @options. The
+ * client is only read, so several threads can share it. A deadline in
+ * @options interrupts the blocking send.
+ *
+ * Returns: (transfer full) (nullable): the #AiResponse, or %NULL on error
+ */
+AiResponse *
+ai_client_chat_sync_with_options(
+    AiClient                *self,
+    GList                   *messages,
+    const AiRequestOptions  *options,
+    GCancellable            *cancellable,
+    GError                 **error
+){
+    AiClientClass *klass;
+    g_autoptr(SoupMessage) msg = NULL;
+    g_autoptr(GBytes) request_body = NULL;
+    g_autoptr(GBytes) response_bytes = NULL;
+    g_autoptr(AiTiming) timing = NULL;
+    g_autoptr(AiDeadline) deadline = NULL;
+    GError *local_error = NULL;
+
+    g_return_val_if_fail(AI_IS_CLIENT(self), NULL);
+
+    klass = AI_CLIENT_GET_CLASS(self);
+
+    g_return_val_if_fail(klass->parse_response != NULL, NULL);
+    g_return_val_if_fail(klass->get_endpoint_url != NULL, NULL);
+
+    timing = ai_timing_new();
+
+    deadline = ai_deadline_new(options != NULL ? ai_request_options_get_deadline(options) : 0,
+                               cancellable);
+    if (!ai_deadline_check(deadline, error))
+    {
+        return NULL;
+    }
+
+    msg = ai_client_create_request(self, messages, options, FALSE, &request_body, error);
+    if (msg == NULL)
+    {
+        return NULL;
+    }
+
+    /* Send request, retrying transient failures */
+    response_bytes = send_and_read_sync(self, msg, request_body, timing,
+                                        ai_deadline_get_cancellable(deadline), &local_error);
+    if (response_bytes == NULL)
+    {
+        ai_deadline_translate_error(deadline, &local_error);
+        g_propagate_error(error, local_error);
+        return NULL;
+    }
 
-    return klass->parse_response(self, response_json, error);
+    return parse_chat_response(self, response_bytes, timing, error);
 }
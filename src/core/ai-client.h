@@ -17,10 +17,15 @@
 #include <libsoup/soup.h>
 #include <json-glib/json-glib.h>
 
+#include "core/ai-balancer.h"
 #include "core/ai-config.h"
+#include "core/ai-delta-buffer.h"
 #include "core/ai-provider.h"
+#include "core/ai-rate-limiter.h"
+#include "core/ai-response-cache.h"
 #include "core/ai-streamable.h"
 #include "model/ai-message.h"
+#include "model/ai-request-options.h"
 #include "model/ai-response.h"
 
 G_BEGIN_DECLS
@@ -36,6 +41,16 @@ G_DECLARE_DERIVABLE_TYPE(AiClient, ai_client, AI, CLIENT, GObject)
  * @parse_response: parses the JSON response from the provider
  * @get_endpoint_url: gets the API endpoint URL
  * @add_auth_headers: adds authentication headers to the request
+ * @parse_stream_chunk: parses a chunk of a streaming response
+ * @build_request_body: serializes the request body for resolved options
+ *   (see ai_client_resolve_options()); the default serializes the result
+ *   of @build_request, which only honours the system prompt, token limit
+ *   and tools of the options
+ * @get_request_url: gets the URL for a request; the default returns
+ *   @get_endpoint_url, override it when the URL depends on the options
+ * @set_api_key: replaces the API key a request built by the client
+ *   carries with @api_key, wherever the provider passes it; used to send
+ *   the request with another key of the config's key pool
  * @_reserved: reserved for future expansion
  *
  * Class structure for #AiClient.
@@ -63,9 +78,19 @@ struct _AiClientClass
                                        gsize           length,
                                        GString        *buffer,
                                        AiResponse     *response);
+    GBytes *     (*build_request_body)(AiClient               *self,
+                                       GList                  *messages,
+                                       const AiRequestOptions *options,
+                                       gboolean                stream);
+    gchar *      (*get_request_url)   (AiClient               *self,
+                                       const AiRequestOptions *options,
+                                       gboolean                stream);
+    void         (*set_api_key)       (AiClient       *self,
+                                       SoupMessage    *msg,
+                                       const gchar    *api_key);
 
     /* Reserved for future expansion */
-    gpointer _reserved[8];
+    gpointer _reserved[5];
 };
 
 /**
@@ -186,6 +211,542 @@ ai_client_set_system_prompt(
 SoupSession *
 ai_client_get_soup_session(AiClient *self);
 
+/**
+ * ai_client_get_rate_limiter:
+ * @self: an #AiClient
+ *
+ * Gets the rate limiter requests from this client wait on. Clients of
+ * the same provider and API key share one. With a key pool, this is
+ * the limiter of ai_config_get_api_key(); requests wait on the limiter
+ * of the key the balancer sent them to.
+ *
+ * Returns: (transfer none) (nullable): the #AiRateLimiter, or %NULL if
+ *   the client is not a provider and is not rate limited
+ */
+AiRateLimiter *
+ai_client_get_rate_limiter(AiClient *self);
+
+/**
+ * ai_client_get_balancer:
+ * @self: an #AiClient
+ *
+ * Gets the balancer that spreads requests over the API keys and base
+ * URLs pooled in the client's #AiConfig. It is built on first use from
+ * every pair of a pooled key and a pooled base URL, and only if there
+ * is more than one pair.
+ *
+ * Each attempt of a request, retries included, goes to the endpoint
+ * the balancer picks and waits on the rate limiter of that endpoint's
+ * key. Latency is measured to the full response, or to the response
+ * headers for streams.
+ *
+ * Returns: (transfer none) (nullable): the #AiBalancer, or %NULL if
+ *   requests all go to one endpoint
+ */
+AiBalancer *
+ai_client_get_balancer(AiClient *self);
+
+/**
+ * ai_client_get_response_cache:
+ * @self: an #AiClient
+ *
+ * Gets the cache chat responses are answered from.
+ *
+ * Returns: (transfer none) (nullable): the #AiResponseCache, or %NULL
+ */
+AiResponseCache *
+ai_client_get_response_cache(AiClient *self);
+
+/**
+ * ai_client_set_response_cache:
+ * @self: an #AiClient
+ * @cache: (nullable): an #AiResponseCache, or %NULL to disable caching
+ *
+ * Sets the cache chat responses are answered from. A request whose
+ * endpoint and serialized body match a cached one gets the cached
+ * response body back without being sent, and is parsed exactly like a
+ * fresh response. Several clients may share one cache.
+ *
+ * The cache does not look at the temperature: enable it for requests
+ * that are meant to be deterministic.
+ */
+void
+ai_client_set_response_cache(
+    AiClient        *self,
+    AiResponseCache *cache
+);
+
+/**
+ * ai_client_get_coalesce_requests:
+ * @self: an #AiClient
+ *
+ * Gets whether identical concurrent chat requests share one HTTP request.
+ *
+ * Returns: %TRUE if requests are coalesced
+ */
+gboolean
+ai_client_get_coalesce_requests(AiClient *self);
+
+/**
+ * ai_client_set_coalesce_requests:
+ * @self: an #AiClient
+ * @coalesce: whether to coalesce identical requests
+ *
+ * Sets whether identical concurrent chat requests share one HTTP
+ * request. While a request is in flight, asynchronous requests with
+ * the same endpoint and serialized body wait for it instead of being
+ * sent, and each caller gets its own #AiResponse parsed from the shared
+ * response body. A caller cancelling only detaches that caller; the
+ * request itself is cancelled once no caller is waiting.
+ *
+ * Unlike a response cache this keeps nothing once the request is done,
+ * so it is safe with non-zero temperatures as long as callers accept
+ * sharing one sample. It is off by default.
+ */
+void
+ai_client_set_coalesce_requests(
+    AiClient *self,
+    gboolean  coalesce
+);
+
+/**
+ * ai_client_get_delta_min_bytes:
+ * @self: an #AiClient
+ *
+ * Gets how many bytes of streamed text are joined into one
+ * #AiStreamable::delta.
+ *
+ * Returns: the number of bytes, or 0 if deltas are not joined
+ */
+guint
+ai_client_get_delta_min_bytes(AiClient *self);
+
+/**
+ * ai_client_set_delta_min_bytes:
+ * @self: an #AiClient
+ * @min_bytes: the number of bytes, or 0 to emit every delta
+ *
+ * Sets how many bytes of streamed text are joined into one
+ * #AiStreamable::delta. Providers can yield a delta every few bytes,
+ * and each one is a signal emission and, in a UI, usually a redraw;
+ * joining them trades a little latency for far fewer of both. Text is
+ * also emitted after #AiClient:delta-max-delay, at a newline if
+ * #AiClient:delta-flush-on-newline is set, and before any other stream
+ * signal, so handlers see the same text in the same order either way.
+ *
+ * The policy is read when a stream starts.
+ */
+void
+ai_client_set_delta_min_bytes(
+    AiClient *self,
+    guint     min_bytes
+);
+
+/**
+ * ai_client_get_delta_max_delay:
+ * @self: an #AiClient
+ *
+ * Gets how long joined text may wait for more.
+ *
+ * Returns: the delay in milliseconds, or 0 for no limit
+ */
+guint
+ai_client_get_delta_max_delay(AiClient *self);
+
+/**
+ * ai_client_set_delta_max_delay:
+ * @self: an #AiClient
+ * @delay_ms: the delay in milliseconds, or 0 for no limit
+ *
+ * Sets how long joined text may wait for more before it is emitted,
+ * counted from the oldest byte that is waiting. The timer runs on the
+ * thread-default main context of the stream. The default is 50.
+ */
+void
+ai_client_set_delta_max_delay(
+    AiClient *self,
+    guint     delay_ms
+);
+
+/**
+ * ai_client_get_delta_flush_on_newline:
+ * @self: an #AiClient
+ *
+ * Gets whether joined text is emitted at the end of each line.
+ *
+ * Returns: %TRUE if a newline emits the joined text
+ */
+gboolean
+ai_client_get_delta_flush_on_newline(AiClient *self);
+
+/**
+ * ai_client_set_delta_flush_on_newline:
+ * @self: an #AiClient
+ * @flush: whether a newline emits the joined text
+ *
+ * Sets whether a delta that contains a newline is emitted at once,
+ * together with the text joined before it. Useful for consumers that
+ * render line by line. The default is %TRUE.
+ */
+void
+ai_client_set_delta_flush_on_newline(
+    AiClient *self,
+    gboolean  flush
+);
+
+/**
+ * ai_client_create_delta_buffer:
+ * @self: an #AiClient that implements #AiStreamable
+ *
+ * @options: (nullable): the request's #AiRequestOptions
+ *
+ * Creates the #AiDeltaBuffer a stream emits its events through, set up
+ * from the client's delta-* properties. If @options carry an #AiStream,
+ * the buffer queues the events there instead. Used by provider
+ * implementations.
+ *
+ * Returns: (transfer full): a new #AiDeltaBuffer
+ */
+AiDeltaBuffer *
+ai_client_create_delta_buffer(
+    AiClient               *self,
+    const AiRequestOptions *options
+);
+
+/**
+ * ai_client_get_retry_count:
+ * @self: an #AiClient
+ *
+ * Gets the total number of retries this client has made across all
+ * requests. Per-request attempts are reported by the #AiClient::retry
+ * signal.
+ *
+ * Returns: the retry count
+ */
+guint
+ai_client_get_retry_count(AiClient *self);
+
+/**
+ * ai_client_send_and_read:
+ * @self: an #AiClient
+ * @msg: the #SoupMessage to send
+ * @body: (nullable): the request body, sent as application/json unless @msg
+ *   already has a Content-Type
+ * @cancellable: (nullable): a #GCancellable
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Sends @msg on the client's session and reads the whole response body,
+ * retrying 408, 429, 5xx and connection failures before the first
+ * response byte up to #AiConfig:max-retries times. Delays follow the
+ * server's Retry-After and rate-limit reset headers when present, and
+ * exponential backoff with full jitter otherwise. Non-2xx responses are
+ * reported as #AI_ERROR errors.
+ *
+ * Returns: (transfer full) (nullable): the response body, or %NULL on error
+ */
+GBytes *
+ai_client_send_and_read(
+    AiClient      *self,
+    SoupMessage   *msg,
+    GBytes        *body,
+    GCancellable  *cancellable,
+    GError       **error
+);
+
+/**
+ * ai_client_send_and_read_async:
+ * @self: an #AiClient
+ * @msg: the #SoupMessage to send
+ * @body: (nullable): the request body, sent as application/json unless @msg
+ *   already has a Content-Type
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): callback to call when complete
+ * @user_data: (closure): user data for @callback
+ *
+ * Asynchronously sends @msg and reads the whole response body, retrying
+ * retryable failures with backoff. See ai_client_send_and_read().
+ */
+void
+ai_client_send_and_read_async(
+    AiClient            *self,
+    SoupMessage         *msg,
+    GBytes              *body,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+);
+
+/**
+ * ai_client_send_and_read_finish:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes an asynchronous send started with
+ * ai_client_send_and_read_async().
+ *
+ * Returns: (transfer full) (nullable): the response body, or %NULL on error
+ */
+GBytes *
+ai_client_send_and_read_finish(
+    AiClient      *self,
+    GAsyncResult  *result,
+    GError       **error
+);
+
+/**
+ * ai_client_send_async:
+ * @self: an #AiClient
+ * @msg: the #SoupMessage to send
+ * @body: (nullable): the request body, sent as application/json unless @msg
+ *   already has a Content-Type
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): callback to call when complete
+ * @user_data: (closure): user data for @callback
+ *
+ * Asynchronously sends @msg and returns the response body as a stream,
+ * for streaming responses. Retries happen only while waiting for the
+ * response headers.
+ */
+void
+ai_client_send_async(
+    AiClient            *self,
+    SoupMessage         *msg,
+    GBytes              *body,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+);
+
+/**
+ * ai_client_send_finish:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes an asynchronous send started with ai_client_send_async().
+ *
+ * Returns: (transfer full) (nullable): the response stream, or %NULL on error
+ */
+GInputStream *
+ai_client_send_finish(
+    AiClient      *self,
+    GAsyncResult  *result,
+    GError       **error
+);
+
+/**
+ * ai_client_prewarm_async:
+ * @self: an #AiClient
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async) (nullable): callback to call when complete
+ * @user_data: (closure): user data for @callback
+ *
+ * Resolves the client's endpoint and opens a connection to it, TLS
+ * handshake included, without sending a request. The connection goes
+ * into the shared session's pool, so the first request, from this or
+ * any client using the same session, skips the connection setup.
+ *
+ * Set #AiConfig:prewarm to start this when the client is created.
+ */
+void
+ai_client_prewarm_async(
+    AiClient            *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+);
+
+/**
+ * ai_client_prewarm_finish:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a pre-warm started with ai_client_prewarm_async().
+ *
+ * Returns: %TRUE if a connection was opened
+ */
+gboolean
+ai_client_prewarm_finish(
+    AiClient      *self,
+    GAsyncResult  *result,
+    GError       **error
+);
+
+/**
+ * ai_client_get_timing:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult of ai_client_send_and_read_async(),
+ *   ai_client_send_async() or ai_client_prewarm_async()
+ *
+ * Gets the latency breakdown of a finished send, from libsoup's
+ * message metrics for the attempt that succeeded. For
+ * ai_client_send_async() it covers the request up to the response
+ * headers; the caller marks %AI_TIMING_FIRST_TOKEN and
+ * %AI_TIMING_TOTAL while reading the stream. For a pre-warm it has
+ * the connection phases and %AI_TIMING_TOTAL.
+ *
+ * Returns: (transfer full) (nullable): the #AiTiming, or %NULL if the
+ *   send failed
+ */
+AiTiming *
+ai_client_get_timing(
+    AiClient     *self,
+    GAsyncResult *result
+);
+
+/**
+ * ai_client_parse_chat_result:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult of ai_client_send_and_read_async()
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a chat request sent with ai_client_send_and_read_async():
+ * parses the response body with the parse_response virtual method and
+ * attaches the request's #AiTiming, JSON parse time included.
+ *
+ * Returns: (transfer full) (nullable): the #AiResponse, or %NULL on error
+ */
+AiResponse *
+ai_client_parse_chat_result(
+    AiClient      *self,
+    GAsyncResult  *result,
+    GError       **error
+);
+
+/**
+ * ai_client_parse_chat_result_async:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult of ai_client_send_and_read_async()
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): callback to call when done
+ * @user_data: user data for the callback
+ *
+ * Parses a chat response like ai_client_parse_chat_result(), without
+ * blocking the caller's main loop on large bodies. A body of at least
+ * #AiConfig:parse-thread-threshold bytes is parsed in a #GTask worker
+ * thread; a smaller one is parsed in place. Either way @callback is
+ * called in the thread-default main context of the caller.
+ *
+ * The provider's parse_response virtual method may run in a worker
+ * thread, so it must not change the client.
+ */
+void
+ai_client_parse_chat_result_async(
+    AiClient            *self,
+    GAsyncResult        *result,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+);
+
+/**
+ * ai_client_parse_chat_result_finish:
+ * @self: an #AiClient
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a parse started with ai_client_parse_chat_result_async().
+ *
+ * Returns: (transfer full) (nullable): the #AiResponse, or %NULL on error
+ */
+AiResponse *
+ai_client_parse_chat_result_finish(
+    AiClient      *self,
+    GAsyncResult  *result,
+    GError       **error
+);
+
+/**
+ * ai_client_build_request_body:
+ * @self: an #AiClient
+ * @messages: (element-type AiMessage): the conversation messages
+ * @system_prompt: (nullable): the system prompt
+ * @max_tokens: the maximum number of tokens to generate
+ * @tools: (element-type AiTool) (nullable): the available tools
+ * @stream: whether to request a streaming response
+ *
+ * Serializes the request body for the provider into a single buffer,
+ * ready to be sent with ai_client_send_and_read() or ai_client_send_async().
+ *
+ * Returns: (transfer full) (nullable): the JSON request body, or %NULL on error
+ */
+GBytes *
+ai_client_build_request_body(
+    AiClient    *self,
+    GList       *messages,
+    const gchar *system_prompt,
+    gint         max_tokens,
+    GList       *tools,
+    gboolean     stream
+);
+
+/**
+ * ai_client_resolve_options:
+ * @self: an #AiClient
+ * @options: (nullable): the request's #AiRequestOptions
+ *
+ * Copies @options and fills in the settings it leaves unset from the
+ * client's properties: model, system prompt, max tokens and
+ * temperature. The client's properties are only read, so requests on
+ * different threads can resolve their options concurrently, as long as
+ * nothing changes the properties meanwhile.
+ *
+ * Returns: (transfer full): the resolved #AiRequestOptions
+ */
+AiRequestOptions *
+ai_client_resolve_options(
+    AiClient               *self,
+    const AiRequestOptions *options
+);
+
+/**
+ * ai_client_build_request_body_with_options:
+ * @self: an #AiClient
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the #AiRequestOptions
+ * @stream: whether to request a streaming response
+ *
+ * Serializes the request body for @options, resolved with
+ * ai_client_resolve_options().
+ *
+ * Returns: (transfer full) (nullable): the JSON request body, or %NULL on error
+ */
+GBytes *
+ai_client_build_request_body_with_options(
+    AiClient               *self,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    gboolean                stream
+);
+
+/**
+ * ai_client_create_request:
+ * @self: an #AiClient
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the #AiRequestOptions
+ * @stream: whether to request a streaming response
+ * @body: (out) (transfer full): return location for the request body
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Builds the HTTP request for a chat completion: the body, the URL
+ * from the get_request_url virtual method and the authentication
+ * headers. Send it with ai_client_send_and_read_async() or
+ * ai_client_send_async().
+ *
+ * Returns: (transfer full) (nullable): the #SoupMessage, or %NULL on error
+ */
+SoupMessage *
+ai_client_create_request(
+    AiClient                *self,
+    GList                   *messages,
+    const AiRequestOptions  *options,
+    gboolean                 stream,
+    GBytes                 **body,
+    GError                 **error
+);
+
 /**
  * ai_client_chat_sync:
  * @self: an #AiClient
@@ -193,7 +754,8 @@ ai_client_get_soup_session(AiClient *self);
  * @cancellable: (nullable): a #GCancellable
  * @error: (out) (optional): return location for a #GError
  *
- * Performs a synchronous chat completion request.
+ * Performs a synchronous chat completion request with the client's
+ * settings.
  *
  * Returns: (transfer full) (nullable): the #AiResponse, or %NULL on error
  */
@@ -205,4 +767,27 @@ ai_client_chat_sync(
     GError       **error
 );
 
+/**
+ * ai_client_chat_sync_with_options:
+ * @self: an #AiClient
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the #AiRequestOptions
+ * @cancellable: (nullable): a #GCancellable
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Performs a synchronous chat completion request with @options. The
+ * client is not modified, so several threads can call this on one
+ * client at the same time.
+ *
+ * Returns: (transfer full) (nullable): the #AiResponse, or %NULL on error
+ */
+AiResponse *
+ai_client_chat_sync_with_options(
+    AiClient                *self,
+    GList                   *messages,
+    const AiRequestOptions  *options,
+    GCancellable            *cancellable,
+    GError                 **error
+);
+
 G_END_DECLS
@@ -43,6 +43,27 @@
 #define AI_GLIB_DEFAULT_PROVIDER_ENV "AI_GLIB_DEFAULT_PROVIDER"
 #define AI_GLIB_DEFAULT_MODEL_ENV    "AI_GLIB_DEFAULT_MODEL"
 
+/*
+ * Where requests of one prompt tier are routed.
+ */
+typedef struct
+{
+    gboolean        set;
+    AiProviderType  provider;
+    gchar          *model;
+    gint            max_tokens;
+} ConfigRoute;
+
+#define N_ROUTES (AI_PROMPT_TIER_REASONING + 1)
+
+/* The HTTP providers, the ones with API keys and base URLs */
+#define N_HTTP_PROVIDERS (AI_PROVIDER_OLLAMA + 1)
+
+/* Keys of the `routing` section, indexed by AiPromptTier */
+static const gchar *route_tier_names[N_ROUTES] = {
+    "simple", "moderate", "complex", "reasoning"
+};
+
 /*
  * Private data structure for AiConfig.
  * Stores API keys, base URLs, and other configuration options.
@@ -59,12 +80,27 @@ struct _AiConfig
     gchar *ollama_api_key;   /* Optional - Ollama may require auth in some setups */
 
     /* Custom base URLs (overrides defaults) */
+    gchar *claude_base_url;
     gchar *openai_base_url;
+    gchar *gemini_base_url;
+    gchar *grok_base_url;
     gchar *ollama_base_url;
 
+    /* Keys and base URLs requests are spread over, indexed by provider */
+    GStrv  api_key_pools[N_HTTP_PROVIDERS];
+    GStrv  base_url_pools[N_HTTP_PROVIDERS];
+
     /* Request settings */
     guint timeout_seconds;
     guint max_retries;
+    guint max_connections;
+    gboolean prewarm;
+    gsize parse_thread_threshold;
+
+    /* Client-side rate limits, 0 for none */
+    guint requests_per_minute;
+    guint input_tokens_per_minute;
+    guint output_tokens_per_minute;
 
     /* Default provider and model from config file */
     AiProviderType default_provider;
@@ -72,6 +108,9 @@ struct _AiConfig
     gboolean       default_provider_programmatic; /* TRUE if set via set_default_provider() */
     gchar         *default_model;
     gboolean       default_model_programmatic;  /* TRUE if set via set_default_model() */
+
+    /* Model routing per prompt tier */
+    ConfigRoute    routes[N_ROUTES];
 };
 
 G_DEFINE_TYPE(AiConfig, ai_config, G_TYPE_OBJECT)
@@ -84,6 +123,12 @@ enum
     PROP_0,
     PROP_TIMEOUT,
     PROP_MAX_RETRIES,
+    PROP_MAX_CONNECTIONS,
+    PROP_PREWARM,
+    PROP_PARSE_THREAD_THRESHOLD,
+    PROP_REQUESTS_PER_MINUTE,
+    PROP_INPUT_TOKENS_PER_MINUTE,
+    PROP_OUTPUT_TOKENS_PER_MINUTE,
     N_PROPS
 };
 
@@ -101,16 +146,31 @@ static void
 ai_config_finalize(GObject *object)
 {
     AiConfig *self = AI_CONFIG(object);
+    guint i;
 
     g_clear_pointer(&self->claude_api_key, g_free);
     g_clear_pointer(&self->openai_api_key, g_free);
     g_clear_pointer(&self->gemini_api_key, g_free);
     g_clear_pointer(&self->grok_api_key, g_free);
     g_clear_pointer(&self->ollama_api_key, g_free);
+    g_clear_pointer(&self->claude_base_url, g_free);
     g_clear_pointer(&self->openai_base_url, g_free);
+    g_clear_pointer(&self->gemini_base_url, g_free);
+    g_clear_pointer(&self->grok_base_url, g_free);
     g_clear_pointer(&self->ollama_base_url, g_free);
     g_clear_pointer(&self->default_model, g_free);
 
+    for (i = 0; i < N_ROUTES; i++)
+    {
+        g_clear_pointer(&self->routes[i].model, g_free);
+    }
+
+    for (i = 0; i < N_HTTP_PROVIDERS; i++)
+    {
+        g_clear_pointer(&self->api_key_pools[i], g_strfreev);
+        g_clear_pointer(&self->base_url_pools[i], g_strfreev);
+    }
+
     G_OBJECT_CLASS(ai_config_parent_class)->finalize(object);
 }
 
@@ -131,6 +191,24 @@ ai_config_get_property(
         case PROP_MAX_RETRIES:
             g_value_set_uint(value, self->max_retries);
             break;
+        case PROP_MAX_CONNECTIONS:
+            g_value_set_uint(value, self->max_connections);
+            break;
+        case PROP_PREWARM:
+            g_value_set_boolean(value, self->prewarm);
+            break;
+        case PROP_PARSE_THREAD_THRESHOLD:
+            g_value_set_uint64(value, self->parse_thread_threshold);
+            break;
+        case PROP_REQUESTS_PER_MINUTE:
+            g_value_set_uint(value, self->requests_per_minute);
+            break;
+        case PROP_INPUT_TOKENS_PER_MINUTE:
+            g_value_set_uint(value, self->input_tokens_per_minute);
+            break;
+        case PROP_OUTPUT_TOKENS_PER_MINUTE:
+            g_value_set_uint(value, self->output_tokens_per_minute);
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
@@ -154,6 +232,24 @@ ai_config_set_property(
         case PROP_MAX_RETRIES:
             self->max_retries = g_value_get_uint(value);
             break;
+        case PROP_MAX_CONNECTIONS:
+            self->max_connections = g_value_get_uint(value);
+            break;
+        case PROP_PREWARM:
+            self->prewarm = g_value_get_boolean(value);
+            break;
+        case PROP_PARSE_THREAD_THRESHOLD:
+            self->parse_thread_threshold = (gsize)g_value_get_uint64(value);
+            break;
+        case PROP_REQUESTS_PER_MINUTE:
+            self->requests_per_minute = g_value_get_uint(value);
+            break;
+        case PROP_INPUT_TOKENS_PER_MINUTE:
+            self->input_tokens_per_minute = g_value_get_uint(value);
+            break;
+        case PROP_OUTPUT_TOKENS_PER_MINUTE:
+            self->output_tokens_per_minute = g_value_get_uint(value);
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
@@ -193,6 +289,79 @@ ai_config_class_init(AiConfigClass *klass)
                           0, G_MAXUINT, AI_CONFIG_DEFAULT_MAX_RETRIES,
                           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+    /**
+     * AiConfig:max-connections:
+     *
+     * The maximum number of concurrent connections per host.
+     */
+    properties[PROP_MAX_CONNECTIONS] =
+        g_param_spec_uint("max-connections",
+                          "Max Connections",
+                          "Maximum number of concurrent connections per host",
+                          1, G_MAXUINT, AI_CONFIG_DEFAULT_MAX_CONNECTIONS,
+                          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiConfig:prewarm:
+     *
+     * Whether clients open a connection to their endpoint on creation.
+     */
+    properties[PROP_PREWARM] =
+        g_param_spec_boolean("prewarm",
+                             "Prewarm",
+                             "Whether clients open a connection on creation",
+                             FALSE,
+                             G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiConfig:parse-thread-threshold:
+     *
+     * The response size in bytes from which chat responses are parsed
+     * in a worker thread. 0 means never.
+     */
+    properties[PROP_PARSE_THREAD_THRESHOLD] =
+        g_param_spec_uint64("parse-thread-threshold",
+                            "Parse Thread Threshold",
+                            "Response size from which parsing runs in a thread",
+                            0, G_MAXSIZE, AI_CONFIG_DEFAULT_PARSE_THREAD_THRESHOLD,
+                            G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiConfig:requests-per-minute:
+     *
+     * The client-side request rate limit, or 0 for none.
+     */
+    properties[PROP_REQUESTS_PER_MINUTE] =
+        g_param_spec_uint("requests-per-minute",
+                          "Requests Per Minute",
+                          "Client-side request rate limit",
+                          0, G_MAXUINT, 0,
+                          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiConfig:input-tokens-per-minute:
+     *
+     * The client-side input token rate limit, or 0 for none.
+     */
+    properties[PROP_INPUT_TOKENS_PER_MINUTE] =
+        g_param_spec_uint("input-tokens-per-minute",
+                          "Input Tokens Per Minute",
+                          "Client-side input token rate limit",
+                          0, G_MAXUINT, 0,
+                          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiConfig:output-tokens-per-minute:
+     *
+     * The client-side output token rate limit, or 0 for none.
+     */
+    properties[PROP_OUTPUT_TOKENS_PER_MINUTE] =
+        g_param_spec_uint("output-tokens-per-minute",
+                          "Output Tokens Per Minute",
+                          "Client-side output token rate limit",
+                          0, G_MAXUINT, 0,
+                          G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
     g_object_class_install_properties(object_class, N_PROPS, properties);
 }
 
@@ -201,6 +370,8 @@ ai_config_init(AiConfig *self)
 {
     self->timeout_seconds = AI_CONFIG_DEFAULT_TIMEOUT;
     self->max_retries = AI_CONFIG_DEFAULT_MAX_RETRIES;
+    self->max_connections = AI_CONFIG_DEFAULT_MAX_CONNECTIONS;
+    self->parse_thread_threshold = AI_CONFIG_DEFAULT_PARSE_THREAD_THRESHOLD;
 }
 
 /* Forward declaration for use in ai_config_new */
@@ -255,8 +426,9 @@ ai_config_get_default(void)
  * @provider: the #AiProviderType to get the key for
  *
  * Gets the API key for the specified provider.
- * First checks for an explicitly set key, then falls back to environment
- * variables. Environment variables checked (in order of precedence):
+ * First checks for an explicitly set key, then for the first key of the
+ * provider's key pool, then falls back to environment variables.
+ * Environment variables checked (in order of precedence):
  * - Claude: ANTHROPIC_API_KEY, CLAUDE_API_KEY
  * - OpenAI: OPENAI_API_KEY
  * - Gemini: GEMINI_API_KEY
@@ -272,9 +444,16 @@ ai_config_get_api_key(
 ){
     const gchar *key = NULL;
     const gchar *env_key = NULL;
+    const gchar *pooled = NULL;
 
     g_return_val_if_fail(AI_IS_CONFIG(self), NULL);
 
+    /* Without a single key, the first of the pool stands in for it */
+    if ((guint)provider < N_HTTP_PROVIDERS && self->api_key_pools[provider] != NULL)
+    {
+        pooled = self->api_key_pools[provider][0];
+    }
+
     /* Check for explicitly set key first, then env vars with fallbacks */
     switch (provider)
     {
@@ -284,6 +463,10 @@ ai_config_get_api_key(
             {
                 return key;
             }
+            if (pooled != NULL)
+            {
+                return pooled;
+            }
             /* Check primary env var, then alternative */
             env_key = g_getenv(ANTHROPIC_API_KEY_ENV);
             if (env_key != NULL && env_key[0] != '\0')
@@ -298,6 +481,10 @@ ai_config_get_api_key(
             {
                 return key;
             }
+            if (pooled != NULL)
+            {
+                return pooled;
+            }
             return g_getenv(OPENAI_API_KEY_ENV);
 
         case AI_PROVIDER_GEMINI:
@@ -306,6 +493,10 @@ ai_config_get_api_key(
             {
                 return key;
             }
+            if (pooled != NULL)
+            {
+                return pooled;
+            }
             return g_getenv(GEMINI_API_KEY_ENV);
 
         case AI_PROVIDER_GROK:
@@ -314,6 +505,10 @@ ai_config_get_api_key(
             {
                 return key;
             }
+            if (pooled != NULL)
+            {
+                return pooled;
+            }
             /* Check primary env var, then alternative */
             env_key = g_getenv(XAI_API_KEY_ENV);
             if (env_key != NULL && env_key[0] != '\0')
@@ -329,6 +524,10 @@ ai_config_get_api_key(
             {
                 return key;
             }
+            if (pooled != NULL)
+            {
+                return pooled;
+            }
             return g_getenv(OLLAMA_API_KEY_ENV);
 
         default:
@@ -386,8 +585,9 @@ ai_config_set_api_key(
  * @provider: the #AiProviderType to get the URL for
  *
  * Gets the base URL for the specified provider.
- * Checks for explicit settings, then environment variables, then returns
- * the default URL.
+ * Checks for explicit settings, then the first URL of the provider's
+ * base URL pool, then environment variables, then returns the default
+ * URL.
  *
  * Returns: (transfer none): the base URL
  */
@@ -397,13 +597,23 @@ ai_config_get_base_url(
     AiProviderType  provider
 ){
     const gchar *url = NULL;
+    const gchar *pooled = NULL;
 
     g_return_val_if_fail(AI_IS_CONFIG(self), NULL);
 
+    if ((guint)provider < N_HTTP_PROVIDERS && self->base_url_pools[provider] != NULL)
+    {
+        pooled = self->base_url_pools[provider][0];
+    }
+
     switch (provider)
     {
         case AI_PROVIDER_CLAUDE:
-            return CLAUDE_BASE_URL;
+            if (self->claude_base_url != NULL && self->claude_base_url[0] != '\0')
+            {
+                return self->claude_base_url;
+            }
+            return pooled != NULL ? pooled : CLAUDE_BASE_URL;
 
         case AI_PROVIDER_OPENAI:
             /* Check explicit setting first */
@@ -411,6 +621,10 @@ ai_config_get_base_url(
             {
                 return self->openai_base_url;
             }
+            if (pooled != NULL)
+            {
+                return pooled;
+            }
             /* Check environment variable */
             url = g_getenv(OPENAI_BASE_URL_ENV);
             if (url != NULL && url[0] != '\0')
@@ -420,10 +634,18 @@ ai_config_get_base_url(
             return OPENAI_BASE_URL;
 
         case AI_PROVIDER_GEMINI:
-            return GEMINI_BASE_URL;
+            if (self->gemini_base_url != NULL && self->gemini_base_url[0] != '\0')
+            {
+                return self->gemini_base_url;
+            }
+            return pooled != NULL ? pooled : GEMINI_BASE_URL;
 
         case AI_PROVIDER_GROK:
-            return GROK_BASE_URL;
+            if (self->grok_base_url != NULL && self->grok_base_url[0] != '\0')
+            {
+                return self->grok_base_url;
+            }
+            return pooled != NULL ? pooled : GROK_BASE_URL;
 
         case AI_PROVIDER_OLLAMA:
             /* Check explicit setting first */
@@ -431,6 +653,10 @@ ai_config_get_base_url(
             {
                 return self->ollama_base_url;
             }
+            if (pooled != NULL)
+            {
+                return pooled;
+            }
             /* Check environment variable */
             url = g_getenv(OLLAMA_HOST_ENV);
             if (url != NULL && url[0] != '\0')
@@ -450,8 +676,8 @@ ai_config_get_base_url(
  * @provider: the #AiProviderType to set the URL for
  * @base_url: (nullable): the base URL to set, or %NULL to use default
  *
- * Sets the base URL for the specified provider.
- * Only OpenAI and Ollama support custom base URLs.
+ * Sets the base URL for the specified provider, for a proxy, gateway
+ * or regional endpoint. The CLI providers have none.
  */
 void
 ai_config_set_base_url(
@@ -459,27 +685,165 @@ ai_config_set_base_url(
     AiProviderType  provider,
     const gchar    *base_url
 ){
+    gchar **target = NULL;
+
     g_return_if_fail(AI_IS_CONFIG(self));
 
     switch (provider)
     {
-        case AI_PROVIDER_OPENAI:
-            g_clear_pointer(&self->openai_base_url, g_free);
-            self->openai_base_url = g_strdup(base_url);
+        case AI_PROVIDER_CLAUDE:
+            target = &self->claude_base_url;
             break;
-
-        case AI_PROVIDER_OLLAMA:
-            g_clear_pointer(&self->ollama_base_url, g_free);
-            self->ollama_base_url = g_strdup(base_url);
+        case AI_PROVIDER_OPENAI:
+            target = &self->openai_base_url;
             break;
-
-        case AI_PROVIDER_CLAUDE:
         case AI_PROVIDER_GEMINI:
+            target = &self->gemini_base_url;
+            break;
         case AI_PROVIDER_GROK:
-        default:
-            /* These providers don't support custom base URLs */
+            target = &self->grok_base_url;
+            break;
+        case AI_PROVIDER_OLLAMA:
+            target = &self->ollama_base_url;
             break;
+        default:
+            /* The CLI providers don't use base URLs */
+            return;
     }
+
+    g_clear_pointer(target, g_free);
+    *target = g_strdup(base_url);
+}
+
+/*
+ * Replace a pool, dropping empty entries. An empty pool is no pool.
+ */
+static void
+set_pool(
+    GStrv              *pool,
+    const gchar *const *values
+){
+    GPtrArray *array = g_ptr_array_new();
+    guint i;
+
+    for (i = 0; values != NULL && values[i] != NULL; i++)
+    {
+        if (values[i][0] != '\0')
+        {
+            g_ptr_array_add(array, g_strdup(values[i]));
+        }
+    }
+
+    g_clear_pointer(pool, g_strfreev);
+
+    if (array->len == 0)
+    {
+        g_ptr_array_free(array, TRUE);
+        return;
+    }
+
+    g_ptr_array_add(array, NULL);
+    *pool = (GStrv)g_ptr_array_free(array, FALSE);
+}
+
+/**
+ * ai_config_get_api_keys:
+ * @self: an #AiConfig
+ * @provider: the #AiProviderType to get the keys for
+ *
+ * Gets the pool of API keys requests to @provider are spread over.
+ *
+ * Returns: (transfer none) (nullable) (array zero-terminated=1): the
+ *   keys, or %NULL if there is no pool
+ */
+const gchar *const *
+ai_config_get_api_keys(
+    AiConfig       *self,
+    AiProviderType  provider
+){
+    g_return_val_if_fail(AI_IS_CONFIG(self), NULL);
+
+    if ((guint)provider >= N_HTTP_PROVIDERS)
+    {
+        return NULL;
+    }
+
+    return (const gchar *const *)self->api_key_pools[provider];
+}
+
+/**
+ * ai_config_set_api_keys:
+ * @self: an #AiConfig
+ * @provider: the #AiProviderType to set the keys for
+ * @api_keys: (nullable) (array zero-terminated=1): the keys, or %NULL
+ *   for no pool
+ *
+ * Sets the pool of API keys requests to @provider are spread over.
+ */
+void
+ai_config_set_api_keys(
+    AiConfig           *self,
+    AiProviderType      provider,
+    const gchar *const *api_keys
+){
+    g_return_if_fail(AI_IS_CONFIG(self));
+
+    if ((guint)provider >= N_HTTP_PROVIDERS)
+    {
+        return;
+    }
+
+    set_pool(&self->api_key_pools[provider], api_keys);
+}
+
+/**
+ * ai_config_get_base_urls:
+ * @self: an #AiConfig
+ * @provider: the #AiProviderType to get the URLs for
+ *
+ * Gets the pool of base URLs requests to @provider are spread over.
+ *
+ * Returns: (transfer none) (nullable) (array zero-terminated=1): the
+ *   URLs, or %NULL if there is no pool
+ */
+const gchar *const *
+ai_config_get_base_urls(
+    AiConfig       *self,
+    AiProviderType  provider
+){
+    g_return_val_if_fail(AI_IS_CONFIG(self), NULL);
+
+    if ((guint)provider >= N_HTTP_PROVIDERS)
+    {
+        return NULL;
+    }
+
+    return (const gchar *const *)self->base_url_pools[provider];
+}
+
+/**
+ * ai_config_set_base_urls:
+ * @self: an #AiConfig
+ * @provider: the #AiProviderType to set the URLs for
+ * @base_urls: (nullable) (array zero-terminated=1): the URLs, or %NULL
+ *   for no pool
+ *
+ * Sets the pool of base URLs requests to @provider are spread over.
+ */
+void
+ai_config_set_base_urls(
+    AiConfig           *self,
+    AiProviderType      provider,
+    const gchar *const *base_urls
+){
+    g_return_if_fail(AI_IS_CONFIG(self));
+
+    if ((guint)provider >= N_HTTP_PROVIDERS)
+    {
+        return;
+    }
+
+    set_pool(&self->base_url_pools[provider], base_urls);
 }
 
 /**
@@ -550,6 +914,219 @@ ai_config_set_max_retries(
     g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_MAX_RETRIES]);
 }
 
+/**
+ * ai_config_get_max_connections:
+ * @self: an #AiConfig
+ *
+ * Gets the maximum number of concurrent connections per host.
+ *
+ * Returns: the maximum connection count
+ */
+guint
+ai_config_get_max_connections(AiConfig *self)
+{
+    g_return_val_if_fail(AI_IS_CONFIG(self), AI_CONFIG_DEFAULT_MAX_CONNECTIONS);
+
+    return self->max_connections;
+}
+
+/**
+ * ai_config_set_max_connections:
+ * @self: an #AiConfig
+ * @max_connections: the maximum connection count
+ *
+ * Sets the maximum number of concurrent connections per host.
+ * Clients created afterwards share a session with this limit.
+ */
+void
+ai_config_set_max_connections(
+    AiConfig *self,
+    guint     max_connections
+){
+    g_return_if_fail(AI_IS_CONFIG(self));
+    g_return_if_fail(max_connections > 0);
+
+    self->max_connections = max_connections;
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_MAX_CONNECTIONS]);
+}
+
+/**
+ * ai_config_get_prewarm:
+ * @self: an #AiConfig
+ *
+ * Gets whether clients open a connection to their endpoint as soon as
+ * they are created.
+ *
+ * Returns: %TRUE if clients pre-warm their connection
+ */
+gboolean
+ai_config_get_prewarm(AiConfig *self)
+{
+    g_return_val_if_fail(AI_IS_CONFIG(self), FALSE);
+
+    return self->prewarm;
+}
+
+/**
+ * ai_config_set_prewarm:
+ * @self: an #AiConfig
+ * @prewarm: whether clients pre-warm their connection
+ *
+ * Sets whether clients created with this config start
+ * ai_client_prewarm_async() on construction.
+ */
+void
+ai_config_set_prewarm(
+    AiConfig *self,
+    gboolean  prewarm
+){
+    g_return_if_fail(AI_IS_CONFIG(self));
+
+    self->prewarm = prewarm;
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_PREWARM]);
+}
+
+/**
+ * ai_config_get_parse_thread_threshold:
+ * @self: an #AiConfig
+ *
+ * Gets the response size from which chat responses are parsed in a
+ * worker thread.
+ *
+ * Returns: the threshold in bytes, or 0 for never
+ */
+gsize
+ai_config_get_parse_thread_threshold(AiConfig *self)
+{
+    g_return_val_if_fail(AI_IS_CONFIG(self), 0);
+
+    return self->parse_thread_threshold;
+}
+
+/**
+ * ai_config_set_parse_thread_threshold:
+ * @self: an #AiConfig
+ * @threshold: the size in bytes, or 0 to never use a worker thread
+ *
+ * Sets the response size from which chat responses are parsed in a
+ * worker thread.
+ */
+void
+ai_config_set_parse_thread_threshold(
+    AiConfig *self,
+    gsize     threshold
+){
+    g_return_if_fail(AI_IS_CONFIG(self));
+
+    self->parse_thread_threshold = threshold;
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_PARSE_THREAD_THRESHOLD]);
+}
+
+/**
+ * ai_config_get_requests_per_minute:
+ * @self: an #AiConfig
+ *
+ * Gets the client-side request rate limit.
+ *
+ * Returns: the limit, or 0 for none
+ */
+guint
+ai_config_get_requests_per_minute(AiConfig *self)
+{
+    g_return_val_if_fail(AI_IS_CONFIG(self), 0);
+
+    return self->requests_per_minute;
+}
+
+/**
+ * ai_config_set_requests_per_minute:
+ * @self: an #AiConfig
+ * @requests_per_minute: the limit, or 0 for none
+ *
+ * Sets the client-side request rate limit. It seeds the shared rate
+ * limiter of clients created afterwards, until response headers report
+ * the real limit.
+ */
+void
+ai_config_set_requests_per_minute(
+    AiConfig *self,
+    guint     requests_per_minute
+){
+    g_return_if_fail(AI_IS_CONFIG(self));
+
+    self->requests_per_minute = requests_per_minute;
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_REQUESTS_PER_MINUTE]);
+}
+
+/**
+ * ai_config_get_input_tokens_per_minute:
+ * @self: an #AiConfig
+ *
+ * Gets the client-side input token rate limit.
+ *
+ * Returns: the limit, or 0 for none
+ */
+guint
+ai_config_get_input_tokens_per_minute(AiConfig *self)
+{
+    g_return_val_if_fail(AI_IS_CONFIG(self), 0);
+
+    return self->input_tokens_per_minute;
+}
+
+/**
+ * ai_config_set_input_tokens_per_minute:
+ * @self: an #AiConfig
+ * @input_tokens_per_minute: the limit, or 0 for none
+ *
+ * Sets the client-side input token rate limit.
+ */
+void
+ai_config_set_input_tokens_per_minute(
+    AiConfig *self,
+    guint     input_tokens_per_minute
+){
+    g_return_if_fail(AI_IS_CONFIG(self));
+
+    self->input_tokens_per_minute = input_tokens_per_minute;
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_INPUT_TOKENS_PER_MINUTE]);
+}
+
+/**
+ * ai_config_get_output_tokens_per_minute:
+ * @self: an #AiConfig
+ *
+ * Gets the client-side output token rate limit.
+ *
+ * Returns: the limit, or 0 for none
+ */
+guint
+ai_config_get_output_tokens_per_minute(AiConfig *self)
+{
+    g_return_val_if_fail(AI_IS_CONFIG(self), 0);
+
+    return self->output_tokens_per_minute;
+}
+
+/**
+ * ai_config_set_output_tokens_per_minute:
+ * @self: an #AiConfig
+ * @output_tokens_per_minute: the limit, or 0 for none
+ *
+ * Sets the client-side output token rate limit. Requests are charged
+ * their max_tokens up front, as the providers do.
+ */
+void
+ai_config_set_output_tokens_per_minute(
+    AiConfig *self,
+    guint     output_tokens_per_minute
+){
+    g_return_if_fail(AI_IS_CONFIG(self));
+
+    self->output_tokens_per_minute = output_tokens_per_minute;
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_OUTPUT_TOKENS_PER_MINUTE]);
+}
+
 /**
  * ai_config_validate:
  * @self: an #AiConfig
@@ -598,15 +1175,53 @@ ai_config_validate(
     return TRUE;
 }
 
+/*
+ * The strings of a YAML sequence member, or %NULL if it is not a
+ * sequence.
+ */
+static GStrv
+get_string_sequence(
+    YamlMapping *map,
+    const gchar *name
+){
+    YamlNode *node;
+    YamlSequence *sequence;
+    GPtrArray *array;
+    guint i;
+
+    node = yaml_mapping_get_member(map, name);
+    if (node == NULL || yaml_node_get_node_type(node) != YAML_NODE_SEQUENCE)
+    {
+        return NULL;
+    }
+
+    sequence = yaml_node_get_sequence(node);
+    array = g_ptr_array_new();
+
+    for (i = 0; i < yaml_sequence_get_length(sequence); i++)
+    {
+        const gchar *val = yaml_sequence_get_string_element(sequence, i);
+
+        if (val != NULL)
+        {
+            g_ptr_array_add(array, g_strdup(val));
+        }
+    }
+
+    g_ptr_array_add(array, NULL);
+    return (GStrv)g_ptr_array_free(array, FALSE);
+}
+
 /*
  * ai_config_apply_provider_mapping:
  * @self: an #AiConfig
  * @provider: the provider type to apply settings for
  * @provider_map: the YAML mapping for this provider's settings
  *
- * Extracts api_key and base_url from a provider's YAML mapping
- * and applies them to the config. Only sets values that are present
- * in the mapping — missing keys are silently skipped.
+ * Extracts api_key and base_url, and the api_keys and base_urls
+ * pools, from a provider's YAML mapping and applies them to the
+ * config. Only sets values that are present in the mapping — missing
+ * keys are silently skipped.
  */
 static void
 ai_config_apply_provider_mapping(
@@ -635,6 +1250,69 @@ ai_config_apply_provider_mapping(
             ai_config_set_base_url(self, provider, val);
         }
     }
+
+    /* Apply the pools if present */
+    if (yaml_mapping_has_member(provider_map, "api_keys"))
+    {
+        g_auto(GStrv) keys = get_string_sequence(provider_map, "api_keys");
+
+        ai_config_set_api_keys(self, provider, (const gchar *const *)keys);
+    }
+
+    if (yaml_mapping_has_member(provider_map, "base_urls"))
+    {
+        g_auto(GStrv) urls = get_string_sequence(provider_map, "base_urls");
+
+        ai_config_set_base_urls(self, provider, (const gchar *const *)urls);
+    }
+}
+
+/*
+ * ai_config_apply_route_mapping:
+ * @self: an #AiConfig
+ * @tier: the prompt tier the mapping is for
+ * @route_map: the YAML mapping of this tier's route
+ *
+ * Applies one entry of the `routing` section. A route without a
+ * provider is ignored.
+ */
+static void
+ai_config_apply_route_mapping(
+    AiConfig     *self,
+    AiPromptTier  tier,
+    YamlMapping  *route_map
+){
+    const gchar *provider;
+    const gchar *model = NULL;
+    gint64 max_tokens = 0;
+
+    if (!yaml_mapping_has_member(route_map, "provider"))
+    {
+        return;
+    }
+
+    provider = yaml_mapping_get_string_member(route_map, "provider");
+    if (provider == NULL || provider[0] == '\0')
+    {
+        return;
+    }
+
+    if (yaml_mapping_has_member(route_map, "model"))
+    {
+        model = yaml_mapping_get_string_member(route_map, "model");
+        if (model != NULL && model[0] == '\0')
+        {
+            model = NULL;
+        }
+    }
+
+    if (yaml_mapping_has_member(route_map, "max_tokens"))
+    {
+        max_tokens = yaml_mapping_get_int_member(route_map, "max_tokens");
+    }
+
+    ai_config_set_route(self, tier, ai_provider_type_from_string(provider), model,
+                        (gint)CLAMP(max_tokens, 0, G_MAXINT));
 }
 
 /*
@@ -748,6 +1426,86 @@ ai_config_load_from_file(
             root_map, "max_retries");
     }
 
+    /* max_connections */
+    if (yaml_mapping_has_member(root_map, "max_connections"))
+    {
+        gint64 max_connections = yaml_mapping_get_int_member(
+            root_map, "max_connections");
+
+        if (max_connections > 0)
+        {
+            self->max_connections = (guint)max_connections;
+        }
+    }
+
+    /* prewarm */
+    if (yaml_mapping_has_member(root_map, "prewarm"))
+    {
+        self->prewarm = yaml_mapping_get_boolean_member(root_map, "prewarm");
+    }
+
+    /* parse_thread_threshold */
+    if (yaml_mapping_has_member(root_map, "parse_thread_threshold"))
+    {
+        gint64 threshold = yaml_mapping_get_int_member(
+            root_map, "parse_thread_threshold");
+
+        if (threshold >= 0)
+        {
+            self->parse_thread_threshold = (gsize)threshold;
+        }
+    }
+
+    /* client-side rate limits */
+    if (yaml_mapping_has_member(root_map, "requests_per_minute"))
+    {
+        self->requests_per_minute = (guint)yaml_mapping_get_int_member(
+            root_map, "requests_per_minute");
+    }
+
+    if (yaml_mapping_has_member(root_map, "input_tokens_per_minute"))
+    {
+        self->input_tokens_per_minute = (guint)yaml_mapping_get_int_member(
+            root_map, "input_tokens_per_minute");
+    }
+
+    if (yaml_mapping_has_member(root_map, "output_tokens_per_minute"))
+    {
+        self->output_tokens_per_minute = (guint)yaml_mapping_get_int_member(
+            root_map, "output_tokens_per_minute");
+    }
+
+    /* routing section — provider, model and max_tokens per prompt tier */
+    if (yaml_mapping_has_member(root_map, "routing"))
+    {
+        YamlNode    *routing_node;
+        YamlMapping *routing_map;
+
+        routing_node = yaml_mapping_get_member(root_map, "routing");
+        if (routing_node != NULL &&
+            yaml_node_get_node_type(routing_node) == YAML_NODE_MAPPING)
+        {
+            routing_map = yaml_node_get_mapping(routing_node);
+
+            for (i = 0; i < N_ROUTES; i++)
+            {
+                YamlMapping *rmap;
+
+                if (!yaml_mapping_has_member(routing_map, route_tier_names[i]))
+                {
+                    continue;
+                }
+
+                rmap = yaml_mapping_get_mapping_member(routing_map,
+                                                       route_tier_names[i]);
+                if (rmap != NULL)
+                {
+                    ai_config_apply_route_mapping(self, (AiPromptTier)i, rmap);
+                }
+            }
+        }
+    }
+
     /* providers section — per-provider api_key and base_url */
     if (yaml_mapping_has_member(root_map, "providers"))
     {
@@ -937,3 +1695,83 @@ ai_config_set_default_model(
     self->default_model = g_strdup(model);
     self->default_model_programmatic = TRUE;
 }
+
+/**
+ * ai_config_get_route:
+ * @self: an #AiConfig
+ * @tier: the #AiPromptTier
+ * @provider: (out) (optional): return location for the provider type
+ * @model: (out) (optional) (transfer none) (nullable): return location
+ *   for the model
+ * @max_tokens: (out) (optional): return location for the token limit
+ *
+ * Gets where requests of @tier are routed.
+ *
+ * Returns: %TRUE if a route is configured for @tier
+ */
+gboolean
+ai_config_get_route(
+    AiConfig        *self,
+    AiPromptTier     tier,
+    AiProviderType  *provider,
+    const gchar    **model,
+    gint            *max_tokens
+){
+    ConfigRoute *route;
+
+    g_return_val_if_fail(AI_IS_CONFIG(self), FALSE);
+    g_return_val_if_fail((guint)tier < N_ROUTES, FALSE);
+
+    route = &self->routes[tier];
+    if (!route->set)
+    {
+        return FALSE;
+    }
+
+    if (provider != NULL)
+    {
+        *provider = route->provider;
+    }
+    if (model != NULL)
+    {
+        *model = route->model;
+    }
+    if (max_tokens != NULL)
+    {
+        *max_tokens = route->max_tokens;
+    }
+
+    return TRUE;
+}
+
+/**
+ * ai_config_set_route:
+ * @self: an #AiConfig
+ * @tier: the #AiPromptTier
+ * @provider: the provider requests of @tier go to
+ * @model: (nullable): the model, or %NULL for the provider default
+ * @max_tokens: the token limit, or 0 to keep the caller's
+ *
+ * Sets where requests of @tier are routed.
+ */
+void
+ai_config_set_route(
+    AiConfig       *self,
+    AiPromptTier    tier,
+    AiProviderType  provider,
+    const gchar    *model,
+    gint            max_tokens
+){
+    ConfigRoute *route;
+
+    g_return_if_fail(AI_IS_CONFIG(self));
+    g_return_if_fail((guint)tier < N_ROUTES);
+    g_return_if_fail(max_tokens >= 0);
+
+    route = &self->routes[tier];
+    route->set = TRUE;
+    route->provider = provider;
+    g_free(route->model);
+    route->model = g_strdup(model);
+    route->max_tokens = max_tokens;
+}
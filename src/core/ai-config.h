@@ -16,6 +16,7 @@
 #include <glib-object.h>
 
 #include "core/ai-enums.h"
+#include "core/ai-prompt-scorer.h"
 
 G_BEGIN_DECLS
 
@@ -37,6 +38,21 @@ G_DECLARE_FINAL_TYPE(AiConfig, ai_config, AI, CONFIG, GObject)
  */
 #define AI_CONFIG_DEFAULT_MAX_RETRIES (3)
 
+/**
+ * AI_CONFIG_DEFAULT_MAX_CONNECTIONS:
+ *
+ * Default maximum number of concurrent connections per host.
+ */
+#define AI_CONFIG_DEFAULT_MAX_CONNECTIONS (8)
+
+/**
+ * AI_CONFIG_DEFAULT_PARSE_THREAD_THRESHOLD:
+ *
+ * Default response size in bytes from which chat responses are parsed
+ * in a worker thread.
+ */
+#define AI_CONFIG_DEFAULT_PARSE_THREAD_THRESHOLD (256 * 1024)
+
 /**
  * AI_CONFIG_SYSTEM_DIR:
  *
@@ -88,8 +104,8 @@ ai_config_get_default(void);
  * @provider: the #AiProviderType to get the key for
  *
  * Gets the API key for the specified provider.
- * First checks for an explicitly set key, then falls back to environment
- * variables.
+ * First checks for an explicitly set key, then for the first key of the
+ * provider's key pool, then falls back to environment variables.
  *
  * Returns: (transfer none) (nullable): the API key, or %NULL if not set
  */
@@ -120,8 +136,9 @@ ai_config_set_api_key(
  * @self: an #AiConfig
  * @provider: the #AiProviderType to get the URL for
  *
- * Gets the base URL for the specified provider.
- * Some providers (like OpenAI and Ollama) support custom base URLs.
+ * Gets the base URL for the specified provider: the one set, or else
+ * the first of the provider's base URL pool, or else the one from the
+ * environment (OpenAI and Ollama only), or else the default.
  *
  * Returns: (transfer none): the base URL
  */
@@ -137,7 +154,8 @@ ai_config_get_base_url(
  * @provider: the #AiProviderType to set the URL for
  * @base_url: (nullable): the base URL to set, or %NULL to use default
  *
- * Sets the base URL for the specified provider.
+ * Sets the base URL for the specified provider, for a proxy, gateway
+ * or regional endpoint. The CLI providers have none.
  */
 void
 ai_config_set_base_url(
@@ -146,6 +164,80 @@ ai_config_set_base_url(
     const gchar    *base_url
 );
 
+/**
+ * ai_config_get_api_keys:
+ * @self: an #AiConfig
+ * @provider: the #AiProviderType to get the keys for
+ *
+ * Gets the pool of API keys requests to @provider are spread over.
+ *
+ * Returns: (transfer none) (nullable) (array zero-terminated=1): the
+ *   keys, or %NULL if there is no pool
+ */
+const gchar *const *
+ai_config_get_api_keys(
+    AiConfig       *self,
+    AiProviderType  provider
+);
+
+/**
+ * ai_config_set_api_keys:
+ * @self: an #AiConfig
+ * @provider: the #AiProviderType to set the keys for
+ * @api_keys: (nullable) (array zero-terminated=1): the keys, or %NULL
+ *   for no pool
+ *
+ * Sets the pool of API keys requests to @provider are spread over,
+ * for example several keys of one organization, each with its own
+ * rate limits. A client balances its requests over every pair of a
+ * pooled key and a pooled base URL; see ai_client_get_balancer().
+ *
+ * The key set with ai_config_set_api_key(), if any, is the one used
+ * where a single key is needed, such as for batch jobs. Otherwise the
+ * first key of the pool is.
+ */
+void
+ai_config_set_api_keys(
+    AiConfig           *self,
+    AiProviderType      provider,
+    const gchar *const *api_keys
+);
+
+/**
+ * ai_config_get_base_urls:
+ * @self: an #AiConfig
+ * @provider: the #AiProviderType to get the URLs for
+ *
+ * Gets the pool of base URLs requests to @provider are spread over.
+ *
+ * Returns: (transfer none) (nullable) (array zero-terminated=1): the
+ *   URLs, or %NULL if there is no pool
+ */
+const gchar *const *
+ai_config_get_base_urls(
+    AiConfig       *self,
+    AiProviderType  provider
+);
+
+/**
+ * ai_config_set_base_urls:
+ * @self: an #AiConfig
+ * @provider: the #AiProviderType to set the URLs for
+ * @base_urls: (nullable) (array zero-terminated=1): the URLs, or %NULL
+ *   for no pool
+ *
+ * Sets the pool of base URLs requests to @provider are spread over,
+ * such as the regional endpoints of one API. Like the key pool, the
+ * first URL stands in for ai_config_get_base_url() when no single base
+ * URL is set.
+ */
+void
+ai_config_set_base_urls(
+    AiConfig           *self,
+    AiProviderType      provider,
+    const gchar *const *base_urls
+);
+
 /**
  * ai_config_get_timeout:
  * @self: an #AiConfig
@@ -194,6 +286,164 @@ ai_config_set_max_retries(
     guint     max_retries
 );
 
+/**
+ * ai_config_get_max_connections:
+ * @self: an #AiConfig
+ *
+ * Gets the maximum number of concurrent connections per host.
+ *
+ * Returns: the maximum connection count
+ */
+guint
+ai_config_get_max_connections(AiConfig *self);
+
+/**
+ * ai_config_set_max_connections:
+ * @self: an #AiConfig
+ * @max_connections: the maximum connection count
+ *
+ * Sets the maximum number of concurrent connections per host.
+ * Clients created afterwards share a session with this limit.
+ */
+void
+ai_config_set_max_connections(
+    AiConfig *self,
+    guint     max_connections
+);
+
+/**
+ * ai_config_get_prewarm:
+ * @self: an #AiConfig
+ *
+ * Gets whether clients open a connection to their endpoint as soon as
+ * they are created.
+ *
+ * Returns: %TRUE if clients pre-warm their connection
+ */
+gboolean
+ai_config_get_prewarm(AiConfig *self);
+
+/**
+ * ai_config_set_prewarm:
+ * @self: an #AiConfig
+ * @prewarm: whether clients pre-warm their connection
+ *
+ * Sets whether clients created with this config start
+ * ai_client_prewarm_async() on construction, so the DNS lookup and
+ * TLS handshake overlap with whatever the program does before its
+ * first request.
+ */
+void
+ai_config_set_prewarm(
+    AiConfig *self,
+    gboolean  prewarm
+);
+
+/**
+ * ai_config_get_parse_thread_threshold:
+ * @self: an #AiConfig
+ *
+ * Gets the response size from which chat responses are parsed in a
+ * worker thread.
+ *
+ * Returns: the threshold in bytes, or 0 if responses are always parsed
+ *   in the calling thread
+ */
+gsize
+ai_config_get_parse_thread_threshold(AiConfig *self);
+
+/**
+ * ai_config_set_parse_thread_threshold:
+ * @self: an #AiConfig
+ * @threshold: the size in bytes, or 0 to never use a worker thread
+ *
+ * Sets the response size from which chat responses are parsed in a
+ * worker thread. Decoding a response with large images or tool results
+ * can take tens of milliseconds; off the main loop, it no longer holds
+ * up the deltas of other streams on that loop. Smaller responses are
+ * parsed in place, where a thread hop would cost more than it saves.
+ */
+void
+ai_config_set_parse_thread_threshold(
+    AiConfig *self,
+    gsize     threshold
+);
+
+/**
+ * ai_config_get_requests_per_minute:
+ * @self: an #AiConfig
+ *
+ * Gets the client-side request rate limit.
+ *
+ * Returns: the limit, or 0 for none
+ */
+guint
+ai_config_get_requests_per_minute(AiConfig *self);
+
+/**
+ * ai_config_set_requests_per_minute:
+ * @self: an #AiConfig
+ * @requests_per_minute: the limit, or 0 for none
+ *
+ * Sets the client-side request rate limit. It seeds the shared rate
+ * limiter of clients created afterwards, until response headers report
+ * the real limit.
+ */
+void
+ai_config_set_requests_per_minute(
+    AiConfig *self,
+    guint     requests_per_minute
+);
+
+/**
+ * ai_config_get_input_tokens_per_minute:
+ * @self: an #AiConfig
+ *
+ * Gets the client-side input token rate limit.
+ *
+ * Returns: the limit, or 0 for none
+ */
+guint
+ai_config_get_input_tokens_per_minute(AiConfig *self);
+
+/**
+ * ai_config_set_input_tokens_per_minute:
+ * @self: an #AiConfig
+ * @input_tokens_per_minute: the limit, or 0 for none
+ *
+ * Sets the client-side input token rate limit.
+ */
+void
+ai_config_set_input_tokens_per_minute(
+    AiConfig *self,
+    guint     input_tokens_per_minute
+);
+
+/**
+ * ai_config_get_output_tokens_per_minute:
+ * @self: an #AiConfig
+ *
+ * Gets the client-side output token rate limit.
+ *
+ * Returns: the limit, or 0 for none
+ */
+guint
+ai_config_get_output_tokens_per_minute(AiConfig *self);
+
+/**
+ * ai_config_set_output_tokens_per_minute:
+ * @self: an #AiConfig
+ * @output_tokens_per_minute: the limit, or 0 for none
+ *
+ * Sets the client-side output token rate limit. Requests are charged
+ * their max_tokens up front, as the providers do.
+ */
+void
+ai_config_set_output_tokens_per_minute(
+    AiConfig *self,
+    guint     output_tokens_per_minute
+);
+
 /**
  * ai_config_validate:
  * @self: an #AiConfig
@@ -227,7 +477,14 @@ ai_config_validate(
  * - default_model: model name string
  * - timeout: integer seconds
  * - max_retries: integer count
- * - providers: mapping of provider name to settings (api_key, base_url)
+ * - max_connections: integer count of connections per host
+ * - prewarm: boolean, open a connection when a client is created
+ * - parse_thread_threshold: integer bytes from which responses are
+ *   parsed in a worker thread (0 for never)
+ * - requests_per_minute, input_tokens_per_minute,
+ *   output_tokens_per_minute: client-side rate limits (0 for none)
+ * - providers: mapping of provider name to settings (api_key, base_url,
+ *   and the api_keys and base_urls pools as sequences of strings)
  *
  * Returns: %TRUE on success, %FALSE on parse error
  */
@@ -300,4 +557,48 @@ ai_config_set_default_model(
     const gchar *model
 );
 
+/**
+ * ai_config_get_route:
+ * @self: an #AiConfig
+ * @tier: the #AiPromptTier
+ * @provider: (out) (optional): return location for the provider type
+ * @model: (out) (optional) (transfer none) (nullable): return location
+ *   for the model, %NULL for the provider default
+ * @max_tokens: (out) (optional): return location for the token limit,
+ *   0 for the caller's
+ *
+ * Gets where requests of @tier are routed, from the `routing` section
+ * of the config file or ai_config_set_route().
+ *
+ * Returns: %TRUE if a route is configured for @tier
+ */
+gboolean
+ai_config_get_route(
+    AiConfig        *self,
+    AiPromptTier     tier,
+    AiProviderType  *provider,
+    const gchar    **model,
+    gint            *max_tokens
+);
+
+/**
+ * ai_config_set_route:
+ * @self: an #AiConfig
+ * @tier: the #AiPromptTier
+ * @provider: the provider requests of @tier go to
+ * @model: (nullable): the model, or %NULL for the provider default
+ * @max_tokens: the token limit, or 0 to keep the caller's
+ *
+ * Sets where requests of @tier are routed by an #AiRouterProvider
+ * created from this config.
+ */
+void
+ai_config_set_route(
+    AiConfig       *self,
+    AiPromptTier    tier,
+    AiProviderType  provider,
+    const gchar    *model,
+    gint            max_tokens
+);
+
 G_END_DECLS
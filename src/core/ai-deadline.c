@@ -0,0 +1,307 @@
+/*
+ * ai-deadline.c - Absolute deadlines for requests
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include "core/ai-deadline.h"
+#include "core/ai-error.h"
+
+struct _AiDeadline
+{
+    gint64        deadline;
+    GCancellable *parent;           /* the caller's, nullable */
+    GCancellable *cancellable;
+    gulong        parent_handler;
+    GSource      *source;           /* on the timer thread, nullable */
+};
+
+/*
+ * All deadline timers run on one thread. Cancelling from there also
+ * interrupts callers that block in a synchronous call, which a timer
+ * on their own context could not.
+ */
+static gpointer
+timer_thread(gpointer user_data)
+{
+    GMainContext *context = user_data;
+
+    for (;;)
+    {
+        g_main_context_iteration(context, TRUE);
+    }
+
+    return NULL;
+}
+
+static GMainContext *
+get_timer_context(void)
+{
+    static gsize initialized = 0;
+    static GMainContext *context = NULL;
+
+    if (g_once_init_enter(&initialized))
+    {
+        context = g_main_context_new();
+        g_thread_unref(g_thread_new("ai-deadline", timer_thread, context));
+        g_once_init_leave(&initialized, 1);
+    }
+
+    return context;
+}
+
+/*
+ * A source that fires once at its ready time, which is on the same
+ * monotonic clock as the deadline, so no rounding to milliseconds.
+ */
+static gboolean
+deadline_source_dispatch(
+    GSource     *source,
+    GSourceFunc  callback,
+    gpointer     user_data
+){
+    (void)source;
+
+    return callback(user_data);
+}
+
+static GSourceFuncs deadline_source_funcs = {
+    NULL,
+    NULL,
+    deadline_source_dispatch,
+    NULL,
+    NULL,
+    NULL
+};
+
+static gboolean
+on_deadline_reached(gpointer user_data)
+{
+    g_cancellable_cancel(G_CANCELLABLE(user_data));
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+on_parent_cancelled(
+    GCancellable *parent,
+    gpointer      user_data
+){
+    (void)parent;
+
+    g_cancellable_cancel(G_CANCELLABLE(user_data));
+}
+
+/**
+ * ai_deadline_new:
+ * @deadline: the time, in g_get_monotonic_time() microseconds, or 0 for none
+ * @cancellable: (nullable): the caller's #GCancellable
+ *
+ * Creates a deadline whose cancellable is cancelled at @deadline or
+ * with @cancellable.
+ *
+ * Returns: (transfer full): a new #AiDeadline
+ */
+AiDeadline *
+ai_deadline_new(
+    gint64        deadline,
+    GCancellable *cancellable
+){
+    AiDeadline *self;
+
+    g_return_val_if_fail(deadline >= 0, NULL);
+    g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
+
+    self = g_slice_new0(AiDeadline);
+    self->deadline = deadline;
+    self->parent = cancellable != NULL ? g_object_ref(cancellable) : NULL;
+
+    if (deadline == 0)
+    {
+        self->cancellable = self->parent != NULL ? g_object_ref(self->parent) : NULL;
+        return self;
+    }
+
+    self->cancellable = g_cancellable_new();
+
+    if (self->parent != NULL)
+    {
+        self->parent_handler = g_cancellable_connect(self->parent,
+                                                     G_CALLBACK(on_parent_cancelled),
+                                                     g_object_ref(self->cancellable),
+                                                     g_object_unref);
+    }
+
+    self->source = g_source_new(&deadline_source_funcs, sizeof(GSource));
+    g_source_set_name(self->source, "[ai-glib] deadline");
+    g_source_set_ready_time(self->source, deadline);
+    g_source_set_callback(self->source, on_deadline_reached,
+                          g_object_ref(self->cancellable), g_object_unref);
+    g_source_attach(self->source, get_timer_context());
+
+    return self;
+}
+
+/**
+ * ai_deadline_free:
+ * @self: (nullable): an #AiDeadline
+ *
+ * Stops the timer and frees @self.
+ */
+void
+ai_deadline_free(AiDeadline *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+
+    if (self->source != NULL)
+    {
+        g_source_destroy(self->source);
+        g_source_unref(self->source);
+    }
+
+    if (self->parent_handler != 0)
+    {
+        g_cancellable_disconnect(self->parent, self->parent_handler);
+    }
+
+    g_clear_object(&self->cancellable);
+    g_clear_object(&self->parent);
+    g_slice_free(AiDeadline, self);
+}
+
+/**
+ * ai_deadline_get_time:
+ * @self: an #AiDeadline
+ *
+ * Gets the deadline.
+ *
+ * Returns: the time in microseconds, or 0 for none
+ */
+gint64
+ai_deadline_get_time(const AiDeadline *self)
+{
+    g_return_val_if_fail(self != NULL, 0);
+
+    return self->deadline;
+}
+
+/**
+ * ai_deadline_get_cancellable:
+ * @self: an #AiDeadline
+ *
+ * Gets the cancellable to run the work under.
+ *
+ * Returns: (transfer none) (nullable): the #GCancellable
+ */
+GCancellable *
+ai_deadline_get_cancellable(AiDeadline *self)
+{
+    g_return_val_if_fail(self != NULL, NULL);
+
+    return self->cancellable;
+}
+
+/**
+ * ai_deadline_has_expired:
+ * @self: an #AiDeadline
+ *
+ * Checks whether the deadline has passed.
+ *
+ * Returns: %TRUE if it has passed
+ */
+gboolean
+ai_deadline_has_expired(const AiDeadline *self)
+{
+    g_return_val_if_fail(self != NULL, FALSE);
+
+    return self->deadline != 0 && g_get_monotonic_time() >= self->deadline;
+}
+
+/**
+ * ai_deadline_get_remaining:
+ * @self: an #AiDeadline
+ *
+ * Gets the time left until the deadline.
+ *
+ * Returns: the time left in microseconds, or %G_MAXINT64 for none
+ */
+gint64
+ai_deadline_get_remaining(const AiDeadline *self)
+{
+    g_return_val_if_fail(self != NULL, 0);
+
+    if (self->deadline == 0)
+    {
+        return G_MAXINT64;
+    }
+
+    return MAX(self->deadline - g_get_monotonic_time(), 0);
+}
+
+/**
+ * ai_deadline_check:
+ * @self: an #AiDeadline
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Checks the deadline before starting more work.
+ *
+ * Returns: %FALSE if the deadline has passed
+ */
+gboolean
+ai_deadline_check(
+    const AiDeadline  *self,
+    GError           **error
+){
+    g_return_val_if_fail(self != NULL, FALSE);
+
+    if (ai_deadline_has_expired(self))
+    {
+        g_set_error_literal(error, AI_ERROR, AI_ERROR_TIMEOUT, "Deadline exceeded");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/**
+ * ai_deadline_translate_error:
+ * @self: an #AiDeadline
+ * @error: (inout) (optional): the error of the work run under @self
+ *
+ * Reports a cancellation caused by the deadline as %AI_ERROR_TIMEOUT.
+ *
+ * Returns: %TRUE if @error was replaced
+ */
+gboolean
+ai_deadline_translate_error(
+    const AiDeadline  *self,
+    GError           **error
+){
+    g_return_val_if_fail(self != NULL, FALSE);
+
+    if (error == NULL || *error == NULL ||
+        !g_error_matches(*error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+    {
+        return FALSE;
+    }
+
+    /* The caller cancelled, or the deadline had nothing to do with it */
+    if ((self->parent != NULL && g_cancellable_is_cancelled(self->parent)) ||
+        !ai_deadline_has_expired(self))
+    {
+        return FALSE;
+    }
+
+    g_clear_error(error);
+    g_set_error_literal(error, AI_ERROR, AI_ERROR_TIMEOUT, "Deadline exceeded");
+
+    return TRUE;
+}
@@ -0,0 +1,149 @@
+/*
+ * ai-deadline.h - Absolute deadlines for requests
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * An AiDeadline turns a point in g_get_monotonic_time() into a
+ * GCancellable that is cancelled when the time comes, or when the
+ * caller's own cancellable is. Whatever runs under that cancellable,
+ * an HTTP request, a retry delay or a CLI subprocess, stops at the
+ * deadline, and ai_deadline_translate_error() reports it as
+ * AI_ERROR_TIMEOUT rather than as a cancellation.
+ *
+ * Quick start:
+ *   g_autoptr(AiDeadline) deadline = NULL;
+ *
+ *   deadline = ai_deadline_new(g_get_monotonic_time() + 5 * G_USEC_PER_SEC,
+ *                              cancellable);
+ *   bytes = ai_client_send_and_read(client, msg, body,
+ *                                   ai_deadline_get_cancellable(deadline),
+ *                                   &error);
+ *   ai_deadline_translate_error(deadline, &error);
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+typedef struct _AiDeadline AiDeadline;
+
+/**
+ * ai_deadline_new:
+ * @deadline: the time, in g_get_monotonic_time() microseconds, or 0 for none
+ * @cancellable: (nullable): the caller's #GCancellable
+ *
+ * Creates a deadline. Its cancellable is cancelled at @deadline from
+ * an internal timer thread, so blocking calls are interrupted too, and
+ * whenever @cancellable is cancelled.
+ *
+ * With a @deadline of 0 nothing is created: the deadline's cancellable
+ * is @cancellable itself.
+ *
+ * Returns: (transfer full): a new #AiDeadline
+ */
+AiDeadline *
+ai_deadline_new(
+    gint64        deadline,
+    GCancellable *cancellable
+);
+
+/**
+ * ai_deadline_free:
+ * @self: (nullable): an #AiDeadline
+ *
+ * Stops the timer and frees @self. The caller's cancellable is left
+ * alone.
+ */
+void
+ai_deadline_free(AiDeadline *self);
+
+/**
+ * ai_deadline_get_time:
+ * @self: an #AiDeadline
+ *
+ * Gets the deadline.
+ *
+ * Returns: the time in g_get_monotonic_time() microseconds, or 0 for none
+ */
+gint64
+ai_deadline_get_time(const AiDeadline *self);
+
+/**
+ * ai_deadline_get_cancellable:
+ * @self: an #AiDeadline
+ *
+ * Gets the cancellable to run the work under.
+ *
+ * Returns: (transfer none) (nullable): the #GCancellable
+ */
+GCancellable *
+ai_deadline_get_cancellable(AiDeadline *self);
+
+/**
+ * ai_deadline_has_expired:
+ * @self: an #AiDeadline
+ *
+ * Checks whether the deadline has passed.
+ *
+ * Returns: %TRUE if there is a deadline and it has passed
+ */
+gboolean
+ai_deadline_has_expired(const AiDeadline *self);
+
+/**
+ * ai_deadline_get_remaining:
+ * @self: an #AiDeadline
+ *
+ * Gets the time left until the deadline.
+ *
+ * Returns: the time left in microseconds, 0 once it has passed, or
+ *   %G_MAXINT64 if there is no deadline
+ */
+gint64
+ai_deadline_get_remaining(const AiDeadline *self);
+
+/**
+ * ai_deadline_check:
+ * @self: an #AiDeadline
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Checks the deadline before starting more work.
+ *
+ * Returns: %FALSE with %AI_ERROR_TIMEOUT set if the deadline has passed
+ */
+gboolean
+ai_deadline_check(
+    const AiDeadline  *self,
+    GError           **error
+);
+
+/**
+ * ai_deadline_translate_error:
+ * @self: an #AiDeadline
+ * @error: (inout) (optional): the error of the work run under @self
+ *
+ * Replaces a %G_IO_ERROR_CANCELLED in @error that was caused by the
+ * deadline, not by the caller's cancellable, with %AI_ERROR_TIMEOUT.
+ * Any other error is left as it is.
+ *
+ * Returns: %TRUE if @error was replaced
+ */
+gboolean
+ai_deadline_translate_error(
+    const AiDeadline  *self,
+    GError           **error
+);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(AiDeadline, ai_deadline_free)
+
+G_END_DECLS
@@ -0,0 +1,395 @@
+/*
+ * ai-delta-buffer.c - Coalescing of streamed text deltas
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "core/ai-delta-buffer.h"
+
+struct _AiDeltaBuffer
+{
+    AiStreamable *target;
+    gsize         min_bytes;
+    guint         max_delay_ms;
+    gboolean      flush_on_newline;
+
+    GString      *pending;
+    GMainContext *context;
+    GSource      *timeout;          /* set while text is pending */
+
+    gboolean      routed;           /* events go to a stream, not signals */
+    GWeakRef      stream;           /* empty once the consumer drops it */
+};
+
+/**
+ * ai_delta_buffer_new:
+ * @target: the #AiStreamable to emit #AiStreamable::delta on
+ * @min_bytes: emit once this many bytes are pending
+ * @max_delay_ms: emit text that has been pending this long, or 0
+ * @flush_on_newline: whether a newline emits the pending text
+ *
+ * Creates a buffer for one stream.
+ *
+ * Returns: (transfer full): a new #AiDeltaBuffer
+ */
+AiDeltaBuffer *
+ai_delta_buffer_new(
+    AiStreamable *target,
+    gsize         min_bytes,
+    guint         max_delay_ms,
+    gboolean      flush_on_newline
+){
+    AiDeltaBuffer *self;
+
+    g_return_val_if_fail(AI_IS_STREAMABLE(target), NULL);
+
+    self = g_slice_new0(AiDeltaBuffer);
+    self->target = g_object_ref(target);
+    self->min_bytes = min_bytes;
+    self->max_delay_ms = max_delay_ms;
+    self->flush_on_newline = flush_on_newline;
+    self->context = g_main_context_ref_thread_default();
+    g_weak_ref_init(&self->stream, NULL);
+
+    if (min_bytes > 1)
+    {
+        self->pending = g_string_sized_new(min_bytes + 64);
+    }
+
+    return self;
+}
+
+static void
+clear_timeout(AiDeltaBuffer *self)
+{
+    if (self->timeout != NULL)
+    {
+        g_source_destroy(self->timeout);
+        g_clear_pointer(&self->timeout, g_source_unref);
+    }
+}
+
+/**
+ * ai_delta_buffer_free:
+ * @self: (nullable): an #AiDeltaBuffer
+ *
+ * Frees the buffer, dropping any pending text.
+ */
+void
+ai_delta_buffer_free(AiDeltaBuffer *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+
+    clear_timeout(self);
+    g_main_context_unref(self->context);
+    g_clear_object(&self->target);
+    g_weak_ref_clear(&self->stream);
+    if (self->pending != NULL)
+    {
+        g_string_free(self->pending, TRUE);
+    }
+    g_slice_free(AiDeltaBuffer, self);
+}
+
+/**
+ * ai_delta_buffer_set_stream:
+ * @self: an #AiDeltaBuffer
+ * @stream: (nullable): the #AiStream of the request, or %NULL
+ *
+ * Routes the events of the stream to @stream.
+ */
+void
+ai_delta_buffer_set_stream(
+    AiDeltaBuffer *self,
+    AiStream      *stream
+){
+    g_return_if_fail(self != NULL);
+    g_return_if_fail(stream == NULL || AI_IS_STREAM(stream));
+
+    self->routed = stream != NULL;
+    g_weak_ref_set(&self->stream, stream);
+}
+
+/*
+ * Hands an item to the stream. If the consumer has dropped the stream,
+ * the request is being cancelled and the item goes nowhere.
+ */
+static void
+push_item(
+    AiDeltaBuffer *self,
+    AiStreamItem  *item
+){
+    g_autoptr(AiStream) stream = g_weak_ref_get(&self->stream);
+
+    if (stream == NULL)
+    {
+        ai_stream_item_free(item);
+        return;
+    }
+
+    ai_stream_push(stream, item);
+}
+
+static void
+emit_text(
+    AiDeltaBuffer *self,
+    const gchar   *text
+){
+    AiStreamItem *item;
+
+    if (!self->routed)
+    {
+        ai_streamable_emit_delta(self->target, text);
+        return;
+    }
+
+    item = ai_stream_item_new(AI_STREAM_ITEM_TEXT);
+    item->text = g_strdup(text);
+    push_item(self, item);
+}
+
+static gboolean
+on_delay_elapsed(gpointer user_data)
+{
+    AiDeltaBuffer *self = user_data;
+
+    ai_delta_buffer_flush(self);
+
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * ai_delta_buffer_append:
+ * @self: an #AiDeltaBuffer
+ * @text: a delta
+ *
+ * Adds a delta and emits the pending text if it is due.
+ */
+void
+ai_delta_buffer_append(
+    AiDeltaBuffer *self,
+    const gchar   *text
+){
+    g_return_if_fail(self != NULL);
+    g_return_if_fail(text != NULL);
+
+    if (self->pending == NULL)
+    {
+        emit_text(self, text);
+        return;
+    }
+
+    g_string_append(self->pending, text);
+
+    if (self->pending->len >= self->min_bytes
+        || (self->flush_on_newline && strchr(text, '\n') != NULL))
+    {
+        ai_delta_buffer_flush(self);
+        return;
+    }
+
+    /* The delay runs from the oldest pending byte */
+    if (self->timeout == NULL && self->max_delay_ms > 0)
+    {
+        self->timeout = g_timeout_source_new(self->max_delay_ms);
+        g_source_set_callback(self->timeout, on_delay_elapsed, self, NULL);
+        g_source_attach(self->timeout, self->context);
+    }
+}
+
+/**
+ * ai_delta_buffer_flush:
+ * @self: an #AiDeltaBuffer
+ *
+ * Emits the pending text, if any, as one delta.
+ */
+void
+ai_delta_buffer_flush(AiDeltaBuffer *self)
+{
+    g_return_if_fail(self != NULL);
+
+    clear_timeout(self);
+
+    if (self->pending == NULL || self->pending->len == 0)
+    {
+        return;
+    }
+
+    emit_text(self, self->pending->str);
+    g_string_truncate(self->pending, 0);
+}
+
+/**
+ * ai_delta_buffer_emit_stream_start:
+ * @self: an #AiDeltaBuffer
+ *
+ * Emits #AiStreamable::stream-start. A stream has no item for it.
+ */
+void
+ai_delta_buffer_emit_stream_start(AiDeltaBuffer *self)
+{
+    g_return_if_fail(self != NULL);
+
+    ai_delta_buffer_flush(self);
+    if (!self->routed)
+    {
+        ai_streamable_emit_stream_start(self->target);
+    }
+}
+
+/**
+ * ai_delta_buffer_emit_tool_input_delta:
+ * @self: an #AiDeltaBuffer
+ * @tool_id: the ID of the tool use
+ * @partial_json: the new part of its JSON input
+ *
+ * Emits #AiStreamable::tool-input-delta after the pending text.
+ */
+void
+ai_delta_buffer_emit_tool_input_delta(
+    AiDeltaBuffer *self,
+    const gchar   *tool_id,
+    const gchar   *partial_json
+){
+    AiStreamItem *item;
+
+    g_return_if_fail(self != NULL);
+
+    ai_delta_buffer_flush(self);
+    if (!self->routed)
+    {
+        ai_streamable_emit_tool_input_delta(self->target, tool_id, partial_json);
+        return;
+    }
+
+    item = ai_stream_item_new(AI_STREAM_ITEM_TOOL_INPUT);
+    item->tool_id = g_strdup(tool_id);
+    item->text = g_strdup(partial_json);
+    push_item(self, item);
+}
+
+/**
+ * ai_delta_buffer_emit_tool_use:
+ * @self: an #AiDeltaBuffer
+ * @tool_use: the #AiToolUse
+ *
+ * Emits #AiStreamable::tool-use after the pending text.
+ */
+void
+ai_delta_buffer_emit_tool_use(
+    AiDeltaBuffer *self,
+    AiToolUse     *tool_use
+){
+    AiStreamItem *item;
+
+    g_return_if_fail(self != NULL);
+    g_return_if_fail(AI_IS_TOOL_USE(tool_use));
+
+    ai_delta_buffer_flush(self);
+    if (!self->routed)
+    {
+        ai_streamable_emit_tool_use(self->target, tool_use);
+        return;
+    }
+
+    item = ai_stream_item_new(AI_STREAM_ITEM_TOOL_USE);
+    item->tool_use = g_object_ref(tool_use);
+    push_item(self, item);
+}
+
+/**
+ * ai_delta_buffer_emit_stream_end:
+ * @self: an #AiDeltaBuffer
+ * @response: the complete #AiResponse
+ *
+ * Emits #AiStreamable::stream-end after the pending text.
+ */
+void
+ai_delta_buffer_emit_stream_end(
+    AiDeltaBuffer *self,
+    AiResponse    *response
+){
+    g_autoptr(AiStream) stream = NULL;
+
+    g_return_if_fail(self != NULL);
+    g_return_if_fail(AI_IS_RESPONSE(response));
+
+    ai_delta_buffer_flush(self);
+    if (!self->routed)
+    {
+        ai_streamable_emit_stream_end(self->target, response);
+        return;
+    }
+
+    stream = g_weak_ref_get(&self->stream);
+    if (stream != NULL)
+    {
+        ai_stream_push_end(stream, response);
+    }
+}
+
+/**
+ * ai_delta_buffer_is_full:
+ * @self: an #AiDeltaBuffer
+ *
+ * Checks whether the stream the events go to is full.
+ *
+ * Returns: %TRUE if the client should stop handing out events
+ */
+gboolean
+ai_delta_buffer_is_full(AiDeltaBuffer *self)
+{
+    g_autoptr(AiStream) stream = NULL;
+
+    g_return_val_if_fail(self != NULL, FALSE);
+
+    if (!self->routed)
+    {
+        return FALSE;
+    }
+
+    stream = g_weak_ref_get(&self->stream);
+
+    return stream != NULL && ai_stream_is_full(stream);
+}
+
+/**
+ * ai_delta_buffer_wait_for_space:
+ * @self: an #AiDeltaBuffer
+ * @resume: called once the stream has room again
+ * @user_data: data for @resume
+ *
+ * Arranges for @resume to be called if the stream is full.
+ *
+ * Returns: %TRUE if the client must wait for @resume before reading
+ */
+gboolean
+ai_delta_buffer_wait_for_space(
+    AiDeltaBuffer *self,
+    GSourceFunc    resume,
+    gpointer       user_data
+){
+    g_autoptr(AiStream) stream = NULL;
+
+    g_return_val_if_fail(self != NULL, FALSE);
+
+    if (!self->routed)
+    {
+        return FALSE;
+    }
+
+    stream = g_weak_ref_get(&self->stream);
+
+    return stream != NULL && ai_stream_wait_for_space(stream, resume, user_data);
+}
+
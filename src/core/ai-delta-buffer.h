@@ -0,0 +1,201 @@
+/*
+ * ai-delta-buffer.h - Coalescing of streamed text deltas
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * A fast stream yields a delta every few bytes, and each one costs a
+ * signal emission and, in a UI, usually a redraw. An AiDeltaBuffer sits
+ * between a streaming client and its AiStreamable::delta signal and
+ * joins deltas until enough text, a newline or enough time has come
+ * together. With coalescing off, deltas pass straight through.
+ *
+ * The streaming clients create one per stream with
+ * ai_client_create_delta_buffer(), from the client's delta-* properties,
+ * and emit all of the stream's signals through it. A buffer made for a
+ * request with an AiStream queues the events on the stream instead,
+ * and tells the client when the consumer has fallen behind.
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+
+#include "core/ai-stream.h"
+#include "core/ai-streamable.h"
+
+G_BEGIN_DECLS
+
+/**
+ * AiDeltaBuffer:
+ *
+ * An opaque buffer of text not yet emitted as an #AiStreamable::delta.
+ */
+typedef struct _AiDeltaBuffer AiDeltaBuffer;
+
+/**
+ * ai_delta_buffer_new:
+ * @target: the #AiStreamable to emit #AiStreamable::delta on
+ * @min_bytes: emit once this many bytes are pending; 0 or 1 passes
+ *   every delta straight through
+ * @max_delay_ms: emit text that has been pending this long, or 0 to
+ *   wait for the other conditions
+ * @flush_on_newline: whether a delta that contains a newline is emitted
+ *   together with the text before it at once
+ *
+ * Creates a buffer for one stream. The delay is measured on the
+ * thread-default main context at the time of the call.
+ *
+ * Returns: (transfer full): a new #AiDeltaBuffer
+ */
+AiDeltaBuffer *
+ai_delta_buffer_new(
+    AiStreamable *target,
+    gsize         min_bytes,
+    guint         max_delay_ms,
+    gboolean      flush_on_newline
+);
+
+/**
+ * ai_delta_buffer_free:
+ * @self: (nullable): an #AiDeltaBuffer
+ *
+ * Frees the buffer. Text still pending is dropped; call
+ * ai_delta_buffer_flush() first to emit it.
+ */
+void
+ai_delta_buffer_free(AiDeltaBuffer *self);
+
+/**
+ * ai_delta_buffer_append:
+ * @self: an #AiDeltaBuffer
+ * @text: a delta
+ *
+ * Adds a delta, and emits the pending text if the policy says so.
+ */
+void
+ai_delta_buffer_append(
+    AiDeltaBuffer *self,
+    const gchar   *text
+);
+
+/**
+ * ai_delta_buffer_flush:
+ * @self: an #AiDeltaBuffer
+ *
+ * Emits the pending text, if there is any, as one delta. The other
+ * emit functions of the buffer call this first, so that deltas keep
+ * their place relative to #AiStreamable::tool-use and
+ * #AiStreamable::stream-end; clients call it when the stream ends or
+ * fails.
+ */
+void
+ai_delta_buffer_flush(AiDeltaBuffer *self);
+
+/**
+ * ai_delta_buffer_set_stream:
+ * @self: an #AiDeltaBuffer
+ * @stream: (nullable): the #AiStream of the request, or %NULL
+ *
+ * Makes the buffer queue text and the other events of the stream on
+ * @stream instead of emitting them on its target. The buffer does not
+ * keep @stream alive; once the consumer drops it, events are discarded.
+ */
+void
+ai_delta_buffer_set_stream(
+    AiDeltaBuffer *self,
+    AiStream      *stream
+);
+
+/**
+ * ai_delta_buffer_emit_stream_start:
+ * @self: an #AiDeltaBuffer
+ *
+ * Emits #AiStreamable::stream-start, unless the events go to a stream.
+ */
+void
+ai_delta_buffer_emit_stream_start(AiDeltaBuffer *self);
+
+/**
+ * ai_delta_buffer_emit_tool_input_delta:
+ * @self: an #AiDeltaBuffer
+ * @tool_id: the ID of the tool use
+ * @partial_json: the new part of its JSON input
+ *
+ * Emits the pending text, then #AiStreamable::tool-input-delta.
+ */
+void
+ai_delta_buffer_emit_tool_input_delta(
+    AiDeltaBuffer *self,
+    const gchar   *tool_id,
+    const gchar   *partial_json
+);
+
+/**
+ * ai_delta_buffer_emit_tool_use:
+ * @self: an #AiDeltaBuffer
+ * @tool_use: the #AiToolUse
+ *
+ * Emits the pending text, then #AiStreamable::tool-use.
+ */
+void
+ai_delta_buffer_emit_tool_use(
+    AiDeltaBuffer *self,
+    AiToolUse     *tool_use
+);
+
+/**
+ * ai_delta_buffer_emit_stream_end:
+ * @self: an #AiDeltaBuffer
+ * @response: the complete #AiResponse
+ *
+ * Emits the pending text, then #AiStreamable::stream-end. On a stream,
+ * this queues the usage and the stop item.
+ */
+void
+ai_delta_buffer_emit_stream_end(
+    AiDeltaBuffer *self,
+    AiResponse    *response
+);
+
+/**
+ * ai_delta_buffer_is_full:
+ * @self: an #AiDeltaBuffer
+ *
+ * Checks whether the consumer of the stream has fallen behind. A client
+ * returns %FALSE from its #AiStreamEventFunc when this is %TRUE, so
+ * that the events not yet handled wait in the #AiStreamReader.
+ *
+ * Returns: %TRUE if the client should stop handing out events; always
+ *   %FALSE when the events go to signals
+ */
+gboolean
+ai_delta_buffer_is_full(AiDeltaBuffer *self);
+
+/**
+ * ai_delta_buffer_wait_for_space:
+ * @self: an #AiDeltaBuffer
+ * @resume: called once the stream has room again
+ * @user_data: data for @resume
+ *
+ * Checks, before a client reads the next block, whether the consumer
+ * of the stream has fallen behind. See ai_stream_wait_for_space().
+ *
+ * Returns: %TRUE if the client must leave the read to @resume
+ */
+gboolean
+ai_delta_buffer_wait_for_space(
+    AiDeltaBuffer *self,
+    GSourceFunc    resume,
+    gpointer       user_data
+);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(AiDeltaBuffer, ai_delta_buffer_free)
+
+G_END_DECLS
@@ -0,0 +1,435 @@
+/*
+ * ai-dispatcher.c - Spread chat requests over worker threads
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include "core/ai-dispatcher.h"
+#include "core/ai-session-pool.h"
+
+/*
+ * A worker thread and the main context it runs.
+ */
+typedef struct
+{
+    GThread      *thread;
+    GMainContext *context;
+    GMainLoop    *loop;
+    gint          in_flight;    /* atomic */
+} Worker;
+
+struct _AiDispatcher
+{
+    GObject parent_instance;
+
+    guint   n_workers;
+    Worker *workers;
+    gint    next;               /* atomic, where the search for a worker starts */
+};
+
+G_DEFINE_TYPE(AiDispatcher, ai_dispatcher, G_TYPE_OBJECT)
+
+enum
+{
+    PROP_0,
+    PROP_N_WORKERS,
+    N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
+/*
+ * Data for one dispatched request. It is created and freed on the
+ * caller's context; the worker only fills in the result.
+ */
+typedef struct
+{
+    Worker           *worker;
+    AiProvider       *provider;
+    GList            *messages;     /* element-type AiMessage, owned refs */
+    AiRequestOptions *options;
+    GCancellable     *cancellable;
+
+    AiResponse       *response;
+    GError           *error;
+} DispatchData;
+
+static void
+dispatch_data_free(DispatchData *data)
+{
+    g_clear_object(&data->provider);
+    g_list_free_full(data->messages, g_object_unref);
+    g_clear_pointer(&data->options, ai_request_options_free);
+    g_clear_object(&data->cancellable);
+    g_clear_object(&data->response);
+    g_clear_error(&data->error);
+    g_slice_free(DispatchData, data);
+}
+
+static gpointer
+worker_thread(gpointer user_data)
+{
+    Worker *worker = user_data;
+
+    g_main_context_push_thread_default(worker->context);
+
+    /* A SoupSession must stay on one context, so the worker gets its own */
+    ai_session_pool_set_thread_local(TRUE);
+
+    g_main_loop_run(worker->loop);
+
+    /* Let the sessions close their connections */
+    ai_session_pool_set_thread_local(FALSE);
+    while (g_main_context_iteration(worker->context, FALSE))
+    {
+    }
+
+    g_main_context_pop_thread_default(worker->context);
+
+    return NULL;
+}
+
+static void
+ai_dispatcher_constructed(GObject *object)
+{
+    AiDispatcher *self = AI_DISPATCHER(object);
+    guint i;
+
+    G_OBJECT_CLASS(ai_dispatcher_parent_class)->constructed(object);
+
+    if (self->n_workers == 0)
+    {
+        self->n_workers = g_get_num_processors();
+    }
+
+    self->workers = g_new0(Worker, self->n_workers);
+
+    for (i = 0; i < self->n_workers; i++)
+    {
+        Worker *worker = &self->workers[i];
+        g_autofree gchar *name = g_strdup_printf("ai-dispatcher-%u", i);
+
+        worker->context = g_main_context_new();
+        worker->loop = g_main_loop_new(worker->context, FALSE);
+        worker->thread = g_thread_new(name, worker_thread, worker);
+    }
+}
+
+static void
+ai_dispatcher_finalize(GObject *object)
+{
+    AiDispatcher *self = AI_DISPATCHER(object);
+    guint i;
+
+    /*
+     * Each request holds a reference to the dispatcher until it is
+     * returned to the caller, so no worker is busy here.
+     */
+    for (i = 0; i < self->n_workers; i++)
+    {
+        g_main_loop_quit(self->workers[i].loop);
+    }
+
+    for (i = 0; i < self->n_workers; i++)
+    {
+        Worker *worker = &self->workers[i];
+
+        g_thread_join(worker->thread);
+        g_main_loop_unref(worker->loop);
+        g_main_context_unref(worker->context);
+    }
+
+    g_free(self->workers);
+
+    G_OBJECT_CLASS(ai_dispatcher_parent_class)->finalize(object);
+}
+
+static void
+ai_dispatcher_get_property(
+    GObject    *object,
+    guint       prop_id,
+    GValue     *value,
+    GParamSpec *pspec
+){
+    AiDispatcher *self = AI_DISPATCHER(object);
+
+    switch (prop_id)
+    {
+        case PROP_N_WORKERS:
+            g_value_set_uint(value, self->n_workers);
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+static void
+ai_dispatcher_set_property(
+    GObject      *object,
+    guint         prop_id,
+    const GValue *value,
+    GParamSpec   *pspec
+){
+    AiDispatcher *self = AI_DISPATCHER(object);
+
+    switch (prop_id)
+    {
+        case PROP_N_WORKERS:
+            self->n_workers = g_value_get_uint(value);
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+static void
+ai_dispatcher_class_init(AiDispatcherClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->constructed = ai_dispatcher_constructed;
+    object_class->finalize = ai_dispatcher_finalize;
+    object_class->get_property = ai_dispatcher_get_property;
+    object_class->set_property = ai_dispatcher_set_property;
+
+    /**
+     * AiDispatcher:n-workers:
+     *
+     * The number of worker threads. 0 at construction means one per
+     * processor.
+     */
+    properties[PROP_N_WORKERS] =
+        g_param_spec_uint("n-workers",
+                          "Workers",
+                          "The number of worker threads",
+                          0, G_MAXUINT, 0,
+                          G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+                          G_PARAM_STATIC_STRINGS);
+
+    g_object_class_install_properties(object_class, N_PROPS, properties);
+}
+
+static void
+ai_dispatcher_init(AiDispatcher *self)
+{
+    (void)self;
+}
+
+/**
+ * ai_dispatcher_new:
+ * @n_workers: the number of worker threads, or 0 for one per processor
+ *
+ * Creates a dispatcher and starts its worker threads.
+ *
+ * Returns: (transfer full): a new #AiDispatcher
+ */
+AiDispatcher *
+ai_dispatcher_new(guint n_workers)
+{
+    return g_object_new(AI_TYPE_DISPATCHER,
+                        "n-workers", n_workers,
+                        NULL);
+}
+
+/**
+ * ai_dispatcher_get_n_workers:
+ * @self: an #AiDispatcher
+ *
+ * Gets the number of worker threads.
+ *
+ * Returns: the number of workers
+ */
+guint
+ai_dispatcher_get_n_workers(AiDispatcher *self)
+{
+    g_return_val_if_fail(AI_IS_DISPATCHER(self), 0);
+
+    return self->n_workers;
+}
+
+/**
+ * ai_dispatcher_get_n_in_flight:
+ * @self: an #AiDispatcher
+ *
+ * Gets the number of requests the workers are running.
+ *
+ * Returns: the number of requests in flight
+ */
+guint
+ai_dispatcher_get_n_in_flight(AiDispatcher *self)
+{
+    guint n = 0;
+    guint i;
+
+    g_return_val_if_fail(AI_IS_DISPATCHER(self), 0);
+
+    for (i = 0; i < self->n_workers; i++)
+    {
+        n += (guint)g_atomic_int_get(&self->workers[i].in_flight);
+    }
+
+    return n;
+}
+
+/*
+ * The worker with the fewest requests in flight. The search starts at
+ * a rotating offset so ties are spread round-robin.
+ */
+static Worker *
+pick_worker(AiDispatcher *self)
+{
+    guint start = (guint)g_atomic_int_add(&self->next, 1);
+    Worker *best = NULL;
+    gint best_in_flight = G_MAXINT;
+    guint i;
+
+    for (i = 0; i < self->n_workers; i++)
+    {
+        Worker *worker = &self->workers[(start + i) % self->n_workers];
+        gint in_flight = g_atomic_int_get(&worker->in_flight);
+
+        if (in_flight < best_in_flight)
+        {
+            best = worker;
+            best_in_flight = in_flight;
+        }
+    }
+
+    return best;
+}
+
+/*
+ * Runs on the caller's context.
+ */
+static gboolean
+return_result(gpointer user_data)
+{
+    GTask *task = user_data;
+    DispatchData *data = g_task_get_task_data(task);
+
+    if (data->error != NULL)
+    {
+        g_task_return_error(task, g_steal_pointer(&data->error));
+    }
+    else
+    {
+        g_task_return_pointer(task, g_steal_pointer(&data->response), g_object_unref);
+    }
+
+    g_object_unref(task);
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * Runs on the worker. The task is only handed back, never unreffed
+ * here, so the caller's objects are always released on its context.
+ */
+static void
+on_chat_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = user_data;
+    DispatchData *data = g_task_get_task_data(task);
+
+    data->response = ai_provider_chat_finish(AI_PROVIDER(source), result, &data->error);
+    g_atomic_int_add(&data->worker->in_flight, -1);
+
+    g_main_context_invoke_full(g_task_get_context(task),
+                               g_task_get_priority(task),
+                               return_result, task, NULL);
+}
+
+/*
+ * Runs on the worker, with its context as the thread default, so the
+ * provider's own async work stays on the worker.
+ */
+static gboolean
+start_request(gpointer user_data)
+{
+    GTask *task = user_data;
+    DispatchData *data = g_task_get_task_data(task);
+
+    ai_provider_chat_with_options_async(data->provider, data->messages, data->options,
+                                        data->cancellable, on_chat_done, task);
+
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * ai_dispatcher_chat_async:
+ * @self: an #AiDispatcher
+ * @provider: the #AiProvider to send the request through
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the #AiRequestOptions
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): callback to call when done
+ * @user_data: user data for the callback
+ *
+ * Sends a chat request from the least busy worker. @callback is called
+ * in the thread-default main context of the caller.
+ */
+void
+ai_dispatcher_chat_async(
+    AiDispatcher           *self,
+    AiProvider             *provider,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
+){
+    DispatchData *data;
+    GTask *task;
+
+    g_return_if_fail(AI_IS_DISPATCHER(self));
+    g_return_if_fail(AI_IS_PROVIDER(provider));
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_dispatcher_chat_async);
+
+    data = g_slice_new0(DispatchData);
+    data->worker = pick_worker(self);
+    data->provider = g_object_ref(provider);
+    data->messages = g_list_copy_deep(messages, (GCopyFunc)g_object_ref, NULL);
+    data->options = ai_request_options_copy(options);
+    data->cancellable = cancellable != NULL ? g_object_ref(cancellable) : NULL;
+    g_task_set_task_data(task, data, (GDestroyNotify)dispatch_data_free);
+
+    g_atomic_int_inc(&data->worker->in_flight);
+
+    /* The reference from g_task_new() is dropped in return_result() */
+    g_main_context_invoke_full(data->worker->context, G_PRIORITY_DEFAULT,
+                               start_request, task, NULL);
+}
+
+/**
+ * ai_dispatcher_chat_finish:
+ * @self: an #AiDispatcher
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a request started with ai_dispatcher_chat_async().
+ *
+ * Returns: (transfer full) (nullable): the #AiResponse, or %NULL on error
+ */
+AiResponse *
+ai_dispatcher_chat_finish(
+    AiDispatcher  *self,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(AI_IS_DISPATCHER(self), NULL);
+    g_return_val_if_fail(g_task_is_valid(result, self), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
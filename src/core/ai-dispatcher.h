@@ -0,0 +1,127 @@
+/*
+ * ai-dispatcher.h - Spread chat requests over worker threads
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * AiDispatcher owns a pool of worker threads. Each worker runs its own
+ * GMainContext with its own HTTP sessions, so request building, I/O and
+ * response parsing of concurrent requests run on several cores instead
+ * of all on the caller's main context. Results are delivered back to
+ * the context the request was made from.
+ *
+ * Quick start:
+ *   g_autoptr(AiDispatcher) dispatcher = ai_dispatcher_new(0);
+ *
+ *   ai_dispatcher_chat_async(dispatcher, AI_PROVIDER(client), messages,
+ *                            options, NULL, on_chat_done, NULL);
+ *
+ *   // in on_chat_done, on the caller's context:
+ *   response = ai_dispatcher_chat_finish(dispatcher, result, &error);
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include "core/ai-provider.h"
+#include "model/ai-message.h"
+#include "model/ai-request-options.h"
+#include "model/ai-response.h"
+
+G_BEGIN_DECLS
+
+#define AI_TYPE_DISPATCHER (ai_dispatcher_get_type())
+
+G_DECLARE_FINAL_TYPE(AiDispatcher, ai_dispatcher, AI, DISPATCHER, GObject)
+
+/**
+ * ai_dispatcher_new:
+ * @n_workers: the number of worker threads, or 0 for one per processor
+ *
+ * Creates a dispatcher and starts its worker threads. The threads are
+ * stopped when the dispatcher is freed.
+ *
+ * Returns: (transfer full): a new #AiDispatcher
+ */
+AiDispatcher *
+ai_dispatcher_new(guint n_workers);
+
+/**
+ * ai_dispatcher_get_n_workers:
+ * @self: an #AiDispatcher
+ *
+ * Gets the number of worker threads.
+ *
+ * Returns: the number of workers
+ */
+guint
+ai_dispatcher_get_n_workers(AiDispatcher *self);
+
+/**
+ * ai_dispatcher_get_n_in_flight:
+ * @self: an #AiDispatcher
+ *
+ * Gets the number of requests the workers are running.
+ *
+ * Returns: the number of requests in flight
+ */
+guint
+ai_dispatcher_get_n_in_flight(AiDispatcher *self);
+
+/**
+ * ai_dispatcher_chat_async:
+ * @self: an #AiDispatcher
+ * @provider: the #AiProvider to send the request through
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the #AiRequestOptions
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): callback to call when done
+ * @user_data: user data for the callback
+ *
+ * Sends a chat request from the worker with the fewest requests in
+ * flight, using ai_provider_chat_with_options_async(). @callback is
+ * called in the thread-default main context of the caller.
+ *
+ * @provider is used from several threads at once, so it must not be
+ * reconfigured while requests are running; put per-request settings in
+ * @options. Signals of @provider, such as #AiClient::retry, are emitted
+ * in the worker thread. The messages must not be changed until the
+ * request has finished.
+ */
+void
+ai_dispatcher_chat_async(
+    AiDispatcher           *self,
+    AiProvider             *provider,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
+);
+
+/**
+ * ai_dispatcher_chat_finish:
+ * @self: an #AiDispatcher
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes a request started with ai_dispatcher_chat_async().
+ *
+ * Returns: (transfer full) (nullable): the #AiResponse, or %NULL on error
+ */
+AiResponse *
+ai_dispatcher_chat_finish(
+    AiDispatcher  *self,
+    GAsyncResult  *result,
+    GError       **error
+);
+
+G_END_DECLS
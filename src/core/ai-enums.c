@@ -601,6 +601,37 @@ ai_image_response_format_get_type(void)
     return image_response_format_type;
 }
 
+/*
+ * GType registration for AiTimingPhase.
+ * Registers the enumeration values with the GLib type system for introspection.
+ */
+GType
+ai_timing_phase_get_type(void)
+{
+    static GType timing_phase_type = 0;
+
+    if (g_once_init_enter(&timing_phase_type))
+    {
+        static const GEnumValue values[] = {
+            { AI_TIMING_QUEUED, "AI_TIMING_QUEUED", "queued" },
+            { AI_TIMING_DNS, "AI_TIMING_DNS", "dns" },
+            { AI_TIMING_CONNECT, "AI_TIMING_CONNECT", "connect" },
+            { AI_TIMING_TLS, "AI_TIMING_TLS", "tls" },
+            { AI_TIMING_FIRST_BYTE, "AI_TIMING_FIRST_BYTE", "first-byte" },
+            { AI_TIMING_DOWNLOAD, "AI_TIMING_DOWNLOAD", "download" },
+            { AI_TIMING_PARSE, "AI_TIMING_PARSE", "parse" },
+            { AI_TIMING_FIRST_TOKEN, "AI_TIMING_FIRST_TOKEN", "first-token" },
+            { AI_TIMING_TOTAL, "AI_TIMING_TOTAL", "total" },
+            { 0, NULL, NULL }
+        };
+
+        GType type = g_enum_register_static("AiTimingPhase", values);
+        g_once_init_leave(&timing_phase_type, type);
+    }
+
+    return timing_phase_type;
+}
+
 /**
  * ai_image_size_to_string:
  * @size: an #AiImageSize
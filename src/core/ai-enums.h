@@ -324,6 +324,38 @@ typedef enum
 GType ai_image_response_format_get_type(void);
 #define AI_TYPE_IMAGE_RESPONSE_FORMAT (ai_image_response_format_get_type())
 
+/**
+ * AiTimingPhase:
+ * @AI_TIMING_QUEUED: Time before the request reached the network,
+ *   including rate limiting, retry backoff and earlier attempts
+ * @AI_TIMING_DNS: DNS lookup
+ * @AI_TIMING_CONNECT: TCP connection setup
+ * @AI_TIMING_TLS: TLS handshake
+ * @AI_TIMING_FIRST_BYTE: From sending the request to the first response byte
+ * @AI_TIMING_DOWNLOAD: From the first to the last response byte
+ * @AI_TIMING_PARSE: Parsing the response JSON
+ * @AI_TIMING_FIRST_TOKEN: From the start of the request to the first
+ *   streamed token
+ * @AI_TIMING_TOTAL: From the start of the request to the finished response
+ *
+ * The phases of a request measured by #AiTiming.
+ */
+typedef enum
+{
+    AI_TIMING_QUEUED = 0,
+    AI_TIMING_DNS,
+    AI_TIMING_CONNECT,
+    AI_TIMING_TLS,
+    AI_TIMING_FIRST_BYTE,
+    AI_TIMING_DOWNLOAD,
+    AI_TIMING_PARSE,
+    AI_TIMING_FIRST_TOKEN,
+    AI_TIMING_TOTAL
+} AiTimingPhase;
+
+GType ai_timing_phase_get_type(void);
+#define AI_TYPE_TIMING_PHASE (ai_timing_phase_get_type())
+
 /**
  * ai_image_size_to_string:
  * @size: an #AiImageSize
@@ -0,0 +1,1247 @@
+/*
+ * ai-failover-provider.c - Ordered failover with per-provider circuit breakers
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include "core/ai-failover-provider.h"
+#include "core/ai-error.h"
+
+/* Recent outcomes a circuit decides on */
+#define OUTCOME_WINDOW (20)
+
+/* Outcomes needed before a circuit may open */
+#define MIN_OUTCOMES (5)
+
+static const GEnumValue circuit_state_values[] = {
+    { AI_CIRCUIT_CLOSED,    "AI_CIRCUIT_CLOSED",    "closed" },
+    { AI_CIRCUIT_OPEN,      "AI_CIRCUIT_OPEN",      "open" },
+    { AI_CIRCUIT_HALF_OPEN, "AI_CIRCUIT_HALF_OPEN", "half-open" },
+    { 0, NULL, NULL }
+};
+
+GType
+ai_circuit_state_get_type(void)
+{
+    static GType type = 0;
+
+    if (g_once_init_enter(&type))
+    {
+        GType t = g_enum_register_static("AiCircuitState", circuit_state_values);
+        g_once_init_leave(&type, t);
+    }
+
+    return type;
+}
+
+/*
+ * How a request went, as far as the health of its provider is concerned.
+ */
+typedef enum
+{
+    OUTCOME_SUCCESS,
+    OUTCOME_FAILURE,
+    OUTCOME_NONE        /* cancelled; says nothing about the provider */
+} Outcome;
+
+/* Streaming signals forwarded from the providers in the chain */
+enum
+{
+    FORWARD_DELTA,
+    FORWARD_STREAM_END,
+    FORWARD_TOOL_USE,
+    FORWARD_TOOL_INPUT_DELTA,
+    N_FORWARDS
+};
+
+/*
+ * A provider in the chain and its circuit breaker. The forwards are
+ * connected once, when the provider joins the chain, and pass events
+ * on only while a streaming request of the chain runs on it.
+ */
+typedef struct
+{
+    AiProvider         *provider;
+    AiFailoverProvider *owner;      /* unowned */
+    gulong              handlers[N_FORWARDS];
+    gint                n_streams;  /* atomic */
+    gint                n_outputs;  /* atomic; output events forwarded */
+
+    AiCircuitState      state;
+    guint               generation; /* bumped on every state change */
+    gboolean            failed[OUTCOME_WINDOW];     /* ring buffer */
+    guint               n_outcomes;
+    guint               next_outcome;
+    gint64              opened_at;
+    gboolean            probing;    /* the half-open trial is in flight */
+} Circuit;
+
+struct _AiFailoverProvider
+{
+    GObject parent_instance;
+
+    GMutex     lock;
+    GPtrArray *circuits;        /* element-type Circuit */
+    gdouble    failure_rate;
+    guint      slow_call_threshold;
+    guint      open_timeout;
+};
+
+static void ai_failover_provider_provider_init(AiProviderInterface *iface);
+static void ai_failover_provider_streamable_init(AiStreamableInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(AiFailoverProvider, ai_failover_provider, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(AI_TYPE_PROVIDER,
+                                              ai_failover_provider_provider_init)
+                        G_IMPLEMENT_INTERFACE(AI_TYPE_STREAMABLE,
+                                              ai_failover_provider_streamable_init))
+
+enum
+{
+    PROP_0,
+    PROP_FAILURE_RATE,
+    PROP_SLOW_CALL_THRESHOLD,
+    PROP_OPEN_TIMEOUT,
+    N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
+/*
+ * State of one request while it walks the chain. The request arguments
+ * are copied, since later providers are tried after the caller's chat
+ * call returned.
+ */
+typedef struct
+{
+    GList            *messages;     /* element-type AiMessage, owned refs */
+    AiRequestOptions *options;
+    gboolean          stream;
+
+    guint             next;         /* next position in the chain to consider */
+    Circuit          *circuit;      /* circuit of the attempt in flight */
+    gboolean          probe;
+    guint             generation;   /* of the circuit when the attempt started */
+    gint64            started;
+    gint              n_outputs;    /* of the circuit when the attempt started */
+
+    gboolean          stream_started;
+    GError           *error;        /* last failure */
+} FailoverData;
+
+static void
+circuit_free(Circuit *circuit)
+{
+    guint i;
+
+    for (i = 0; i < N_FORWARDS; i++)
+    {
+        g_clear_signal_handler(&circuit->handlers[i], circuit->provider);
+    }
+    g_object_unref(circuit->provider);
+    g_slice_free(Circuit, circuit);
+}
+
+static void
+failover_data_free(FailoverData *data)
+{
+    g_list_free_full(data->messages, g_object_unref);
+    ai_request_options_free(data->options);
+    g_clear_error(&data->error);
+    g_slice_free(FailoverData, data);
+}
+
+static void
+ai_failover_provider_finalize(GObject *object)
+{
+    AiFailoverProvider *self = AI_FAILOVER_PROVIDER(object);
+
+    g_ptr_array_unref(self->circuits);
+    g_mutex_clear(&self->lock);
+
+    G_OBJECT_CLASS(ai_failover_provider_parent_class)->finalize(object);
+}
+
+static void
+ai_failover_provider_get_property(
+    GObject    *object,
+    guint       prop_id,
+    GValue     *value,
+    GParamSpec *pspec
+){
+    AiFailoverProvider *self = AI_FAILOVER_PROVIDER(object);
+
+    switch (prop_id)
+    {
+        case PROP_FAILURE_RATE:
+            g_value_set_double(value, ai_failover_provider_get_failure_rate(self));
+            break;
+        case PROP_SLOW_CALL_THRESHOLD:
+            g_value_set_uint(value, ai_failover_provider_get_slow_call_threshold(self));
+            break;
+        case PROP_OPEN_TIMEOUT:
+            g_value_set_uint(value, ai_failover_provider_get_open_timeout(self));
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+static void
+ai_failover_provider_set_property(
+    GObject      *object,
+    guint         prop_id,
+    const GValue *value,
+    GParamSpec   *pspec
+){
+    AiFailoverProvider *self = AI_FAILOVER_PROVIDER(object);
+
+    switch (prop_id)
+    {
+        case PROP_FAILURE_RATE:
+            ai_failover_provider_set_failure_rate(self, g_value_get_double(value));
+            break;
+        case PROP_SLOW_CALL_THRESHOLD:
+            ai_failover_provider_set_slow_call_threshold(self, g_value_get_uint(value));
+            break;
+        case PROP_OPEN_TIMEOUT:
+            ai_failover_provider_set_open_timeout(self, g_value_get_uint(value));
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+static void
+ai_failover_provider_class_init(AiFailoverProviderClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->finalize = ai_failover_provider_finalize;
+    object_class->get_property = ai_failover_provider_get_property;
+    object_class->set_property = ai_failover_provider_set_property;
+
+    /**
+     * AiFailoverProvider:failure-rate:
+     *
+     * The share of failed recent requests that opens a circuit.
+     */
+    properties[PROP_FAILURE_RATE] =
+        g_param_spec_double("failure-rate",
+                            "Failure Rate",
+                            "The share of failed recent requests that opens a circuit",
+                            0.01, 1.0, AI_FAILOVER_PROVIDER_DEFAULT_FAILURE_RATE,
+                            G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                            G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiFailoverProvider:slow-call-threshold:
+     *
+     * The latency in milliseconds above which a successful request
+     * counts as failed, or 0 to disable.
+     */
+    properties[PROP_SLOW_CALL_THRESHOLD] =
+        g_param_spec_uint("slow-call-threshold",
+                          "Slow Call Threshold",
+                          "Latency in milliseconds above which a request counts as failed",
+                          0, G_MAXUINT, 0,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiFailoverProvider:open-timeout:
+     *
+     * The time in seconds an open circuit waits before a trial request.
+     */
+    properties[PROP_OPEN_TIMEOUT] =
+        g_param_spec_uint("open-timeout",
+                          "Open Timeout",
+                          "Seconds an open circuit waits before a trial request",
+                          0, G_MAXUINT, AI_FAILOVER_PROVIDER_DEFAULT_OPEN_TIMEOUT,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_STRINGS);
+
+    g_object_class_install_properties(object_class, N_PROPS, properties);
+}
+
+static void
+ai_failover_provider_init(AiFailoverProvider *self)
+{
+    g_mutex_init(&self->lock);
+    self->circuits = g_ptr_array_new_with_free_func((GDestroyNotify)circuit_free);
+    self->failure_rate = AI_FAILOVER_PROVIDER_DEFAULT_FAILURE_RATE;
+    self->open_timeout = AI_FAILOVER_PROVIDER_DEFAULT_OPEN_TIMEOUT;
+}
+
+/**
+ * ai_failover_provider_new:
+ *
+ * Creates an empty failover chain.
+ *
+ * Returns: (transfer full): a new #AiFailoverProvider
+ */
+AiFailoverProvider *
+ai_failover_provider_new(void)
+{
+    return g_object_new(AI_TYPE_FAILOVER_PROVIDER, NULL);
+}
+
+/**
+ * ai_failover_provider_add_provider:
+ * @self: an #AiFailoverProvider
+ * @provider: the #AiProvider to append
+ *
+ * Appends @provider to the chain, with a closed circuit.
+ */
+void
+ai_failover_provider_add_provider(
+    AiFailoverProvider *self,
+    AiProvider         *provider
+){
+    Circuit *circuit;
+
+    g_return_if_fail(AI_IS_FAILOVER_PROVIDER(self));
+    g_return_if_fail(AI_IS_PROVIDER(provider));
+    g_return_if_fail((gpointer)provider != (gpointer)self);
+
+    circuit = g_slice_new0(Circuit);
+    circuit->provider = g_object_ref(provider);
+    circuit->owner = self;
+    circuit->state = AI_CIRCUIT_CLOSED;
+
+    if (AI_IS_STREAMABLE(provider))
+    {
+        connect_forwards(circuit);
+    }
+
+    g_mutex_lock(&self->lock);
+    g_ptr_array_add(self->circuits, circuit);
+    g_mutex_unlock(&self->lock);
+}
+
+/**
+ * ai_failover_provider_get_n_providers:
+ * @self: an #AiFailoverProvider
+ *
+ * Gets the number of providers in the chain.
+ *
+ * Returns: the provider count
+ */
+guint
+ai_failover_provider_get_n_providers(AiFailoverProvider *self)
+{
+    guint n;
+
+    g_return_val_if_fail(AI_IS_FAILOVER_PROVIDER(self), 0);
+
+    g_mutex_lock(&self->lock);
+    n = self->circuits->len;
+    g_mutex_unlock(&self->lock);
+
+    return n;
+}
+
+/*
+ * Circuits are never removed, so the pointer stays valid after the
+ * lock is released.
+ */
+static Circuit *
+get_circuit(
+    AiFailoverProvider *self,
+    guint               index
+){
+    Circuit *circuit = NULL;
+
+    g_mutex_lock(&self->lock);
+    if (index < self->circuits->len)
+    {
+        circuit = g_ptr_array_index(self->circuits, index);
+    }
+    g_mutex_unlock(&self->lock);
+
+    return circuit;
+}
+
+/**
+ * ai_failover_provider_get_provider:
+ * @self: an #AiFailoverProvider
+ * @index: the position in the chain
+ *
+ * Gets the provider at @index.
+ *
+ * Returns: (transfer none): the #AiProvider
+ */
+AiProvider *
+ai_failover_provider_get_provider(
+    AiFailoverProvider *self,
+    guint               index
+){
+    Circuit *circuit;
+
+    g_return_val_if_fail(AI_IS_FAILOVER_PROVIDER(self), NULL);
+
+    circuit = get_circuit(self, index);
+    g_return_val_if_fail(circuit != NULL, NULL);
+
+    return circuit->provider;
+}
+
+/* Called with the lock held */
+static gboolean
+circuit_timeout_passed(
+    AiFailoverProvider *self,
+    Circuit            *circuit
+){
+    return g_get_monotonic_time() - circuit->opened_at >=
+           (gint64)self->open_timeout * G_USEC_PER_SEC;
+}
+
+/* Called with the lock held */
+static void
+circuit_set_state(
+    Circuit        *circuit,
+    AiCircuitState  state
+){
+    circuit->state = state;
+    circuit->generation++;
+    circuit->n_outcomes = 0;
+    circuit->next_outcome = 0;
+    circuit->probing = FALSE;
+
+    if (state == AI_CIRCUIT_OPEN)
+    {
+        circuit->opened_at = g_get_monotonic_time();
+    }
+}
+
+/**
+ * ai_failover_provider_get_circuit_state:
+ * @self: an #AiFailoverProvider
+ * @index: the position in the chain
+ *
+ * Gets the state of the circuit breaker of the provider at @index.
+ *
+ * Returns: the #AiCircuitState
+ */
+AiCircuitState
+ai_failover_provider_get_circuit_state(
+    AiFailoverProvider *self,
+    guint               index
+){
+    Circuit *circuit;
+    AiCircuitState state;
+
+    g_return_val_if_fail(AI_IS_FAILOVER_PROVIDER(self), AI_CIRCUIT_CLOSED);
+
+    circuit = get_circuit(self, index);
+    g_return_val_if_fail(circuit != NULL, AI_CIRCUIT_CLOSED);
+
+    g_mutex_lock(&self->lock);
+    state = circuit->state;
+    if (state == AI_CIRCUIT_OPEN && circuit_timeout_passed(self, circuit))
+    {
+        state = AI_CIRCUIT_HALF_OPEN;
+    }
+    g_mutex_unlock(&self->lock);
+
+    return state;
+}
+
+/**
+ * ai_failover_provider_reset_circuit:
+ * @self: an #AiFailoverProvider
+ * @index: the position in the chain
+ *
+ * Closes the circuit of the provider at @index.
+ */
+void
+ai_failover_provider_reset_circuit(
+    AiFailoverProvider *self,
+    guint               index
+){
+    Circuit *circuit;
+
+    g_return_if_fail(AI_IS_FAILOVER_PROVIDER(self));
+
+    circuit = get_circuit(self, index);
+    g_return_if_fail(circuit != NULL);
+
+    g_mutex_lock(&self->lock);
+    circuit_set_state(circuit, AI_CIRCUIT_CLOSED);
+    g_mutex_unlock(&self->lock);
+}
+
+/**
+ * ai_failover_provider_get_failure_rate:
+ * @self: an #AiFailoverProvider
+ *
+ * Gets the share of failed recent requests that opens a circuit.
+ *
+ * Returns: the failure rate
+ */
+gdouble
+ai_failover_provider_get_failure_rate(AiFailoverProvider *self)
+{
+    gdouble rate;
+
+    g_return_val_if_fail(AI_IS_FAILOVER_PROVIDER(self), 0.0);
+
+    g_mutex_lock(&self->lock);
+    rate = self->failure_rate;
+    g_mutex_unlock(&self->lock);
+
+    return rate;
+}
+
+/**
+ * ai_failover_provider_set_failure_rate:
+ * @self: an #AiFailoverProvider
+ * @failure_rate: the failure rate, greater than 0.0 and at most 1.0
+ *
+ * Sets the share of failed recent requests that opens a circuit.
+ */
+void
+ai_failover_provider_set_failure_rate(
+    AiFailoverProvider *self,
+    gdouble             failure_rate
+){
+    g_return_if_fail(AI_IS_FAILOVER_PROVIDER(self));
+    g_return_if_fail(failure_rate > 0.0 && failure_rate <= 1.0);
+
+    g_mutex_lock(&self->lock);
+    if (self->failure_rate == failure_rate)
+    {
+        g_mutex_unlock(&self->lock);
+        return;
+    }
+    self->failure_rate = failure_rate;
+    g_mutex_unlock(&self->lock);
+
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_FAILURE_RATE]);
+}
+
+/**
+ * ai_failover_provider_get_slow_call_threshold:
+ * @self: an #AiFailoverProvider
+ *
+ * Gets the latency above which a successful request counts as failed.
+ *
+ * Returns: the threshold in milliseconds, or 0 if disabled
+ */
+guint
+ai_failover_provider_get_slow_call_threshold(AiFailoverProvider *self)
+{
+    guint threshold;
+
+    g_return_val_if_fail(AI_IS_FAILOVER_PROVIDER(self), 0);
+
+    g_mutex_lock(&self->lock);
+    threshold = self->slow_call_threshold;
+    g_mutex_unlock(&self->lock);
+
+    return threshold;
+}
+
+/**
+ * ai_failover_provider_set_slow_call_threshold:
+ * @self: an #AiFailoverProvider
+ * @threshold_ms: the threshold in milliseconds, or 0 to disable
+ *
+ * Sets the latency above which a successful request counts as failed.
+ */
+void
+ai_failover_provider_set_slow_call_threshold(
+    AiFailoverProvider *self,
+    guint               threshold_ms
+){
+    g_return_if_fail(AI_IS_FAILOVER_PROVIDER(self));
+
+    g_mutex_lock(&self->lock);
+    if (self->slow_call_threshold == threshold_ms)
+    {
+        g_mutex_unlock(&self->lock);
+        return;
+    }
+    self->slow_call_threshold = threshold_ms;
+    g_mutex_unlock(&self->lock);
+
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_SLOW_CALL_THRESHOLD]);
+}
+
+/**
+ * ai_failover_provider_get_open_timeout:
+ * @self: an #AiFailoverProvider
+ *
+ * Gets how long an open circuit waits before a trial request.
+ *
+ * Returns: the timeout in seconds
+ */
+guint
+ai_failover_provider_get_open_timeout(AiFailoverProvider *self)
+{
+    guint timeout;
+
+    g_return_val_if_fail(AI_IS_FAILOVER_PROVIDER(self), 0);
+
+    g_mutex_lock(&self->lock);
+    timeout = self->open_timeout;
+    g_mutex_unlock(&self->lock);
+
+    return timeout;
+}
+
+/**
+ * ai_failover_provider_set_open_timeout:
+ * @self: an #AiFailoverProvider
+ * @timeout_seconds: the timeout in seconds
+ *
+ * Sets how long an open circuit skips its provider.
+ */
+void
+ai_failover_provider_set_open_timeout(
+    AiFailoverProvider *self,
+    guint               timeout_seconds
+){
+    g_return_if_fail(AI_IS_FAILOVER_PROVIDER(self));
+
+    g_mutex_lock(&self->lock);
+    if (self->open_timeout == timeout_seconds)
+    {
+        g_mutex_unlock(&self->lock);
+        return;
+    }
+    self->open_timeout = timeout_seconds;
+    g_mutex_unlock(&self->lock);
+
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_OPEN_TIMEOUT]);
+}
+
+/*
+ * Ask the circuit to let a request through. Once the timeout of an open
+ * circuit has passed, exactly one request is let through as the trial;
+ * @probe tells the caller it got that role. @generation is the state
+ * the request was let through in, for circuit_record().
+ */
+static gboolean
+circuit_acquire(
+    AiFailoverProvider *self,
+    Circuit            *circuit,
+    gboolean           *probe,
+    guint              *generation
+){
+    gboolean allowed = FALSE;
+
+    *probe = FALSE;
+
+    g_mutex_lock(&self->lock);
+
+    if (circuit->state == AI_CIRCUIT_OPEN && circuit_timeout_passed(self, circuit))
+    {
+        circuit_set_state(circuit, AI_CIRCUIT_HALF_OPEN);
+    }
+
+    switch (circuit->state)
+    {
+        case AI_CIRCUIT_CLOSED:
+            allowed = TRUE;
+            break;
+        case AI_CIRCUIT_HALF_OPEN:
+            if (!circuit->probing)
+            {
+                circuit->probing = TRUE;
+                *probe = TRUE;
+                allowed = TRUE;
+            }
+            break;
+        case AI_CIRCUIT_OPEN:
+        default:
+            break;
+    }
+
+    *generation = circuit->generation;
+
+    g_mutex_unlock(&self->lock);
+
+    return allowed;
+}
+
+static void
+circuit_record(
+    AiFailoverProvider *self,
+    Circuit            *circuit,
+    Outcome             outcome,
+    gboolean            probe,
+    guint               generation
+){
+    guint n_failed = 0;
+    guint i;
+
+    g_mutex_lock(&self->lock);
+
+    /* Requests that started before the circuit last changed are ignored */
+    if (circuit->generation != generation)
+    {
+        g_mutex_unlock(&self->lock);
+        return;
+    }
+
+    if (probe)
+    {
+        /* The trial decides; after a cancelled one, the next request tries */
+        if (outcome == OUTCOME_SUCCESS)
+        {
+            circuit_set_state(circuit, AI_CIRCUIT_CLOSED);
+        }
+        else if (outcome == OUTCOME_FAILURE)
+        {
+            circuit_set_state(circuit, AI_CIRCUIT_OPEN);
+        }
+        else
+        {
+            circuit->probing = FALSE;
+        }
+    }
+    else if (circuit->state == AI_CIRCUIT_CLOSED && outcome != OUTCOME_NONE)
+    {
+        circuit->failed[circuit->next_outcome] = (outcome == OUTCOME_FAILURE);
+        circuit->next_outcome = (circuit->next_outcome + 1) % OUTCOME_WINDOW;
+        circuit->n_outcomes = MIN(circuit->n_outcomes + 1, OUTCOME_WINDOW);
+
+        for (i = 0; i < circuit->n_outcomes; i++)
+        {
+            n_failed += circuit->failed[i] ? 1 : 0;
+        }
+
+        if (circuit->n_outcomes >= MIN_OUTCOMES &&
+            n_failed >= self->failure_rate * circuit->n_outcomes)
+        {
+            g_debug("Opening circuit of provider %s after %u of %u requests failed",
+                    ai_provider_get_name(circuit->provider), n_failed, circuit->n_outcomes);
+            circuit_set_state(circuit, AI_CIRCUIT_OPEN);
+        }
+    }
+
+    g_mutex_unlock(&self->lock);
+}
+
+static gboolean
+is_cancelled_error(const GError *error)
+{
+    return g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED) ||
+           g_error_matches(error, AI_ERROR, AI_ERROR_CANCELLED);
+}
+
+/*
+ * Errors caused by the request itself. The provider answered, so its
+ * circuit counts a success, and the next provider would only fail the
+ * same way.
+ */
+static gboolean
+is_request_error(const GError *error)
+{
+    if (error->domain != AI_ERROR)
+    {
+        return FALSE;
+    }
+
+    switch (error->code)
+    {
+        case AI_ERROR_INVALID_REQUEST:
+        case AI_ERROR_CONTEXT_LENGTH_EXCEEDED:
+        case AI_ERROR_CONTENT_FILTERED:
+        case AI_ERROR_TOOL_ERROR:
+            return TRUE;
+        default:
+            return FALSE;
+    }
+}
+
+static void
+on_child_delta(
+    AiStreamable *child,
+    const gchar  *text,
+    gpointer      user_data
+){
+    Circuit *circuit = user_data;
+
+    (void)child;
+
+    if (g_atomic_int_get(&circuit->n_streams) > 0)
+    {
+        g_atomic_int_inc(&circuit->n_outputs);
+        ai_streamable_emit_delta(AI_STREAMABLE(circuit->owner), text);
+    }
+}
+
+static void
+on_child_stream_end(
+    AiStreamable *child,
+    GObject      *response,
+    gpointer      user_data
+){
+    Circuit *circuit = user_data;
+
+    (void)child;
+
+    if (g_atomic_int_get(&circuit->n_streams) > 0)
+    {
+        ai_streamable_emit_stream_end(AI_STREAMABLE(circuit->owner), AI_RESPONSE(response));
+    }
+}
+
+static void
+on_child_tool_use(
+    AiStreamable *child,
+    GObject      *tool_use,
+    gpointer      user_data
+){
+    Circuit *circuit = user_data;
+
+    (void)child;
+
+    if (g_atomic_int_get(&circuit->n_streams) > 0)
+    {
+        g_atomic_int_inc(&circuit->n_outputs);
+        ai_streamable_emit_tool_use(AI_STREAMABLE(circuit->owner), AI_TOOL_USE(tool_use));
+    }
+}
+
+static void
+on_child_tool_input_delta(
+    AiStreamable *child,
+    const gchar  *tool_id,
+    const gchar  *partial_json,
+    gpointer      user_data
+){
+    Circuit *circuit = user_data;
+
+    (void)child;
+
+    if (g_atomic_int_get(&circuit->n_streams) > 0)
+    {
+        g_atomic_int_inc(&circuit->n_outputs);
+        ai_streamable_emit_tool_input_delta(AI_STREAMABLE(circuit->owner),
+                                            tool_id, partial_json);
+    }
+}
+
+static void
+connect_forwards(Circuit *circuit)
+{
+    circuit->handlers[FORWARD_DELTA] =
+        g_signal_connect(circuit->provider, "delta",
+                         G_CALLBACK(on_child_delta), circuit);
+    circuit->handlers[FORWARD_STREAM_END] =
+        g_signal_connect(circuit->provider, "stream-end",
+                         G_CALLBACK(on_child_stream_end), circuit);
+    circuit->handlers[FORWARD_TOOL_USE] =
+        g_signal_connect(circuit->provider, "tool-use",
+                         G_CALLBACK(on_child_tool_use), circuit);
+    circuit->handlers[FORWARD_TOOL_INPUT_DELTA] =
+        g_signal_connect(circuit->provider, "tool-input-delta",
+                         G_CALLBACK(on_child_tool_input_delta), circuit);
+}
+
+static void try_next(GTask *task);
+
+static void
+on_attempt_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    AiFailoverProvider *self = g_task_get_source_object(task);
+    FailoverData *data = g_task_get_task_data(task);
+    AiResponse *response;
+    GError *error = NULL;
+    gint64 latency;
+    guint threshold;
+
+    if (data->stream)
+    {
+        response = ai_streamable_chat_stream_finish(AI_STREAMABLE(source), result, &error);
+        g_atomic_int_add(&data->circuit->n_streams, -1);
+    }
+    else
+    {
+        response = ai_provider_chat_finish(AI_PROVIDER(source), result, &error);
+    }
+
+    latency = (g_get_monotonic_time() - data->started) / 1000;
+
+    if (response != NULL)
+    {
+        threshold = ai_failover_provider_get_slow_call_threshold(self);
+        circuit_record(self, data->circuit,
+                       threshold > 0 && latency > threshold ? OUTCOME_FAILURE : OUTCOME_SUCCESS,
+                       data->probe, data->generation);
+        g_task_return_pointer(task, response, g_object_unref);
+        g_object_unref(task);
+        return;
+    }
+
+    if (is_cancelled_error(error))
+    {
+        circuit_record(self, data->circuit, OUTCOME_NONE, data->probe, data->generation);
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    if (is_request_error(error))
+    {
+        circuit_record(self, data->circuit, OUTCOME_SUCCESS, data->probe, data->generation);
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    circuit_record(self, data->circuit, OUTCOME_FAILURE, data->probe, data->generation);
+
+    /*
+     * Part of the answer was already delivered and cannot be replaced.
+     * The count is per provider, so output of another stream running on
+     * it at the same time also stops the failover; that returns an
+     * error rather than risk a duplicated answer.
+     */
+    if (data->stream &&
+        g_atomic_int_get(&data->circuit->n_outputs) != data->n_outputs)
+    {
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    g_debug("Provider %s failed, trying the next one: %s",
+            ai_provider_get_name(data->circuit->provider), error->message);
+
+    g_clear_error(&data->error);
+    data->error = error;
+    try_next(task);
+}
+
+/*
+ * Send the request to the next provider whose circuit lets it through,
+ * or return the last failure. Takes over the caller's reference to @task.
+ */
+static void
+try_next(GTask *task)
+{
+    AiFailoverProvider *self = g_task_get_source_object(task);
+    FailoverData *data = g_task_get_task_data(task);
+    GCancellable *cancellable = g_task_get_cancellable(task);
+    Circuit *circuit;
+
+    if (g_task_return_error_if_cancelled(task))
+    {
+        g_object_unref(task);
+        return;
+    }
+
+    while ((circuit = get_circuit(self, data->next)) != NULL)
+    {
+        data->next++;
+
+        if (data->stream && !AI_IS_STREAMABLE(circuit->provider))
+        {
+            continue;
+        }
+
+        if (!circuit_acquire(self, circuit, &data->probe, &data->generation))
+        {
+            continue;
+        }
+
+        data->circuit = circuit;
+        data->started = g_get_monotonic_time();
+
+        if (!data->stream)
+        {
+            ai_provider_chat_with_options_async(circuit->provider, data->messages,
+                                                data->options, cancellable,
+                                                on_attempt_done, task);
+            return;
+        }
+
+        /* Once per request, however many providers it goes through */
+        if (!data->stream_started)
+        {
+            data->stream_started = TRUE;
+            ai_streamable_emit_stream_start(AI_STREAMABLE(self));
+        }
+
+        data->n_outputs = g_atomic_int_get(&circuit->n_outputs);
+        g_atomic_int_inc(&circuit->n_streams);
+
+        ai_streamable_chat_stream_with_options_async(AI_STREAMABLE(circuit->provider),
+                                                     data->messages, data->options,
+                                                     cancellable, on_attempt_done, task);
+        return;
+    }
+
+    if (data->error != NULL)
+    {
+        g_task_return_error(task, g_steal_pointer(&data->error));
+    }
+    else
+    {
+        g_task_return_new_error(task, AI_ERROR, AI_ERROR_SERVICE_UNAVAILABLE,
+                                "No provider is available; all circuits are open");
+    }
+    g_object_unref(task);
+}
+
+static void
+start_request(
+    AiFailoverProvider     *self,
+    gboolean                stream,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data,
+    gpointer                source_tag
+){
+    FailoverData *data;
+    GTask *task;
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, source_tag);
+
+    data = g_slice_new0(FailoverData);
+    data->messages = g_list_copy_deep(messages, (GCopyFunc)g_object_ref, NULL);
+    data->options = options != NULL ? ai_request_options_copy(options) : ai_request_options_new();
+    data->stream = stream;
+
+    /*
+     * A provider that fed an AiStream itself would bypass the forwards,
+     * and a failed attempt would look as if nothing reached the caller.
+     */
+    ai_request_options_set_stream(data->options, NULL);
+    g_task_set_task_data(task, data, (GDestroyNotify)failover_data_free);
+
+    try_next(task);
+}
+
+static AiProvider *
+get_first_provider(AiFailoverProvider *self)
+{
+    Circuit *circuit = get_circuit(self, 0);
+
+    return circuit != NULL ? circuit->provider : NULL;
+}
+
+static AiProviderType
+ai_failover_provider_get_provider_type(AiProvider *provider)
+{
+    AiProvider *first = get_first_provider(AI_FAILOVER_PROVIDER(provider));
+
+    return first != NULL ? ai_provider_get_provider_type(first) : AI_PROVIDER_CLAUDE;
+}
+
+static const gchar *
+ai_failover_provider_get_name(AiProvider *provider)
+{
+    AiProvider *first = get_first_provider(AI_FAILOVER_PROVIDER(provider));
+
+    return first != NULL ? ai_provider_get_name(first) : "Failover";
+}
+
+static const gchar *
+ai_failover_provider_get_default_model(AiProvider *provider)
+{
+    AiProvider *first = get_first_provider(AI_FAILOVER_PROVIDER(provider));
+
+    return first != NULL ? ai_provider_get_default_model(first) : NULL;
+}
+
+static void
+ai_failover_provider_chat_with_options_async(
+    AiProvider             *provider,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
+){
+    start_request(AI_FAILOVER_PROVIDER(provider), FALSE, messages, options,
+                  cancellable, callback, user_data,
+                  ai_failover_provider_chat_with_options_async);
+}
+
+static void
+ai_failover_provider_chat_async(
+    AiProvider          *provider,
+    GList               *messages,
+    const gchar         *system_prompt,
+    gint                 max_tokens,
+    GList               *tools,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    ai_failover_provider_chat_with_options_async(provider, messages, options,
+                                                 cancellable, callback, user_data);
+}
+
+static AiResponse *
+ai_failover_provider_chat_finish(
+    AiProvider    *provider,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(g_task_is_valid(result, provider), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+on_list_models_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    GError *error = NULL;
+    GList *models;
+
+    models = ai_provider_list_models_finish(AI_PROVIDER(source), result, &error);
+    if (error != NULL)
+    {
+        g_task_return_error(task, error);
+    }
+    else
+    {
+        g_task_return_pointer(task, models, NULL);
+    }
+    g_object_unref(task);
+}
+
+static void
+ai_failover_provider_list_models_async(
+    AiProvider          *provider,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    AiFailoverProvider *self = AI_FAILOVER_PROVIDER(provider);
+    AiProvider *target = NULL;
+    Circuit *circuit;
+    GTask *task;
+    guint i;
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_failover_provider_list_models_async);
+
+    /* The provider a chat request would go to; the circuit is not touched */
+    for (i = 0; (circuit = get_circuit(self, i)) != NULL; i++)
+    {
+        if (ai_failover_provider_get_circuit_state(self, i) != AI_CIRCUIT_OPEN)
+        {
+            target = circuit->provider;
+            break;
+        }
+    }
+
+    if (target == NULL)
+    {
+        g_task_return_new_error(task, AI_ERROR, AI_ERROR_SERVICE_UNAVAILABLE,
+                                "No provider is available; all circuits are open");
+        g_object_unref(task);
+        return;
+    }
+
+    ai_provider_list_models_async(target, cancellable, on_list_models_done, task);
+}
+
+static GList *
+ai_failover_provider_list_models_finish(
+    AiProvider    *provider,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(g_task_is_valid(result, provider), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+ai_failover_provider_chat_stream_with_options_async(
+    AiStreamable           *streamable,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
+){
+    start_request(AI_FAILOVER_PROVIDER(streamable), TRUE, messages, options,
+                  cancellable, callback, user_data,
+                  ai_failover_provider_chat_stream_with_options_async);
+}
+
+static void
+ai_failover_provider_chat_stream_async(
+    AiStreamable        *streamable,
+    GList               *messages,
+    const gchar         *system_prompt,
+    gint                 max_tokens,
+    GList               *tools,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    ai_failover_provider_chat_stream_with_options_async(streamable, messages, options,
+                                                        cancellable, callback, user_data);
+}
+
+static AiResponse *
+ai_failover_provider_chat_stream_finish(
+    AiStreamable  *streamable,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(g_task_is_valid(result, streamable), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+ai_failover_provider_provider_init(AiProviderInterface *iface)
+{
+    iface->get_provider_type = ai_failover_provider_get_provider_type;
+    iface->get_name = ai_failover_provider_get_name;
+    iface->get_default_model = ai_failover_provider_get_default_model;
+    iface->chat_async = ai_failover_provider_chat_async;
+    iface->chat_with_options_async = ai_failover_provider_chat_with_options_async;
+    iface->chat_finish = ai_failover_provider_chat_finish;
+    iface->list_models_async = ai_failover_provider_list_models_async;
+    iface->list_models_finish = ai_failover_provider_list_models_finish;
+}
+
+static void
+ai_failover_provider_streamable_init(AiStreamableInterface *iface)
+{
+    iface->chat_stream_async = ai_failover_provider_chat_stream_async;
+    iface->chat_stream_with_options_async = ai_failover_provider_chat_stream_with_options_async;
+    iface->chat_stream_finish = ai_failover_provider_chat_stream_finish;
+}
@@ -0,0 +1,237 @@
+/*
+ * ai-failover-provider.h - Ordered failover with per-provider circuit breakers
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * AiFailoverProvider wraps an ordered list of providers. Each request
+ * goes to the first provider whose circuit breaker lets it through; if
+ * that provider fails, the next one is tried. A provider that keeps
+ * failing (or answering too slowly) has its circuit opened and is
+ * skipped without a request until a cool-down has passed, so an outage
+ * costs one fast failure instead of a full timeout per call.
+ *
+ * Quick start:
+ *   g_autoptr(AiFailoverProvider) failover = ai_failover_provider_new();
+ *
+ *   ai_failover_provider_add_provider(failover, AI_PROVIDER(claude));
+ *   ai_failover_provider_add_provider(failover, AI_PROVIDER(openai));
+ *   ai_failover_provider_add_provider(failover, AI_PROVIDER(ollama));
+ *   ai_provider_chat_async(AI_PROVIDER(failover), messages, NULL, 256, NULL,
+ *                          NULL, on_chat_done, NULL);
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include "core/ai-provider.h"
+#include "core/ai-streamable.h"
+
+G_BEGIN_DECLS
+
+/**
+ * AiCircuitState:
+ * @AI_CIRCUIT_CLOSED: requests go through and outcomes are counted
+ * @AI_CIRCUIT_OPEN: requests are skipped until the open timeout passes
+ * @AI_CIRCUIT_HALF_OPEN: a single trial request decides whether the
+ *   circuit closes again or stays open
+ *
+ * State of the circuit breaker of one provider in an #AiFailoverProvider.
+ */
+typedef enum
+{
+    AI_CIRCUIT_CLOSED = 0,
+    AI_CIRCUIT_OPEN,
+    AI_CIRCUIT_HALF_OPEN
+} AiCircuitState;
+
+GType ai_circuit_state_get_type(void) G_GNUC_CONST;
+#define AI_TYPE_CIRCUIT_STATE (ai_circuit_state_get_type())
+
+/**
+ * AI_FAILOVER_PROVIDER_DEFAULT_FAILURE_RATE:
+ *
+ * Default share of failed requests, among the recent ones, that opens
+ * a circuit.
+ */
+#define AI_FAILOVER_PROVIDER_DEFAULT_FAILURE_RATE (0.5)
+
+/**
+ * AI_FAILOVER_PROVIDER_DEFAULT_OPEN_TIMEOUT:
+ *
+ * Default time in seconds an open circuit waits before a trial request.
+ */
+#define AI_FAILOVER_PROVIDER_DEFAULT_OPEN_TIMEOUT (30)
+
+#define AI_TYPE_FAILOVER_PROVIDER (ai_failover_provider_get_type())
+
+G_DECLARE_FINAL_TYPE(AiFailoverProvider, ai_failover_provider, AI, FAILOVER_PROVIDER, GObject)
+
+/**
+ * ai_failover_provider_new:
+ *
+ * Creates an empty failover chain. Add providers with
+ * ai_failover_provider_add_provider() before sending requests.
+ *
+ * Returns: (transfer full): a new #AiFailoverProvider
+ */
+AiFailoverProvider *
+ai_failover_provider_new(void);
+
+/**
+ * ai_failover_provider_add_provider:
+ * @self: an #AiFailoverProvider
+ * @provider: the #AiProvider to append
+ *
+ * Appends @provider to the chain. Providers are tried in the order they
+ * were added. Streaming requests only use providers that also implement
+ * #AiStreamable.
+ */
+void
+ai_failover_provider_add_provider(
+    AiFailoverProvider *self,
+    AiProvider         *provider
+);
+
+/**
+ * ai_failover_provider_get_n_providers:
+ * @self: an #AiFailoverProvider
+ *
+ * Gets the number of providers in the chain.
+ *
+ * Returns: the provider count
+ */
+guint
+ai_failover_provider_get_n_providers(AiFailoverProvider *self);
+
+/**
+ * ai_failover_provider_get_provider:
+ * @self: an #AiFailoverProvider
+ * @index: the position in the chain
+ *
+ * Gets the provider at @index.
+ *
+ * Returns: (transfer none): the #AiProvider
+ */
+AiProvider *
+ai_failover_provider_get_provider(
+    AiFailoverProvider *self,
+    guint               index
+);
+
+/**
+ * ai_failover_provider_get_circuit_state:
+ * @self: an #AiFailoverProvider
+ * @index: the position in the chain
+ *
+ * Gets the state of the circuit breaker of the provider at @index. An
+ * open circuit whose timeout has passed is reported as half-open.
+ *
+ * Returns: the #AiCircuitState
+ */
+AiCircuitState
+ai_failover_provider_get_circuit_state(
+    AiFailoverProvider *self,
+    guint               index
+);
+
+/**
+ * ai_failover_provider_reset_circuit:
+ * @self: an #AiFailoverProvider
+ * @index: the position in the chain
+ *
+ * Closes the circuit of the provider at @index and forgets its recent
+ * outcomes, for example after its configuration was fixed.
+ */
+void
+ai_failover_provider_reset_circuit(
+    AiFailoverProvider *self,
+    guint               index
+);
+
+/**
+ * ai_failover_provider_get_failure_rate:
+ * @self: an #AiFailoverProvider
+ *
+ * Gets the share of failed recent requests that opens a circuit.
+ *
+ * Returns: the failure rate, between 0.0 and 1.0
+ */
+gdouble
+ai_failover_provider_get_failure_rate(AiFailoverProvider *self);
+
+/**
+ * ai_failover_provider_set_failure_rate:
+ * @self: an #AiFailoverProvider
+ * @failure_rate: the failure rate, greater than 0.0 and at most 1.0
+ *
+ * Sets the share of failed requests, among the last 20 to a provider,
+ * that opens its circuit. At least 5 requests must have been seen.
+ */
+void
+ai_failover_provider_set_failure_rate(
+    AiFailoverProvider *self,
+    gdouble             failure_rate
+);
+
+/**
+ * ai_failover_provider_get_slow_call_threshold:
+ * @self: an #AiFailoverProvider
+ *
+ * Gets the latency above which a successful request counts as failed.
+ *
+ * Returns: the threshold in milliseconds, or 0 if disabled
+ */
+guint
+ai_failover_provider_get_slow_call_threshold(AiFailoverProvider *self);
+
+/**
+ * ai_failover_provider_set_slow_call_threshold:
+ * @self: an #AiFailoverProvider
+ * @threshold_ms: the threshold in milliseconds, or 0 to disable
+ *
+ * Sets the latency above which a successful request counts as a failure
+ * for the circuit breaker. The response is still returned; only later
+ * requests are affected, so a degraded provider is skipped before it
+ * starts timing out.
+ */
+void
+ai_failover_provider_set_slow_call_threshold(
+    AiFailoverProvider *self,
+    guint               threshold_ms
+);
+
+/**
+ * ai_failover_provider_get_open_timeout:
+ * @self: an #AiFailoverProvider
+ *
+ * Gets how long an open circuit waits before a trial request.
+ *
+ * Returns: the timeout in seconds
+ */
+guint
+ai_failover_provider_get_open_timeout(AiFailoverProvider *self);
+
+/**
+ * ai_failover_provider_set_open_timeout:
+ * @self: an #AiFailoverProvider
+ * @timeout_seconds: the timeout in seconds
+ *
+ * Sets how long an open circuit skips its provider. Afterwards the
+ * circuit becomes half-open and lets one trial request through.
+ */
+void
+ai_failover_provider_set_open_timeout(
+    AiFailoverProvider *self,
+    guint               timeout_seconds
+);
+
+G_END_DECLS
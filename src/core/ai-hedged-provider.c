@@ -0,0 +1,834 @@
+/*
+ * ai-hedged-provider.c - Hedged chat requests against slow tails
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "core/ai-hedged-provider.h"
+
+/* Latencies kept for the percentile estimate */
+#define LATENCY_WINDOW (128)
+
+/* Latencies needed before the estimate replaces the initial delay */
+#define MIN_SAMPLES (16)
+
+struct _AiHedgedProvider
+{
+    GObject parent_instance;
+
+    AiProvider *primary;
+    AiProvider *backup;
+
+    GMutex      lock;
+    gdouble     percentile;
+    guint       initial_delay;
+    guint       min_delay;
+    guint       latencies[LATENCY_WINDOW];  /* ring buffer, in ms */
+    guint       n_latencies;
+    guint       next_latency;
+    guint       n_hedged;
+    guint       n_hedge_wins;
+};
+
+static void ai_hedged_provider_provider_init(AiProviderInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(AiHedgedProvider, ai_hedged_provider, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(AI_TYPE_PROVIDER,
+                                              ai_hedged_provider_provider_init))
+
+enum
+{
+    PROP_0,
+    PROP_PRIMARY,
+    PROP_BACKUP,
+    PROP_PERCENTILE,
+    N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
+/*
+ * The two attempts of a request, the original and the hedge.
+ */
+enum
+{
+    ATTEMPT_PRIMARY,
+    ATTEMPT_HEDGE,
+    N_ATTEMPTS
+};
+
+/*
+ * State of one hedged chat request. The request arguments are copied,
+ * since the hedge is sent after the caller's chat call returned.
+ */
+typedef struct
+{
+    GList            *messages;     /* element-type AiMessage, owned refs */
+    AiRequestOptions *options;
+
+    GCancellable     *cancellables[N_ATTEMPTS];
+    gint64            started[N_ATTEMPTS];
+    guint             n_running;
+    gboolean          returned;
+    GError           *error;        /* first failure, returned if both fail */
+
+    GSource          *timer;
+    GSource          *cancel_source;    /* watches the caller's cancellable */
+} HedgeData;
+
+static void
+hedge_data_free(HedgeData *data)
+{
+    guint i;
+
+    g_list_free_full(data->messages, g_object_unref);
+    ai_request_options_free(data->options);
+
+    for (i = 0; i < N_ATTEMPTS; i++)
+    {
+        g_clear_object(&data->cancellables[i]);
+    }
+
+    if (data->cancel_source != NULL)
+    {
+        g_source_destroy(data->cancel_source);
+        g_source_unref(data->cancel_source);
+    }
+
+    g_clear_error(&data->error);
+    g_slice_free(HedgeData, data);
+}
+
+static void
+ai_hedged_provider_dispose(GObject *object)
+{
+    AiHedgedProvider *self = AI_HEDGED_PROVIDER(object);
+
+    g_clear_object(&self->primary);
+    g_clear_object(&self->backup);
+
+    G_OBJECT_CLASS(ai_hedged_provider_parent_class)->dispose(object);
+}
+
+static void
+ai_hedged_provider_finalize(GObject *object)
+{
+    AiHedgedProvider *self = AI_HEDGED_PROVIDER(object);
+
+    g_mutex_clear(&self->lock);
+
+    G_OBJECT_CLASS(ai_hedged_provider_parent_class)->finalize(object);
+}
+
+static void
+ai_hedged_provider_constructed(GObject *object)
+{
+    AiHedgedProvider *self = AI_HEDGED_PROVIDER(object);
+
+    G_OBJECT_CLASS(ai_hedged_provider_parent_class)->constructed(object);
+
+    if (self->backup == NULL && self->primary != NULL)
+    {
+        self->backup = g_object_ref(self->primary);
+    }
+}
+
+static void
+ai_hedged_provider_get_property(
+    GObject    *object,
+    guint       prop_id,
+    GValue     *value,
+    GParamSpec *pspec
+){
+    AiHedgedProvider *self = AI_HEDGED_PROVIDER(object);
+
+    switch (prop_id)
+    {
+        case PROP_PRIMARY:
+            g_value_set_object(value, self->primary);
+            break;
+        case PROP_BACKUP:
+            g_value_set_object(value, self->backup);
+            break;
+        case PROP_PERCENTILE:
+            g_value_set_double(value, ai_hedged_provider_get_percentile(self));
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+static void
+ai_hedged_provider_set_property(
+    GObject      *object,
+    guint         prop_id,
+    const GValue *value,
+    GParamSpec   *pspec
+){
+    AiHedgedProvider *self = AI_HEDGED_PROVIDER(object);
+
+    switch (prop_id)
+    {
+        case PROP_PRIMARY:
+            g_clear_object(&self->primary);
+            self->primary = g_value_dup_object(value);
+            break;
+        case PROP_BACKUP:
+            g_clear_object(&self->backup);
+            self->backup = g_value_dup_object(value);
+            break;
+        case PROP_PERCENTILE:
+            ai_hedged_provider_set_percentile(self, g_value_get_double(value));
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+static void
+ai_hedged_provider_class_init(AiHedgedProviderClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->dispose = ai_hedged_provider_dispose;
+    object_class->finalize = ai_hedged_provider_finalize;
+    object_class->constructed = ai_hedged_provider_constructed;
+    object_class->get_property = ai_hedged_provider_get_property;
+    object_class->set_property = ai_hedged_provider_set_property;
+
+    /**
+     * AiHedgedProvider:primary:
+     *
+     * The provider every request is sent to first.
+     */
+    properties[PROP_PRIMARY] =
+        g_param_spec_object("primary",
+                            "Primary",
+                            "The provider every request is sent to first",
+                            AI_TYPE_PROVIDER,
+                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+                            G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiHedgedProvider:backup:
+     *
+     * The provider hedges are sent to. Defaults to the primary.
+     */
+    properties[PROP_BACKUP] =
+        g_param_spec_object("backup",
+                            "Backup",
+                            "The provider hedges are sent to",
+                            AI_TYPE_PROVIDER,
+                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY |
+                            G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiHedgedProvider:percentile:
+     *
+     * The latency percentile used as the hedge delay.
+     */
+    properties[PROP_PERCENTILE] =
+        g_param_spec_double("percentile",
+                            "Percentile",
+                            "The latency percentile used as the hedge delay",
+                            0.5, 1.0, AI_HEDGED_PROVIDER_DEFAULT_PERCENTILE,
+                            G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                            G_PARAM_STATIC_STRINGS);
+
+    g_object_class_install_properties(object_class, N_PROPS, properties);
+}
+
+static void
+ai_hedged_provider_init(AiHedgedProvider *self)
+{
+    g_mutex_init(&self->lock);
+    self->percentile = AI_HEDGED_PROVIDER_DEFAULT_PERCENTILE;
+    self->initial_delay = AI_HEDGED_PROVIDER_DEFAULT_INITIAL_DELAY;
+    self->min_delay = AI_HEDGED_PROVIDER_DEFAULT_MIN_DELAY;
+}
+
+/**
+ * ai_hedged_provider_new:
+ * @primary: the #AiProvider every request is sent to first
+ * @backup: (nullable): the #AiProvider hedges are sent to, or %NULL
+ *
+ * Creates a hedging wrapper around @primary.
+ *
+ * Returns: (transfer full): a new #AiHedgedProvider
+ */
+AiHedgedProvider *
+ai_hedged_provider_new(
+    AiProvider *primary,
+    AiProvider *backup
+){
+    g_return_val_if_fail(AI_IS_PROVIDER(primary), NULL);
+    g_return_val_if_fail(backup == NULL || AI_IS_PROVIDER(backup), NULL);
+
+    return g_object_new(AI_TYPE_HEDGED_PROVIDER,
+                        "primary", primary,
+                        "backup", backup,
+                        NULL);
+}
+
+/**
+ * ai_hedged_provider_get_primary:
+ * @self: an #AiHedgedProvider
+ *
+ * Gets the provider requests are sent to first.
+ *
+ * Returns: (transfer none): the primary #AiProvider
+ */
+AiProvider *
+ai_hedged_provider_get_primary(AiHedgedProvider *self)
+{
+    g_return_val_if_fail(AI_IS_HEDGED_PROVIDER(self), NULL);
+
+    return self->primary;
+}
+
+/**
+ * ai_hedged_provider_get_backup:
+ * @self: an #AiHedgedProvider
+ *
+ * Gets the provider hedges are sent to.
+ *
+ * Returns: (transfer none): the backup #AiProvider
+ */
+AiProvider *
+ai_hedged_provider_get_backup(AiHedgedProvider *self)
+{
+    g_return_val_if_fail(AI_IS_HEDGED_PROVIDER(self), NULL);
+
+    return self->backup;
+}
+
+/**
+ * ai_hedged_provider_get_percentile:
+ * @self: an #AiHedgedProvider
+ *
+ * Gets the latency percentile used as the hedge delay.
+ *
+ * Returns: the percentile
+ */
+gdouble
+ai_hedged_provider_get_percentile(AiHedgedProvider *self)
+{
+    gdouble percentile;
+
+    g_return_val_if_fail(AI_IS_HEDGED_PROVIDER(self), 0.0);
+
+    g_mutex_lock(&self->lock);
+    percentile = self->percentile;
+    g_mutex_unlock(&self->lock);
+
+    return percentile;
+}
+
+/**
+ * ai_hedged_provider_set_percentile:
+ * @self: an #AiHedgedProvider
+ * @percentile: the percentile, between 0.5 and 1.0
+ *
+ * Sets the latency percentile used as the hedge delay.
+ */
+void
+ai_hedged_provider_set_percentile(
+    AiHedgedProvider *self,
+    gdouble           percentile
+){
+    g_return_if_fail(AI_IS_HEDGED_PROVIDER(self));
+    g_return_if_fail(percentile >= 0.5 && percentile <= 1.0);
+
+    g_mutex_lock(&self->lock);
+    if (self->percentile == percentile)
+    {
+        g_mutex_unlock(&self->lock);
+        return;
+    }
+    self->percentile = percentile;
+    g_mutex_unlock(&self->lock);
+
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_PERCENTILE]);
+}
+
+/**
+ * ai_hedged_provider_set_delay_bounds:
+ * @self: an #AiHedgedProvider
+ * @initial_delay_ms: the delay used until enough latencies are known
+ * @min_delay_ms: the lower bound of the adaptive delay
+ *
+ * Sets the delay used before the latency distribution is known, and
+ * the shortest delay the adaptive estimate may go down to.
+ */
+void
+ai_hedged_provider_set_delay_bounds(
+    AiHedgedProvider *self,
+    guint             initial_delay_ms,
+    guint             min_delay_ms
+){
+    g_return_if_fail(AI_IS_HEDGED_PROVIDER(self));
+
+    g_mutex_lock(&self->lock);
+    self->initial_delay = initial_delay_ms;
+    self->min_delay = min_delay_ms;
+    g_mutex_unlock(&self->lock);
+}
+
+static gint
+compare_latency(
+    gconstpointer a,
+    gconstpointer b
+){
+    guint la = *(const guint *)a;
+    guint lb = *(const guint *)b;
+
+    return la < lb ? -1 : la > lb ? 1 : 0;
+}
+
+/**
+ * ai_hedged_provider_get_hedge_delay:
+ * @self: an #AiHedgedProvider
+ *
+ * Gets the delay after which a request would be hedged right now: the
+ * configured percentile of the last 128 latencies, or the initial delay
+ * while fewer than 16 are known.
+ *
+ * Returns: the delay in milliseconds
+ */
+guint
+ai_hedged_provider_get_hedge_delay(AiHedgedProvider *self)
+{
+    guint sorted[LATENCY_WINDOW];
+    guint delay;
+    guint n;
+    guint i;
+
+    g_return_val_if_fail(AI_IS_HEDGED_PROVIDER(self), 0);
+
+    g_mutex_lock(&self->lock);
+
+    n = self->n_latencies;
+    if (n < MIN_SAMPLES)
+    {
+        delay = self->initial_delay;
+        g_mutex_unlock(&self->lock);
+        return delay;
+    }
+
+    memcpy(sorted, self->latencies, n * sizeof(guint));
+    qsort(sorted, n, sizeof(guint), compare_latency);
+
+    /* Nearest-rank percentile */
+    i = (guint)(self->percentile * n + 0.999999);
+    delay = MAX(sorted[CLAMP(i, 1u, n) - 1], self->min_delay);
+
+    g_mutex_unlock(&self->lock);
+
+    return delay;
+}
+
+/**
+ * ai_hedged_provider_get_n_hedged:
+ * @self: an #AiHedgedProvider
+ *
+ * Gets the number of requests for which a hedge was sent.
+ *
+ * Returns: the hedge count
+ */
+guint
+ai_hedged_provider_get_n_hedged(AiHedgedProvider *self)
+{
+    guint n;
+
+    g_return_val_if_fail(AI_IS_HEDGED_PROVIDER(self), 0);
+
+    g_mutex_lock(&self->lock);
+    n = self->n_hedged;
+    g_mutex_unlock(&self->lock);
+
+    return n;
+}
+
+/**
+ * ai_hedged_provider_get_n_hedge_wins:
+ * @self: an #AiHedgedProvider
+ *
+ * Gets the number of requests the hedge answered first.
+ *
+ * Returns: the count of hedge wins
+ */
+guint
+ai_hedged_provider_get_n_hedge_wins(AiHedgedProvider *self)
+{
+    guint n;
+
+    g_return_val_if_fail(AI_IS_HEDGED_PROVIDER(self), 0);
+
+    g_mutex_lock(&self->lock);
+    n = self->n_hedge_wins;
+    g_mutex_unlock(&self->lock);
+
+    return n;
+}
+
+/*
+ * Record the latency of a request, from when its primary started. The
+ * slow primaries a hedge beats are cancelled, so a hedge win stands in
+ * for one: the primary would have taken at least that long. Timing it
+ * from the hedge instead would leave the tail out of the window and
+ * pull the delay down, hedging ever more requests.
+ */
+static void
+record_win(
+    AiHedgedProvider *self,
+    guint             attempt,
+    gint64            latency_us
+){
+    g_mutex_lock(&self->lock);
+
+    self->latencies[self->next_latency] = (guint)MIN(latency_us / 1000, G_MAXUINT);
+    self->next_latency = (self->next_latency + 1) % LATENCY_WINDOW;
+    self->n_latencies = MIN(self->n_latencies + 1, LATENCY_WINDOW);
+
+    if (attempt == ATTEMPT_HEDGE)
+    {
+        self->n_hedge_wins++;
+    }
+
+    g_mutex_unlock(&self->lock);
+}
+
+static gboolean
+on_caller_cancelled(
+    GCancellable *cancellable,
+    gpointer      user_data
+){
+    HedgeData *data = user_data;
+    guint i;
+
+    (void)cancellable;
+
+    /* The attempts then fail with their own cancellation errors */
+    for (i = 0; i < N_ATTEMPTS; i++)
+    {
+        g_cancellable_cancel(data->cancellables[i]);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * Stop everything still pending once the task has its result.
+ */
+static void
+finish_hedge(HedgeData *data)
+{
+    guint i;
+
+    data->returned = TRUE;
+
+    if (data->timer != NULL)
+    {
+        g_source_destroy(data->timer);
+        g_clear_pointer(&data->timer, g_source_unref);
+    }
+
+    if (data->cancel_source != NULL)
+    {
+        g_source_destroy(data->cancel_source);
+        g_clear_pointer(&data->cancel_source, g_source_unref);
+    }
+
+    /* Cancel the loser, if it is still running */
+    for (i = 0; i < N_ATTEMPTS; i++)
+    {
+        g_cancellable_cancel(data->cancellables[i]);
+    }
+}
+
+static void
+on_attempt_done(
+    GTask        *task,
+    guint         attempt,
+    AiProvider   *provider,
+    GAsyncResult *result
+){
+    AiHedgedProvider *self = g_task_get_source_object(task);
+    HedgeData *data = g_task_get_task_data(task);
+    g_autoptr(AiResponse) response = NULL;
+    GError *error = NULL;
+
+    response = ai_provider_chat_finish(provider, result, &error);
+    data->n_running--;
+
+    if (data->returned)
+    {
+        g_clear_error(&error);
+        return;
+    }
+
+    if (response != NULL)
+    {
+        record_win(self, attempt, g_get_monotonic_time() - data->started[ATTEMPT_PRIMARY]);
+        finish_hedge(data);
+        g_task_return_pointer(task, g_steal_pointer(&response), g_object_unref);
+        return;
+    }
+
+    if (data->error == NULL)
+    {
+        data->error = error;
+    }
+    else
+    {
+        g_error_free(error);
+    }
+
+    /* Wait for the other attempt while it may still succeed */
+    if (data->n_running > 0)
+    {
+        return;
+    }
+
+    finish_hedge(data);
+    g_task_return_error(task, g_steal_pointer(&data->error));
+}
+
+static void
+on_primary_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+
+    on_attempt_done(task, ATTEMPT_PRIMARY, AI_PROVIDER(source), result);
+    g_object_unref(task);
+}
+
+static void
+on_hedge_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+
+    on_attempt_done(task, ATTEMPT_HEDGE, AI_PROVIDER(source), result);
+    g_object_unref(task);
+}
+
+static void
+start_attempt(
+    GTask *task,
+    guint  attempt
+){
+    AiHedgedProvider *self = g_task_get_source_object(task);
+    HedgeData *data = g_task_get_task_data(task);
+
+    data->started[attempt] = g_get_monotonic_time();
+    data->n_running++;
+
+    ai_provider_chat_with_options_async(attempt == ATTEMPT_PRIMARY ? self->primary : self->backup,
+                                        data->messages,
+                                        data->options,
+                                        data->cancellables[attempt],
+                                        attempt == ATTEMPT_PRIMARY ? on_primary_done : on_hedge_done,
+                                        g_object_ref(task));
+}
+
+static gboolean
+on_hedge_timeout(gpointer user_data)
+{
+    GTask *task = G_TASK(user_data);
+    AiHedgedProvider *self = g_task_get_source_object(task);
+    HedgeData *data = g_task_get_task_data(task);
+
+    g_clear_pointer(&data->timer, g_source_unref);
+
+    /* A failed primary was already reported; do not hedge a dead request */
+    if (data->returned || data->n_running == 0 ||
+        g_cancellable_is_cancelled(data->cancellables[ATTEMPT_HEDGE]))
+    {
+        return G_SOURCE_REMOVE;
+    }
+
+    g_mutex_lock(&self->lock);
+    self->n_hedged++;
+    g_mutex_unlock(&self->lock);
+
+    start_attempt(task, ATTEMPT_HEDGE);
+
+    return G_SOURCE_REMOVE;
+}
+
+static AiProviderType
+ai_hedged_provider_get_provider_type(AiProvider *provider)
+{
+    AiHedgedProvider *self = AI_HEDGED_PROVIDER(provider);
+
+    return ai_provider_get_provider_type(self->primary);
+}
+
+static const gchar *
+ai_hedged_provider_get_name(AiProvider *provider)
+{
+    AiHedgedProvider *self = AI_HEDGED_PROVIDER(provider);
+
+    return ai_provider_get_name(self->primary);
+}
+
+static const gchar *
+ai_hedged_provider_get_default_model(AiProvider *provider)
+{
+    AiHedgedProvider *self = AI_HEDGED_PROVIDER(provider);
+
+    return ai_provider_get_default_model(self->primary);
+}
+
+static void
+ai_hedged_provider_chat_with_options_async(
+    AiProvider             *provider,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
+){
+    AiHedgedProvider *self = AI_HEDGED_PROVIDER(provider);
+    HedgeData *data;
+    GTask *task;
+    guint delay;
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_hedged_provider_chat_with_options_async);
+
+    data = g_slice_new0(HedgeData);
+    data->messages = g_list_copy_deep(messages, (GCopyFunc)g_object_ref, NULL);
+    data->options = options != NULL ? ai_request_options_copy(options) : ai_request_options_new();
+    data->cancellables[ATTEMPT_PRIMARY] = g_cancellable_new();
+    data->cancellables[ATTEMPT_HEDGE] = g_cancellable_new();
+    g_task_set_task_data(task, data, (GDestroyNotify)hedge_data_free);
+
+    /* The caller cancelling stops both attempts */
+    if (cancellable != NULL)
+    {
+        data->cancel_source = g_cancellable_source_new(cancellable);
+        g_source_set_callback(data->cancel_source,
+                              (GSourceFunc)(GCallback)on_caller_cancelled,
+                              data, NULL);
+        g_source_attach(data->cancel_source, g_task_get_context(task));
+    }
+
+    delay = ai_hedged_provider_get_hedge_delay(self);
+    data->timer = g_timeout_source_new(delay);
+    g_source_set_callback(data->timer, on_hedge_timeout, g_object_ref(task), g_object_unref);
+    g_source_attach(data->timer, g_task_get_context(task));
+
+    start_attempt(task, ATTEMPT_PRIMARY);
+    g_object_unref(task);
+}
+
+static void
+ai_hedged_provider_chat_async(
+    AiProvider          *provider,
+    GList               *messages,
+    const gchar         *system_prompt,
+    gint                 max_tokens,
+    GList               *tools,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    ai_hedged_provider_chat_with_options_async(provider, messages, options,
+                                               cancellable, callback, user_data);
+}
+
+static AiResponse *
+ai_hedged_provider_chat_finish(
+    AiProvider    *provider,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(g_task_is_valid(result, provider), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+on_list_models_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    GError *error = NULL;
+    GList *models;
+
+    models = ai_provider_list_models_finish(AI_PROVIDER(source), result, &error);
+    if (error != NULL)
+    {
+        g_task_return_error(task, error);
+    }
+    else
+    {
+        g_task_return_pointer(task, models, NULL);
+    }
+    g_object_unref(task);
+}
+
+static void
+ai_hedged_provider_list_models_async(
+    AiProvider          *provider,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    AiHedgedProvider *self = AI_HEDGED_PROVIDER(provider);
+    GTask *task;
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_hedged_provider_list_models_async);
+
+    ai_provider_list_models_async(self->primary, cancellable, on_list_models_done, task);
+}
+
+static GList *
+ai_hedged_provider_list_models_finish(
+    AiProvider    *provider,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(g_task_is_valid(result, provider), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+ai_hedged_provider_provider_init(AiProviderInterface *iface)
+{
+    iface->get_provider_type = ai_hedged_provider_get_provider_type;
+    iface->get_name = ai_hedged_provider_get_name;
+    iface->get_default_model = ai_hedged_provider_get_default_model;
+    iface->chat_async = ai_hedged_provider_chat_async;
+    iface->chat_with_options_async = ai_hedged_provider_chat_with_options_async;
+    iface->chat_finish = ai_hedged_provider_chat_finish;
+    iface->list_models_async = ai_hedged_provider_list_models_async;
+    iface->list_models_finish = ai_hedged_provider_list_models_finish;
+}
@@ -0,0 +1,176 @@
+/*
+ * ai-hedged-provider.h - Hedged chat requests against slow tails
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * AiHedgedProvider wraps a provider and, when a chat request has not
+ * completed within the hedge delay, sends a duplicate to a backup
+ * provider (or the same one). Whichever finishes first wins and the
+ * other is cancelled. The hedge delay follows a percentile of the
+ * latencies observed so far, so only the slow tail is duplicated.
+ *
+ * Quick start:
+ *   g_autoptr(AiHedgedProvider) hedged = NULL;
+ *
+ *   hedged = ai_hedged_provider_new(AI_PROVIDER(claude), NULL);
+ *   ai_provider_chat_async(AI_PROVIDER(hedged), messages, NULL, 256, NULL,
+ *                          NULL, on_chat_done, NULL);
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include "core/ai-provider.h"
+
+G_BEGIN_DECLS
+
+/**
+ * AI_HEDGED_PROVIDER_DEFAULT_PERCENTILE:
+ *
+ * Default latency percentile used as the hedge delay.
+ */
+#define AI_HEDGED_PROVIDER_DEFAULT_PERCENTILE (0.95)
+
+/**
+ * AI_HEDGED_PROVIDER_DEFAULT_INITIAL_DELAY:
+ *
+ * Default hedge delay in milliseconds, used until enough latencies
+ * have been observed.
+ */
+#define AI_HEDGED_PROVIDER_DEFAULT_INITIAL_DELAY (2000)
+
+/**
+ * AI_HEDGED_PROVIDER_DEFAULT_MIN_DELAY:
+ *
+ * Default lower bound of the hedge delay in milliseconds.
+ */
+#define AI_HEDGED_PROVIDER_DEFAULT_MIN_DELAY (50)
+
+#define AI_TYPE_HEDGED_PROVIDER (ai_hedged_provider_get_type())
+
+G_DECLARE_FINAL_TYPE(AiHedgedProvider, ai_hedged_provider, AI, HEDGED_PROVIDER, GObject)
+
+/**
+ * ai_hedged_provider_new:
+ * @primary: the #AiProvider every request is sent to first
+ * @backup: (nullable): the #AiProvider hedges are sent to, or %NULL to
+ *   hedge against @primary itself
+ *
+ * Creates a hedging wrapper. Only non-streaming chat requests are
+ * hedged; model listing goes to @primary.
+ *
+ * Returns: (transfer full): a new #AiHedgedProvider
+ */
+AiHedgedProvider *
+ai_hedged_provider_new(
+    AiProvider *primary,
+    AiProvider *backup
+);
+
+/**
+ * ai_hedged_provider_get_primary:
+ * @self: an #AiHedgedProvider
+ *
+ * Gets the provider requests are sent to first.
+ *
+ * Returns: (transfer none): the primary #AiProvider
+ */
+AiProvider *
+ai_hedged_provider_get_primary(AiHedgedProvider *self);
+
+/**
+ * ai_hedged_provider_get_backup:
+ * @self: an #AiHedgedProvider
+ *
+ * Gets the provider hedges are sent to.
+ *
+ * Returns: (transfer none): the backup #AiProvider
+ */
+AiProvider *
+ai_hedged_provider_get_backup(AiHedgedProvider *self);
+
+/**
+ * ai_hedged_provider_get_percentile:
+ * @self: an #AiHedgedProvider
+ *
+ * Gets the latency percentile used as the hedge delay.
+ *
+ * Returns: the percentile, between 0.5 and 1.0
+ */
+gdouble
+ai_hedged_provider_get_percentile(AiHedgedProvider *self);
+
+/**
+ * ai_hedged_provider_set_percentile:
+ * @self: an #AiHedgedProvider
+ * @percentile: the percentile, between 0.5 and 1.0
+ *
+ * Sets the latency percentile used as the hedge delay. With 0.95, a
+ * request is hedged once it is slower than 95% of recent requests, so
+ * about one request in twenty is duplicated.
+ */
+void
+ai_hedged_provider_set_percentile(
+    AiHedgedProvider *self,
+    gdouble           percentile
+);
+
+/**
+ * ai_hedged_provider_set_delay_bounds:
+ * @self: an #AiHedgedProvider
+ * @initial_delay_ms: the delay used until enough latencies are known
+ * @min_delay_ms: the lower bound of the adaptive delay
+ *
+ * Sets the delay used before the latency distribution is known, and
+ * the shortest delay the adaptive estimate may go down to.
+ */
+void
+ai_hedged_provider_set_delay_bounds(
+    AiHedgedProvider *self,
+    guint             initial_delay_ms,
+    guint             min_delay_ms
+);
+
+/**
+ * ai_hedged_provider_get_hedge_delay:
+ * @self: an #AiHedgedProvider
+ *
+ * Gets the delay after which a request would be hedged right now.
+ *
+ * Returns: the delay in milliseconds
+ */
+guint
+ai_hedged_provider_get_hedge_delay(AiHedgedProvider *self);
+
+/**
+ * ai_hedged_provider_get_n_hedged:
+ * @self: an #AiHedgedProvider
+ *
+ * Gets the number of requests for which a hedge was sent.
+ *
+ * Returns: the hedge count
+ */
+guint
+ai_hedged_provider_get_n_hedged(AiHedgedProvider *self);
+
+/**
+ * ai_hedged_provider_get_n_hedge_wins:
+ * @self: an #AiHedgedProvider
+ *
+ * Gets the number of requests the hedge answered first.
+ *
+ * Returns: the count of hedge wins
+ */
+guint
+ai_hedged_provider_get_n_hedge_wins(AiHedgedProvider *self);
+
+G_END_DECLS
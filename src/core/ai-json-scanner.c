@@ -0,0 +1,637 @@
+/*
+ * ai-json-scanner.c - Allocation-free JSON pull scanner
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "core/ai-json-scanner.h"
+
+static gboolean
+scanner_fail(AiJsonScanner *self)
+{
+    self->failed = TRUE;
+    return FALSE;
+}
+
+static inline void
+skip_whitespace(AiJsonScanner *self)
+{
+    while (self->pos < self->end
+           && (*self->pos == ' ' || *self->pos == '\n' || *self->pos == '\r' || *self->pos == '\t'))
+    {
+        self->pos++;
+    }
+}
+
+/*
+ * Skip whitespace and consume @c if it comes next.
+ */
+static inline gboolean
+consume_char(
+    AiJsonScanner *self,
+    gchar          c
+){
+    skip_whitespace(self);
+
+    if (self->pos < self->end && *self->pos == c)
+    {
+        self->pos++;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+static gboolean
+consume_literal(
+    AiJsonScanner *self,
+    const gchar   *literal,
+    gsize          length
+){
+    if ((gsize)(self->end - self->pos) >= length && memcmp(self->pos, literal, length) == 0)
+    {
+        self->pos += length;
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*
+ * Read a string without escapes as a slice of the text. Names and
+ * enumerated values such as "text_delta" never need escaping.
+ */
+static gboolean
+read_plain_string(
+    AiJsonScanner  *self,
+    const gchar   **value,
+    gsize          *length
+){
+    const gchar *p;
+
+    if (!consume_char(self, '"'))
+    {
+        return scanner_fail(self);
+    }
+
+    for (p = self->pos; p < self->end && *p != '"'; p++)
+    {
+        if (*p == '\\' || (guchar)*p < 0x20)
+        {
+            return scanner_fail(self);
+        }
+    }
+
+    if (p >= self->end)
+    {
+        return scanner_fail(self);
+    }
+
+    *value = self->pos;
+    *length = p - self->pos;
+    self->pos = p + 1;
+
+    return TRUE;
+}
+
+static gboolean
+read_hex4(
+    const gchar *p,
+    const gchar *end,
+    gunichar    *value
+){
+    gint i;
+
+    if (end - p < 4)
+    {
+        return FALSE;
+    }
+
+    *value = 0;
+    for (i = 0; i < 4; i++)
+    {
+        gint digit = g_ascii_xdigit_value(p[i]);
+
+        if (digit < 0)
+        {
+            return FALSE;
+        }
+        *value = (*value << 4) | digit;
+    }
+
+    return TRUE;
+}
+
+/*
+ * Decode the escape after a backslash at @p, appending it to @out.
+ * Returns where the escape ends, or NULL if it is invalid.
+ */
+static const gchar *
+decode_escape(
+    const gchar *p,
+    const gchar *end,
+    GString     *out
+){
+    gunichar c;
+    gunichar low;
+
+    if (p >= end)
+    {
+        return NULL;
+    }
+
+    switch (*p)
+    {
+        case '"':
+        case '\\':
+        case '/':
+            c = *p;
+            break;
+        case 'b':
+            c = '\b';
+            break;
+        case 'f':
+            c = '\f';
+            break;
+        case 'n':
+            c = '\n';
+            break;
+        case 'r':
+            c = '\r';
+            break;
+        case 't':
+            c = '\t';
+            break;
+        case 'u':
+            if (!read_hex4(p + 1, end, &c))
+            {
+                return NULL;
+            }
+            p += 4;
+
+            if (c >= 0xD800 && c <= 0xDBFF)
+            {
+                /* A high surrogate must be followed by a low one */
+                if (end - p < 3 || p[1] != '\\' || p[2] != 'u'
+                    || !read_hex4(p + 3, end, &low)
+                    || low < 0xDC00 || low > 0xDFFF)
+                {
+                    return NULL;
+                }
+                c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                p += 6;
+            }
+            else if ((c >= 0xDC00 && c <= 0xDFFF) || c == 0)
+            {
+                /* A nul would truncate the text for every consumer */
+                return NULL;
+            }
+            break;
+        default:
+            return NULL;
+    }
+
+    if (out != NULL)
+    {
+        g_string_append_unichar(out, c);
+    }
+
+    return p + 1;
+}
+
+/**
+ * ai_json_scanner_init:
+ * @self: an #AiJsonScanner
+ * @json: the JSON text
+ * @length: the length of @json, or -1 if it is nul-terminated
+ *
+ * Starts scanning @json.
+ */
+void
+ai_json_scanner_init(
+    AiJsonScanner *self,
+    const gchar   *json,
+    gssize         length
+){
+    g_return_if_fail(self != NULL);
+    g_return_if_fail(json != NULL || length == 0);
+
+    if (length < 0)
+    {
+        length = strlen(json);
+    }
+
+    self->pos = json;
+    self->end = json + length;
+    self->first = FALSE;
+    self->failed = FALSE;
+}
+
+/**
+ * ai_json_scanner_enter_object:
+ * @self: an #AiJsonScanner
+ *
+ * Consumes the opening brace of an object.
+ *
+ * Returns: %TRUE if the next value is an object
+ */
+gboolean
+ai_json_scanner_enter_object(AiJsonScanner *self)
+{
+    if (self->failed || !consume_char(self, '{'))
+    {
+        return scanner_fail(self);
+    }
+
+    self->first = TRUE;
+
+    return TRUE;
+}
+
+/**
+ * ai_json_scanner_next_member:
+ * @self: an #AiJsonScanner
+ * @name: (out) (transfer none): return location for the member name
+ * @name_len: (out): return location for its length
+ *
+ * Reads the name of the next member of the current object.
+ *
+ * Returns: %TRUE if there is a member
+ */
+gboolean
+ai_json_scanner_next_member(
+    AiJsonScanner  *self,
+    const gchar   **name,
+    gsize          *name_len
+){
+    if (self->failed)
+    {
+        return FALSE;
+    }
+
+    /*
+     * first is only true right after a brace was opened. The object
+     * that ends here may be nested, in which case the next call is for
+     * its parent, past its first member.
+     */
+    if (consume_char(self, '}'))
+    {
+        self->first = FALSE;
+        return FALSE;
+    }
+
+    if (!self->first && !consume_char(self, ','))
+    {
+        return scanner_fail(self);
+    }
+    self->first = FALSE;
+
+    if (!read_plain_string(self, name, name_len))
+    {
+        return FALSE;
+    }
+
+    if (!consume_char(self, ':'))
+    {
+        return scanner_fail(self);
+    }
+
+    return TRUE;
+}
+
+/**
+ * ai_json_scanner_enter_array:
+ * @self: an #AiJsonScanner
+ *
+ * Consumes the opening bracket of an array.
+ *
+ * Returns: %TRUE if the next value is an array
+ */
+gboolean
+ai_json_scanner_enter_array(AiJsonScanner *self)
+{
+    if (self->failed || !consume_char(self, '['))
+    {
+        return scanner_fail(self);
+    }
+
+    self->first = TRUE;
+
+    return TRUE;
+}
+
+/**
+ * ai_json_scanner_next_element:
+ * @self: an #AiJsonScanner
+ *
+ * Moves to the next element of the current array.
+ *
+ * Returns: %TRUE if there is an element
+ */
+gboolean
+ai_json_scanner_next_element(AiJsonScanner *self)
+{
+    if (self->failed)
+    {
+        return FALSE;
+    }
+
+    if (consume_char(self, ']'))
+    {
+        self->first = FALSE;
+        return FALSE;
+    }
+
+    if (!self->first && !consume_char(self, ','))
+    {
+        return scanner_fail(self);
+    }
+    self->first = FALSE;
+
+    return TRUE;
+}
+
+/**
+ * ai_json_scanner_read_string:
+ * @self: an #AiJsonScanner
+ * @out: (nullable): the #GString to append the unescaped string to
+ *
+ * Reads a string value and appends it to @out.
+ *
+ * Returns: %TRUE if a valid string was read
+ */
+gboolean
+ai_json_scanner_read_string(
+    AiJsonScanner *self,
+    GString       *out
+){
+    gsize mark = out != NULL ? out->len : 0;
+    const gchar *run;
+    const gchar *p;
+
+    if (self->failed || !consume_char(self, '"'))
+    {
+        return scanner_fail(self);
+    }
+
+    /*
+     * Runs between escapes are validated and copied whole. An escape
+     * is pure ASCII, so it never splits a valid UTF-8 sequence.
+     */
+    run = p = self->pos;
+    while (p < self->end)
+    {
+        guchar c = *p;
+
+        if (c != '"' && c != '\\')
+        {
+            if (c < 0x20)
+            {
+                break;
+            }
+            p++;
+            continue;
+        }
+
+        if (!g_utf8_validate_len(run, p - run, NULL))
+        {
+            break;
+        }
+        if (out != NULL)
+        {
+            g_string_append_len(out, run, p - run);
+        }
+
+        if (c == '"')
+        {
+            self->pos = p + 1;
+            return TRUE;
+        }
+
+        p = decode_escape(p + 1, self->end, out);
+        if (p == NULL)
+        {
+            break;
+        }
+        run = p;
+    }
+
+    if (out != NULL)
+    {
+        g_string_truncate(out, mark);
+    }
+
+    return scanner_fail(self);
+}
+
+/**
+ * ai_json_scanner_read_plain_string:
+ * @self: an #AiJsonScanner
+ * @value: (out) (transfer none): return location for the string
+ * @length: (out): return location for its length
+ *
+ * Reads a string value without escapes as a slice of the JSON text.
+ *
+ * Returns: %TRUE if a string without escapes was read
+ */
+gboolean
+ai_json_scanner_read_plain_string(
+    AiJsonScanner  *self,
+    const gchar   **value,
+    gsize          *length
+){
+    if (self->failed)
+    {
+        return FALSE;
+    }
+
+    return read_plain_string(self, value, length);
+}
+
+/**
+ * ai_json_scanner_read_null:
+ * @self: an #AiJsonScanner
+ *
+ * Consumes a null value if there is one.
+ *
+ * Returns: %TRUE if the value was null
+ */
+gboolean
+ai_json_scanner_read_null(AiJsonScanner *self)
+{
+    if (self->failed)
+    {
+        return FALSE;
+    }
+
+    skip_whitespace(self);
+
+    return consume_literal(self, "null", 4);
+}
+
+/**
+ * ai_json_scanner_read_boolean:
+ * @self: an #AiJsonScanner
+ * @value: (out): return location for the value
+ *
+ * Reads a boolean value.
+ *
+ * Returns: %TRUE if the value was a boolean
+ */
+gboolean
+ai_json_scanner_read_boolean(
+    AiJsonScanner *self,
+    gboolean      *value
+){
+    if (self->failed)
+    {
+        return FALSE;
+    }
+
+    skip_whitespace(self);
+
+    if (consume_literal(self, "true", 4))
+    {
+        *value = TRUE;
+        return TRUE;
+    }
+
+    if (consume_literal(self, "false", 5))
+    {
+        *value = FALSE;
+        return TRUE;
+    }
+
+    return scanner_fail(self);
+}
+
+static gboolean
+skip_number(AiJsonScanner *self)
+{
+    const gchar *start = self->pos;
+
+    if (self->pos < self->end && *self->pos == '-')
+    {
+        self->pos++;
+    }
+
+    if (self->pos >= self->end || !g_ascii_isdigit(*self->pos))
+    {
+        return scanner_fail(self);
+    }
+
+    while (self->pos < self->end
+           && (g_ascii_isdigit(*self->pos) || *self->pos == '.' || *self->pos == 'e'
+               || *self->pos == 'E' || *self->pos == '+' || *self->pos == '-'))
+    {
+        self->pos++;
+    }
+
+    return self->pos > start;
+}
+
+static gboolean
+skip_container(AiJsonScanner *self)
+{
+    guint depth = 0;
+
+    while (self->pos < self->end)
+    {
+        switch (*self->pos)
+        {
+            case '"':
+                if (!ai_json_scanner_read_string(self, NULL))
+                {
+                    return FALSE;
+                }
+                continue;
+            case '{':
+            case '[':
+                depth++;
+                break;
+            case '}':
+            case ']':
+                if (--depth == 0)
+                {
+                    self->pos++;
+                    return TRUE;
+                }
+                break;
+            default:
+                break;
+        }
+        self->pos++;
+    }
+
+    return scanner_fail(self);
+}
+
+/**
+ * ai_json_scanner_skip_value:
+ * @self: an #AiJsonScanner
+ *
+ * Skips the next value of any type.
+ *
+ * Returns: %TRUE if a value was skipped
+ */
+gboolean
+ai_json_scanner_skip_value(AiJsonScanner *self)
+{
+    gboolean value;
+
+    if (self->failed)
+    {
+        return FALSE;
+    }
+
+    skip_whitespace(self);
+
+    if (self->pos >= self->end)
+    {
+        return scanner_fail(self);
+    }
+
+    switch (*self->pos)
+    {
+        case '"':
+            return ai_json_scanner_read_string(self, NULL);
+        case '{':
+        case '[':
+            return skip_container(self);
+        case 't':
+        case 'f':
+            return ai_json_scanner_read_boolean(self, &value);
+        case 'n':
+            return ai_json_scanner_read_null(self) || scanner_fail(self);
+        default:
+            return skip_number(self);
+    }
+}
+
+/**
+ * ai_json_scanner_at_end:
+ * @self: an #AiJsonScanner
+ *
+ * Checks that the whole text was scanned without a failure.
+ *
+ * Returns: %TRUE if the scan succeeded
+ */
+gboolean
+ai_json_scanner_at_end(AiJsonScanner *self)
+{
+    if (self->failed)
+    {
+        return FALSE;
+    }
+
+    skip_whitespace(self);
+
+    return self->pos == self->end;
+}
@@ -0,0 +1,230 @@
+/*
+ * ai-json-scanner.h - Allocation-free JSON pull scanner
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * Reads members and values straight from JSON text, in document order,
+ * without building a tree. It is meant for the few small event shapes
+ * that make up almost all of a streamed response, such as text deltas:
+ * the caller walks the shape it expects and, if anything does not
+ * match, falls back to #JsonParser.
+ *
+ * Errors are sticky. Once a call fails, every later call fails too, so
+ * a whole scan can be checked once with ai_json_scanner_at_end().
+ *
+ * Quick start:
+ *   ai_json_scanner_init(&scanner, json, length);
+ *   ai_json_scanner_enter_object(&scanner);
+ *   while (ai_json_scanner_next_member(&scanner, &name, &name_len))
+ *   {
+ *       if (AI_JSON_SLICE_IS(name, name_len, "text"))
+ *           ai_json_scanner_read_string(&scanner, text);
+ *       else
+ *           ai_json_scanner_skip_value(&scanner);
+ *   }
+ *
+ *   // if !ai_json_scanner_at_end(&scanner), fall back to JsonParser
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <string.h>
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * AiJsonScanner:
+ *
+ * The scanner state. It lives on the stack and needs no cleanup; all
+ * fields are private.
+ */
+typedef struct
+{
+    /*< private >*/
+    const gchar *pos;
+    const gchar *end;
+    gboolean     first;
+    gboolean     failed;
+} AiJsonScanner;
+
+/**
+ * AI_JSON_SLICE_IS:
+ * @str: a member name or plain string read by the scanner
+ * @len: its length
+ * @literal: a string literal
+ *
+ * Whether the slice of JSON text is @literal.
+ */
+#define AI_JSON_SLICE_IS(str, len, literal) \
+    ((len) == sizeof(literal) - 1 && memcmp((str), (literal), (len)) == 0)
+
+/**
+ * ai_json_scanner_init:
+ * @self: an #AiJsonScanner
+ * @json: the JSON text
+ * @length: the length of @json, or -1 if it is nul-terminated
+ *
+ * Starts scanning @json. The text must outlive the scan.
+ */
+void
+ai_json_scanner_init(
+    AiJsonScanner *self,
+    const gchar   *json,
+    gssize         length
+);
+
+/**
+ * ai_json_scanner_enter_object:
+ * @self: an #AiJsonScanner
+ *
+ * Consumes the opening brace of an object. Its members are then read
+ * with ai_json_scanner_next_member().
+ *
+ * Returns: %TRUE if the next value is an object
+ */
+gboolean
+ai_json_scanner_enter_object(AiJsonScanner *self);
+
+/**
+ * ai_json_scanner_next_member:
+ * @self: an #AiJsonScanner
+ * @name: (out) (transfer none): return location for the member name
+ * @name_len: (out): return location for its length
+ *
+ * Reads the name of the next member of the current object, up to and
+ * including the colon; the caller must then read or skip its value.
+ * @name points into the JSON text and is not nul-terminated. Names that
+ * contain escapes are not supported and fail the scan.
+ *
+ * Returns: %TRUE if there is a member, %FALSE at the end of the object
+ *   or on failure
+ */
+gboolean
+ai_json_scanner_next_member(
+    AiJsonScanner  *self,
+    const gchar   **name,
+    gsize          *name_len
+);
+
+/**
+ * ai_json_scanner_enter_array:
+ * @self: an #AiJsonScanner
+ *
+ * Consumes the opening bracket of an array. Its elements are then
+ * visited with ai_json_scanner_next_element().
+ *
+ * Returns: %TRUE if the next value is an array
+ */
+gboolean
+ai_json_scanner_enter_array(AiJsonScanner *self);
+
+/**
+ * ai_json_scanner_next_element:
+ * @self: an #AiJsonScanner
+ *
+ * Moves to the next element of the current array; the caller must then
+ * read or skip it.
+ *
+ * Returns: %TRUE if there is an element, %FALSE at the end of the array
+ *   or on failure
+ */
+gboolean
+ai_json_scanner_next_element(AiJsonScanner *self);
+
+/**
+ * ai_json_scanner_read_string:
+ * @self: an #AiJsonScanner
+ * @out: (nullable): the #GString to append the unescaped string to
+ *
+ * Reads a string value and appends it to @out, with all escapes,
+ * including UTF-16 surrogate pairs, decoded. Strings with unescaped
+ * control characters, lone surrogates or invalid UTF-8 fail the scan,
+ * and leave @out as it was.
+ *
+ * Returns: %TRUE if a valid string was read
+ */
+gboolean
+ai_json_scanner_read_string(
+    AiJsonScanner *self,
+    GString       *out
+);
+
+/**
+ * ai_json_scanner_read_plain_string:
+ * @self: an #AiJsonScanner
+ * @value: (out) (transfer none): return location for the string
+ * @length: (out): return location for its length
+ *
+ * Reads a string value as a slice of the JSON text, which is not
+ * nul-terminated. This suits enumerated values such as a type; strings
+ * that contain escapes fail the scan.
+ *
+ * Returns: %TRUE if a string without escapes was read
+ */
+gboolean
+ai_json_scanner_read_plain_string(
+    AiJsonScanner  *self,
+    const gchar   **value,
+    gsize          *length
+);
+
+/**
+ * ai_json_scanner_read_null:
+ * @self: an #AiJsonScanner
+ *
+ * Consumes a null value if there is one. Any other value is left in
+ * place and does not fail the scan.
+ *
+ * Returns: %TRUE if the value was null
+ */
+gboolean
+ai_json_scanner_read_null(AiJsonScanner *self);
+
+/**
+ * ai_json_scanner_read_boolean:
+ * @self: an #AiJsonScanner
+ * @value: (out): return location for the value
+ *
+ * Reads a boolean value.
+ *
+ * Returns: %TRUE if the value was a boolean
+ */
+gboolean
+ai_json_scanner_read_boolean(
+    AiJsonScanner *self,
+    gboolean      *value
+);
+
+/**
+ * ai_json_scanner_skip_value:
+ * @self: an #AiJsonScanner
+ *
+ * Skips the next value of any type. Inside a skipped object or array,
+ * only strings and the depth of brackets are checked.
+ *
+ * Returns: %TRUE if a value was skipped
+ */
+gboolean
+ai_json_scanner_skip_value(AiJsonScanner *self);
+
+/**
+ * ai_json_scanner_at_end:
+ * @self: an #AiJsonScanner
+ *
+ * Checks that the whole text was scanned without a failure, with
+ * nothing but whitespace left over.
+ *
+ * Returns: %TRUE if the scan succeeded
+ */
+gboolean
+ai_json_scanner_at_end(AiJsonScanner *self);
+
+G_END_DECLS
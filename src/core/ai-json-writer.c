@@ -0,0 +1,582 @@
+/*
+ * ai-json-writer.c - Direct JSON serializer
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "core/ai-json-writer.h"
+
+#define AI_JSON_WRITER_DEFAULT_SIZE (4096)
+
+struct _AiJsonWriter
+{
+    GString  *buffer;
+
+    /*
+     * Separator state: a comma is needed before the next value or member
+     * name unless we just opened a container or just wrote a member name.
+     */
+    gboolean  needs_comma;
+};
+
+/*
+ * Word-at-a-time scanning. A byte needs escaping when it is below 0x20,
+ * a double quote or a backslash; everything else (including UTF-8
+ * continuation bytes) is copied as is.
+ */
+#define ONES   (G_GUINT64_CONSTANT(0x0101010101010101))
+#define HIGHS  (G_GUINT64_CONSTANT(0x8080808080808080))
+
+static inline guint64
+has_zero_byte(guint64 v)
+{
+    return (v - ONES) & ~v & HIGHS;
+}
+
+static inline gboolean
+word_needs_escape(guint64 v)
+{
+    guint64 below_space;
+
+    /* High bit set only for bytes < 0x20 (bytes >= 0x80 are masked off) */
+    below_space = (v - ONES * 0x20) & ~v & HIGHS;
+
+    return (below_space
+            | has_zero_byte(v ^ (ONES * '"'))
+            | has_zero_byte(v ^ (ONES * '\\'))) != 0;
+}
+
+/**
+ * ai_json_escape_string:
+ * @buffer: the #GString to append to
+ * @value: a UTF-8 string
+ * @length: the length of @value in bytes
+ *
+ * Appends @value to @buffer as a quoted JSON string. Runs of characters
+ * that need no escaping are found a machine word at a time and copied
+ * in bulk, which keeps large text blocks cheap to serialize.
+ */
+void
+ai_json_escape_string(
+    GString     *buffer,
+    const gchar *value,
+    gsize        length
+){
+    const guchar *p = (const guchar *)value;
+    const guchar *end = p + length;
+    const guchar *run = p;
+
+    g_return_if_fail(buffer != NULL);
+    g_return_if_fail(value != NULL || length == 0);
+
+    /* Worst case is every byte as \u00XX; reserve for the common case */
+    if (buffer->allocated_len < buffer->len + length + 3)
+    {
+        gsize len = buffer->len;
+
+        g_string_set_size(buffer, len + length + 3);
+        g_string_truncate(buffer, len);
+    }
+
+    g_string_append_c(buffer, '"');
+
+    while (p < end)
+    {
+        guint64 word;
+
+        /* Skip clean words */
+        while (end - p >= 8)
+        {
+            memcpy(&word, p, sizeof word);
+            if (word_needs_escape(word))
+            {
+                break;
+            }
+            p += 8;
+        }
+
+        /* Find the exact byte in the dirty word (or the tail) */
+        while (p < end && *p >= 0x20 && *p != '"' && *p != '\\')
+        {
+            p++;
+        }
+
+        if (p >= end)
+        {
+            break;
+        }
+
+        if (p > run)
+        {
+            g_string_append_len(buffer, (const gchar *)run, p - run);
+        }
+
+        switch (*p)
+        {
+            case '"':
+                g_string_append_len(buffer, "\\\"", 2);
+                break;
+            case '\\':
+                g_string_append_len(buffer, "\\\\", 2);
+                break;
+            case '\n':
+                g_string_append_len(buffer, "\\n", 2);
+                break;
+            case '\r':
+                g_string_append_len(buffer, "\\r", 2);
+                break;
+            case '\t':
+                g_string_append_len(buffer, "\\t", 2);
+                break;
+            case '\b':
+                g_string_append_len(buffer, "\\b", 2);
+                break;
+            case '\f':
+                g_string_append_len(buffer, "\\f", 2);
+                break;
+            default:
+                g_string_append_printf(buffer, "\\u%04x", *p);
+                break;
+        }
+
+        p++;
+        run = p;
+    }
+
+    if (end > run)
+    {
+        g_string_append_len(buffer, (const gchar *)run, end - run);
+    }
+
+    g_string_append_c(buffer, '"');
+}
+
+static inline void
+begin_value(AiJsonWriter *self)
+{
+    if (self->needs_comma)
+    {
+        g_string_append_c(self->buffer, ',');
+    }
+    self->needs_comma = TRUE;
+}
+
+/**
+ * ai_json_writer_new:
+ * @reserved_size: the initial buffer size in bytes, or 0 for a default
+ *
+ * Creates a new #AiJsonWriter.
+ *
+ * Returns: (transfer full): a new #AiJsonWriter
+ */
+AiJsonWriter *
+ai_json_writer_new(gsize reserved_size)
+{
+    AiJsonWriter *self;
+
+    self = g_slice_new0(AiJsonWriter);
+    self->buffer = g_string_sized_new(reserved_size > 0
+                                      ? reserved_size
+                                      : AI_JSON_WRITER_DEFAULT_SIZE);
+
+    return self;
+}
+
+/**
+ * ai_json_writer_free:
+ * @self: (nullable): an #AiJsonWriter
+ *
+ * Frees the writer and any data not yet taken with
+ * ai_json_writer_free_to_bytes().
+ */
+void
+ai_json_writer_free(AiJsonWriter *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+
+    g_string_free(self->buffer, TRUE);
+    g_slice_free(AiJsonWriter, self);
+}
+
+/**
+ * ai_json_writer_free_to_bytes:
+ * @self: (transfer full): an #AiJsonWriter
+ *
+ * Frees the writer and returns the written JSON without copying it.
+ *
+ * Returns: (transfer full): the JSON document
+ */
+GBytes *
+ai_json_writer_free_to_bytes(AiJsonWriter *self)
+{
+    GBytes *bytes;
+
+    g_return_val_if_fail(self != NULL, NULL);
+
+    bytes = g_string_free_to_bytes(self->buffer);
+    g_slice_free(AiJsonWriter, self);
+
+    return bytes;
+}
+
+/**
+ * ai_json_writer_get_data:
+ * @self: an #AiJsonWriter
+ * @length: (out) (optional): return location for the length in bytes
+ *
+ * Gets the JSON written so far. The data is owned by the writer and is
+ * only valid until the next write.
+ *
+ * Returns: (transfer none): the JSON text, nul-terminated
+ */
+const gchar *
+ai_json_writer_get_data(
+    AiJsonWriter *self,
+    gsize        *length
+){
+    g_return_val_if_fail(self != NULL, NULL);
+
+    if (length != NULL)
+    {
+        *length = self->buffer->len;
+    }
+
+    return self->buffer->str;
+}
+
+/**
+ * ai_json_writer_begin_object:
+ * @self: an #AiJsonWriter
+ *
+ * Opens a JSON object.
+ */
+void
+ai_json_writer_begin_object(AiJsonWriter *self)
+{
+    g_return_if_fail(self != NULL);
+
+    begin_value(self);
+    g_string_append_c(self->buffer, '{');
+    self->needs_comma = FALSE;
+}
+
+/**
+ * ai_json_writer_end_object:
+ * @self: an #AiJsonWriter
+ *
+ * Closes the current JSON object.
+ */
+void
+ai_json_writer_end_object(AiJsonWriter *self)
+{
+    g_return_if_fail(self != NULL);
+
+    g_string_append_c(self->buffer, '}');
+    self->needs_comma = TRUE;
+}
+
+/**
+ * ai_json_writer_begin_array:
+ * @self: an #AiJsonWriter
+ *
+ * Opens a JSON array.
+ */
+void
+ai_json_writer_begin_array(AiJsonWriter *self)
+{
+    g_return_if_fail(self != NULL);
+
+    begin_value(self);
+    g_string_append_c(self->buffer, '[');
+    self->needs_comma = FALSE;
+}
+
+/**
+ * ai_json_writer_end_array:
+ * @self: an #AiJsonWriter
+ *
+ * Closes the current JSON array.
+ */
+void
+ai_json_writer_end_array(AiJsonWriter *self)
+{
+    g_return_if_fail(self != NULL);
+
+    g_string_append_c(self->buffer, ']');
+    self->needs_comma = TRUE;
+}
+
+/**
+ * ai_json_writer_set_member_name:
+ * @self: an #AiJsonWriter
+ * @name: the member name
+ *
+ * Writes the name of the next object member.
+ */
+void
+ai_json_writer_set_member_name(
+    AiJsonWriter *self,
+    const gchar  *name
+){
+    g_return_if_fail(self != NULL);
+    g_return_if_fail(name != NULL);
+
+    begin_value(self);
+    ai_json_escape_string(self->buffer, name, strlen(name));
+    g_string_append_c(self->buffer, ':');
+
+    /* The value that follows takes no separator */
+    self->needs_comma = FALSE;
+}
+
+/**
+ * ai_json_writer_add_string_value:
+ * @self: an #AiJsonWriter
+ * @value: (nullable): a UTF-8 string, or %NULL for JSON null
+ *
+ * Writes a string value, escaping it as needed.
+ */
+void
+ai_json_writer_add_string_value(
+    AiJsonWriter *self,
+    const gchar  *value
+){
+    g_return_if_fail(self != NULL);
+
+    if (value == NULL)
+    {
+        ai_json_writer_add_null_value(self);
+        return;
+    }
+
+    begin_value(self);
+    ai_json_escape_string(self->buffer, value, strlen(value));
+}
+
+/**
+ * ai_json_writer_add_string_value_len:
+ * @self: an #AiJsonWriter
+ * @value: a UTF-8 string
+ * @length: the length of @value in bytes, or -1 if nul-terminated
+ *
+ * Writes a string value of known length, escaping it as needed.
+ */
+void
+ai_json_writer_add_string_value_len(
+    AiJsonWriter *self,
+    const gchar  *value,
+    gssize        length
+){
+    g_return_if_fail(self != NULL);
+    g_return_if_fail(value != NULL || length == 0);
+
+    if (length < 0)
+    {
+        length = strlen(value);
+    }
+
+    begin_value(self);
+    ai_json_escape_string(self->buffer, value, length);
+}
+
+/**
+ * ai_json_writer_add_int_value:
+ * @self: an #AiJsonWriter
+ * @value: the value
+ *
+ * Writes an integer value.
+ */
+void
+ai_json_writer_add_int_value(
+    AiJsonWriter *self,
+    gint64        value
+){
+    g_return_if_fail(self != NULL);
+
+    begin_value(self);
+    g_string_append_printf(self->buffer, "%" G_GINT64_FORMAT, value);
+}
+
+/**
+ * ai_json_writer_add_double_value:
+ * @self: an #AiJsonWriter
+ * @value: the value
+ *
+ * Writes a floating point value, in the same format as #JsonGenerator.
+ */
+void
+ai_json_writer_add_double_value(
+    AiJsonWriter *self,
+    gdouble       value
+){
+    gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+
+    g_return_if_fail(self != NULL);
+
+    begin_value(self);
+    g_ascii_dtostr(buf, sizeof buf, value);
+    g_string_append(self->buffer, buf);
+
+    /* Keep the value a double when read back, like JsonGenerator does */
+    if (strpbrk(buf, ".eEni") == NULL)
+    {
+        g_string_append_len(self->buffer, ".0", 2);
+    }
+}
+
+/**
+ * ai_json_writer_add_boolean_value:
+ * @self: an #AiJsonWriter
+ * @value: the value
+ *
+ * Writes a boolean value.
+ */
+void
+ai_json_writer_add_boolean_value(
+    AiJsonWriter *self,
+    gboolean      value
+){
+    g_return_if_fail(self != NULL);
+
+    begin_value(self);
+    if (value)
+    {
+        g_string_append_len(self->buffer, "true", 4);
+    }
+    else
+    {
+        g_string_append_len(self->buffer, "false", 5);
+    }
+}
+
+/**
+ * ai_json_writer_add_null_value:
+ * @self: an #AiJsonWriter
+ *
+ * Writes a null value.
+ */
+void
+ai_json_writer_add_null_value(AiJsonWriter *self)
+{
+    g_return_if_fail(self != NULL);
+
+    begin_value(self);
+    g_string_append_len(self->buffer, "null", 4);
+}
+
+static void
+write_object_member(
+    JsonObject  *object,
+    const gchar *member_name,
+    JsonNode    *member_node,
+    gpointer     user_data
+){
+    AiJsonWriter *self = user_data;
+
+    ai_json_writer_set_member_name(self, member_name);
+    ai_json_writer_add_node(self, member_node);
+}
+
+static void
+write_array_element(
+    JsonArray *array,
+    guint      index_,
+    JsonNode  *element_node,
+    gpointer   user_data
+){
+    ai_json_writer_add_node((AiJsonWriter *)user_data, element_node);
+}
+
+/**
+ * ai_json_writer_add_node:
+ * @self: an #AiJsonWriter
+ * @node: (nullable): a #JsonNode, or %NULL for JSON null
+ *
+ * Writes an existing #JsonNode tree as a value.
+ */
+void
+ai_json_writer_add_node(
+    AiJsonWriter *self,
+    JsonNode     *node
+){
+    g_return_if_fail(self != NULL);
+
+    if (node == NULL || JSON_NODE_HOLDS_NULL(node))
+    {
+        ai_json_writer_add_null_value(self);
+        return;
+    }
+
+    switch (json_node_get_node_type(node))
+    {
+        case JSON_NODE_OBJECT:
+            ai_json_writer_begin_object(self);
+            json_object_foreach_member(json_node_get_object(node),
+                                       write_object_member, self);
+            ai_json_writer_end_object(self);
+            break;
+
+        case JSON_NODE_ARRAY:
+            ai_json_writer_begin_array(self);
+            json_array_foreach_element(json_node_get_array(node),
+                                       write_array_element, self);
+            ai_json_writer_end_array(self);
+            break;
+
+        case JSON_NODE_VALUE:
+            switch (json_node_get_value_type(node))
+            {
+                case G_TYPE_STRING:
+                    ai_json_writer_add_string_value(self, json_node_get_string(node));
+                    break;
+                case G_TYPE_BOOLEAN:
+                    ai_json_writer_add_boolean_value(self, json_node_get_boolean(node));
+                    break;
+                case G_TYPE_DOUBLE:
+                case G_TYPE_FLOAT:
+                    ai_json_writer_add_double_value(self, json_node_get_double(node));
+                    break;
+                default:
+                    ai_json_writer_add_int_value(self, json_node_get_int(node));
+                    break;
+            }
+            break;
+
+        case JSON_NODE_NULL:
+        default:
+            ai_json_writer_add_null_value(self);
+            break;
+    }
+}
+
+/**
+ * ai_json_writer_add_raw_value:
+ * @self: an #AiJsonWriter
+ * @json: an already serialized JSON value
+ * @length: the length of @json in bytes, or -1 if nul-terminated
+ *
+ * Writes a pre-serialized JSON value verbatim. The caller is
+ * responsible for @json being valid JSON.
+ */
+void
+ai_json_writer_add_raw_value(
+    AiJsonWriter *self,
+    const gchar  *json,
+    gssize        length
+){
+    g_return_if_fail(self != NULL);
+    g_return_if_fail(json != NULL);
+
+    begin_value(self);
+    g_string_append_len(self->buffer, json, length);
+}
@@ -0,0 +1,255 @@
+/*
+ * ai-json-writer.h - Direct JSON serializer
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * Writes JSON straight into a growable buffer, without building a
+ * JsonNode tree first. The buffer is handed over as #GBytes without a
+ * copy, ready for soup_message_set_request_body_from_bytes().
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib.h>
+#include <json-glib/json-glib.h>
+
+G_BEGIN_DECLS
+
+/**
+ * AiJsonWriter:
+ *
+ * An opaque JSON writer. The API mirrors #JsonBuilder: containers are
+ * opened and closed explicitly, and object members are written as a
+ * name followed by a value. The writer does not validate nesting.
+ */
+typedef struct _AiJsonWriter AiJsonWriter;
+
+/**
+ * ai_json_writer_new:
+ * @reserved_size: the initial buffer size in bytes, or 0 for a default
+ *
+ * Creates a new #AiJsonWriter.
+ *
+ * Returns: (transfer full): a new #AiJsonWriter
+ */
+AiJsonWriter *
+ai_json_writer_new(gsize reserved_size);
+
+/**
+ * ai_json_writer_free:
+ * @self: (nullable): an #AiJsonWriter
+ *
+ * Frees the writer and any data not yet taken with
+ * ai_json_writer_free_to_bytes().
+ */
+void
+ai_json_writer_free(AiJsonWriter *self);
+
+/**
+ * ai_json_writer_free_to_bytes:
+ * @self: (transfer full): an #AiJsonWriter
+ *
+ * Frees the writer and returns the written JSON without copying it.
+ *
+ * Returns: (transfer full): the JSON document
+ */
+GBytes *
+ai_json_writer_free_to_bytes(AiJsonWriter *self);
+
+/**
+ * ai_json_writer_get_data:
+ * @self: an #AiJsonWriter
+ * @length: (out) (optional): return location for the length in bytes
+ *
+ * Gets the JSON written so far. The data is owned by the writer and is
+ * only valid until the next write.
+ *
+ * Returns: (transfer none): the JSON text, nul-terminated
+ */
+const gchar *
+ai_json_writer_get_data(
+    AiJsonWriter *self,
+    gsize        *length
+);
+
+/**
+ * ai_json_writer_begin_object:
+ * @self: an #AiJsonWriter
+ *
+ * Opens a JSON object.
+ */
+void
+ai_json_writer_begin_object(AiJsonWriter *self);
+
+/**
+ * ai_json_writer_end_object:
+ * @self: an #AiJsonWriter
+ *
+ * Closes the current JSON object.
+ */
+void
+ai_json_writer_end_object(AiJsonWriter *self);
+
+/**
+ * ai_json_writer_begin_array:
+ * @self: an #AiJsonWriter
+ *
+ * Opens a JSON array.
+ */
+void
+ai_json_writer_begin_array(AiJsonWriter *self);
+
+/**
+ * ai_json_writer_end_array:
+ * @self: an #AiJsonWriter
+ *
+ * Closes the current JSON array.
+ */
+void
+ai_json_writer_end_array(AiJsonWriter *self);
+
+/**
+ * ai_json_writer_set_member_name:
+ * @self: an #AiJsonWriter
+ * @name: the member name
+ *
+ * Writes the name of the next object member.
+ */
+void
+ai_json_writer_set_member_name(
+    AiJsonWriter *self,
+    const gchar  *name
+);
+
+/**
+ * ai_json_writer_add_string_value:
+ * @self: an #AiJsonWriter
+ * @value: (nullable): a UTF-8 string, or %NULL for JSON null
+ *
+ * Writes a string value, escaping it as needed.
+ */
+void
+ai_json_writer_add_string_value(
+    AiJsonWriter *self,
+    const gchar  *value
+);
+
+/**
+ * ai_json_writer_add_string_value_len:
+ * @self: an #AiJsonWriter
+ * @value: a UTF-8 string
+ * @length: the length of @value in bytes, or -1 if nul-terminated
+ *
+ * Writes a string value of known length, escaping it as needed.
+ */
+void
+ai_json_writer_add_string_value_len(
+    AiJsonWriter *self,
+    const gchar  *value,
+    gssize        length
+);
+
+/**
+ * ai_json_writer_add_int_value:
+ * @self: an #AiJsonWriter
+ * @value: the value
+ *
+ * Writes an integer value.
+ */
+void
+ai_json_writer_add_int_value(
+    AiJsonWriter *self,
+    gint64        value
+);
+
+/**
+ * ai_json_writer_add_double_value:
+ * @self: an #AiJsonWriter
+ * @value: the value
+ *
+ * Writes a floating point value, in the same format as #JsonGenerator.
+ */
+void
+ai_json_writer_add_double_value(
+    AiJsonWriter *self,
+    gdouble       value
+);
+
+/**
+ * ai_json_writer_add_boolean_value:
+ * @self: an #AiJsonWriter
+ * @value: the value
+ *
+ * Writes a boolean value.
+ */
+void
+ai_json_writer_add_boolean_value(
+    AiJsonWriter *self,
+    gboolean      value
+);
+
+/**
+ * ai_json_writer_add_null_value:
+ * @self: an #AiJsonWriter
+ *
+ * Writes a null value.
+ */
+void
+ai_json_writer_add_null_value(AiJsonWriter *self);
+
+/**
+ * ai_json_writer_add_node:
+ * @self: an #AiJsonWriter
+ * @node: (nullable): a #JsonNode, or %NULL for JSON null
+ *
+ * Writes an existing #JsonNode tree as a value.
+ */
+void
+ai_json_writer_add_node(
+    AiJsonWriter *self,
+    JsonNode     *node
+);
+
+/**
+ * ai_json_writer_add_raw_value:
+ * @self: an #AiJsonWriter
+ * @json: an already serialized JSON value
+ * @length: the length of @json in bytes, or -1 if nul-terminated
+ *
+ * Writes a pre-serialized JSON value verbatim. The caller is
+ * responsible for @json being valid JSON.
+ */
+void
+ai_json_writer_add_raw_value(
+    AiJsonWriter *self,
+    const gchar  *json,
+    gssize        length
+);
+
+/**
+ * ai_json_escape_string:
+ * @buffer: the #GString to append to
+ * @value: a UTF-8 string
+ * @length: the length of @value in bytes
+ *
+ * Appends @value to @buffer as a quoted JSON string. Runs of characters
+ * that need no escaping are found a machine word at a time and copied
+ * in bulk, which keeps large text blocks cheap to serialize.
+ */
+void
+ai_json_escape_string(
+    GString     *buffer,
+    const gchar *value,
+    gsize        length
+);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(AiJsonWriter, ai_json_writer_free)
+
+G_END_DECLS
@@ -633,6 +633,13 @@ calibrate_confidence(gdouble distance, gdouble steepness)
     return 1.0 / (1.0 + exp(-steepness * distance));
 }
 
+/* Rough token estimate: ~4 chars per token */
+guint
+ai_prompt_estimate_tokens(gsize len)
+{
+    return (guint)MIN(len / 4, G_MAXUINT);
+}
+
 /* ================================================================== */
 /* Main classify function                                              */
 /* ================================================================== */
@@ -679,10 +686,9 @@ ai_prompt_scorer_classify(const gchar          *prompt,
     }
     text = combined;
 
-    /* Rough token estimate: ~4 chars per token */
-    estimated_tokens = (guint)(strlen(prompt) / 4);
+    estimated_tokens = ai_prompt_estimate_tokens(strlen(prompt));
     if (system_prompt != NULL)
-        estimated_tokens += (guint)(strlen(system_prompt) / 4);
+        estimated_tokens += ai_prompt_estimate_tokens(strlen(system_prompt));
 
     /* Score all 14 dimensions */
     dims[ndims++] = score_token_count(estimated_tokens);
@@ -159,4 +159,17 @@ ai_prompt_scorer_classify(const gchar          *prompt,
                           const gchar          *system_prompt,
                           const AiScorerConfig *config);
 
+/**
+ * ai_prompt_estimate_tokens:
+ * @len: the text length in bytes
+ *
+ * Rough token estimate for @len bytes of text, at ~4 chars per token.
+ * This is the estimate behind ai_scoring_result_get_estimated_tokens(),
+ * cheap enough to run on every request (e.g. for rate limiting).
+ *
+ * Returns: the estimated token count
+ */
+guint
+ai_prompt_estimate_tokens(gsize len);
+
 G_END_DECLS
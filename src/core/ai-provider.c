@@ -10,6 +10,7 @@
 #include "config.h"
 
 #include "core/ai-provider.h"
+#include "core/ai-deadline.h"
 
 G_DEFINE_INTERFACE(AiProvider, ai_provider, G_TYPE_OBJECT)
 
@@ -119,6 +120,111 @@ ai_provider_chat_async(
                       cancellable, callback, user_data);
 }
 
+static void
+start_chat(
+    AiProvider             *self,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
+){
+    AiProviderInterface *iface = AI_PROVIDER_GET_IFACE(self);
+
+    if (iface->chat_with_options_async != NULL)
+    {
+        iface->chat_with_options_async(self, messages, options,
+                                       cancellable, callback, user_data);
+        return;
+    }
+
+    g_return_if_fail(iface->chat_async != NULL);
+
+    iface->chat_async(self, messages,
+                      options != NULL ? ai_request_options_get_system_prompt(options) : NULL,
+                      options != NULL ? ai_request_options_get_max_tokens(options) : 0,
+                      options != NULL ? ai_request_options_get_tools(options) : NULL,
+                      cancellable, callback, user_data);
+}
+
+static void
+on_deadline_chat_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    AiDeadline *deadline = g_task_get_task_data(task);
+    GError *error = NULL;
+    AiResponse *response;
+
+    response = AI_PROVIDER_GET_IFACE(source)->chat_finish(AI_PROVIDER(source), result, &error);
+    if (response == NULL)
+    {
+        ai_deadline_translate_error(deadline, &error);
+        g_task_return_error(task, error);
+    }
+    else
+    {
+        g_task_return_pointer(task, response, g_object_unref);
+    }
+
+    g_object_unref(task);
+}
+
+/**
+ * ai_provider_chat_with_options_async:
+ * @self: an #AiProvider
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the #AiRequestOptions
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): callback to call when done
+ * @user_data: user data for the callback
+ *
+ * Starts an asynchronous chat completion request with @options.
+ * Call ai_provider_chat_finish() from the callback to get the result.
+ *
+ * When @options has a deadline, the provider runs under an #AiDeadline
+ * and the request fails with %AI_ERROR_TIMEOUT once it passes.
+ */
+void
+ai_provider_chat_with_options_async(
+    AiProvider             *self,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
+){
+    AiDeadline *deadline;
+    GError *error = NULL;
+    GTask *task;
+
+    g_return_if_fail(AI_IS_PROVIDER(self));
+
+    if (options == NULL || ai_request_options_get_deadline(options) == 0)
+    {
+        start_chat(self, messages, options, cancellable, callback, user_data);
+        return;
+    }
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_provider_chat_with_options_async);
+
+    deadline = ai_deadline_new(ai_request_options_get_deadline(options), cancellable);
+    g_task_set_task_data(task, deadline, (GDestroyNotify)ai_deadline_free);
+
+    if (!ai_deadline_check(deadline, &error))
+    {
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    start_chat(self, messages, options, ai_deadline_get_cancellable(deadline),
+               on_deadline_chat_done, task);
+}
+
 /**
  * ai_provider_chat_finish:
  * @self: an #AiProvider
@@ -140,6 +246,11 @@ ai_provider_chat_finish(
 
     g_return_val_if_fail(AI_IS_PROVIDER(self), NULL);
 
+    if (g_async_result_is_tagged(result, ai_provider_chat_with_options_async))
+    {
+        return g_task_propagate_pointer(G_TASK(result), error);
+    }
+
     iface = AI_PROVIDER_GET_IFACE(self);
     g_return_val_if_fail(iface->chat_finish != NULL, NULL);
 
@@ -18,6 +18,7 @@
 
 #include "core/ai-enums.h"
 #include "model/ai-message.h"
+#include "model/ai-request-options.h"
 #include "model/ai-response.h"
 #include "model/ai-tool.h"
 
@@ -37,6 +38,8 @@ G_DECLARE_INTERFACE(AiProvider, ai_provider, AI, PROVIDER, GObject)
  * @chat_finish: finishes an async chat completion
  * @list_models_async: starts listing available models
  * @list_models_finish: finishes listing available models
+ * @chat_with_options_async: starts an async chat completion with
+ *   #AiRequestOptions; finished with @chat_finish
  * @_reserved: reserved for future expansion
  *
  * Interface for AI providers.
@@ -70,8 +73,15 @@ struct _AiProviderInterface
                                          GAsyncResult        *result,
                                          GError             **error);
 
+    void           (*chat_with_options_async)(AiProvider             *self,
+                                              GList                  *messages,
+                                              const AiRequestOptions *options,
+                                              GCancellable           *cancellable,
+                                              GAsyncReadyCallback     callback,
+                                              gpointer                user_data);
+
     /* Reserved for future expansion */
-    gpointer _reserved[8];
+    gpointer _reserved[7];
 };
 
 /**
@@ -132,6 +142,38 @@ ai_provider_chat_async(
     gpointer             user_data
 );
 
+/**
+ * ai_provider_chat_with_options_async:
+ * @self: an #AiProvider
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the #AiRequestOptions
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): callback to call when done
+ * @user_data: user data for the callback
+ *
+ * Starts an asynchronous chat completion request with @options, without
+ * changing the provider, so concurrent requests can use different
+ * settings. Settings @options leaves unset come from the provider.
+ * Finish it with ai_provider_chat_finish().
+ *
+ * Providers that do not implement this only get the system prompt,
+ * token limit and tools of @options.
+ *
+ * The deadline of @options holds for every provider: the request runs
+ * under an #AiDeadline, which cancels it, retries and subprocesses
+ * included, when the deadline passes. The request then fails with
+ * %AI_ERROR_TIMEOUT.
+ */
+void
+ai_provider_chat_with_options_async(
+    AiProvider             *self,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
+);
+
 /**
  * ai_provider_chat_finish:
  * @self: an #AiProvider
@@ -0,0 +1,826 @@
+/*
+ * ai-rate-limiter.c - Client-side rate limiting
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "core/ai-rate-limiter.h"
+#include "core/ai-retry.h"
+
+#define USEC_PER_MINUTE (60.0 * G_USEC_PER_SEC)
+
+/*
+ * The limits tracked per account. TOKENS is the combined input plus
+ * output limit that OpenAI (and older Anthropic tiers) report.
+ */
+typedef enum
+{
+    BUCKET_REQUESTS,
+    BUCKET_INPUT_TOKENS,
+    BUCKET_OUTPUT_TOKENS,
+    BUCKET_TOKENS,
+    N_BUCKETS
+} BucketKind;
+
+/*
+ * Response headers for each bucket, Anthropic style then OpenAI style.
+ * A NULL name means the provider does not report that limit.
+ */
+static const struct {
+    const gchar *limit;
+    const gchar *remaining;
+    const gchar *reset;
+} bucket_headers[N_BUCKETS][2] = {
+    [BUCKET_REQUESTS] = {
+        { "anthropic-ratelimit-requests-limit",
+          "anthropic-ratelimit-requests-remaining",
+          "anthropic-ratelimit-requests-reset" },
+        { "x-ratelimit-limit-requests",
+          "x-ratelimit-remaining-requests",
+          "x-ratelimit-reset-requests" },
+    },
+    [BUCKET_INPUT_TOKENS] = {
+        { "anthropic-ratelimit-input-tokens-limit",
+          "anthropic-ratelimit-input-tokens-remaining",
+          "anthropic-ratelimit-input-tokens-reset" },
+        { NULL, NULL, NULL },
+    },
+    [BUCKET_OUTPUT_TOKENS] = {
+        { "anthropic-ratelimit-output-tokens-limit",
+          "anthropic-ratelimit-output-tokens-remaining",
+          "anthropic-ratelimit-output-tokens-reset" },
+        { NULL, NULL, NULL },
+    },
+    [BUCKET_TOKENS] = {
+        { "anthropic-ratelimit-tokens-limit",
+          "anthropic-ratelimit-tokens-remaining",
+          "anthropic-ratelimit-tokens-reset" },
+        { "x-ratelimit-limit-tokens",
+          "x-ratelimit-remaining-tokens",
+          "x-ratelimit-reset-tokens" },
+    },
+};
+
+/*
+ * A token bucket refilling continuously at limit per minute.
+ */
+typedef struct
+{
+    gdouble limit;          /* per minute, 0 for no limit */
+    gdouble level;          /* capacity available now */
+    gint64  blocked_until;  /* monotonic time the server said to wait for */
+} Bucket;
+
+/*
+ * An asynchronous request waiting for capacity. Whoever removes it
+ * from the queue, under the lock, owns it.
+ */
+typedef struct
+{
+    GTask   *task;
+    gdouble  costs[N_BUCKETS];
+    GSource *cancel_source;
+} Waiter;
+
+struct _AiRateLimiter
+{
+    GObject parent_instance;
+
+    GMutex   lock;
+    Bucket   buckets[N_BUCKETS];
+    gint64   refilled_at;
+    GQueue   waiters;           /* element-type Waiter */
+    GSource *timer;
+};
+
+G_DEFINE_TYPE(AiRateLimiter, ai_rate_limiter, G_TYPE_OBJECT)
+
+static GMutex      shared_lock;
+static GHashTable *shared = NULL;
+
+static void
+waiter_free(Waiter *waiter)
+{
+    if (waiter->cancel_source != NULL)
+    {
+        g_source_destroy(waiter->cancel_source);
+        g_source_unref(waiter->cancel_source);
+    }
+    g_clear_object(&waiter->task);
+    g_slice_free(Waiter, waiter);
+}
+
+static void
+ai_rate_limiter_finalize(GObject *object)
+{
+    AiRateLimiter *self = AI_RATE_LIMITER(object);
+
+    /* Queued waiters hold references, so the queue is empty here */
+    if (self->timer != NULL)
+    {
+        g_source_destroy(self->timer);
+        g_source_unref(self->timer);
+    }
+    g_mutex_clear(&self->lock);
+
+    G_OBJECT_CLASS(ai_rate_limiter_parent_class)->finalize(object);
+}
+
+static void
+ai_rate_limiter_class_init(AiRateLimiterClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->finalize = ai_rate_limiter_finalize;
+}
+
+static void
+ai_rate_limiter_init(AiRateLimiter *self)
+{
+    g_mutex_init(&self->lock);
+    g_queue_init(&self->waiters);
+    self->refilled_at = g_get_monotonic_time();
+}
+
+/**
+ * ai_rate_limiter_new:
+ *
+ * Creates a rate limiter with no limits.
+ *
+ * Returns: (transfer full): a new #AiRateLimiter
+ */
+AiRateLimiter *
+ai_rate_limiter_new(void)
+{
+    return g_object_new(AI_TYPE_RATE_LIMITER, NULL);
+}
+
+/**
+ * ai_rate_limiter_get_shared:
+ * @provider: the #AiProviderType
+ * @api_key: (nullable): the API key the limits belong to
+ *
+ * Gets the process-wide limiter for @provider and @api_key. Shared
+ * limiters live for the rest of the process, so what they learned
+ * from response headers carries over to clients created later.
+ *
+ * Returns: (transfer full): the shared #AiRateLimiter
+ */
+AiRateLimiter *
+ai_rate_limiter_get_shared(
+    AiProviderType  provider,
+    const gchar    *api_key
+){
+    g_autofree gchar *digest = NULL;
+    gchar *key;
+    AiRateLimiter *limiter;
+
+    digest = g_compute_checksum_for_string(G_CHECKSUM_SHA256,
+                                           api_key != NULL ? api_key : "", -1);
+    key = g_strdup_printf("%d|%s", (gint)provider, digest);
+
+    g_mutex_lock(&shared_lock);
+
+    if (shared == NULL)
+    {
+        shared = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_object_unref);
+    }
+
+    limiter = g_hash_table_lookup(shared, key);
+    if (limiter == NULL)
+    {
+        limiter = ai_rate_limiter_new();
+        g_hash_table_insert(shared, key, limiter);
+    }
+    else
+    {
+        g_free(key);
+    }
+
+    g_object_ref(limiter);
+
+    g_mutex_unlock(&shared_lock);
+
+    return limiter;
+}
+
+/*
+ * Refill every bucket for the time elapsed since the last refill.
+ */
+static void
+refill_locked(
+    AiRateLimiter *self,
+    gint64         now
+){
+    gint64 elapsed = now - self->refilled_at;
+    guint i;
+
+    if (elapsed <= 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < N_BUCKETS; i++)
+    {
+        Bucket *bucket = &self->buckets[i];
+
+        if (bucket->limit > 0)
+        {
+            bucket->level = MIN(bucket->limit,
+                                bucket->level + elapsed * bucket->limit / USEC_PER_MINUTE);
+        }
+    }
+
+    self->refilled_at = now;
+}
+
+static void
+set_costs(
+    gdouble *costs,
+    guint    input_tokens,
+    guint    output_tokens
+){
+    costs[BUCKET_REQUESTS] = 1;
+    costs[BUCKET_INPUT_TOKENS] = input_tokens;
+    costs[BUCKET_OUTPUT_TOKENS] = output_tokens;
+    costs[BUCKET_TOKENS] = (gdouble)input_tokens + output_tokens;
+}
+
+/*
+ * Add @costs to @total, clamping each to its bucket size so a request
+ * larger than a bucket only waits for the bucket to fill.
+ */
+static void
+add_costs_locked(
+    AiRateLimiter *self,
+    gdouble       *total,
+    const gdouble *costs
+){
+    guint i;
+
+    for (i = 0; i < N_BUCKETS; i++)
+    {
+        gdouble limit = self->buckets[i].limit;
+
+        total[i] += limit > 0 ? MIN(costs[i], limit) : 0;
+    }
+}
+
+/*
+ * Microseconds until @costs (already clamped) fit every bucket.
+ */
+static gint64
+wait_time_locked(
+    AiRateLimiter *self,
+    const gdouble *costs,
+    gint64         now
+){
+    gint64 wait = 0;
+    guint i;
+
+    for (i = 0; i < N_BUCKETS; i++)
+    {
+        Bucket *bucket = &self->buckets[i];
+
+        if (bucket->blocked_until > now)
+        {
+            wait = MAX(wait, bucket->blocked_until - now);
+        }
+
+        if (bucket->limit > 0 && costs[i] > bucket->level)
+        {
+            gdouble deficit = costs[i] - bucket->level;
+
+            wait = MAX(wait, (gint64)(deficit * USEC_PER_MINUTE / bucket->limit) + 1);
+        }
+    }
+
+    return wait;
+}
+
+static void
+take_locked(
+    AiRateLimiter *self,
+    const gdouble *costs
+){
+    guint i;
+
+    for (i = 0; i < N_BUCKETS; i++)
+    {
+        if (self->buckets[i].limit > 0)
+        {
+            self->buckets[i].level -= costs[i];
+        }
+    }
+}
+
+/*
+ * Total cost of the queued waiters, optionally plus one more request.
+ */
+static void
+queued_costs_locked(
+    AiRateLimiter *self,
+    gdouble       *total,
+    const gdouble *extra
+){
+    GList *l;
+
+    memset(total, 0, sizeof(gdouble) * N_BUCKETS);
+
+    for (l = self->waiters.head; l != NULL; l = l->next)
+    {
+        add_costs_locked(self, total, ((Waiter *)l->data)->costs);
+    }
+
+    if (extra != NULL)
+    {
+        add_costs_locked(self, total, extra);
+    }
+}
+
+static void dispatch(AiRateLimiter *self);
+
+static gboolean
+on_timer(gpointer user_data)
+{
+    AiRateLimiter *self = AI_RATE_LIMITER(user_data);
+
+    g_mutex_lock(&self->lock);
+    if (self->timer == g_main_current_source())
+    {
+        g_clear_pointer(&self->timer, g_source_unref);
+    }
+    g_mutex_unlock(&self->lock);
+
+    dispatch(self);
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * Admit waiters from the head of the queue while they fit, then arm
+ * the timer for the next one.
+ */
+static void
+dispatch(AiRateLimiter *self)
+{
+    GQueue ready = G_QUEUE_INIT;
+    Waiter *waiter;
+    gint64 now;
+
+    g_mutex_lock(&self->lock);
+
+    now = g_get_monotonic_time();
+    refill_locked(self, now);
+
+    while ((waiter = g_queue_peek_head(&self->waiters)) != NULL)
+    {
+        gdouble costs[N_BUCKETS] = { 0 };
+        gint64 wait;
+
+        add_costs_locked(self, costs, waiter->costs);
+        wait = wait_time_locked(self, costs, now);
+
+        if (wait > 0)
+        {
+            if (self->timer != NULL)
+            {
+                g_source_destroy(self->timer);
+                g_source_unref(self->timer);
+            }
+
+            /* The timer keeps the limiter alive until it fires */
+            self->timer = g_timeout_source_new((guint)MIN((wait + 999) / 1000, G_MAXUINT));
+            g_source_set_callback(self->timer, on_timer, g_object_ref(self), g_object_unref);
+            g_source_attach(self->timer, g_task_get_context(waiter->task));
+            break;
+        }
+
+        take_locked(self, costs);
+        g_queue_push_tail(&ready, g_queue_pop_head(&self->waiters));
+    }
+
+    if (waiter == NULL && self->timer != NULL)
+    {
+        g_source_destroy(self->timer);
+        g_clear_pointer(&self->timer, g_source_unref);
+    }
+
+    g_mutex_unlock(&self->lock);
+
+    /* Complete outside the lock: callbacks may queue the next request */
+    while ((waiter = g_queue_pop_head(&ready)) != NULL)
+    {
+        g_task_return_boolean(waiter->task, TRUE);
+        waiter_free(waiter);
+    }
+}
+
+static gint
+compare_waiter_task(
+    gconstpointer a,
+    gconstpointer b
+){
+    return ((const Waiter *)a)->task == b ? 0 : 1;
+}
+
+static gboolean
+on_waiter_cancelled(
+    GCancellable *cancellable,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    AiRateLimiter *self = g_task_get_source_object(task);
+    Waiter *waiter = NULL;
+    GList *link;
+
+    /*
+     * The waiter may already have been admitted by another thread, in
+     * which case it is not ours to touch. The source holds a reference
+     * on the task, so looking it up is safe either way.
+     */
+    g_mutex_lock(&self->lock);
+    link = g_queue_find_custom(&self->waiters, task, compare_waiter_task);
+    if (link != NULL)
+    {
+        waiter = link->data;
+        g_queue_delete_link(&self->waiters, link);
+    }
+    g_mutex_unlock(&self->lock);
+
+    if (waiter != NULL)
+    {
+        g_object_ref(self);
+        g_task_return_error_if_cancelled(waiter->task);
+        waiter_free(waiter);
+
+        /* The next waiter may have been held up behind this one */
+        dispatch(self);
+        g_object_unref(self);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * ai_rate_limiter_set_limits:
+ * @self: an #AiRateLimiter
+ * @requests_per_minute: the request limit, or 0 for none
+ * @input_tokens_per_minute: the input token limit, or 0 for none
+ * @output_tokens_per_minute: the output token limit, or 0 for none
+ *
+ * Sets the per-minute limits. A new limit starts with a full bucket;
+ * a changed one keeps its current level.
+ */
+void
+ai_rate_limiter_set_limits(
+    AiRateLimiter *self,
+    guint          requests_per_minute,
+    guint          input_tokens_per_minute,
+    guint          output_tokens_per_minute
+){
+    const guint limits[] = {
+        requests_per_minute, input_tokens_per_minute, output_tokens_per_minute
+    };
+    guint i;
+
+    g_return_if_fail(AI_IS_RATE_LIMITER(self));
+
+    g_mutex_lock(&self->lock);
+
+    refill_locked(self, g_get_monotonic_time());
+
+    for (i = 0; i < G_N_ELEMENTS(limits); i++)
+    {
+        Bucket *bucket = &self->buckets[i];
+
+        bucket->level = bucket->limit > 0 ? MIN(bucket->level, limits[i]) : limits[i];
+        bucket->limit = limits[i];
+    }
+
+    g_mutex_unlock(&self->lock);
+
+    dispatch(self);
+}
+
+/**
+ * ai_rate_limiter_get_wait_time:
+ * @self: an #AiRateLimiter
+ * @input_tokens: the estimated input tokens of a request
+ * @output_tokens: the output tokens the request may generate
+ *
+ * Gets how long a request with this cost would wait right now.
+ *
+ * Returns: the wait in milliseconds, 0 if it would be sent at once
+ */
+guint
+ai_rate_limiter_get_wait_time(
+    AiRateLimiter *self,
+    guint          input_tokens,
+    guint          output_tokens
+){
+    gdouble costs[N_BUCKETS];
+    gdouble total[N_BUCKETS];
+    gint64 now;
+    gint64 wait;
+
+    g_return_val_if_fail(AI_IS_RATE_LIMITER(self), 0);
+
+    set_costs(costs, input_tokens, output_tokens);
+
+    g_mutex_lock(&self->lock);
+
+    now = g_get_monotonic_time();
+    refill_locked(self, now);
+    queued_costs_locked(self, total, costs);
+    wait = wait_time_locked(self, total, now);
+
+    g_mutex_unlock(&self->lock);
+
+    return (guint)MIN((wait + 999) / 1000, G_MAXUINT);
+}
+
+/**
+ * ai_rate_limiter_get_queue_length:
+ * @self: an #AiRateLimiter
+ *
+ * Gets the number of asynchronous requests waiting for capacity.
+ *
+ * Returns: the queue length
+ */
+guint
+ai_rate_limiter_get_queue_length(AiRateLimiter *self)
+{
+    guint length;
+
+    g_return_val_if_fail(AI_IS_RATE_LIMITER(self), 0);
+
+    g_mutex_lock(&self->lock);
+    length = self->waiters.length;
+    g_mutex_unlock(&self->lock);
+
+    return length;
+}
+
+/**
+ * ai_rate_limiter_acquire:
+ * @self: an #AiRateLimiter
+ * @input_tokens: the estimated input tokens of the request
+ * @output_tokens: the output tokens the request may generate
+ * @cancellable: (nullable): a #GCancellable
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Blocks until the request fits the limits, then takes its cost from
+ * the buckets. Blocking callers wait behind the asynchronous queue.
+ *
+ * Returns: %TRUE once admitted, %FALSE if @cancellable was cancelled
+ */
+gboolean
+ai_rate_limiter_acquire(
+    AiRateLimiter  *self,
+    guint           input_tokens,
+    guint           output_tokens,
+    GCancellable   *cancellable,
+    GError        **error
+){
+    gdouble costs[N_BUCKETS];
+
+    g_return_val_if_fail(AI_IS_RATE_LIMITER(self), FALSE);
+
+    set_costs(costs, input_tokens, output_tokens);
+
+    for (;;)
+    {
+        gdouble total[N_BUCKETS];
+        GPollFD pollfd;
+        gint64 now;
+        gint64 wait;
+
+        if (g_cancellable_set_error_if_cancelled(cancellable, error))
+        {
+            return FALSE;
+        }
+
+        g_mutex_lock(&self->lock);
+
+        now = g_get_monotonic_time();
+        refill_locked(self, now);
+        queued_costs_locked(self, total, costs);
+        wait = wait_time_locked(self, total, now);
+
+        if (wait == 0)
+        {
+            gdouble own[N_BUCKETS] = { 0 };
+
+            add_costs_locked(self, own, costs);
+            take_locked(self, own);
+            g_mutex_unlock(&self->lock);
+            return TRUE;
+        }
+
+        g_mutex_unlock(&self->lock);
+
+        /* Sleep, waking early on cancellation */
+        if (cancellable != NULL && g_cancellable_make_pollfd(cancellable, &pollfd))
+        {
+            g_poll(&pollfd, 1, (gint)MIN((wait + 999) / 1000, G_MAXINT));
+            g_cancellable_release_fd(cancellable);
+        }
+        else
+        {
+            g_usleep((gulong)MIN(wait, G_MAXLONG));
+        }
+    }
+}
+
+/**
+ * ai_rate_limiter_acquire_async:
+ * @self: an #AiRateLimiter
+ * @input_tokens: the estimated input tokens of the request
+ * @output_tokens: the output tokens the request may generate
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call once the request is admitted
+ * @user_data: user data for @callback
+ *
+ * Queues a request and calls @callback once it fits the limits.
+ * Requests are admitted in the order they were queued; cancelling one
+ * removes it from the queue.
+ */
+void
+ai_rate_limiter_acquire_async(
+    AiRateLimiter       *self,
+    guint                input_tokens,
+    guint                output_tokens,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    Waiter *waiter;
+    GTask *task;
+
+    g_return_if_fail(AI_IS_RATE_LIMITER(self));
+    g_return_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable));
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_rate_limiter_acquire_async);
+
+    if (g_task_return_error_if_cancelled(task))
+    {
+        g_object_unref(task);
+        return;
+    }
+
+    waiter = g_slice_new0(Waiter);
+    waiter->task = task;
+    set_costs(waiter->costs, input_tokens, output_tokens);
+
+    if (cancellable != NULL)
+    {
+        waiter->cancel_source = g_cancellable_source_new(cancellable);
+        g_source_set_callback(waiter->cancel_source,
+                              (GSourceFunc)(GCallback)on_waiter_cancelled,
+                              g_object_ref(task), g_object_unref);
+        g_source_attach(waiter->cancel_source, g_task_get_context(task));
+    }
+
+    g_mutex_lock(&self->lock);
+    g_queue_push_tail(&self->waiters, waiter);
+    g_mutex_unlock(&self->lock);
+
+    dispatch(self);
+}
+
+/**
+ * ai_rate_limiter_acquire_finish:
+ * @self: an #AiRateLimiter
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes ai_rate_limiter_acquire_async().
+ *
+ * Returns: %TRUE once admitted, %FALSE if the wait was cancelled
+ */
+gboolean
+ai_rate_limiter_acquire_finish(
+    AiRateLimiter  *self,
+    GAsyncResult   *result,
+    GError        **error
+){
+    g_return_val_if_fail(AI_IS_RATE_LIMITER(self), FALSE);
+    g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+static gboolean
+parse_count(
+    const gchar *value,
+    gdouble     *out
+){
+    gchar *end = NULL;
+    gdouble count;
+
+    if (value == NULL)
+    {
+        return FALSE;
+    }
+
+    count = g_ascii_strtod(value, &end);
+    if (end == value || count < 0.0 || count != count)
+    {
+        return FALSE;
+    }
+
+    *out = count;
+    return TRUE;
+}
+
+/**
+ * ai_rate_limiter_update_from_headers:
+ * @self: an #AiRateLimiter
+ * @headers: response #SoupMessageHeaders
+ *
+ * Corrects the buckets from a response's rate-limit headers. The
+ * server's view wins over the local estimate, since it also counts
+ * requests from other processes using the same key.
+ */
+void
+ai_rate_limiter_update_from_headers(
+    AiRateLimiter      *self,
+    SoupMessageHeaders *headers
+){
+    gboolean changed = FALSE;
+    gint64 now;
+    guint i;
+    guint j;
+
+    g_return_if_fail(AI_IS_RATE_LIMITER(self));
+    g_return_if_fail(headers != NULL);
+
+    g_mutex_lock(&self->lock);
+
+    now = g_get_monotonic_time();
+    refill_locked(self, now);
+
+    for (i = 0; i < N_BUCKETS; i++)
+    {
+        Bucket *bucket = &self->buckets[i];
+
+        for (j = 0; j < G_N_ELEMENTS(bucket_headers[i]); j++)
+        {
+            gdouble limit;
+            gdouble remaining;
+            gint64 reset_ms;
+
+            if (bucket_headers[i][j].limit == NULL)
+            {
+                continue;
+            }
+
+            if (parse_count(soup_message_headers_get_one(headers, bucket_headers[i][j].limit),
+                            &limit) && limit > 0)
+            {
+                if (bucket->limit == 0)
+                {
+                    bucket->level = limit;
+                }
+                bucket->limit = limit;
+                changed = TRUE;
+            }
+
+            if (!parse_count(soup_message_headers_get_one(headers, bucket_headers[i][j].remaining),
+                             &remaining))
+            {
+                continue;
+            }
+
+            bucket->level = bucket->limit > 0 ? MIN(remaining, bucket->limit) : remaining;
+            changed = TRUE;
+
+            if (remaining < 1.0)
+            {
+                reset_ms = ai_retry_parse_reset(
+                    soup_message_headers_get_one(headers, bucket_headers[i][j].reset));
+                if (reset_ms > 0)
+                {
+                    bucket->blocked_until = MAX(bucket->blocked_until,
+                                                now + reset_ms * 1000);
+                }
+            }
+        }
+    }
+
+    g_mutex_unlock(&self->lock);
+
+    if (changed)
+    {
+        dispatch(self);
+    }
+}
@@ -0,0 +1,191 @@
+/*
+ * ai-rate-limiter.h - Client-side rate limiting
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * An AiRateLimiter keeps token buckets for the per-minute limits of
+ * one provider account: requests, input tokens and output tokens, plus
+ * the combined token limit some providers report. Requests that would
+ * exceed a limit wait in a FIFO queue until the bucket refills, instead
+ * of being sent and rejected with 429.
+ *
+ * Limits come from #AiConfig and are corrected from the rate-limit
+ * headers of every response (`anthropic-ratelimit-*`,
+ * `x-ratelimit-*`). Clients share one limiter per provider and API key.
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "core/ai-enums.h"
+
+G_BEGIN_DECLS
+
+#define AI_TYPE_RATE_LIMITER (ai_rate_limiter_get_type())
+
+G_DECLARE_FINAL_TYPE(AiRateLimiter, ai_rate_limiter, AI, RATE_LIMITER, GObject)
+
+/**
+ * ai_rate_limiter_new:
+ *
+ * Creates a rate limiter with no limits. Limits are set with
+ * ai_rate_limiter_set_limits() or learned from response headers.
+ *
+ * Returns: (transfer full): a new #AiRateLimiter
+ */
+AiRateLimiter *
+ai_rate_limiter_new(void);
+
+/**
+ * ai_rate_limiter_get_shared:
+ * @provider: the #AiProviderType
+ * @api_key: (nullable): the API key the limits belong to
+ *
+ * Gets the process-wide limiter for @provider and @api_key. Provider
+ * limits apply per account, so every client using the same key shares
+ * one limiter. The key itself is not kept, only a digest of it.
+ *
+ * Returns: (transfer full): the shared #AiRateLimiter
+ */
+AiRateLimiter *
+ai_rate_limiter_get_shared(
+    AiProviderType  provider,
+    const gchar    *api_key
+);
+
+/**
+ * ai_rate_limiter_set_limits:
+ * @self: an #AiRateLimiter
+ * @requests_per_minute: the request limit, or 0 for none
+ * @input_tokens_per_minute: the input token limit, or 0 for none
+ * @output_tokens_per_minute: the output token limit, or 0 for none
+ *
+ * Sets the per-minute limits. Limits reported by the server in later
+ * responses replace these.
+ */
+void
+ai_rate_limiter_set_limits(
+    AiRateLimiter *self,
+    guint          requests_per_minute,
+    guint          input_tokens_per_minute,
+    guint          output_tokens_per_minute
+);
+
+/**
+ * ai_rate_limiter_get_wait_time:
+ * @self: an #AiRateLimiter
+ * @input_tokens: the estimated input tokens of a request
+ * @output_tokens: the output tokens the request may generate
+ *
+ * Gets how long a request with this cost would wait right now,
+ * including the time for requests already queued ahead of it.
+ *
+ * Returns: the wait in milliseconds, 0 if it would be sent at once
+ */
+guint
+ai_rate_limiter_get_wait_time(
+    AiRateLimiter *self,
+    guint          input_tokens,
+    guint          output_tokens
+);
+
+/**
+ * ai_rate_limiter_get_queue_length:
+ * @self: an #AiRateLimiter
+ *
+ * Gets the number of asynchronous requests waiting for capacity.
+ *
+ * Returns: the queue length
+ */
+guint
+ai_rate_limiter_get_queue_length(AiRateLimiter *self);
+
+/**
+ * ai_rate_limiter_acquire:
+ * @self: an #AiRateLimiter
+ * @input_tokens: the estimated input tokens of the request
+ * @output_tokens: the output tokens the request may generate
+ * @cancellable: (nullable): a #GCancellable
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Blocks until the request fits the limits, then takes its cost from
+ * the buckets. A cost larger than a whole bucket is clamped to it, so
+ * oversized requests wait for a full bucket rather than forever.
+ *
+ * Returns: %TRUE once admitted, %FALSE if @cancellable was cancelled
+ */
+gboolean
+ai_rate_limiter_acquire(
+    AiRateLimiter  *self,
+    guint           input_tokens,
+    guint           output_tokens,
+    GCancellable   *cancellable,
+    GError        **error
+);
+
+/**
+ * ai_rate_limiter_acquire_async:
+ * @self: an #AiRateLimiter
+ * @input_tokens: the estimated input tokens of the request
+ * @output_tokens: the output tokens the request may generate
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call once the request is admitted
+ * @user_data: user data for @callback
+ *
+ * Queues a request and calls @callback once it fits the limits.
+ * Requests are admitted in the order they were queued.
+ */
+void
+ai_rate_limiter_acquire_async(
+    AiRateLimiter       *self,
+    guint                input_tokens,
+    guint                output_tokens,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+);
+
+/**
+ * ai_rate_limiter_acquire_finish:
+ * @self: an #AiRateLimiter
+ * @result: the #GAsyncResult
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Completes ai_rate_limiter_acquire_async().
+ *
+ * Returns: %TRUE once admitted, %FALSE if the wait was cancelled
+ */
+gboolean
+ai_rate_limiter_acquire_finish(
+    AiRateLimiter  *self,
+    GAsyncResult   *result,
+    GError        **error
+);
+
+/**
+ * ai_rate_limiter_update_from_headers:
+ * @self: an #AiRateLimiter
+ * @headers: response #SoupMessageHeaders
+ *
+ * Corrects the buckets from a response's rate-limit headers: `limit`
+ * headers set the bucket sizes, `remaining` headers the current
+ * levels, and an exhausted limit blocks its bucket until the matching
+ * `reset` time.
+ */
+void
+ai_rate_limiter_update_from_headers(
+    AiRateLimiter      *self,
+    SoupMessageHeaders *headers
+);
+
+G_END_DECLS
@@ -0,0 +1,1314 @@
+/*
+ * ai-response-cache.c - Content-addressed cache of provider responses
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#include "core/ai-response-cache.h"
+
+/*
+ * On-disk layout. "blobs.<generation>" holds response bodies back to
+ * back and is only ever appended to. "index" starts with INDEX_MAGIC
+ * and the generation of its blob file, followed by fixed-size records
+ * in host byte order; a later record for a key replaces an earlier
+ * one. Compaction writes the next generation and renames a new index
+ * over the old one, so the index always names the blob file its
+ * records point into. ai_response_cache_clear() empties both in place.
+ */
+#define INDEX_FILE  "index"
+#define BLOB_FILE   "blobs"
+#define INDEX_MAGIC "AIRC0002"
+#define MAGIC_LEN   (sizeof(INDEX_MAGIC) - 1)
+#define HEADER_LEN  (MAGIC_LEN + sizeof(guint64))
+#define KEY_LEN     (64)
+
+typedef struct
+{
+    gchar   key[KEY_LEN];   /* hex SHA-256, not NUL-terminated */
+    guint64 offset;
+    guint64 length;
+    gint64  expires_at;     /* real time in microseconds, 0 for never */
+} IndexRecord;
+
+G_STATIC_ASSERT(sizeof(IndexRecord) == KEY_LEN + 24);
+
+typedef struct
+{
+    gchar  *key;
+    GBytes *data;
+    gint64  expires_at;
+    GList   link;           /* in the LRU queue, most recent first */
+} MemoryEntry;
+
+typedef struct
+{
+    guint64 offset;
+    guint64 length;
+    gint64  expires_at;
+} DiskEntry;
+
+struct _AiResponseCache
+{
+    GObject parent_instance;
+
+    GMutex      lock;
+    GHashTable *memory;         /* key -> MemoryEntry */
+    GQueue      lru;
+    guint64     memory_size;
+    guint64     max_memory_size;
+
+    gchar      *directory;
+    GHashTable *disk;           /* key -> DiskEntry */
+    gint        index_fd;
+    gint        blob_fd;
+    guint64     generation;     /* of the blob file */
+    guint64     index_size;
+    guint64     blob_size;
+    guint64     max_disk_size;
+
+    guint       ttl;
+    guint64     hits;
+    guint64     misses;
+};
+
+G_DEFINE_TYPE(AiResponseCache, ai_response_cache, G_TYPE_OBJECT)
+
+enum
+{
+    PROP_0,
+    PROP_DIRECTORY,
+    PROP_MAX_MEMORY_SIZE,
+    PROP_MAX_DISK_SIZE,
+    PROP_TTL,
+    N_PROPS
+};
+
+static GParamSpec *properties[N_PROPS];
+
+static void
+memory_entry_free(MemoryEntry *entry)
+{
+    g_free(entry->key);
+    g_bytes_unref(entry->data);
+    g_slice_free(MemoryEntry, entry);
+}
+
+static void
+disk_entry_free(DiskEntry *entry)
+{
+    g_slice_free(DiskEntry, entry);
+}
+
+static void
+close_disk(AiResponseCache *self)
+{
+    if (self->index_fd >= 0)
+    {
+        close(self->index_fd);
+        self->index_fd = -1;
+    }
+    if (self->blob_fd >= 0)
+    {
+        close(self->blob_fd);
+        self->blob_fd = -1;
+    }
+}
+
+static void
+ai_response_cache_finalize(GObject *object)
+{
+    AiResponseCache *self = AI_RESPONSE_CACHE(object);
+
+    close_disk(self);
+    g_clear_pointer(&self->memory, g_hash_table_unref);
+    g_clear_pointer(&self->disk, g_hash_table_unref);
+    g_clear_pointer(&self->directory, g_free);
+    g_mutex_clear(&self->lock);
+
+    G_OBJECT_CLASS(ai_response_cache_parent_class)->finalize(object);
+}
+
+static void
+ai_response_cache_get_property(
+    GObject    *object,
+    guint       prop_id,
+    GValue     *value,
+    GParamSpec *pspec
+){
+    AiResponseCache *self = AI_RESPONSE_CACHE(object);
+
+    switch (prop_id)
+    {
+        case PROP_DIRECTORY:
+            g_value_set_string(value, self->directory);
+            break;
+        case PROP_MAX_MEMORY_SIZE:
+            g_value_set_uint64(value, ai_response_cache_get_max_memory_size(self));
+            break;
+        case PROP_MAX_DISK_SIZE:
+            g_value_set_uint64(value, ai_response_cache_get_max_disk_size(self));
+            break;
+        case PROP_TTL:
+            g_value_set_uint(value, ai_response_cache_get_ttl(self));
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+static void
+ai_response_cache_set_property(
+    GObject      *object,
+    guint         prop_id,
+    const GValue *value,
+    GParamSpec   *pspec
+){
+    AiResponseCache *self = AI_RESPONSE_CACHE(object);
+
+    switch (prop_id)
+    {
+        case PROP_MAX_MEMORY_SIZE:
+            ai_response_cache_set_max_memory_size(self, g_value_get_uint64(value));
+            break;
+        case PROP_MAX_DISK_SIZE:
+            ai_response_cache_set_max_disk_size(self, g_value_get_uint64(value));
+            break;
+        case PROP_TTL:
+            ai_response_cache_set_ttl(self, g_value_get_uint(value));
+            break;
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
+            break;
+    }
+}
+
+static void
+ai_response_cache_class_init(AiResponseCacheClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->finalize = ai_response_cache_finalize;
+    object_class->get_property = ai_response_cache_get_property;
+    object_class->set_property = ai_response_cache_set_property;
+
+    /**
+     * AiResponseCache:directory:
+     *
+     * The directory of the on-disk tier, or %NULL for a memory-only cache.
+     */
+    properties[PROP_DIRECTORY] =
+        g_param_spec_string("directory",
+                            "Directory",
+                            "The directory of the on-disk tier",
+                            NULL,
+                            G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiResponseCache:max-memory-size:
+     *
+     * The size limit of the memory tier, in bytes.
+     */
+    properties[PROP_MAX_MEMORY_SIZE] =
+        g_param_spec_uint64("max-memory-size",
+                            "Max Memory Size",
+                            "The size limit of the memory tier, in bytes",
+                            0, G_MAXUINT64,
+                            AI_RESPONSE_CACHE_DEFAULT_MAX_MEMORY_SIZE,
+                            G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                            G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiResponseCache:max-disk-size:
+     *
+     * The size limit of the on-disk tier, in bytes.
+     */
+    properties[PROP_MAX_DISK_SIZE] =
+        g_param_spec_uint64("max-disk-size",
+                            "Max Disk Size",
+                            "The size limit of the on-disk tier, in bytes",
+                            0, G_MAXUINT64,
+                            AI_RESPONSE_CACHE_DEFAULT_MAX_DISK_SIZE,
+                            G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                            G_PARAM_STATIC_STRINGS);
+
+    /**
+     * AiResponseCache:ttl:
+     *
+     * How long new entries stay valid, in seconds. 0 means forever.
+     */
+    properties[PROP_TTL] =
+        g_param_spec_uint("ttl",
+                          "TTL",
+                          "How long new entries stay valid, in seconds",
+                          0, G_MAXUINT, 0,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY |
+                          G_PARAM_STATIC_STRINGS);
+
+    g_object_class_install_properties(object_class, N_PROPS, properties);
+}
+
+static void
+ai_response_cache_init(AiResponseCache *self)
+{
+    g_mutex_init(&self->lock);
+    self->memory = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+                                         (GDestroyNotify)memory_entry_free);
+    g_queue_init(&self->lru);
+    self->max_memory_size = AI_RESPONSE_CACHE_DEFAULT_MAX_MEMORY_SIZE;
+    self->disk = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                       (GDestroyNotify)disk_entry_free);
+    self->index_fd = -1;
+    self->blob_fd = -1;
+    self->max_disk_size = AI_RESPONSE_CACHE_DEFAULT_MAX_DISK_SIZE;
+}
+
+/*
+ * pwrite()/pread() the whole buffer, retrying on short transfers.
+ */
+static gboolean
+write_all(
+    gint          fd,
+    gconstpointer data,
+    gsize         len,
+    guint64       offset
+){
+    const guint8 *p = data;
+
+    while (len > 0)
+    {
+        gssize n = pwrite(fd, p, len, (off_t)offset);
+
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return FALSE;
+        }
+
+        p += n;
+        len -= n;
+        offset += n;
+    }
+
+    return TRUE;
+}
+
+static gboolean
+read_all(
+    gint     fd,
+    gpointer data,
+    gsize    len,
+    guint64  offset
+){
+    guint8 *p = data;
+
+    while (len > 0)
+    {
+        gssize n = pread(fd, p, len, (off_t)offset);
+
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return FALSE;
+        }
+
+        p += n;
+        len -= n;
+        offset += n;
+    }
+
+    return TRUE;
+}
+
+static gint
+open_file(
+    const gchar  *path,
+    GError      **error
+){
+    gint fd = g_open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+
+    if (fd < 0)
+    {
+        int saved_errno = errno;
+
+        g_set_error(error, G_IO_ERROR, g_io_error_from_errno(saved_errno),
+                    "Failed to open %s: %s", path, g_strerror(saved_errno));
+    }
+
+    return fd;
+}
+
+static gchar *
+get_blob_path(
+    AiResponseCache *self,
+    guint64          generation
+){
+    g_autofree gchar *name = NULL;
+
+    name = g_strdup_printf(BLOB_FILE ".%" G_GUINT64_FORMAT, generation);
+
+    return g_build_filename(self->directory, name, NULL);
+}
+
+static gboolean
+write_header(
+    gint    fd,
+    guint64 generation
+){
+    return write_all(fd, INDEX_MAGIC, MAGIC_LEN, 0) &&
+           write_all(fd, &generation, sizeof(generation), MAGIC_LEN);
+}
+
+/*
+ * Empty both files and write a fresh index header.
+ */
+static gboolean
+reset_disk_locked(AiResponseCache *self)
+{
+    g_hash_table_remove_all(self->disk);
+    self->index_size = 0;
+    self->blob_size = 0;
+
+    if (ftruncate(self->index_fd, 0) != 0 || ftruncate(self->blob_fd, 0) != 0 ||
+        !write_header(self->index_fd, self->generation))
+    {
+        return FALSE;
+    }
+
+    self->index_size = HEADER_LEN;
+    return TRUE;
+}
+
+static void
+insert_disk_entry(
+    GHashTable        *table,
+    const IndexRecord *record
+){
+    DiskEntry *entry = g_slice_new(DiskEntry);
+
+    entry->offset = record->offset;
+    entry->length = record->length;
+    entry->expires_at = record->expires_at;
+    g_hash_table_replace(table, g_strndup(record->key, KEY_LEN), entry);
+}
+
+/*
+ * Open the blob file of the current generation and note its size.
+ */
+static gboolean
+open_blobs(
+    AiResponseCache  *self,
+    GError          **error
+){
+    g_autofree gchar *blob_path = get_blob_path(self, self->generation);
+    GStatBuf st;
+
+    self->blob_fd = open_file(blob_path, error);
+    if (self->blob_fd < 0)
+    {
+        return FALSE;
+    }
+
+    if (g_stat(blob_path, &st) != 0)
+    {
+        int saved_errno = errno;
+
+        g_set_error(error, G_IO_ERROR, g_io_error_from_errno(saved_errno),
+                    "Failed to stat %s: %s", blob_path, g_strerror(saved_errno));
+        return FALSE;
+    }
+    self->blob_size = (guint64)st.st_size;
+
+    return TRUE;
+}
+
+/*
+ * Map the index, open the blob file it names and load its records. A
+ * torn record at the end, left by a crash mid-write, is cut off so new
+ * records stay aligned.
+ */
+static gboolean
+load_index(
+    AiResponseCache  *self,
+    const gchar      *index_path,
+    GError          **error
+){
+    g_autoptr(GMappedFile) mapped = NULL;
+    const gchar *contents;
+    gsize length;
+    gsize n_records;
+    gsize i;
+
+    mapped = g_mapped_file_new(index_path, FALSE, error);
+    if (mapped == NULL)
+    {
+        return FALSE;
+    }
+
+    contents = g_mapped_file_get_contents(mapped);
+    length = g_mapped_file_get_length(mapped);
+
+    if (length < HEADER_LEN || memcmp(contents, INDEX_MAGIC, MAGIC_LEN) != 0)
+    {
+        /* New or unrecognized: the blobs are unreachable without it */
+        self->generation = 0;
+        if (!open_blobs(self, error))
+        {
+            return FALSE;
+        }
+        if (!reset_disk_locked(self))
+        {
+            g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errno),
+                        "Failed to initialize %s: %s", index_path, g_strerror(errno));
+            return FALSE;
+        }
+        return TRUE;
+    }
+
+    memcpy(&self->generation, contents + MAGIC_LEN, sizeof(self->generation));
+    if (!open_blobs(self, error))
+    {
+        return FALSE;
+    }
+
+    n_records = (length - HEADER_LEN) / sizeof(IndexRecord);
+
+    for (i = 0; i < n_records; i++)
+    {
+        IndexRecord record;
+
+        memcpy(&record, contents + HEADER_LEN + i * sizeof(IndexRecord), sizeof(record));
+
+        if (record.offset > self->blob_size ||
+            record.length > self->blob_size - record.offset)
+        {
+            continue;
+        }
+
+        insert_disk_entry(self->disk, &record);
+    }
+
+    self->index_size = HEADER_LEN + n_records * sizeof(IndexRecord);
+    if (self->index_size < length && ftruncate(self->index_fd, (off_t)self->index_size) != 0)
+    {
+        g_set_error(error, G_IO_ERROR, g_io_error_from_errno(errno),
+                    "Failed to repair %s: %s", index_path, g_strerror(errno));
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+/*
+ * Remove blob files of earlier generations, which a crash between
+ * replacing the index and removing them leaves behind, and the blob
+ * file of the layout before generations. Later generations may belong
+ * to a compaction in progress; the next compaction overwrites them.
+ */
+static void
+remove_stale_blobs(AiResponseCache *self)
+{
+    GDir *dir;
+    const gchar *name;
+
+    dir = g_dir_open(self->directory, 0, NULL);
+    if (dir == NULL)
+    {
+        return;
+    }
+
+    while ((name = g_dir_read_name(dir)) != NULL)
+    {
+        g_autofree gchar *path = NULL;
+        guint64 generation;
+        gchar *end;
+
+        if (strcmp(name, BLOB_FILE) != 0)
+        {
+            if (!g_str_has_prefix(name, BLOB_FILE "."))
+            {
+                continue;
+            }
+
+            generation = g_ascii_strtoull(name + strlen(BLOB_FILE "."), &end, 10);
+            if (*end != '\0' || generation >= self->generation)
+            {
+                continue;
+            }
+        }
+
+        path = g_build_filename(self->directory, name, NULL);
+        g_unlink(path);
+    }
+
+    g_dir_close(dir);
+}
+
+static gboolean
+open_disk(
+    AiResponseCache  *self,
+    GError          **error
+){
+    g_autofree gchar *index_path = NULL;
+
+    if (g_mkdir_with_parents(self->directory, 0700) != 0)
+    {
+        int saved_errno = errno;
+
+        g_set_error(error, G_IO_ERROR, g_io_error_from_errno(saved_errno),
+                    "Failed to create %s: %s", self->directory, g_strerror(saved_errno));
+        return FALSE;
+    }
+
+    index_path = g_build_filename(self->directory, INDEX_FILE, NULL);
+
+    self->index_fd = open_file(index_path, error);
+    if (self->index_fd < 0)
+    {
+        return FALSE;
+    }
+
+    if (!load_index(self, index_path, error))
+    {
+        return FALSE;
+    }
+
+    remove_stale_blobs(self);
+
+    return TRUE;
+}
+
+/**
+ * ai_response_cache_new:
+ *
+ * Creates a cache that only keeps entries in memory.
+ *
+ * Returns: (transfer full): a new #AiResponseCache
+ */
+AiResponseCache *
+ai_response_cache_new(void)
+{
+    return g_object_new(AI_TYPE_RESPONSE_CACHE, NULL);
+}
+
+/**
+ * ai_response_cache_new_for_directory:
+ * @directory: the directory holding the on-disk tier
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Creates a cache backed by @directory. The index is memory-mapped
+ * once here; afterwards lookups only touch the blob file on a miss in
+ * the memory tier.
+ *
+ * Returns: (transfer full) (nullable): a new #AiResponseCache, or %NULL
+ */
+AiResponseCache *
+ai_response_cache_new_for_directory(
+    const gchar  *directory,
+    GError      **error
+){
+    g_autoptr(AiResponseCache) self = NULL;
+
+    g_return_val_if_fail(directory != NULL, NULL);
+    g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+    self = ai_response_cache_new();
+    self->directory = g_strdup(directory);
+
+    if (!open_disk(self, error))
+    {
+        return NULL;
+    }
+
+    return g_steal_pointer(&self);
+}
+
+/**
+ * ai_response_cache_get_directory:
+ * @self: an #AiResponseCache
+ *
+ * Gets the directory of the on-disk tier.
+ *
+ * Returns: (transfer none) (nullable): the directory
+ */
+const gchar *
+ai_response_cache_get_directory(AiResponseCache *self)
+{
+    g_return_val_if_fail(AI_IS_RESPONSE_CACHE(self), NULL);
+
+    return self->directory;
+}
+
+static void
+remove_memory_entry_locked(
+    AiResponseCache *self,
+    MemoryEntry     *entry
+){
+    g_queue_unlink(&self->lru, &entry->link);
+    self->memory_size -= g_bytes_get_size(entry->data);
+    g_hash_table_remove(self->memory, entry->key);
+}
+
+/*
+ * Drop least recently used entries until the memory tier fits.
+ */
+static void
+evict_memory_locked(AiResponseCache *self)
+{
+    while (self->memory_size > self->max_memory_size && self->lru.tail != NULL)
+    {
+        remove_memory_entry_locked(self, self->lru.tail->data);
+    }
+}
+
+static void
+insert_memory_locked(
+    AiResponseCache *self,
+    const gchar     *key,
+    GBytes          *data,
+    gint64           expires_at
+){
+    MemoryEntry *entry = g_hash_table_lookup(self->memory, key);
+
+    if (entry != NULL)
+    {
+        remove_memory_entry_locked(self, entry);
+    }
+
+    entry = g_slice_new0(MemoryEntry);
+    entry->key = g_strdup(key);
+    entry->data = g_bytes_ref(data);
+    entry->expires_at = expires_at;
+    entry->link.data = entry;
+
+    g_hash_table_insert(self->memory, entry->key, entry);
+    g_queue_push_head_link(&self->lru, &entry->link);
+    self->memory_size += g_bytes_get_size(data);
+
+    evict_memory_locked(self);
+}
+
+/**
+ * ai_response_cache_get_max_memory_size:
+ * @self: an #AiResponseCache
+ *
+ * Gets the size limit of the memory tier.
+ *
+ * Returns: the limit in bytes
+ */
+guint64
+ai_response_cache_get_max_memory_size(AiResponseCache *self)
+{
+    guint64 max_size;
+
+    g_return_val_if_fail(AI_IS_RESPONSE_CACHE(self), 0);
+
+    g_mutex_lock(&self->lock);
+    max_size = self->max_memory_size;
+    g_mutex_unlock(&self->lock);
+
+    return max_size;
+}
+
+/**
+ * ai_response_cache_set_max_memory_size:
+ * @self: an #AiResponseCache
+ * @max_size: the limit in bytes
+ *
+ * Sets the size limit of the memory tier, evicting entries right away
+ * if the tier no longer fits.
+ */
+void
+ai_response_cache_set_max_memory_size(
+    AiResponseCache *self,
+    guint64          max_size
+){
+    g_return_if_fail(AI_IS_RESPONSE_CACHE(self));
+
+    g_mutex_lock(&self->lock);
+    if (self->max_memory_size == max_size)
+    {
+        g_mutex_unlock(&self->lock);
+        return;
+    }
+    self->max_memory_size = max_size;
+    evict_memory_locked(self);
+    g_mutex_unlock(&self->lock);
+
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_MAX_MEMORY_SIZE]);
+}
+
+/**
+ * ai_response_cache_get_max_disk_size:
+ * @self: an #AiResponseCache
+ *
+ * Gets the size limit of the on-disk tier.
+ *
+ * Returns: the limit in bytes
+ */
+guint64
+ai_response_cache_get_max_disk_size(AiResponseCache *self)
+{
+    guint64 max_size;
+
+    g_return_val_if_fail(AI_IS_RESPONSE_CACHE(self), 0);
+
+    g_mutex_lock(&self->lock);
+    max_size = self->max_disk_size;
+    g_mutex_unlock(&self->lock);
+
+    return max_size;
+}
+
+/**
+ * ai_response_cache_set_max_disk_size:
+ * @self: an #AiResponseCache
+ * @max_size: the limit in bytes
+ *
+ * Sets the size limit of the on-disk tier. It is enforced on the next
+ * store.
+ */
+void
+ai_response_cache_set_max_disk_size(
+    AiResponseCache *self,
+    guint64          max_size
+){
+    g_return_if_fail(AI_IS_RESPONSE_CACHE(self));
+
+    g_mutex_lock(&self->lock);
+    if (self->max_disk_size == max_size)
+    {
+        g_mutex_unlock(&self->lock);
+        return;
+    }
+    self->max_disk_size = max_size;
+    g_mutex_unlock(&self->lock);
+
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_MAX_DISK_SIZE]);
+}
+
+/**
+ * ai_response_cache_get_ttl:
+ * @self: an #AiResponseCache
+ *
+ * Gets how long new entries stay valid.
+ *
+ * Returns: the time to live in seconds, 0 if entries never expire
+ */
+guint
+ai_response_cache_get_ttl(AiResponseCache *self)
+{
+    guint ttl;
+
+    g_return_val_if_fail(AI_IS_RESPONSE_CACHE(self), 0);
+
+    g_mutex_lock(&self->lock);
+    ttl = self->ttl;
+    g_mutex_unlock(&self->lock);
+
+    return ttl;
+}
+
+/**
+ * ai_response_cache_set_ttl:
+ * @self: an #AiResponseCache
+ * @ttl_seconds: the time to live in seconds, or 0 for none
+ *
+ * Sets how long entries stored from now on stay valid. Existing
+ * entries keep the expiry they were stored with.
+ */
+void
+ai_response_cache_set_ttl(
+    AiResponseCache *self,
+    guint            ttl_seconds
+){
+    g_return_if_fail(AI_IS_RESPONSE_CACHE(self));
+
+    g_mutex_lock(&self->lock);
+    if (self->ttl == ttl_seconds)
+    {
+        g_mutex_unlock(&self->lock);
+        return;
+    }
+    self->ttl = ttl_seconds;
+    g_mutex_unlock(&self->lock);
+
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_TTL]);
+}
+
+/**
+ * ai_response_cache_compute_key:
+ * @url: the endpoint URL of the request
+ * @request_body: the serialized request body
+ *
+ * Computes the cache key of a request. The URL is part of the key so
+ * equal bodies sent to different providers or models do not collide.
+ *
+ * Returns: (transfer full): the key as a hex string
+ */
+gchar *
+ai_response_cache_compute_key(
+    const gchar *url,
+    GBytes      *request_body
+){
+    g_autoptr(GChecksum) checksum = NULL;
+    gconstpointer data;
+    gsize len;
+
+    g_return_val_if_fail(url != NULL, NULL);
+    g_return_val_if_fail(request_body != NULL, NULL);
+
+    data = g_bytes_get_data(request_body, &len);
+
+    checksum = g_checksum_new(G_CHECKSUM_SHA256);
+    g_checksum_update(checksum, (const guchar *)url, strlen(url));
+    g_checksum_update(checksum, (const guchar *)"\n", 1);
+    g_checksum_update(checksum, data, len);
+
+    return g_strdup(g_checksum_get_string(checksum));
+}
+
+static gboolean
+is_expired(
+    gint64 expires_at,
+    gint64 now
+){
+    return expires_at != 0 && expires_at <= now;
+}
+
+/*
+ * Read an entry from the blob file. Expired or unreadable entries are
+ * dropped from the index table.
+ */
+static GBytes *
+lookup_disk_locked(
+    AiResponseCache *self,
+    const gchar     *key,
+    gint64           now,
+    gint64          *expires_at
+){
+    DiskEntry *entry;
+    gpointer data;
+
+    if (self->blob_fd < 0)
+    {
+        return NULL;
+    }
+
+    entry = g_hash_table_lookup(self->disk, key);
+    if (entry == NULL)
+    {
+        return NULL;
+    }
+
+    if (is_expired(entry->expires_at, now))
+    {
+        g_hash_table_remove(self->disk, key);
+        return NULL;
+    }
+
+    data = g_malloc(entry->length);
+    if (!read_all(self->blob_fd, data, entry->length, entry->offset))
+    {
+        g_free(data);
+        g_hash_table_remove(self->disk, key);
+        return NULL;
+    }
+
+    *expires_at = entry->expires_at;
+    return g_bytes_new_take(data, entry->length);
+}
+
+/**
+ * ai_response_cache_lookup:
+ * @self: an #AiResponseCache
+ * @key: a key from ai_response_cache_compute_key()
+ *
+ * Looks up a response body, memory tier first.
+ *
+ * Returns: (transfer full) (nullable): the response body, or %NULL
+ */
+GBytes *
+ai_response_cache_lookup(
+    AiResponseCache *self,
+    const gchar     *key
+){
+    MemoryEntry *entry;
+    GBytes *data = NULL;
+    gint64 expires_at = 0;
+    gint64 now;
+
+    g_return_val_if_fail(AI_IS_RESPONSE_CACHE(self), NULL);
+    g_return_val_if_fail(key != NULL, NULL);
+
+    now = g_get_real_time();
+
+    g_mutex_lock(&self->lock);
+
+    entry = g_hash_table_lookup(self->memory, key);
+    if (entry != NULL && is_expired(entry->expires_at, now))
+    {
+        remove_memory_entry_locked(self, entry);
+        entry = NULL;
+    }
+
+    if (entry != NULL)
+    {
+        g_queue_unlink(&self->lru, &entry->link);
+        g_queue_push_head_link(&self->lru, &entry->link);
+        data = g_bytes_ref(entry->data);
+    }
+    else
+    {
+        data = lookup_disk_locked(self, key, now, &expires_at);
+        if (data != NULL)
+        {
+            insert_memory_locked(self, key, data, expires_at);
+        }
+    }
+
+    if (data != NULL)
+    {
+        self->hits++;
+    }
+    else
+    {
+        self->misses++;
+    }
+
+    g_mutex_unlock(&self->lock);
+
+    return data;
+}
+
+static gint
+compare_offset_desc(
+    gconstpointer a,
+    gconstpointer b
+){
+    const IndexRecord *ra = a;
+    const IndexRecord *rb = b;
+
+    return ra->offset < rb->offset ? 1 : ra->offset > rb->offset ? -1 : 0;
+}
+
+/*
+ * Rewrite both files with the newest live entries, filling at most
+ * three quarters of the limit so compaction does not run on every
+ * store. The entries go to a blob file of the next generation and an
+ * index beside the live one, which then replaces it in one rename.
+ * Until that rename the live files are untouched, so a failure or a
+ * crash leaves the old cache in use; after it, the new one.
+ */
+static gboolean
+compact_locked(AiResponseCache *self)
+{
+    g_autofree gchar *index_path = NULL;
+    g_autofree gchar *index_tmp = NULL;
+    g_autofree gchar *blob_path = NULL;
+    g_autofree gchar *old_blob_path = NULL;
+    g_autoptr(GArray) records = NULL;
+    g_autoptr(GHashTable) table = NULL;
+    GHashTableIter iter;
+    gpointer key;
+    gpointer value;
+    guint64 budget = self->max_disk_size / 4 * 3;
+    guint64 kept = 0;
+    gint64 now = g_get_real_time();
+    guint64 generation = self->generation + 1;
+    gint index_fd = -1;
+    gint blob_fd = -1;
+    guint64 offset = 0;
+    guint n_kept = 0;
+    int saved_errno;
+    guint i;
+
+    records = g_array_new(FALSE, FALSE, sizeof(IndexRecord));
+
+    g_hash_table_iter_init(&iter, self->disk);
+    while (g_hash_table_iter_next(&iter, &key, &value))
+    {
+        DiskEntry *entry = value;
+        IndexRecord record;
+
+        if (is_expired(entry->expires_at, now))
+        {
+            continue;
+        }
+
+        memcpy(record.key, key, KEY_LEN);
+        record.offset = entry->offset;
+        record.length = entry->length;
+        record.expires_at = entry->expires_at;
+        g_array_append_val(records, record);
+    }
+
+    /* Newest first, so the oldest entries are the ones left out */
+    g_array_sort(records, compare_offset_desc);
+    while (n_kept < records->len &&
+           kept + g_array_index(records, IndexRecord, n_kept).length <= budget)
+    {
+        kept += g_array_index(records, IndexRecord, n_kept).length;
+        n_kept++;
+    }
+
+    index_path = g_build_filename(self->directory, INDEX_FILE, NULL);
+    index_tmp = g_strconcat(index_path, ".tmp", NULL);
+    blob_path = get_blob_path(self, generation);
+    old_blob_path = get_blob_path(self, self->generation);
+
+    index_fd = g_open(index_tmp, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    blob_fd = g_open(blob_path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (index_fd < 0 || blob_fd < 0 || !write_header(index_fd, generation))
+    {
+        goto fail;
+    }
+
+    table = g_hash_table_new_full(g_str_hash, g_str_equal, g_free,
+                                  (GDestroyNotify)disk_entry_free);
+
+    /* Oldest first, keeping the file order */
+    for (i = n_kept; i > 0; i--)
+    {
+        IndexRecord record = g_array_index(records, IndexRecord, i - 1);
+        g_autofree gpointer data = g_malloc(record.length);
+
+        if (!read_all(self->blob_fd, data, record.length, record.offset) ||
+            !write_all(blob_fd, data, record.length, offset))
+        {
+            goto fail;
+        }
+
+        record.offset = offset;
+        offset += record.length;
+
+        if (!write_all(index_fd, &record, sizeof(record),
+                       HEADER_LEN + (guint64)(n_kept - i) * sizeof(record)))
+        {
+            goto fail;
+        }
+
+        insert_disk_entry(table, &record);
+    }
+
+    /* The new blobs must be on disk before an index names them */
+    if (g_fsync(blob_fd) != 0 || g_fsync(index_fd) != 0 ||
+        g_rename(index_tmp, index_path) != 0)
+    {
+        goto fail;
+    }
+
+    close_disk(self);
+    g_unlink(old_blob_path);
+    self->index_fd = index_fd;
+    self->blob_fd = blob_fd;
+    self->generation = generation;
+    self->index_size = HEADER_LEN + (guint64)n_kept * sizeof(IndexRecord);
+    self->blob_size = offset;
+    g_hash_table_unref(self->disk);
+    self->disk = g_steal_pointer(&table);
+
+    return TRUE;
+
+fail:
+    saved_errno = errno;
+    if (index_fd >= 0)
+    {
+        close(index_fd);
+    }
+    if (blob_fd >= 0)
+    {
+        close(blob_fd);
+    }
+    g_unlink(index_tmp);
+    g_unlink(blob_path);
+    errno = saved_errno;
+
+    return FALSE;
+}
+
+static void
+store_disk_locked(
+    AiResponseCache *self,
+    const gchar     *key,
+    GBytes          *data,
+    gint64           expires_at
+){
+    IndexRecord record;
+    gconstpointer bytes;
+    gsize len;
+
+    bytes = g_bytes_get_data(data, &len);
+
+    memcpy(record.key, key, KEY_LEN);
+    record.offset = self->blob_size;
+    record.length = len;
+    record.expires_at = expires_at;
+
+    /* Blob before index: a crash in between only wastes blob space */
+    if (!write_all(self->blob_fd, bytes, len, record.offset) ||
+        !write_all(self->index_fd, &record, sizeof(record), self->index_size))
+    {
+        g_warning("Failed to write response cache in %s: %s",
+                  self->directory, g_strerror(errno));
+        return;
+    }
+
+    self->blob_size += len;
+    self->index_size += sizeof(record);
+    insert_disk_entry(self->disk, &record);
+
+    if (self->blob_size > self->max_disk_size && !compact_locked(self))
+    {
+        g_warning("Failed to compact response cache in %s: %s",
+                  self->directory, g_strerror(errno));
+    }
+}
+
+/**
+ * ai_response_cache_store:
+ * @self: an #AiResponseCache
+ * @key: a key from ai_response_cache_compute_key()
+ * @response_body: the response body to store
+ *
+ * Stores a response body in both tiers. Write failures on disk are
+ * logged and leave the entry in memory only.
+ */
+void
+ai_response_cache_store(
+    AiResponseCache *self,
+    const gchar     *key,
+    GBytes          *response_body
+){
+    gint64 expires_at = 0;
+
+    g_return_if_fail(AI_IS_RESPONSE_CACHE(self));
+    g_return_if_fail(key != NULL && strlen(key) == KEY_LEN);
+    g_return_if_fail(response_body != NULL);
+
+    g_mutex_lock(&self->lock);
+
+    if (self->ttl > 0)
+    {
+        expires_at = g_get_real_time() + (gint64)self->ttl * G_USEC_PER_SEC;
+    }
+
+    insert_memory_locked(self, key, response_body, expires_at);
+
+    if (self->blob_fd >= 0)
+    {
+        store_disk_locked(self, key, response_body, expires_at);
+    }
+
+    g_mutex_unlock(&self->lock);
+}
+
+/**
+ * ai_response_cache_clear:
+ * @self: an #AiResponseCache
+ *
+ * Removes every entry from both tiers. The hit and miss counters are
+ * kept.
+ */
+void
+ai_response_cache_clear(AiResponseCache *self)
+{
+    g_return_if_fail(AI_IS_RESPONSE_CACHE(self));
+
+    g_mutex_lock(&self->lock);
+
+    g_queue_init(&self->lru);
+    g_hash_table_remove_all(self->memory);
+    self->memory_size = 0;
+
+    if (self->blob_fd >= 0 && !reset_disk_locked(self))
+    {
+        g_warning("Failed to clear response cache in %s: %s",
+                  self->directory, g_strerror(errno));
+    }
+
+    g_mutex_unlock(&self->lock);
+}
+
+/**
+ * ai_response_cache_get_hits:
+ * @self: an #AiResponseCache
+ *
+ * Gets the number of lookups that found an entry.
+ *
+ * Returns: the hit count
+ */
+guint64
+ai_response_cache_get_hits(AiResponseCache *self)
+{
+    guint64 hits;
+
+    g_return_val_if_fail(AI_IS_RESPONSE_CACHE(self), 0);
+
+    g_mutex_lock(&self->lock);
+    hits = self->hits;
+    g_mutex_unlock(&self->lock);
+
+    return hits;
+}
+
+/**
+ * ai_response_cache_get_misses:
+ * @self: an #AiResponseCache
+ *
+ * Gets the number of lookups that found no valid entry.
+ *
+ * Returns: the miss count
+ */
+guint64
+ai_response_cache_get_misses(AiResponseCache *self)
+{
+    guint64 misses;
+
+    g_return_val_if_fail(AI_IS_RESPONSE_CACHE(self), 0);
+
+    g_mutex_lock(&self->lock);
+    misses = self->misses;
+    g_mutex_unlock(&self->lock);
+
+    return misses;
+}
+
+/**
+ * ai_response_cache_get_memory_size:
+ * @self: an #AiResponseCache
+ *
+ * Gets the bytes currently held by the memory tier.
+ *
+ * Returns: the size in bytes
+ */
+guint64
+ai_response_cache_get_memory_size(AiResponseCache *self)
+{
+    guint64 size;
+
+    g_return_val_if_fail(AI_IS_RESPONSE_CACHE(self), 0);
+
+    g_mutex_lock(&self->lock);
+    size = self->memory_size;
+    g_mutex_unlock(&self->lock);
+
+    return size;
+}
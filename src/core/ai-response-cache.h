@@ -0,0 +1,261 @@
+/*
+ * ai-response-cache.h - Content-addressed cache of provider responses
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * An AiResponseCache maps the exact request a client sends (endpoint
+ * URL plus serialized body) to the raw response body the provider
+ * returned. Clients given a cache answer repeated chat requests from
+ * it without a network round trip; the cached body goes through the
+ * same parse_response path as a fresh one.
+ *
+ * Entries live in an LRU memory tier and, optionally, an on-disk tier
+ * made of an append-only blob file and an index that is memory-mapped
+ * when the cache is opened.
+ *
+ * Quick start:
+ *   g_autoptr(AiResponseCache) cache = NULL;
+ *
+ *   cache = ai_response_cache_new_for_directory("/var/cache/my-app/ai", &error);
+ *   ai_response_cache_set_ttl(cache, 24 * 60 * 60);
+ *   ai_client_set_response_cache(AI_CLIENT(client), cache);
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+/**
+ * AI_RESPONSE_CACHE_DEFAULT_MAX_MEMORY_SIZE:
+ *
+ * Default size limit of the memory tier, in bytes.
+ */
+#define AI_RESPONSE_CACHE_DEFAULT_MAX_MEMORY_SIZE (G_GUINT64_CONSTANT(64) * 1024 * 1024)
+
+/**
+ * AI_RESPONSE_CACHE_DEFAULT_MAX_DISK_SIZE:
+ *
+ * Default size limit of the on-disk blob file, in bytes.
+ */
+#define AI_RESPONSE_CACHE_DEFAULT_MAX_DISK_SIZE (G_GUINT64_CONSTANT(1024) * 1024 * 1024)
+
+#define AI_TYPE_RESPONSE_CACHE (ai_response_cache_get_type())
+
+G_DECLARE_FINAL_TYPE(AiResponseCache, ai_response_cache, AI, RESPONSE_CACHE, GObject)
+
+/**
+ * ai_response_cache_new:
+ *
+ * Creates a cache that only keeps entries in memory.
+ *
+ * Returns: (transfer full): a new #AiResponseCache
+ */
+AiResponseCache *
+ai_response_cache_new(void);
+
+/**
+ * ai_response_cache_new_for_directory:
+ * @directory: the directory holding the on-disk tier
+ * @error: (out) (optional): return location for a #GError
+ *
+ * Creates a cache backed by @directory, creating it if needed. Entries
+ * stored by earlier processes are available right away.
+ *
+ * Returns: (transfer full) (nullable): a new #AiResponseCache, or %NULL
+ *   if the directory or its files could not be opened
+ */
+AiResponseCache *
+ai_response_cache_new_for_directory(
+    const gchar  *directory,
+    GError      **error
+);
+
+/**
+ * ai_response_cache_get_directory:
+ * @self: an #AiResponseCache
+ *
+ * Gets the directory of the on-disk tier.
+ *
+ * Returns: (transfer none) (nullable): the directory, or %NULL for a
+ *   memory-only cache
+ */
+const gchar *
+ai_response_cache_get_directory(AiResponseCache *self);
+
+/**
+ * ai_response_cache_get_max_memory_size:
+ * @self: an #AiResponseCache
+ *
+ * Gets the size limit of the memory tier.
+ *
+ * Returns: the limit in bytes
+ */
+guint64
+ai_response_cache_get_max_memory_size(AiResponseCache *self);
+
+/**
+ * ai_response_cache_set_max_memory_size:
+ * @self: an #AiResponseCache
+ * @max_size: the limit in bytes
+ *
+ * Sets the size limit of the memory tier. The least recently used
+ * entries are evicted once it is exceeded.
+ */
+void
+ai_response_cache_set_max_memory_size(
+    AiResponseCache *self,
+    guint64          max_size
+);
+
+/**
+ * ai_response_cache_get_max_disk_size:
+ * @self: an #AiResponseCache
+ *
+ * Gets the size limit of the on-disk tier.
+ *
+ * Returns: the limit in bytes
+ */
+guint64
+ai_response_cache_get_max_disk_size(AiResponseCache *self);
+
+/**
+ * ai_response_cache_set_max_disk_size:
+ * @self: an #AiResponseCache
+ * @max_size: the limit in bytes
+ *
+ * Sets the size limit of the on-disk tier. When the blob file grows
+ * past it, the files are compacted, dropping expired entries and then
+ * the oldest ones.
+ */
+void
+ai_response_cache_set_max_disk_size(
+    AiResponseCache *self,
+    guint64          max_size
+);
+
+/**
+ * ai_response_cache_get_ttl:
+ * @self: an #AiResponseCache
+ *
+ * Gets how long new entries stay valid.
+ *
+ * Returns: the time to live in seconds, 0 if entries never expire
+ */
+guint
+ai_response_cache_get_ttl(AiResponseCache *self);
+
+/**
+ * ai_response_cache_set_ttl:
+ * @self: an #AiResponseCache
+ * @ttl_seconds: the time to live in seconds, or 0 for none
+ *
+ * Sets how long entries stored from now on stay valid.
+ */
+void
+ai_response_cache_set_ttl(
+    AiResponseCache *self,
+    guint            ttl_seconds
+);
+
+/**
+ * ai_response_cache_compute_key:
+ * @url: the endpoint URL of the request
+ * @request_body: the serialized request body
+ *
+ * Computes the cache key of a request: the SHA-256 of its URL and
+ * body. Requests only share a key when they are byte-for-byte equal,
+ * which the deterministic request serialization makes the case for
+ * equal inputs.
+ *
+ * Returns: (transfer full): the key as a hex string
+ */
+gchar *
+ai_response_cache_compute_key(
+    const gchar *url,
+    GBytes      *request_body
+);
+
+/**
+ * ai_response_cache_lookup:
+ * @self: an #AiResponseCache
+ * @key: a key from ai_response_cache_compute_key()
+ *
+ * Looks up a response body. Entries found on disk are promoted to the
+ * memory tier. Counts a hit or a miss.
+ *
+ * Returns: (transfer full) (nullable): the response body, or %NULL
+ */
+GBytes *
+ai_response_cache_lookup(
+    AiResponseCache *self,
+    const gchar     *key
+);
+
+/**
+ * ai_response_cache_store:
+ * @self: an #AiResponseCache
+ * @key: a key from ai_response_cache_compute_key()
+ * @response_body: the response body to store
+ *
+ * Stores a response body in the memory tier and, if the cache has a
+ * directory, on disk.
+ */
+void
+ai_response_cache_store(
+    AiResponseCache *self,
+    const gchar     *key,
+    GBytes          *response_body
+);
+
+/**
+ * ai_response_cache_clear:
+ * @self: an #AiResponseCache
+ *
+ * Removes every entry from both tiers.
+ */
+void
+ai_response_cache_clear(AiResponseCache *self);
+
+/**
+ * ai_response_cache_get_hits:
+ * @self: an #AiResponseCache
+ *
+ * Gets the number of lookups that found an entry.
+ *
+ * Returns: the hit count
+ */
+guint64
+ai_response_cache_get_hits(AiResponseCache *self);
+
+/**
+ * ai_response_cache_get_misses:
+ * @self: an #AiResponseCache
+ *
+ * Gets the number of lookups that found no valid entry.
+ *
+ * Returns: the miss count
+ */
+guint64
+ai_response_cache_get_misses(AiResponseCache *self);
+
+/**
+ * ai_response_cache_get_memory_size:
+ * @self: an #AiResponseCache
+ *
+ * Gets the bytes currently held by the memory tier.
+ *
+ * Returns: the size in bytes
+ */
+guint64
+ai_response_cache_get_memory_size(AiResponseCache *self);
+
+G_END_DECLS
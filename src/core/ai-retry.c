@@ -0,0 +1,420 @@
+/*
+ * ai-retry.c - Retry policy for HTTP requests
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include <gio/gio.h>
+
+#include "core/ai-retry.h"
+
+/*
+ * Rate-limit header pairs. When a "remaining" header reports zero, the
+ * matching "reset" header tells how long until the limit refills.
+ * Anthropic sends RFC 3339 timestamps; OpenAI and xAI send durations.
+ */
+static const struct {
+    const gchar *remaining;
+    const gchar *reset;
+} rate_limit_headers[] = {
+    { "anthropic-ratelimit-requests-remaining",
+      "anthropic-ratelimit-requests-reset" },
+    { "anthropic-ratelimit-tokens-remaining",
+      "anthropic-ratelimit-tokens-reset" },
+    { "anthropic-ratelimit-input-tokens-remaining",
+      "anthropic-ratelimit-input-tokens-reset" },
+    { "anthropic-ratelimit-output-tokens-remaining",
+      "anthropic-ratelimit-output-tokens-reset" },
+    { "x-ratelimit-remaining-requests",
+      "x-ratelimit-reset-requests" },
+    { "x-ratelimit-remaining-tokens",
+      "x-ratelimit-reset-tokens" },
+    { NULL, NULL }
+};
+
+/*
+ * Milliseconds from now until @date, clamped at zero.
+ */
+static gint64
+delay_until(GDateTime *date)
+{
+    g_autoptr(GDateTime) now = g_date_time_new_now_utc();
+    GTimeSpan diff;
+
+    diff = g_date_time_difference(date, now);
+    if (diff <= 0)
+    {
+        return 0;
+    }
+
+    return (diff + 999) / 1000;
+}
+
+/**
+ * ai_retry_is_retryable_status:
+ * @status: an HTTP status code
+ *
+ * Checks whether a request that failed with @status may be retried.
+ * Only statuses that mean the request was not processed are retryable:
+ * 408, 429 and 5xx (except 501 and 505). This includes Anthropic's
+ * non-standard 529 "overloaded" status.
+ *
+ * Returns: %TRUE if the status is retryable
+ */
+gboolean
+ai_retry_is_retryable_status(guint status)
+{
+    if (status == 408 || status == 429)
+    {
+        return TRUE;
+    }
+
+    if (status >= 500 && status < 600)
+    {
+        return status != 501 && status != 505;
+    }
+
+    return FALSE;
+}
+
+/**
+ * ai_retry_is_retryable_error:
+ * @error: a transport #GError
+ * @status: the HTTP status of the message, or 0 if none was received
+ *
+ * Checks whether a transport error may be retried. Only connection
+ * failures that happen before any response byte was received (@status
+ * is 0) qualify, since the server cannot have acted on the request.
+ * Cancellation and timeouts are never retried.
+ *
+ * Returns: %TRUE if the error is retryable
+ */
+gboolean
+ai_retry_is_retryable_error(
+    const GError *error,
+    guint         status
+){
+    if (error == NULL || status != SOUP_STATUS_NONE)
+    {
+        return FALSE;
+    }
+
+    /* G_IO_ERROR_CONNECTION_CLOSED shares its value with BROKEN_PIPE */
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_BROKEN_PIPE) ||
+        g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CONNECTION_REFUSED) ||
+        g_error_matches(error, G_IO_ERROR, G_IO_ERROR_NOT_CONNECTED) ||
+        g_error_matches(error, G_IO_ERROR, G_IO_ERROR_NETWORK_UNREACHABLE) ||
+        g_error_matches(error, G_IO_ERROR, G_IO_ERROR_HOST_UNREACHABLE))
+    {
+        return TRUE;
+    }
+
+    if (g_error_matches(error, G_RESOLVER_ERROR, G_RESOLVER_ERROR_TEMPORARY_FAILURE))
+    {
+        return TRUE;
+    }
+
+    if (g_error_matches(error, G_TLS_ERROR, G_TLS_ERROR_EOF))
+    {
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+/**
+ * ai_retry_parse_duration:
+ * @value: a duration string
+ *
+ * Parses a duration as used by rate-limit headers. Accepts plain
+ * seconds ("2", "1.5") and Go-style durations ("250ms", "1m30s",
+ * "6m0s", "1h2m3.5s").
+ *
+ * Returns: the duration in milliseconds, or -1 if @value is invalid
+ */
+gint64
+ai_retry_parse_duration(const gchar *value)
+{
+    g_autofree gchar *copy = NULL;
+    const gchar *p;
+    gdouble total_ms = 0.0;
+    gboolean has_unit = FALSE;
+
+    if (value == NULL)
+    {
+        return -1;
+    }
+
+    copy = g_strstrip(g_strdup(value));
+    p = copy;
+
+    if (*p == '\0')
+    {
+        return -1;
+    }
+
+    while (*p != '\0')
+    {
+        gchar *end = NULL;
+        gdouble num;
+        gdouble scale;
+
+        num = g_ascii_strtod(p, &end);
+        if (end == p || num < 0.0 || num != num || num > 1e12)
+        {
+            return -1;
+        }
+        p = end;
+
+        if (g_str_has_prefix(p, "ms"))
+        {
+            scale = 1.0;
+            p += 2;
+        }
+        else if (g_str_has_prefix(p, "us"))
+        {
+            scale = 0.001;
+            p += 2;
+        }
+        else if (g_str_has_prefix(p, "ns"))
+        {
+            scale = 0.000001;
+            p += 2;
+        }
+        else if (*p == 'h')
+        {
+            scale = 3600000.0;
+            p++;
+        }
+        else if (*p == 'm')
+        {
+            scale = 60000.0;
+            p++;
+        }
+        else if (*p == 's')
+        {
+            scale = 1000.0;
+            p++;
+        }
+        else if (*p == '\0' && !has_unit)
+        {
+            /* Bare number: delta-seconds */
+            scale = 1000.0;
+        }
+        else
+        {
+            return -1;
+        }
+
+        has_unit = TRUE;
+        total_ms += num * scale;
+    }
+
+    return (gint64)(total_ms + 0.999);
+}
+
+/*
+ * Parse a Retry-After value: delta-seconds or an HTTP date.
+ */
+static gint64
+parse_retry_after(const gchar *value)
+{
+    g_autoptr(GDateTime) date = NULL;
+    gint64 ms;
+
+    ms = ai_retry_parse_duration(value);
+    if (ms >= 0)
+    {
+        return ms;
+    }
+
+    date = soup_date_time_new_from_http_string(value);
+    if (date == NULL)
+    {
+        return -1;
+    }
+
+    return delay_until(date);
+}
+
+/**
+ * ai_retry_parse_reset:
+ * @value: a rate-limit reset header value
+ *
+ * Parses the time until a rate limit refills, given either as a
+ * duration (OpenAI, xAI: "1s", "6m0s") or as an RFC 3339 timestamp
+ * (Anthropic).
+ *
+ * Returns: the delay in milliseconds, or -1 if @value is invalid
+ */
+gint64
+ai_retry_parse_reset(const gchar *value)
+{
+    g_autoptr(GDateTime) date = NULL;
+    gint64 ms;
+
+    ms = ai_retry_parse_duration(value);
+    if (ms >= 0 || value == NULL)
+    {
+        return ms;
+    }
+
+    date = g_date_time_new_from_iso8601(value, NULL);
+    if (date == NULL)
+    {
+        return -1;
+    }
+
+    return delay_until(date);
+}
+
+/**
+ * ai_retry_get_server_delay:
+ * @headers: response #SoupMessageHeaders
+ *
+ * Extracts the delay requested by the server. Checks, in order:
+ * `retry-after-ms`, `Retry-After` (seconds or HTTP date), then the
+ * `anthropic-ratelimit-*-reset` and `x-ratelimit-reset-*` headers for
+ * any limit whose matching `remaining` header is exhausted. When several
+ * limits are exhausted, the longest reset wins.
+ *
+ * Returns: the delay in milliseconds, or -1 if the server gave no hint
+ */
+gint64
+ai_retry_get_server_delay(SoupMessageHeaders *headers)
+{
+    const gchar *value;
+    gint64 delay = -1;
+    guint i;
+
+    g_return_val_if_fail(headers != NULL, -1);
+
+    value = soup_message_headers_get_one(headers, "retry-after-ms");
+    if (value != NULL)
+    {
+        gchar *end = NULL;
+        gdouble ms = g_ascii_strtod(value, &end);
+
+        if (end != value && ms >= 0.0)
+        {
+            return (gint64)(ms + 0.999);
+        }
+    }
+
+    value = soup_message_headers_get_one(headers, "Retry-After");
+    if (value != NULL)
+    {
+        delay = parse_retry_after(value);
+        if (delay >= 0)
+        {
+            return delay;
+        }
+    }
+
+    for (i = 0; rate_limit_headers[i].remaining != NULL; i++)
+    {
+        const gchar *remaining;
+        const gchar *reset;
+        gint64 reset_ms;
+
+        remaining = soup_message_headers_get_one(headers, rate_limit_headers[i].remaining);
+        reset = soup_message_headers_get_one(headers, rate_limit_headers[i].reset);
+
+        if (remaining == NULL || reset == NULL ||
+            g_ascii_strtoll(remaining, NULL, 10) > 0)
+        {
+            continue;
+        }
+
+        reset_ms = ai_retry_parse_reset(reset);
+        if (reset_ms > delay)
+        {
+            delay = reset_ms;
+        }
+    }
+
+    return delay;
+}
+
+/**
+ * ai_retry_compute_backoff:
+ * @attempt: the zero-based retry attempt
+ * @base_delay_ms: the base delay in milliseconds
+ * @max_delay_ms: the maximum delay in milliseconds
+ *
+ * Computes an exponential backoff delay with full jitter: a uniformly
+ * random value between 0 and min(@max_delay_ms, @base_delay_ms * 2^@attempt).
+ * Full jitter spreads out clients that failed together so they do not
+ * retry in lockstep.
+ *
+ * Returns: the delay in milliseconds
+ */
+guint
+ai_retry_compute_backoff(
+    guint attempt,
+    guint base_delay_ms,
+    guint max_delay_ms
+){
+    guint64 window = base_delay_ms;
+    guint i;
+
+    for (i = 0; i < attempt && window < max_delay_ms; i++)
+    {
+        window *= 2;
+    }
+
+    if (window > max_delay_ms)
+    {
+        window = max_delay_ms;
+    }
+    if (window >= G_MAXINT32)
+    {
+        window = G_MAXINT32 - 1;
+    }
+
+    if (window == 0)
+    {
+        return 0;
+    }
+
+    return (guint)g_random_int_range(0, (gint32)window + 1);
+}
+
+/**
+ * ai_retry_get_delay:
+ * @msg: (nullable): the failed #SoupMessage
+ * @attempt: the zero-based retry attempt
+ *
+ * Gets the delay before retrying @msg. A server hint takes precedence
+ * over the computed backoff; both are capped at
+ * %AI_RETRY_DEFAULT_MAX_DELAY_MS.
+ *
+ * Returns: the delay in milliseconds
+ */
+guint
+ai_retry_get_delay(
+    SoupMessage *msg,
+    guint        attempt
+){
+    gint64 server_delay = -1;
+
+    if (msg != NULL)
+    {
+        server_delay = ai_retry_get_server_delay(
+            soup_message_get_response_headers(msg));
+    }
+
+    if (server_delay >= 0)
+    {
+        return (guint)MIN(server_delay, AI_RETRY_DEFAULT_MAX_DELAY_MS);
+    }
+
+    return ai_retry_compute_backoff(attempt,
+                                    AI_RETRY_DEFAULT_BASE_DELAY_MS,
+                                    AI_RETRY_DEFAULT_MAX_DELAY_MS);
+}
@@ -0,0 +1,146 @@
+/*
+ * ai-retry.h - Retry policy for HTTP requests
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * Decides which failures are safe to retry and how long to wait
+ * before the next attempt. Delays honor server hints (Retry-After,
+ * retry-after-ms and the provider rate-limit reset headers) and fall
+ * back to exponential backoff with full jitter.
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib.h>
+#include <libsoup/soup.h>
+
+G_BEGIN_DECLS
+
+/**
+ * AI_RETRY_DEFAULT_BASE_DELAY_MS:
+ *
+ * Base delay in milliseconds for the first retry. Each further attempt
+ * doubles the backoff window.
+ */
+#define AI_RETRY_DEFAULT_BASE_DELAY_MS (500)
+
+/**
+ * AI_RETRY_DEFAULT_MAX_DELAY_MS:
+ *
+ * Upper bound in milliseconds for any single retry delay, including
+ * delays requested by the server.
+ */
+#define AI_RETRY_DEFAULT_MAX_DELAY_MS (60000)
+
+/**
+ * ai_retry_is_retryable_status:
+ * @status: an HTTP status code
+ *
+ * Checks whether a request that failed with @status may be retried.
+ * Only statuses that mean the request was not processed are retryable:
+ * 408, 429 and 5xx (except 501 and 505).
+ *
+ * Returns: %TRUE if the status is retryable
+ */
+gboolean
+ai_retry_is_retryable_status(guint status);
+
+/**
+ * ai_retry_is_retryable_error:
+ * @error: a transport #GError
+ * @status: the HTTP status of the message, or 0 if none was received
+ *
+ * Checks whether a transport error may be retried. Only connection
+ * failures that happen before any response byte was received (@status
+ * is 0) qualify, since the server cannot have acted on the request.
+ *
+ * Returns: %TRUE if the error is retryable
+ */
+gboolean
+ai_retry_is_retryable_error(
+    const GError *error,
+    guint         status
+);
+
+/**
+ * ai_retry_parse_duration:
+ * @value: a duration string
+ *
+ * Parses a duration as used by rate-limit headers. Accepts plain
+ * seconds ("2", "1.5") and Go-style durations ("250ms", "1m30s",
+ * "6m0s", "1h2m3.5s").
+ *
+ * Returns: the duration in milliseconds, or -1 if @value is invalid
+ */
+gint64
+ai_retry_parse_duration(const gchar *value);
+
+/**
+ * ai_retry_parse_reset:
+ * @value: a rate-limit reset header value
+ *
+ * Parses the time until a rate limit refills, given either as a
+ * duration (OpenAI, xAI) or as an RFC 3339 timestamp (Anthropic).
+ *
+ * Returns: the delay in milliseconds, or -1 if @value is invalid
+ */
+gint64
+ai_retry_parse_reset(const gchar *value);
+
+/**
+ * ai_retry_get_server_delay:
+ * @headers: response #SoupMessageHeaders
+ *
+ * Extracts the delay requested by the server. Checks, in order:
+ * `retry-after-ms`, `Retry-After` (seconds or HTTP date), then the
+ * `anthropic-ratelimit-*-reset` and `x-ratelimit-reset-*` headers for
+ * any limit whose matching `remaining` header is exhausted.
+ *
+ * Returns: the delay in milliseconds, or -1 if the server gave no hint
+ */
+gint64
+ai_retry_get_server_delay(SoupMessageHeaders *headers);
+
+/**
+ * ai_retry_compute_backoff:
+ * @attempt: the zero-based retry attempt
+ * @base_delay_ms: the base delay in milliseconds
+ * @max_delay_ms: the maximum delay in milliseconds
+ *
+ * Computes an exponential backoff delay with full jitter: a uniformly
+ * random value between 0 and min(@max_delay_ms, @base_delay_ms * 2^@attempt).
+ *
+ * Returns: the delay in milliseconds
+ */
+guint
+ai_retry_compute_backoff(
+    guint attempt,
+    guint base_delay_ms,
+    guint max_delay_ms
+);
+
+/**
+ * ai_retry_get_delay:
+ * @msg: (nullable): the failed #SoupMessage
+ * @attempt: the zero-based retry attempt
+ *
+ * Gets the delay before retrying @msg. A server hint takes precedence
+ * over the computed backoff; both are capped at
+ * %AI_RETRY_DEFAULT_MAX_DELAY_MS.
+ *
+ * Returns: the delay in milliseconds
+ */
+guint
+ai_retry_get_delay(
+    SoupMessage *msg,
+    guint        attempt
+);
+
+G_END_DECLS
@@ -0,0 +1,246 @@
+/*
+ * ai-session-pool.c - Process-wide shared HTTP sessions
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include "core/ai-session-pool.h"
+
+/*
+ * Pool entry. The session pointer is only compared, never dereferenced,
+ * once the weak reference has been cleared.
+ */
+typedef struct
+{
+    GWeakRef     ref;
+    SoupSession *session;
+    gchar       *key;
+} PoolEntry;
+
+static GMutex      pool_lock;
+static GHashTable *pool = NULL;
+
+/* Sessions of threads with ai_session_pool_set_thread_local(), strong refs */
+static GPrivate thread_pool = G_PRIVATE_INIT((GDestroyNotify)g_hash_table_unref);
+
+static void
+pool_entry_free(PoolEntry *entry)
+{
+    g_weak_ref_clear(&entry->ref);
+    g_free(entry->key);
+    g_slice_free(PoolEntry, entry);
+}
+
+/*
+ * Drop the entry once its session is gone, unless it was already
+ * replaced by a newer session for the same key.
+ */
+static void
+on_session_finalized(
+    gpointer  data,
+    GObject  *where_the_object_was
+){
+    PoolEntry *entry;
+    g_autofree gchar *key = data;
+
+    g_mutex_lock(&pool_lock);
+
+    entry = g_hash_table_lookup(pool, key);
+    if (entry != NULL && (GObject *)entry->session == where_the_object_was)
+    {
+        g_hash_table_remove(pool, key);
+    }
+
+    g_mutex_unlock(&pool_lock);
+}
+
+/*
+ * Build the pool key: the endpoint origin and the session settings.
+ */
+static gchar *
+make_key(
+    const gchar *url,
+    guint        timeout_seconds,
+    guint        max_connections
+){
+    g_autoptr(GUri) uri = NULL;
+
+    if (url != NULL)
+    {
+        uri = g_uri_parse(url, G_URI_FLAGS_NONE, NULL);
+    }
+
+    if (uri == NULL)
+    {
+        return g_strdup_printf("*|%u|%u", timeout_seconds, max_connections);
+    }
+
+    return g_strdup_printf("%s://%s:%d|%u|%u",
+                           g_uri_get_scheme(uri),
+                           g_uri_get_host(uri) != NULL ? g_uri_get_host(uri) : "",
+                           g_uri_get_port(uri),
+                           timeout_seconds,
+                           max_connections);
+}
+
+static SoupSession *
+new_session(
+    const gchar *url,
+    guint        timeout_seconds,
+    guint        max_connections
+){
+    /*
+     * A general-purpose session talks to many hosts, so only the
+     * per-host limit applies; endpoint sessions talk to one host.
+     */
+    return soup_session_new_with_options(
+        "max-conns-per-host", max_connections,
+        "max-conns", url != NULL ? max_connections : MAX(max_connections * 4, 10u),
+        "idle-timeout", AI_SESSION_POOL_IDLE_TIMEOUT,
+        "timeout", timeout_seconds,
+        NULL);
+}
+
+/**
+ * ai_session_pool_get_session:
+ * @url: (nullable): a URL on the endpoint, or %NULL for a general-purpose session
+ * @timeout_seconds: the I/O timeout in seconds, or 0 for none
+ * @max_connections: the maximum number of connections per host
+ *
+ * Gets the shared #SoupSession for the endpoint of @url. Sessions are
+ * keyed by scheme, host and port plus the timeout and connection limit,
+ * so callers with the same settings share connections. The pool only
+ * holds weak references: a session is freed once its last user drops
+ * it, which also closes its connections.
+ *
+ * Returns: (transfer full): the #SoupSession
+ */
+SoupSession *
+ai_session_pool_get_session(
+    const gchar *url,
+    guint        timeout_seconds,
+    guint        max_connections
+){
+    g_autofree gchar *key = NULL;
+    GHashTable *local;
+    PoolEntry *entry;
+    SoupSession *session;
+
+    if (max_connections == 0)
+    {
+        max_connections = 1;
+    }
+
+    key = make_key(url, timeout_seconds, max_connections);
+
+    local = g_private_get(&thread_pool);
+    if (local != NULL)
+    {
+        session = g_hash_table_lookup(local, key);
+        if (session == NULL)
+        {
+            session = new_session(url, timeout_seconds, max_connections);
+            g_hash_table_insert(local, g_steal_pointer(&key), session);
+        }
+
+        return g_object_ref(session);
+    }
+
+    g_mutex_lock(&pool_lock);
+
+    if (pool == NULL)
+    {
+        pool = g_hash_table_new_full(g_str_hash, g_str_equal,
+                                     NULL, (GDestroyNotify)pool_entry_free);
+    }
+
+    entry = g_hash_table_lookup(pool, key);
+    if (entry != NULL)
+    {
+        session = g_weak_ref_get(&entry->ref);
+        if (session != NULL)
+        {
+            g_mutex_unlock(&pool_lock);
+            return session;
+        }
+    }
+
+    session = new_session(url, timeout_seconds, max_connections);
+
+    entry = g_slice_new0(PoolEntry);
+    entry->key = g_strdup(key);
+    entry->session = session;
+    g_weak_ref_init(&entry->ref, session);
+
+    /* Replaces (and frees) any stale entry for the key */
+    g_hash_table_replace(pool, entry->key, entry);
+
+    g_object_weak_ref(G_OBJECT(session), on_session_finalized, g_strdup(key));
+
+    g_mutex_unlock(&pool_lock);
+
+    return session;
+}
+
+/**
+ * ai_session_pool_set_thread_local:
+ * @thread_local: whether the calling thread gets sessions of its own
+ *
+ * Makes ai_session_pool_get_session() give the calling thread sessions
+ * that no other thread uses.
+ */
+void
+ai_session_pool_set_thread_local(gboolean thread_local)
+{
+    if (!thread_local)
+    {
+        /* Frees the table through the GPrivate notify */
+        g_private_replace(&thread_pool, NULL);
+        return;
+    }
+
+    if (g_private_get(&thread_pool) == NULL)
+    {
+        g_private_set(&thread_pool,
+                      g_hash_table_new_full(g_str_hash, g_str_equal,
+                                            g_free, g_object_unref));
+    }
+}
+
+/**
+ * ai_session_pool_get_thread_local:
+ *
+ * Gets whether the calling thread has sessions of its own.
+ *
+ * Returns: %TRUE if thread-local sessions are on for the calling thread
+ */
+gboolean
+ai_session_pool_get_thread_local(void)
+{
+    return g_private_get(&thread_pool) != NULL;
+}
+
+/**
+ * ai_session_pool_get_size:
+ *
+ * Gets the number of live sessions in the pool, not counting
+ * thread-local sessions.
+ *
+ * Returns: the number of sessions
+ */
+guint
+ai_session_pool_get_size(void)
+{
+    guint size;
+
+    g_mutex_lock(&pool_lock);
+    size = pool != NULL ? g_hash_table_size(pool) : 0;
+    g_mutex_unlock(&pool_lock);
+
+    return size;
+}
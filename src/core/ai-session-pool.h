@@ -0,0 +1,89 @@
+/*
+ * ai-session-pool.h - Process-wide shared HTTP sessions
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * Clients talking to the same endpoint share one SoupSession, so
+ * keep-alive connections (and HTTP/2 connections, which libsoup
+ * negotiates via ALPN) are reused across clients instead of paying a
+ * new TCP and TLS handshake per client.
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib.h>
+#include <libsoup/soup.h>
+
+G_BEGIN_DECLS
+
+/**
+ * AI_SESSION_POOL_IDLE_TIMEOUT:
+ *
+ * Seconds after which idle pooled connections are closed.
+ */
+#define AI_SESSION_POOL_IDLE_TIMEOUT (90)
+
+/**
+ * ai_session_pool_get_session:
+ * @url: (nullable): a URL on the endpoint, or %NULL for a general-purpose session
+ * @timeout_seconds: the I/O timeout in seconds, or 0 for none
+ * @max_connections: the maximum number of connections per host
+ *
+ * Gets the shared #SoupSession for the endpoint of @url. Sessions are
+ * keyed by scheme, host and port plus the timeout and connection limit,
+ * so callers with the same settings share connections. The pool only
+ * holds weak references: a session is freed once its last user drops
+ * it, which also closes its connections.
+ *
+ * Returns: (transfer full): the #SoupSession
+ */
+SoupSession *
+ai_session_pool_get_session(
+    const gchar *url,
+    guint        timeout_seconds,
+    guint        max_connections
+);
+
+/**
+ * ai_session_pool_set_thread_local:
+ * @thread_local: whether the calling thread gets sessions of its own
+ *
+ * Makes ai_session_pool_get_session() give the calling thread sessions
+ * that no other thread uses, still shared by the clients in the thread.
+ * A thread that runs its own #GMainContext needs this, since a
+ * #SoupSession must be driven from one context. The thread keeps its
+ * sessions until this is turned off or the thread exits.
+ */
+void
+ai_session_pool_set_thread_local(gboolean thread_local);
+
+/**
+ * ai_session_pool_get_thread_local:
+ *
+ * Gets whether the calling thread has sessions of its own.
+ *
+ * Returns: %TRUE if ai_session_pool_set_thread_local() is on for the
+ *   calling thread
+ */
+gboolean
+ai_session_pool_get_thread_local(void);
+
+/**
+ * ai_session_pool_get_size:
+ *
+ * Gets the number of live sessions in the pool, not counting
+ * thread-local sessions.
+ *
+ * Returns: the number of sessions
+ */
+guint
+ai_session_pool_get_size(void);
+
+G_END_DECLS
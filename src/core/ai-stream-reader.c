@@ -0,0 +1,467 @@
+/*
+ * ai-stream-reader.c - Block-buffered SSE and NDJSON framing
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "core/ai-stream-reader.h"
+
+/* Grow the buffer rather than read fewer bytes than this */
+#define MIN_READ_SIZE 4096
+
+/* Room kept free to terminate the last event at the end of the stream */
+#define EOF_RESERVE 2
+
+static const GEnumValue stream_format_values[] = {
+    { AI_STREAM_FORMAT_SSE,    "AI_STREAM_FORMAT_SSE",    "sse" },
+    { AI_STREAM_FORMAT_NDJSON, "AI_STREAM_FORMAT_NDJSON", "ndjson" },
+    { 0, NULL, NULL }
+};
+
+GType
+ai_stream_format_get_type(void)
+{
+    static GType type = 0;
+
+    if (g_once_init_enter(&type))
+    {
+        GType t = g_enum_register_static("AiStreamFormat", stream_format_values);
+        g_once_init_leave(&type, t);
+    }
+
+    return type;
+}
+
+/*
+ * The buffer holds, in order: events already dispatched (before
+ * start), the lines of the event being parsed (start to scan), and
+ * bytes not yet split into lines (scan to end). Before each read, the
+ * pending bytes are moved to the front, which is usually a partial
+ * line of a few hundred bytes.
+ *
+ * Fields of the event being parsed are kept as offsets from start, so
+ * they survive that move.
+ */
+struct _AiStreamReader
+{
+    GInputStream      *stream;
+    AiStreamFormat     format;
+    AiStreamEventFunc  func;
+    gpointer           user_data;
+
+    gchar             *buffer;
+    gsize              size;
+    gsize              start;
+    gsize              scan;
+    gsize              end;
+
+    gssize             type_offset;     /* -1 for none */
+    gsize              type_len;
+    gssize             data_offset;     /* -1 for none */
+    gsize              data_len;
+    guint              n_data_lines;
+    GString           *joined;          /* data of multi-line events */
+
+    gboolean           paused;
+    gboolean           eof;
+};
+
+/**
+ * ai_stream_reader_new:
+ * @stream: the #GInputStream to read
+ * @format: how events are framed
+ * @func: called for every event
+ * @user_data: data for @func
+ *
+ * Creates a reader for @stream.
+ *
+ * Returns: (transfer full): a new #AiStreamReader
+ */
+AiStreamReader *
+ai_stream_reader_new(
+    GInputStream      *stream,
+    AiStreamFormat     format,
+    AiStreamEventFunc  func,
+    gpointer           user_data
+){
+    AiStreamReader *self;
+
+    g_return_val_if_fail(G_IS_INPUT_STREAM(stream), NULL);
+    g_return_val_if_fail(func != NULL, NULL);
+
+    self = g_slice_new0(AiStreamReader);
+    self->stream = g_object_ref(stream);
+    self->format = format;
+    self->func = func;
+    self->user_data = user_data;
+    self->size = AI_STREAM_READER_BLOCK_SIZE;
+    self->buffer = g_malloc(self->size);
+    self->type_offset = -1;
+    self->data_offset = -1;
+
+    return self;
+}
+
+/**
+ * ai_stream_reader_free:
+ * @self: (nullable): an #AiStreamReader
+ *
+ * Frees the reader.
+ */
+void
+ai_stream_reader_free(AiStreamReader *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+
+    g_clear_object(&self->stream);
+    g_free(self->buffer);
+    if (self->joined != NULL)
+    {
+        g_string_free(self->joined, TRUE);
+    }
+    g_slice_free(AiStreamReader, self);
+}
+
+static void
+reset_event(AiStreamReader *self)
+{
+    self->type_offset = -1;
+    self->type_len = 0;
+    self->data_offset = -1;
+    self->data_len = 0;
+    self->n_data_lines = 0;
+}
+
+/*
+ * Hand the SSE event parsed so far to the event function.
+ */
+static gboolean
+dispatch_sse_event(AiStreamReader *self)
+{
+    AiStreamEvent event;
+
+    if (self->n_data_lines == 0)
+    {
+        /* Events without data are not dispatched, as in browsers */
+        return TRUE;
+    }
+
+    event.type = self->type_offset >= 0 ? self->buffer + self->start + self->type_offset : NULL;
+    event.type_len = self->type_len;
+
+    if (self->n_data_lines == 1)
+    {
+        event.data = self->buffer + self->start + self->data_offset;
+        event.data_len = self->data_len;
+    }
+    else
+    {
+        event.data = self->joined->str;
+        event.data_len = self->joined->len;
+    }
+
+    return self->func(&event, self->user_data);
+}
+
+/*
+ * Add one line, terminated in place, to the SSE event being parsed.
+ * Returns FALSE if the event function asked to pause.
+ */
+static gboolean
+parse_sse_line(
+    AiStreamReader *self,
+    gchar          *line,
+    gsize           length
+){
+    gchar *colon;
+    gchar *value;
+    gsize name_len;
+    gsize value_len;
+    gboolean go_on = TRUE;
+
+    if (length == 0)
+    {
+        go_on = dispatch_sse_event(self);
+        reset_event(self);
+        return go_on;
+    }
+
+    if (line[0] == ':')
+    {
+        /* A comment, usually a keep-alive */
+        return TRUE;
+    }
+
+    colon = memchr(line, ':', length);
+    name_len = colon != NULL ? (gsize)(colon - line) : length;
+    value = colon != NULL ? colon + 1 : line + length;
+    if (value[0] == ' ')
+    {
+        value++;
+    }
+    value_len = length - (value - line);
+
+    if (name_len == 4 && memcmp(line, "data", 4) == 0)
+    {
+        self->n_data_lines++;
+
+        if (self->n_data_lines == 1)
+        {
+            self->data_offset = value - (self->buffer + self->start);
+            self->data_len = value_len;
+        }
+        else
+        {
+            if (self->joined == NULL)
+            {
+                self->joined = g_string_sized_new(2 * (self->data_len + value_len));
+            }
+
+            if (self->n_data_lines == 2)
+            {
+                g_string_truncate(self->joined, 0);
+                g_string_append_len(self->joined,
+                                    self->buffer + self->start + self->data_offset,
+                                    self->data_len);
+            }
+            g_string_append_c(self->joined, '\n');
+            g_string_append_len(self->joined, value, value_len);
+        }
+    }
+    else if (name_len == 5 && memcmp(line, "event", 5) == 0)
+    {
+        self->type_offset = value - (self->buffer + self->start);
+        self->type_len = value_len;
+    }
+
+    /* id: and retry: are of no use for a single response */
+    return TRUE;
+}
+
+/*
+ * Split complete lines off the buffer and dispatch the events they
+ * complete, until the bytes run out or the event function pauses.
+ */
+static void
+dispatch_lines(AiStreamReader *self)
+{
+    while (!self->paused && self->scan < self->end)
+    {
+        gchar *line = self->buffer + self->scan;
+        gchar *newline = memchr(line, '\n', self->end - self->scan);
+        gsize next;
+        gsize length;
+
+        if (newline == NULL)
+        {
+            break;
+        }
+
+        length = newline - line;
+        next = self->scan + length + 1;
+
+        if (length > 0 && line[length - 1] == '\r')
+        {
+            length--;
+        }
+        line[length] = '\0';
+
+        self->scan = next;
+
+        if (self->format == AI_STREAM_FORMAT_NDJSON)
+        {
+            self->start = next;
+
+            if (length > 0)
+            {
+                AiStreamEvent event = { NULL, 0, line, length };
+
+                self->paused = !self->func(&event, self->user_data);
+            }
+        }
+        else
+        {
+            gboolean idle = self->n_data_lines == 0 && self->type_offset < 0;
+
+            /*
+             * Lines outside any event, such as comments between events,
+             * need not be kept, so the buffer does not fill up with them.
+             */
+            if (idle && (length == 0 || line[0] == ':'))
+            {
+                self->start = next;
+                continue;
+            }
+
+            self->paused = !parse_sse_line(self, line, length);
+
+            if (length == 0)
+            {
+                self->start = next;
+            }
+        }
+    }
+}
+
+/*
+ * Move the pending bytes to the front and make room for a block.
+ */
+static void
+prepare_buffer(AiStreamReader *self)
+{
+    if (self->start > 0)
+    {
+        memmove(self->buffer, self->buffer + self->start, self->end - self->start);
+        self->scan -= self->start;
+        self->end -= self->start;
+        self->start = 0;
+    }
+
+    /* An event larger than the buffer */
+    if (self->size - self->end < MIN_READ_SIZE + EOF_RESERVE)
+    {
+        self->size *= 2;
+        self->buffer = g_realloc(self->buffer, self->size);
+    }
+}
+
+/*
+ * Terminate whatever the stream ended with, as if the sender had
+ * finished the line and the event.
+ */
+static void
+finish_stream(AiStreamReader *self)
+{
+    self->eof = TRUE;
+    self->buffer[self->end++] = '\n';
+
+    if (self->format == AI_STREAM_FORMAT_SSE)
+    {
+        self->buffer[self->end++] = '\n';
+    }
+}
+
+/*
+ * Whether events are still to be dispatched from the buffer.
+ */
+static gboolean
+has_buffered_lines(AiStreamReader *self)
+{
+    return memchr(self->buffer + self->scan, '\n', self->end - self->scan) != NULL;
+}
+
+static void
+on_block_read(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    AiStreamReader *self = g_task_get_task_data(task);
+    GError *error = NULL;
+    gssize n_read;
+
+    n_read = g_input_stream_read_finish(G_INPUT_STREAM(source), result, &error);
+
+    if (n_read < 0)
+    {
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    if (n_read == 0)
+    {
+        finish_stream(self);
+    }
+    else
+    {
+        self->end += n_read;
+    }
+
+    dispatch_lines(self);
+
+    g_task_return_boolean(task, !self->eof || has_buffered_lines(self));
+    g_object_unref(task);
+}
+
+/**
+ * ai_stream_reader_read_async:
+ * @self: an #AiStreamReader
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): called when the read is done
+ * @user_data: data for @callback
+ *
+ * Reads and dispatches the next block of the stream.
+ */
+void
+ai_stream_reader_read_async(
+    AiStreamReader      *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    GTask *task;
+
+    g_return_if_fail(self != NULL);
+
+    task = g_task_new(NULL, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_stream_reader_read_async);
+    g_task_set_task_data(task, self, NULL);
+
+    /* Events held back last time go first */
+    self->paused = FALSE;
+    dispatch_lines(self);
+
+    if (self->paused || self->eof)
+    {
+        g_task_return_boolean(task, !self->eof || has_buffered_lines(self));
+        g_object_unref(task);
+        return;
+    }
+
+    prepare_buffer(self);
+
+    g_input_stream_read_async(self->stream,
+                              self->buffer + self->end,
+                              self->size - self->end - EOF_RESERVE,
+                              G_PRIORITY_DEFAULT,
+                              cancellable,
+                              on_block_read,
+                              task);
+}
+
+/**
+ * ai_stream_reader_read_finish:
+ * @self: an #AiStreamReader
+ * @result: the #GAsyncResult
+ * @error: return location for a #GError
+ *
+ * Finishes a read.
+ *
+ * Returns: %TRUE if more events may follow, %FALSE at the end of the
+ *   stream or on error
+ */
+gboolean
+ai_stream_reader_read_finish(
+    AiStreamReader  *self,
+    GAsyncResult    *result,
+    GError         **error
+){
+    g_return_val_if_fail(self != NULL, FALSE);
+    g_return_val_if_fail(g_task_is_valid(result, NULL), FALSE);
+    g_return_val_if_fail(g_task_get_source_tag(G_TASK(result)) == ai_stream_reader_read_async,
+                         FALSE);
+
+    return g_task_propagate_boolean(G_TASK(result), error);
+}
@@ -0,0 +1,177 @@
+/*
+ * ai-stream-reader.h - Block-buffered SSE and NDJSON framing
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * An AiStreamReader splits a streamed HTTP response into events. It
+ * reads the stream in large blocks into one reusable buffer, finds line
+ * ends with memchr(), and hands each complete event to a callback as a
+ * slice of that buffer, terminated in place. Nothing is copied or
+ * allocated per line; only an SSE event with several data: lines is
+ * joined into a scratch string.
+ *
+ * One read covers all events in a block, so a stream costs one main
+ * loop round-trip per block instead of one per line.
+ *
+ * Quick start:
+ *   reader = ai_stream_reader_new(stream, AI_STREAM_FORMAT_SSE,
+ *                                 on_event, data);
+ *   ai_stream_reader_read_async(reader, cancellable, on_read, data);
+ *
+ *   // in on_read: call ai_stream_reader_read_finish() and read again
+ *   // until it returns FALSE
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+/**
+ * AiStreamFormat:
+ * @AI_STREAM_FORMAT_SSE: Server-Sent Events; events end at a blank line
+ * @AI_STREAM_FORMAT_NDJSON: newline-delimited JSON; every non-empty
+ *   line is an event
+ *
+ * How an #AiStreamReader frames events.
+ */
+typedef enum
+{
+    AI_STREAM_FORMAT_SSE = 0,
+    AI_STREAM_FORMAT_NDJSON
+} AiStreamFormat;
+
+GType ai_stream_format_get_type(void) G_GNUC_CONST;
+#define AI_TYPE_STREAM_FORMAT (ai_stream_format_get_type())
+
+/**
+ * AiStreamEvent:
+ * @type: (nullable): the SSE event: field, or %NULL if there was none
+ *   or for NDJSON
+ * @type_len: the length of @type
+ * @data: the event data, with several SSE data: lines joined by "\n";
+ *   for NDJSON the line itself
+ * @data_len: the length of @data
+ *
+ * One event. Both strings are nul-terminated, point into the reader's
+ * buffer and are only valid during the callback.
+ */
+typedef struct
+{
+    const gchar *type;
+    gsize        type_len;
+    const gchar *data;
+    gsize        data_len;
+} AiStreamEvent;
+
+/**
+ * AiStreamEventFunc:
+ * @event: the event
+ * @user_data: the data passed to ai_stream_reader_new()
+ *
+ * Called for every complete event.
+ *
+ * Returns: %TRUE to go on, %FALSE to hold back the remaining events
+ *   until the next ai_stream_reader_read_async()
+ */
+typedef gboolean (*AiStreamEventFunc)(
+    const AiStreamEvent *event,
+    gpointer             user_data
+);
+
+/**
+ * AiStreamReader:
+ *
+ * An opaque reader that frames one input stream into events.
+ */
+typedef struct _AiStreamReader AiStreamReader;
+
+/**
+ * AI_STREAM_READER_BLOCK_SIZE:
+ *
+ * The initial buffer size of an #AiStreamReader, in bytes. The buffer
+ * grows when one event does not fit.
+ */
+#define AI_STREAM_READER_BLOCK_SIZE (16 * 1024)
+
+/**
+ * ai_stream_reader_new:
+ * @stream: the #GInputStream to read
+ * @format: how events are framed
+ * @func: called for every event
+ * @user_data: data for @func
+ *
+ * Creates a reader for @stream.
+ *
+ * Returns: (transfer full): a new #AiStreamReader
+ */
+AiStreamReader *
+ai_stream_reader_new(
+    GInputStream      *stream,
+    AiStreamFormat     format,
+    AiStreamEventFunc  func,
+    gpointer           user_data
+);
+
+/**
+ * ai_stream_reader_free:
+ * @self: (nullable): an #AiStreamReader
+ *
+ * Frees the reader. It must not have a read in progress. The stream is
+ * not closed.
+ */
+void
+ai_stream_reader_free(AiStreamReader *self);
+
+/**
+ * ai_stream_reader_read_async:
+ * @self: an #AiStreamReader
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): called when the read is done
+ * @user_data: data for @callback
+ *
+ * Reads the next block of the stream and calls the event function for
+ * every event it completes. Events held back by the event function are
+ * dispatched first, without reading, if any are left.
+ *
+ * At the end of the stream, a last event without a terminating blank
+ * line or newline is dispatched as well.
+ */
+void
+ai_stream_reader_read_async(
+    AiStreamReader      *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+);
+
+/**
+ * ai_stream_reader_read_finish:
+ * @self: an #AiStreamReader
+ * @result: the #GAsyncResult
+ * @error: return location for a #GError
+ *
+ * Finishes a read.
+ *
+ * Returns: %TRUE if more events may follow, so the caller should read
+ *   again; %FALSE at the end of the stream, or on error with @error set
+ */
+gboolean
+ai_stream_reader_read_finish(
+    AiStreamReader  *self,
+    GAsyncResult    *result,
+    GError         **error
+);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(AiStreamReader, ai_stream_reader_free)
+
+G_END_DECLS
@@ -0,0 +1,886 @@
+/*
+ * ai-stream.c - Pull-based reading of a streamed response
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include "core/ai-stream.h"
+#include "core/ai-session-pool.h"
+
+#define DEFAULT_CAPACITY 64
+
+static const GEnumValue stream_item_type_values[] = {
+    { AI_STREAM_ITEM_TEXT,       "AI_STREAM_ITEM_TEXT",       "text" },
+    { AI_STREAM_ITEM_TOOL_INPUT, "AI_STREAM_ITEM_TOOL_INPUT", "tool-input" },
+    { AI_STREAM_ITEM_TOOL_USE,   "AI_STREAM_ITEM_TOOL_USE",   "tool-use" },
+    { AI_STREAM_ITEM_USAGE,      "AI_STREAM_ITEM_USAGE",      "usage" },
+    { AI_STREAM_ITEM_STOP,       "AI_STREAM_ITEM_STOP",       "stop" },
+    { 0, NULL, NULL }
+};
+
+GType
+ai_stream_item_type_get_type(void)
+{
+    static GType type = 0;
+
+    if (g_once_init_enter(&type))
+    {
+        GType t = g_enum_register_static("AiStreamItemType", stream_item_type_values);
+        g_once_init_leave(&type, t);
+    }
+
+    return type;
+}
+
+G_DEFINE_BOXED_TYPE(AiStreamItem, ai_stream_item, ai_stream_item_copy, ai_stream_item_free)
+
+/**
+ * ai_stream_item_new:
+ * @type: the kind of item
+ *
+ * Creates an empty item.
+ *
+ * Returns: (transfer full): a new #AiStreamItem
+ */
+AiStreamItem *
+ai_stream_item_new(AiStreamItemType type)
+{
+    AiStreamItem *self;
+
+    self = g_slice_new0(AiStreamItem);
+    self->type = type;
+
+    return self;
+}
+
+/**
+ * ai_stream_item_copy:
+ * @self: an #AiStreamItem
+ *
+ * Copies an item.
+ *
+ * Returns: (transfer full): a copy of @self
+ */
+AiStreamItem *
+ai_stream_item_copy(const AiStreamItem *self)
+{
+    AiStreamItem *copy;
+
+    g_return_val_if_fail(self != NULL, NULL);
+
+    copy = g_slice_dup(AiStreamItem, self);
+    copy->text = g_strdup(self->text);
+    copy->tool_id = g_strdup(self->tool_id);
+    if (self->tool_use != NULL)
+    {
+        g_object_ref(self->tool_use);
+    }
+    if (self->usage != NULL)
+    {
+        copy->usage = ai_usage_copy(self->usage);
+    }
+    if (self->response != NULL)
+    {
+        g_object_ref(self->response);
+    }
+
+    return copy;
+}
+
+/**
+ * ai_stream_item_free:
+ * @self: (nullable): an #AiStreamItem
+ *
+ * Frees an item.
+ */
+void
+ai_stream_item_free(AiStreamItem *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+
+    g_free(self->text);
+    g_free(self->tool_id);
+    g_clear_object(&self->tool_use);
+    g_clear_pointer(&self->usage, ai_usage_free);
+    g_clear_object(&self->response);
+    g_slice_free(AiStreamItem, self);
+}
+
+/*
+ * The queue is shared by the I/O thread, which pushes, and whichever
+ * thread takes items off; everything below the mutex is guarded by it.
+ */
+struct _AiStream
+{
+    GObject parent_instance;
+
+    guint         capacity;
+    GCancellable *cancellable;      /* stops the request */
+    GCancellable *parent;           /* the caller's, nullable */
+    gulong        parent_handler;
+
+    GMutex        mutex;
+    GCond         cond;
+    GQueue        items;
+    gboolean      pushed;           /* the client queued items itself */
+    gboolean      stopped;          /* the stop item is queued */
+    gboolean      done;             /* the request has returned */
+    GError       *error;
+
+    GTask        *waiter;           /* a pending ai_stream_next_item_async() */
+    GSource      *waiter_source;    /* its cancellable's, nullable */
+
+    GSourceFunc   resume;           /* set while the client waits for space */
+    gpointer      resume_data;
+    GMainContext *resume_context;
+};
+
+G_DEFINE_TYPE(AiStream, ai_stream, G_TYPE_OBJECT)
+
+/*
+ * Streams run their requests on one thread with its own context and
+ * sessions, so the thread that takes the items off needs no main loop.
+ */
+static gpointer
+stream_thread(gpointer user_data)
+{
+    GMainContext *context = user_data;
+
+    g_main_context_push_thread_default(context);
+    ai_session_pool_set_thread_local(TRUE);
+
+    for (;;)
+    {
+        g_main_context_iteration(context, TRUE);
+    }
+
+    return NULL;
+}
+
+static GMainContext *
+get_stream_context(void)
+{
+    static gsize initialized = 0;
+    static GMainContext *context = NULL;
+
+    if (g_once_init_enter(&initialized))
+    {
+        context = g_main_context_new();
+        g_thread_unref(g_thread_new("ai-stream", stream_thread, context));
+        g_once_init_leave(&initialized, 1);
+    }
+
+    return context;
+}
+
+/*
+ * Calls the client's resume function, taken from the stream under the
+ * lock, on the client's context.
+ */
+static void
+schedule_resume(
+    GSourceFunc   resume,
+    gpointer      resume_data,
+    GMainContext *context
+){
+    GSource *source;
+
+    source = g_idle_source_new();
+    g_source_set_callback(source, resume, resume_data, NULL);
+    g_source_attach(source, context);
+    g_source_unref(source);
+    g_main_context_unref(context);
+}
+
+/*
+ * Takes the next item for a consumer. Called with the lock held.
+ * Returns TRUE if there is an answer: an item, or the end of the
+ * stream with or without an error.
+ */
+static gboolean
+pop_locked(
+    AiStream      *self,
+    AiStreamItem **item,
+    GError       **error,
+    GSourceFunc   *resume,
+    gpointer      *resume_data,
+    GMainContext **resume_context
+){
+    *item = g_queue_pop_head(&self->items);
+    if (*item == NULL && !self->done)
+    {
+        return FALSE;
+    }
+
+    if (*item == NULL && self->error != NULL)
+    {
+        g_propagate_error(error, g_error_copy(self->error));
+    }
+
+    /* Let the client read again once half the queue is free */
+    if (self->resume != NULL && self->items.length <= self->capacity / 2)
+    {
+        *resume = self->resume;
+        *resume_data = self->resume_data;
+        *resume_context = self->resume_context;
+        self->resume = NULL;
+        self->resume_context = NULL;
+    }
+
+    return TRUE;
+}
+
+/*
+ * Answers a pending async wait, if there is an answer for it. Called
+ * with the lock held; the task is returned to after the lock is
+ * dropped.
+ */
+static void
+wake_locked(
+    AiStream      *self,
+    GTask        **task,
+    GSource      **source,
+    AiStreamItem **item,
+    GError       **error,
+    GSourceFunc   *resume,
+    gpointer      *resume_data,
+    GMainContext **resume_context
+){
+    g_cond_broadcast(&self->cond);
+
+    if (self->waiter == NULL)
+    {
+        return;
+    }
+    if (!pop_locked(self, item, error, resume, resume_data, resume_context))
+    {
+        return;
+    }
+
+    *task = g_steal_pointer(&self->waiter);
+    *source = g_steal_pointer(&self->waiter_source);
+}
+
+static void
+return_item(
+    GTask        *task,
+    GSource      *source,
+    AiStreamItem *item,
+    GError       *error
+){
+    if (source != NULL)
+    {
+        g_source_destroy(source);
+        g_source_unref(source);
+    }
+
+    if (error != NULL)
+    {
+        g_task_return_error(task, error);
+    }
+    else
+    {
+        g_task_return_pointer(task, item, (GDestroyNotify)ai_stream_item_free);
+    }
+    g_object_unref(task);
+}
+
+/*
+ * Queues an item, or the end of the stream if @item is NULL, and
+ * answers a consumer that waits for it.
+ */
+static void
+push_item(
+    AiStream     *self,
+    AiStreamItem *item,
+    gboolean      done
+){
+    GTask *task = NULL;
+    GSource *source = NULL;
+    AiStreamItem *next = NULL;
+    GError *error = NULL;
+    GSourceFunc resume = NULL;
+    gpointer resume_data = NULL;
+    GMainContext *resume_context = NULL;
+
+    g_mutex_lock(&self->mutex);
+    if (item != NULL)
+    {
+        if (item->type == AI_STREAM_ITEM_STOP)
+        {
+            self->stopped = TRUE;
+        }
+        g_queue_push_tail(&self->items, item);
+    }
+    if (done)
+    {
+        self->done = TRUE;
+    }
+    wake_locked(self, &task, &source, &next, &error, &resume, &resume_data, &resume_context);
+    g_mutex_unlock(&self->mutex);
+
+    if (task != NULL)
+    {
+        return_item(task, source, next, error);
+    }
+    if (resume != NULL)
+    {
+        schedule_resume(resume, resume_data, resume_context);
+    }
+}
+
+/*
+ * The whole response, for clients that did not queue it as it came.
+ */
+static void
+push_response(
+    AiStream   *self,
+    AiResponse *response
+){
+    AiStreamItem *item;
+    g_autofree gchar *text = NULL;
+    GList *tool_uses;
+    GList *l;
+
+    text = ai_response_get_text(response);
+    if (text != NULL && text[0] != '\0')
+    {
+        item = ai_stream_item_new(AI_STREAM_ITEM_TEXT);
+        item->text = g_steal_pointer(&text);
+        push_item(self, item, FALSE);
+    }
+
+    tool_uses = ai_response_get_tool_uses(response);
+    for (l = tool_uses; l != NULL; l = l->next)
+    {
+        item = ai_stream_item_new(AI_STREAM_ITEM_TOOL_USE);
+        item->tool_use = g_object_ref(l->data);
+        push_item(self, item, FALSE);
+    }
+    g_list_free(tool_uses);
+
+    ai_stream_push_end(self, response);
+}
+
+static void
+ai_stream_dispose(GObject *object)
+{
+    AiStream *self = AI_STREAM(object);
+    GSourceFunc resume;
+    gpointer resume_data;
+    GMainContext *resume_context;
+
+    if (self->parent_handler != 0)
+    {
+        g_cancellable_disconnect(self->parent, self->parent_handler);
+        self->parent_handler = 0;
+    }
+
+    /* Nobody reads on, so stop the request and wake a paused client */
+    g_cancellable_cancel(self->cancellable);
+
+    g_mutex_lock(&self->mutex);
+    resume = self->resume;
+    resume_data = self->resume_data;
+    resume_context = self->resume_context;
+    self->resume = NULL;
+    self->resume_context = NULL;
+    g_mutex_unlock(&self->mutex);
+
+    if (resume != NULL)
+    {
+        schedule_resume(resume, resume_data, resume_context);
+    }
+
+    G_OBJECT_CLASS(ai_stream_parent_class)->dispose(object);
+}
+
+static void
+ai_stream_finalize(GObject *object)
+{
+    AiStream *self = AI_STREAM(object);
+
+    g_queue_clear_full(&self->items, (GDestroyNotify)ai_stream_item_free);
+    g_clear_error(&self->error);
+    g_clear_object(&self->cancellable);
+    g_clear_object(&self->parent);
+    g_mutex_clear(&self->mutex);
+    g_cond_clear(&self->cond);
+
+    G_OBJECT_CLASS(ai_stream_parent_class)->finalize(object);
+}
+
+static void
+ai_stream_class_init(AiStreamClass *klass)
+{
+    GObjectClass *object_class = G_OBJECT_CLASS(klass);
+
+    object_class->dispose = ai_stream_dispose;
+    object_class->finalize = ai_stream_finalize;
+}
+
+static void
+ai_stream_init(AiStream *self)
+{
+    self->cancellable = g_cancellable_new();
+    g_mutex_init(&self->mutex);
+    g_cond_init(&self->cond);
+    g_queue_init(&self->items);
+}
+
+/*
+ * Data for the request of one stream, which lives on the I/O thread.
+ * It only has a weak reference to the stream, so that dropping the
+ * stream stops the request.
+ */
+typedef struct
+{
+    GWeakRef          stream;
+    AiStreamable     *client;
+    GList            *messages;
+    AiRequestOptions *options;
+    GCancellable     *cancellable;
+} StreamRequest;
+
+static void
+stream_request_free(StreamRequest *request)
+{
+    g_weak_ref_clear(&request->stream);
+    g_clear_object(&request->client);
+    g_list_free_full(request->messages, g_object_unref);
+    g_clear_pointer(&request->options, ai_request_options_free);
+    g_clear_object(&request->cancellable);
+    g_slice_free(StreamRequest, request);
+}
+
+static void
+on_request_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    StreamRequest *request = user_data;
+    g_autoptr(AiStream) self = NULL;
+    g_autoptr(AiResponse) response = NULL;
+    g_autoptr(GError) error = NULL;
+    gboolean complete;
+
+    response = ai_streamable_chat_stream_finish(AI_STREAMABLE(source), result, &error);
+
+    self = g_weak_ref_get(&request->stream);
+    stream_request_free(request);
+    if (self == NULL)
+    {
+        return;
+    }
+
+    g_mutex_lock(&self->mutex);
+    if (response == NULL)
+    {
+        self->error = g_steal_pointer(&error);
+    }
+    complete = self->stopped;
+    g_mutex_unlock(&self->mutex);
+
+    /* A client that queued the items itself may still owe the end */
+    if (response != NULL && !complete)
+    {
+        if (self->pushed)
+        {
+            ai_stream_push_end(self, response);
+        }
+        else
+        {
+            push_response(self, response);
+        }
+    }
+
+    push_item(self, NULL, TRUE);
+}
+
+static gboolean
+on_request_start(gpointer user_data)
+{
+    StreamRequest *request = user_data;
+
+    ai_streamable_chat_stream_with_options_async(request->client,
+                                                 request->messages,
+                                                 request->options,
+                                                 request->cancellable,
+                                                 on_request_done,
+                                                 request);
+
+    /* The client has taken what it needs; the stream must not be kept alive */
+    ai_request_options_set_stream(request->options, NULL);
+
+    return G_SOURCE_REMOVE;
+}
+
+static void
+on_parent_cancelled(
+    GCancellable *parent,
+    gpointer      user_data
+){
+    GCancellable *cancellable = user_data;
+
+    (void)parent;
+
+    g_cancellable_cancel(cancellable);
+}
+
+/**
+ * ai_stream_new:
+ * @client: the #AiStreamable to send the request with
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the request's #AiRequestOptions
+ * @capacity: the queue's capacity, or 0 for the default
+ * @cancellable: (nullable): a #GCancellable
+ *
+ * Starts a streaming request on the I/O thread.
+ *
+ * Returns: (transfer full): a new #AiStream
+ */
+AiStream *
+ai_stream_new(
+    AiStreamable           *client,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    guint                   capacity,
+    GCancellable           *cancellable
+){
+    AiStream *self;
+    StreamRequest *request;
+
+    g_return_val_if_fail(AI_IS_STREAMABLE(client), NULL);
+    g_return_val_if_fail(cancellable == NULL || G_IS_CANCELLABLE(cancellable), NULL);
+
+    self = g_object_new(AI_TYPE_STREAM, NULL);
+    self->capacity = capacity > 0 ? capacity : DEFAULT_CAPACITY;
+
+    if (cancellable != NULL)
+    {
+        self->parent = g_object_ref(cancellable);
+        self->parent_handler = g_cancellable_connect(cancellable,
+                                                     G_CALLBACK(on_parent_cancelled),
+                                                     self->cancellable, NULL);
+    }
+
+    request = g_slice_new0(StreamRequest);
+    g_weak_ref_init(&request->stream, self);
+    request->client = g_object_ref(client);
+    request->messages = g_list_copy_deep(messages, (GCopyFunc)g_object_ref, NULL);
+    request->options = options != NULL ? ai_request_options_copy(options) : ai_request_options_new();
+    request->cancellable = g_object_ref(self->cancellable);
+    ai_request_options_set_stream(request->options, self);
+
+    g_main_context_invoke(get_stream_context(), on_request_start, request);
+
+    return self;
+}
+
+/**
+ * ai_stream_get_capacity:
+ * @self: an #AiStream
+ *
+ * Gets the queue's capacity.
+ *
+ * Returns: the capacity
+ */
+guint
+ai_stream_get_capacity(AiStream *self)
+{
+    g_return_val_if_fail(AI_IS_STREAM(self), 0);
+
+    return self->capacity;
+}
+
+/**
+ * ai_stream_next_item:
+ * @self: an #AiStream
+ * @timeout_ms: the longest wait in milliseconds, or -1
+ * @error: return location for a #GError
+ *
+ * Takes the next item off the stream, blocking until there is one.
+ *
+ * Returns: (transfer full) (nullable): the next #AiStreamItem, or %NULL
+ */
+AiStreamItem *
+ai_stream_next_item(
+    AiStream  *self,
+    gint       timeout_ms,
+    GError   **error
+){
+    AiStreamItem *item = NULL;
+    GSourceFunc resume = NULL;
+    gpointer resume_data = NULL;
+    GMainContext *resume_context = NULL;
+    gint64 end_time;
+
+    g_return_val_if_fail(AI_IS_STREAM(self), NULL);
+    g_return_val_if_fail(error == NULL || *error == NULL, NULL);
+
+    end_time = timeout_ms >= 0 ? g_get_monotonic_time() + timeout_ms * G_TIME_SPAN_MILLISECOND : 0;
+
+    g_mutex_lock(&self->mutex);
+    while (!pop_locked(self, &item, error, &resume, &resume_data, &resume_context))
+    {
+        if (timeout_ms < 0)
+        {
+            g_cond_wait(&self->cond, &self->mutex);
+        }
+        else if (!g_cond_wait_until(&self->cond, &self->mutex, end_time))
+        {
+            if (pop_locked(self, &item, error, &resume, &resume_data, &resume_context))
+            {
+                break;
+            }
+            g_set_error(error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT,
+                        "No stream item within %d ms", timeout_ms);
+            break;
+        }
+    }
+    g_mutex_unlock(&self->mutex);
+
+    if (resume != NULL)
+    {
+        schedule_resume(resume, resume_data, resume_context);
+    }
+
+    return item;
+}
+
+static gboolean
+on_wait_cancelled(
+    GCancellable *cancellable,
+    gpointer      user_data
+){
+    AiStream *self = user_data;
+    GTask *task;
+    GSource *source;
+
+    (void)cancellable;
+
+    g_mutex_lock(&self->mutex);
+    task = g_steal_pointer(&self->waiter);
+    source = g_steal_pointer(&self->waiter_source);
+    g_mutex_unlock(&self->mutex);
+
+    if (task != NULL)
+    {
+        g_task_return_error_if_cancelled(task);
+        g_object_unref(task);
+    }
+    if (source != NULL)
+    {
+        g_source_unref(source);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * ai_stream_next_item_async:
+ * @self: an #AiStream
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): called with the next item
+ * @user_data: data for @callback
+ *
+ * Waits for the next item without blocking.
+ */
+void
+ai_stream_next_item_async(
+    AiStream            *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    GTask *task;
+    AiStreamItem *item = NULL;
+    GError *error = NULL;
+    GSourceFunc resume = NULL;
+    gpointer resume_data = NULL;
+    GMainContext *resume_context = NULL;
+    gboolean ready;
+
+    g_return_if_fail(AI_IS_STREAM(self));
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_stream_next_item_async);
+
+    if (g_task_return_error_if_cancelled(task))
+    {
+        g_object_unref(task);
+        return;
+    }
+
+    g_mutex_lock(&self->mutex);
+    if (self->waiter != NULL)
+    {
+        g_mutex_unlock(&self->mutex);
+        g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_PENDING,
+                                "Another wait for a stream item is pending");
+        g_object_unref(task);
+        return;
+    }
+
+    ready = pop_locked(self, &item, &error, &resume, &resume_data, &resume_context);
+    if (!ready)
+    {
+        self->waiter = task;
+        if (cancellable != NULL)
+        {
+            self->waiter_source = g_cancellable_source_new(cancellable);
+            g_source_set_callback(self->waiter_source, (GSourceFunc)on_wait_cancelled, self, NULL);
+            g_source_attach(self->waiter_source, g_task_get_context(task));
+        }
+    }
+    g_mutex_unlock(&self->mutex);
+
+    if (ready)
+    {
+        return_item(task, NULL, item, error);
+    }
+    if (resume != NULL)
+    {
+        schedule_resume(resume, resume_data, resume_context);
+    }
+}
+
+/**
+ * ai_stream_next_item_finish:
+ * @self: an #AiStream
+ * @result: the #GAsyncResult
+ * @error: return location for a #GError
+ *
+ * Finishes a wait for the next item.
+ *
+ * Returns: (transfer full) (nullable): the next #AiStreamItem, or %NULL
+ */
+AiStreamItem *
+ai_stream_next_item_finish(
+    AiStream      *self,
+    GAsyncResult  *result,
+    GError       **error
+){
+    g_return_val_if_fail(AI_IS_STREAM(self), NULL);
+    g_return_val_if_fail(g_task_is_valid(result, self), NULL);
+
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+/**
+ * ai_stream_push:
+ * @self: an #AiStream
+ * @item: (transfer full): an #AiStreamItem
+ *
+ * Queues an item.
+ */
+void
+ai_stream_push(
+    AiStream     *self,
+    AiStreamItem *item
+){
+    g_return_if_fail(AI_IS_STREAM(self));
+    g_return_if_fail(item != NULL);
+
+    self->pushed = TRUE;
+    push_item(self, item, FALSE);
+}
+
+/**
+ * ai_stream_push_end:
+ * @self: an #AiStream
+ * @response: the complete #AiResponse
+ *
+ * Queues the usage and the stop item of @response.
+ */
+void
+ai_stream_push_end(
+    AiStream   *self,
+    AiResponse *response
+){
+    AiStreamItem *item;
+    AiUsage *usage;
+
+    g_return_if_fail(AI_IS_STREAM(self));
+    g_return_if_fail(AI_IS_RESPONSE(response));
+
+    self->pushed = TRUE;
+
+    usage = ai_response_get_usage(response);
+    if (usage != NULL)
+    {
+        item = ai_stream_item_new(AI_STREAM_ITEM_USAGE);
+        item->usage = ai_usage_copy(usage);
+        push_item(self, item, FALSE);
+    }
+
+    item = ai_stream_item_new(AI_STREAM_ITEM_STOP);
+    item->stop_reason = ai_response_get_stop_reason(response);
+    item->response = g_object_ref(response);
+    push_item(self, item, FALSE);
+}
+
+/**
+ * ai_stream_is_full:
+ * @self: an #AiStream
+ *
+ * Checks whether the queue is full.
+ *
+ * Returns: %TRUE if the queue is full
+ */
+gboolean
+ai_stream_is_full(AiStream *self)
+{
+    gboolean full;
+
+    g_return_val_if_fail(AI_IS_STREAM(self), FALSE);
+
+    g_mutex_lock(&self->mutex);
+    full = self->items.length >= self->capacity;
+    g_mutex_unlock(&self->mutex);
+
+    return full;
+}
+
+/**
+ * ai_stream_wait_for_space:
+ * @self: an #AiStream
+ * @resume: called once there is room again
+ * @user_data: data for @resume
+ *
+ * Arranges for @resume to be called if the queue is full.
+ *
+ * Returns: %TRUE if the caller must wait for @resume
+ */
+gboolean
+ai_stream_wait_for_space(
+    AiStream    *self,
+    GSourceFunc  resume,
+    gpointer     user_data
+){
+    gboolean full;
+
+    g_return_val_if_fail(AI_IS_STREAM(self), FALSE);
+    g_return_val_if_fail(resume != NULL, FALSE);
+
+    g_mutex_lock(&self->mutex);
+    full = self->items.length >= self->capacity;
+    if (full)
+    {
+        self->resume = resume;
+        self->resume_data = user_data;
+        self->resume_context = g_main_context_ref_thread_default();
+    }
+    g_mutex_unlock(&self->mutex);
+
+    return full;
+}
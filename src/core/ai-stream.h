@@ -0,0 +1,311 @@
+/*
+ * ai-stream.h - Pull-based reading of a streamed response
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ *
+ * The AiStreamable signals push a response to whoever is connected to
+ * the client, on the context the request was made from. An AiStream
+ * turns that around: it runs one request on a shared I/O thread and
+ * queues what arrives as AiStreamItems, which any thread takes off the
+ * queue when it is ready for them, blocking or asynchronously. A worker
+ * thread can consume a response without running a main loop, several
+ * requests on one client stay apart, and a slow consumer holds back
+ * the network reads instead of growing a backlog.
+ *
+ * Quick start:
+ *   g_autoptr(AiStream) stream = ai_stream_new(AI_STREAMABLE(client),
+ *                                              messages, NULL, 0, NULL);
+ *   AiStreamItem *item;
+ *
+ *   while ((item = ai_stream_next_item(stream, -1, &error)) != NULL)
+ *   {
+ *       if (item->type == AI_STREAM_ITEM_TEXT)
+ *           fputs(item->text, stdout);
+ *       ai_stream_item_free(item);
+ *   }
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+#include <gio/gio.h>
+
+#include "core/ai-enums.h"
+#include "core/ai-streamable.h"
+#include "model/ai-request-options.h"
+#include "model/ai-response.h"
+#include "model/ai-tool-use.h"
+#include "model/ai-usage.h"
+
+G_BEGIN_DECLS
+
+/**
+ * AiStreamItemType:
+ * @AI_STREAM_ITEM_TEXT: generated text, in @text
+ * @AI_STREAM_ITEM_TOOL_INPUT: part of a tool call's JSON input, in
+ *   @text, for the call @tool_id
+ * @AI_STREAM_ITEM_TOOL_USE: a tool call streamed in full, in @tool_use
+ * @AI_STREAM_ITEM_USAGE: the token usage of the response, in @usage
+ * @AI_STREAM_ITEM_STOP: the end of the response; @stop_reason says why
+ *   and @response holds the whole of it
+ *
+ * What an #AiStreamItem carries.
+ */
+typedef enum
+{
+    AI_STREAM_ITEM_TEXT = 0,
+    AI_STREAM_ITEM_TOOL_INPUT,
+    AI_STREAM_ITEM_TOOL_USE,
+    AI_STREAM_ITEM_USAGE,
+    AI_STREAM_ITEM_STOP
+} AiStreamItemType;
+
+GType ai_stream_item_type_get_type(void) G_GNUC_CONST;
+#define AI_TYPE_STREAM_ITEM_TYPE (ai_stream_item_type_get_type())
+
+/**
+ * AiStreamItem:
+ * @type: the kind of item
+ * @text: (nullable): the text of a %AI_STREAM_ITEM_TEXT or
+ *   %AI_STREAM_ITEM_TOOL_INPUT item
+ * @tool_id: (nullable): the tool call a %AI_STREAM_ITEM_TOOL_INPUT
+ *   item belongs to
+ * @tool_use: (nullable): the tool call of a %AI_STREAM_ITEM_TOOL_USE item
+ * @usage: (nullable): the usage of a %AI_STREAM_ITEM_USAGE item
+ * @stop_reason: the stop reason of a %AI_STREAM_ITEM_STOP item
+ * @response: (nullable): the complete response, on a
+ *   %AI_STREAM_ITEM_STOP item
+ *
+ * One piece of a streamed response. Only the fields of its @type are
+ * set; the item owns all of them.
+ */
+typedef struct _AiStreamItem AiStreamItem;
+
+struct _AiStreamItem
+{
+    AiStreamItemType  type;
+    gchar            *text;
+    gchar            *tool_id;
+    AiToolUse        *tool_use;
+    AiUsage          *usage;
+    AiStopReason      stop_reason;
+    AiResponse       *response;
+};
+
+GType ai_stream_item_get_type(void) G_GNUC_CONST;
+#define AI_TYPE_STREAM_ITEM (ai_stream_item_get_type())
+
+/**
+ * ai_stream_item_new:
+ * @type: the kind of item
+ *
+ * Creates an item with all fields but @type unset.
+ *
+ * Returns: (transfer full): a new #AiStreamItem
+ */
+AiStreamItem *
+ai_stream_item_new(AiStreamItemType type);
+
+/**
+ * ai_stream_item_copy:
+ * @self: an #AiStreamItem
+ *
+ * Copies an item.
+ *
+ * Returns: (transfer full): a copy of @self
+ */
+AiStreamItem *
+ai_stream_item_copy(const AiStreamItem *self);
+
+/**
+ * ai_stream_item_free:
+ * @self: (nullable): an #AiStreamItem
+ *
+ * Frees an item and everything it holds.
+ */
+void
+ai_stream_item_free(AiStreamItem *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(AiStreamItem, ai_stream_item_free)
+
+#define AI_TYPE_STREAM (ai_stream_get_type())
+
+G_DECLARE_FINAL_TYPE(AiStream, ai_stream, AI, STREAM, GObject)
+
+/**
+ * ai_stream_new:
+ * @client: the #AiStreamable to send the request with
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the request's #AiRequestOptions
+ * @capacity: how many items to queue before the network reads pause,
+ *   or 0 for the default of 64
+ * @cancellable: (nullable): a #GCancellable that stops the request
+ *
+ * Starts a streaming request on the shared I/O thread and returns the
+ * stream its items arrive on. Any thread may take them off.
+ *
+ * The HTTP clients queue text, tool calls and the end of the response
+ * as they stream in, and emit none of the #AiStreamable signals for
+ * the request. Other clients, such as the CLI clients or an
+ * #AiFailoverProvider, still emit their signals, on the I/O thread,
+ * and the stream gets the whole response at once when it is done.
+ *
+ * Dropping the last reference to the stream cancels the request.
+ *
+ * Returns: (transfer full): a new #AiStream
+ */
+AiStream *
+ai_stream_new(
+    AiStreamable           *client,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    guint                   capacity,
+    GCancellable           *cancellable
+);
+
+/**
+ * ai_stream_get_capacity:
+ * @self: an #AiStream
+ *
+ * Gets how many items are queued before the network reads pause.
+ *
+ * Returns: the capacity
+ */
+guint
+ai_stream_get_capacity(AiStream *self);
+
+/**
+ * ai_stream_next_item:
+ * @self: an #AiStream
+ * @timeout_ms: how long to wait, in milliseconds, or -1 to wait until
+ *   an item arrives or the stream ends
+ * @error: return location for a #GError
+ *
+ * Takes the next item off the stream, waiting for one if the queue is
+ * empty. Blocks the calling thread, which must not be the I/O thread;
+ * a thread that runs a main loop is better served by
+ * ai_stream_next_item_async().
+ *
+ * Returns: (transfer full) (nullable): the next #AiStreamItem; %NULL
+ *   without @error set at the end of the stream, or %NULL with @error
+ *   set if the request failed or, as %G_IO_ERROR_TIMED_OUT, if no item
+ *   came within @timeout_ms
+ */
+AiStreamItem *
+ai_stream_next_item(
+    AiStream  *self,
+    gint       timeout_ms,
+    GError   **error
+);
+
+/**
+ * ai_stream_next_item_async:
+ * @self: an #AiStream
+ * @cancellable: (nullable): a #GCancellable that stops the wait, but
+ *   not the request
+ * @callback: (scope async): called when an item is there or the stream
+ *   has ended
+ * @user_data: data for @callback
+ *
+ * Takes the next item off the stream without blocking. @callback runs
+ * on the thread-default main context of the caller. Only one wait may
+ * be pending at a time.
+ */
+void
+ai_stream_next_item_async(
+    AiStream            *self,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+);
+
+/**
+ * ai_stream_next_item_finish:
+ * @self: an #AiStream
+ * @result: the #GAsyncResult
+ * @error: return location for a #GError
+ *
+ * Finishes a wait started with ai_stream_next_item_async().
+ *
+ * Returns: (transfer full) (nullable): the next #AiStreamItem; %NULL
+ *   without @error set at the end of the stream, or %NULL with @error
+ *   set if the request failed or the wait was cancelled
+ */
+AiStreamItem *
+ai_stream_next_item_finish(
+    AiStream      *self,
+    GAsyncResult  *result,
+    GError       **error
+);
+
+/**
+ * ai_stream_push:
+ * @self: an #AiStream
+ * @item: (transfer full): the item to queue
+ *
+ * Queues an item. For client implementations, which normally go
+ * through their #AiDeltaBuffer instead. A push never blocks and never
+ * fails; ai_stream_is_full() and ai_stream_wait_for_space() tell the
+ * client when to pause.
+ */
+void
+ai_stream_push(
+    AiStream     *self,
+    AiStreamItem *item
+);
+
+/**
+ * ai_stream_push_end:
+ * @self: an #AiStream
+ * @response: the complete #AiResponse
+ *
+ * Queues the usage of @response, if it has any, and the
+ * %AI_STREAM_ITEM_STOP item.
+ */
+void
+ai_stream_push_end(
+    AiStream   *self,
+    AiResponse *response
+);
+
+/**
+ * ai_stream_is_full:
+ * @self: an #AiStream
+ *
+ * Checks whether the queue holds as many items as its capacity. A
+ * client stops handing out events once this is %TRUE.
+ *
+ * Returns: %TRUE if the queue is full
+ */
+gboolean
+ai_stream_is_full(AiStream *self);
+
+/**
+ * ai_stream_wait_for_space:
+ * @self: an #AiStream
+ * @resume: called once the consumer has emptied half of the queue
+ * @user_data: data for @resume
+ *
+ * Before reading from the network, a client checks here whether the
+ * queue is full. If it is, @resume is called on the caller's
+ * thread-default main context once there is room again, or once the
+ * stream is dropped; the client reads from there.
+ *
+ * Returns: %TRUE if the client must wait for @resume, %FALSE if it can
+ *   read now, in which case @resume is never called
+ */
+gboolean
+ai_stream_wait_for_space(
+    AiStream    *self,
+    GSourceFunc  resume,
+    gpointer     user_data
+);
+
+G_END_DECLS
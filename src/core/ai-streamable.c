@@ -10,6 +10,7 @@
 #include "config.h"
 
 #include "core/ai-streamable.h"
+#include "core/ai-deadline.h"
 
 G_DEFINE_INTERFACE(AiStreamable, ai_streamable, G_TYPE_OBJECT)
 
@@ -22,6 +23,7 @@ enum
     SIGNAL_STREAM_START,
     SIGNAL_STREAM_END,
     SIGNAL_TOOL_USE,
+    SIGNAL_TOOL_INPUT_DELTA,
     N_SIGNALS
 };
 
@@ -86,7 +88,8 @@ ai_streamable_default_init(AiStreamableInterface *iface)
      * @self: the object that received the signal
      * @tool_use: the tool use request
      *
-     * Emitted when a tool use request is detected in the stream.
+     * Emitted as soon as a tool use request has been streamed in full,
+     * while the rest of the response may still be generating.
      */
     signals[SIGNAL_TOOL_USE] =
         g_signal_new("tool-use",
@@ -97,6 +100,28 @@ ai_streamable_default_init(AiStreamableInterface *iface)
                      NULL,
                      G_TYPE_NONE, 1,
                      G_TYPE_OBJECT);
+
+    /**
+     * AiStreamable::tool-input-delta:
+     * @self: the object that received the signal
+     * @tool_id: the ID of the tool use being streamed
+     * @partial_json: the next piece of its input, as JSON text
+     *
+     * Emitted for each piece of a tool use's input as it is received.
+     * The pieces joined together form the input of the #AiToolUse later
+     * passed to #AiStreamable::tool-use; on their own they are not valid
+     * JSON.
+     */
+    signals[SIGNAL_TOOL_INPUT_DELTA] =
+        g_signal_new("tool-input-delta",
+                     G_TYPE_FROM_INTERFACE(iface),
+                     G_SIGNAL_RUN_LAST,
+                     0,
+                     NULL, NULL,
+                     NULL,
+                     G_TYPE_NONE, 2,
+                     G_TYPE_STRING,
+                     G_TYPE_STRING);
 }
 
 /**
@@ -136,6 +161,113 @@ ai_streamable_chat_stream_async(
                              cancellable, callback, user_data);
 }
 
+static void
+start_chat_stream(
+    AiStreamable           *self,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
+){
+    AiStreamableInterface *iface = AI_STREAMABLE_GET_IFACE(self);
+
+    if (iface->chat_stream_with_options_async != NULL)
+    {
+        iface->chat_stream_with_options_async(self, messages, options,
+                                              cancellable, callback, user_data);
+        return;
+    }
+
+    g_return_if_fail(iface->chat_stream_async != NULL);
+
+    iface->chat_stream_async(self, messages,
+                             options != NULL ? ai_request_options_get_system_prompt(options) : NULL,
+                             options != NULL ? ai_request_options_get_max_tokens(options) : 0,
+                             options != NULL ? ai_request_options_get_tools(options) : NULL,
+                             cancellable, callback, user_data);
+}
+
+static void
+on_deadline_stream_done(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GTask *task = G_TASK(user_data);
+    AiDeadline *deadline = g_task_get_task_data(task);
+    GError *error = NULL;
+    AiResponse *response;
+
+    response = AI_STREAMABLE_GET_IFACE(source)->chat_stream_finish(AI_STREAMABLE(source),
+                                                                   result, &error);
+    if (response == NULL)
+    {
+        ai_deadline_translate_error(deadline, &error);
+        g_task_return_error(task, error);
+    }
+    else
+    {
+        g_task_return_pointer(task, response, g_object_unref);
+    }
+
+    g_object_unref(task);
+}
+
+/**
+ * ai_streamable_chat_stream_with_options_async:
+ * @self: an #AiStreamable
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the #AiRequestOptions
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): callback to call when done
+ * @user_data: user data for the callback
+ *
+ * Starts an asynchronous streaming chat completion request with
+ * @options. Call ai_streamable_chat_stream_finish() from the callback.
+ *
+ * A deadline in @options covers the whole stream, not only the wait
+ * for the response headers. Deltas emitted before it passed stay
+ * delivered; the request then fails with %AI_ERROR_TIMEOUT.
+ */
+void
+ai_streamable_chat_stream_with_options_async(
+    AiStreamable           *self,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
+){
+    AiDeadline *deadline;
+    GError *error = NULL;
+    GTask *task;
+
+    g_return_if_fail(AI_IS_STREAMABLE(self));
+
+    if (options == NULL || ai_request_options_get_deadline(options) == 0)
+    {
+        start_chat_stream(self, messages, options, cancellable, callback, user_data);
+        return;
+    }
+
+    task = g_task_new(self, cancellable, callback, user_data);
+    g_task_set_source_tag(task, ai_streamable_chat_stream_with_options_async);
+
+    deadline = ai_deadline_new(ai_request_options_get_deadline(options), cancellable);
+    g_task_set_task_data(task, deadline, (GDestroyNotify)ai_deadline_free);
+
+    if (!ai_deadline_check(deadline, &error))
+    {
+        g_task_return_error(task, error);
+        g_object_unref(task);
+        return;
+    }
+
+    start_chat_stream(self, messages, options, ai_deadline_get_cancellable(deadline),
+                      on_deadline_stream_done, task);
+}
+
 /**
  * ai_streamable_chat_stream_finish:
  * @self: an #AiStreamable
@@ -156,8 +288,97 @@ ai_streamable_chat_stream_finish(
 
     g_return_val_if_fail(AI_IS_STREAMABLE(self), NULL);
 
+    if (g_async_result_is_tagged(result, ai_streamable_chat_stream_with_options_async))
+    {
+        return g_task_propagate_pointer(G_TASK(result), error);
+    }
+
     iface = AI_STREAMABLE_GET_IFACE(self);
     g_return_val_if_fail(iface->chat_stream_finish != NULL, NULL);
 
     return iface->chat_stream_finish(self, result, error);
 }
+
+/**
+ * ai_streamable_emit_delta:
+ * @self: an #AiStreamable
+ * @text: the new text
+ *
+ * Emits #AiStreamable::delta by its cached signal ID.
+ */
+void
+ai_streamable_emit_delta(
+    AiStreamable *self,
+    const gchar  *text
+){
+    g_return_if_fail(AI_IS_STREAMABLE(self));
+
+    g_signal_emit(self, signals[SIGNAL_DELTA], 0, text);
+}
+
+/**
+ * ai_streamable_emit_stream_start:
+ * @self: an #AiStreamable
+ *
+ * Emits #AiStreamable::stream-start.
+ */
+void
+ai_streamable_emit_stream_start(AiStreamable *self)
+{
+    g_return_if_fail(AI_IS_STREAMABLE(self));
+
+    g_signal_emit(self, signals[SIGNAL_STREAM_START], 0);
+}
+
+/**
+ * ai_streamable_emit_stream_end:
+ * @self: an #AiStreamable
+ * @response: the complete response
+ *
+ * Emits #AiStreamable::stream-end.
+ */
+void
+ai_streamable_emit_stream_end(
+    AiStreamable *self,
+    AiResponse   *response
+){
+    g_return_if_fail(AI_IS_STREAMABLE(self));
+
+    g_signal_emit(self, signals[SIGNAL_STREAM_END], 0, response);
+}
+
+/**
+ * ai_streamable_emit_tool_use:
+ * @self: an #AiStreamable
+ * @tool_use: the tool use
+ *
+ * Emits #AiStreamable::tool-use.
+ */
+void
+ai_streamable_emit_tool_use(
+    AiStreamable *self,
+    AiToolUse    *tool_use
+){
+    g_return_if_fail(AI_IS_STREAMABLE(self));
+
+    g_signal_emit(self, signals[SIGNAL_TOOL_USE], 0, tool_use);
+}
+
+/**
+ * ai_streamable_emit_tool_input_delta:
+ * @self: an #AiStreamable
+ * @tool_id: the ID of the tool use
+ * @partial_json: the next piece of its input
+ *
+ * Emits #AiStreamable::tool-input-delta.
+ */
+void
+ai_streamable_emit_tool_input_delta(
+    AiStreamable *self,
+    const gchar  *tool_id,
+    const gchar  *partial_json
+){
+    g_return_if_fail(AI_IS_STREAMABLE(self));
+
+    g_signal_emit(self, signals[SIGNAL_TOOL_INPUT_DELTA], 0, tool_id, partial_json);
+}
@@ -17,6 +17,7 @@
 #include <gio/gio.h>
 
 #include "model/ai-message.h"
+#include "model/ai-request-options.h"
 #include "model/ai-response.h"
 #include "model/ai-tool.h"
 
@@ -31,6 +32,8 @@ G_DECLARE_INTERFACE(AiStreamable, ai_streamable, AI, STREAMABLE, GObject)
  * @parent_iface: the parent interface
  * @chat_stream_async: starts a streaming chat completion
  * @chat_stream_finish: finishes a streaming chat completion
+ * @chat_stream_with_options_async: starts a streaming chat completion
+ *   with #AiRequestOptions; finished with @chat_stream_finish
  * @_reserved: reserved for future expansion
  *
  * Interface for streaming AI responses.
@@ -39,7 +42,9 @@ G_DECLARE_INTERFACE(AiStreamable, ai_streamable, AI, STREAMABLE, GObject)
  * - "delta": (gchar *text) - emitted when new text is received
  * - "stream-start": () - emitted when streaming starts
  * - "stream-end": (AiResponse *response) - emitted when streaming ends
- * - "tool-use": (AiToolUse *tool_use) - emitted when a tool use is detected
+ * - "tool-use": (AiToolUse *tool_use) - emitted when a tool use is complete
+ * - "tool-input-delta": (gchar *tool_id, gchar *partial_json) - emitted
+ *   for each piece of a tool use's input
  */
 struct _AiStreamableInterface
 {
@@ -58,8 +63,15 @@ struct _AiStreamableInterface
                                         GAsyncResult        *result,
                                         GError             **error);
 
+    void         (*chat_stream_with_options_async)(AiStreamable           *self,
+                                                   GList                  *messages,
+                                                   const AiRequestOptions *options,
+                                                   GCancellable           *cancellable,
+                                                   GAsyncReadyCallback     callback,
+                                                   gpointer                user_data);
+
     /* Reserved for future expansion */
-    gpointer _reserved[8];
+    gpointer _reserved[7];
 };
 
 /**
@@ -89,6 +101,37 @@ ai_streamable_chat_stream_async(
     gpointer             user_data
 );
 
+/**
+ * ai_streamable_chat_stream_with_options_async:
+ * @self: an #AiStreamable
+ * @messages: (element-type AiMessage): the conversation messages
+ * @options: (nullable): the #AiRequestOptions
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: (scope async): callback to call when done
+ * @user_data: user data for the callback
+ *
+ * Starts an asynchronous streaming chat completion request with
+ * @options, without changing the provider. Settings @options leaves
+ * unset come from the provider. Finish it with
+ * ai_streamable_chat_stream_finish().
+ *
+ * Implementations that do not support options only get the system
+ * prompt, token limit and tools of @options.
+ *
+ * A deadline in @options bounds the whole stream. When it passes, the
+ * stream is cancelled and the request fails with %AI_ERROR_TIMEOUT;
+ * the deltas already emitted are what there is of the response.
+ */
+void
+ai_streamable_chat_stream_with_options_async(
+    AiStreamable           *self,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
+);
+
 /**
  * ai_streamable_chat_stream_finish:
  * @self: an #AiStreamable
@@ -106,4 +149,69 @@ ai_streamable_chat_stream_finish(
     GError       **error
 );
 
+/**
+ * ai_streamable_emit_delta:
+ * @self: an #AiStreamable
+ * @text: the new text
+ *
+ * Emits #AiStreamable::delta. Implementations use these functions
+ * rather than g_signal_emit_by_name(), which looks the signal up by
+ * name on every call; a fast stream emits thousands of deltas.
+ */
+void
+ai_streamable_emit_delta(
+    AiStreamable *self,
+    const gchar  *text
+);
+
+/**
+ * ai_streamable_emit_stream_start:
+ * @self: an #AiStreamable
+ *
+ * Emits #AiStreamable::stream-start.
+ */
+void
+ai_streamable_emit_stream_start(AiStreamable *self);
+
+/**
+ * ai_streamable_emit_stream_end:
+ * @self: an #AiStreamable
+ * @response: the complete response
+ *
+ * Emits #AiStreamable::stream-end.
+ */
+void
+ai_streamable_emit_stream_end(
+    AiStreamable *self,
+    AiResponse   *response
+);
+
+/**
+ * ai_streamable_emit_tool_use:
+ * @self: an #AiStreamable
+ * @tool_use: the tool use
+ *
+ * Emits #AiStreamable::tool-use.
+ */
+void
+ai_streamable_emit_tool_use(
+    AiStreamable *self,
+    AiToolUse    *tool_use
+);
+
+/**
+ * ai_streamable_emit_tool_input_delta:
+ * @self: an #AiStreamable
+ * @tool_id: the ID of the tool use
+ * @partial_json: the next piece of its input
+ *
+ * Emits #AiStreamable::tool-input-delta.
+ */
+void
+ai_streamable_emit_tool_input_delta(
+    AiStreamable *self,
+    const gchar  *tool_id,
+    const gchar  *partial_json
+);
+
 G_END_DECLS
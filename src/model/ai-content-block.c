@@ -49,12 +49,28 @@ ai_content_block_real_to_json(AiContentBlock *self)
     return json_builder_get_root(builder);
 }
 
+/*
+ * Default implementation of write_json.
+ * Serializes via to_json, so subclasses that only implement to_json
+ * still work; subclasses holding large payloads override it.
+ */
+static void
+ai_content_block_real_write_json(
+    AiContentBlock *self,
+    AiJsonWriter   *writer
+){
+    g_autoptr(JsonNode) node = ai_content_block_to_json(self);
+
+    ai_json_writer_add_node(writer, node);
+}
+
 static void
 ai_content_block_class_init(AiContentBlockClass *klass)
 {
     /* Set up default virtual method implementations */
     klass->get_content_type = ai_content_block_real_get_content_type;
     klass->to_json = ai_content_block_real_to_json;
+    klass->write_json = ai_content_block_real_write_json;
 }
 
 static void
@@ -109,3 +125,28 @@ ai_content_block_to_json(AiContentBlock *self)
 
     return klass->to_json(self);
 }
+
+/**
+ * ai_content_block_write_json:
+ * @self: an #AiContentBlock
+ * @writer: the #AiJsonWriter to write to
+ *
+ * Serializes this content block straight into @writer, producing the
+ * same JSON as ai_content_block_to_json() without building and copying
+ * an intermediate #JsonNode tree.
+ */
+void
+ai_content_block_write_json(
+    AiContentBlock *self,
+    AiJsonWriter   *writer
+){
+    AiContentBlockClass *klass;
+
+    g_return_if_fail(AI_IS_CONTENT_BLOCK(self));
+    g_return_if_fail(writer != NULL);
+
+    klass = AI_CONTENT_BLOCK_GET_CLASS(self);
+    g_return_if_fail(klass->write_json != NULL);
+
+    klass->write_json(self, writer);
+}
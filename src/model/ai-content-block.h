@@ -17,6 +17,7 @@
 #include <json-glib/json-glib.h>
 
 #include "core/ai-enums.h"
+#include "core/ai-json-writer.h"
 
 G_BEGIN_DECLS
 
@@ -29,6 +30,7 @@ G_DECLARE_DERIVABLE_TYPE(AiContentBlock, ai_content_block, AI, CONTENT_BLOCK, GO
  * @parent_class: the parent class
  * @get_content_type: virtual function to get the content type
  * @to_json: virtual function to serialize to JSON
+ * @write_json: virtual function to serialize directly into an #AiJsonWriter
  * @_reserved: reserved for future expansion
  *
  * Class structure for #AiContentBlock.
@@ -40,9 +42,11 @@ struct _AiContentBlockClass
     /* Virtual methods */
     AiContentType (*get_content_type)(AiContentBlock *self);
     JsonNode *    (*to_json)         (AiContentBlock *self);
+    void          (*write_json)      (AiContentBlock *self,
+                                      AiJsonWriter   *writer);
 
     /* Reserved for future expansion */
-    gpointer _reserved[8];
+    gpointer _reserved[7];
 };
 
 /**
@@ -67,4 +71,18 @@ ai_content_block_get_content_type(AiContentBlock *self);
 JsonNode *
 ai_content_block_to_json(AiContentBlock *self);
 
+/**
+ * ai_content_block_write_json:
+ * @self: an #AiContentBlock
+ * @writer: the #AiJsonWriter to write to
+ *
+ * Serializes this content block straight into @writer, producing the
+ * same JSON as ai_content_block_to_json() without an intermediate tree.
+ */
+void
+ai_content_block_write_json(
+    AiContentBlock *self,
+    AiJsonWriter   *writer
+);
+
 G_END_DECLS
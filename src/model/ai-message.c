@@ -24,6 +24,17 @@ struct _AiMessage
 
     AiRole  role;
     GList  *content_blocks; /* List of AiContentBlock */
+    gboolean cache_breakpoint;
+
+    /*
+     * Serialized JSON of the message, reused across requests so a
+     * growing conversation is not re-escaped on every turn. The
+     * generation is bumped on every invalidation so a fragment built
+     * concurrently with a mutation is never stored.
+     */
+    GMutex  json_lock;
+    GBytes *json_cache;
+    guint   json_generation;
 };
 
 G_DEFINE_TYPE(AiMessage, ai_message, G_TYPE_OBJECT)
@@ -46,10 +57,33 @@ ai_message_finalize(GObject *object)
     AiMessage *self = AI_MESSAGE(object);
 
     g_list_free_full(self->content_blocks, g_object_unref);
+    g_clear_pointer(&self->json_cache, g_bytes_unref);
+    g_mutex_clear(&self->json_lock);
 
     G_OBJECT_CLASS(ai_message_parent_class)->finalize(object);
 }
 
+/*
+ * Drop the cached JSON after any change to the message.
+ */
+static void
+invalidate_json_cache(AiMessage *self)
+{
+    g_mutex_lock(&self->json_lock);
+    g_clear_pointer(&self->json_cache, g_bytes_unref);
+    self->json_generation++;
+    g_mutex_unlock(&self->json_lock);
+}
+
+static void
+on_content_block_notify(
+    GObject    *block,
+    GParamSpec *pspec,
+    gpointer    user_data
+){
+    invalidate_json_cache(AI_MESSAGE(user_data));
+}
+
 static void
 ai_message_get_property(
     GObject    *object,
@@ -83,6 +117,7 @@ ai_message_set_property(
     {
         case PROP_ROLE:
             self->role = g_value_get_enum(value);
+            invalidate_json_cache(self);
             break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
@@ -121,6 +156,7 @@ ai_message_init(AiMessage *self)
 {
     self->role = AI_ROLE_USER;
     self->content_blocks = NULL;
+    g_mutex_init(&self->json_lock);
 }
 
 /**
@@ -286,7 +322,9 @@ ai_message_get_content_blocks(AiMessage *self)
  * @block: (transfer full): the content block to add
  *
  * Adds a content block to the message.
- * The message takes ownership of the block.
+ * The message takes ownership of the block. Adding a block, or changing
+ * a property of one, invalidates the cached serialization used by
+ * ai_message_write_json().
  */
 void
 ai_message_add_content_block(
@@ -297,6 +335,10 @@ ai_message_add_content_block(
     g_return_if_fail(AI_IS_CONTENT_BLOCK(block));
 
     self->content_blocks = g_list_append(self->content_blocks, block);
+
+    g_signal_connect_object(block, "notify",
+                            G_CALLBACK(on_content_block_notify), self, 0);
+    invalidate_json_cache(self);
 }
 
 /**
@@ -319,6 +361,41 @@ ai_message_add_text(
     ai_message_add_content_block(self, (AiContentBlock *)g_steal_pointer(&content));
 }
 
+/**
+ * ai_message_set_cache_breakpoint:
+ * @self: an #AiMessage
+ * @breakpoint: whether the prompt up to this message should be cached
+ *
+ * Marks the message as the end of a cacheable prompt prefix. The mark
+ * is not part of the generic serialization, so the cached JSON stays
+ * valid.
+ */
+void
+ai_message_set_cache_breakpoint(
+    AiMessage *self,
+    gboolean   breakpoint
+){
+    g_return_if_fail(AI_IS_MESSAGE(self));
+
+    self->cache_breakpoint = breakpoint;
+}
+
+/**
+ * ai_message_get_cache_breakpoint:
+ * @self: an #AiMessage
+ *
+ * Gets whether the message is marked as a cache breakpoint.
+ *
+ * Returns: %TRUE if the message is a cache breakpoint
+ */
+gboolean
+ai_message_get_cache_breakpoint(AiMessage *self)
+{
+    g_return_val_if_fail(AI_IS_MESSAGE(self), FALSE);
+
+    return self->cache_breakpoint;
+}
+
 /**
  * ai_message_to_json:
  * @self: an #AiMessage
@@ -374,6 +451,101 @@ ai_message_to_json(AiMessage *self)
     return json_builder_get_root(builder);
 }
 
+/*
+ * Serialize the message from its content blocks.
+ */
+static void
+write_json_uncached(
+    AiMessage    *self,
+    AiJsonWriter *writer
+){
+    GList *l;
+
+    ai_json_writer_begin_object(writer);
+
+    /* Role */
+    ai_json_writer_set_member_name(writer, "role");
+    ai_json_writer_add_string_value(writer, ai_role_to_string(self->role));
+
+    /* Content */
+    ai_json_writer_set_member_name(writer, "content");
+
+    /* If single text block, use string shorthand; otherwise use array */
+    if (self->content_blocks != NULL &&
+        self->content_blocks->next == NULL &&
+        AI_IS_TEXT_CONTENT(self->content_blocks->data))
+    {
+        const gchar *text = ai_text_content_get_text(AI_TEXT_CONTENT(self->content_blocks->data));
+        ai_json_writer_add_string_value(writer, text != NULL ? text : "");
+    }
+    else
+    {
+        ai_json_writer_begin_array(writer);
+
+        for (l = self->content_blocks; l != NULL; l = l->next)
+        {
+            ai_content_block_write_json(AI_CONTENT_BLOCK(l->data), writer);
+        }
+
+        ai_json_writer_end_array(writer);
+    }
+
+    ai_json_writer_end_object(writer);
+}
+
+/**
+ * ai_message_write_json:
+ * @self: an #AiMessage
+ * @writer: the #AiJsonWriter to write to
+ *
+ * Serializes the message straight into @writer, in the same format as
+ * ai_message_to_json(). Content is escaped from the blocks in place, so
+ * large texts and tool results are not copied into a #JsonNode tree.
+ *
+ * The serialized message is cached, so resending a conversation only
+ * serializes the messages added since the last request; older messages
+ * are appended as already-escaped fragments. The cache is dropped
+ * whenever the message or one of its blocks changes.
+ */
+void
+ai_message_write_json(
+    AiMessage    *self,
+    AiJsonWriter *writer
+){
+    g_autoptr(GBytes) cached = NULL;
+    g_autoptr(AiJsonWriter) fragment = NULL;
+    guint generation;
+
+    g_return_if_fail(AI_IS_MESSAGE(self));
+    g_return_if_fail(writer != NULL);
+
+    g_mutex_lock(&self->json_lock);
+    if (self->json_cache != NULL)
+    {
+        cached = g_bytes_ref(self->json_cache);
+    }
+    generation = self->json_generation;
+    g_mutex_unlock(&self->json_lock);
+
+    if (cached == NULL)
+    {
+        fragment = ai_json_writer_new(256);
+        write_json_uncached(self, fragment);
+        cached = ai_json_writer_free_to_bytes(g_steal_pointer(&fragment));
+
+        g_mutex_lock(&self->json_lock);
+        if (self->json_generation == generation && self->json_cache == NULL)
+        {
+            self->json_cache = g_bytes_ref(cached);
+        }
+        g_mutex_unlock(&self->json_lock);
+    }
+
+    ai_json_writer_add_raw_value(writer,
+                                 g_bytes_get_data(cached, NULL),
+                                 g_bytes_get_size(cached));
+}
+
 /**
  * ai_message_new_from_json:
  * @json: a #JsonNode containing message data
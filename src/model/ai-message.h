@@ -136,6 +136,31 @@ ai_message_add_text(
     const gchar *text
 );
 
+/**
+ * ai_message_set_cache_breakpoint:
+ * @self: an #AiMessage
+ * @breakpoint: whether the prompt up to this message should be cached
+ *
+ * Marks the message as the end of a prompt prefix the provider should
+ * cache. Providers without prompt caching ignore the mark.
+ */
+void
+ai_message_set_cache_breakpoint(
+    AiMessage *self,
+    gboolean   breakpoint
+);
+
+/**
+ * ai_message_get_cache_breakpoint:
+ * @self: an #AiMessage
+ *
+ * Gets whether the message is marked as a cache breakpoint.
+ *
+ * Returns: %TRUE if the message is a cache breakpoint
+ */
+gboolean
+ai_message_get_cache_breakpoint(AiMessage *self);
+
 /**
  * ai_message_to_json:
  * @self: an #AiMessage
@@ -147,6 +172,21 @@ ai_message_add_text(
 JsonNode *
 ai_message_to_json(AiMessage *self);
 
+/**
+ * ai_message_write_json:
+ * @self: an #AiMessage
+ * @writer: the #AiJsonWriter to write to
+ *
+ * Serializes the message straight into @writer. The output is the same
+ * as ai_message_to_json(), but no intermediate tree is built. The result
+ * is cached on the message until it or one of its blocks changes.
+ */
+void
+ai_message_write_json(
+    AiMessage    *self,
+    AiJsonWriter *writer
+);
+
 /**
  * ai_message_new_from_json:
  * @json: a #JsonNode containing message data
@@ -0,0 +1,421 @@
+/*
+ * ai-request-options.c - Per-request settings
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include "model/ai-request-options.h"
+
+/*
+ * Private structure for AiRequestOptions boxed type.
+ */
+struct _AiRequestOptions
+{
+    gchar    *model;
+    gchar    *system_prompt;
+    gboolean  has_system_prompt;
+    gint      max_tokens;
+    gdouble   temperature;
+    gboolean  has_temperature;
+    gchar   **stop_sequences;
+    GList    *tools;            /* List of AiTool, owned */
+    gint64    deadline;
+    AiStream *stream;           /* owned ref, nullable */
+};
+
+/*
+ * ai_request_options_get_type:
+ *
+ * Registers the AiRequestOptions boxed type with the GLib type system.
+ */
+G_DEFINE_BOXED_TYPE(AiRequestOptions, ai_request_options,
+                    ai_request_options_copy, ai_request_options_free)
+
+/**
+ * ai_request_options_new:
+ *
+ * Creates options with nothing set.
+ *
+ * Returns: (transfer full): a new #AiRequestOptions
+ */
+AiRequestOptions *
+ai_request_options_new(void)
+{
+    AiRequestOptions *self;
+
+    self = g_slice_new0(AiRequestOptions);
+    self->temperature = 1.0;
+
+    return self;
+}
+
+/**
+ * ai_request_options_copy:
+ * @self: an #AiRequestOptions
+ *
+ * Creates a copy of an #AiRequestOptions.
+ *
+ * Returns: (transfer full): a copy of @self
+ */
+AiRequestOptions *
+ai_request_options_copy(const AiRequestOptions *self)
+{
+    AiRequestOptions *copy;
+
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    copy = g_slice_dup(AiRequestOptions, self);
+    copy->model = g_strdup(self->model);
+    copy->system_prompt = g_strdup(self->system_prompt);
+    copy->stop_sequences = g_strdupv(self->stop_sequences);
+    copy->tools = g_list_copy_deep(self->tools, (GCopyFunc)g_object_ref, NULL);
+    if (self->stream != NULL)
+    {
+        g_object_ref(self->stream);
+    }
+
+    return copy;
+}
+
+/**
+ * ai_request_options_free:
+ * @self: (nullable): an #AiRequestOptions
+ *
+ * Frees an #AiRequestOptions instance.
+ * If @self is %NULL, this function does nothing.
+ */
+void
+ai_request_options_free(AiRequestOptions *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+
+    g_free(self->model);
+    g_free(self->system_prompt);
+    g_strfreev(self->stop_sequences);
+    g_list_free_full(self->tools, g_object_unref);
+    g_clear_object(&self->stream);
+    g_slice_free(AiRequestOptions, self);
+}
+
+/**
+ * ai_request_options_get_model:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the model.
+ *
+ * Returns: (transfer none) (nullable): the model, or %NULL if not set
+ */
+const gchar *
+ai_request_options_get_model(const AiRequestOptions *self)
+{
+    g_return_val_if_fail(self != NULL, NULL);
+
+    return self->model;
+}
+
+/**
+ * ai_request_options_set_model:
+ * @self: an #AiRequestOptions
+ * @model: (nullable): the model, or %NULL to use the client's
+ *
+ * Sets the model.
+ */
+void
+ai_request_options_set_model(
+    AiRequestOptions *self,
+    const gchar      *model
+){
+    g_return_if_fail(self != NULL);
+
+    g_free(self->model);
+    self->model = g_strdup(model);
+}
+
+/**
+ * ai_request_options_has_system_prompt:
+ * @self: an #AiRequestOptions
+ *
+ * Gets whether the system prompt is set.
+ *
+ * Returns: %TRUE if the system prompt is set
+ */
+gboolean
+ai_request_options_has_system_prompt(const AiRequestOptions *self)
+{
+    g_return_val_if_fail(self != NULL, FALSE);
+
+    return self->has_system_prompt;
+}
+
+/**
+ * ai_request_options_get_system_prompt:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the system prompt.
+ *
+ * Returns: (transfer none) (nullable): the system prompt
+ */
+const gchar *
+ai_request_options_get_system_prompt(const AiRequestOptions *self)
+{
+    g_return_val_if_fail(self != NULL, NULL);
+
+    return self->system_prompt;
+}
+
+/**
+ * ai_request_options_set_system_prompt:
+ * @self: an #AiRequestOptions
+ * @system_prompt: (nullable): the system prompt, or %NULL for none
+ *
+ * Sets the system prompt.
+ */
+void
+ai_request_options_set_system_prompt(
+    AiRequestOptions *self,
+    const gchar      *system_prompt
+){
+    g_return_if_fail(self != NULL);
+
+    g_free(self->system_prompt);
+    self->system_prompt = g_strdup(system_prompt);
+    self->has_system_prompt = TRUE;
+}
+
+/**
+ * ai_request_options_get_max_tokens:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the token limit.
+ *
+ * Returns: the token limit, or 0 if not set
+ */
+gint
+ai_request_options_get_max_tokens(const AiRequestOptions *self)
+{
+    g_return_val_if_fail(self != NULL, 0);
+
+    return self->max_tokens;
+}
+
+/**
+ * ai_request_options_set_max_tokens:
+ * @self: an #AiRequestOptions
+ * @max_tokens: the token limit, or 0 to use the client's
+ *
+ * Sets the maximum number of tokens to generate.
+ */
+void
+ai_request_options_set_max_tokens(
+    AiRequestOptions *self,
+    gint              max_tokens
+){
+    g_return_if_fail(self != NULL);
+
+    self->max_tokens = MAX(max_tokens, 0);
+}
+
+/**
+ * ai_request_options_has_temperature:
+ * @self: an #AiRequestOptions
+ *
+ * Gets whether the temperature is set.
+ *
+ * Returns: %TRUE if the temperature is set
+ */
+gboolean
+ai_request_options_has_temperature(const AiRequestOptions *self)
+{
+    g_return_val_if_fail(self != NULL, FALSE);
+
+    return self->has_temperature;
+}
+
+/**
+ * ai_request_options_get_temperature:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the temperature.
+ *
+ * Returns: the temperature, or 1.0 if not set
+ */
+gdouble
+ai_request_options_get_temperature(const AiRequestOptions *self)
+{
+    g_return_val_if_fail(self != NULL, 1.0);
+
+    return self->temperature;
+}
+
+/**
+ * ai_request_options_set_temperature:
+ * @self: an #AiRequestOptions
+ * @temperature: the sampling temperature
+ *
+ * Sets the sampling temperature.
+ */
+void
+ai_request_options_set_temperature(
+    AiRequestOptions *self,
+    gdouble           temperature
+){
+    g_return_if_fail(self != NULL);
+
+    self->temperature = temperature;
+    self->has_temperature = TRUE;
+}
+
+/**
+ * ai_request_options_get_stop_sequences:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the sequences that end generation.
+ *
+ * Returns: (transfer none) (nullable) (array zero-terminated=1): the
+ *   stop sequences, or %NULL if none
+ */
+const gchar * const *
+ai_request_options_get_stop_sequences(const AiRequestOptions *self)
+{
+    g_return_val_if_fail(self != NULL, NULL);
+
+    return (const gchar * const *)self->stop_sequences;
+}
+
+/**
+ * ai_request_options_set_stop_sequences:
+ * @self: an #AiRequestOptions
+ * @stop_sequences: (nullable) (array zero-terminated=1): the stop
+ *   sequences, or %NULL for none
+ *
+ * Sets sequences that end generation when the model produces them.
+ * An empty array is stored as %NULL.
+ */
+void
+ai_request_options_set_stop_sequences(
+    AiRequestOptions    *self,
+    const gchar * const *stop_sequences
+){
+    g_return_if_fail(self != NULL);
+
+    g_clear_pointer(&self->stop_sequences, g_strfreev);
+    if (stop_sequences != NULL && stop_sequences[0] != NULL)
+    {
+        self->stop_sequences = g_strdupv((gchar **)stop_sequences);
+    }
+}
+
+/**
+ * ai_request_options_get_tools:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the tools offered to the model.
+ *
+ * Returns: (transfer none) (element-type AiTool) (nullable): the tools
+ */
+GList *
+ai_request_options_get_tools(const AiRequestOptions *self)
+{
+    g_return_val_if_fail(self != NULL, NULL);
+
+    return self->tools;
+}
+
+/**
+ * ai_request_options_set_tools:
+ * @self: an #AiRequestOptions
+ * @tools: (element-type AiTool) (nullable): the tools
+ *
+ * Sets the tools offered to the model.
+ */
+void
+ai_request_options_set_tools(
+    AiRequestOptions *self,
+    GList            *tools
+){
+    GList *copy;
+
+    g_return_if_fail(self != NULL);
+
+    /* Copy first, in case @tools is our own list */
+    copy = g_list_copy_deep(tools, (GCopyFunc)g_object_ref, NULL);
+    g_list_free_full(self->tools, g_object_unref);
+    self->tools = copy;
+}
+
+/**
+ * ai_request_options_get_deadline:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the deadline.
+ *
+ * Returns: the deadline in microseconds, or 0 if there is none
+ */
+gint64
+ai_request_options_get_deadline(const AiRequestOptions *self)
+{
+    g_return_val_if_fail(self != NULL, 0);
+
+    return self->deadline;
+}
+
+/**
+ * ai_request_options_set_deadline:
+ * @self: an #AiRequestOptions
+ * @deadline: the deadline in microseconds, or 0 for none
+ *
+ * Sets the time by which the request must be done.
+ */
+void
+ai_request_options_set_deadline(
+    AiRequestOptions *self,
+    gint64            deadline
+){
+    g_return_if_fail(self != NULL);
+
+    self->deadline = MAX(deadline, 0);
+}
+
+/**
+ * ai_request_options_get_stream:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the stream the request's events go to.
+ *
+ * Returns: (transfer none) (nullable): the #AiStream, or %NULL
+ */
+AiStream *
+ai_request_options_get_stream(const AiRequestOptions *self)
+{
+    g_return_val_if_fail(self != NULL, NULL);
+
+    return self->stream;
+}
+
+/**
+ * ai_request_options_set_stream:
+ * @self: an #AiRequestOptions
+ * @stream: (nullable): an #AiStream, or %NULL
+ *
+ * Sets the stream a streaming request's events go to.
+ */
+void
+ai_request_options_set_stream(
+    AiRequestOptions *self,
+    AiStream         *stream
+){
+    g_return_if_fail(self != NULL);
+
+    g_set_object(&self->stream, stream);
+}
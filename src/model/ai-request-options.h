@@ -0,0 +1,316 @@
+/*
+ * ai-request-options.h - Per-request settings
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+
+#include "model/ai-tool.h"
+
+G_BEGIN_DECLS
+
+/* Declared in core/ai-stream.h, which includes this header */
+typedef struct _AiStream AiStream;
+
+#define AI_TYPE_REQUEST_OPTIONS (ai_request_options_get_type())
+
+/**
+ * AiRequestOptions:
+ *
+ * A boxed type holding the settings of one request: model, system
+ * prompt, token limit, temperature, stop sequences, tools and deadline.
+ * Passing options to the `_with_options` request functions leaves the
+ * client untouched, so one client can serve concurrent requests with
+ * different settings.
+ *
+ * A setting that is not set falls back to the client's property of the
+ * same name. Requests take a copy of the options when they start, so
+ * an options object can be reused, or changed, while requests made
+ * with it are still running.
+ */
+typedef struct _AiRequestOptions AiRequestOptions;
+
+/**
+ * ai_request_options_get_type:
+ *
+ * Gets the #GType for #AiRequestOptions.
+ *
+ * Returns: the #GType for #AiRequestOptions
+ */
+GType
+ai_request_options_get_type(void);
+
+/**
+ * ai_request_options_new:
+ *
+ * Creates options with nothing set.
+ *
+ * Returns: (transfer full): a new #AiRequestOptions
+ */
+AiRequestOptions *
+ai_request_options_new(void);
+
+/**
+ * ai_request_options_copy:
+ * @self: an #AiRequestOptions
+ *
+ * Creates a copy of an #AiRequestOptions.
+ *
+ * Returns: (transfer full): a copy of @self
+ */
+AiRequestOptions *
+ai_request_options_copy(const AiRequestOptions *self);
+
+/**
+ * ai_request_options_free:
+ * @self: (nullable): an #AiRequestOptions
+ *
+ * Frees an #AiRequestOptions instance.
+ */
+void
+ai_request_options_free(AiRequestOptions *self);
+
+/**
+ * ai_request_options_get_model:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the model.
+ *
+ * Returns: (transfer none) (nullable): the model, or %NULL if not set
+ */
+const gchar *
+ai_request_options_get_model(const AiRequestOptions *self);
+
+/**
+ * ai_request_options_set_model:
+ * @self: an #AiRequestOptions
+ * @model: (nullable): the model, or %NULL to use the client's
+ *
+ * Sets the model.
+ */
+void
+ai_request_options_set_model(
+    AiRequestOptions *self,
+    const gchar      *model
+);
+
+/**
+ * ai_request_options_has_system_prompt:
+ * @self: an #AiRequestOptions
+ *
+ * Gets whether the system prompt is set. A system prompt set to %NULL
+ * counts as set: the request has no system prompt.
+ *
+ * Returns: %TRUE if the system prompt is set
+ */
+gboolean
+ai_request_options_has_system_prompt(const AiRequestOptions *self);
+
+/**
+ * ai_request_options_get_system_prompt:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the system prompt.
+ *
+ * Returns: (transfer none) (nullable): the system prompt
+ */
+const gchar *
+ai_request_options_get_system_prompt(const AiRequestOptions *self);
+
+/**
+ * ai_request_options_set_system_prompt:
+ * @self: an #AiRequestOptions
+ * @system_prompt: (nullable): the system prompt, or %NULL for none
+ *
+ * Sets the system prompt.
+ */
+void
+ai_request_options_set_system_prompt(
+    AiRequestOptions *self,
+    const gchar      *system_prompt
+);
+
+/**
+ * ai_request_options_get_max_tokens:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the token limit.
+ *
+ * Returns: the token limit, or 0 if not set
+ */
+gint
+ai_request_options_get_max_tokens(const AiRequestOptions *self);
+
+/**
+ * ai_request_options_set_max_tokens:
+ * @self: an #AiRequestOptions
+ * @max_tokens: the token limit, or 0 to use the client's
+ *
+ * Sets the maximum number of tokens to generate.
+ */
+void
+ai_request_options_set_max_tokens(
+    AiRequestOptions *self,
+    gint              max_tokens
+);
+
+/**
+ * ai_request_options_has_temperature:
+ * @self: an #AiRequestOptions
+ *
+ * Gets whether the temperature is set.
+ *
+ * Returns: %TRUE if the temperature is set
+ */
+gboolean
+ai_request_options_has_temperature(const AiRequestOptions *self);
+
+/**
+ * ai_request_options_get_temperature:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the temperature.
+ *
+ * Returns: the temperature, or 1.0 if not set
+ */
+gdouble
+ai_request_options_get_temperature(const AiRequestOptions *self);
+
+/**
+ * ai_request_options_set_temperature:
+ * @self: an #AiRequestOptions
+ * @temperature: the sampling temperature
+ *
+ * Sets the sampling temperature.
+ */
+void
+ai_request_options_set_temperature(
+    AiRequestOptions *self,
+    gdouble           temperature
+);
+
+/**
+ * ai_request_options_get_stop_sequences:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the sequences that end generation.
+ *
+ * Returns: (transfer none) (nullable) (array zero-terminated=1): the
+ *   stop sequences, or %NULL if none
+ */
+const gchar * const *
+ai_request_options_get_stop_sequences(const AiRequestOptions *self);
+
+/**
+ * ai_request_options_set_stop_sequences:
+ * @self: an #AiRequestOptions
+ * @stop_sequences: (nullable) (array zero-terminated=1): the stop
+ *   sequences, or %NULL for none
+ *
+ * Sets sequences that end generation when the model produces them.
+ * The clients have no default, so this applies only to requests made
+ * with these options.
+ */
+void
+ai_request_options_set_stop_sequences(
+    AiRequestOptions    *self,
+    const gchar * const *stop_sequences
+);
+
+/**
+ * ai_request_options_get_tools:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the tools offered to the model.
+ *
+ * Returns: (transfer none) (element-type AiTool) (nullable): the tools
+ */
+GList *
+ai_request_options_get_tools(const AiRequestOptions *self);
+
+/**
+ * ai_request_options_set_tools:
+ * @self: an #AiRequestOptions
+ * @tools: (element-type AiTool) (nullable): the tools
+ *
+ * Sets the tools offered to the model. The options keep a reference to
+ * each tool.
+ */
+void
+ai_request_options_set_tools(
+    AiRequestOptions *self,
+    GList            *tools
+);
+
+/**
+ * ai_request_options_get_deadline:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the deadline.
+ *
+ * Returns: the deadline in g_get_monotonic_time() microseconds, or 0
+ *   if there is none
+ */
+gint64
+ai_request_options_get_deadline(const AiRequestOptions *self);
+
+/**
+ * ai_request_options_set_deadline:
+ * @self: an #AiRequestOptions
+ * @deadline: the deadline in g_get_monotonic_time() microseconds, or 0
+ *   for none
+ *
+ * Sets the time by which the request must be done. At the deadline
+ * the request is cancelled wherever it is, waiting for a retry or
+ * reading a stream, and fails with %AI_ERROR_TIMEOUT. Retries that
+ * could not finish in time are not attempted. Use
+ * g_get_monotonic_time() plus the time budget, so that several
+ * requests of one job can share one deadline.
+ */
+void
+ai_request_options_set_deadline(
+    AiRequestOptions *self,
+    gint64            deadline
+);
+
+/**
+ * ai_request_options_get_stream:
+ * @self: an #AiRequestOptions
+ *
+ * Gets the stream a streaming request's events go to.
+ *
+ * Returns: (transfer none) (nullable): the #AiStream, or %NULL
+ */
+AiStream *
+ai_request_options_get_stream(const AiRequestOptions *self);
+
+/**
+ * ai_request_options_set_stream:
+ * @self: an #AiRequestOptions
+ * @stream: (nullable): an #AiStream, or %NULL
+ *
+ * Sets the stream a streaming request's events go to. The HTTP
+ * clients then queue text, tool calls and the end of the response on
+ * @stream instead of emitting the #AiStreamable signals, so several
+ * requests on one client can be read apart. ai_stream_new() sets
+ * this; there is rarely a reason to call it directly.
+ */
+void
+ai_request_options_set_stream(
+    AiRequestOptions *self,
+    AiStream         *stream
+);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(AiRequestOptions, ai_request_options_free)
+
+G_END_DECLS
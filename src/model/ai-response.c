@@ -23,6 +23,7 @@ struct _AiResponse
     gchar        *model;
     AiStopReason  stop_reason;
     AiUsage      *usage;
+    AiTiming     *timing;
     GList        *content_blocks; /* List of AiContentBlock */
 };
 
@@ -50,6 +51,7 @@ ai_response_finalize(GObject *object)
     g_clear_pointer(&self->id, g_free);
     g_clear_pointer(&self->model, g_free);
     g_clear_pointer(&self->usage, ai_usage_free);
+    g_clear_pointer(&self->timing, ai_timing_free);
     g_list_free_full(self->content_blocks, g_object_unref);
 
     G_OBJECT_CLASS(ai_response_parent_class)->finalize(object);
@@ -167,6 +169,7 @@ ai_response_init(AiResponse *self)
     self->model = NULL;
     self->stop_reason = AI_STOP_REASON_NONE;
     self->usage = NULL;
+    self->timing = NULL;
     self->content_blocks = NULL;
 }
 
@@ -295,6 +298,43 @@ ai_response_set_usage(
     }
 }
 
+/**
+ * ai_response_get_timing:
+ * @self: an #AiResponse
+ *
+ * Gets where the time of the request went.
+ *
+ * Returns: (transfer none) (nullable): the #AiTiming
+ */
+AiTiming *
+ai_response_get_timing(AiResponse *self)
+{
+    g_return_val_if_fail(AI_IS_RESPONSE(self), NULL);
+
+    return self->timing;
+}
+
+/**
+ * ai_response_set_timing:
+ * @self: an #AiResponse
+ * @timing: (nullable): the timing information
+ *
+ * Sets the timing information.
+ */
+void
+ai_response_set_timing(
+    AiResponse *self,
+    AiTiming   *timing
+){
+    g_return_if_fail(AI_IS_RESPONSE(self));
+
+    g_clear_pointer(&self->timing, ai_timing_free);
+    if (timing != NULL)
+    {
+        self->timing = ai_timing_copy(timing);
+    }
+}
+
 /**
  * ai_response_get_content_blocks:
  * @self: an #AiResponse
@@ -17,6 +17,7 @@
 
 #include "core/ai-enums.h"
 #include "model/ai-usage.h"
+#include "model/ai-timing.h"
 #include "model/ai-content-block.h"
 #include "model/ai-tool-use.h"
 
@@ -111,6 +112,32 @@ ai_response_set_usage(
     AiUsage    *usage
 );
 
+/**
+ * ai_response_get_timing:
+ * @self: an #AiResponse
+ *
+ * Gets where the time of the request went. HTTP clients set it on
+ * every response; it is %NULL for responses built by hand or by the
+ * CLI clients.
+ *
+ * Returns: (transfer none) (nullable): the #AiTiming
+ */
+AiTiming *
+ai_response_get_timing(AiResponse *self);
+
+/**
+ * ai_response_set_timing:
+ * @self: an #AiResponse
+ * @timing: (nullable): the timing information
+ *
+ * Sets the timing information.
+ */
+void
+ai_response_set_timing(
+    AiResponse *self,
+    AiTiming   *timing
+);
+
 /**
  * ai_response_get_content_blocks:
  * @self: an #AiResponse
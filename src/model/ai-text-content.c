@@ -119,6 +119,27 @@ ai_text_content_to_json(AiContentBlock *block)
     return json_builder_get_root(builder);
 }
 
+/*
+ * Write the text block directly, without copying the text into a tree.
+ */
+static void
+ai_text_content_write_json(
+    AiContentBlock *block,
+    AiJsonWriter   *writer
+){
+    AiTextContent *self = AI_TEXT_CONTENT(block);
+
+    ai_json_writer_begin_object(writer);
+
+    ai_json_writer_set_member_name(writer, "type");
+    ai_json_writer_add_string_value(writer, "text");
+
+    ai_json_writer_set_member_name(writer, "text");
+    ai_json_writer_add_string_value(writer, self->text != NULL ? self->text : "");
+
+    ai_json_writer_end_object(writer);
+}
+
 static void
 ai_text_content_class_init(AiTextContentClass *klass)
 {
@@ -132,6 +153,7 @@ ai_text_content_class_init(AiTextContentClass *klass)
     /* Override virtual methods */
     content_class->get_content_type = ai_text_content_get_content_type;
     content_class->to_json = ai_text_content_to_json;
+    content_class->write_json = ai_text_content_write_json;
 
     /**
      * AiTextContent:text:
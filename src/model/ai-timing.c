@@ -0,0 +1,248 @@
+/*
+ * ai-timing.c - Per-request latency breakdown
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#include "config.h"
+
+#include "model/ai-timing.h"
+
+#define N_PHASES (AI_TIMING_TOTAL + 1)
+
+/*
+ * Private structure for AiTiming boxed type.
+ */
+struct _AiTiming
+{
+    gint64  start_time;
+    gint64  durations[N_PHASES];
+    guint64 request_bytes;
+    guint64 response_bytes;
+};
+
+/*
+ * ai_timing_get_type:
+ *
+ * Registers the AiTiming boxed type with the GLib type system.
+ */
+G_DEFINE_BOXED_TYPE(AiTiming, ai_timing, ai_timing_copy, ai_timing_free)
+
+/**
+ * ai_timing_new:
+ *
+ * Creates an empty #AiTiming whose request starts now.
+ *
+ * Returns: (transfer full): a new #AiTiming
+ */
+AiTiming *
+ai_timing_new(void)
+{
+    AiTiming *self;
+
+    self = g_slice_new0(AiTiming);
+    self->start_time = g_get_monotonic_time();
+
+    return self;
+}
+
+/**
+ * ai_timing_copy:
+ * @self: an #AiTiming
+ *
+ * Creates a copy of an #AiTiming.
+ *
+ * Returns: (transfer full): a copy of @self
+ */
+AiTiming *
+ai_timing_copy(const AiTiming *self)
+{
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    return g_slice_dup(AiTiming, self);
+}
+
+/**
+ * ai_timing_free:
+ * @self: (nullable): an #AiTiming
+ *
+ * Frees an #AiTiming instance.
+ * If @self is %NULL, this function does nothing.
+ */
+void
+ai_timing_free(AiTiming *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+
+    g_slice_free(AiTiming, self);
+}
+
+/**
+ * ai_timing_get_start_time:
+ * @self: an #AiTiming
+ *
+ * Gets the monotonic time the request started at.
+ *
+ * Returns: the start time in microseconds
+ */
+gint64
+ai_timing_get_start_time(const AiTiming *self)
+{
+    g_return_val_if_fail(self != NULL, 0);
+
+    return self->start_time;
+}
+
+/**
+ * ai_timing_get_duration:
+ * @self: an #AiTiming
+ * @phase: an #AiTimingPhase
+ *
+ * Gets how long @phase took.
+ *
+ * Returns: the duration in microseconds, or 0 if @phase did not happen
+ */
+gint64
+ai_timing_get_duration(
+    const AiTiming *self,
+    AiTimingPhase   phase
+){
+    g_return_val_if_fail(self != NULL, 0);
+    g_return_val_if_fail((guint)phase < N_PHASES, 0);
+
+    return self->durations[phase];
+}
+
+/**
+ * ai_timing_set_duration:
+ * @self: an #AiTiming
+ * @phase: an #AiTimingPhase
+ * @duration: the duration in microseconds
+ *
+ * Sets how long @phase took. Negative durations, which clock skew
+ * between measurements can produce, are stored as 0.
+ */
+void
+ai_timing_set_duration(
+    AiTiming      *self,
+    AiTimingPhase  phase,
+    gint64         duration
+){
+    g_return_if_fail(self != NULL);
+    g_return_if_fail((guint)phase < N_PHASES);
+
+    self->durations[phase] = MAX(duration, 0);
+}
+
+/**
+ * ai_timing_mark:
+ * @self: an #AiTiming
+ * @phase: an #AiTimingPhase
+ *
+ * Sets @phase to the time elapsed since the request started.
+ */
+void
+ai_timing_mark(
+    AiTiming      *self,
+    AiTimingPhase  phase
+){
+    g_return_if_fail(self != NULL);
+
+    ai_timing_set_duration(self, phase, g_get_monotonic_time() - self->start_time);
+}
+
+/**
+ * ai_timing_get_request_bytes:
+ * @self: an #AiTiming
+ *
+ * Gets the number of bytes sent for the request.
+ *
+ * Returns: the request size in bytes
+ */
+guint64
+ai_timing_get_request_bytes(const AiTiming *self)
+{
+    g_return_val_if_fail(self != NULL, 0);
+
+    return self->request_bytes;
+}
+
+/**
+ * ai_timing_get_response_bytes:
+ * @self: an #AiTiming
+ *
+ * Gets the number of bytes received for the response.
+ *
+ * Returns: the response size in bytes
+ */
+guint64
+ai_timing_get_response_bytes(const AiTiming *self)
+{
+    g_return_val_if_fail(self != NULL, 0);
+
+    return self->response_bytes;
+}
+
+/**
+ * ai_timing_set_bytes:
+ * @self: an #AiTiming
+ * @request_bytes: bytes sent for the request
+ * @response_bytes: bytes received for the response
+ *
+ * Sets the request and response sizes.
+ */
+void
+ai_timing_set_bytes(
+    AiTiming *self,
+    guint64   request_bytes,
+    guint64   response_bytes
+){
+    g_return_if_fail(self != NULL);
+
+    self->request_bytes = request_bytes;
+    self->response_bytes = response_bytes;
+}
+
+/**
+ * ai_timing_format_debug:
+ * @self: an #AiTiming
+ *
+ * Formats every phase in milliseconds on one line, e.g.
+ * "queued=0.1ms dns=12.0ms ... sent=1834B received=2211B".
+ *
+ * Returns: (transfer full): the formatted string, free with g_free()
+ */
+gchar *
+ai_timing_format_debug(const AiTiming *self)
+{
+    g_autoptr(GEnumClass) enum_class = NULL;
+    GString *str;
+    guint i;
+
+    g_return_val_if_fail(self != NULL, NULL);
+
+    enum_class = g_type_class_ref(AI_TYPE_TIMING_PHASE);
+    str = g_string_new(NULL);
+
+    for (i = 0; i < N_PHASES; i++)
+    {
+        GEnumValue *value = g_enum_get_value(enum_class, (gint)i);
+
+        g_string_append_printf(str, "%s=%.1fms ", value->value_nick,
+                               self->durations[i] / 1000.0);
+    }
+
+    g_string_append_printf(str, "sent=%" G_GUINT64_FORMAT "B received=%" G_GUINT64_FORMAT "B",
+                           self->request_bytes, self->response_bytes);
+
+    return g_string_free(str, FALSE);
+}
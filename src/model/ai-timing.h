@@ -0,0 +1,185 @@
+/*
+ * ai-timing.h - Per-request latency breakdown
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * This file is part of ai-glib.
+ */
+
+#pragma once
+
+#if !defined(AI_GLIB_INSIDE) && !defined(AI_GLIB_COMPILATION)
+#error "Only <ai-glib.h> can be included directly."
+#endif
+
+#include <glib-object.h>
+
+#include "core/ai-enums.h"
+
+G_BEGIN_DECLS
+
+#define AI_TYPE_TIMING (ai_timing_get_type())
+
+/**
+ * AiTiming:
+ *
+ * A boxed type holding where the time of one request went: DNS,
+ * connect, TLS, waiting for the first byte, downloading, parsing and,
+ * for streams, the first token. HTTP clients attach it to each
+ * #AiResponse.
+ *
+ * All durations are in microseconds. A phase that did not happen,
+ * such as DNS and connect on a reused connection, is 0.
+ */
+typedef struct _AiTiming AiTiming;
+
+/**
+ * ai_timing_get_type:
+ *
+ * Gets the #GType for #AiTiming.
+ *
+ * Returns: the #GType for #AiTiming
+ */
+GType
+ai_timing_get_type(void);
+
+/**
+ * ai_timing_new:
+ *
+ * Creates an empty #AiTiming whose request starts now, as returned
+ * by g_get_monotonic_time().
+ *
+ * Returns: (transfer full): a new #AiTiming
+ */
+AiTiming *
+ai_timing_new(void);
+
+/**
+ * ai_timing_copy:
+ * @self: an #AiTiming
+ *
+ * Creates a copy of an #AiTiming.
+ *
+ * Returns: (transfer full): a copy of @self
+ */
+AiTiming *
+ai_timing_copy(const AiTiming *self);
+
+/**
+ * ai_timing_free:
+ * @self: (nullable): an #AiTiming
+ *
+ * Frees an #AiTiming instance.
+ */
+void
+ai_timing_free(AiTiming *self);
+
+/**
+ * ai_timing_get_start_time:
+ * @self: an #AiTiming
+ *
+ * Gets the monotonic time the request started at.
+ *
+ * Returns: the start time in microseconds
+ */
+gint64
+ai_timing_get_start_time(const AiTiming *self);
+
+/**
+ * ai_timing_get_duration:
+ * @self: an #AiTiming
+ * @phase: an #AiTimingPhase
+ *
+ * Gets how long @phase took.
+ *
+ * Returns: the duration in microseconds, or 0 if @phase did not happen
+ */
+gint64
+ai_timing_get_duration(
+    const AiTiming *self,
+    AiTimingPhase   phase
+);
+
+/**
+ * ai_timing_set_duration:
+ * @self: an #AiTiming
+ * @phase: an #AiTimingPhase
+ * @duration: the duration in microseconds
+ *
+ * Sets how long @phase took.
+ */
+void
+ai_timing_set_duration(
+    AiTiming      *self,
+    AiTimingPhase  phase,
+    gint64         duration
+);
+
+/**
+ * ai_timing_mark:
+ * @self: an #AiTiming
+ * @phase: an #AiTimingPhase
+ *
+ * Sets @phase to the time elapsed since the request started. Meant for
+ * %AI_TIMING_FIRST_TOKEN and %AI_TIMING_TOTAL, which are measured from
+ * the start.
+ */
+void
+ai_timing_mark(
+    AiTiming      *self,
+    AiTimingPhase  phase
+);
+
+/**
+ * ai_timing_get_request_bytes:
+ * @self: an #AiTiming
+ *
+ * Gets the number of bytes sent for the request, headers included.
+ *
+ * Returns: the request size in bytes
+ */
+guint64
+ai_timing_get_request_bytes(const AiTiming *self);
+
+/**
+ * ai_timing_get_response_bytes:
+ * @self: an #AiTiming
+ *
+ * Gets the number of bytes received for the response, headers
+ * included. For streams, only the headers are counted.
+ *
+ * Returns: the response size in bytes
+ */
+guint64
+ai_timing_get_response_bytes(const AiTiming *self);
+
+/**
+ * ai_timing_set_bytes:
+ * @self: an #AiTiming
+ * @request_bytes: bytes sent for the request
+ * @response_bytes: bytes received for the response
+ *
+ * Sets the request and response sizes.
+ */
+void
+ai_timing_set_bytes(
+    AiTiming *self,
+    guint64   request_bytes,
+    guint64   response_bytes
+);
+
+/**
+ * ai_timing_format_debug:
+ * @self: an #AiTiming
+ *
+ * Formats every phase in milliseconds on one line, for logging.
+ *
+ * Returns: (transfer full): the formatted string, free with g_free()
+ */
+gchar *
+ai_timing_format_debug(const AiTiming *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(AiTiming, ai_timing_free)
+
+G_END_DECLS
@@ -148,6 +148,37 @@ ai_tool_result_to_json(AiContentBlock *block)
     return json_builder_get_root(builder);
 }
 
+/*
+ * Write the tool result directly. Results often carry whole files, so
+ * this avoids copying the content into a tree and back out again.
+ */
+static void
+ai_tool_result_write_json(
+    AiContentBlock *block,
+    AiJsonWriter   *writer
+){
+    AiToolResult *self = AI_TOOL_RESULT(block);
+
+    ai_json_writer_begin_object(writer);
+
+    ai_json_writer_set_member_name(writer, "type");
+    ai_json_writer_add_string_value(writer, "tool_result");
+
+    ai_json_writer_set_member_name(writer, "tool_use_id");
+    ai_json_writer_add_string_value(writer, self->tool_use_id != NULL ? self->tool_use_id : "");
+
+    ai_json_writer_set_member_name(writer, "content");
+    ai_json_writer_add_string_value(writer, self->content != NULL ? self->content : "");
+
+    if (self->is_error)
+    {
+        ai_json_writer_set_member_name(writer, "is_error");
+        ai_json_writer_add_boolean_value(writer, TRUE);
+    }
+
+    ai_json_writer_end_object(writer);
+}
+
 static void
 ai_tool_result_class_init(AiToolResultClass *klass)
 {
@@ -161,6 +192,7 @@ ai_tool_result_class_init(AiToolResultClass *klass)
     /* Override virtual methods */
     content_class->get_content_type = ai_tool_result_get_content_type;
     content_class->to_json = ai_tool_result_to_json;
+    content_class->write_json = ai_tool_result_write_json;
 
     /**
      * AiToolResult:tool-use-id:
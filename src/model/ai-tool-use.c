@@ -153,6 +153,42 @@ ai_tool_use_to_json(AiContentBlock *block)
     return json_builder_get_root(builder);
 }
 
+/*
+ * Write the tool use directly; the input tree is walked in place
+ * instead of being deep-copied.
+ */
+static void
+ai_tool_use_write_json(
+    AiContentBlock *block,
+    AiJsonWriter   *writer
+){
+    AiToolUse *self = AI_TOOL_USE(block);
+
+    ai_json_writer_begin_object(writer);
+
+    ai_json_writer_set_member_name(writer, "type");
+    ai_json_writer_add_string_value(writer, "tool_use");
+
+    ai_json_writer_set_member_name(writer, "id");
+    ai_json_writer_add_string_value(writer, self->id != NULL ? self->id : "");
+
+    ai_json_writer_set_member_name(writer, "name");
+    ai_json_writer_add_string_value(writer, self->name != NULL ? self->name : "");
+
+    ai_json_writer_set_member_name(writer, "input");
+    if (self->input != NULL)
+    {
+        ai_json_writer_add_node(writer, self->input);
+    }
+    else
+    {
+        ai_json_writer_begin_object(writer);
+        ai_json_writer_end_object(writer);
+    }
+
+    ai_json_writer_end_object(writer);
+}
+
 static void
 ai_tool_use_class_init(AiToolUseClass *klass)
 {
@@ -166,6 +202,7 @@ ai_tool_use_class_init(AiToolUseClass *klass)
     /* Override virtual methods */
     content_class->get_content_type = ai_tool_use_get_content_type;
     content_class->to_json = ai_tool_use_to_json;
+    content_class->write_json = ai_tool_use_write_json;
 
     /**
      * AiToolUse:id:
@@ -19,6 +19,8 @@ struct _AiUsage
 {
     gint input_tokens;
     gint output_tokens;
+    gint cache_creation_input_tokens;
+    gint cache_read_input_tokens;
     gint ref_count;
 };
 
@@ -65,12 +67,18 @@ ai_usage_new(
 AiUsage *
 ai_usage_copy(const AiUsage *self)
 {
+    AiUsage *copy;
+
     if (self == NULL)
     {
         return NULL;
     }
 
-    return ai_usage_new(self->input_tokens, self->output_tokens);
+    copy = ai_usage_new(self->input_tokens, self->output_tokens);
+    copy->cache_creation_input_tokens = self->cache_creation_input_tokens;
+    copy->cache_read_input_tokens = self->cache_read_input_tokens;
+
+    return copy;
 }
 
 /**
@@ -127,7 +135,8 @@ ai_usage_get_output_tokens(const AiUsage *self)
  * ai_usage_get_total_tokens:
  * @self: an #AiUsage
  *
- * Gets the total number of tokens (input + output).
+ * Gets the total number of tokens (input + output). Cache tokens are
+ * counted separately.
  *
  * Returns: the total token count
  */
@@ -138,3 +147,55 @@ ai_usage_get_total_tokens(const AiUsage *self)
 
     return self->input_tokens + self->output_tokens;
 }
+
+/**
+ * ai_usage_get_cache_creation_input_tokens:
+ * @self: an #AiUsage
+ *
+ * Gets the number of input tokens written to the prompt cache.
+ *
+ * Returns: the cache write token count
+ */
+gint
+ai_usage_get_cache_creation_input_tokens(const AiUsage *self)
+{
+    g_return_val_if_fail(self != NULL, 0);
+
+    return self->cache_creation_input_tokens;
+}
+
+/**
+ * ai_usage_get_cache_read_input_tokens:
+ * @self: an #AiUsage
+ *
+ * Gets the number of input tokens read from the prompt cache.
+ *
+ * Returns: the cache read token count
+ */
+gint
+ai_usage_get_cache_read_input_tokens(const AiUsage *self)
+{
+    g_return_val_if_fail(self != NULL, 0);
+
+    return self->cache_read_input_tokens;
+}
+
+/**
+ * ai_usage_set_cache_tokens:
+ * @self: an #AiUsage
+ * @cache_creation_input_tokens: input tokens written to the cache
+ * @cache_read_input_tokens: input tokens read from the cache
+ *
+ * Sets the prompt cache token counts.
+ */
+void
+ai_usage_set_cache_tokens(
+    AiUsage *self,
+    gint     cache_creation_input_tokens,
+    gint     cache_read_input_tokens
+){
+    g_return_if_fail(self != NULL);
+
+    self->cache_creation_input_tokens = cache_creation_input_tokens;
+    self->cache_read_input_tokens = cache_read_input_tokens;
+}
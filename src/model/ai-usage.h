@@ -98,13 +98,53 @@ ai_usage_get_output_tokens(const AiUsage *self);
  * ai_usage_get_total_tokens:
  * @self: an #AiUsage
  *
- * Gets the total number of tokens (input + output).
+ * Gets the total number of tokens (input + output). Cache tokens are
+ * not included.
  *
  * Returns: the total token count
  */
 gint
 ai_usage_get_total_tokens(const AiUsage *self);
 
+/**
+ * ai_usage_get_cache_creation_input_tokens:
+ * @self: an #AiUsage
+ *
+ * Gets the number of input tokens written to the provider's prompt
+ * cache. They are not part of the input token count.
+ *
+ * Returns: the cache write token count
+ */
+gint
+ai_usage_get_cache_creation_input_tokens(const AiUsage *self);
+
+/**
+ * ai_usage_get_cache_read_input_tokens:
+ * @self: an #AiUsage
+ *
+ * Gets the number of input tokens read from the provider's prompt
+ * cache. They are not part of the input token count.
+ *
+ * Returns: the cache read token count
+ */
+gint
+ai_usage_get_cache_read_input_tokens(const AiUsage *self);
+
+/**
+ * ai_usage_set_cache_tokens:
+ * @self: an #AiUsage
+ * @cache_creation_input_tokens: input tokens written to the cache
+ * @cache_read_input_tokens: input tokens read from the cache
+ *
+ * Sets the prompt cache token counts.
+ */
+void
+ai_usage_set_cache_tokens(
+    AiUsage *self,
+    gint     cache_creation_input_tokens,
+    gint     cache_read_input_tokens
+);
+
 G_DEFINE_AUTOPTR_CLEANUP_FUNC(AiUsage, ai_usage_free)
 
 G_END_DECLS
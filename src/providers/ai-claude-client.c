@@ -11,6 +11,9 @@
 
 #include "providers/ai-claude-client.h"
 #include "core/ai-error.h"
+#include "core/ai-json-writer.h"
+#include "core/ai-json-scanner.h"
+#include "core/ai-stream-reader.h"
 #include "model/ai-text-content.h"
 #include "model/ai-tool-use.h"
 
@@ -23,9 +26,31 @@ struct _AiClaudeClient
 {
     AiClient parent_instance;
 
-    gchar *api_version;
+    gchar              *api_version;
+    AiClaudeCacheFlags  cache_flags;
 };
 
+static const GFlagsValue cache_flags_values[] = {
+    { AI_CLAUDE_CACHE_SYSTEM,       "AI_CLAUDE_CACHE_SYSTEM",       "system" },
+    { AI_CLAUDE_CACHE_TOOLS,        "AI_CLAUDE_CACHE_TOOLS",        "tools" },
+    { AI_CLAUDE_CACHE_CONVERSATION, "AI_CLAUDE_CACHE_CONVERSATION", "conversation" },
+    { 0, NULL, NULL }
+};
+
+GType
+ai_claude_cache_flags_get_type(void)
+{
+    static GType type = 0;
+
+    if (g_once_init_enter(&type))
+    {
+        GType t = g_flags_register_static("AiClaudeCacheFlags", cache_flags_values);
+        g_once_init_leave(&type, t);
+    }
+
+    return type;
+}
+
 /*
  * Interface implementations forward declarations.
  */
@@ -45,6 +70,7 @@ enum
 {
     PROP_0,
     PROP_API_VERSION,
+    PROP_CACHE_BREAKPOINTS,
     N_PROPS
 };
 
@@ -74,6 +100,9 @@ ai_claude_client_get_property(
         case PROP_API_VERSION:
             g_value_set_string(value, self->api_version);
             break;
+        case PROP_CACHE_BREAKPOINTS:
+            g_value_set_flags(value, self->cache_flags);
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
@@ -95,12 +124,180 @@ ai_claude_client_set_property(
             g_clear_pointer(&self->api_version, g_free);
             self->api_version = g_value_dup_string(value);
             break;
+        case PROP_CACHE_BREAKPOINTS:
+            self->cache_flags = g_value_get_flags(value);
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID(object, prop_id, pspec);
             break;
     }
 }
 
+/*
+ * Mark a content block, tool or system block as the end of a cached
+ * prefix.
+ */
+static void
+set_cache_control(JsonObject *obj)
+{
+    JsonObject *cache_control = json_object_new();
+
+    json_object_set_string_member(cache_control, "type", "ephemeral");
+    json_object_set_object_member(obj, "cache_control", cache_control);
+}
+
+/*
+ * Whether the system prompt and the tool list carry a breakpoint.
+ */
+static gboolean
+cache_system(
+    AiClaudeClient *self,
+    const gchar    *system_prompt
+){
+    return (self->cache_flags & AI_CLAUDE_CACHE_SYSTEM) &&
+           system_prompt != NULL && system_prompt[0] != '\0';
+}
+
+static gboolean
+cache_tools(
+    AiClaudeClient *self,
+    GList          *tools
+){
+    return (self->cache_flags & AI_CLAUDE_CACHE_TOOLS) && tools != NULL;
+}
+
+/*
+ * Pick the messages that end a cached prefix: the ones marked by the
+ * caller and, with AI_CLAUDE_CACHE_CONVERSATION, the last message
+ * (written for the next turn) and the last one before the newest
+ * assistant reply (where the previous turn ended, read by this one).
+ * @reserved breakpoints are taken by the system prompt and tools.
+ *
+ * Returns: one flag per message, or %NULL if no message is marked
+ */
+static gboolean *
+select_message_breakpoints(
+    AiClaudeClient *self,
+    GList          *messages,
+    guint           reserved
+){
+    gboolean *marks;
+    guint n_messages;
+    guint last_assistant = 0;
+    guint n_marks = 0;
+    guint i;
+    GList *l;
+
+    n_messages = g_list_length(messages);
+    if (n_messages == 0)
+    {
+        return NULL;
+    }
+
+    marks = g_new0(gboolean, n_messages);
+
+    for (l = messages, i = 0; l != NULL; l = l->next, i++)
+    {
+        AiMessage *msg = l->data;
+
+        marks[i] = ai_message_get_cache_breakpoint(msg);
+        if (ai_message_get_role(msg) == AI_ROLE_ASSISTANT)
+        {
+            last_assistant = i;
+        }
+    }
+
+    if (self->cache_flags & AI_CLAUDE_CACHE_CONVERSATION)
+    {
+        marks[n_messages - 1] = TRUE;
+        if (last_assistant > 0)
+        {
+            marks[last_assistant - 1] = TRUE;
+        }
+    }
+
+    /* Over the limit, keep the latest: they cover the longest prefixes */
+    for (i = n_messages; i-- > 0;)
+    {
+        if (!marks[i])
+        {
+            continue;
+        }
+
+        if (n_marks + reserved < AI_CLAUDE_MAX_CACHE_BREAKPOINTS)
+        {
+            n_marks++;
+        }
+        else
+        {
+            marks[i] = FALSE;
+        }
+    }
+
+    if (n_marks == 0)
+    {
+        g_free(marks);
+        return NULL;
+    }
+
+    return marks;
+}
+
+/*
+ * Serialize a message with cache_control on its last content block.
+ * The string shorthand has nowhere to put it, so a single text block
+ * is written out as an array.
+ */
+static JsonNode *
+message_to_cached_json(AiMessage *msg)
+{
+    JsonNode *node = ai_message_to_json(msg);
+    JsonObject *obj = json_node_get_object(node);
+    JsonNode *content = json_object_get_member(obj, "content");
+
+    if (content != NULL && JSON_NODE_HOLDS_VALUE(content))
+    {
+        JsonArray *blocks = json_array_new();
+        JsonObject *block = json_object_new();
+
+        json_object_set_string_member(block, "type", "text");
+        json_object_set_string_member(block, "text", json_node_get_string(content));
+        set_cache_control(block);
+        json_array_add_object_element(blocks, block);
+        json_object_set_array_member(obj, "content", blocks);
+    }
+    else if (content != NULL && JSON_NODE_HOLDS_ARRAY(content))
+    {
+        JsonArray *blocks = json_node_get_array(content);
+        guint len = json_array_get_length(blocks);
+
+        if (len > 0 && JSON_NODE_HOLDS_OBJECT(json_array_get_element(blocks, len - 1)))
+        {
+            set_cache_control(json_array_get_object_element(blocks, len - 1));
+        }
+    }
+
+    return node;
+}
+
+/*
+ * Read a usage object, including the prompt cache counts.
+ */
+static AiUsage *
+parse_usage(JsonObject *usage_obj)
+{
+    AiUsage *usage;
+
+    usage = ai_usage_new(
+        json_object_get_int_member_with_default(usage_obj, "input_tokens", 0),
+        json_object_get_int_member_with_default(usage_obj, "output_tokens", 0));
+    ai_usage_set_cache_tokens(usage,
+        json_object_get_int_member_with_default(usage_obj, "cache_creation_input_tokens", 0),
+        json_object_get_int_member_with_default(usage_obj, "cache_read_input_tokens", 0));
+
+    return usage;
+}
+
 /*
  * Build the JSON request body for Claude's Messages API.
  */
@@ -114,10 +311,17 @@ ai_claude_client_build_request(
 ){
     AiClaudeClient *self = AI_CLAUDE_CLIENT(client);
     g_autoptr(JsonBuilder) builder = json_builder_new();
+    g_autofree gboolean *marks = NULL;
+    gboolean with_system;
+    gboolean with_tools;
     const gchar *model;
+    guint i;
     GList *l;
 
-    (void)self;
+    with_system = cache_system(self, system_prompt);
+    with_tools = cache_tools(self, tools);
+    marks = select_message_breakpoints(self, messages,
+                                       (with_system ? 1 : 0) + (with_tools ? 1 : 0));
 
     model = ai_client_get_model(client);
     if (model == NULL)
@@ -136,7 +340,25 @@ ai_claude_client_build_request(
     json_builder_add_int_value(builder, max_tokens > 0 ? max_tokens : 4096);
 
     /* System prompt */
-    if (system_prompt != NULL && system_prompt[0] != '\0')
+    if (with_system)
+    {
+        /* Only the block form can carry cache_control */
+        json_builder_set_member_name(builder, "system");
+        json_builder_begin_array(builder);
+        json_builder_begin_object(builder);
+        json_builder_set_member_name(builder, "type");
+        json_builder_add_string_value(builder, "text");
+        json_builder_set_member_name(builder, "text");
+        json_builder_add_string_value(builder, system_prompt);
+        json_builder_set_member_name(builder, "cache_control");
+        json_builder_begin_object(builder);
+        json_builder_set_member_name(builder, "type");
+        json_builder_add_string_value(builder, "ephemeral");
+        json_builder_end_object(builder);
+        json_builder_end_object(builder);
+        json_builder_end_array(builder);
+    }
+    else if (system_prompt != NULL && system_prompt[0] != '\0')
     {
         json_builder_set_member_name(builder, "system");
         json_builder_add_string_value(builder, system_prompt);
@@ -146,10 +368,19 @@ ai_claude_client_build_request(
     json_builder_set_member_name(builder, "messages");
     json_builder_begin_array(builder);
 
-    for (l = messages; l != NULL; l = l->next)
+    for (l = messages, i = 0; l != NULL; l = l->next, i++)
     {
         AiMessage *msg = l->data;
-        g_autoptr(JsonNode) msg_node = ai_message_to_json(msg);
+        g_autoptr(JsonNode) msg_node = NULL;
+
+        if (marks != NULL && marks[i])
+        {
+            msg_node = message_to_cached_json(msg);
+        }
+        else
+        {
+            msg_node = ai_message_to_json(msg);
+        }
 
         json_builder_add_value(builder, g_steal_pointer(&msg_node));
     }
@@ -167,6 +398,12 @@ ai_claude_client_build_request(
             AiTool *tool = l->data;
             g_autoptr(JsonNode) tool_node = ai_tool_to_json(tool, AI_PROVIDER_CLAUDE);
 
+            /* One breakpoint after the last tool caches the whole list */
+            if (with_tools && l->next == NULL)
+            {
+                set_cache_control(json_node_get_object(tool_node));
+            }
+
             json_builder_add_value(builder, g_steal_pointer(&tool_node));
         }
 
@@ -188,6 +425,154 @@ ai_claude_client_build_request(
     return json_builder_get_root(builder);
 }
 
+/*
+ * Write the request body for Claude's Messages API straight from the
+ * messages. Without stop sequences, produces the same JSON as
+ * build_request.
+ */
+static GBytes *
+ai_claude_client_build_request_body(
+    AiClient               *client,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    gboolean                stream
+){
+    AiClaudeClient *self = AI_CLAUDE_CLIENT(client);
+    g_autoptr(AiJsonWriter) writer = NULL;
+    g_autofree gboolean *marks = NULL;
+    const gchar *system_prompt = ai_request_options_get_system_prompt(options);
+    gint max_tokens = ai_request_options_get_max_tokens(options);
+    GList *tools = ai_request_options_get_tools(options);
+    const gchar * const *stop_sequences;
+    gboolean with_system;
+    gboolean with_tools;
+    const gchar *model;
+    gdouble temp;
+    guint i;
+    GList *l;
+
+    with_system = cache_system(self, system_prompt);
+    with_tools = cache_tools(self, tools);
+    marks = select_message_breakpoints(self, messages,
+                                       (with_system ? 1 : 0) + (with_tools ? 1 : 0));
+
+    model = ai_request_options_get_model(options);
+    if (model == NULL)
+    {
+        model = AI_CLAUDE_DEFAULT_MODEL;
+    }
+
+    writer = ai_json_writer_new(0);
+
+    ai_json_writer_begin_object(writer);
+
+    /* Model */
+    ai_json_writer_set_member_name(writer, "model");
+    ai_json_writer_add_string_value(writer, model);
+
+    /* Max tokens */
+    ai_json_writer_set_member_name(writer, "max_tokens");
+    ai_json_writer_add_int_value(writer, max_tokens > 0 ? max_tokens : 4096);
+
+    /* Enable streaming */
+    if (stream)
+    {
+        ai_json_writer_set_member_name(writer, "stream");
+        ai_json_writer_add_boolean_value(writer, TRUE);
+    }
+
+    /* System prompt */
+    if (with_system)
+    {
+        ai_json_writer_set_member_name(writer, "system");
+        ai_json_writer_begin_array(writer);
+        ai_json_writer_begin_object(writer);
+        ai_json_writer_set_member_name(writer, "type");
+        ai_json_writer_add_string_value(writer, "text");
+        ai_json_writer_set_member_name(writer, "text");
+        ai_json_writer_add_string_value(writer, system_prompt);
+        ai_json_writer_set_member_name(writer, "cache_control");
+        ai_json_writer_begin_object(writer);
+        ai_json_writer_set_member_name(writer, "type");
+        ai_json_writer_add_string_value(writer, "ephemeral");
+        ai_json_writer_end_object(writer);
+        ai_json_writer_end_object(writer);
+        ai_json_writer_end_array(writer);
+    }
+    else if (system_prompt != NULL && system_prompt[0] != '\0')
+    {
+        ai_json_writer_set_member_name(writer, "system");
+        ai_json_writer_add_string_value(writer, system_prompt);
+    }
+
+    /* Messages */
+    ai_json_writer_set_member_name(writer, "messages");
+    ai_json_writer_begin_array(writer);
+
+    for (l = messages, i = 0; l != NULL; l = l->next, i++)
+    {
+        if (marks != NULL && marks[i])
+        {
+            /* Breakpoint messages bypass the per-message JSON cache */
+            g_autoptr(JsonNode) msg_node = message_to_cached_json(AI_MESSAGE(l->data));
+
+            ai_json_writer_add_node(writer, msg_node);
+        }
+        else
+        {
+            ai_message_write_json(AI_MESSAGE(l->data), writer);
+        }
+    }
+
+    ai_json_writer_end_array(writer);
+
+    /* Tools */
+    if (tools != NULL)
+    {
+        ai_json_writer_set_member_name(writer, "tools");
+        ai_json_writer_begin_array(writer);
+
+        for (l = tools; l != NULL; l = l->next)
+        {
+            g_autoptr(JsonNode) tool_node = ai_tool_to_json(AI_TOOL(l->data), AI_PROVIDER_CLAUDE);
+
+            if (with_tools && l->next == NULL)
+            {
+                set_cache_control(json_node_get_object(tool_node));
+            }
+
+            ai_json_writer_add_node(writer, tool_node);
+        }
+
+        ai_json_writer_end_array(writer);
+    }
+
+    /* Temperature */
+    temp = ai_request_options_get_temperature(options);
+    if (temp != 1.0)
+    {
+        ai_json_writer_set_member_name(writer, "temperature");
+        ai_json_writer_add_double_value(writer, temp);
+    }
+
+    /* Stop sequences */
+    stop_sequences = ai_request_options_get_stop_sequences(options);
+    if (stop_sequences != NULL)
+    {
+        ai_json_writer_set_member_name(writer, "stop_sequences");
+        ai_json_writer_begin_array(writer);
+        for (i = 0; stop_sequences[i] != NULL; i++)
+        {
+            ai_json_writer_add_string_value(writer, stop_sequences[i]);
+        }
+        ai_json_writer_end_array(writer);
+    }
+
+    ai_json_writer_end_object(writer);
+
+    return ai_json_writer_free_to_bytes(g_steal_pointer(&writer));
+}
+
 /*
  * Parse Claude's response JSON into an AiResponse.
  */
@@ -250,9 +635,7 @@ ai_claude_client_parse_response(
     if (json_object_has_member(obj, "usage"))
     {
         JsonObject *usage_obj = json_object_get_object_member(obj, "usage");
-        gint input_tokens = json_object_get_int_member_with_default(usage_obj, "input_tokens", 0);
-        gint output_tokens = json_object_get_int_member_with_default(usage_obj, "output_tokens", 0);
-        g_autoptr(AiUsage) usage = ai_usage_new(input_tokens, output_tokens);
+        g_autoptr(AiUsage) usage = parse_usage(usage_obj);
 
         ai_response_set_usage(response, usage);
     }
@@ -325,6 +708,21 @@ ai_claude_client_add_auth_headers(
         self->api_version != NULL ? self->api_version : AI_CLAUDE_API_VERSION);
 }
 
+/*
+ * Send the request with another key of the pool.
+ */
+static void
+ai_claude_client_set_api_key(
+    AiClient    *client,
+    SoupMessage *msg,
+    const gchar *api_key
+){
+    (void)client;
+
+    soup_message_headers_replace(soup_message_get_request_headers(msg),
+                                 "x-api-key", api_key);
+}
+
 static void
 ai_claude_client_class_init(AiClaudeClientClass *klass)
 {
@@ -337,9 +735,11 @@ ai_claude_client_class_init(AiClaudeClientClass *klass)
 
     /* Override virtual methods */
     client_class->build_request = ai_claude_client_build_request;
+    client_class->build_request_body = ai_claude_client_build_request_body;
     client_class->parse_response = ai_claude_client_parse_response;
     client_class->get_endpoint_url = ai_claude_client_get_endpoint_url;
     client_class->add_auth_headers = ai_claude_client_add_auth_headers;
+    client_class->set_api_key = ai_claude_client_set_api_key;
 
     /**
      * AiClaudeClient:api-version:
@@ -353,6 +753,21 @@ ai_claude_client_class_init(AiClaudeClientClass *klass)
                             AI_CLAUDE_API_VERSION,
                             G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
 
+    /**
+     * AiClaudeClient:cache-breakpoints:
+     *
+     * Where the client places prompt cache breakpoints. Cached input is
+     * billed at a fraction of the normal rate on later requests, but
+     * writing it costs more, so caching is off by default.
+     */
+    properties[PROP_CACHE_BREAKPOINTS] =
+        g_param_spec_flags("cache-breakpoints",
+                           "Cache Breakpoints",
+                           "Where prompt cache breakpoints are placed",
+                           AI_TYPE_CLAUDE_CACHE_FLAGS,
+                           AI_CLAUDE_CACHE_NONE,
+                           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
     g_object_class_install_properties(object_class, N_PROPS, properties);
 }
 
@@ -397,85 +812,26 @@ typedef struct
 {
     AiClaudeClient *client;
     GTask          *task;
-    SoupMessage    *msg;
 } ChatAsyncData;
 
 static void
 chat_async_data_free(ChatAsyncData *data)
 {
     g_clear_object(&data->client);
-    g_clear_object(&data->msg);
     g_slice_free(ChatAsyncData, data);
 }
 
 static void
-on_chat_response(
+on_chat_parsed(
     GObject      *source,
     GAsyncResult *result,
     gpointer      user_data
 ){
     ChatAsyncData *data = user_data;
-    g_autoptr(GBytes) response_bytes = NULL;
     g_autoptr(GError) error = NULL;
-    g_autoptr(JsonParser) parser = NULL;
-    SoupMessage *msg = data->msg;
-    const gchar *response_data;
-    gsize response_len;
-    JsonNode *response_json;
-    AiClientClass *klass;
     AiResponse *response;
 
-    (void)source;  /* source is SoupSession, we use data->msg instead */
-
-    response_bytes = soup_session_send_and_read_finish(
-        ai_client_get_soup_session(AI_CLIENT(data->client)), result, &error);
-
-    if (response_bytes == NULL)
-    {
-        g_task_return_error(data->task, g_steal_pointer(&error));
-        chat_async_data_free(data);
-        return;
-    }
-
-    /* Check HTTP status */
-    if (!SOUP_STATUS_IS_SUCCESSFUL(soup_message_get_status(msg)))
-    {
-        guint status = soup_message_get_status(msg);
-
-        if (status == 401 || status == 403)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_API_KEY,
-                                    "Authentication failed (HTTP %u)", status);
-        }
-        else if (status == 429)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_RATE_LIMITED,
-                                    "Rate limited (HTTP %u)", status);
-        }
-        else
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_NETWORK_ERROR,
-                                    "Request failed (HTTP %u)", status);
-        }
-
-        chat_async_data_free(data);
-        return;
-    }
-
-    response_data = g_bytes_get_data(response_bytes, &response_len);
-    parser = json_parser_new();
-
-    if (!json_parser_load_from_data(parser, response_data, response_len, &error))
-    {
-        g_task_return_error(data->task, g_steal_pointer(&error));
-        chat_async_data_free(data);
-        return;
-    }
-
-    response_json = json_parser_get_root(parser);
-    klass = AI_CLIENT_GET_CLASS(data->client);
-
-    response = klass->parse_response(AI_CLIENT(data->client), response_json, &error);
+    response = ai_client_parse_chat_result_finish(AI_CLIENT(source), result, &error);
     if (response == NULL)
     {
         g_task_return_error(data->task, g_steal_pointer(&error));
@@ -489,86 +845,95 @@ on_chat_response(
 }
 
 static void
-ai_claude_client_chat_async(
-    AiProvider          *provider,
-    GList               *messages,
-    const gchar         *system_prompt,
-    gint                 max_tokens,
-    GList               *tools,
-    GCancellable        *cancellable,
-    GAsyncReadyCallback  callback,
-    gpointer             user_data
+on_chat_response(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    ChatAsyncData *data = user_data;
+
+    (void)source;
+
+    ai_client_parse_chat_result_async(AI_CLIENT(data->client), result,
+                                      g_task_get_cancellable(data->task),
+                                      on_chat_parsed, data);
+}
+
+static void
+ai_claude_client_chat_with_options_async(
+    AiProvider             *provider,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
 ){
     AiClaudeClient *self = AI_CLAUDE_CLIENT(provider);
-    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
-    g_autoptr(JsonNode) request_json = NULL;
     g_autoptr(SoupMessage) msg = NULL;
-    g_autofree gchar *url = NULL;
-    g_autofree gchar *request_body = NULL;
+    g_autoptr(GBytes) request_bytes = NULL;
+    GError *error = NULL;
     ChatAsyncData *data;
     GTask *task;
 
     task = g_task_new(self, cancellable, callback, user_data);
 
-    /* Build request */
-    request_json = klass->build_request(AI_CLIENT(self), messages, system_prompt,
-                                        max_tokens, tools);
-    if (request_json == NULL)
+    msg = ai_client_create_request(AI_CLIENT(self), messages, options, FALSE,
+                                   &request_bytes, &error);
+    if (msg == NULL)
     {
-        g_task_return_new_error(task, AI_ERROR, AI_ERROR_INVALID_REQUEST,
-                                "Failed to build request");
+        g_task_return_error(task, error);
         g_object_unref(task);
         return;
     }
 
-    /* Serialize to JSON string */
-    {
-        g_autoptr(JsonGenerator) gen = json_generator_new();
-        json_generator_set_root(gen, request_json);
-        request_body = json_generator_to_data(gen, NULL);
-    }
-
-    /* Get endpoint URL */
-    url = klass->get_endpoint_url(AI_CLIENT(self));
-
-    /* Create HTTP request */
-    msg = soup_message_new("POST", url);
-    soup_message_headers_append(soup_message_get_request_headers(msg),
-                                "Content-Type", "application/json");
-
-    klass->add_auth_headers(AI_CLIENT(self), msg);
-
-    soup_message_set_request_body_from_bytes(msg, "application/json",
-        g_bytes_new_take(g_steal_pointer(&request_body), strlen(request_body)));
-
     /* Set up callback data */
     data = g_slice_new0(ChatAsyncData);
     data->client = g_object_ref(self);
     data->task = task;
-    data->msg = g_object_ref(msg);
 
     /* Send request */
-    soup_session_send_and_read_async(
-        ai_client_get_soup_session(AI_CLIENT(self)),
+    ai_client_send_and_read_async(
+        AI_CLIENT(self),
         msg,
-        G_PRIORITY_DEFAULT,
+        request_bytes,
         cancellable,
         on_chat_response,
         data);
 }
 
-static AiResponse *
-ai_claude_client_chat_finish(
-    AiProvider    *provider,
-    GAsyncResult  *result,
-    GError       **error
-){
-    (void)provider;
-    return g_task_propagate_pointer(G_TASK(result), error);
-}
-
 static void
-ai_claude_client_list_models_async(
+ai_claude_client_chat_async(
+    AiProvider          *provider,
+    GList               *messages,
+    const gchar         *system_prompt,
+    gint                 max_tokens,
+    GList               *tools,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    ai_claude_client_chat_with_options_async(provider, messages, options,
+                                             cancellable, callback, user_data);
+}
+
+static AiResponse *
+ai_claude_client_chat_finish(
+    AiProvider    *provider,
+    GAsyncResult  *result,
+    GError       **error
+){
+    (void)provider;
+    return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+ai_claude_client_list_models_async(
     AiProvider          *provider,
     GCancellable        *cancellable,
     GAsyncReadyCallback  callback,
@@ -608,6 +973,7 @@ ai_claude_client_provider_init(AiProviderInterface *iface)
     iface->get_default_model = ai_claude_client_get_default_model;
     iface->chat_async = ai_claude_client_chat_async;
     iface->chat_finish = ai_claude_client_chat_finish;
+    iface->chat_with_options_async = ai_claude_client_chat_with_options_async;
     iface->list_models_async = ai_claude_client_list_models_async;
     iface->list_models_finish = ai_claude_client_list_models_finish;
 }
@@ -628,10 +994,10 @@ typedef struct
 {
     AiClaudeClient  *client;
     GTask           *task;
-    SoupMessage     *msg;
     GInputStream    *input_stream;
-    GDataInputStream *data_stream;
+    AiStreamReader  *reader;
     GCancellable    *cancellable;
+    AiTiming        *timing;
 
     /* Response being built */
     AiResponse      *response;
@@ -639,10 +1005,8 @@ typedef struct
     gchar           *current_tool_id;
     gchar           *current_tool_name;
     GString         *current_tool_input;
-
-    /* SSE parsing state */
-    gchar           *current_event_type;
-    GString         *current_event_data;
+    GString         *scratch;           /* unescaped delta, reused */
+    AiDeltaBuffer   *deltas;
 
     /* State tracking */
     gboolean         stream_started;
@@ -654,11 +1018,12 @@ static void
 stream_async_data_free(StreamAsyncData *data)
 {
     g_clear_object(&data->client);
-    g_clear_object(&data->msg);
+    g_clear_pointer(&data->reader, ai_stream_reader_free);
     g_clear_object(&data->input_stream);
-    g_clear_object(&data->data_stream);
     g_clear_object(&data->cancellable);
     g_clear_object(&data->response);
+    g_clear_pointer(&data->timing, ai_timing_free);
+    g_clear_pointer(&data->deltas, ai_delta_buffer_free);
 
     if (data->current_text != NULL)
     {
@@ -668,17 +1033,113 @@ stream_async_data_free(StreamAsyncData *data)
     {
         g_string_free(data->current_tool_input, TRUE);
     }
-    if (data->current_event_data != NULL)
-    {
-        g_string_free(data->current_event_data, TRUE);
-    }
+    g_string_free(data->scratch, TRUE);
     g_clear_pointer(&data->current_tool_id, g_free);
     g_clear_pointer(&data->current_tool_name, g_free);
-    g_clear_pointer(&data->current_event_type, g_free);
 
     g_slice_free(StreamAsyncData, data);
 }
 
+static void
+append_text_delta(
+    StreamAsyncData *data,
+    const gchar     *text
+){
+    if (data->current_text != NULL)
+    {
+        g_string_append(data->current_text, text);
+    }
+
+    /* Emit delta signal */
+    if (ai_timing_get_duration(data->timing, AI_TIMING_FIRST_TOKEN) == 0)
+    {
+        ai_timing_mark(data->timing, AI_TIMING_FIRST_TOKEN);
+    }
+    ai_delta_buffer_append(data->deltas, text);
+}
+
+static void
+append_tool_input(
+    StreamAsyncData *data,
+    const gchar     *partial
+){
+    if (data->current_tool_input == NULL || partial[0] == '\0')
+    {
+        return;
+    }
+
+    g_string_append(data->current_tool_input, partial);
+    ai_delta_buffer_emit_tool_input_delta(data->deltas, data->current_tool_id, partial);
+}
+
+/*
+ * Read a content_block_delta event without a JsonParser. Nearly every
+ * event of a response has this shape:
+ *   {"type":"content_block_delta","index":0,
+ *    "delta":{"type":"text_delta","text":"..."}}
+ * The text, or the partial_json of an input_json_delta, is unescaped
+ * into data->scratch. Any other shape returns FALSE and is left to the
+ * parser.
+ */
+static gboolean
+scan_content_block_delta(
+    StreamAsyncData *data,
+    const gchar     *event_data,
+    gsize            length,
+    gboolean        *is_text
+){
+    AiJsonScanner scanner;
+    const gchar *name;
+    gsize name_len;
+    const gchar *type = NULL;
+    gsize type_len = 0;
+    guint n_values = 0;
+    gboolean has_text = FALSE;
+
+    g_string_truncate(data->scratch, 0);
+    ai_json_scanner_init(&scanner, event_data, length);
+    ai_json_scanner_enter_object(&scanner);
+
+    while (ai_json_scanner_next_member(&scanner, &name, &name_len))
+    {
+        if (!AI_JSON_SLICE_IS(name, name_len, "delta"))
+        {
+            ai_json_scanner_skip_value(&scanner);
+            continue;
+        }
+
+        ai_json_scanner_enter_object(&scanner);
+        while (ai_json_scanner_next_member(&scanner, &name, &name_len))
+        {
+            if (AI_JSON_SLICE_IS(name, name_len, "type"))
+            {
+                ai_json_scanner_read_plain_string(&scanner, &type, &type_len);
+            }
+            else if (AI_JSON_SLICE_IS(name, name_len, "text")
+                     || AI_JSON_SLICE_IS(name, name_len, "partial_json"))
+            {
+                has_text = AI_JSON_SLICE_IS(name, name_len, "text");
+                n_values++;
+                ai_json_scanner_read_string(&scanner, data->scratch);
+            }
+            else
+            {
+                ai_json_scanner_skip_value(&scanner);
+            }
+        }
+    }
+
+    if (!ai_json_scanner_at_end(&scanner) || n_values != 1)
+    {
+        return FALSE;
+    }
+
+    *is_text = has_text;
+
+    return has_text ? AI_JSON_SLICE_IS(type, type_len, "text_delta")
+                    : AI_JSON_SLICE_IS(type, type_len, "input_json_delta");
+}
+
 /*
  * Process a single SSE event from the stream.
  */
@@ -686,20 +1147,37 @@ static void
 process_stream_event(
     StreamAsyncData *data,
     const gchar     *event_type,
-    const gchar     *event_data
+    const gchar     *event_data,
+    gsize            length
 ){
     g_autoptr(JsonParser) parser = NULL;
     JsonNode *root;
     JsonObject *obj;
     g_autoptr(GError) error = NULL;
+    gboolean is_text;
 
-    if (event_data == NULL || event_data[0] == '\0')
+    if (event_data == NULL || length == 0)
     {
         return;
     }
 
+    /* Deltas skip the parser and the event type chain below */
+    if (g_strcmp0(event_type, "content_block_delta") == 0
+        && scan_content_block_delta(data, event_data, length, &is_text))
+    {
+        if (is_text)
+        {
+            append_text_delta(data, data->scratch->str);
+        }
+        else
+        {
+            append_tool_input(data, data->scratch->str);
+        }
+        return;
+    }
+
     parser = json_parser_new();
-    if (!json_parser_load_from_data(parser, event_data, -1, &error))
+    if (!json_parser_load_from_data(parser, event_data, length, &error))
     {
         g_debug("Failed to parse SSE event: %s", error->message);
         return;
@@ -728,9 +1206,7 @@ process_stream_event(
             if (json_object_has_member(msg_obj, "usage"))
             {
                 JsonObject *usage_obj = json_object_get_object_member(msg_obj, "usage");
-                gint input_tokens = json_object_get_int_member_with_default(usage_obj, "input_tokens", 0);
-                gint output_tokens = json_object_get_int_member_with_default(usage_obj, "output_tokens", 0);
-                g_autoptr(AiUsage) usage = ai_usage_new(input_tokens, output_tokens);
+                g_autoptr(AiUsage) usage = parse_usage(usage_obj);
 
                 ai_response_set_usage(data->response, usage);
             }
@@ -740,7 +1216,7 @@ process_stream_event(
         if (!data->stream_started)
         {
             data->stream_started = TRUE;
-            g_signal_emit_by_name(data->client, "stream-start");
+            ai_delta_buffer_emit_stream_start(data->deltas);
         }
     }
     else if (g_strcmp0(event_type, "content_block_start") == 0)
@@ -777,24 +1253,13 @@ process_stream_event(
 
             if (g_strcmp0(type, "text_delta") == 0)
             {
-                const gchar *text = json_object_get_string_member_with_default(delta_obj, "text", "");
-
-                if (data->current_text != NULL)
-                {
-                    g_string_append(data->current_text, text);
-                }
-
-                /* Emit delta signal */
-                g_signal_emit_by_name(data->client, "delta", text);
+                append_text_delta(data,
+                    json_object_get_string_member_with_default(delta_obj, "text", ""));
             }
             else if (g_strcmp0(type, "input_json_delta") == 0)
             {
-                const gchar *partial = json_object_get_string_member_with_default(delta_obj, "partial_json", "");
-
-                if (data->current_tool_input != NULL)
-                {
-                    g_string_append(data->current_tool_input, partial);
-                }
+                append_tool_input(data,
+                    json_object_get_string_member_with_default(delta_obj, "partial_json", ""));
             }
         }
     }
@@ -816,10 +1281,10 @@ process_stream_event(
                 data->current_tool_id,
                 data->current_tool_name,
                 data->current_tool_input->str);
-            ai_response_add_content_block(data->response, (AiContentBlock *)g_steal_pointer(&tool_use));
 
-            /* Emit tool-use signal */
-            /* Note: we'd need the tool_use object again for the signal, so we emit before stealing */
+            /* The tool can run while the rest of the message streams in */
+            ai_delta_buffer_emit_tool_use(data->deltas, tool_use);
+            ai_response_add_content_block(data->response, (AiContentBlock *)g_steal_pointer(&tool_use));
 
             g_string_free(data->current_tool_input, TRUE);
             data->current_tool_input = NULL;
@@ -848,120 +1313,122 @@ process_stream_event(
             JsonObject *usage_obj = json_object_get_object_member(obj, "usage");
             gint output_tokens = json_object_get_int_member_with_default(usage_obj, "output_tokens", 0);
 
-            /* Get existing usage to preserve input tokens */
+            /* Get existing usage to preserve input and cache tokens */
             AiUsage *old_usage = ai_response_get_usage(data->response);
             gint input_tokens = 0;
+            gint cache_creation = 0;
+            gint cache_read = 0;
 
             if (old_usage != NULL)
             {
                 input_tokens = ai_usage_get_input_tokens(old_usage);
+                cache_creation = ai_usage_get_cache_creation_input_tokens(old_usage);
+                cache_read = ai_usage_get_cache_read_input_tokens(old_usage);
             }
 
             g_autoptr(AiUsage) usage = ai_usage_new(input_tokens, output_tokens);
+            ai_usage_set_cache_tokens(usage,
+                json_object_get_int_member_with_default(usage_obj, "cache_creation_input_tokens",
+                                                        cache_creation),
+                json_object_get_int_member_with_default(usage_obj, "cache_read_input_tokens",
+                                                        cache_read));
             ai_response_set_usage(data->response, usage);
         }
     }
     else if (g_strcmp0(event_type, "message_stop") == 0)
     {
         /* End of message - emit stream-end signal */
-        g_signal_emit_by_name(data->client, "stream-end", data->response);
+        ai_timing_mark(data->timing, AI_TIMING_TOTAL);
+        ai_response_set_timing(data->response, data->timing);
+        ai_delta_buffer_emit_stream_end(data->deltas, data->response);
+    }
+}
+
+/*
+ * SSE events arrive as:
+ *   event: <event-type>
+ *   data: <json-data>
+ *   <blank line>
+ */
+static gboolean
+on_stream_event(
+    const AiStreamEvent *event,
+    gpointer             user_data
+){
+    StreamAsyncData *data = user_data;
+
+    if (event->type != NULL)
+    {
+        process_stream_event(data, event->type, event->data, event->data_len);
     }
+
+    /* A consumer that has fallen behind holds back the rest of the block */
+    return !ai_delta_buffer_is_full(data->deltas);
 }
 
-static void read_next_line(StreamAsyncData *data);
+static void read_next_block(StreamAsyncData *data);
 
 static void
-on_line_read(
+on_block_read(
     GObject      *source,
     GAsyncResult *result,
     gpointer      user_data
 ){
     StreamAsyncData *data = user_data;
     g_autoptr(GError) error = NULL;
-    g_autofree gchar *line = NULL;
-    gsize length;
 
     (void)source;
 
-    line = g_data_input_stream_read_line_finish(data->data_stream, result, &length, &error);
-
-    if (error != NULL)
+    if (ai_stream_reader_read_finish(data->reader, result, &error))
     {
-        /* Check if this is just EOF or cancellation */
-        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-        {
-            g_task_return_error(data->task, g_steal_pointer(&error));
-            stream_async_data_free(data);
-        }
+        read_next_block(data);
         return;
     }
 
-    if (line == NULL)
-    {
-        /* EOF - stream is complete */
-        if (data->response != NULL)
-        {
-            g_task_return_pointer(data->task, g_object_ref(data->response), g_object_unref);
-        }
-        else
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
-                                    "Stream ended without a valid response");
-        }
+    /* Text still held back belongs before the result */
+    ai_delta_buffer_flush(data->deltas);
 
+    if (error != NULL)
+    {
+        g_task_return_error(data->task, g_steal_pointer(&error));
         stream_async_data_free(data);
         return;
     }
 
-    /* Parse SSE format:
-     * event: <event-type>
-     * data: <json-data>
-     * <blank line>
-     */
-    if (g_str_has_prefix(line, "event: "))
+    /* EOF - stream is complete */
+    if (data->response != NULL)
     {
-        g_clear_pointer(&data->current_event_type, g_free);
-        data->current_event_type = g_strdup(line + 7);
+        g_task_return_pointer(data->task, g_object_ref(data->response), g_object_unref);
     }
-    else if (g_str_has_prefix(line, "data: "))
+    else
     {
-        if (data->current_event_data == NULL)
-        {
-            data->current_event_data = g_string_new(line + 6);
-        }
-        else
-        {
-            g_string_append(data->current_event_data, line + 6);
-        }
+        g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
+                                "Stream ended without a valid response");
     }
-    else if (length == 0 || line[0] == '\0')
-    {
-        /* Empty line marks end of event */
-        if (data->current_event_type != NULL && data->current_event_data != NULL)
-        {
-            process_stream_event(data, data->current_event_type, data->current_event_data->str);
-        }
 
-        g_clear_pointer(&data->current_event_type, g_free);
-        if (data->current_event_data != NULL)
-        {
-            g_string_free(data->current_event_data, TRUE);
-            data->current_event_data = NULL;
-        }
-    }
+    stream_async_data_free(data);
+}
 
-    /* Read next line */
-    read_next_line(data);
+static gboolean
+on_unblocked(gpointer user_data)
+{
+    read_next_block(user_data);
+
+    return G_SOURCE_REMOVE;
 }
 
 static void
-read_next_line(StreamAsyncData *data)
+read_next_block(StreamAsyncData *data)
 {
-    g_data_input_stream_read_line_async(
-        data->data_stream,
-        G_PRIORITY_DEFAULT,
+    if (ai_delta_buffer_wait_for_space(data->deltas, on_unblocked, data))
+    {
+        return;
+    }
+
+    ai_stream_reader_read_async(
+        data->reader,
         data->cancellable,
-        on_line_read,
+        on_block_read,
         data);
 }
 
@@ -974,10 +1441,8 @@ on_stream_ready(
     StreamAsyncData *data = user_data;
     g_autoptr(GError) error = NULL;
 
-    data->input_stream = soup_session_send_finish(
-        ai_client_get_soup_session(AI_CLIENT(data->client)),
-        result,
-        &error);
+    data->input_stream = ai_client_send_finish(
+        AI_CLIENT(data->client), result, &error);
 
     if (data->input_stream == NULL)
     {
@@ -986,207 +1451,88 @@ on_stream_ready(
         return;
     }
 
-    /* Check HTTP status */
-    if (!SOUP_STATUS_IS_SUCCESSFUL(soup_message_get_status(data->msg)))
-    {
-        guint status = soup_message_get_status(data->msg);
+    data->timing = ai_client_get_timing(AI_CLIENT(data->client), result);
 
-        if (status == 401 || status == 403)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_API_KEY,
-                                    "Authentication failed (HTTP %u)", status);
-        }
-        else if (status == 429)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_RATE_LIMITED,
-                                    "Rate limited (HTTP %u)", status);
-        }
-        else
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_NETWORK_ERROR,
-                                    "Request failed (HTTP %u)", status);
-        }
+    /* Frame the response into SSE events, a block at a time */
+    data->reader = ai_stream_reader_new(data->input_stream, AI_STREAM_FORMAT_SSE,
+                                        on_stream_event, data);
 
-        stream_async_data_free(data);
-        return;
-    }
-
-    /* Wrap in a data input stream for line-by-line reading */
-    data->data_stream = g_data_input_stream_new(data->input_stream);
-    g_data_input_stream_set_newline_type(data->data_stream, G_DATA_STREAM_NEWLINE_TYPE_ANY);
-
-    /* Start reading lines */
-    read_next_line(data);
-}
-
-/*
- * Build a streaming request (adds "stream": true to the request).
- */
-static JsonNode *
-ai_claude_client_build_stream_request(
-    AiClient    *client,
-    GList       *messages,
-    const gchar *system_prompt,
-    gint         max_tokens,
-    GList       *tools
-){
-    AiClaudeClient *self = AI_CLAUDE_CLIENT(client);
-    g_autoptr(JsonBuilder) builder = json_builder_new();
-    const gchar *model;
-    GList *l;
-
-    (void)self;
-
-    model = ai_client_get_model(client);
-    if (model == NULL)
-    {
-        model = AI_CLAUDE_DEFAULT_MODEL;
-    }
-
-    json_builder_begin_object(builder);
-
-    /* Model */
-    json_builder_set_member_name(builder, "model");
-    json_builder_add_string_value(builder, model);
-
-    /* Max tokens */
-    json_builder_set_member_name(builder, "max_tokens");
-    json_builder_add_int_value(builder, max_tokens > 0 ? max_tokens : 4096);
-
-    /* Enable streaming */
-    json_builder_set_member_name(builder, "stream");
-    json_builder_add_boolean_value(builder, TRUE);
-
-    /* System prompt */
-    if (system_prompt != NULL && system_prompt[0] != '\0')
-    {
-        json_builder_set_member_name(builder, "system");
-        json_builder_add_string_value(builder, system_prompt);
-    }
-
-    /* Messages */
-    json_builder_set_member_name(builder, "messages");
-    json_builder_begin_array(builder);
-
-    for (l = messages; l != NULL; l = l->next)
-    {
-        AiMessage *msg = l->data;
-        g_autoptr(JsonNode) msg_node = ai_message_to_json(msg);
-
-        json_builder_add_value(builder, g_steal_pointer(&msg_node));
-    }
-
-    json_builder_end_array(builder);
-
-    /* Tools */
-    if (tools != NULL)
-    {
-        json_builder_set_member_name(builder, "tools");
-        json_builder_begin_array(builder);
-
-        for (l = tools; l != NULL; l = l->next)
-        {
-            AiTool *tool = l->data;
-            g_autoptr(JsonNode) tool_node = ai_tool_to_json(tool, AI_PROVIDER_CLAUDE);
-
-            json_builder_add_value(builder, g_steal_pointer(&tool_node));
-        }
-
-        json_builder_end_array(builder);
-    }
-
-    /* Temperature */
-    {
-        gdouble temp = ai_client_get_temperature(client);
-        if (temp != 1.0)
-        {
-            json_builder_set_member_name(builder, "temperature");
-            json_builder_add_double_value(builder, temp);
-        }
-    }
-
-    json_builder_end_object(builder);
-
-    return json_builder_get_root(builder);
+    read_next_block(data);
 }
 
 static void
-ai_claude_client_chat_stream_async(
-    AiStreamable        *streamable,
-    GList               *messages,
-    const gchar         *system_prompt,
-    gint                 max_tokens,
-    GList               *tools,
-    GCancellable        *cancellable,
-    GAsyncReadyCallback  callback,
-    gpointer             user_data
+ai_claude_client_chat_stream_with_options_async(
+    AiStreamable           *streamable,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
 ){
     AiClaudeClient *self = AI_CLAUDE_CLIENT(streamable);
-    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
-    g_autoptr(JsonNode) request_json = NULL;
     g_autoptr(SoupMessage) msg = NULL;
-    g_autofree gchar *url = NULL;
-    g_autofree gchar *request_body = NULL;
-    gsize request_len;
+    g_autoptr(GBytes) request_bytes = NULL;
+    GError *error = NULL;
     StreamAsyncData *data;
     GTask *task;
 
     task = g_task_new(self, cancellable, callback, user_data);
 
     /* Build streaming request */
-    request_json = ai_claude_client_build_stream_request(
-        AI_CLIENT(self), messages, system_prompt, max_tokens, tools);
-
-    if (request_json == NULL)
+    msg = ai_client_create_request(AI_CLIENT(self), messages, options, TRUE,
+                                   &request_bytes, &error);
+    if (msg == NULL)
     {
-        g_task_return_new_error(task, AI_ERROR, AI_ERROR_INVALID_REQUEST,
-                                "Failed to build request");
+        g_task_return_error(task, error);
         g_object_unref(task);
         return;
     }
 
-    /* Serialize to JSON string */
-    {
-        g_autoptr(JsonGenerator) gen = json_generator_new();
-        json_generator_set_root(gen, request_json);
-        request_body = json_generator_to_data(gen, &request_len);
-    }
-
-    /* Get endpoint URL */
-    url = klass->get_endpoint_url(AI_CLIENT(self));
-
-    /* Create HTTP request */
-    msg = soup_message_new("POST", url);
-    soup_message_headers_append(soup_message_get_request_headers(msg),
-                                "Content-Type", "application/json");
     soup_message_headers_append(soup_message_get_request_headers(msg),
                                 "Accept", "text/event-stream");
 
-    klass->add_auth_headers(AI_CLIENT(self), msg);
-
-    soup_message_set_request_body_from_bytes(msg, "application/json",
-        g_bytes_new_take(g_steal_pointer(&request_body), request_len));
-
     /* Set up callback data */
     data = g_slice_new0(StreamAsyncData);
     data->client = g_object_ref(self);
     data->task = task;
-    data->msg = g_object_ref(msg);
     data->cancellable = cancellable != NULL ? g_object_ref(cancellable) : NULL;
+    data->scratch = g_string_sized_new(256);
+    data->deltas = ai_client_create_delta_buffer(AI_CLIENT(self), options);
     data->stream_started = FALSE;
     data->in_text_block = FALSE;
     data->in_tool_block = FALSE;
 
     /* Send request - use send_async to get the input stream */
-    soup_session_send_async(
-        ai_client_get_soup_session(AI_CLIENT(self)),
+    ai_client_send_async(
+        AI_CLIENT(self),
         msg,
-        G_PRIORITY_DEFAULT,
+        request_bytes,
         cancellable,
         on_stream_ready,
         data);
 }
 
+static void
+ai_claude_client_chat_stream_async(
+    AiStreamable        *streamable,
+    GList               *messages,
+    const gchar         *system_prompt,
+    gint                 max_tokens,
+    GList               *tools,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    ai_claude_client_chat_stream_with_options_async(streamable, messages, options,
+                                                    cancellable, callback, user_data);
+}
+
 static AiResponse *
 ai_claude_client_chat_stream_finish(
     AiStreamable  *streamable,
@@ -1202,6 +1548,7 @@ ai_claude_client_streamable_init(AiStreamableInterface *iface)
 {
     iface->chat_stream_async = ai_claude_client_chat_stream_async;
     iface->chat_stream_finish = ai_claude_client_chat_stream_finish;
+    iface->chat_stream_with_options_async = ai_claude_client_chat_stream_with_options_async;
 }
 
 /*
@@ -1295,3 +1642,43 @@ ai_claude_client_set_api_version(
 
     g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_API_VERSION]);
 }
+
+/**
+ * ai_claude_client_get_cache_breakpoints:
+ * @self: an #AiClaudeClient
+ *
+ * Gets where the client places prompt cache breakpoints.
+ *
+ * Returns: the #AiClaudeCacheFlags
+ */
+AiClaudeCacheFlags
+ai_claude_client_get_cache_breakpoints(AiClaudeClient *self)
+{
+    g_return_val_if_fail(AI_IS_CLAUDE_CLIENT(self), AI_CLAUDE_CACHE_NONE);
+
+    return self->cache_flags;
+}
+
+/**
+ * ai_claude_client_set_cache_breakpoints:
+ * @self: an #AiClaudeClient
+ * @flags: the #AiClaudeCacheFlags
+ *
+ * Sets where the client places prompt cache breakpoints.
+ */
+void
+ai_claude_client_set_cache_breakpoints(
+    AiClaudeClient     *self,
+    AiClaudeCacheFlags  flags
+){
+    g_return_if_fail(AI_IS_CLAUDE_CLIENT(self));
+
+    if (self->cache_flags == flags)
+    {
+        return;
+    }
+
+    self->cache_flags = flags;
+
+    g_object_notify_by_pspec(G_OBJECT(self), properties[PROP_CACHE_BREAKPOINTS]);
+}
@@ -78,6 +78,39 @@ G_DECLARE_FINAL_TYPE(AiClaudeClient, ai_claude_client, AI, CLAUDE_CLIENT, AiClie
  */
 #define AI_CLAUDE_API_VERSION "2023-06-01"
 
+/**
+ * AiClaudeCacheFlags:
+ * @AI_CLAUDE_CACHE_NONE: only messages marked with
+ *   ai_message_set_cache_breakpoint() are cached
+ * @AI_CLAUDE_CACHE_SYSTEM: cache the system prompt
+ * @AI_CLAUDE_CACHE_TOOLS: cache the tool definitions
+ * @AI_CLAUDE_CACHE_CONVERSATION: place breakpoints on the conversation
+ *   so each turn reads the prefix the previous turn wrote
+ * @AI_CLAUDE_CACHE_ALL: all of the above
+ *
+ * Where #AiClaudeClient places prompt cache breakpoints on its own.
+ */
+typedef enum
+{
+    AI_CLAUDE_CACHE_NONE         = 0,
+    AI_CLAUDE_CACHE_SYSTEM       = 1 << 0,
+    AI_CLAUDE_CACHE_TOOLS        = 1 << 1,
+    AI_CLAUDE_CACHE_CONVERSATION = 1 << 2,
+    AI_CLAUDE_CACHE_ALL          = AI_CLAUDE_CACHE_SYSTEM |
+                                   AI_CLAUDE_CACHE_TOOLS |
+                                   AI_CLAUDE_CACHE_CONVERSATION
+} AiClaudeCacheFlags;
+
+GType ai_claude_cache_flags_get_type(void) G_GNUC_CONST;
+#define AI_TYPE_CLAUDE_CACHE_FLAGS (ai_claude_cache_flags_get_type())
+
+/**
+ * AI_CLAUDE_MAX_CACHE_BREAKPOINTS:
+ *
+ * The most cache breakpoints the Messages API accepts in one request.
+ */
+#define AI_CLAUDE_MAX_CACHE_BREAKPOINTS (4)
+
 /**
  * ai_claude_client_new:
  *
@@ -135,4 +168,31 @@ ai_claude_client_set_api_version(
     const gchar    *version
 );
 
+/**
+ * ai_claude_client_get_cache_breakpoints:
+ * @self: an #AiClaudeClient
+ *
+ * Gets where the client places prompt cache breakpoints.
+ *
+ * Returns: the #AiClaudeCacheFlags
+ */
+AiClaudeCacheFlags
+ai_claude_client_get_cache_breakpoints(AiClaudeClient *self);
+
+/**
+ * ai_claude_client_set_cache_breakpoints:
+ * @self: an #AiClaudeClient
+ * @flags: the #AiClaudeCacheFlags
+ *
+ * Sets where the client places prompt cache breakpoints. Messages
+ * marked with ai_message_set_cache_breakpoint() are always cached.
+ * Requests carry at most %AI_CLAUDE_MAX_CACHE_BREAKPOINTS breakpoints;
+ * when there are more, the earliest message breakpoints are dropped.
+ */
+void
+ai_claude_client_set_cache_breakpoints(
+    AiClaudeClient     *self,
+    AiClaudeCacheFlags  flags
+);
+
 G_END_DECLS
@@ -14,6 +14,8 @@
 #include "providers/ai-gemini-client.h"
 #include "core/ai-error.h"
 #include "core/ai-image-generator.h"
+#include "core/ai-json-writer.h"
+#include "core/ai-stream-reader.h"
 #include "model/ai-text-content.h"
 #include "model/ai-tool-use.h"
 #include "model/ai-image-request.h"
@@ -41,21 +43,22 @@ G_DEFINE_TYPE_WITH_CODE(AiGeminiClient, ai_gemini_client, AI_TYPE_CLIENT,
                                               ai_gemini_client_image_generator_init))
 
 /*
- * Build Gemini API request.
+ * Build a Gemini API request for @options.
  * Gemini uses a different format: { contents: [...], generationConfig: {...} }
  */
 static JsonNode *
-ai_gemini_client_build_request(
-    AiClient    *client,
-    GList       *messages,
-    const gchar *system_prompt,
-    gint         max_tokens,
-    GList       *tools
+build_request_json(
+    GList                  *messages,
+    const AiRequestOptions *options
 ){
     g_autoptr(JsonBuilder) builder = json_builder_new();
+    const gchar *system_prompt = ai_request_options_get_system_prompt(options);
+    gint max_tokens = ai_request_options_get_max_tokens(options);
+    const gchar * const *stop_sequences = ai_request_options_get_stop_sequences(options);
+    gdouble temp = ai_request_options_get_temperature(options);
     GList *l;
 
-    (void)tools; /* TODO: Implement tool support for Gemini */
+    /* TODO: Implement tool support for Gemini */
 
     json_builder_begin_object(builder);
 
@@ -120,13 +123,23 @@ ai_gemini_client_build_request(
         json_builder_add_int_value(builder, max_tokens);
     }
 
+    if (temp != 1.0)
+    {
+        json_builder_set_member_name(builder, "temperature");
+        json_builder_add_double_value(builder, temp);
+    }
+
+    if (stop_sequences != NULL)
     {
-        gdouble temp = ai_client_get_temperature(client);
-        if (temp != 1.0)
+        guint i;
+
+        json_builder_set_member_name(builder, "stopSequences");
+        json_builder_begin_array(builder);
+        for (i = 0; stop_sequences[i] != NULL; i++)
         {
-            json_builder_set_member_name(builder, "temperature");
-            json_builder_add_double_value(builder, temp);
+            json_builder_add_string_value(builder, stop_sequences[i]);
         }
+        json_builder_end_array(builder);
     }
 
     json_builder_end_object(builder);
@@ -136,6 +149,48 @@ ai_gemini_client_build_request(
     return json_builder_get_root(builder);
 }
 
+static JsonNode *
+ai_gemini_client_build_request(
+    AiClient    *client,
+    GList       *messages,
+    const gchar *system_prompt,
+    gint         max_tokens,
+    GList       *tools
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_temperature(options, ai_client_get_temperature(client));
+    ai_request_options_set_tools(options, tools);
+
+    return build_request_json(messages, options);
+}
+
+/*
+ * The body is the same for streaming; Gemini selects streaming by URL.
+ */
+static GBytes *
+ai_gemini_client_build_request_body(
+    AiClient               *client,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    gboolean                stream
+){
+    g_autoptr(JsonNode) request_json = NULL;
+    g_autoptr(AiJsonWriter) writer = NULL;
+
+    (void)client;
+    (void)stream;
+
+    request_json = build_request_json(messages, options);
+
+    writer = ai_json_writer_new(0);
+    ai_json_writer_add_node(writer, request_json);
+
+    return ai_json_writer_free_to_bytes(g_steal_pointer(&writer));
+}
+
 /*
  * Parse Gemini response.
  */
@@ -234,12 +289,17 @@ ai_gemini_client_parse_response(
     return (AiResponse *)g_steal_pointer(&response);
 }
 
+/*
+ * Gemini puts the model in the URL, so the URL depends on the request.
+ */
 static gchar *
-ai_gemini_client_get_endpoint_url(AiClient *client)
-{
+build_url(
+    AiClient    *client,
+    const gchar *model,
+    gboolean     stream
+){
     AiConfig *config = ai_client_get_config(client);
     const gchar *base_url = ai_config_get_base_url(config, AI_PROVIDER_GEMINI);
-    const gchar *model = ai_client_get_model(client);
     const gchar *api_key = ai_config_get_api_key(config, AI_PROVIDER_GEMINI);
 
     if (model == NULL)
@@ -247,10 +307,32 @@ ai_gemini_client_get_endpoint_url(AiClient *client)
         model = AI_GEMINI_DEFAULT_MODEL;
     }
 
+    if (stream)
+    {
+        /* Use streamGenerateContent instead of generateContent */
+        return g_strdup_printf("%s/v1beta/models/%s:streamGenerateContent?alt=sse&key=%s",
+                               base_url, model, api_key != NULL ? api_key : "");
+    }
+
     return g_strdup_printf("%s/v1beta/models/%s:generateContent?key=%s",
                            base_url, model, api_key != NULL ? api_key : "");
 }
 
+static gchar *
+ai_gemini_client_get_endpoint_url(AiClient *client)
+{
+    return build_url(client, ai_client_get_model(client), FALSE);
+}
+
+static gchar *
+ai_gemini_client_get_request_url(
+    AiClient               *client,
+    const AiRequestOptions *options,
+    gboolean                stream
+){
+    return build_url(client, ai_request_options_get_model(options), stream);
+}
+
 static void
 ai_gemini_client_add_auth_headers(
     AiClient    *client,
@@ -261,15 +343,66 @@ ai_gemini_client_add_auth_headers(
     (void)msg;
 }
 
+/*
+ * The key is the "key" parameter of the query; the rest of the URL is
+ * kept as it is.
+ */
+static void
+ai_gemini_client_set_api_key(
+    AiClient    *client,
+    SoupMessage *msg,
+    const gchar *api_key
+){
+    GUri *uri = soup_message_get_uri(msg);
+    g_auto(GStrv) params = NULL;
+    g_autofree gchar *escaped = NULL;
+    g_autofree gchar *query = NULL;
+    GUri *keyed;
+    guint i;
+
+    (void)client;
+
+    if (g_uri_get_query(uri) == NULL)
+    {
+        return;
+    }
+
+    escaped = g_uri_escape_string(api_key, NULL, TRUE);
+    params = g_strsplit(g_uri_get_query(uri), "&", -1);
+    for (i = 0; params[i] != NULL; i++)
+    {
+        if (g_str_has_prefix(params[i], "key="))
+        {
+            g_free(params[i]);
+            params[i] = g_strconcat("key=", escaped, NULL);
+        }
+    }
+    query = g_strjoinv("&", params);
+
+    keyed = g_uri_build(g_uri_get_flags(uri),
+                        g_uri_get_scheme(uri),
+                        g_uri_get_userinfo(uri),
+                        g_uri_get_host(uri),
+                        g_uri_get_port(uri),
+                        g_uri_get_path(uri),
+                        query,
+                        g_uri_get_fragment(uri));
+    soup_message_set_uri(msg, keyed);
+    g_uri_unref(keyed);
+}
+
 static void
 ai_gemini_client_class_init(AiGeminiClientClass *klass)
 {
     AiClientClass *client_class = AI_CLIENT_CLASS(klass);
 
     client_class->build_request = ai_gemini_client_build_request;
+    client_class->build_request_body = ai_gemini_client_build_request_body;
     client_class->parse_response = ai_gemini_client_parse_response;
     client_class->get_endpoint_url = ai_gemini_client_get_endpoint_url;
+    client_class->get_request_url = ai_gemini_client_get_request_url;
     client_class->add_auth_headers = ai_gemini_client_add_auth_headers;
+    client_class->set_api_key = ai_gemini_client_set_api_key;
 }
 
 static void
@@ -311,84 +444,26 @@ typedef struct
 {
     AiGeminiClient *client;
     GTask          *task;
-    SoupMessage    *msg;
 } GeminiChatAsyncData;
 
 static void
 gemini_chat_async_data_free(GeminiChatAsyncData *data)
 {
     g_clear_object(&data->client);
-    g_clear_object(&data->msg);
     g_slice_free(GeminiChatAsyncData, data);
 }
 
 static void
-on_gemini_chat_response(
+on_gemini_chat_parsed(
     GObject      *source,
     GAsyncResult *result,
     gpointer      user_data
 ){
     GeminiChatAsyncData *data = user_data;
-    g_autoptr(GBytes) response_bytes = NULL;
     g_autoptr(GError) error = NULL;
-    g_autoptr(JsonParser) parser = NULL;
-    SoupMessage *msg = data->msg;
-    const gchar *response_data;
-    gsize response_len;
-    JsonNode *response_json;
-    AiClientClass *klass;
     AiResponse *response;
 
-    (void)source;
-
-    response_bytes = soup_session_send_and_read_finish(
-        ai_client_get_soup_session(AI_CLIENT(data->client)), result, &error);
-
-    if (response_bytes == NULL)
-    {
-        g_task_return_error(data->task, g_steal_pointer(&error));
-        gemini_chat_async_data_free(data);
-        return;
-    }
-
-    if (!SOUP_STATUS_IS_SUCCESSFUL(soup_message_get_status(msg)))
-    {
-        guint status = soup_message_get_status(msg);
-
-        if (status == 401 || status == 403)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_API_KEY,
-                                    "Authentication failed (HTTP %u)", status);
-        }
-        else if (status == 429)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_RATE_LIMITED,
-                                    "Rate limited (HTTP %u)", status);
-        }
-        else
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_NETWORK_ERROR,
-                                    "Request failed (HTTP %u)", status);
-        }
-
-        gemini_chat_async_data_free(data);
-        return;
-    }
-
-    response_data = g_bytes_get_data(response_bytes, &response_len);
-    parser = json_parser_new();
-
-    if (!json_parser_load_from_data(parser, response_data, response_len, &error))
-    {
-        g_task_return_error(data->task, g_steal_pointer(&error));
-        gemini_chat_async_data_free(data);
-        return;
-    }
-
-    response_json = json_parser_get_root(parser);
-    klass = AI_CLIENT_GET_CLASS(data->client);
-
-    response = klass->parse_response(AI_CLIENT(data->client), response_json, &error);
+    response = ai_client_parse_chat_result_finish(AI_CLIENT(source), result, &error);
     if (response == NULL)
     {
         g_task_return_error(data->task, g_steal_pointer(&error));
@@ -402,68 +477,81 @@ on_gemini_chat_response(
 }
 
 static void
-ai_gemini_client_chat_async(
-    AiProvider          *provider,
-    GList               *messages,
-    const gchar         *system_prompt,
-    gint                 max_tokens,
-    GList               *tools,
-    GCancellable        *cancellable,
-    GAsyncReadyCallback  callback,
-    gpointer             user_data
+on_gemini_chat_response(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    GeminiChatAsyncData *data = user_data;
+
+    (void)source;
+
+    ai_client_parse_chat_result_async(AI_CLIENT(data->client), result,
+                                      g_task_get_cancellable(data->task),
+                                      on_gemini_chat_parsed, data);
+}
+
+static void
+ai_gemini_client_chat_with_options_async(
+    AiProvider             *provider,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
 ){
     AiGeminiClient *self = AI_GEMINI_CLIENT(provider);
-    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
-    g_autoptr(JsonNode) request_json = NULL;
     g_autoptr(SoupMessage) msg = NULL;
-    g_autofree gchar *url = NULL;
-    g_autofree gchar *request_body = NULL;
+    g_autoptr(GBytes) request_bytes = NULL;
+    GError *error = NULL;
     GeminiChatAsyncData *data;
     GTask *task;
 
     task = g_task_new(self, cancellable, callback, user_data);
 
-    request_json = klass->build_request(AI_CLIENT(self), messages, system_prompt,
-                                        max_tokens, tools);
-    if (request_json == NULL)
+    msg = ai_client_create_request(AI_CLIENT(self), messages, options, FALSE,
+                                   &request_bytes, &error);
+    if (msg == NULL)
     {
-        g_task_return_new_error(task, AI_ERROR, AI_ERROR_INVALID_REQUEST,
-                                "Failed to build request");
+        g_task_return_error(task, error);
         g_object_unref(task);
         return;
     }
 
-    {
-        g_autoptr(JsonGenerator) gen = json_generator_new();
-        json_generator_set_root(gen, request_json);
-        request_body = json_generator_to_data(gen, NULL);
-    }
-
-    url = klass->get_endpoint_url(AI_CLIENT(self));
-
-    msg = soup_message_new("POST", url);
-    soup_message_headers_append(soup_message_get_request_headers(msg),
-                                "Content-Type", "application/json");
-
-    klass->add_auth_headers(AI_CLIENT(self), msg);
-
-    soup_message_set_request_body_from_bytes(msg, "application/json",
-        g_bytes_new_take(g_steal_pointer(&request_body), strlen(request_body)));
-
     data = g_slice_new0(GeminiChatAsyncData);
     data->client = g_object_ref(self);
     data->task = task;
-    data->msg = g_object_ref(msg);
 
-    soup_session_send_and_read_async(
-        ai_client_get_soup_session(AI_CLIENT(self)),
+    ai_client_send_and_read_async(
+        AI_CLIENT(self),
         msg,
-        G_PRIORITY_DEFAULT,
+        request_bytes,
         cancellable,
         on_gemini_chat_response,
         data);
 }
 
+static void
+ai_gemini_client_chat_async(
+    AiProvider          *provider,
+    GList               *messages,
+    const gchar         *system_prompt,
+    gint                 max_tokens,
+    GList               *tools,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    ai_gemini_client_chat_with_options_async(provider, messages, options,
+                                             cancellable, callback, user_data);
+}
+
 static AiResponse *
 ai_gemini_client_chat_finish(
     AiProvider    *provider,
@@ -514,6 +602,7 @@ ai_gemini_client_provider_init(AiProviderInterface *iface)
     iface->get_default_model = ai_gemini_client_get_default_model;
     iface->chat_async = ai_gemini_client_chat_async;
     iface->chat_finish = ai_gemini_client_chat_finish;
+    iface->chat_with_options_async = ai_gemini_client_chat_with_options_async;
     iface->list_models_async = ai_gemini_client_list_models_async;
     iface->list_models_finish = ai_gemini_client_list_models_finish;
 }
@@ -529,13 +618,14 @@ typedef struct
 {
     AiGeminiClient   *client;
     GTask            *task;
-    SoupMessage      *msg;
     GInputStream     *input_stream;
-    GDataInputStream *data_stream;
+    AiStreamReader   *reader;
     GCancellable     *cancellable;
+    AiTiming         *timing;
 
     AiResponse       *response;
     GString          *current_text;
+    AiDeltaBuffer    *deltas;
 
     gboolean          stream_started;
 } GeminiStreamData;
@@ -544,11 +634,12 @@ static void
 gemini_stream_data_free(GeminiStreamData *data)
 {
     g_clear_object(&data->client);
-    g_clear_object(&data->msg);
+    g_clear_pointer(&data->reader, ai_stream_reader_free);
     g_clear_object(&data->input_stream);
-    g_clear_object(&data->data_stream);
     g_clear_object(&data->cancellable);
     g_clear_object(&data->response);
+    g_clear_pointer(&data->timing, ai_timing_free);
+    g_clear_pointer(&data->deltas, ai_delta_buffer_free);
 
     if (data->current_text != NULL)
     {
@@ -593,7 +684,7 @@ gemini_process_stream_chunk(
         data->current_text = g_string_new("");
         data->stream_started = TRUE;
 
-        g_signal_emit_by_name(data->client, "stream-start");
+        ai_delta_buffer_emit_stream_start(data->deltas);
     }
 
     /* Parse candidates */
@@ -636,7 +727,11 @@ gemini_process_stream_chunk(
                             if (text != NULL)
                             {
                                 g_string_append(data->current_text, text);
-                                g_signal_emit_by_name(data->client, "delta", text);
+                                if (ai_timing_get_duration(data->timing, AI_TIMING_FIRST_TOKEN) == 0)
+                                {
+                                    ai_timing_mark(data->timing, AI_TIMING_FIRST_TOKEN);
+                                }
+                                ai_delta_buffer_append(data->deltas, text);
                             }
                         }
                     }
@@ -657,73 +752,90 @@ gemini_process_stream_chunk(
     }
 }
 
-static void gemini_read_next_line(GeminiStreamData *data);
+static gboolean
+on_gemini_stream_event(
+    const AiStreamEvent *event,
+    gpointer             user_data
+){
+    GeminiStreamData *data = user_data;
+
+    /* Gemini streaming returns SSE format: data: {json} */
+    gemini_process_stream_chunk(data, event->data);
+
+    return !ai_delta_buffer_is_full(data->deltas);
+}
+
+static void gemini_read_next_block(GeminiStreamData *data);
 
 static void
-on_gemini_line_read(
+on_gemini_block_read(
     GObject      *source,
     GAsyncResult *result,
     gpointer      user_data
 ){
     GeminiStreamData *data = user_data;
     g_autoptr(GError) error = NULL;
-    g_autofree gchar *line = NULL;
-    gsize length;
 
     (void)source;
 
-    line = g_data_input_stream_read_line_finish(data->data_stream, result, &length, &error);
+    if (ai_stream_reader_read_finish(data->reader, result, &error))
+    {
+        gemini_read_next_block(data);
+        return;
+    }
+
+    /* Text still held back belongs before the result */
+    ai_delta_buffer_flush(data->deltas);
 
     if (error != NULL)
     {
-        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-        {
-            g_task_return_error(data->task, g_steal_pointer(&error));
-            gemini_stream_data_free(data);
-        }
+        g_task_return_error(data->task, g_steal_pointer(&error));
+        gemini_stream_data_free(data);
         return;
     }
 
-    if (line == NULL)
+    /* EOF - finalize response */
+    if (data->response != NULL)
     {
-        /* EOF - finalize response */
-        if (data->response != NULL)
-        {
-            if (data->current_text != NULL && data->current_text->len > 0)
-            {
-                g_autoptr(AiTextContent) content = ai_text_content_new(data->current_text->str);
-                ai_response_add_content_block(data->response, (AiContentBlock *)g_steal_pointer(&content));
-            }
-
-            g_signal_emit_by_name(data->client, "stream-end", data->response);
-            g_task_return_pointer(data->task, g_object_ref(data->response), g_object_unref);
-        }
-        else
+        if (data->current_text != NULL && data->current_text->len > 0)
         {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
-                                    "Stream ended without valid response");
+            g_autoptr(AiTextContent) content = ai_text_content_new(data->current_text->str);
+            ai_response_add_content_block(data->response, (AiContentBlock *)g_steal_pointer(&content));
         }
-        gemini_stream_data_free(data);
-        return;
-    }
 
-    /* Gemini streaming returns SSE format: data: {json} */
-    if (g_str_has_prefix(line, "data: "))
+        ai_timing_mark(data->timing, AI_TIMING_TOTAL);
+        ai_response_set_timing(data->response, data->timing);
+        ai_delta_buffer_emit_stream_end(data->deltas, data->response);
+        g_task_return_pointer(data->task, g_object_ref(data->response), g_object_unref);
+    }
+    else
     {
-        gemini_process_stream_chunk(data, line + 6);
+        g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
+                                "Stream ended without valid response");
     }
+    gemini_stream_data_free(data);
+}
 
-    gemini_read_next_line(data);
+static gboolean
+on_gemini_unblocked(gpointer user_data)
+{
+    gemini_read_next_block(user_data);
+
+    return G_SOURCE_REMOVE;
 }
 
 static void
-gemini_read_next_line(GeminiStreamData *data)
+gemini_read_next_block(GeminiStreamData *data)
 {
-    g_data_input_stream_read_line_async(
-        data->data_stream,
-        G_PRIORITY_DEFAULT,
+    if (ai_delta_buffer_wait_for_space(data->deltas, on_gemini_unblocked, data))
+    {
+        return;
+    }
+
+    ai_stream_reader_read_async(
+        data->reader,
         data->cancellable,
-        on_gemini_line_read,
+        on_gemini_block_read,
         data);
 }
 
@@ -736,10 +848,8 @@ on_gemini_stream_ready(
     GeminiStreamData *data = user_data;
     g_autoptr(GError) error = NULL;
 
-    data->input_stream = soup_session_send_finish(
-        ai_client_get_soup_session(AI_CLIENT(data->client)),
-        result,
-        &error);
+    data->input_stream = ai_client_send_finish(
+        AI_CLIENT(data->client), result, &error);
 
     if (data->input_stream == NULL)
     {
@@ -748,121 +858,82 @@ on_gemini_stream_ready(
         return;
     }
 
-    if (!SOUP_STATUS_IS_SUCCESSFUL(soup_message_get_status(data->msg)))
-    {
-        guint status = soup_message_get_status(data->msg);
-
-        if (status == 401 || status == 403)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_API_KEY,
-                                    "Authentication failed (HTTP %u)", status);
-        }
-        else if (status == 429)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_RATE_LIMITED,
-                                    "Rate limited (HTTP %u)", status);
-        }
-        else
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_NETWORK_ERROR,
-                                    "Request failed (HTTP %u)", status);
-        }
-        gemini_stream_data_free(data);
-        return;
-    }
+    data->timing = ai_client_get_timing(AI_CLIENT(data->client), result);
 
-    data->data_stream = g_data_input_stream_new(data->input_stream);
-    g_data_input_stream_set_newline_type(data->data_stream, G_DATA_STREAM_NEWLINE_TYPE_ANY);
+    data->reader = ai_stream_reader_new(data->input_stream, AI_STREAM_FORMAT_SSE,
+                                        on_gemini_stream_event, data);
 
-    gemini_read_next_line(data);
-}
-
-static gchar *
-ai_gemini_client_get_stream_endpoint_url(AiClient *client)
-{
-    AiConfig *config = ai_client_get_config(client);
-    const gchar *base_url = ai_config_get_base_url(config, AI_PROVIDER_GEMINI);
-    const gchar *model = ai_client_get_model(client);
-    const gchar *api_key = ai_config_get_api_key(config, AI_PROVIDER_GEMINI);
-
-    if (model == NULL)
-    {
-        model = AI_GEMINI_DEFAULT_MODEL;
-    }
-
-    /* Use streamGenerateContent instead of generateContent */
-    return g_strdup_printf("%s/v1beta/models/%s:streamGenerateContent?alt=sse&key=%s",
-                           base_url, model, api_key != NULL ? api_key : "");
+    gemini_read_next_block(data);
 }
 
 static void
-ai_gemini_client_chat_stream_async(
-    AiStreamable        *streamable,
-    GList               *messages,
-    const gchar         *system_prompt,
-    gint                 max_tokens,
-    GList               *tools,
-    GCancellable        *cancellable,
-    GAsyncReadyCallback  callback,
-    gpointer             user_data
+ai_gemini_client_chat_stream_with_options_async(
+    AiStreamable           *streamable,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
 ){
     AiGeminiClient *self = AI_GEMINI_CLIENT(streamable);
-    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
-    g_autoptr(JsonNode) request_json = NULL;
     g_autoptr(SoupMessage) msg = NULL;
-    g_autofree gchar *url = NULL;
-    g_autofree gchar *request_body = NULL;
-    gsize request_len;
+    g_autoptr(GBytes) request_bytes = NULL;
+    GError *error = NULL;
     GeminiStreamData *data;
     GTask *task;
 
     task = g_task_new(self, cancellable, callback, user_data);
 
-    request_json = klass->build_request(AI_CLIENT(self), messages, system_prompt,
-                                        max_tokens, tools);
-
-    if (request_json == NULL)
+    /* Uses the streaming endpoint */
+    msg = ai_client_create_request(AI_CLIENT(self), messages, options, TRUE,
+                                   &request_bytes, &error);
+    if (msg == NULL)
     {
-        g_task_return_new_error(task, AI_ERROR, AI_ERROR_INVALID_REQUEST,
-                                "Failed to build request");
+        g_task_return_error(task, error);
         g_object_unref(task);
         return;
     }
 
-    {
-        g_autoptr(JsonGenerator) gen = json_generator_new();
-        json_generator_set_root(gen, request_json);
-        request_body = json_generator_to_data(gen, &request_len);
-    }
-
-    /* Use streaming endpoint */
-    url = ai_gemini_client_get_stream_endpoint_url(AI_CLIENT(self));
-
-    msg = soup_message_new("POST", url);
-    soup_message_headers_append(soup_message_get_request_headers(msg),
-                                "Content-Type", "application/json");
     soup_message_headers_append(soup_message_get_request_headers(msg),
                                 "Accept", "text/event-stream");
 
-    soup_message_set_request_body_from_bytes(msg, "application/json",
-        g_bytes_new_take(g_steal_pointer(&request_body), request_len));
-
     data = g_slice_new0(GeminiStreamData);
     data->client = g_object_ref(self);
     data->task = task;
-    data->msg = g_object_ref(msg);
     data->cancellable = cancellable != NULL ? g_object_ref(cancellable) : NULL;
+    data->deltas = ai_client_create_delta_buffer(AI_CLIENT(self), options);
     data->stream_started = FALSE;
 
-    soup_session_send_async(
-        ai_client_get_soup_session(AI_CLIENT(self)),
+    ai_client_send_async(
+        AI_CLIENT(self),
         msg,
-        G_PRIORITY_DEFAULT,
+        request_bytes,
         cancellable,
         on_gemini_stream_ready,
         data);
 }
 
+static void
+ai_gemini_client_chat_stream_async(
+    AiStreamable        *streamable,
+    GList               *messages,
+    const gchar         *system_prompt,
+    gint                 max_tokens,
+    GList               *tools,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    ai_gemini_client_chat_stream_with_options_async(streamable, messages, options,
+                                                    cancellable, callback, user_data);
+}
+
 static AiResponse *
 ai_gemini_client_chat_stream_finish(
     AiStreamable  *streamable,
@@ -878,6 +949,7 @@ ai_gemini_client_streamable_init(AiStreamableInterface *iface)
 {
     iface->chat_stream_async = ai_gemini_client_chat_stream_async;
     iface->chat_stream_finish = ai_gemini_client_chat_stream_finish;
+    iface->chat_stream_with_options_async = ai_gemini_client_chat_stream_with_options_async;
 }
 
 /*
@@ -900,7 +972,6 @@ typedef struct
 {
     AiGeminiClient *client;
     GTask          *task;
-    SoupMessage    *msg;
     gboolean        is_nano_banana;
 } GeminiImageGenData;
 
@@ -908,7 +979,6 @@ static void
 gemini_image_gen_data_free(GeminiImageGenData *data)
 {
     g_clear_object(&data->client);
-    g_clear_object(&data->msg);
     g_slice_free(GeminiImageGenData, data);
 }
 
@@ -1289,7 +1359,6 @@ on_gemini_image_response(
     g_autoptr(GBytes) response_bytes = NULL;
     g_autoptr(GError) error = NULL;
     g_autoptr(JsonParser) parser = NULL;
-    SoupMessage *msg = data->msg;
     const gchar *response_data;
     gsize response_len;
     JsonNode *response_json;
@@ -1297,8 +1366,8 @@ on_gemini_image_response(
 
     (void)source;
 
-    response_bytes = soup_session_send_and_read_finish(
-        ai_client_get_soup_session(AI_CLIENT(data->client)), result, &error);
+    response_bytes = ai_client_send_and_read_finish(
+        AI_CLIENT(data->client), result, &error);
 
     if (response_bytes == NULL)
     {
@@ -1307,32 +1376,6 @@ on_gemini_image_response(
         return;
     }
 
-    if (!SOUP_STATUS_IS_SUCCESSFUL(soup_message_get_status(msg)))
-    {
-        guint status = soup_message_get_status(msg);
-
-        if (status == 401 || status == 403)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_API_KEY,
-                                    "Authentication failed (HTTP %u)", status);
-        }
-        else if (status == 429)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_RATE_LIMITED,
-                                    "Rate limited (HTTP %u)", status);
-        }
-        else
-        {
-            response_data = g_bytes_get_data(response_bytes, &response_len);
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_SERVER_ERROR,
-                                    "Request failed (HTTP %u): %.*s", status,
-                                    (int)MIN(response_len, 200), response_data);
-        }
-
-        gemini_image_gen_data_free(data);
-        return;
-    }
-
     response_data = g_bytes_get_data(response_bytes, &response_len);
     parser = json_parser_new();
 
@@ -1380,6 +1423,7 @@ ai_gemini_client_generate_image_async(
     g_autoptr(SoupMessage) msg = NULL;
     g_autofree gchar *url = NULL;
     g_autofree gchar *request_body = NULL;
+    g_autoptr(GBytes) request_bytes = NULL;
     gsize request_len;
     AiConfig *config;
     const gchar *base_url;
@@ -1445,19 +1489,17 @@ ai_gemini_client_generate_image_async(
     soup_message_headers_append(soup_message_get_request_headers(msg),
                                 "Content-Type", "application/json");
 
-    soup_message_set_request_body_from_bytes(msg, "application/json",
-        g_bytes_new_take(g_steal_pointer(&request_body), request_len));
+    request_bytes = g_bytes_new_take(g_steal_pointer(&request_body), request_len);
 
     data = g_slice_new0(GeminiImageGenData);
     data->client = g_object_ref(self);
     data->task = task;
-    data->msg = g_object_ref(msg);
     data->is_nano_banana = is_nano_banana;
 
-    soup_session_send_and_read_async(
-        ai_client_get_soup_session(AI_CLIENT(self)),
+    ai_client_send_and_read_async(
+        AI_CLIENT(self),
         msg,
-        G_PRIORITY_DEFAULT,
+        request_bytes,
         cancellable,
         on_gemini_image_response,
         data);
@@ -11,6 +11,9 @@
 
 #include "providers/ai-ollama-client.h"
 #include "core/ai-error.h"
+#include "core/ai-json-writer.h"
+#include "core/ai-json-scanner.h"
+#include "core/ai-stream-reader.h"
 #include "model/ai-text-content.h"
 #include "model/ai-tool-use.h"
 
@@ -34,23 +37,25 @@ G_DEFINE_TYPE_WITH_CODE(AiOllamaClient, ai_ollama_client, AI_TYPE_CLIENT,
                                               ai_ollama_client_streamable_init))
 
 /*
- * Build Ollama API request.
+ * Build an Ollama API request for @options.
  */
 static JsonNode *
-ai_ollama_client_build_request(
-    AiClient    *client,
-    GList       *messages,
-    const gchar *system_prompt,
-    gint         max_tokens,
-    GList       *tools
+build_request_json(
+    GList                  *messages,
+    const AiRequestOptions *options,
+    gboolean                stream
 ){
     g_autoptr(JsonBuilder) builder = json_builder_new();
+    const gchar *system_prompt = ai_request_options_get_system_prompt(options);
+    gint max_tokens = ai_request_options_get_max_tokens(options);
+    const gchar * const *stop_sequences = ai_request_options_get_stop_sequences(options);
+    gdouble temp = ai_request_options_get_temperature(options);
     const gchar *model;
     GList *l;
 
-    (void)tools; /* TODO: Implement tool support */
+    /* TODO: Implement tool support */
 
-    model = ai_client_get_model(client);
+    model = ai_request_options_get_model(options);
     if (model == NULL)
     {
         model = AI_OLLAMA_DEFAULT_MODEL;
@@ -96,9 +101,9 @@ ai_ollama_client_build_request(
 
     json_builder_end_array(builder);
 
-    /* Disable streaming for sync requests */
+    /* Ollama streams unless told otherwise */
     json_builder_set_member_name(builder, "stream");
-    json_builder_add_boolean_value(builder, FALSE);
+    json_builder_add_boolean_value(builder, stream);
 
     /* Options */
     json_builder_set_member_name(builder, "options");
@@ -110,13 +115,23 @@ ai_ollama_client_build_request(
         json_builder_add_int_value(builder, max_tokens);
     }
 
+    if (temp != 1.0)
     {
-        gdouble temp = ai_client_get_temperature(client);
-        if (temp != 1.0)
+        json_builder_set_member_name(builder, "temperature");
+        json_builder_add_double_value(builder, temp);
+    }
+
+    if (stop_sequences != NULL)
+    {
+        guint i;
+
+        json_builder_set_member_name(builder, "stop");
+        json_builder_begin_array(builder);
+        for (i = 0; stop_sequences[i] != NULL; i++)
         {
-            json_builder_set_member_name(builder, "temperature");
-            json_builder_add_double_value(builder, temp);
+            json_builder_add_string_value(builder, stop_sequences[i]);
         }
+        json_builder_end_array(builder);
     }
 
     json_builder_end_object(builder);
@@ -126,6 +141,45 @@ ai_ollama_client_build_request(
     return json_builder_get_root(builder);
 }
 
+static JsonNode *
+ai_ollama_client_build_request(
+    AiClient    *client,
+    GList       *messages,
+    const gchar *system_prompt,
+    gint         max_tokens,
+    GList       *tools
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_model(options, ai_client_get_model(client));
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_temperature(options, ai_client_get_temperature(client));
+    ai_request_options_set_tools(options, tools);
+
+    return build_request_json(messages, options, FALSE);
+}
+
+static GBytes *
+ai_ollama_client_build_request_body(
+    AiClient               *client,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    gboolean                stream
+){
+    g_autoptr(JsonNode) request_json = NULL;
+    g_autoptr(AiJsonWriter) writer = NULL;
+
+    (void)client;
+
+    request_json = build_request_json(messages, options, stream);
+
+    writer = ai_json_writer_new(0);
+    ai_json_writer_add_node(writer, request_json);
+
+    return ai_json_writer_free_to_bytes(g_steal_pointer(&writer));
+}
+
 /*
  * Parse Ollama response.
  */
@@ -158,7 +212,9 @@ ai_ollama_client_parse_response(
         return NULL;
     }
 
-    response = ai_response_new("", ai_client_get_model(client));
+    /* The model is per request, so take it from the response */
+    response = ai_response_new("", json_object_get_string_member_with_default(
+        obj, "model", ai_client_get_model(client)));
 
     /* Parse done status */
     if (json_object_get_boolean_member_with_default(obj, "done", FALSE))
@@ -230,6 +286,7 @@ ai_ollama_client_class_init(AiOllamaClientClass *klass)
     AiClientClass *client_class = AI_CLIENT_CLASS(klass);
 
     client_class->build_request = ai_ollama_client_build_request;
+    client_class->build_request_body = ai_ollama_client_build_request_body;
     client_class->parse_response = ai_ollama_client_parse_response;
     client_class->get_endpoint_url = ai_ollama_client_get_endpoint_url;
     client_class->add_auth_headers = ai_ollama_client_add_auth_headers;
@@ -274,84 +331,26 @@ typedef struct
 {
     AiOllamaClient *client;
     GTask          *task;
-    SoupMessage    *msg;
 } OllamaChatAsyncData;
 
 static void
 ollama_chat_async_data_free(OllamaChatAsyncData *data)
 {
     g_clear_object(&data->client);
-    g_clear_object(&data->msg);
     g_slice_free(OllamaChatAsyncData, data);
 }
 
 static void
-on_ollama_chat_response(
+on_ollama_chat_parsed(
     GObject      *source,
     GAsyncResult *result,
     gpointer      user_data
 ){
     OllamaChatAsyncData *data = user_data;
-    g_autoptr(GBytes) response_bytes = NULL;
     g_autoptr(GError) error = NULL;
-    g_autoptr(JsonParser) parser = NULL;
-    SoupMessage *msg = data->msg;
-    const gchar *response_data;
-    gsize response_len;
-    JsonNode *response_json;
-    AiClientClass *klass;
     AiResponse *response;
 
-    (void)source;
-
-    response_bytes = soup_session_send_and_read_finish(
-        ai_client_get_soup_session(AI_CLIENT(data->client)), result, &error);
-
-    if (response_bytes == NULL)
-    {
-        g_task_return_error(data->task, g_steal_pointer(&error));
-        ollama_chat_async_data_free(data);
-        return;
-    }
-
-    if (!SOUP_STATUS_IS_SUCCESSFUL(soup_message_get_status(msg)))
-    {
-        guint status = soup_message_get_status(msg);
-
-        if (status == 401 || status == 403)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_API_KEY,
-                                    "Authentication failed (HTTP %u)", status);
-        }
-        else if (status == 429)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_RATE_LIMITED,
-                                    "Rate limited (HTTP %u)", status);
-        }
-        else
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_NETWORK_ERROR,
-                                    "Request failed (HTTP %u)", status);
-        }
-
-        ollama_chat_async_data_free(data);
-        return;
-    }
-
-    response_data = g_bytes_get_data(response_bytes, &response_len);
-    parser = json_parser_new();
-
-    if (!json_parser_load_from_data(parser, response_data, response_len, &error))
-    {
-        g_task_return_error(data->task, g_steal_pointer(&error));
-        ollama_chat_async_data_free(data);
-        return;
-    }
-
-    response_json = json_parser_get_root(parser);
-    klass = AI_CLIENT_GET_CLASS(data->client);
-
-    response = klass->parse_response(AI_CLIENT(data->client), response_json, &error);
+    response = ai_client_parse_chat_result_finish(AI_CLIENT(source), result, &error);
     if (response == NULL)
     {
         g_task_return_error(data->task, g_steal_pointer(&error));
@@ -365,68 +364,81 @@ on_ollama_chat_response(
 }
 
 static void
-ai_ollama_client_chat_async(
-    AiProvider          *provider,
-    GList               *messages,
-    const gchar         *system_prompt,
-    gint                 max_tokens,
-    GList               *tools,
-    GCancellable        *cancellable,
-    GAsyncReadyCallback  callback,
-    gpointer             user_data
+on_ollama_chat_response(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    OllamaChatAsyncData *data = user_data;
+
+    (void)source;
+
+    ai_client_parse_chat_result_async(AI_CLIENT(data->client), result,
+                                      g_task_get_cancellable(data->task),
+                                      on_ollama_chat_parsed, data);
+}
+
+static void
+ai_ollama_client_chat_with_options_async(
+    AiProvider             *provider,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
 ){
     AiOllamaClient *self = AI_OLLAMA_CLIENT(provider);
-    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
-    g_autoptr(JsonNode) request_json = NULL;
     g_autoptr(SoupMessage) msg = NULL;
-    g_autofree gchar *url = NULL;
-    g_autofree gchar *request_body = NULL;
+    g_autoptr(GBytes) request_bytes = NULL;
+    GError *error = NULL;
     OllamaChatAsyncData *data;
     GTask *task;
 
     task = g_task_new(self, cancellable, callback, user_data);
 
-    request_json = klass->build_request(AI_CLIENT(self), messages, system_prompt,
-                                        max_tokens, tools);
-    if (request_json == NULL)
+    msg = ai_client_create_request(AI_CLIENT(self), messages, options, FALSE,
+                                   &request_bytes, &error);
+    if (msg == NULL)
     {
-        g_task_return_new_error(task, AI_ERROR, AI_ERROR_INVALID_REQUEST,
-                                "Failed to build request");
+        g_task_return_error(task, error);
         g_object_unref(task);
         return;
     }
 
-    {
-        g_autoptr(JsonGenerator) gen = json_generator_new();
-        json_generator_set_root(gen, request_json);
-        request_body = json_generator_to_data(gen, NULL);
-    }
-
-    url = klass->get_endpoint_url(AI_CLIENT(self));
-
-    msg = soup_message_new("POST", url);
-    soup_message_headers_append(soup_message_get_request_headers(msg),
-                                "Content-Type", "application/json");
-
-    klass->add_auth_headers(AI_CLIENT(self), msg);
-
-    soup_message_set_request_body_from_bytes(msg, "application/json",
-        g_bytes_new_take(g_steal_pointer(&request_body), strlen(request_body)));
-
     data = g_slice_new0(OllamaChatAsyncData);
     data->client = g_object_ref(self);
     data->task = task;
-    data->msg = g_object_ref(msg);
 
-    soup_session_send_and_read_async(
-        ai_client_get_soup_session(AI_CLIENT(self)),
+    ai_client_send_and_read_async(
+        AI_CLIENT(self),
         msg,
-        G_PRIORITY_DEFAULT,
+        request_bytes,
         cancellable,
         on_ollama_chat_response,
         data);
 }
 
+static void
+ai_ollama_client_chat_async(
+    AiProvider          *provider,
+    GList               *messages,
+    const gchar         *system_prompt,
+    gint                 max_tokens,
+    GList               *tools,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    ai_ollama_client_chat_with_options_async(provider, messages, options,
+                                             cancellable, callback, user_data);
+}
+
 static AiResponse *
 ai_ollama_client_chat_finish(
     AiProvider    *provider,
@@ -479,6 +491,7 @@ ai_ollama_client_provider_init(AiProviderInterface *iface)
     iface->get_default_model = ai_ollama_client_get_default_model;
     iface->chat_async = ai_ollama_client_chat_async;
     iface->chat_finish = ai_ollama_client_chat_finish;
+    iface->chat_with_options_async = ai_ollama_client_chat_with_options_async;
     iface->list_models_async = ai_ollama_client_list_models_async;
     iface->list_models_finish = ai_ollama_client_list_models_finish;
 }
@@ -495,13 +508,15 @@ typedef struct
 {
     AiOllamaClient   *client;
     GTask            *task;
-    SoupMessage      *msg;
     GInputStream     *input_stream;
-    GDataInputStream *data_stream;
+    AiStreamReader   *reader;
     GCancellable     *cancellable;
+    AiTiming         *timing;
 
     AiResponse       *response;
     GString          *current_text;
+    GString          *scratch;     /* unescaped content, reused */
+    AiDeltaBuffer    *deltas;
 
     gboolean          stream_started;
 } OllamaStreamData;
@@ -510,37 +525,119 @@ static void
 ollama_stream_data_free(OllamaStreamData *data)
 {
     g_clear_object(&data->client);
-    g_clear_object(&data->msg);
+    g_clear_pointer(&data->reader, ai_stream_reader_free);
     g_clear_object(&data->input_stream);
-    g_clear_object(&data->data_stream);
     g_clear_object(&data->cancellable);
     g_clear_object(&data->response);
+    g_clear_pointer(&data->timing, ai_timing_free);
+    g_clear_pointer(&data->deltas, ai_delta_buffer_free);
 
     if (data->current_text != NULL)
     {
         g_string_free(data->current_text, TRUE);
     }
+    g_string_free(data->scratch, TRUE);
 
     g_slice_free(OllamaStreamData, data);
 }
 
+static void
+ollama_append_content(
+    OllamaStreamData *data,
+    const gchar      *content
+){
+    if (content[0] == '\0')
+    {
+        return;
+    }
+
+    g_string_append(data->current_text, content);
+    if (ai_timing_get_duration(data->timing, AI_TIMING_FIRST_TOKEN) == 0)
+    {
+        ai_timing_mark(data->timing, AI_TIMING_FIRST_TOKEN);
+    }
+    ai_delta_buffer_append(data->deltas, content);
+}
+
+/*
+ * Read a chunk that is not the last one without a JsonParser:
+ *   {"model":"...","created_at":"...",
+ *    "message":{"role":"assistant","content":"..."},"done":false}
+ * The content is unescaped into data->scratch. The final chunk, with
+ * done set, returns FALSE and is parsed for its usage.
+ */
+static gboolean
+ollama_scan_content_chunk(
+    OllamaStreamData *data,
+    const gchar      *json_str,
+    gsize             length
+){
+    AiJsonScanner scanner;
+    const gchar *name;
+    gsize name_len;
+    gboolean done = TRUE;
+
+    g_string_truncate(data->scratch, 0);
+    ai_json_scanner_init(&scanner, json_str, length);
+    ai_json_scanner_enter_object(&scanner);
+
+    while (ai_json_scanner_next_member(&scanner, &name, &name_len))
+    {
+        if (AI_JSON_SLICE_IS(name, name_len, "done"))
+        {
+            ai_json_scanner_read_boolean(&scanner, &done);
+        }
+        else if (AI_JSON_SLICE_IS(name, name_len, "message"))
+        {
+            ai_json_scanner_enter_object(&scanner);
+            while (ai_json_scanner_next_member(&scanner, &name, &name_len))
+            {
+                /* Only the content of a message is streamed */
+                if (AI_JSON_SLICE_IS(name, name_len, "content"))
+                {
+                    g_string_truncate(data->scratch, 0);
+                    ai_json_scanner_read_string(&scanner, data->scratch);
+                }
+                else
+                {
+                    ai_json_scanner_skip_value(&scanner);
+                }
+            }
+        }
+        else
+        {
+            ai_json_scanner_skip_value(&scanner);
+        }
+    }
+
+    return ai_json_scanner_at_end(&scanner) && !done;
+}
+
 static void
 ollama_process_stream_chunk(
     OllamaStreamData *data,
-    const gchar      *json_str
+    const gchar      *json_str,
+    gsize             length
 ){
     g_autoptr(JsonParser) parser = NULL;
     g_autoptr(GError) error = NULL;
     JsonNode *root;
     JsonObject *obj;
 
-    if (json_str == NULL || json_str[0] == '\0')
+    if (json_str == NULL || length == 0)
     {
         return;
     }
 
+    /* After the first chunk, content deltas skip the parser */
+    if (data->stream_started && ollama_scan_content_chunk(data, json_str, length))
+    {
+        ollama_append_content(data, data->scratch->str);
+        return;
+    }
+
     parser = json_parser_new();
-    if (!json_parser_load_from_data(parser, json_str, -1, &error))
+    if (!json_parser_load_from_data(parser, json_str, length, &error))
     {
         return;
     }
@@ -561,7 +658,7 @@ ollama_process_stream_chunk(
         data->current_text = g_string_new("");
         data->stream_started = TRUE;
 
-        g_signal_emit_by_name(data->client, "stream-start");
+        ai_delta_buffer_emit_stream_start(data->deltas);
     }
 
     /* Parse message content delta */
@@ -571,10 +668,9 @@ ollama_process_stream_chunk(
         const gchar *content = json_object_get_string_member_with_default(
             message, "content", "");
 
-        if (content != NULL && content[0] != '\0')
+        if (content != NULL)
         {
-            g_string_append(data->current_text, content);
-            g_signal_emit_by_name(data->client, "delta", content);
+            ollama_append_content(data, content);
         }
     }
 
@@ -612,70 +708,87 @@ ollama_process_stream_chunk(
             ai_response_add_content_block(data->response, (AiContentBlock *)g_steal_pointer(&text_content));
         }
 
-        g_signal_emit_by_name(data->client, "stream-end", data->response);
+        ai_timing_mark(data->timing, AI_TIMING_TOTAL);
+        ai_response_set_timing(data->response, data->timing);
+        ai_delta_buffer_emit_stream_end(data->deltas, data->response);
     }
 }
 
-static void ollama_read_next_line(OllamaStreamData *data);
+static gboolean
+on_ollama_stream_event(
+    const AiStreamEvent *event,
+    gpointer             user_data
+){
+    OllamaStreamData *data = user_data;
+
+    /* Ollama uses NDJSON - each line is a complete JSON object */
+    ollama_process_stream_chunk(data, event->data, event->data_len);
+
+    return !ai_delta_buffer_is_full(data->deltas);
+}
+
+static void ollama_read_next_block(OllamaStreamData *data);
 
 static void
-on_ollama_line_read(
+on_ollama_block_read(
     GObject      *source,
     GAsyncResult *result,
     gpointer      user_data
 ){
     OllamaStreamData *data = user_data;
     g_autoptr(GError) error = NULL;
-    g_autofree gchar *line = NULL;
-    gsize length;
 
     (void)source;
 
-    line = g_data_input_stream_read_line_finish(data->data_stream, result, &length, &error);
-
-    if (error != NULL)
+    if (ai_stream_reader_read_finish(data->reader, result, &error))
     {
-        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-        {
-            g_task_return_error(data->task, g_steal_pointer(&error));
-            ollama_stream_data_free(data);
-        }
+        ollama_read_next_block(data);
         return;
     }
 
-    if (line == NULL)
+    /* Text still held back belongs before the result */
+    ai_delta_buffer_flush(data->deltas);
+
+    if (error != NULL)
     {
-        /* EOF */
-        if (data->response != NULL)
-        {
-            g_task_return_pointer(data->task, g_object_ref(data->response), g_object_unref);
-        }
-        else
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
-                                    "Stream ended without valid response");
-        }
+        g_task_return_error(data->task, g_steal_pointer(&error));
         ollama_stream_data_free(data);
         return;
     }
 
-    /* Ollama uses NDJSON - each line is a complete JSON object */
-    if (length > 0)
+    /* EOF */
+    if (data->response != NULL)
     {
-        ollama_process_stream_chunk(data, line);
+        g_task_return_pointer(data->task, g_object_ref(data->response), g_object_unref);
     }
+    else
+    {
+        g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
+                                "Stream ended without valid response");
+    }
+    ollama_stream_data_free(data);
+}
 
-    ollama_read_next_line(data);
+static gboolean
+on_ollama_unblocked(gpointer user_data)
+{
+    ollama_read_next_block(user_data);
+
+    return G_SOURCE_REMOVE;
 }
 
 static void
-ollama_read_next_line(OllamaStreamData *data)
+ollama_read_next_block(OllamaStreamData *data)
 {
-    g_data_input_stream_read_line_async(
-        data->data_stream,
-        G_PRIORITY_DEFAULT,
+    if (ai_delta_buffer_wait_for_space(data->deltas, on_ollama_unblocked, data))
+    {
+        return;
+    }
+
+    ai_stream_reader_read_async(
+        data->reader,
         data->cancellable,
-        on_ollama_line_read,
+        on_ollama_block_read,
         data);
 }
 
@@ -688,10 +801,8 @@ on_ollama_stream_ready(
     OllamaStreamData *data = user_data;
     g_autoptr(GError) error = NULL;
 
-    data->input_stream = soup_session_send_finish(
-        ai_client_get_soup_session(AI_CLIENT(data->client)),
-        result,
-        &error);
+    data->input_stream = ai_client_send_finish(
+        AI_CLIENT(data->client), result, &error);
 
     if (data->input_stream == NULL)
     {
@@ -700,184 +811,79 @@ on_ollama_stream_ready(
         return;
     }
 
-    if (!SOUP_STATUS_IS_SUCCESSFUL(soup_message_get_status(data->msg)))
-    {
-        guint status = soup_message_get_status(data->msg);
-
-        if (status == 401 || status == 403)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_API_KEY,
-                                    "Authentication failed (HTTP %u)", status);
-        }
-        else if (status == 429)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_RATE_LIMITED,
-                                    "Rate limited (HTTP %u)", status);
-        }
-        else
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_NETWORK_ERROR,
-                                    "Request failed (HTTP %u)", status);
-        }
-        ollama_stream_data_free(data);
-        return;
-    }
-
-    data->data_stream = g_data_input_stream_new(data->input_stream);
-    g_data_input_stream_set_newline_type(data->data_stream, G_DATA_STREAM_NEWLINE_TYPE_ANY);
-
-    ollama_read_next_line(data);
-}
-
-static JsonNode *
-ai_ollama_client_build_stream_request(
-    AiClient    *client,
-    GList       *messages,
-    const gchar *system_prompt,
-    gint         max_tokens,
-    GList       *tools
-){
-    g_autoptr(JsonBuilder) builder = json_builder_new();
-    const gchar *model;
-    GList *l;
-
-    (void)tools; /* TODO: Implement tool support */
-
-    model = ai_client_get_model(client);
-    if (model == NULL)
-    {
-        model = AI_OLLAMA_DEFAULT_MODEL;
-    }
-
-    json_builder_begin_object(builder);
-
-    json_builder_set_member_name(builder, "model");
-    json_builder_add_string_value(builder, model);
-
-    json_builder_set_member_name(builder, "messages");
-    json_builder_begin_array(builder);
-
-    if (system_prompt != NULL && system_prompt[0] != '\0')
-    {
-        json_builder_begin_object(builder);
-        json_builder_set_member_name(builder, "role");
-        json_builder_add_string_value(builder, "system");
-        json_builder_set_member_name(builder, "content");
-        json_builder_add_string_value(builder, system_prompt);
-        json_builder_end_object(builder);
-    }
-
-    for (l = messages; l != NULL; l = l->next)
-    {
-        AiMessage *msg = l->data;
-        AiRole role = ai_message_get_role(msg);
-        g_autofree gchar *text = ai_message_get_text(msg);
+    data->timing = ai_client_get_timing(AI_CLIENT(data->client), result);
 
-        json_builder_begin_object(builder);
-        json_builder_set_member_name(builder, "role");
-        json_builder_add_string_value(builder, ai_role_to_string(role));
-        json_builder_set_member_name(builder, "content");
-        json_builder_add_string_value(builder, text != NULL ? text : "");
-        json_builder_end_object(builder);
-    }
-
-    json_builder_end_array(builder);
+    data->reader = ai_stream_reader_new(data->input_stream, AI_STREAM_FORMAT_NDJSON,
+                                        on_ollama_stream_event, data);
 
-    /* Enable streaming */
-    json_builder_set_member_name(builder, "stream");
-    json_builder_add_boolean_value(builder, TRUE);
-
-    /* Options */
-    json_builder_set_member_name(builder, "options");
-    json_builder_begin_object(builder);
-
-    if (max_tokens > 0)
-    {
-        json_builder_set_member_name(builder, "num_predict");
-        json_builder_add_int_value(builder, max_tokens);
-    }
-
-    {
-        gdouble temp = ai_client_get_temperature(client);
-        if (temp != 1.0)
-        {
-            json_builder_set_member_name(builder, "temperature");
-            json_builder_add_double_value(builder, temp);
-        }
-    }
-
-    json_builder_end_object(builder);
-
-    json_builder_end_object(builder);
-
-    return json_builder_get_root(builder);
+    ollama_read_next_block(data);
 }
 
 static void
-ai_ollama_client_chat_stream_async(
-    AiStreamable        *streamable,
-    GList               *messages,
-    const gchar         *system_prompt,
-    gint                 max_tokens,
-    GList               *tools,
-    GCancellable        *cancellable,
-    GAsyncReadyCallback  callback,
-    gpointer             user_data
+ai_ollama_client_chat_stream_with_options_async(
+    AiStreamable           *streamable,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
 ){
     AiOllamaClient *self = AI_OLLAMA_CLIENT(streamable);
-    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
-    g_autoptr(JsonNode) request_json = NULL;
     g_autoptr(SoupMessage) msg = NULL;
-    g_autofree gchar *url = NULL;
-    g_autofree gchar *request_body = NULL;
-    gsize request_len;
+    g_autoptr(GBytes) request_bytes = NULL;
+    GError *error = NULL;
     OllamaStreamData *data;
     GTask *task;
 
     task = g_task_new(self, cancellable, callback, user_data);
 
-    request_json = ai_ollama_client_build_stream_request(
-        AI_CLIENT(self), messages, system_prompt, max_tokens, tools);
-
-    if (request_json == NULL)
+    msg = ai_client_create_request(AI_CLIENT(self), messages, options, TRUE,
+                                   &request_bytes, &error);
+    if (msg == NULL)
     {
-        g_task_return_new_error(task, AI_ERROR, AI_ERROR_INVALID_REQUEST,
-                                "Failed to build request");
+        g_task_return_error(task, error);
         g_object_unref(task);
         return;
     }
 
-    {
-        g_autoptr(JsonGenerator) gen = json_generator_new();
-        json_generator_set_root(gen, request_json);
-        request_body = json_generator_to_data(gen, &request_len);
-    }
-
-    url = klass->get_endpoint_url(AI_CLIENT(self));
-
-    msg = soup_message_new("POST", url);
-    soup_message_headers_append(soup_message_get_request_headers(msg),
-                                "Content-Type", "application/json");
-
-    soup_message_set_request_body_from_bytes(msg, "application/json",
-        g_bytes_new_take(g_steal_pointer(&request_body), request_len));
-
     data = g_slice_new0(OllamaStreamData);
     data->client = g_object_ref(self);
     data->task = task;
-    data->msg = g_object_ref(msg);
     data->cancellable = cancellable != NULL ? g_object_ref(cancellable) : NULL;
+    data->scratch = g_string_sized_new(256);
+    data->deltas = ai_client_create_delta_buffer(AI_CLIENT(self), options);
     data->stream_started = FALSE;
 
-    soup_session_send_async(
-        ai_client_get_soup_session(AI_CLIENT(self)),
+    ai_client_send_async(
+        AI_CLIENT(self),
         msg,
-        G_PRIORITY_DEFAULT,
+        request_bytes,
         cancellable,
         on_ollama_stream_ready,
         data);
 }
 
+static void
+ai_ollama_client_chat_stream_async(
+    AiStreamable        *streamable,
+    GList               *messages,
+    const gchar         *system_prompt,
+    gint                 max_tokens,
+    GList               *tools,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    ai_ollama_client_chat_stream_with_options_async(streamable, messages, options,
+                                                    cancellable, callback, user_data);
+}
+
 static AiResponse *
 ai_ollama_client_chat_stream_finish(
     AiStreamable  *streamable,
@@ -893,6 +899,7 @@ ai_ollama_client_streamable_init(AiStreamableInterface *iface)
 {
     iface->chat_stream_async = ai_ollama_client_chat_stream_async;
     iface->chat_stream_finish = ai_ollama_client_chat_stream_finish;
+    iface->chat_stream_with_options_async = ai_ollama_client_chat_stream_with_options_async;
 }
 
 /*
@@ -11,6 +11,9 @@
 
 #include "providers/ai-openai-client.h"
 #include "core/ai-error.h"
+#include "core/ai-json-writer.h"
+#include "core/ai-json-scanner.h"
+#include "core/ai-stream-reader.h"
 #include "core/ai-image-generator.h"
 #include "model/ai-text-content.h"
 #include "model/ai-tool-use.h"
@@ -135,6 +138,120 @@ ai_openai_client_build_request(
     return json_builder_get_root(builder);
 }
 
+/*
+ * Write the request body straight from the messages. Matches
+ * build_request, plus the streaming options when @stream is set.
+ */
+static GBytes *
+ai_openai_client_build_request_body(
+    AiClient               *client,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    gboolean                stream
+){
+    g_autoptr(AiJsonWriter) writer = NULL;
+    const gchar *system_prompt = ai_request_options_get_system_prompt(options);
+    gint max_tokens = ai_request_options_get_max_tokens(options);
+    GList *tools = ai_request_options_get_tools(options);
+    const gchar * const *stop_sequences;
+    const gchar *model;
+    gdouble temp;
+    GList *l;
+    guint i;
+
+    (void)client;
+
+    model = ai_request_options_get_model(options);
+    if (model == NULL)
+    {
+        model = AI_OPENAI_DEFAULT_MODEL;
+    }
+
+    writer = ai_json_writer_new(0);
+
+    ai_json_writer_begin_object(writer);
+
+    ai_json_writer_set_member_name(writer, "model");
+    ai_json_writer_add_string_value(writer, model);
+
+    if (stream)
+    {
+        ai_json_writer_set_member_name(writer, "stream");
+        ai_json_writer_add_boolean_value(writer, TRUE);
+
+        /* Request usage in stream */
+        ai_json_writer_set_member_name(writer, "stream_options");
+        ai_json_writer_begin_object(writer);
+        ai_json_writer_set_member_name(writer, "include_usage");
+        ai_json_writer_add_boolean_value(writer, TRUE);
+        ai_json_writer_end_object(writer);
+    }
+
+    if (max_tokens > 0)
+    {
+        ai_json_writer_set_member_name(writer, "max_tokens");
+        ai_json_writer_add_int_value(writer, max_tokens);
+    }
+
+    ai_json_writer_set_member_name(writer, "messages");
+    ai_json_writer_begin_array(writer);
+
+    if (system_prompt != NULL && system_prompt[0] != '\0')
+    {
+        ai_json_writer_begin_object(writer);
+        ai_json_writer_set_member_name(writer, "role");
+        ai_json_writer_add_string_value(writer, "system");
+        ai_json_writer_set_member_name(writer, "content");
+        ai_json_writer_add_string_value(writer, system_prompt);
+        ai_json_writer_end_object(writer);
+    }
+
+    for (l = messages; l != NULL; l = l->next)
+    {
+        ai_message_write_json(AI_MESSAGE(l->data), writer);
+    }
+
+    ai_json_writer_end_array(writer);
+
+    if (tools != NULL)
+    {
+        ai_json_writer_set_member_name(writer, "tools");
+        ai_json_writer_begin_array(writer);
+
+        for (l = tools; l != NULL; l = l->next)
+        {
+            g_autoptr(JsonNode) tool_node = ai_tool_to_json(AI_TOOL(l->data), AI_PROVIDER_OPENAI);
+
+            ai_json_writer_add_node(writer, tool_node);
+        }
+
+        ai_json_writer_end_array(writer);
+    }
+
+    temp = ai_request_options_get_temperature(options);
+    if (temp != 1.0)
+    {
+        ai_json_writer_set_member_name(writer, "temperature");
+        ai_json_writer_add_double_value(writer, temp);
+    }
+
+    stop_sequences = ai_request_options_get_stop_sequences(options);
+    if (stop_sequences != NULL)
+    {
+        ai_json_writer_set_member_name(writer, "stop");
+        ai_json_writer_begin_array(writer);
+        for (i = 0; stop_sequences[i] != NULL; i++)
+        {
+            ai_json_writer_add_string_value(writer, stop_sequences[i]);
+        }
+        ai_json_writer_end_array(writer);
+    }
+
+    ai_json_writer_end_object(writer);
+
+    return ai_json_writer_free_to_bytes(g_steal_pointer(&writer));
+}
+
 /*
  * Parse OpenAI's response JSON into an AiResponse.
  */
@@ -287,6 +404,23 @@ ai_openai_client_add_auth_headers(
     }
 }
 
+/*
+ * Send the request with another key of the pool.
+ */
+static void
+ai_openai_client_set_api_key(
+    AiClient    *client,
+    SoupMessage *msg,
+    const gchar *api_key
+){
+    g_autofree gchar *auth_header = g_strdup_printf("Bearer %s", api_key);
+
+    (void)client;
+
+    soup_message_headers_replace(soup_message_get_request_headers(msg),
+                                 "Authorization", auth_header);
+}
+
 static void
 ai_openai_client_class_init(AiOpenAIClientClass *klass)
 {
@@ -294,9 +428,11 @@ ai_openai_client_class_init(AiOpenAIClientClass *klass)
 
     /* Override virtual methods */
     client_class->build_request = ai_openai_client_build_request;
+    client_class->build_request_body = ai_openai_client_build_request_body;
     client_class->parse_response = ai_openai_client_parse_response;
     client_class->get_endpoint_url = ai_openai_client_get_endpoint_url;
     client_class->add_auth_headers = ai_openai_client_add_auth_headers;
+    client_class->set_api_key = ai_openai_client_set_api_key;
 }
 
 static void
@@ -340,84 +476,26 @@ typedef struct
 {
     AiOpenAIClient *client;
     GTask          *task;
-    SoupMessage    *msg;
 } OpenAIChatAsyncData;
 
 static void
 openai_chat_async_data_free(OpenAIChatAsyncData *data)
 {
     g_clear_object(&data->client);
-    g_clear_object(&data->msg);
     g_slice_free(OpenAIChatAsyncData, data);
 }
 
 static void
-on_openai_chat_response(
+on_openai_chat_parsed(
     GObject      *source,
     GAsyncResult *result,
     gpointer      user_data
 ){
     OpenAIChatAsyncData *data = user_data;
-    g_autoptr(GBytes) response_bytes = NULL;
     g_autoptr(GError) error = NULL;
-    g_autoptr(JsonParser) parser = NULL;
-    SoupMessage *msg = data->msg;
-    const gchar *response_data;
-    gsize response_len;
-    JsonNode *response_json;
-    AiClientClass *klass;
     AiResponse *response;
 
-    (void)source;
-
-    response_bytes = soup_session_send_and_read_finish(
-        ai_client_get_soup_session(AI_CLIENT(data->client)), result, &error);
-
-    if (response_bytes == NULL)
-    {
-        g_task_return_error(data->task, g_steal_pointer(&error));
-        openai_chat_async_data_free(data);
-        return;
-    }
-
-    if (!SOUP_STATUS_IS_SUCCESSFUL(soup_message_get_status(msg)))
-    {
-        guint status = soup_message_get_status(msg);
-
-        if (status == 401 || status == 403)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_API_KEY,
-                                    "Authentication failed (HTTP %u)", status);
-        }
-        else if (status == 429)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_RATE_LIMITED,
-                                    "Rate limited (HTTP %u)", status);
-        }
-        else
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_NETWORK_ERROR,
-                                    "Request failed (HTTP %u)", status);
-        }
-
-        openai_chat_async_data_free(data);
-        return;
-    }
-
-    response_data = g_bytes_get_data(response_bytes, &response_len);
-    parser = json_parser_new();
-
-    if (!json_parser_load_from_data(parser, response_data, response_len, &error))
-    {
-        g_task_return_error(data->task, g_steal_pointer(&error));
-        openai_chat_async_data_free(data);
-        return;
-    }
-
-    response_json = json_parser_get_root(parser);
-    klass = AI_CLIENT_GET_CLASS(data->client);
-
-    response = klass->parse_response(AI_CLIENT(data->client), response_json, &error);
+    response = ai_client_parse_chat_result_finish(AI_CLIENT(source), result, &error);
     if (response == NULL)
     {
         g_task_return_error(data->task, g_steal_pointer(&error));
@@ -431,68 +509,81 @@ on_openai_chat_response(
 }
 
 static void
-ai_openai_client_chat_async(
-    AiProvider          *provider,
-    GList               *messages,
-    const gchar         *system_prompt,
-    gint                 max_tokens,
-    GList               *tools,
-    GCancellable        *cancellable,
-    GAsyncReadyCallback  callback,
-    gpointer             user_data
+on_openai_chat_response(
+    GObject      *source,
+    GAsyncResult *result,
+    gpointer      user_data
+){
+    OpenAIChatAsyncData *data = user_data;
+
+    (void)source;
+
+    ai_client_parse_chat_result_async(AI_CLIENT(data->client), result,
+                                      g_task_get_cancellable(data->task),
+                                      on_openai_chat_parsed, data);
+}
+
+static void
+ai_openai_client_chat_with_options_async(
+    AiProvider             *provider,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
 ){
     AiOpenAIClient *self = AI_OPENAI_CLIENT(provider);
-    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
-    g_autoptr(JsonNode) request_json = NULL;
     g_autoptr(SoupMessage) msg = NULL;
-    g_autofree gchar *url = NULL;
-    g_autofree gchar *request_body = NULL;
+    g_autoptr(GBytes) request_bytes = NULL;
+    GError *error = NULL;
     OpenAIChatAsyncData *data;
     GTask *task;
 
     task = g_task_new(self, cancellable, callback, user_data);
 
-    request_json = klass->build_request(AI_CLIENT(self), messages, system_prompt,
-                                        max_tokens, tools);
-    if (request_json == NULL)
+    msg = ai_client_create_request(AI_CLIENT(self), messages, options, FALSE,
+                                   &request_bytes, &error);
+    if (msg == NULL)
     {
-        g_task_return_new_error(task, AI_ERROR, AI_ERROR_INVALID_REQUEST,
-                                "Failed to build request");
+        g_task_return_error(task, error);
         g_object_unref(task);
         return;
     }
 
-    {
-        g_autoptr(JsonGenerator) gen = json_generator_new();
-        json_generator_set_root(gen, request_json);
-        request_body = json_generator_to_data(gen, NULL);
-    }
-
-    url = klass->get_endpoint_url(AI_CLIENT(self));
-
-    msg = soup_message_new("POST", url);
-    soup_message_headers_append(soup_message_get_request_headers(msg),
-                                "Content-Type", "application/json");
-
-    klass->add_auth_headers(AI_CLIENT(self), msg);
-
-    soup_message_set_request_body_from_bytes(msg, "application/json",
-        g_bytes_new_take(g_steal_pointer(&request_body), strlen(request_body)));
-
     data = g_slice_new0(OpenAIChatAsyncData);
     data->client = g_object_ref(self);
     data->task = task;
-    data->msg = g_object_ref(msg);
 
-    soup_session_send_and_read_async(
-        ai_client_get_soup_session(AI_CLIENT(self)),
+    ai_client_send_and_read_async(
+        AI_CLIENT(self),
         msg,
-        G_PRIORITY_DEFAULT,
+        request_bytes,
         cancellable,
         on_openai_chat_response,
         data);
 }
 
+static void
+ai_openai_client_chat_async(
+    AiProvider          *provider,
+    GList               *messages,
+    const gchar         *system_prompt,
+    gint                 max_tokens,
+    GList               *tools,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    ai_openai_client_chat_with_options_async(provider, messages, options,
+                                             cancellable, callback, user_data);
+}
+
 static AiResponse *
 ai_openai_client_chat_finish(
     AiProvider    *provider,
@@ -544,6 +635,7 @@ ai_openai_client_provider_init(AiProviderInterface *iface)
     iface->get_default_model = ai_openai_client_get_default_model;
     iface->chat_async = ai_openai_client_chat_async;
     iface->chat_finish = ai_openai_client_chat_finish;
+    iface->chat_with_options_async = ai_openai_client_chat_with_options_async;
     iface->list_models_async = ai_openai_client_list_models_async;
     iface->list_models_finish = ai_openai_client_list_models_finish;
 }
@@ -560,20 +652,19 @@ typedef struct
 {
     AiOpenAIClient   *client;
     GTask            *task;
-    SoupMessage      *msg;
     GInputStream     *input_stream;
-    GDataInputStream *data_stream;
+    AiStreamReader   *reader;
     GCancellable     *cancellable;
+    AiTiming         *timing;
 
     /* Response being built */
     AiResponse       *response;
     GString          *current_text;
+    GString          *scratch;     /* unescaped content, reused */
+    AiDeltaBuffer    *deltas;
 
     /* Tool call accumulation */
-    GHashTable       *tool_calls;  /* id -> {name, arguments} */
-
-    /* SSE parsing state */
-    gchar            *current_event_data;
+    GPtrArray        *tool_calls;  /* of OpenAIToolCall, by index */
 
     /* State tracking */
     gboolean          stream_started;
@@ -581,14 +672,18 @@ typedef struct
 
 typedef struct
 {
-    gchar   *name;
-    GString *arguments;
+    gchar     *id;
+    gchar     *name;
+    GString   *arguments;
+    AiToolUse *tool_use;   /* set once the call is complete */
 } OpenAIToolCall;
 
 static void
 openai_tool_call_free(OpenAIToolCall *tc)
 {
+    g_free(tc->id);
     g_free(tc->name);
+    g_clear_object(&tc->tool_use);
     if (tc->arguments != NULL)
     {
         g_string_free(tc->arguments, TRUE);
@@ -600,36 +695,250 @@ static void
 openai_stream_data_free(OpenAIStreamData *data)
 {
     g_clear_object(&data->client);
-    g_clear_object(&data->msg);
+    g_clear_pointer(&data->reader, ai_stream_reader_free);
     g_clear_object(&data->input_stream);
-    g_clear_object(&data->data_stream);
     g_clear_object(&data->cancellable);
     g_clear_object(&data->response);
+    g_clear_pointer(&data->timing, ai_timing_free);
+    g_clear_pointer(&data->deltas, ai_delta_buffer_free);
 
     if (data->current_text != NULL)
     {
         g_string_free(data->current_text, TRUE);
     }
-    if (data->tool_calls != NULL)
+    g_clear_pointer(&data->tool_calls, g_ptr_array_unref);
+    g_string_free(data->scratch, TRUE);
+
+    g_slice_free(OpenAIStreamData, data);
+}
+
+static void
+openai_append_content(
+    OpenAIStreamData *data,
+    const gchar      *content
+){
+    g_string_append(data->current_text, content);
+    if (ai_timing_get_duration(data->timing, AI_TIMING_FIRST_TOKEN) == 0)
     {
-        g_hash_table_destroy(data->tool_calls);
+        ai_timing_mark(data->timing, AI_TIMING_FIRST_TOKEN);
     }
-    g_clear_pointer(&data->current_event_data, g_free);
+    ai_delta_buffer_append(data->deltas, content);
+}
 
-    g_slice_free(OpenAIStreamData, data);
+/*
+ * Tool calls stream one after another, in fragments that carry the
+ * call's index. A call is complete once a later one starts or the
+ * choice finishes; complete calls are emitted right away, so a tool
+ * can run while the rest of the response is still generating.
+ */
+static void
+openai_complete_tool_calls(
+    OpenAIStreamData *data,
+    guint             n_calls
+){
+    guint i;
+
+    if (data->tool_calls == NULL)
+    {
+        return;
+    }
+
+    for (i = 0; i < MIN(n_calls, data->tool_calls->len); i++)
+    {
+        OpenAIToolCall *tc = g_ptr_array_index(data->tool_calls, i);
+
+        if (tc->tool_use != NULL)
+        {
+            continue;
+        }
+
+        tc->tool_use = ai_tool_use_new_from_json_string(
+            tc->id != NULL ? tc->id : "",
+            tc->name != NULL ? tc->name : "",
+            tc->arguments->str);
+        ai_delta_buffer_emit_tool_use(data->deltas, tc->tool_use);
+    }
+}
+
+/*
+ * Get the call a fragment belongs to. Returns NULL for an index that
+ * skips ahead, which a conforming stream never sends.
+ */
+static OpenAIToolCall *
+openai_get_tool_call(
+    OpenAIStreamData *data,
+    gint64            index
+){
+    OpenAIToolCall *tc;
+
+    if (data->tool_calls == NULL)
+    {
+        data->tool_calls = g_ptr_array_new_with_free_func(
+            (GDestroyNotify)openai_tool_call_free);
+    }
+
+    if (index < 0 || index > (gint64)data->tool_calls->len)
+    {
+        return NULL;
+    }
+
+    if (index < (gint64)data->tool_calls->len)
+    {
+        return g_ptr_array_index(data->tool_calls, index);
+    }
+
+    /* A new call has started, so every earlier one is complete */
+    openai_complete_tool_calls(data, data->tool_calls->len);
+
+    tc = g_slice_new0(OpenAIToolCall);
+    tc->arguments = g_string_new("");
+    g_ptr_array_add(data->tool_calls, tc);
+
+    return tc;
+}
+
+static void
+openai_append_tool_input(
+    OpenAIStreamData *data,
+    OpenAIToolCall   *tc,
+    const gchar      *partial
+){
+    if (partial == NULL || partial[0] == '\0' || tc->tool_use != NULL)
+    {
+        return;
+    }
+
+    g_string_append(tc->arguments, partial);
+    ai_delta_buffer_emit_tool_input_delta(data->deltas, tc->id, partial);
+}
+
+/*
+ * Read one choice of a content chunk. Its delta may only hold content
+ * and a role; any other non-null member, such as tool_calls, and a
+ * finish_reason make the whole chunk go through the parser.
+ */
+static gboolean
+openai_scan_choice(
+    AiJsonScanner *scanner,
+    GString       *content,
+    gboolean      *has_content
+){
+    const gchar *name;
+    gsize name_len;
+
+    ai_json_scanner_enter_object(scanner);
+    while (ai_json_scanner_next_member(scanner, &name, &name_len))
+    {
+        if (AI_JSON_SLICE_IS(name, name_len, "finish_reason"))
+        {
+            if (!ai_json_scanner_read_null(scanner))
+            {
+                return FALSE;
+            }
+        }
+        else if (AI_JSON_SLICE_IS(name, name_len, "delta"))
+        {
+            ai_json_scanner_enter_object(scanner);
+            while (ai_json_scanner_next_member(scanner, &name, &name_len))
+            {
+                if (AI_JSON_SLICE_IS(name, name_len, "content"))
+                {
+                    if (*has_content)
+                    {
+                        return FALSE;
+                    }
+                    if (!ai_json_scanner_read_null(scanner))
+                    {
+                        *has_content = ai_json_scanner_read_string(scanner, content);
+                    }
+                }
+                else if (AI_JSON_SLICE_IS(name, name_len, "role"))
+                {
+                    ai_json_scanner_skip_value(scanner);
+                }
+                else if (!ai_json_scanner_read_null(scanner))
+                {
+                    return FALSE;
+                }
+            }
+        }
+        else
+        {
+            ai_json_scanner_skip_value(scanner);
+        }
+    }
+
+    return TRUE;
+}
+
+/*
+ * Read a content chunk without a JsonParser:
+ *   {"id":...,"choices":[{"index":0,"delta":{"content":"..."},
+ *    "finish_reason":null}]}
+ * The content is unescaped into data->scratch. Chunks of any other
+ * shape, including the first one, the last ones with a finish_reason
+ * or usage, and tool call deltas, return FALSE.
+ */
+static gboolean
+openai_scan_content_chunk(
+    OpenAIStreamData *data,
+    const gchar      *json_str,
+    gsize             length,
+    gboolean         *has_content
+){
+    AiJsonScanner scanner;
+    const gchar *name;
+    gsize name_len;
+    guint n_choices = 0;
+
+    *has_content = FALSE;
+    g_string_truncate(data->scratch, 0);
+    ai_json_scanner_init(&scanner, json_str, length);
+    ai_json_scanner_enter_object(&scanner);
+
+    while (ai_json_scanner_next_member(&scanner, &name, &name_len))
+    {
+        if (AI_JSON_SLICE_IS(name, name_len, "usage"))
+        {
+            if (!ai_json_scanner_read_null(&scanner))
+            {
+                return FALSE;
+            }
+        }
+        else if (AI_JSON_SLICE_IS(name, name_len, "choices"))
+        {
+            ai_json_scanner_enter_array(&scanner);
+            while (ai_json_scanner_next_element(&scanner))
+            {
+                if (n_choices++ > 0
+                    || !openai_scan_choice(&scanner, data->scratch, has_content))
+                {
+                    return FALSE;
+                }
+            }
+        }
+        else
+        {
+            ai_json_scanner_skip_value(&scanner);
+        }
+    }
+
+    return ai_json_scanner_at_end(&scanner) && n_choices == 1;
 }
 
 static void
 openai_process_stream_chunk(
     OpenAIStreamData *data,
-    const gchar      *json_str
+    const gchar      *json_str,
+    gsize             length
 ){
     g_autoptr(JsonParser) parser = NULL;
     g_autoptr(GError) error = NULL;
     JsonNode *root;
     JsonObject *obj;
+    gboolean has_content;
 
-    if (json_str == NULL || json_str[0] == '\0')
+    if (json_str == NULL || length == 0)
     {
         return;
     }
@@ -637,6 +946,8 @@ openai_process_stream_chunk(
     /* Check for [DONE] marker */
     if (g_strcmp0(json_str, "[DONE]") == 0)
     {
+        openai_complete_tool_calls(data, G_MAXUINT);
+
         /* Finalize response */
         if (data->current_text != NULL && data->current_text->len > 0)
         {
@@ -647,26 +958,36 @@ openai_process_stream_chunk(
         /* Add accumulated tool calls */
         if (data->tool_calls != NULL)
         {
-            GHashTableIter iter;
-            gpointer key, value;
+            guint i;
 
-            g_hash_table_iter_init(&iter, data->tool_calls);
-            while (g_hash_table_iter_next(&iter, &key, &value))
+            for (i = 0; i < data->tool_calls->len; i++)
             {
-                const gchar *tc_id = key;
-                OpenAIToolCall *tc = value;
-                g_autoptr(AiToolUse) tool_use = ai_tool_use_new_from_json_string(
-                    tc_id, tc->name, tc->arguments->str);
-                ai_response_add_content_block(data->response, (AiContentBlock *)g_steal_pointer(&tool_use));
+                OpenAIToolCall *tc = g_ptr_array_index(data->tool_calls, i);
+
+                ai_response_add_content_block(data->response,
+                                              (AiContentBlock *)g_object_ref(tc->tool_use));
             }
         }
 
-        g_signal_emit_by_name(data->client, "stream-end", data->response);
+        ai_timing_mark(data->timing, AI_TIMING_TOTAL);
+        ai_response_set_timing(data->response, data->timing);
+        ai_delta_buffer_emit_stream_end(data->deltas, data->response);
+        return;
+    }
+
+    /* After the first chunk, content deltas skip the parser */
+    if (data->stream_started
+        && openai_scan_content_chunk(data, json_str, length, &has_content))
+    {
+        if (has_content)
+        {
+            openai_append_content(data, data->scratch->str);
+        }
         return;
     }
 
     parser = json_parser_new();
-    if (!json_parser_load_from_data(parser, json_str, -1, &error))
+    if (!json_parser_load_from_data(parser, json_str, length, &error))
     {
         g_debug("Failed to parse OpenAI SSE chunk: %s", error->message);
         return;
@@ -690,7 +1011,7 @@ openai_process_stream_chunk(
         data->current_text = g_string_new("");
         data->stream_started = TRUE;
 
-        g_signal_emit_by_name(data->client, "stream-start");
+        ai_delta_buffer_emit_stream_start(data->deltas);
     }
 
     /* Parse choices */
@@ -701,6 +1022,7 @@ openai_process_stream_chunk(
         if (json_array_get_length(choices) > 0)
         {
             JsonObject *choice = json_array_get_object_element(choices, 0);
+            gboolean finished = FALSE;
 
             /* Check finish_reason */
             if (json_object_has_member(choice, "finish_reason"))
@@ -711,6 +1033,7 @@ openai_process_stream_chunk(
                     const gchar *finish_reason = json_node_get_string(fr_node);
                     ai_response_set_stop_reason(data->response,
                         ai_stop_reason_from_string(finish_reason));
+                    finished = TRUE;
                 }
             }
 
@@ -728,8 +1051,7 @@ openai_process_stream_chunk(
                         const gchar *content = json_node_get_string(content_node);
                         if (content != NULL)
                         {
-                            g_string_append(data->current_text, content);
-                            g_signal_emit_by_name(data->client, "delta", content);
+                            openai_append_content(data, content);
                         }
                     }
                 }
@@ -741,34 +1063,21 @@ openai_process_stream_chunk(
                     guint len = json_array_get_length(tool_calls);
                     guint i;
 
-                    if (data->tool_calls == NULL)
-                    {
-                        data->tool_calls = g_hash_table_new_full(
-                            g_str_hash, g_str_equal,
-                            g_free, (GDestroyNotify)openai_tool_call_free);
-                    }
-
                     for (i = 0; i < len; i++)
                     {
                         JsonObject *tc = json_array_get_object_element(tool_calls, i);
-                        gint index = json_object_get_int_member_with_default(tc, "index", 0);
-                        g_autofree gchar *index_key = g_strdup_printf("%d", index);
+                        gint64 index = json_object_get_int_member_with_default(tc, "index", 0);
                         OpenAIToolCall *existing;
 
-                        existing = g_hash_table_lookup(data->tool_calls, index_key);
+                        existing = openai_get_tool_call(data, index);
                         if (existing == NULL)
                         {
-                            existing = g_slice_new0(OpenAIToolCall);
-                            existing->arguments = g_string_new("");
-
-                            /* Get id if present */
-                            if (json_object_has_member(tc, "id"))
-                            {
-                                g_free(index_key);
-                                index_key = g_strdup(json_object_get_string_member(tc, "id"));
-                            }
+                            continue;
+                        }
 
-                            g_hash_table_insert(data->tool_calls, g_strdup(index_key), existing);
+                        if (existing->id == NULL && json_object_has_member(tc, "id"))
+                        {
+                            existing->id = g_strdup(json_object_get_string_member(tc, "id"));
                         }
 
                         /* Parse function */
@@ -785,12 +1094,17 @@ openai_process_stream_chunk(
                             if (json_object_has_member(func, "arguments"))
                             {
                                 const gchar *args = json_object_get_string_member(func, "arguments");
-                                g_string_append(existing->arguments, args);
+                                openai_append_tool_input(data, existing, args);
                             }
                         }
                     }
                 }
             }
+
+            if (finished)
+            {
+                openai_complete_tool_calls(data, G_MAXUINT);
+            }
         }
     }
 
@@ -806,66 +1120,81 @@ openai_process_stream_chunk(
     }
 }
 
-static void openai_read_next_line(OpenAIStreamData *data);
+static gboolean
+on_openai_stream_event(
+    const AiStreamEvent *event,
+    gpointer             user_data
+){
+    OpenAIStreamData *data = user_data;
+
+    /* Parse SSE: data: {json} */
+    openai_process_stream_chunk(data, event->data, event->data_len);
+
+    return !ai_delta_buffer_is_full(data->deltas);
+}
+
+static void openai_read_next_block(OpenAIStreamData *data);
 
 static void
-on_openai_line_read(
+on_openai_block_read(
     GObject      *source,
     GAsyncResult *result,
     gpointer      user_data
 ){
     OpenAIStreamData *data = user_data;
     g_autoptr(GError) error = NULL;
-    g_autofree gchar *line = NULL;
-    gsize length;
 
     (void)source;
 
-    line = g_data_input_stream_read_line_finish(data->data_stream, result, &length, &error);
-
-    if (error != NULL)
+    if (ai_stream_reader_read_finish(data->reader, result, &error))
     {
-        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-        {
-            g_task_return_error(data->task, g_steal_pointer(&error));
-            openai_stream_data_free(data);
-        }
+        openai_read_next_block(data);
         return;
     }
 
-    if (line == NULL)
+    /* Text still held back belongs before the result */
+    ai_delta_buffer_flush(data->deltas);
+
+    if (error != NULL)
     {
-        /* EOF */
-        if (data->response != NULL)
-        {
-            g_task_return_pointer(data->task, g_object_ref(data->response), g_object_unref);
-        }
-        else
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
-                                    "Stream ended without valid response");
-        }
+        g_task_return_error(data->task, g_steal_pointer(&error));
         openai_stream_data_free(data);
         return;
     }
 
-    /* Parse SSE: data: {json} */
-    if (g_str_has_prefix(line, "data: "))
+    /* EOF */
+    if (data->response != NULL)
+    {
+        g_task_return_pointer(data->task, g_object_ref(data->response), g_object_unref);
+    }
+    else
     {
-        openai_process_stream_chunk(data, line + 6);
+        g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
+                                "Stream ended without valid response");
     }
+    openai_stream_data_free(data);
+}
+
+static gboolean
+on_openai_unblocked(gpointer user_data)
+{
+    openai_read_next_block(user_data);
 
-    openai_read_next_line(data);
+    return G_SOURCE_REMOVE;
 }
 
 static void
-openai_read_next_line(OpenAIStreamData *data)
+openai_read_next_block(OpenAIStreamData *data)
 {
-    g_data_input_stream_read_line_async(
-        data->data_stream,
-        G_PRIORITY_DEFAULT,
+    if (ai_delta_buffer_wait_for_space(data->deltas, on_openai_unblocked, data))
+    {
+        return;
+    }
+
+    ai_stream_reader_read_async(
+        data->reader,
         data->cancellable,
-        on_openai_line_read,
+        on_openai_block_read,
         data);
 }
 
@@ -878,10 +1207,8 @@ on_openai_stream_ready(
     OpenAIStreamData *data = user_data;
     g_autoptr(GError) error = NULL;
 
-    data->input_stream = soup_session_send_finish(
-        ai_client_get_soup_session(AI_CLIENT(data->client)),
-        result,
-        &error);
+    data->input_stream = ai_client_send_finish(
+        AI_CLIENT(data->client), result, &error);
 
     if (data->input_stream == NULL)
     {
@@ -890,195 +1217,82 @@ on_openai_stream_ready(
         return;
     }
 
-    if (!SOUP_STATUS_IS_SUCCESSFUL(soup_message_get_status(data->msg)))
-    {
-        guint status = soup_message_get_status(data->msg);
-
-        if (status == 401 || status == 403)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_API_KEY,
-                                    "Authentication failed (HTTP %u)", status);
-        }
-        else if (status == 429)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_RATE_LIMITED,
-                                    "Rate limited (HTTP %u)", status);
-        }
-        else
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_NETWORK_ERROR,
-                                    "Request failed (HTTP %u)", status);
-        }
-        openai_stream_data_free(data);
-        return;
-    }
-
-    data->data_stream = g_data_input_stream_new(data->input_stream);
-    g_data_input_stream_set_newline_type(data->data_stream, G_DATA_STREAM_NEWLINE_TYPE_ANY);
-
-    openai_read_next_line(data);
-}
-
-static JsonNode *
-ai_openai_client_build_stream_request(
-    AiClient    *client,
-    GList       *messages,
-    const gchar *system_prompt,
-    gint         max_tokens,
-    GList       *tools
-){
-    g_autoptr(JsonBuilder) builder = json_builder_new();
-    const gchar *model;
-    GList *l;
-
-    model = ai_client_get_model(client);
-    if (model == NULL)
-    {
-        model = AI_OPENAI_DEFAULT_MODEL;
-    }
-
-    json_builder_begin_object(builder);
-
-    json_builder_set_member_name(builder, "model");
-    json_builder_add_string_value(builder, model);
-
-    /* Enable streaming */
-    json_builder_set_member_name(builder, "stream");
-    json_builder_add_boolean_value(builder, TRUE);
-
-    /* Request usage in stream */
-    json_builder_set_member_name(builder, "stream_options");
-    json_builder_begin_object(builder);
-    json_builder_set_member_name(builder, "include_usage");
-    json_builder_add_boolean_value(builder, TRUE);
-    json_builder_end_object(builder);
-
-    if (max_tokens > 0)
-    {
-        json_builder_set_member_name(builder, "max_tokens");
-        json_builder_add_int_value(builder, max_tokens);
-    }
-
-    json_builder_set_member_name(builder, "messages");
-    json_builder_begin_array(builder);
-
-    if (system_prompt != NULL && system_prompt[0] != '\0')
-    {
-        json_builder_begin_object(builder);
-        json_builder_set_member_name(builder, "role");
-        json_builder_add_string_value(builder, "system");
-        json_builder_set_member_name(builder, "content");
-        json_builder_add_string_value(builder, system_prompt);
-        json_builder_end_object(builder);
-    }
+    data->timing = ai_client_get_timing(AI_CLIENT(data->client), result);
 
-    for (l = messages; l != NULL; l = l->next)
-    {
-        AiMessage *msg = l->data;
-        g_autoptr(JsonNode) msg_node = ai_message_to_json(msg);
-        json_builder_add_value(builder, g_steal_pointer(&msg_node));
-    }
+    data->reader = ai_stream_reader_new(data->input_stream, AI_STREAM_FORMAT_SSE,
+                                        on_openai_stream_event, data);
 
-    json_builder_end_array(builder);
-
-    if (tools != NULL)
-    {
-        json_builder_set_member_name(builder, "tools");
-        json_builder_begin_array(builder);
-
-        for (l = tools; l != NULL; l = l->next)
-        {
-            AiTool *tool = l->data;
-            g_autoptr(JsonNode) tool_node = ai_tool_to_json(tool, AI_PROVIDER_OPENAI);
-            json_builder_add_value(builder, g_steal_pointer(&tool_node));
-        }
-
-        json_builder_end_array(builder);
-    }
-
-    {
-        gdouble temp = ai_client_get_temperature(client);
-        if (temp != 1.0)
-        {
-            json_builder_set_member_name(builder, "temperature");
-            json_builder_add_double_value(builder, temp);
-        }
-    }
-
-    json_builder_end_object(builder);
-
-    return json_builder_get_root(builder);
+    openai_read_next_block(data);
 }
 
 static void
-ai_openai_client_chat_stream_async(
-    AiStreamable        *streamable,
-    GList               *messages,
-    const gchar         *system_prompt,
-    gint                 max_tokens,
-    GList               *tools,
-    GCancellable        *cancellable,
-    GAsyncReadyCallback  callback,
-    gpointer             user_data
+ai_openai_client_chat_stream_with_options_async(
+    AiStreamable           *streamable,
+    GList                  *messages,
+    const AiRequestOptions *options,
+    GCancellable           *cancellable,
+    GAsyncReadyCallback     callback,
+    gpointer                user_data
 ){
     AiOpenAIClient *self = AI_OPENAI_CLIENT(streamable);
-    AiClientClass *klass = AI_CLIENT_GET_CLASS(self);
-    g_autoptr(JsonNode) request_json = NULL;
     g_autoptr(SoupMessage) msg = NULL;
-    g_autofree gchar *url = NULL;
-    g_autofree gchar *request_body = NULL;
-    gsize request_len;
+    g_autoptr(GBytes) request_bytes = NULL;
+    GError *error = NULL;
     OpenAIStreamData *data;
     GTask *task;
 
     task = g_task_new(self, cancellable, callback, user_data);
 
-    request_json = ai_openai_client_build_stream_request(
-        AI_CLIENT(self), messages, system_prompt, max_tokens, tools);
-
-    if (request_json == NULL)
+    msg = ai_client_create_request(AI_CLIENT(self), messages, options, TRUE,
+                                   &request_bytes, &error);
+    if (msg == NULL)
     {
-        g_task_return_new_error(task, AI_ERROR, AI_ERROR_INVALID_REQUEST,
-                                "Failed to build request");
+        g_task_return_error(task, error);
         g_object_unref(task);
         return;
     }
 
-    {
-        g_autoptr(JsonGenerator) gen = json_generator_new();
-        json_generator_set_root(gen, request_json);
-        request_body = json_generator_to_data(gen, &request_len);
-    }
-
-    url = klass->get_endpoint_url(AI_CLIENT(self));
-
-    msg = soup_message_new("POST", url);
-    soup_message_headers_append(soup_message_get_request_headers(msg),
-                                "Content-Type", "application/json");
     soup_message_headers_append(soup_message_get_request_headers(msg),
                                 "Accept", "text/event-stream");
 
-    klass->add_auth_headers(AI_CLIENT(self), msg);
-
-    soup_message_set_request_body_from_bytes(msg, "application/json",
-        g_bytes_new_take(g_steal_pointer(&request_body), request_len));
-
     data = g_slice_new0(OpenAIStreamData);
     data->client = g_object_ref(self);
     data->task = task;
-    data->msg = g_object_ref(msg);
     data->cancellable = cancellable != NULL ? g_object_ref(cancellable) : NULL;
+    data->scratch = g_string_sized_new(256);
+    data->deltas = ai_client_create_delta_buffer(AI_CLIENT(self), options);
     data->stream_started = FALSE;
 
-    soup_session_send_async(
-        ai_client_get_soup_session(AI_CLIENT(self)),
+    ai_client_send_async(
+        AI_CLIENT(self),
         msg,
-        G_PRIORITY_DEFAULT,
+        request_bytes,
         cancellable,
         on_openai_stream_ready,
         data);
 }
 
+static void
+ai_openai_client_chat_stream_async(
+    AiStreamable        *streamable,
+    GList               *messages,
+    const gchar         *system_prompt,
+    gint                 max_tokens,
+    GList               *tools,
+    GCancellable        *cancellable,
+    GAsyncReadyCallback  callback,
+    gpointer             user_data
+){
+    g_autoptr(AiRequestOptions) options = ai_request_options_new();
+
+    ai_request_options_set_system_prompt(options, system_prompt);
+    ai_request_options_set_max_tokens(options, max_tokens);
+    ai_request_options_set_tools(options, tools);
+
+    ai_openai_client_chat_stream_with_options_async(streamable, messages, options,
+                                                    cancellable, callback, user_data);
+}
+
 static AiResponse *
 ai_openai_client_chat_stream_finish(
     AiStreamable  *streamable,
@@ -1094,6 +1308,7 @@ ai_openai_client_streamable_init(AiStreamableInterface *iface)
 {
     iface->chat_stream_async = ai_openai_client_chat_stream_async;
     iface->chat_stream_finish = ai_openai_client_chat_stream_finish;
+    iface->chat_stream_with_options_async = ai_openai_client_chat_stream_with_options_async;
 }
 
 /*
@@ -1107,14 +1322,12 @@ typedef struct
 {
     AiOpenAIClient *client;
     GTask          *task;
-    SoupMessage    *msg;
 } OpenAIImageGenData;
 
 static void
 openai_image_gen_data_free(OpenAIImageGenData *data)
 {
     g_clear_object(&data->client);
-    g_clear_object(&data->msg);
     g_slice_free(OpenAIImageGenData, data);
 }
 
@@ -1302,7 +1515,6 @@ on_openai_image_response(
     g_autoptr(GBytes) response_bytes = NULL;
     g_autoptr(GError) error = NULL;
     g_autoptr(JsonParser) parser = NULL;
-    SoupMessage *msg = data->msg;
     const gchar *response_data;
     gsize response_len;
     JsonNode *response_json;
@@ -1310,8 +1522,8 @@ on_openai_image_response(
 
     (void)source;
 
-    response_bytes = soup_session_send_and_read_finish(
-        ai_client_get_soup_session(AI_CLIENT(data->client)), result, &error);
+    response_bytes = ai_client_send_and_read_finish(
+        AI_CLIENT(data->client), result, &error);
 
     if (response_bytes == NULL)
     {
@@ -1320,33 +1532,6 @@ on_openai_image_response(
         return;
     }
 
-    if (!SOUP_STATUS_IS_SUCCESSFUL(soup_message_get_status(msg)))
-    {
-        guint status = soup_message_get_status(msg);
-
-        if (status == 401 || status == 403)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_API_KEY,
-                                    "Authentication failed (HTTP %u)", status);
-        }
-        else if (status == 429)
-        {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_RATE_LIMITED,
-                                    "Rate limited (HTTP %u)", status);
-        }
-        else
-        {
-            /* Try to parse error message from response body */
-            response_data = g_bytes_get_data(response_bytes, &response_len);
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_SERVER_ERROR,
-                                    "Request failed (HTTP %u): %.*s", status,
-                                    (int)MIN(response_len, 200), response_data);
-        }
-
-        openai_image_gen_data_free(data);
-        return;
-    }
-
     response_data = g_bytes_get_data(response_bytes, &response_len);
     parser = json_parser_new();
 
@@ -1386,6 +1571,7 @@ ai_openai_client_generate_image_async(
     g_autoptr(SoupMessage) msg = NULL;
     g_autofree gchar *url = NULL;
     g_autofree gchar *request_body = NULL;
+    g_autoptr(GBytes) request_bytes = NULL;
     gsize request_len;
     AiConfig *config;
     const gchar *base_url;
@@ -1419,18 +1605,16 @@ ai_openai_client_generate_image_async(
 
     klass->add_auth_headers(AI_CLIENT(self), msg);
 
-    soup_message_set_request_body_from_bytes(msg, "application/json",
-        g_bytes_new_take(g_steal_pointer(&request_body), request_len));
+    request_bytes = g_bytes_new_take(g_steal_pointer(&request_body), request_len);
 
     data = g_slice_new0(OpenAIImageGenData);
     data->client = g_object_ref(self);
     data->task = task;
-    data->msg = g_object_ref(msg);
 
-    soup_session_send_and_read_async(
-        ai_client_get_soup_session(AI_CLIENT(self)),
+    ai_client_send_and_read_async(
+        AI_CLIENT(self),
         msg,
-        G_PRIORITY_DEFAULT,
+        request_bytes,
         cancellable,
         on_openai_image_response,
         data);
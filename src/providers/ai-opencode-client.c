@@ -11,6 +11,7 @@
 
 #include "providers/ai-opencode-client.h"
 #include "core/ai-error.h"
+#include "core/ai-stream-reader.h"
 #include "model/ai-text-content.h"
 #include "model/ai-tool-use.h"
 
@@ -884,6 +885,12 @@ on_chat_communicate_complete(
     if (!g_subprocess_communicate_utf8_finish(G_SUBPROCESS(source), result,
                                                &stdout_data, &stderr_data, &error))
     {
+        /* Cancelled, possibly at a deadline: the CLI must not run on */
+        if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+            g_subprocess_force_exit(data->subprocess);
+        }
+
         g_task_return_error(data->task, g_steal_pointer(&error));
         chat_async_data_free(data);
         return;
@@ -1105,7 +1112,7 @@ typedef struct
     AiOpenCodeClient *client;
     GTask            *task;
     GSubprocess      *subprocess;
-    GDataInputStream *data_stream;
+    AiStreamReader   *reader;
     GCancellable     *cancellable;
     AiResponse       *response;
     GString          *accumulated_text;
@@ -1116,8 +1123,8 @@ static void
 stream_async_data_free(StreamAsyncData *data)
 {
     g_clear_object(&data->client);
+    g_clear_pointer(&data->reader, ai_stream_reader_free);
     g_clear_object(&data->subprocess);
-    g_clear_object(&data->data_stream);
     g_clear_object(&data->cancellable);
     g_clear_object(&data->response);
 
@@ -1129,95 +1136,107 @@ stream_async_data_free(StreamAsyncData *data)
     g_slice_free(StreamAsyncData, data);
 }
 
-static void read_next_stream_line(StreamAsyncData *data);
+/*
+ * The CLI writes one JSON object per line.
+ */
+static gboolean
+on_stream_event(
+    const AiStreamEvent *event,
+    gpointer             user_data
+){
+    StreamAsyncData *data = user_data;
+    g_autofree gchar *delta_text = NULL;
+    AiCliClientClass *klass;
+
+    klass = AI_CLI_CLIENT_GET_CLASS(data->client);
+    if (klass->parse_stream_line(AI_CLI_CLIENT(data->client), event->data, data->response,
+                                  &delta_text, NULL))
+    {
+        if (delta_text != NULL && delta_text[0] != '\0')
+        {
+            /* Emit stream-start on first delta */
+            if (!data->stream_started)
+            {
+                data->stream_started = TRUE;
+                g_signal_emit_by_name(data->client, "stream-start");
+            }
+
+            /* Accumulate text */
+            g_string_append(data->accumulated_text, delta_text);
+
+            /* Emit delta signal */
+            g_signal_emit_by_name(data->client, "delta", delta_text);
+        }
+    }
+
+    return TRUE;
+}
+
+static void read_next_stream_block(StreamAsyncData *data);
 
 static void
-on_stream_line_read(
+on_stream_block_read(
     GObject      *source,
     GAsyncResult *result,
     gpointer      user_data
 ){
     StreamAsyncData *data = user_data;
     g_autoptr(GError) error = NULL;
-    g_autofree gchar *line = NULL;
-    g_autofree gchar *delta_text = NULL;
-    AiCliClientClass *klass;
-    gsize length;
 
     (void)source;
 
-    line = g_data_input_stream_read_line_finish(data->data_stream, result, &length, &error);
-
-    if (error != NULL)
+    if (ai_stream_reader_read_finish(data->reader, result, &error))
     {
-        if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
-        {
-            g_task_return_error(data->task, g_steal_pointer(&error));
-            stream_async_data_free(data);
-        }
+        read_next_stream_block(data);
         return;
     }
 
-    if (line == NULL)
+    if (error != NULL)
     {
-        /* EOF - stream is complete */
-        if (data->response != NULL)
-        {
-            /* Add accumulated text as content block if not already done */
-            if (data->accumulated_text != NULL && data->accumulated_text->len > 0 &&
-                ai_response_get_content_blocks(data->response) == NULL)
-            {
-                g_autoptr(AiTextContent) content = ai_text_content_new(data->accumulated_text->str);
-                ai_response_add_content_block(data->response, (AiContentBlock *)g_steal_pointer(&content));
-            }
-
-            g_signal_emit_by_name(data->client, "stream-end", data->response);
-            g_task_return_pointer(data->task, g_object_ref(data->response), g_object_unref);
-        }
-        else
+        /*
+         * A cancelled stream, possibly at a deadline, still completes the
+         * task; the deltas emitted so far are its partial result.
+         */
+        if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
         {
-            g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
-                                    "Stream ended without a valid response");
+            g_subprocess_force_exit(data->subprocess);
         }
 
+        g_task_return_error(data->task, g_steal_pointer(&error));
         stream_async_data_free(data);
         return;
     }
 
-    /* Parse the line */
-    klass = AI_CLI_CLIENT_GET_CLASS(data->client);
-    if (klass->parse_stream_line(AI_CLI_CLIENT(data->client), line, data->response,
-                                  &delta_text, &error))
+    /* EOF - stream is complete */
+    if (data->response != NULL)
     {
-        if (delta_text != NULL && delta_text[0] != '\0')
+        /* Add accumulated text as content block if not already done */
+        if (data->accumulated_text != NULL && data->accumulated_text->len > 0 &&
+            ai_response_get_content_blocks(data->response) == NULL)
         {
-            /* Emit stream-start on first delta */
-            if (!data->stream_started)
-            {
-                data->stream_started = TRUE;
-                g_signal_emit_by_name(data->client, "stream-start");
-            }
-
-            /* Accumulate text */
-            g_string_append(data->accumulated_text, delta_text);
-
-            /* Emit delta signal */
-            g_signal_emit_by_name(data->client, "delta", delta_text);
+            g_autoptr(AiTextContent) content = ai_text_content_new(data->accumulated_text->str);
+            ai_response_add_content_block(data->response, (AiContentBlock *)g_steal_pointer(&content));
         }
+
+        g_signal_emit_by_name(data->client, "stream-end", data->response);
+        g_task_return_pointer(data->task, g_object_ref(data->response), g_object_unref);
+    }
+    else
+    {
+        g_task_return_new_error(data->task, AI_ERROR, AI_ERROR_INVALID_RESPONSE,
+                                "Stream ended without a valid response");
     }
 
-    /* Read next line */
-    read_next_stream_line(data);
+    stream_async_data_free(data);
 }
 
 static void
-read_next_stream_line(StreamAsyncData *data)
+read_next_stream_block(StreamAsyncData *data)
 {
-    g_data_input_stream_read_line_async(
-        data->data_stream,
-        G_PRIORITY_DEFAULT,
+    ai_stream_reader_read_async(
+        data->reader,
         data->cancellable,
-        on_stream_line_read,
+        on_stream_block_read,
         data);
 }
 
@@ -1243,16 +1262,15 @@ on_stream_subprocess_started(
         return;
     }
 
-    /* Wrap in data input stream for line-by-line reading */
-    data->data_stream = g_data_input_stream_new(stdout_stream);
-    g_data_input_stream_set_newline_type(data->data_stream, G_DATA_STREAM_NEWLINE_TYPE_ANY);
+    /* Frame stdout into JSON lines, a block at a time */
+    data->reader = ai_stream_reader_new(stdout_stream, AI_STREAM_FORMAT_NDJSON,
+                                        on_stream_event, data);
 
     /* Create response object */
     data->response = ai_response_new("", ai_cli_client_get_model(AI_CLI_CLIENT(data->client)));
     data->accumulated_text = g_string_new("");
 
-    /* Start reading lines */
-    read_next_stream_line(data);
+    read_next_stream_block(data);
 }
 
 static void
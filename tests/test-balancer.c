@@ -0,0 +1,404 @@
+/*
+ * test-balancer.c - Unit tests for AiBalancer and key pooling
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "core/ai-balancer.h"
+#include "core/ai-client.h"
+#include "core/ai-config.h"
+#include "core/ai-error.h"
+#include "core/ai-provider.h"
+#include "model/ai-message.h"
+#include "model/ai-response.h"
+#include "providers/ai-claude-client.h"
+
+#define N_REQUESTS 8
+
+static void
+test_balancer_endpoints(void)
+{
+	static const gchar *keys[] = { "key-a", "key-b", NULL };
+	static const gchar *urls[] = { "https://x.example", "https://y.example", NULL };
+	g_autoptr(AiBalancer) balancer = NULL;
+	g_autoptr(AiBalancer) keyless = NULL;
+
+	balancer = ai_balancer_new(keys, urls);
+	g_assert_cmpuint(ai_balancer_get_n_endpoints(balancer), ==, 4);
+	g_assert_cmpstr(ai_balancer_get_api_key(balancer, 1), ==, "key-a");
+	g_assert_cmpstr(ai_balancer_get_base_url(balancer, 1), ==, "https://y.example");
+	g_assert_cmpstr(ai_balancer_get_api_key(balancer, 2), ==, "key-b");
+	g_assert_cmpstr(ai_balancer_get_base_url(balancer, 2), ==, "https://x.example");
+
+	keyless = ai_balancer_new(NULL, urls);
+	g_assert_cmpuint(ai_balancer_get_n_endpoints(keyless), ==, 2);
+	g_assert_null(ai_balancer_get_api_key(keyless, 0));
+}
+
+static void
+test_balancer_least_outstanding(void)
+{
+	static const gchar *keys[] = { "key-a", "key-b", "key-c", NULL };
+	static const gchar *urls[] = { "https://x.example", NULL };
+	g_autoptr(AiBalancer) balancer = ai_balancer_new(keys, urls);
+	guint i;
+
+	/* Without latency samples, requests spread evenly */
+	for (i = 0; i < 6; i++)
+	{
+		ai_balancer_acquire(balancer);
+	}
+
+	for (i = 0; i < 3; i++)
+	{
+		g_assert_cmpuint(ai_balancer_get_n_in_flight(balancer, i), ==, 2);
+	}
+
+	ai_balancer_release(balancer, 1, 200, 1000);
+	ai_balancer_release(balancer, 1, 200, 1000);
+	g_assert_cmpuint(ai_balancer_get_n_in_flight(balancer, 1), ==, 0);
+	g_assert_cmpuint(ai_balancer_acquire(balancer), ==, 1);
+}
+
+static void
+test_balancer_latency(void)
+{
+	static const gchar *keys[] = { "fast", "slow", NULL };
+	static const gchar *urls[] = { "https://x.example", NULL };
+	g_autoptr(AiBalancer) balancer = ai_balancer_new(keys, urls);
+	guint fast = 0;
+	guint i;
+
+	ai_balancer_release(balancer, ai_balancer_acquire(balancer), 200, 0);
+	g_assert_cmpint(ai_balancer_get_latency(balancer, 0), ==, 0);
+
+	/* Teach the balancer that endpoint 0 is ten times faster */
+	ai_balancer_acquire(balancer);
+	ai_balancer_acquire(balancer);
+	ai_balancer_release(balancer, 0, 200, 10000);
+	ai_balancer_release(balancer, 1, 200, 100000);
+	g_assert_cmpint(ai_balancer_get_latency(balancer, 0), ==, 10000);
+	g_assert_cmpint(ai_balancer_get_latency(balancer, 1), ==, 100000);
+
+	/* The fast endpoint takes several requests before the slow one */
+	for (i = 0; i < 8; i++)
+	{
+		if (ai_balancer_acquire(balancer) == 0)
+		{
+			fast++;
+		}
+	}
+	g_assert_cmpuint(fast, >=, 6);
+
+	/* The average moves towards new samples */
+	for (i = 0; i < 8; i++)
+	{
+		ai_balancer_release(balancer, 0, 200, 20000);
+	}
+	g_assert_cmpint(ai_balancer_get_latency(balancer, 0), >, 10000);
+	g_assert_cmpint(ai_balancer_get_latency(balancer, 0), <, 20000);
+}
+
+static void
+test_balancer_throttled(void)
+{
+	static const gchar *keys[] = { "key-a", "key-b", NULL };
+	static const gchar *urls[] = { "https://x.example", NULL };
+	g_autoptr(AiBalancer) balancer = ai_balancer_new(keys, urls);
+	guint index;
+
+	/* Same latency on both, then a 429 on one of them */
+	ai_balancer_acquire(balancer);
+	ai_balancer_acquire(balancer);
+	ai_balancer_release(balancer, 0, 200, 10000);
+	ai_balancer_release(balancer, 1, 200, 10000);
+
+	index = ai_balancer_acquire(balancer);
+	ai_balancer_release(balancer, index, 429, 10000);
+
+	/* Even with requests in flight elsewhere, it is avoided for now */
+	ai_balancer_acquire(balancer);
+	ai_balancer_acquire(balancer);
+	g_assert_cmpuint(ai_balancer_get_n_in_flight(balancer, !index), ==, 2);
+	g_assert_cmpuint(ai_balancer_get_n_in_flight(balancer, index), ==, 0);
+}
+
+/*
+ * Local stand-in for the Claude messages endpoint. It counts requests
+ * per key and rejects "key-limited" with 429.
+ */
+typedef struct
+{
+	SoupServer *servers[2];
+	gchar      *base_urls[3];
+	GHashTable *per_key;        /* key -> count */
+	guint       per_server[2];
+	guint       bad_paths;
+	GMainLoop  *loop;
+	guint       pending;
+} PoolFixture;
+
+static void
+on_messages_request(
+	SoupServer        *server,
+	SoupServerMessage *msg,
+	const char        *path,
+	GHashTable        *query,
+	gpointer           user_data
+){
+	PoolFixture *fixture = user_data;
+	SoupMessageHeaders *headers = soup_server_message_get_request_headers(msg);
+	const gchar *key = soup_message_headers_get_one(headers, "x-api-key");
+	static const gchar *limited = "{\"type\":\"error\",\"error\":"
+	                              "{\"type\":\"rate_limit_error\",\"message\":\"Slow down\"}}";
+	static const gchar *ok =
+		"{\"id\":\"msg_1\",\"type\":\"message\",\"role\":\"assistant\",\"model\":\"m\","
+		"\"content\":[{\"type\":\"text\",\"text\":\"Hello\"}],\"stop_reason\":\"end_turn\","
+		"\"usage\":{\"input_tokens\":3,\"output_tokens\":1}}";
+
+	(void)query;
+
+	if (g_strcmp0(path, "/v1/messages") != 0)
+	{
+		fixture->bad_paths++;
+	}
+
+	g_hash_table_insert(fixture->per_key, g_strdup(key),
+	                    GUINT_TO_POINTER(GPOINTER_TO_UINT(g_hash_table_lookup(fixture->per_key,
+	                                                                          key)) + 1));
+	fixture->per_server[server == fixture->servers[0] ? 0 : 1]++;
+
+	if (g_strcmp0(key, "key-limited") == 0)
+	{
+		soup_message_headers_replace(soup_server_message_get_response_headers(msg),
+		                             "Retry-After", "0");
+		soup_server_message_set_status(msg, 429, NULL);
+		soup_server_message_set_response(msg, "application/json", SOUP_MEMORY_STATIC,
+		                                 limited, strlen(limited));
+		return;
+	}
+
+	soup_server_message_set_status(msg, 200, NULL);
+	soup_server_message_set_response(msg, "application/json", SOUP_MEMORY_STATIC,
+	                                 ok, strlen(ok));
+}
+
+static void
+fixture_setup(PoolFixture *fixture)
+{
+	guint i;
+
+	memset(fixture, 0, sizeof(*fixture));
+
+	for (i = 0; i < 2; i++)
+	{
+		g_autoptr(GError) error = NULL;
+		GSList *uris;
+
+		fixture->servers[i] = soup_server_new(NULL);
+		soup_server_add_handler(fixture->servers[i], NULL, on_messages_request, fixture, NULL);
+		g_assert_true(soup_server_listen_local(fixture->servers[i], 0,
+		                                       SOUP_SERVER_LISTEN_IPV4_ONLY, &error));
+		g_assert_no_error(error);
+
+		uris = soup_server_get_uris(fixture->servers[i]);
+		fixture->base_urls[i] = g_strdup_printf("http://127.0.0.1:%d",
+		                                        g_uri_get_port(uris->data));
+		g_slist_free_full(uris, (GDestroyNotify)g_uri_unref);
+	}
+
+	fixture->per_key = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+	fixture->loop = g_main_loop_new(NULL, FALSE);
+}
+
+static void
+fixture_teardown(PoolFixture *fixture)
+{
+	guint i;
+
+	for (i = 0; i < 2; i++)
+	{
+		g_clear_object(&fixture->servers[i]);
+		g_clear_pointer(&fixture->base_urls[i], g_free);
+	}
+	g_clear_pointer(&fixture->per_key, g_hash_table_unref);
+	g_clear_pointer(&fixture->loop, g_main_loop_unref);
+}
+
+static guint
+count_for_key(
+	PoolFixture *fixture,
+	const gchar *key
+){
+	return GPOINTER_TO_UINT(g_hash_table_lookup(fixture->per_key, key));
+}
+
+static void
+on_chat_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	PoolFixture *fixture = user_data;
+	g_autoptr(AiResponse) response = NULL;
+	g_autoptr(GError) error = NULL;
+
+	response = ai_provider_chat_finish(AI_PROVIDER(source), result, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(response);
+
+	if (--fixture->pending == 0)
+	{
+		g_main_loop_quit(fixture->loop);
+	}
+}
+
+static void
+run_chats(
+	PoolFixture *fixture,
+	AiProvider  *provider
+){
+	g_autoptr(AiMessage) msg = ai_message_new_user("Hello");
+	GList messages = { NULL, NULL, NULL };
+	guint i;
+
+	messages.data = msg;
+	fixture->pending = N_REQUESTS;
+
+	for (i = 0; i < N_REQUESTS; i++)
+	{
+		ai_provider_chat_async(provider, &messages, NULL, 0, NULL, NULL,
+		                       on_chat_done, fixture);
+	}
+
+	g_main_loop_run(fixture->loop);
+}
+
+static void
+test_balancer_client_spreads(void)
+{
+	PoolFixture fixture;
+	g_autoptr(AiConfig) config = ai_config_new();
+	g_autoptr(AiClaudeClient) client = NULL;
+	static const gchar *keys[] = { "key-a", "key-b", NULL };
+	AiBalancer *balancer;
+	guint i;
+
+	fixture_setup(&fixture);
+
+	ai_config_set_api_keys(config, AI_PROVIDER_CLAUDE, keys);
+	ai_config_set_base_urls(config, AI_PROVIDER_CLAUDE,
+	                        (const gchar *const *)fixture.base_urls);
+	client = ai_claude_client_new_with_config(config);
+
+	balancer = ai_client_get_balancer(AI_CLIENT(client));
+	g_assert_nonnull(balancer);
+	g_assert_cmpuint(ai_balancer_get_n_endpoints(balancer), ==, 4);
+
+	run_chats(&fixture, AI_PROVIDER(client));
+
+	/* Concurrent requests went to every key and every URL */
+	g_assert_cmpuint(count_for_key(&fixture, "key-a"), >, 0);
+	g_assert_cmpuint(count_for_key(&fixture, "key-b"), >, 0);
+	g_assert_cmpuint(count_for_key(&fixture, "key-a") + count_for_key(&fixture, "key-b"),
+	                 ==, N_REQUESTS);
+	g_assert_cmpuint(fixture.per_server[0], >, 0);
+	g_assert_cmpuint(fixture.per_server[1], >, 0);
+
+	for (i = 0; i < ai_balancer_get_n_endpoints(balancer); i++)
+	{
+		g_assert_cmpuint(ai_balancer_get_n_in_flight(balancer, i), ==, 0);
+	}
+
+	fixture_teardown(&fixture);
+}
+
+static void
+test_balancer_client_avoids_429(void)
+{
+	PoolFixture fixture;
+	g_autoptr(AiConfig) config = ai_config_new();
+	g_autoptr(AiClaudeClient) client = NULL;
+	static const gchar *keys[] = { "key-limited", "key-b", NULL };
+
+	fixture_setup(&fixture);
+
+	ai_config_set_api_keys(config, AI_PROVIDER_CLAUDE, keys);
+	ai_config_set_base_url(config, AI_PROVIDER_CLAUDE, fixture.base_urls[0]);
+	ai_config_set_max_retries(config, 3);
+	client = ai_claude_client_new_with_config(config);
+
+	/* Every request succeeds: a 429 is retried on the other key */
+	run_chats(&fixture, AI_PROVIDER(client));
+
+	g_assert_cmpuint(count_for_key(&fixture, "key-b"), ==, N_REQUESTS);
+	g_assert_cmpuint(count_for_key(&fixture, "key-limited"), <, N_REQUESTS);
+
+	fixture_teardown(&fixture);
+}
+
+static void
+test_balancer_client_key_in_url(void)
+{
+	PoolFixture fixture;
+	g_autoptr(AiConfig) config = ai_config_new();
+	g_autoptr(AiClaudeClient) client = NULL;
+	static const gchar *keys[] = { "1", "key-b", NULL };
+
+	fixture_setup(&fixture);
+
+	/* "1" is in the host, the port and the path of the request URL */
+	ai_config_set_api_keys(config, AI_PROVIDER_CLAUDE, keys);
+	ai_config_set_base_url(config, AI_PROVIDER_CLAUDE, fixture.base_urls[0]);
+	client = ai_claude_client_new_with_config(config);
+
+	run_chats(&fixture, AI_PROVIDER(client));
+
+	/* Switching keys leaves the URL alone */
+	g_assert_cmpuint(fixture.bad_paths, ==, 0);
+	g_assert_cmpuint(fixture.per_server[0], ==, N_REQUESTS);
+	g_assert_cmpuint(count_for_key(&fixture, "1"), >, 0);
+	g_assert_cmpuint(count_for_key(&fixture, "key-b"), >, 0);
+	g_assert_cmpuint(count_for_key(&fixture, "1") + count_for_key(&fixture, "key-b"),
+	                 ==, N_REQUESTS);
+
+	fixture_teardown(&fixture);
+}
+
+static void
+test_balancer_client_single_endpoint(void)
+{
+	g_autoptr(AiConfig) config = ai_config_new();
+	g_autoptr(AiClaudeClient) client = NULL;
+
+	/* A pool of one is no pool */
+	ai_config_set_api_key(config, AI_PROVIDER_CLAUDE, "key-a");
+	client = ai_claude_client_new_with_config(config);
+	g_assert_null(ai_client_get_balancer(AI_CLIENT(client)));
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/balancer/endpoints", test_balancer_endpoints);
+	g_test_add_func("/ai-glib/balancer/least-outstanding", test_balancer_least_outstanding);
+	g_test_add_func("/ai-glib/balancer/latency", test_balancer_latency);
+	g_test_add_func("/ai-glib/balancer/throttled", test_balancer_throttled);
+	g_test_add_func("/ai-glib/balancer/client-spreads", test_balancer_client_spreads);
+	g_test_add_func("/ai-glib/balancer/client-avoids-429", test_balancer_client_avoids_429);
+	g_test_add_func("/ai-glib/balancer/client-key-in-url", test_balancer_client_key_in_url);
+	g_test_add_func("/ai-glib/balancer/client-single-endpoint",
+	                test_balancer_client_single_endpoint);
+
+	return g_test_run();
+}
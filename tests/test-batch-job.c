@@ -0,0 +1,453 @@
+/*
+ * test-batch-job.c - Unit tests for AiBatchJob
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "core/ai-batch-job.h"
+#include "core/ai-error.h"
+#include "model/ai-message.h"
+#include "model/ai-response.h"
+#include "providers/ai-claude-client.h"
+#include "providers/ai-openai-client.h"
+
+/*
+ * Local stand-in for the Claude and OpenAI batch endpoints. A batch
+ * stays in progress for a couple of polls, then ends.
+ */
+typedef struct
+{
+	SoupServer *server;
+	gchar      *base_url;
+	GMainLoop  *loop;
+	gboolean    ok;
+	GError     *error;
+
+	guint       polls;
+	guint       n_finished;
+	gchar      *submitted;      /* body of the batch creation request */
+	gchar      *uploaded;       /* body of the file upload */
+	gboolean    cancelled;
+} BatchFixture;
+
+static const gchar *claude_results =
+	"{\"custom_id\":\"first\",\"result\":{\"type\":\"succeeded\",\"message\":"
+	"{\"id\":\"msg_1\",\"type\":\"message\",\"role\":\"assistant\",\"model\":\"claude-test\","
+	"\"content\":[{\"type\":\"text\",\"text\":\"Hello\"}],\"stop_reason\":\"end_turn\","
+	"\"usage\":{\"input_tokens\":3,\"output_tokens\":1}}}}\n"
+	"{\"custom_id\":\"second\",\"result\":{\"type\":\"errored\",\"error\":"
+	"{\"type\":\"error\",\"error\":{\"type\":\"invalid_request_error\",\"message\":\"Bad\"}}}}\n"
+	"{\"custom_id\":\"unknown\",\"result\":{\"type\":\"expired\"}}\n"
+	"\n";
+
+static const gchar *openai_output =
+	"{\"id\":\"batch_req_1\",\"custom_id\":\"request-0\",\"response\":{\"status_code\":200,"
+	"\"body\":{\"id\":\"chatcmpl-1\",\"object\":\"chat.completion\",\"model\":\"gpt-test\","
+	"\"choices\":[{\"index\":0,\"message\":{\"role\":\"assistant\",\"content\":\"Hi\"},"
+	"\"finish_reason\":\"stop\"}],\"usage\":{\"prompt_tokens\":3,\"completion_tokens\":1,"
+	"\"total_tokens\":4}}},\"error\":null}\n";
+
+static const gchar *openai_errors =
+	"{\"id\":\"batch_req_2\",\"custom_id\":\"request-1\",\"response\":{\"status_code\":429,"
+	"\"body\":{\"error\":{\"message\":\"Slow down\",\"type\":\"rate_limit_error\"}}},"
+	"\"error\":null}\n";
+
+static void
+reply_json(
+	SoupServerMessage *msg,
+	const gchar       *json
+){
+	soup_server_message_set_status(msg, 200, NULL);
+	soup_server_message_set_response(msg, "application/json", SOUP_MEMORY_COPY,
+	                                 json, strlen(json));
+}
+
+static gchar *
+get_request_body(SoupServerMessage *msg)
+{
+	SoupMessageBody *body = soup_server_message_get_request_body(msg);
+
+	return g_strndup(body->data, body->length);
+}
+
+static void
+on_claude_request(
+	SoupServer        *server,
+	SoupServerMessage *msg,
+	const char        *path,
+	GHashTable        *query,
+	gpointer           user_data
+){
+	BatchFixture *fixture = user_data;
+	SoupMessageHeaders *headers = soup_server_message_get_request_headers(msg);
+	const gchar *method = soup_server_message_get_method(msg);
+	g_autofree gchar *results = NULL;
+
+	(void)server;
+	(void)query;
+
+	if (g_str_equal(path, "/results"))
+	{
+		soup_server_message_set_status(msg, 200, NULL);
+		soup_server_message_set_response(msg, "application/binary", SOUP_MEMORY_STATIC,
+		                                 claude_results, strlen(claude_results));
+		return;
+	}
+
+	g_assert_cmpstr(soup_message_headers_get_one(headers, "x-api-key"), ==, "test-key");
+	g_assert_nonnull(soup_message_headers_get_one(headers, "anthropic-version"));
+
+	if (g_str_equal(method, "POST") && g_str_equal(path, "/v1/messages/batches"))
+	{
+		fixture->submitted = get_request_body(msg);
+		reply_json(msg, "{\"id\":\"msgbatch_1\",\"processing_status\":\"in_progress\"}");
+	}
+	else if (g_str_equal(method, "POST") && g_str_equal(path, "/v1/messages/batches/msgbatch_1/cancel"))
+	{
+		fixture->cancelled = TRUE;
+		reply_json(msg, "{\"id\":\"msgbatch_1\",\"processing_status\":\"canceling\"}");
+	}
+	else if (g_str_equal(method, "GET") && g_str_equal(path, "/v1/messages/batches/msgbatch_1"))
+	{
+		if (++fixture->polls < 3)
+		{
+			reply_json(msg, "{\"id\":\"msgbatch_1\",\"processing_status\":\"in_progress\"}");
+			return;
+		}
+
+		results = g_strdup_printf("{\"id\":\"msgbatch_1\",\"processing_status\":\"ended\","
+		                          "\"results_url\":\"%s/results\"}", fixture->base_url);
+		reply_json(msg, results);
+	}
+	else
+	{
+		soup_server_message_set_status(msg, 404, NULL);
+	}
+}
+
+static void
+on_openai_request(
+	SoupServer        *server,
+	SoupServerMessage *msg,
+	const char        *path,
+	GHashTable        *query,
+	gpointer           user_data
+){
+	BatchFixture *fixture = user_data;
+	SoupMessageHeaders *headers = soup_server_message_get_request_headers(msg);
+	const gchar *method = soup_server_message_get_method(msg);
+
+	(void)server;
+	(void)query;
+
+	g_assert_cmpstr(soup_message_headers_get_one(headers, "Authorization"), ==, "Bearer test-key");
+
+	if (g_str_equal(method, "POST") && g_str_equal(path, "/v1/files"))
+	{
+		g_assert_true(g_str_has_prefix(soup_message_headers_get_content_type(headers, NULL),
+		                               "multipart/form-data"));
+		fixture->uploaded = get_request_body(msg);
+		reply_json(msg, "{\"id\":\"file-in\",\"object\":\"file\",\"purpose\":\"batch\"}");
+	}
+	else if (g_str_equal(method, "POST") && g_str_equal(path, "/v1/batches"))
+	{
+		fixture->submitted = get_request_body(msg);
+		reply_json(msg, "{\"id\":\"batch_1\",\"status\":\"validating\"}");
+	}
+	else if (g_str_equal(method, "GET") && g_str_equal(path, "/v1/batches/batch_1"))
+	{
+		if (++fixture->polls < 3)
+		{
+			reply_json(msg, "{\"id\":\"batch_1\",\"status\":\"in_progress\"}");
+			return;
+		}
+
+		reply_json(msg, "{\"id\":\"batch_1\",\"status\":\"completed\","
+		                "\"output_file_id\":\"file-out\",\"error_file_id\":\"file-err\"}");
+	}
+	else if (g_str_equal(method, "GET") && g_str_equal(path, "/v1/files/file-out/content"))
+	{
+		soup_server_message_set_status(msg, 200, NULL);
+		soup_server_message_set_response(msg, "application/jsonl", SOUP_MEMORY_STATIC,
+		                                 openai_output, strlen(openai_output));
+	}
+	else if (g_str_equal(method, "GET") && g_str_equal(path, "/v1/files/file-err/content"))
+	{
+		soup_server_message_set_status(msg, 200, NULL);
+		soup_server_message_set_response(msg, "application/jsonl", SOUP_MEMORY_STATIC,
+		                                 openai_errors, strlen(openai_errors));
+	}
+	else
+	{
+		soup_server_message_set_status(msg, 404, NULL);
+	}
+}
+
+static void
+fixture_setup(
+	BatchFixture       *fixture,
+	SoupServerCallback  handler
+){
+	g_autoptr(GError) error = NULL;
+	GSList *uris;
+
+	memset(fixture, 0, sizeof(*fixture));
+
+	fixture->server = soup_server_new(NULL);
+	soup_server_add_handler(fixture->server, NULL, handler, fixture, NULL);
+	g_assert_true(soup_server_listen_local(fixture->server, 0,
+	                                       SOUP_SERVER_LISTEN_IPV4_ONLY, &error));
+	g_assert_no_error(error);
+
+	uris = soup_server_get_uris(fixture->server);
+	fixture->base_url = g_strdup_printf("http://127.0.0.1:%d",
+	                                    g_uri_get_port(uris->data));
+	g_slist_free_full(uris, (GDestroyNotify)g_uri_unref);
+
+	fixture->loop = g_main_loop_new(NULL, FALSE);
+}
+
+static void
+fixture_teardown(BatchFixture *fixture)
+{
+	g_clear_error(&fixture->error);
+	g_clear_pointer(&fixture->submitted, g_free);
+	g_clear_pointer(&fixture->uploaded, g_free);
+	g_clear_pointer(&fixture->loop, g_main_loop_unref);
+	g_clear_pointer(&fixture->base_url, g_free);
+	g_clear_object(&fixture->server);
+}
+
+static void
+on_submit_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	BatchFixture *fixture = user_data;
+
+	fixture->ok = ai_batch_job_submit_finish(AI_BATCH_JOB(source), result, &fixture->error);
+	g_main_loop_quit(fixture->loop);
+}
+
+static void
+on_wait_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	BatchFixture *fixture = user_data;
+
+	fixture->ok = ai_batch_job_wait_finish(AI_BATCH_JOB(source), result, &fixture->error);
+	g_main_loop_quit(fixture->loop);
+}
+
+static void
+on_cancel_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	BatchFixture *fixture = user_data;
+
+	fixture->ok = ai_batch_job_cancel_finish(AI_BATCH_JOB(source), result, &fixture->error);
+	g_main_loop_quit(fixture->loop);
+}
+
+static void
+on_request_finished(
+	AiBatchJob *job,
+	guint       index,
+	gpointer    user_data
+){
+	BatchFixture *fixture = user_data;
+
+	fixture->n_finished++;
+}
+
+static void
+add_prompt(
+	AiBatchJob  *job,
+	const gchar *custom_id,
+	const gchar *prompt
+){
+	g_autoptr(AiMessage) msg = ai_message_new_user(prompt);
+	GList messages = { NULL, NULL, NULL };
+
+	messages.data = msg;
+	ai_batch_job_add_request(job, custom_id, &messages, NULL, 64, NULL);
+}
+
+static void
+run_submit_and_wait(
+	BatchFixture *fixture,
+	AiBatchJob   *job
+){
+	ai_batch_job_set_base_url(job, fixture->base_url);
+	ai_batch_job_set_poll_interval(job, 1, 5);
+	g_signal_connect(job, "request-finished", G_CALLBACK(on_request_finished), fixture);
+
+	ai_batch_job_submit_async(job, NULL, on_submit_done, fixture);
+	g_main_loop_run(fixture->loop);
+	g_assert_no_error(fixture->error);
+	g_assert_true(fixture->ok);
+	g_assert_cmpint(ai_batch_job_get_status(job), ==, AI_BATCH_STATUS_IN_PROGRESS);
+
+	ai_batch_job_wait_async(job, NULL, on_wait_done, fixture);
+	g_main_loop_run(fixture->loop);
+	g_assert_no_error(fixture->error);
+	g_assert_true(fixture->ok);
+	g_assert_cmpint(ai_batch_job_get_status(job), ==, AI_BATCH_STATUS_ENDED);
+	g_assert_cmpuint(fixture->polls, ==, 3);
+}
+
+static void
+test_batch_job_claude(void)
+{
+	BatchFixture fixture;
+	g_autoptr(AiClaudeClient) client = NULL;
+	g_autoptr(AiBatchJob) job = NULL;
+	g_autofree gchar *text = NULL;
+
+	fixture_setup(&fixture, on_claude_request);
+
+	client = ai_claude_client_new_with_key("test-key");
+	job = ai_batch_job_new(AI_CLIENT(client));
+
+	add_prompt(job, "first", "Say hello");
+	add_prompt(job, "second", "Say nothing");
+	add_prompt(job, "third", "Never answered");
+	g_assert_cmpuint(ai_batch_job_get_n_requests(job), ==, 3);
+
+	run_submit_and_wait(&fixture, job);
+
+	g_assert_cmpstr(ai_batch_job_get_id(job), ==, "msgbatch_1");
+	g_assert_nonnull(strstr(fixture.submitted, "\"requests\":[{\"custom_id\":\"first\",\"params\":{"));
+	g_assert_nonnull(strstr(fixture.submitted, "Say hello"));
+	g_assert_null(strstr(fixture.submitted, "\"stream\""));
+
+	/* Every request finishes once, including the one with no result */
+	g_assert_cmpuint(fixture.n_finished, ==, 3);
+
+	g_assert_no_error((GError *)ai_batch_job_get_error(job, 0));
+	g_assert_cmpstr(ai_response_get_id(ai_batch_job_get_response(job, 0)), ==, "msg_1");
+	text = ai_response_get_text(ai_batch_job_get_response(job, 0));
+	g_assert_cmpstr(text, ==, "Hello");
+
+	g_assert_null(ai_batch_job_get_response(job, 1));
+	g_assert_error((GError *)ai_batch_job_get_error(job, 1), AI_ERROR, AI_ERROR_INVALID_REQUEST);
+	g_assert_cmpstr(ai_batch_job_get_error(job, 1)->message, ==, "Bad");
+
+	g_assert_null(ai_batch_job_get_response(job, 2));
+	g_assert_error((GError *)ai_batch_job_get_error(job, 2), AI_ERROR, AI_ERROR_INVALID_RESPONSE);
+
+	fixture_teardown(&fixture);
+}
+
+static void
+test_batch_job_openai(void)
+{
+	BatchFixture fixture;
+	g_autoptr(AiOpenAIClient) client = NULL;
+	g_autoptr(AiBatchJob) job = NULL;
+	g_autofree gchar *text = NULL;
+
+	fixture_setup(&fixture, on_openai_request);
+
+	client = ai_openai_client_new_with_key("test-key");
+	job = ai_batch_job_new(AI_CLIENT(client));
+
+	add_prompt(job, NULL, "Say hi");
+	add_prompt(job, NULL, "Say more");
+
+	run_submit_and_wait(&fixture, job);
+
+	g_assert_cmpstr(ai_batch_job_get_id(job), ==, "batch_1");
+	g_assert_nonnull(strstr(fixture.uploaded, "name=\"purpose\""));
+	g_assert_nonnull(strstr(fixture.uploaded,
+		"{\"custom_id\":\"request-0\",\"method\":\"POST\",\"url\":\"/v1/chat/completions\",\"body\":{"));
+	g_assert_nonnull(strstr(fixture.uploaded, "{\"custom_id\":\"request-1\""));
+	g_assert_nonnull(strstr(fixture.submitted, "\"input_file_id\":\"file-in\""));
+	g_assert_nonnull(strstr(fixture.submitted, "\"completion_window\":\"24h\""));
+
+	g_assert_cmpuint(fixture.n_finished, ==, 2);
+
+	text = ai_response_get_text(ai_batch_job_get_response(job, 0));
+	g_assert_cmpstr(text, ==, "Hi");
+
+	g_assert_null(ai_batch_job_get_response(job, 1));
+	g_assert_error((GError *)ai_batch_job_get_error(job, 1), AI_ERROR, AI_ERROR_RATE_LIMITED);
+
+	fixture_teardown(&fixture);
+}
+
+static void
+test_batch_job_cancel(void)
+{
+	BatchFixture fixture;
+	g_autoptr(AiClaudeClient) client = NULL;
+	g_autoptr(AiBatchJob) job = NULL;
+
+	fixture_setup(&fixture, on_claude_request);
+
+	client = ai_claude_client_new_with_key("test-key");
+	job = ai_batch_job_new(AI_CLIENT(client));
+	ai_batch_job_set_base_url(job, fixture.base_url);
+	add_prompt(job, "first", "Say hello");
+
+	ai_batch_job_submit_async(job, NULL, on_submit_done, &fixture);
+	g_main_loop_run(fixture.loop);
+	g_assert_no_error(fixture.error);
+
+	ai_batch_job_cancel_async(job, NULL, on_cancel_done, &fixture);
+	g_main_loop_run(fixture.loop);
+	g_assert_no_error(fixture.error);
+	g_assert_true(fixture.ok);
+	g_assert_true(fixture.cancelled);
+	g_assert_cmpint(ai_batch_job_get_status(job), ==, AI_BATCH_STATUS_CANCELING);
+
+	fixture_teardown(&fixture);
+}
+
+static void
+test_batch_job_not_supported(void)
+{
+	BatchFixture fixture;
+	g_autoptr(AiClient) client = NULL;
+	g_autoptr(AiBatchJob) job = NULL;
+
+	fixture_setup(&fixture, on_claude_request);
+
+	client = g_object_new(AI_TYPE_CLIENT, NULL);
+	job = ai_batch_job_new(client);
+
+	ai_batch_job_submit_async(job, NULL, on_submit_done, &fixture);
+	g_main_loop_run(fixture.loop);
+
+	g_assert_false(fixture.ok);
+	g_assert_error(fixture.error, AI_ERROR, AI_ERROR_NOT_SUPPORTED);
+	g_assert_null(ai_batch_job_get_id(job));
+
+	fixture_teardown(&fixture);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/batch-job/claude", test_batch_job_claude);
+	g_test_add_func("/ai-glib/batch-job/openai", test_batch_job_openai);
+	g_test_add_func("/ai-glib/batch-job/cancel", test_batch_job_cancel);
+	g_test_add_func("/ai-glib/batch-job/not-supported", test_batch_job_not_supported);
+
+	return g_test_run();
+}
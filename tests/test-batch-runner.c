@@ -0,0 +1,267 @@
+/*
+ * test-batch-runner.c - Unit tests for AiBatchRunner
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "core/ai-batch-runner.h"
+#include "core/ai-error.h"
+#include "core/ai-provider.h"
+#include "model/ai-message.h"
+#include "model/ai-response.h"
+
+/*
+ * A provider that answers each request after a short delay, echoing the
+ * prompt as the response ID, and fails prompts starting with "fail".
+ */
+#define TEST_TYPE_PROVIDER (test_provider_get_type())
+G_DECLARE_FINAL_TYPE(TestProvider, test_provider, TEST, PROVIDER, GObject)
+
+struct _TestProvider
+{
+	GObject parent_instance;
+
+	guint in_flight;
+	guint max_seen;
+	guint n_calls;
+};
+
+static void test_provider_iface_init(AiProviderInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(TestProvider, test_provider, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(AI_TYPE_PROVIDER, test_provider_iface_init))
+
+static gboolean
+on_reply_timeout(gpointer user_data)
+{
+	GTask *task = user_data;
+	TestProvider *self = g_task_get_source_object(task);
+	const gchar *prompt = g_task_get_task_data(task);
+
+	self->in_flight--;
+
+	if (g_task_return_error_if_cancelled(task))
+	{
+		/* nothing else to do */
+	}
+	else if (g_str_has_prefix(prompt, "fail"))
+	{
+		g_task_return_new_error(task, AI_ERROR, AI_ERROR_SERVER_ERROR, "failed: %s", prompt);
+	}
+	else
+	{
+		g_task_return_pointer(task, ai_response_new(prompt, "test"), g_object_unref);
+	}
+
+	g_object_unref(task);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+test_provider_chat_async(
+	AiProvider          *provider,
+	GList               *messages,
+	const gchar         *system_prompt,
+	gint                 max_tokens,
+	GList               *tools,
+	GCancellable        *cancellable,
+	GAsyncReadyCallback  callback,
+	gpointer             user_data
+){
+	TestProvider *self = TEST_PROVIDER(provider);
+	GTask *task;
+
+	task = g_task_new(self, cancellable, callback, user_data);
+	g_task_set_task_data(task, ai_message_get_text(messages->data), g_free);
+
+	self->n_calls++;
+	self->in_flight++;
+	self->max_seen = MAX(self->max_seen, self->in_flight);
+
+	/* Later requests finish first, to exercise result ordering */
+	g_timeout_add(20 - MIN(self->n_calls, 10u), on_reply_timeout, task);
+}
+
+static AiResponse *
+test_provider_chat_finish(
+	AiProvider    *provider,
+	GAsyncResult  *result,
+	GError       **error
+){
+	return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+test_provider_iface_init(AiProviderInterface *iface)
+{
+	iface->chat_async = test_provider_chat_async;
+	iface->chat_finish = test_provider_chat_finish;
+}
+
+static void
+test_provider_class_init(TestProviderClass *klass)
+{
+}
+
+static void
+test_provider_init(TestProvider *self)
+{
+}
+
+typedef struct
+{
+	GMainLoop *loop;
+	gboolean   ok;
+	GError    *error;
+	guint      n_finished;
+} RunData;
+
+static void
+on_run_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	RunData *data = user_data;
+
+	data->ok = ai_batch_runner_run_finish(AI_BATCH_RUNNER(source), result, &data->error);
+	g_main_loop_quit(data->loop);
+}
+
+static void
+on_request_finished(
+	AiBatchRunner *batch,
+	guint          index,
+	gpointer       user_data
+){
+	RunData *data = user_data;
+
+	data->n_finished++;
+}
+
+static void
+test_batch_runner_order_and_limit(void)
+{
+	g_autoptr(TestProvider) provider = g_object_new(TEST_TYPE_PROVIDER, NULL);
+	g_autoptr(AiBatchRunner) batch = NULL;
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+	RunData data = { loop, FALSE, NULL, 0 };
+	guint i;
+
+	batch = ai_batch_runner_new(AI_PROVIDER(provider));
+	ai_batch_runner_set_max_in_flight(batch, 3);
+	g_signal_connect(batch, "request-finished", G_CALLBACK(on_request_finished), &data);
+
+	for (i = 0; i < 10; i++)
+	{
+		g_autofree gchar *prompt = NULL;
+
+		prompt = g_strdup_printf("%s%u", i == 4 ? "fail" : "item", i);
+		g_assert_cmpuint(ai_batch_runner_add_prompt(batch, prompt, NULL, 16), ==, i);
+	}
+
+	ai_batch_runner_run_async(batch, NULL, on_run_done, &data);
+	g_main_loop_run(loop);
+
+	g_assert_no_error(data.error);
+	g_assert_true(data.ok);
+	g_assert_cmpuint(data.n_finished, ==, 10);
+	g_assert_cmpuint(provider->n_calls, ==, 10);
+	g_assert_cmpuint(provider->max_seen, ==, 3);
+	g_assert_cmpuint(ai_batch_runner_get_n_failed(batch), ==, 1);
+
+	for (i = 0; i < 10; i++)
+	{
+		g_autofree gchar *expected = g_strdup_printf("item%u", i);
+		AiResponse *response = ai_batch_runner_get_response(batch, i);
+
+		if (i == 4)
+		{
+			g_assert_null(response);
+			g_assert_error(ai_batch_runner_get_error(batch, i),
+			               AI_ERROR, AI_ERROR_SERVER_ERROR);
+			continue;
+		}
+
+		g_assert_nonnull(response);
+		g_assert_null(ai_batch_runner_get_error(batch, i));
+		g_assert_cmpstr(ai_response_get_id(response), ==, expected);
+	}
+}
+
+static gboolean
+cancel_soon(gpointer user_data)
+{
+	g_cancellable_cancel(G_CANCELLABLE(user_data));
+	return G_SOURCE_REMOVE;
+}
+
+static void
+test_batch_runner_cancel(void)
+{
+	g_autoptr(TestProvider) provider = g_object_new(TEST_TYPE_PROVIDER, NULL);
+	g_autoptr(AiBatchRunner) batch = NULL;
+	g_autoptr(GCancellable) cancellable = g_cancellable_new();
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+	RunData data = { loop, FALSE, NULL, 0 };
+	guint i;
+
+	batch = ai_batch_runner_new(AI_PROVIDER(provider));
+	ai_batch_runner_set_max_in_flight(batch, 2);
+
+	for (i = 0; i < 20; i++)
+	{
+		ai_batch_runner_add_prompt(batch, "item", NULL, 16);
+	}
+
+	ai_batch_runner_run_async(batch, cancellable, on_run_done, &data);
+	g_timeout_add(1, cancel_soon, cancellable);
+	g_main_loop_run(loop);
+
+	g_assert_false(data.ok);
+	g_assert_error(data.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_clear_error(&data.error);
+
+	/* Only the first slots were ever sent; the rest failed unsent */
+	g_assert_cmpuint(provider->n_calls, ==, 2);
+	g_assert_cmpuint(ai_batch_runner_get_n_failed(batch), ==, 20);
+	g_assert_error(ai_batch_runner_get_error(batch, 19), G_IO_ERROR, G_IO_ERROR_CANCELLED);
+}
+
+static void
+test_batch_runner_empty(void)
+{
+	g_autoptr(TestProvider) provider = g_object_new(TEST_TYPE_PROVIDER, NULL);
+	g_autoptr(AiBatchRunner) batch = NULL;
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+	RunData data = { loop, FALSE, NULL, 0 };
+
+	batch = ai_batch_runner_new(AI_PROVIDER(provider));
+	g_assert_cmpuint(ai_batch_runner_get_max_in_flight(batch), ==,
+	                 AI_BATCH_RUNNER_DEFAULT_MAX_IN_FLIGHT);
+
+	ai_batch_runner_run_async(batch, NULL, on_run_done, &data);
+	g_main_loop_run(loop);
+
+	g_assert_no_error(data.error);
+	g_assert_true(data.ok);
+	g_assert_cmpuint(provider->n_calls, ==, 0);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/batch-runner/order-and-limit", test_batch_runner_order_and_limit);
+	g_test_add_func("/ai-glib/batch-runner/cancel", test_batch_runner_cancel);
+	g_test_add_func("/ai-glib/batch-runner/empty", test_batch_runner_empty);
+
+	return g_test_run();
+}
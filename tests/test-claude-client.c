@@ -6,10 +6,83 @@
  */
 
 #include <glib.h>
+#include <json-glib/json-glib.h>
 
 #include "providers/ai-claude-client.h"
 #include "core/ai-provider.h"
 #include "core/ai-config.h"
+#include "model/ai-message.h"
+#include "model/ai-tool.h"
+
+/*
+ * Build a request body and check that the JsonBuilder path produces
+ * the same document.
+ */
+static JsonNode *
+build_body(
+	AiClaudeClient *client,
+	GList          *messages,
+	const gchar    *system_prompt,
+	GList          *tools
+){
+	g_autoptr(GBytes) body = NULL;
+	g_autoptr(JsonParser) parser = json_parser_new();
+	g_autoptr(JsonNode) tree = NULL;
+	g_autoptr(GError) error = NULL;
+	gsize len;
+	const gchar *data;
+
+	body = ai_client_build_request_body(AI_CLIENT(client), messages, system_prompt,
+	                                    1024, tools, FALSE);
+	g_assert_nonnull(body);
+
+	data = g_bytes_get_data(body, &len);
+	json_parser_load_from_data(parser, data, (gssize)len, &error);
+	g_assert_no_error(error);
+
+	tree = AI_CLIENT_GET_CLASS(client)->build_request(AI_CLIENT(client), messages,
+	                                                  system_prompt, 1024, tools);
+	g_assert_true(json_node_equal(tree, json_parser_get_root(parser)));
+
+	return json_node_copy(json_parser_get_root(parser));
+}
+
+static gboolean
+has_cache_control(JsonObject *obj)
+{
+	JsonObject *cache_control;
+
+	if (!json_object_has_member(obj, "cache_control"))
+	{
+		return FALSE;
+	}
+
+	cache_control = json_object_get_object_member(obj, "cache_control");
+	return g_strcmp0(json_object_get_string_member(cache_control, "type"), "ephemeral") == 0;
+}
+
+/*
+ * Whether the last content block of message @index is a breakpoint.
+ */
+static gboolean
+message_cached(
+	JsonObject *root,
+	guint       index
+){
+	JsonArray *messages = json_object_get_array_member(root, "messages");
+	JsonObject *msg = json_array_get_object_element(messages, index);
+	JsonNode *content = json_object_get_member(msg, "content");
+	JsonArray *blocks;
+
+	if (!JSON_NODE_HOLDS_ARRAY(content))
+	{
+		return FALSE;
+	}
+
+	blocks = json_node_get_array(content);
+	return has_cache_control(json_array_get_object_element(blocks,
+	                         json_array_get_length(blocks) - 1));
+}
 
 static void
 test_claude_client_new(void)
@@ -105,6 +178,208 @@ test_claude_client_gtype(void)
 	g_assert_cmpstr(g_type_name(type), ==, "AiClaudeClient");
 }
 
+static void
+test_claude_client_cache_breakpoints(void)
+{
+	g_autoptr(AiClaudeClient) client = NULL;
+	AiClaudeCacheFlags flags;
+
+	client = ai_claude_client_new_with_key("test-key");
+	g_assert_cmpint(ai_claude_client_get_cache_breakpoints(client), ==, AI_CLAUDE_CACHE_NONE);
+
+	ai_claude_client_set_cache_breakpoints(client, AI_CLAUDE_CACHE_SYSTEM | AI_CLAUDE_CACHE_TOOLS);
+	g_object_get(client, "cache-breakpoints", &flags, NULL);
+	g_assert_cmpint(flags, ==, AI_CLAUDE_CACHE_SYSTEM | AI_CLAUDE_CACHE_TOOLS);
+	g_assert_true(G_TYPE_IS_FLAGS(AI_TYPE_CLAUDE_CACHE_FLAGS));
+}
+
+static void
+test_claude_client_cache_system_tools(void)
+{
+	g_autoptr(AiClaudeClient) client = NULL;
+	g_autoptr(AiMessage) msg = NULL;
+	g_autoptr(AiTool) first = NULL;
+	g_autoptr(AiTool) second = NULL;
+	g_autoptr(JsonNode) body = NULL;
+	GList *messages = NULL;
+	GList *tools = NULL;
+	JsonObject *root;
+	JsonArray *system;
+	JsonArray *tool_arr;
+
+	client = ai_claude_client_new_with_key("test-key");
+	msg = ai_message_new_user("Hello");
+	first = ai_tool_new("first", "The first tool");
+	second = ai_tool_new("second", "The second tool");
+	messages = g_list_append(messages, msg);
+	tools = g_list_append(tools, first);
+	tools = g_list_append(tools, second);
+
+	/* Without flags the request is unchanged */
+	body = build_body(client, messages, "You are helpful.", tools);
+	root = json_node_get_object(body);
+	g_assert_cmpstr(json_object_get_string_member(root, "system"), ==, "You are helpful.");
+	tool_arr = json_object_get_array_member(root, "tools");
+	g_assert_false(has_cache_control(json_array_get_object_element(tool_arr, 1)));
+	g_clear_pointer(&body, json_node_unref);
+
+	ai_claude_client_set_cache_breakpoints(client, AI_CLAUDE_CACHE_SYSTEM | AI_CLAUDE_CACHE_TOOLS);
+	body = build_body(client, messages, "You are helpful.", tools);
+	root = json_node_get_object(body);
+
+	system = json_object_get_array_member(root, "system");
+	g_assert_cmpuint(json_array_get_length(system), ==, 1);
+	g_assert_cmpstr(json_object_get_string_member(json_array_get_object_element(system, 0), "text"),
+	                ==, "You are helpful.");
+	g_assert_true(has_cache_control(json_array_get_object_element(system, 0)));
+
+	tool_arr = json_object_get_array_member(root, "tools");
+	g_assert_false(has_cache_control(json_array_get_object_element(tool_arr, 0)));
+	g_assert_true(has_cache_control(json_array_get_object_element(tool_arr, 1)));
+
+	g_list_free(messages);
+	g_list_free(tools);
+}
+
+static void
+test_claude_client_cache_conversation(void)
+{
+	g_autoptr(AiClaudeClient) client = NULL;
+	g_autoptr(JsonNode) body = NULL;
+	GList *messages = NULL;
+	JsonObject *root;
+
+	client = ai_claude_client_new_with_key("test-key");
+	ai_claude_client_set_cache_breakpoints(client, AI_CLAUDE_CACHE_CONVERSATION);
+
+	messages = g_list_append(messages, ai_message_new_user("First question"));
+	messages = g_list_append(messages, ai_message_new_assistant("First answer"));
+	messages = g_list_append(messages, ai_message_new_user("Second question"));
+	messages = g_list_append(messages, ai_message_new_assistant("Second answer"));
+	messages = g_list_append(messages, ai_message_new_user("Third question"));
+
+	/* The end of the previous turn and the end of this one */
+	body = build_body(client, messages, NULL, NULL);
+	root = json_node_get_object(body);
+	g_assert_false(message_cached(root, 0));
+	g_assert_false(message_cached(root, 1));
+	g_assert_true(message_cached(root, 2));
+	g_assert_false(message_cached(root, 3));
+	g_assert_true(message_cached(root, 4));
+	g_clear_pointer(&body, json_node_unref);
+
+	/* An explicit mark is honoured without any flags */
+	ai_claude_client_set_cache_breakpoints(client, AI_CLAUDE_CACHE_NONE);
+	ai_message_set_cache_breakpoint(g_list_nth_data(messages, 1), TRUE);
+	body = build_body(client, messages, NULL, NULL);
+	root = json_node_get_object(body);
+	g_assert_true(message_cached(root, 1));
+	g_assert_false(message_cached(root, 2));
+	g_assert_false(message_cached(root, 4));
+
+	g_list_free_full(messages, g_object_unref);
+}
+
+static void
+test_claude_client_cache_limit(void)
+{
+	g_autoptr(AiClaudeClient) client = NULL;
+	g_autoptr(AiTool) tool = NULL;
+	g_autoptr(JsonNode) body = NULL;
+	GList *messages = NULL;
+	GList *tools = NULL;
+	JsonObject *root;
+	GList *l;
+
+	client = ai_claude_client_new_with_key("test-key");
+	ai_claude_client_set_cache_breakpoints(client, AI_CLAUDE_CACHE_ALL);
+	tool = ai_tool_new("lookup", "Look something up");
+	tools = g_list_append(tools, tool);
+
+	messages = g_list_append(messages, ai_message_new_user("One"));
+	messages = g_list_append(messages, ai_message_new_assistant("Two"));
+	messages = g_list_append(messages, ai_message_new_user("Three"));
+	messages = g_list_append(messages, ai_message_new_assistant("Four"));
+	messages = g_list_append(messages, ai_message_new_user("Five"));
+
+	for (l = messages; l != NULL; l = l->next)
+	{
+		ai_message_set_cache_breakpoint(l->data, TRUE);
+	}
+
+	/* System and tools take two; only the two latest messages keep theirs */
+	body = build_body(client, messages, "System", tools);
+	root = json_node_get_object(body);
+	g_assert_false(message_cached(root, 0));
+	g_assert_false(message_cached(root, 1));
+	g_assert_false(message_cached(root, 2));
+	g_assert_true(message_cached(root, 3));
+	g_assert_true(message_cached(root, 4));
+
+	g_list_free_full(messages, g_object_unref);
+	g_list_free(tools);
+}
+
+static void
+test_claude_client_request_options(void)
+{
+	g_autoptr(AiClaudeClient) client = NULL;
+	g_autoptr(AiRequestOptions) options = NULL;
+	g_autoptr(AiRequestOptions) resolved = NULL;
+	g_autoptr(JsonParser) parser = json_parser_new();
+	g_autoptr(GBytes) body = NULL;
+	g_autoptr(GError) error = NULL;
+	const gchar *stop[] = { "END", NULL };
+	GList *messages = NULL;
+	JsonObject *root;
+	JsonArray *stop_array;
+	gsize len;
+	const gchar *data;
+
+	client = ai_claude_client_new_with_key("test-key");
+	ai_client_set_model(AI_CLIENT(client), AI_CLAUDE_MODEL_SONNET_4);
+	ai_client_set_system_prompt(AI_CLIENT(client), "Client prompt");
+	messages = g_list_append(messages, ai_message_new_user("Hello"));
+
+	/* Unset options fall back to the client */
+	options = ai_request_options_new();
+	resolved = ai_client_resolve_options(AI_CLIENT(client), options);
+	g_assert_cmpstr(ai_request_options_get_model(resolved), ==, AI_CLAUDE_MODEL_SONNET_4);
+	g_assert_cmpstr(ai_request_options_get_system_prompt(resolved), ==, "Client prompt");
+	g_assert_cmpint(ai_request_options_get_max_tokens(resolved), ==,
+	                ai_client_get_max_tokens(AI_CLIENT(client)));
+
+	ai_request_options_set_model(options, AI_CLAUDE_MODEL_HAIKU_4_5);
+	ai_request_options_set_system_prompt(options, NULL);
+	ai_request_options_set_max_tokens(options, 200);
+	ai_request_options_set_temperature(options, 0.25);
+	ai_request_options_set_stop_sequences(options, stop);
+
+	body = ai_client_build_request_body_with_options(AI_CLIENT(client), messages,
+	                                                 options, FALSE);
+	g_assert_nonnull(body);
+
+	data = g_bytes_get_data(body, &len);
+	json_parser_load_from_data(parser, data, (gssize)len, &error);
+	g_assert_no_error(error);
+
+	root = json_node_get_object(json_parser_get_root(parser));
+	g_assert_cmpstr(json_object_get_string_member(root, "model"), ==, AI_CLAUDE_MODEL_HAIKU_4_5);
+	g_assert_false(json_object_has_member(root, "system"));
+	g_assert_cmpint(json_object_get_int_member(root, "max_tokens"), ==, 200);
+	g_assert_cmpfloat(json_object_get_double_member(root, "temperature"), ==, 0.25);
+
+	stop_array = json_object_get_array_member(root, "stop_sequences");
+	g_assert_cmpuint(json_array_get_length(stop_array), ==, 1);
+	g_assert_cmpstr(json_array_get_string_element(stop_array, 0), ==, "END");
+
+	/* The client is untouched */
+	g_assert_cmpstr(ai_client_get_model(AI_CLIENT(client)), ==, AI_CLAUDE_MODEL_SONNET_4);
+	g_assert_cmpstr(ai_client_get_system_prompt(AI_CLIENT(client)), ==, "Client prompt");
+
+	g_list_free_full(messages, g_object_unref);
+}
+
 int
 main(
 	int   argc,
@@ -118,6 +393,11 @@ main(
 	g_test_add_func("/ai-glib/claude-client/api-version", test_claude_client_api_version);
 	g_test_add_func("/ai-glib/claude-client/model", test_claude_client_model);
 	g_test_add_func("/ai-glib/claude-client/gtype", test_claude_client_gtype);
+	g_test_add_func("/ai-glib/claude-client/cache-breakpoints", test_claude_client_cache_breakpoints);
+	g_test_add_func("/ai-glib/claude-client/cache-system-tools", test_claude_client_cache_system_tools);
+	g_test_add_func("/ai-glib/claude-client/cache-conversation", test_claude_client_cache_conversation);
+	g_test_add_func("/ai-glib/claude-client/cache-limit", test_claude_client_cache_limit);
+	g_test_add_func("/ai-glib/claude-client/request-options", test_claude_client_request_options);
 
 	return g_test_run();
 }
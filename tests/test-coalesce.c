@@ -0,0 +1,269 @@
+/*
+ * test-coalesce.c - Unit tests for coalescing identical requests
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "core/ai-client.h"
+#include "core/ai-config.h"
+#include "core/ai-provider.h"
+#include "model/ai-message.h"
+#include "model/ai-response.h"
+#include "providers/ai-claude-client.h"
+
+/*
+ * Local stand-in for the Claude messages endpoint. Replies are held
+ * back briefly so concurrent requests overlap.
+ */
+typedef struct
+{
+	SoupServer     *server;
+	AiClaudeClient *client;
+	GMainLoop      *loop;
+	guint           n_requests;
+	guint           pending;
+	AiResponse     *responses[3];
+	GError         *errors[3];
+} CoalesceFixture;
+
+static const gchar *claude_reply =
+	"{\"id\":\"msg_1\",\"type\":\"message\",\"role\":\"assistant\",\"model\":\"claude-test\","
+	"\"content\":[{\"type\":\"text\",\"text\":\"Hello\"}],\"stop_reason\":\"end_turn\","
+	"\"usage\":{\"input_tokens\":3,\"output_tokens\":1}}";
+
+static gboolean
+on_reply_timeout(gpointer user_data)
+{
+	SoupServerMessage *msg = user_data;
+
+	soup_server_message_set_status(msg, 200, NULL);
+	soup_server_message_set_response(msg, "application/json", SOUP_MEMORY_STATIC,
+	                                 claude_reply, strlen(claude_reply));
+	soup_server_message_unpause(msg);
+	g_object_unref(msg);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+on_messages_request(
+	SoupServer        *server,
+	SoupServerMessage *msg,
+	const char        *path,
+	GHashTable        *query,
+	gpointer           user_data
+){
+	CoalesceFixture *fixture = user_data;
+
+	(void)server;
+	(void)query;
+
+	g_assert_cmpstr(path, ==, "/v1/messages");
+	fixture->n_requests++;
+
+	soup_server_message_pause(msg);
+	g_timeout_add(50, on_reply_timeout, g_object_ref(msg));
+}
+
+static void
+fixture_setup(CoalesceFixture *fixture)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(AiConfig) config = NULL;
+	g_autofree gchar *base_url = NULL;
+	GSList *uris;
+
+	memset(fixture, 0, sizeof(*fixture));
+
+	fixture->server = soup_server_new(NULL);
+	soup_server_add_handler(fixture->server, NULL, on_messages_request, fixture, NULL);
+	g_assert_true(soup_server_listen_local(fixture->server, 0,
+	                                       SOUP_SERVER_LISTEN_IPV4_ONLY, &error));
+	g_assert_no_error(error);
+
+	uris = soup_server_get_uris(fixture->server);
+	base_url = g_strdup_printf("http://127.0.0.1:%d", g_uri_get_port(uris->data));
+	g_slist_free_full(uris, (GDestroyNotify)g_uri_unref);
+
+	config = ai_config_new();
+	ai_config_set_api_key(config, AI_PROVIDER_CLAUDE, "test-key");
+	ai_config_set_base_url(config, AI_PROVIDER_CLAUDE, base_url);
+
+	fixture->client = ai_claude_client_new_with_config(config);
+	fixture->loop = g_main_loop_new(NULL, FALSE);
+}
+
+static void
+fixture_teardown(CoalesceFixture *fixture)
+{
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(fixture->responses); i++)
+	{
+		g_clear_object(&fixture->responses[i]);
+		g_clear_error(&fixture->errors[i]);
+	}
+	g_clear_pointer(&fixture->loop, g_main_loop_unref);
+	g_clear_object(&fixture->client);
+	g_clear_object(&fixture->server);
+}
+
+static void
+on_chat_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	CoalesceFixture *fixture = g_object_get_data(G_OBJECT(source), "fixture");
+	guint index = GPOINTER_TO_UINT(user_data);
+
+	fixture->responses[index] = ai_provider_chat_finish(AI_PROVIDER(source), result,
+	                                                    &fixture->errors[index]);
+
+	if (--fixture->pending == 0)
+	{
+		g_main_loop_quit(fixture->loop);
+	}
+}
+
+static void
+start_chat(
+	CoalesceFixture *fixture,
+	guint            index,
+	const gchar     *prompt,
+	GCancellable    *cancellable
+){
+	g_autoptr(AiMessage) msg = ai_message_new_user(prompt);
+	GList messages = { NULL, NULL, NULL };
+
+	messages.data = msg;
+	g_object_set_data(G_OBJECT(fixture->client), "fixture", fixture);
+	fixture->pending++;
+	ai_provider_chat_async(AI_PROVIDER(fixture->client), &messages, NULL, 64, NULL,
+	                       cancellable, on_chat_done, GUINT_TO_POINTER(index));
+}
+
+static void
+assert_hello(AiResponse *response)
+{
+	g_autofree gchar *text = NULL;
+
+	g_assert_nonnull(response);
+	text = ai_response_get_text(response);
+	g_assert_cmpstr(text, ==, "Hello");
+}
+
+static void
+test_coalesce_identical(void)
+{
+	CoalesceFixture fixture;
+	guint i;
+
+	fixture_setup(&fixture);
+	g_assert_false(ai_client_get_coalesce_requests(AI_CLIENT(fixture.client)));
+	ai_client_set_coalesce_requests(AI_CLIENT(fixture.client), TRUE);
+
+	for (i = 0; i < 3; i++)
+	{
+		start_chat(&fixture, i, "Classify this", NULL);
+	}
+	g_main_loop_run(fixture.loop);
+
+	g_assert_cmpuint(fixture.n_requests, ==, 1);
+	for (i = 0; i < 3; i++)
+	{
+		g_assert_no_error(fixture.errors[i]);
+		assert_hello(fixture.responses[i]);
+	}
+
+	/* Each caller owns its own response */
+	g_assert_true(fixture.responses[0] != fixture.responses[1]);
+	g_assert_true(fixture.responses[1] != fixture.responses[2]);
+
+	/* Nothing is kept once the request is done */
+	start_chat(&fixture, 0, "Classify this", NULL);
+	g_clear_object(&fixture.responses[0]);
+	g_main_loop_run(fixture.loop);
+	g_assert_cmpuint(fixture.n_requests, ==, 2);
+
+	fixture_teardown(&fixture);
+}
+
+static void
+test_coalesce_different(void)
+{
+	CoalesceFixture fixture;
+
+	fixture_setup(&fixture);
+	ai_client_set_coalesce_requests(AI_CLIENT(fixture.client), TRUE);
+
+	start_chat(&fixture, 0, "Classify this", NULL);
+	start_chat(&fixture, 1, "Classify that", NULL);
+	g_main_loop_run(fixture.loop);
+
+	g_assert_cmpuint(fixture.n_requests, ==, 2);
+	assert_hello(fixture.responses[0]);
+	assert_hello(fixture.responses[1]);
+
+	fixture_teardown(&fixture);
+}
+
+static void
+test_coalesce_disabled(void)
+{
+	CoalesceFixture fixture;
+
+	fixture_setup(&fixture);
+
+	start_chat(&fixture, 0, "Classify this", NULL);
+	start_chat(&fixture, 1, "Classify this", NULL);
+	g_main_loop_run(fixture.loop);
+
+	g_assert_cmpuint(fixture.n_requests, ==, 2);
+
+	fixture_teardown(&fixture);
+}
+
+static void
+test_coalesce_cancel(void)
+{
+	CoalesceFixture fixture;
+	g_autoptr(GCancellable) cancellable = g_cancellable_new();
+
+	fixture_setup(&fixture);
+	ai_client_set_coalesce_requests(AI_CLIENT(fixture.client), TRUE);
+
+	/* The first caller giving up does not fail the second */
+	start_chat(&fixture, 0, "Classify this", cancellable);
+	start_chat(&fixture, 1, "Classify this", NULL);
+	g_cancellable_cancel(cancellable);
+	g_main_loop_run(fixture.loop);
+
+	g_assert_cmpuint(fixture.n_requests, ==, 1);
+	g_assert_error(fixture.errors[0], G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_assert_no_error(fixture.errors[1]);
+	assert_hello(fixture.responses[1]);
+
+	fixture_teardown(&fixture);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/coalesce/identical", test_coalesce_identical);
+	g_test_add_func("/ai-glib/coalesce/different", test_coalesce_different);
+	g_test_add_func("/ai-glib/coalesce/disabled", test_coalesce_disabled);
+	g_test_add_func("/ai-glib/coalesce/cancel", test_coalesce_cancel);
+
+	return g_test_run();
+}
@@ -148,6 +148,9 @@ test_config_load_from_file(void)
 		"default_model: qwen2.5:7b\n"
 		"timeout: 60\n"
 		"max_retries: 5\n"
+		"max_connections: 16\n"
+		"prewarm: true\n"
+		"parse_thread_threshold: 65536\n"
 		"providers:\n"
 		"  claude:\n"
 		"    api_key: sk-ant-test-123\n"
@@ -178,9 +181,12 @@ test_config_load_from_file(void)
 	g_assert_cmpstr(ai_config_get_default_model(config),
 	                ==, "qwen2.5:7b");
 
-	/* Verify timeout and max_retries */
+	/* Verify connection and parsing settings */
 	g_assert_cmpuint(ai_config_get_timeout(config), ==, 60);
 	g_assert_cmpuint(ai_config_get_max_retries(config), ==, 5);
+	g_assert_cmpuint(ai_config_get_max_connections(config), ==, 16);
+	g_assert_true(ai_config_get_prewarm(config));
+	g_assert_cmpuint(ai_config_get_parse_thread_threshold(config), ==, 65536);
 
 	/* Verify provider API keys */
 	g_assert_cmpstr(ai_config_get_api_key(config, AI_PROVIDER_CLAUDE),
@@ -383,6 +389,86 @@ test_config_env_overrides_file(void)
 	g_unlink(path);
 }
 
+static void
+test_config_pools(void)
+{
+	g_autoptr(AiConfig) config = NULL;
+	static const gchar *keys[] = { "key-a", "", "key-b", NULL };
+	static const gchar *urls[] = { "https://a.example", "https://b.example", NULL };
+	const gchar *const *pool;
+
+	g_unsetenv("GEMINI_API_KEY");
+
+	config = ai_config_new();
+	g_assert_null(ai_config_get_api_keys(config, AI_PROVIDER_GEMINI));
+
+	/* Empty entries are dropped; the first key is the primary key */
+	ai_config_set_api_keys(config, AI_PROVIDER_GEMINI, keys);
+	pool = ai_config_get_api_keys(config, AI_PROVIDER_GEMINI);
+	g_assert_nonnull(pool);
+	g_assert_cmpuint(g_strv_length((gchar **)pool), ==, 2);
+	g_assert_cmpstr(pool[1], ==, "key-b");
+	g_assert_cmpstr(ai_config_get_api_key(config, AI_PROVIDER_GEMINI), ==, "key-a");
+
+	/* An explicit key still wins */
+	ai_config_set_api_key(config, AI_PROVIDER_GEMINI, "single");
+	g_assert_cmpstr(ai_config_get_api_key(config, AI_PROVIDER_GEMINI), ==, "single");
+
+	ai_config_set_base_urls(config, AI_PROVIDER_GEMINI, urls);
+	g_assert_cmpstr(ai_config_get_base_url(config, AI_PROVIDER_GEMINI),
+	                ==, "https://a.example");
+
+	/* Every HTTP provider takes a custom base URL */
+	ai_config_set_base_url(config, AI_PROVIDER_CLAUDE, "http://127.0.0.1:8080");
+	g_assert_cmpstr(ai_config_get_base_url(config, AI_PROVIDER_CLAUDE),
+	                ==, "http://127.0.0.1:8080");
+
+	/* An empty pool clears it */
+	ai_config_set_api_keys(config, AI_PROVIDER_GEMINI, NULL);
+	g_assert_null(ai_config_get_api_keys(config, AI_PROVIDER_GEMINI));
+}
+
+static void
+test_config_file_pools(void)
+{
+	g_autoptr(AiConfig) config = NULL;
+	g_autofree gchar *path = NULL;
+	GError *error = NULL;
+	const gchar *const *pool;
+	const gchar *yaml_content =
+		"providers:\n"
+		"  openai:\n"
+		"    api_keys:\n"
+		"      - sk-one\n"
+		"      - sk-two\n"
+		"    base_urls:\n"
+		"      - https://east.example\n"
+		"      - https://west.example\n";
+
+	g_unsetenv("OPENAI_API_KEY");
+	g_unsetenv("OPENAI_BASE_URL");
+
+	path = write_temp_yaml(yaml_content);
+	config = g_object_new(AI_TYPE_CONFIG, NULL);
+
+	g_assert_true(ai_config_load_from_file(config, path, &error));
+	g_assert_no_error(error);
+
+	pool = ai_config_get_api_keys(config, AI_PROVIDER_OPENAI);
+	g_assert_nonnull(pool);
+	g_assert_cmpstr(pool[0], ==, "sk-one");
+	g_assert_cmpstr(pool[1], ==, "sk-two");
+	g_assert_null(pool[2]);
+
+	pool = ai_config_get_base_urls(config, AI_PROVIDER_OPENAI);
+	g_assert_nonnull(pool);
+	g_assert_cmpstr(pool[1], ==, "https://west.example");
+	g_assert_cmpstr(ai_config_get_base_url(config, AI_PROVIDER_OPENAI),
+	                ==, "https://east.example");
+
+	g_unlink(path);
+}
+
 static void
 test_config_file_missing(void)
 {
@@ -440,6 +526,8 @@ main(
 	                test_config_env_default_model);
 	g_test_add_func("/ai-glib/config/env-overrides-file",
 	                test_config_env_overrides_file);
+	g_test_add_func("/ai-glib/config/pools", test_config_pools);
+	g_test_add_func("/ai-glib/config/file-pools", test_config_file_pools);
 	g_test_add_func("/ai-glib/config/file-missing",
 	                test_config_file_missing);
 	g_test_add_func("/ai-glib/config/file-invalid-yaml",
@@ -0,0 +1,283 @@
+/*
+ * test-deadline.c - Unit tests for AiDeadline and request deadlines
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "core/ai-config.h"
+#include "core/ai-deadline.h"
+#include "core/ai-error.h"
+#include "core/ai-provider.h"
+#include "model/ai-message.h"
+#include "model/ai-request-options.h"
+#include "model/ai-response.h"
+#include "providers/ai-claude-client.h"
+
+/* Waits for the timer thread to cancel @cancellable */
+static gboolean
+wait_cancelled(GCancellable *cancellable)
+{
+	gint64 give_up = g_get_monotonic_time() + 5 * G_USEC_PER_SEC;
+
+	while (!g_cancellable_is_cancelled(cancellable))
+	{
+		if (g_get_monotonic_time() > give_up)
+		{
+			return FALSE;
+		}
+		g_usleep(1000);
+	}
+
+	return TRUE;
+}
+
+static void
+test_deadline_none(void)
+{
+	g_autoptr(AiDeadline) deadline = NULL;
+	g_autoptr(AiDeadline) with_parent = NULL;
+	g_autoptr(GCancellable) parent = g_cancellable_new();
+	g_autoptr(GError) error = NULL;
+
+	deadline = ai_deadline_new(0, NULL);
+	g_assert_cmpint(ai_deadline_get_time(deadline), ==, 0);
+	g_assert_null(ai_deadline_get_cancellable(deadline));
+	g_assert_false(ai_deadline_has_expired(deadline));
+	g_assert_cmpint(ai_deadline_get_remaining(deadline), ==, G_MAXINT64);
+	g_assert_true(ai_deadline_check(deadline, &error));
+	g_assert_no_error(error);
+
+	/* Without a deadline the caller's cancellable is used as it is */
+	with_parent = ai_deadline_new(0, parent);
+	g_assert_true(ai_deadline_get_cancellable(with_parent) == parent);
+}
+
+static void
+test_deadline_expires(void)
+{
+	g_autoptr(AiDeadline) deadline = NULL;
+	g_autoptr(GError) error = NULL;
+	GCancellable *cancellable;
+
+	deadline = ai_deadline_new(g_get_monotonic_time() + 50 * 1000, NULL);
+	cancellable = ai_deadline_get_cancellable(deadline);
+	g_assert_nonnull(cancellable);
+	g_assert_cmpint(ai_deadline_get_remaining(deadline), >, 0);
+
+	g_assert_true(wait_cancelled(cancellable));
+	g_assert_true(ai_deadline_has_expired(deadline));
+	g_assert_cmpint(ai_deadline_get_remaining(deadline), ==, 0);
+
+	g_assert_false(ai_deadline_check(deadline, &error));
+	g_assert_error(error, AI_ERROR, AI_ERROR_TIMEOUT);
+	g_clear_error(&error);
+
+	/* The cancellation it caused is reported as a timeout */
+	g_cancellable_set_error_if_cancelled(cancellable, &error);
+	g_assert_true(ai_deadline_translate_error(deadline, &error));
+	g_assert_error(error, AI_ERROR, AI_ERROR_TIMEOUT);
+	g_clear_error(&error);
+
+	/* Other errors are left alone */
+	g_set_error_literal(&error, AI_ERROR, AI_ERROR_NETWORK_ERROR, "Network");
+	g_assert_false(ai_deadline_translate_error(deadline, &error));
+	g_assert_error(error, AI_ERROR, AI_ERROR_NETWORK_ERROR);
+}
+
+static void
+test_deadline_parent_cancelled(void)
+{
+	g_autoptr(AiDeadline) deadline = NULL;
+	g_autoptr(GCancellable) parent = g_cancellable_new();
+	g_autoptr(GError) error = NULL;
+	GCancellable *cancellable;
+
+	deadline = ai_deadline_new(g_get_monotonic_time() + 60 * G_USEC_PER_SEC, parent);
+	cancellable = ai_deadline_get_cancellable(deadline);
+	g_assert_true(cancellable != parent);
+
+	g_cancellable_cancel(parent);
+	g_assert_true(g_cancellable_is_cancelled(cancellable));
+
+	/* The caller cancelled, so it stays a cancellation */
+	g_cancellable_set_error_if_cancelled(cancellable, &error);
+	g_assert_false(ai_deadline_translate_error(deadline, &error));
+	g_assert_error(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+}
+
+/*
+ * Local stand-in for the Claude messages endpoint that either never
+ * answers or is overloaded and asks for a long wait.
+ */
+typedef struct
+{
+	SoupServer *server;
+	gboolean    overloaded;
+	guint       requests;
+	GMainLoop  *loop;
+	AiResponse *response;
+	GError     *error;
+} DeadlineFixture;
+
+static void
+on_messages_request(
+	SoupServer        *server,
+	SoupServerMessage *msg,
+	const char        *path,
+	GHashTable        *query,
+	gpointer           user_data
+){
+	DeadlineFixture *fixture = user_data;
+	static const gchar *busy = "{\"type\":\"error\",\"error\":"
+	                           "{\"type\":\"overloaded_error\",\"message\":\"Overloaded\"}}";
+
+	(void)server;
+	(void)path;
+	(void)query;
+
+	fixture->requests++;
+
+	if (!fixture->overloaded)
+	{
+		soup_server_message_pause(msg);
+		return;
+	}
+
+	soup_message_headers_replace(soup_server_message_get_response_headers(msg),
+	                             "Retry-After", "60");
+	soup_server_message_set_status(msg, 503, NULL);
+	soup_server_message_set_response(msg, "application/json", SOUP_MEMORY_STATIC,
+	                                 busy, strlen(busy));
+}
+
+static AiClaudeClient *
+fixture_setup(
+	DeadlineFixture *fixture,
+	gboolean         overloaded
+){
+	g_autoptr(GError) error = NULL;
+	g_autoptr(AiConfig) config = ai_config_new();
+	g_autofree gchar *base_url = NULL;
+	GSList *uris;
+
+	memset(fixture, 0, sizeof(*fixture));
+	fixture->overloaded = overloaded;
+	fixture->loop = g_main_loop_new(NULL, FALSE);
+
+	fixture->server = soup_server_new(NULL);
+	soup_server_add_handler(fixture->server, NULL, on_messages_request, fixture, NULL);
+	g_assert_true(soup_server_listen_local(fixture->server, 0,
+	                                       SOUP_SERVER_LISTEN_IPV4_ONLY, &error));
+	g_assert_no_error(error);
+
+	uris = soup_server_get_uris(fixture->server);
+	base_url = g_strdup_printf("http://127.0.0.1:%d", g_uri_get_port(uris->data));
+	g_slist_free_full(uris, (GDestroyNotify)g_uri_unref);
+
+	ai_config_set_api_key(config, AI_PROVIDER_CLAUDE, "test-key");
+	ai_config_set_base_url(config, AI_PROVIDER_CLAUDE, base_url);
+	ai_config_set_max_retries(config, 3);
+
+	return ai_claude_client_new_with_config(config);
+}
+
+static void
+fixture_teardown(DeadlineFixture *fixture)
+{
+	g_clear_object(&fixture->response);
+	g_clear_error(&fixture->error);
+	g_clear_pointer(&fixture->loop, g_main_loop_unref);
+	g_clear_object(&fixture->server);
+}
+
+static void
+on_chat_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	DeadlineFixture *fixture = user_data;
+
+	fixture->response = ai_provider_chat_finish(AI_PROVIDER(source), result,
+	                                            &fixture->error);
+	g_main_loop_quit(fixture->loop);
+}
+
+static void
+run_chat(
+	DeadlineFixture *fixture,
+	AiClaudeClient  *client,
+	gint64           timeout_us
+){
+	g_autoptr(AiRequestOptions) options = ai_request_options_new();
+	g_autoptr(AiMessage) msg = ai_message_new_user("Hello");
+	GList messages = { NULL, NULL, NULL };
+
+	messages.data = msg;
+	ai_request_options_set_deadline(options, g_get_monotonic_time() + timeout_us);
+
+	ai_provider_chat_with_options_async(AI_PROVIDER(client), &messages, options,
+	                                    NULL, on_chat_done, fixture);
+	g_main_loop_run(fixture->loop);
+}
+
+static void
+test_deadline_chat_slow_server(void)
+{
+	DeadlineFixture fixture;
+	g_autoptr(AiClaudeClient) client = fixture_setup(&fixture, FALSE);
+	gint64 start = g_get_monotonic_time();
+
+	run_chat(&fixture, client, 200 * 1000);
+
+	/* The request in flight is stopped at the deadline */
+	g_assert_null(fixture.response);
+	g_assert_error(fixture.error, AI_ERROR, AI_ERROR_TIMEOUT);
+	g_assert_cmpint(g_get_monotonic_time() - start, <, 5 * G_USEC_PER_SEC);
+	g_assert_cmpuint(fixture.requests, ==, 1);
+
+	fixture_teardown(&fixture);
+}
+
+static void
+test_deadline_chat_no_retry_past_deadline(void)
+{
+	DeadlineFixture fixture;
+	g_autoptr(AiClaudeClient) client = fixture_setup(&fixture, TRUE);
+	gint64 start = g_get_monotonic_time();
+
+	run_chat(&fixture, client, 5 * G_USEC_PER_SEC);
+
+	/* A 60 s Retry-After cannot fit, so there is no second attempt */
+	g_assert_null(fixture.response);
+	g_assert_error(fixture.error, AI_ERROR, AI_ERROR_TIMEOUT);
+	g_assert_nonnull(strstr(fixture.error->message, "Overloaded"));
+	g_assert_cmpint(g_get_monotonic_time() - start, <, 5 * G_USEC_PER_SEC);
+	g_assert_cmpuint(fixture.requests, ==, 1);
+	g_assert_cmpuint(ai_client_get_retry_count(AI_CLIENT(client)), ==, 0);
+
+	fixture_teardown(&fixture);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/deadline/none", test_deadline_none);
+	g_test_add_func("/ai-glib/deadline/expires", test_deadline_expires);
+	g_test_add_func("/ai-glib/deadline/parent-cancelled", test_deadline_parent_cancelled);
+	g_test_add_func("/ai-glib/deadline/chat-slow-server", test_deadline_chat_slow_server);
+	g_test_add_func("/ai-glib/deadline/chat-no-retry-past-deadline",
+	                test_deadline_chat_no_retry_past_deadline);
+
+	return g_test_run();
+}
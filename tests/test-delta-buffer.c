@@ -0,0 +1,244 @@
+/*
+ * test-delta-buffer.c - Unit tests for AiDeltaBuffer
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "core/ai-client.h"
+#include "core/ai-delta-buffer.h"
+#include "core/ai-streamable.h"
+#include "providers/ai-claude-client.h"
+
+/*
+ * Records every delta emitted on a client, in order.
+ */
+typedef struct
+{
+	AiClaudeClient *client;
+	GPtrArray      *deltas;
+	GMainLoop      *loop;
+} DeltaFixture;
+
+static void
+on_delta(
+	AiStreamable *streamable,
+	const gchar  *text,
+	gpointer      user_data
+){
+	DeltaFixture *fixture = user_data;
+
+	(void)streamable;
+
+	g_ptr_array_add(fixture->deltas, g_strdup(text));
+	if (fixture->loop != NULL)
+	{
+		g_main_loop_quit(fixture->loop);
+	}
+}
+
+static void
+fixture_set_up(
+	DeltaFixture  *fixture,
+	gconstpointer  user_data
+){
+	(void)user_data;
+
+	fixture->client = ai_claude_client_new_with_key("test-key");
+	fixture->deltas = g_ptr_array_new_with_free_func(g_free);
+	fixture->loop = NULL;
+	g_signal_connect(fixture->client, "delta", G_CALLBACK(on_delta), fixture);
+}
+
+static void
+fixture_tear_down(
+	DeltaFixture  *fixture,
+	gconstpointer  user_data
+){
+	(void)user_data;
+
+	g_clear_object(&fixture->client);
+	g_clear_pointer(&fixture->deltas, g_ptr_array_unref);
+	g_clear_pointer(&fixture->loop, g_main_loop_unref);
+}
+
+static void
+assert_deltas(
+	DeltaFixture *fixture,
+	const gchar  *expected[],
+	guint         n_expected
+){
+	guint i;
+
+	g_assert_cmpuint(fixture->deltas->len, ==, n_expected);
+	for (i = 0; i < n_expected; i++)
+	{
+		g_assert_cmpstr(g_ptr_array_index(fixture->deltas, i), ==, expected[i]);
+	}
+}
+
+static void
+test_delta_buffer_pass_through(
+	DeltaFixture  *fixture,
+	gconstpointer  user_data
+){
+	g_autoptr(AiDeltaBuffer) buffer = NULL;
+	const gchar *expected[] = { "a", "b" };
+
+	(void)user_data;
+
+	buffer = ai_delta_buffer_new(AI_STREAMABLE(fixture->client), 0, 50, TRUE);
+	ai_delta_buffer_append(buffer, "a");
+	ai_delta_buffer_append(buffer, "b");
+	ai_delta_buffer_flush(buffer);
+
+	assert_deltas(fixture, expected, G_N_ELEMENTS(expected));
+}
+
+static void
+test_delta_buffer_min_bytes(
+	DeltaFixture  *fixture,
+	gconstpointer  user_data
+){
+	g_autoptr(AiDeltaBuffer) buffer = NULL;
+	const gchar *expected[] = { "abcd", "efgh", "i" };
+
+	(void)user_data;
+
+	buffer = ai_delta_buffer_new(AI_STREAMABLE(fixture->client), 4, 0, FALSE);
+	ai_delta_buffer_append(buffer, "ab");
+	ai_delta_buffer_append(buffer, "c");
+	g_assert_cmpuint(fixture->deltas->len, ==, 0);
+	ai_delta_buffer_append(buffer, "d");
+	ai_delta_buffer_append(buffer, "efgh");
+	ai_delta_buffer_append(buffer, "i");
+	ai_delta_buffer_flush(buffer);
+
+	/* Nothing is pending, so a second flush emits nothing */
+	ai_delta_buffer_flush(buffer);
+
+	assert_deltas(fixture, expected, G_N_ELEMENTS(expected));
+}
+
+static void
+test_delta_buffer_newline(
+	DeltaFixture  *fixture,
+	gconstpointer  user_data
+){
+	g_autoptr(AiDeltaBuffer) buffer = NULL;
+	const gchar *expected[] = { "one\n", "two\nth", "ree" };
+
+	(void)user_data;
+
+	buffer = ai_delta_buffer_new(AI_STREAMABLE(fixture->client), 64, 0, TRUE);
+	ai_delta_buffer_append(buffer, "on");
+	ai_delta_buffer_append(buffer, "e\n");
+	ai_delta_buffer_append(buffer, "two\nth");
+	ai_delta_buffer_append(buffer, "ree");
+	g_assert_cmpuint(fixture->deltas->len, ==, 2);
+	ai_delta_buffer_flush(buffer);
+
+	assert_deltas(fixture, expected, G_N_ELEMENTS(expected));
+}
+
+static void
+test_delta_buffer_delay(
+	DeltaFixture  *fixture,
+	gconstpointer  user_data
+){
+	g_autoptr(AiDeltaBuffer) buffer = NULL;
+	const gchar *expected[] = { "slow" };
+
+	(void)user_data;
+
+	fixture->loop = g_main_loop_new(NULL, FALSE);
+	buffer = ai_delta_buffer_new(AI_STREAMABLE(fixture->client), 64, 10, FALSE);
+	ai_delta_buffer_append(buffer, "sl");
+	ai_delta_buffer_append(buffer, "ow");
+	g_assert_cmpuint(fixture->deltas->len, ==, 0);
+
+	g_main_loop_run(fixture->loop);
+
+	assert_deltas(fixture, expected, G_N_ELEMENTS(expected));
+}
+
+static gboolean
+on_quit_timeout(gpointer user_data)
+{
+	g_main_loop_quit(user_data);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+test_delta_buffer_free_drops(
+	DeltaFixture  *fixture,
+	gconstpointer  user_data
+){
+	AiDeltaBuffer *buffer;
+	g_autoptr(GMainLoop) loop = NULL;
+
+	(void)user_data;
+
+	/* A buffer freed with text and a timer pending emits nothing later */
+	buffer = ai_delta_buffer_new(AI_STREAMABLE(fixture->client), 64, 1, FALSE);
+	ai_delta_buffer_append(buffer, "lost");
+	ai_delta_buffer_free(buffer);
+
+	loop = g_main_loop_new(NULL, FALSE);
+	g_timeout_add(20, on_quit_timeout, loop);
+	g_main_loop_run(loop);
+
+	g_assert_cmpuint(fixture->deltas->len, ==, 0);
+}
+
+static void
+test_delta_buffer_client_policy(void)
+{
+	g_autoptr(AiClaudeClient) client = NULL;
+	g_autoptr(AiDeltaBuffer) buffer = NULL;
+	AiClient *base;
+
+	client = ai_claude_client_new_with_key("test-key");
+	base = AI_CLIENT(client);
+
+	g_assert_cmpuint(ai_client_get_delta_min_bytes(base), ==, 0);
+	g_assert_cmpuint(ai_client_get_delta_max_delay(base), ==, 50);
+	g_assert_true(ai_client_get_delta_flush_on_newline(base));
+
+	g_object_set(client,
+	             "delta-min-bytes", 128,
+	             "delta-max-delay", 16,
+	             "delta-flush-on-newline", FALSE,
+	             NULL);
+	g_assert_cmpuint(ai_client_get_delta_min_bytes(base), ==, 128);
+	g_assert_cmpuint(ai_client_get_delta_max_delay(base), ==, 16);
+	g_assert_false(ai_client_get_delta_flush_on_newline(base));
+
+	buffer = ai_client_create_delta_buffer(base, NULL);
+	g_assert_nonnull(buffer);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add("/ai-glib/delta-buffer/pass-through", DeltaFixture, NULL,
+	           fixture_set_up, test_delta_buffer_pass_through, fixture_tear_down);
+	g_test_add("/ai-glib/delta-buffer/min-bytes", DeltaFixture, NULL,
+	           fixture_set_up, test_delta_buffer_min_bytes, fixture_tear_down);
+	g_test_add("/ai-glib/delta-buffer/newline", DeltaFixture, NULL,
+	           fixture_set_up, test_delta_buffer_newline, fixture_tear_down);
+	g_test_add("/ai-glib/delta-buffer/delay", DeltaFixture, NULL,
+	           fixture_set_up, test_delta_buffer_delay, fixture_tear_down);
+	g_test_add("/ai-glib/delta-buffer/free-drops", DeltaFixture, NULL,
+	           fixture_set_up, test_delta_buffer_free_drops, fixture_tear_down);
+	g_test_add_func("/ai-glib/delta-buffer/client-policy", test_delta_buffer_client_policy);
+
+	return g_test_run();
+}
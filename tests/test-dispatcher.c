@@ -0,0 +1,185 @@
+/*
+ * test-dispatcher.c - Unit tests for AiDispatcher
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <json-glib/json-glib.h>
+#include <libsoup/soup.h>
+
+#include "core/ai-client.h"
+#include "core/ai-config.h"
+#include "core/ai-dispatcher.h"
+#include "core/ai-provider.h"
+#include "model/ai-message.h"
+#include "model/ai-request-options.h"
+#include "model/ai-response.h"
+#include "providers/ai-claude-client.h"
+
+#define N_REQUESTS 12
+
+/*
+ * Local stand-in for the Claude messages endpoint. The reply names the
+ * model of the request, so each caller can tell its answer apart.
+ */
+static void
+on_messages_request(
+	SoupServer        *server,
+	SoupServerMessage *msg,
+	const char        *path,
+	GHashTable        *query,
+	gpointer           user_data
+){
+	SoupMessageBody *body = soup_server_message_get_request_body(msg);
+	g_autoptr(JsonParser) parser = json_parser_new();
+	g_autofree gchar *reply = NULL;
+	const gchar *model;
+
+	(void)server;
+	(void)path;
+	(void)query;
+	(void)user_data;
+
+	g_assert_true(json_parser_load_from_data(parser, body->data, body->length, NULL));
+	model = json_object_get_string_member(json_node_get_object(json_parser_get_root(parser)),
+	                                      "model");
+
+	reply = g_strdup_printf(
+		"{\"id\":\"msg_1\",\"type\":\"message\",\"role\":\"assistant\",\"model\":\"%s\","
+		"\"content\":[{\"type\":\"text\",\"text\":\"Hello\"}],\"stop_reason\":\"end_turn\","
+		"\"usage\":{\"input_tokens\":3,\"output_tokens\":1}}", model);
+
+	soup_server_message_set_status(msg, 200, NULL);
+	soup_server_message_set_response(msg, "application/json", SOUP_MEMORY_COPY,
+	                                 reply, strlen(reply));
+}
+
+static AiClaudeClient *
+create_client(SoupServer *server)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(AiConfig) config = ai_config_new();
+	g_autofree gchar *base_url = NULL;
+	GSList *uris;
+
+	soup_server_add_handler(server, NULL, on_messages_request, NULL, NULL);
+	g_assert_true(soup_server_listen_local(server, 0, SOUP_SERVER_LISTEN_IPV4_ONLY, &error));
+	g_assert_no_error(error);
+
+	uris = soup_server_get_uris(server);
+	base_url = g_strdup_printf("http://127.0.0.1:%d", g_uri_get_port(uris->data));
+	g_slist_free_full(uris, (GDestroyNotify)g_uri_unref);
+
+	ai_config_set_api_key(config, AI_PROVIDER_CLAUDE, "test-key");
+	ai_config_set_base_url(config, AI_PROVIDER_CLAUDE, base_url);
+
+	return ai_claude_client_new_with_config(config);
+}
+
+static void
+test_dispatcher_new(void)
+{
+	g_autoptr(AiDispatcher) dispatcher = NULL;
+	g_autoptr(AiDispatcher) per_cpu = NULL;
+
+	dispatcher = ai_dispatcher_new(3);
+	g_assert_cmpuint(ai_dispatcher_get_n_workers(dispatcher), ==, 3);
+	g_assert_cmpuint(ai_dispatcher_get_n_in_flight(dispatcher), ==, 0);
+
+	per_cpu = ai_dispatcher_new(0);
+	g_assert_cmpuint(ai_dispatcher_get_n_workers(per_cpu), ==, g_get_num_processors());
+}
+
+typedef struct
+{
+	GMainLoop *loop;
+	GThread   *caller;
+	gchar     *model;
+	guint     *pending;
+} ChatData;
+
+static void
+on_chat_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	ChatData *data = user_data;
+	g_autoptr(AiResponse) response = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* Results come back on the caller's context */
+	g_assert_true(g_thread_self() == data->caller);
+
+	response = ai_dispatcher_chat_finish(AI_DISPATCHER(source), result, &error);
+	g_assert_no_error(error);
+	g_assert_nonnull(response);
+	g_assert_cmpstr(ai_response_get_model(response), ==, data->model);
+
+	if (--(*data->pending) == 0)
+	{
+		g_main_loop_quit(data->loop);
+	}
+
+	g_free(data->model);
+	g_slice_free(ChatData, data);
+}
+
+static void
+test_dispatcher_chat(void)
+{
+	g_autoptr(SoupServer) server = soup_server_new(NULL);
+	g_autoptr(AiClaudeClient) client = create_client(server);
+	g_autoptr(AiDispatcher) dispatcher = ai_dispatcher_new(3);
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+	g_autoptr(AiMessage) msg = ai_message_new_user("Hello");
+	GList messages = { NULL, NULL, NULL };
+	guint pending = N_REQUESTS;
+	guint i;
+
+	messages.data = msg;
+
+	/* One client, shared by all workers, with a model per request */
+	for (i = 0; i < N_REQUESTS; i++)
+	{
+		g_autoptr(AiRequestOptions) options = ai_request_options_new();
+		ChatData *data = g_slice_new0(ChatData);
+
+		data->loop = loop;
+		data->caller = g_thread_self();
+		data->model = g_strdup_printf("model-%u", i);
+		data->pending = &pending;
+
+		ai_request_options_set_model(options, data->model);
+		ai_dispatcher_chat_async(dispatcher, AI_PROVIDER(client), &messages, options,
+		                         NULL, on_chat_done, data);
+	}
+
+	g_assert_cmpuint(ai_dispatcher_get_n_in_flight(dispatcher), <=, N_REQUESTS);
+
+	/* The server answers from this thread's main context */
+	g_main_loop_run(loop);
+
+	g_assert_cmpuint(pending, ==, 0);
+	g_assert_cmpuint(ai_dispatcher_get_n_in_flight(dispatcher), ==, 0);
+
+	/* The client was not changed by the requests */
+	g_assert_cmpstr(ai_client_get_model(AI_CLIENT(client)), !=, "model-0");
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/dispatcher/new", test_dispatcher_new);
+	g_test_add_func("/ai-glib/dispatcher/chat", test_dispatcher_chat);
+
+	return g_test_run();
+}
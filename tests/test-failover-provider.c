@@ -0,0 +1,688 @@
+/*
+ * test-failover-provider.c - Unit tests for AiFailoverProvider
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "core/ai-error.h"
+#include "core/ai-failover-provider.h"
+#include "core/ai-provider.h"
+#include "core/ai-streamable.h"
+#include "model/ai-message.h"
+#include "model/ai-response.h"
+
+/*
+ * A provider that answers after a short delay with its label as the
+ * response ID, or fails with @error_code when it is set. Streaming
+ * requests emit one delta first, except when failing as unavailable.
+ * It remembers the model of the last request made with options.
+ */
+#define TEST_TYPE_PROVIDER (test_provider_get_type())
+G_DECLARE_FINAL_TYPE(TestProvider, test_provider, TEST, PROVIDER, GObject)
+
+struct _TestProvider
+{
+	GObject parent_instance;
+
+	gchar *label;
+	gchar *model;
+	guint  delay;
+	gint   error_code;
+	guint  n_calls;
+};
+
+static void test_provider_iface_init(AiProviderInterface *iface);
+static void test_streamable_iface_init(AiStreamableInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(TestProvider, test_provider, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(AI_TYPE_PROVIDER, test_provider_iface_init)
+                        G_IMPLEMENT_INTERFACE(AI_TYPE_STREAMABLE, test_streamable_iface_init))
+
+static gboolean
+on_reply_timeout(gpointer user_data)
+{
+	GTask *task = user_data;
+	TestProvider *self = g_task_get_source_object(task);
+
+	if (g_task_return_error_if_cancelled(task))
+	{
+		/* nothing else to do */
+	}
+	else if (self->error_code != 0)
+	{
+		g_task_return_new_error(task, AI_ERROR, self->error_code, "%s failed", self->label);
+	}
+	else
+	{
+		g_task_return_pointer(task, ai_response_new(self->label, "test"), g_object_unref);
+	}
+
+	g_object_unref(task);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+test_provider_chat_async(
+	AiProvider          *provider,
+	GList               *messages,
+	const gchar         *system_prompt,
+	gint                 max_tokens,
+	GList               *tools,
+	GCancellable        *cancellable,
+	GAsyncReadyCallback  callback,
+	gpointer             user_data
+){
+	TestProvider *self = TEST_PROVIDER(provider);
+
+	self->n_calls++;
+	g_timeout_add(self->delay, on_reply_timeout,
+	              g_task_new(self, cancellable, callback, user_data));
+}
+
+static void
+test_provider_chat_with_options_async(
+	AiProvider             *provider,
+	GList                  *messages,
+	const AiRequestOptions *options,
+	GCancellable           *cancellable,
+	GAsyncReadyCallback     callback,
+	gpointer                user_data
+){
+	TestProvider *self = TEST_PROVIDER(provider);
+
+	g_free(self->model);
+	self->model = g_strdup(ai_request_options_get_model(options));
+
+	test_provider_chat_async(provider, messages, NULL, 0, NULL,
+	                         cancellable, callback, user_data);
+}
+
+static AiResponse *
+test_provider_chat_finish(
+	AiProvider    *provider,
+	GAsyncResult  *result,
+	GError       **error
+){
+	return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+test_provider_chat_stream_async(
+	AiStreamable        *streamable,
+	GList               *messages,
+	const gchar         *system_prompt,
+	gint                 max_tokens,
+	GList               *tools,
+	GCancellable        *cancellable,
+	GAsyncReadyCallback  callback,
+	gpointer             user_data
+){
+	TestProvider *self = TEST_PROVIDER(streamable);
+
+	self->n_calls++;
+	g_signal_emit_by_name(self, "stream-start");
+	if (self->error_code != AI_ERROR_SERVICE_UNAVAILABLE)
+	{
+		g_signal_emit_by_name(self, "delta", self->label);
+	}
+	g_timeout_add(self->delay, on_reply_timeout,
+	              g_task_new(self, cancellable, callback, user_data));
+}
+
+static void
+test_provider_chat_stream_with_options_async(
+	AiStreamable           *streamable,
+	GList                  *messages,
+	const AiRequestOptions *options,
+	GCancellable           *cancellable,
+	GAsyncReadyCallback     callback,
+	gpointer                user_data
+){
+	TestProvider *self = TEST_PROVIDER(streamable);
+
+	g_free(self->model);
+	self->model = g_strdup(ai_request_options_get_model(options));
+
+	test_provider_chat_stream_async(streamable, messages, NULL, 0, NULL,
+	                                cancellable, callback, user_data);
+}
+
+static AiResponse *
+test_provider_chat_stream_finish(
+	AiStreamable  *streamable,
+	GAsyncResult  *result,
+	GError       **error
+){
+	return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static const gchar *
+test_provider_get_name(AiProvider *provider)
+{
+	return TEST_PROVIDER(provider)->label;
+}
+
+static void
+test_provider_iface_init(AiProviderInterface *iface)
+{
+	iface->get_name = test_provider_get_name;
+	iface->chat_async = test_provider_chat_async;
+	iface->chat_with_options_async = test_provider_chat_with_options_async;
+	iface->chat_finish = test_provider_chat_finish;
+}
+
+static void
+test_streamable_iface_init(AiStreamableInterface *iface)
+{
+	iface->chat_stream_async = test_provider_chat_stream_async;
+	iface->chat_stream_with_options_async = test_provider_chat_stream_with_options_async;
+	iface->chat_stream_finish = test_provider_chat_stream_finish;
+}
+
+static void
+test_provider_finalize(GObject *object)
+{
+	g_free(TEST_PROVIDER(object)->label);
+	g_free(TEST_PROVIDER(object)->model);
+
+	G_OBJECT_CLASS(test_provider_parent_class)->finalize(object);
+}
+
+static void
+test_provider_class_init(TestProviderClass *klass)
+{
+	G_OBJECT_CLASS(klass)->finalize = test_provider_finalize;
+}
+
+static void
+test_provider_init(TestProvider *self)
+{
+	self->delay = 5;
+}
+
+static TestProvider *
+test_provider_new(const gchar *label)
+{
+	TestProvider *self = g_object_new(TEST_TYPE_PROVIDER, NULL);
+
+	self->label = g_strdup(label);
+
+	return self;
+}
+
+typedef struct
+{
+	GMainLoop  *loop;
+	AiResponse *response;
+	GError     *error;
+	GString    *deltas;
+	guint       n_starts;
+} ChatData;
+
+static void
+on_chat_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	ChatData *data = user_data;
+
+	data->response = ai_provider_chat_finish(AI_PROVIDER(source), result, &data->error);
+	g_main_loop_quit(data->loop);
+}
+
+static void
+on_stream_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	ChatData *data = user_data;
+
+	data->response = ai_streamable_chat_stream_finish(AI_STREAMABLE(source), result,
+	                                                  &data->error);
+	g_main_loop_quit(data->loop);
+}
+
+static void
+on_delta(
+	AiStreamable *streamable,
+	const gchar  *text,
+	gpointer      user_data
+){
+	ChatData *data = user_data;
+
+	g_string_append(data->deltas, text);
+}
+
+static void
+on_stream_start(
+	AiStreamable *streamable,
+	gpointer      user_data
+){
+	ChatData *data = user_data;
+
+	data->n_starts++;
+}
+
+static void
+run_chat(
+	AiFailoverProvider *failover,
+	gboolean            stream,
+	ChatData           *data
+){
+	g_autoptr(AiMessage) msg = ai_message_new_user("Hello");
+	GList messages = { NULL, NULL, NULL };
+	gulong delta_id;
+	gulong start_id;
+
+	messages.data = msg;
+	data->loop = g_main_loop_new(NULL, FALSE);
+	data->response = NULL;
+	data->error = NULL;
+	data->deltas = g_string_new(NULL);
+	data->n_starts = 0;
+
+	delta_id = g_signal_connect(failover, "delta", G_CALLBACK(on_delta), data);
+	start_id = g_signal_connect(failover, "stream-start", G_CALLBACK(on_stream_start), data);
+
+	if (stream)
+	{
+		ai_streamable_chat_stream_async(AI_STREAMABLE(failover), &messages, NULL, 64, NULL,
+		                                NULL, on_stream_done, data);
+	}
+	else
+	{
+		ai_provider_chat_async(AI_PROVIDER(failover), &messages, NULL, 64, NULL,
+		                       NULL, on_chat_done, data);
+	}
+	g_main_loop_run(data->loop);
+	g_main_loop_unref(data->loop);
+
+	g_signal_handler_disconnect(failover, delta_id);
+	g_signal_handler_disconnect(failover, start_id);
+}
+
+static void
+chat_data_clear(ChatData *data)
+{
+	g_clear_object(&data->response);
+	g_clear_error(&data->error);
+	g_string_free(data->deltas, TRUE);
+}
+
+static void
+test_failover_next_provider(void)
+{
+	g_autoptr(TestProvider) first = test_provider_new("first");
+	g_autoptr(TestProvider) second = test_provider_new("second");
+	g_autoptr(AiFailoverProvider) failover = ai_failover_provider_new();
+	ChatData data;
+
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(first));
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(second));
+	g_assert_cmpuint(ai_failover_provider_get_n_providers(failover), ==, 2);
+	g_assert_true(ai_failover_provider_get_provider(failover, 1) == AI_PROVIDER(second));
+
+	run_chat(failover, FALSE, &data);
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "first");
+	g_assert_cmpuint(second->n_calls, ==, 0);
+	chat_data_clear(&data);
+
+	first->error_code = AI_ERROR_SERVER_ERROR;
+	run_chat(failover, FALSE, &data);
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "second");
+	chat_data_clear(&data);
+
+	/* One failure is not enough to open the circuit */
+	g_assert_cmpint(ai_failover_provider_get_circuit_state(failover, 0), ==, AI_CIRCUIT_CLOSED);
+
+	/* With every provider failing, the last error is returned */
+	second->error_code = AI_ERROR_RATE_LIMITED;
+	run_chat(failover, FALSE, &data);
+	g_assert_error(data.error, AI_ERROR, AI_ERROR_RATE_LIMITED);
+	chat_data_clear(&data);
+}
+
+static void
+test_failover_request_error(void)
+{
+	g_autoptr(TestProvider) first = test_provider_new("first");
+	g_autoptr(TestProvider) second = test_provider_new("second");
+	g_autoptr(AiFailoverProvider) failover = ai_failover_provider_new();
+	ChatData data;
+
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(first));
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(second));
+
+	/* A bad request would fail everywhere, so it is not retried */
+	first->error_code = AI_ERROR_INVALID_REQUEST;
+	run_chat(failover, FALSE, &data);
+	g_assert_error(data.error, AI_ERROR, AI_ERROR_INVALID_REQUEST);
+	g_assert_cmpuint(second->n_calls, ==, 0);
+	chat_data_clear(&data);
+}
+
+static void
+test_failover_circuit_opens(void)
+{
+	g_autoptr(TestProvider) first = test_provider_new("first");
+	g_autoptr(TestProvider) second = test_provider_new("second");
+	g_autoptr(AiFailoverProvider) failover = ai_failover_provider_new();
+	ChatData data;
+	guint i;
+
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(first));
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(second));
+
+	first->error_code = AI_ERROR_SERVICE_UNAVAILABLE;
+	for (i = 0; i < 5; i++)
+	{
+		run_chat(failover, FALSE, &data);
+		g_assert_cmpstr(ai_response_get_id(data.response), ==, "second");
+		chat_data_clear(&data);
+	}
+	g_assert_cmpint(ai_failover_provider_get_circuit_state(failover, 0), ==, AI_CIRCUIT_OPEN);
+
+	/* The open circuit is skipped without a request */
+	run_chat(failover, FALSE, &data);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "second");
+	g_assert_cmpuint(first->n_calls, ==, 5);
+	chat_data_clear(&data);
+
+	/* Resetting closes the circuit by hand */
+	ai_failover_provider_reset_circuit(failover, 0);
+	g_assert_cmpint(ai_failover_provider_get_circuit_state(failover, 0), ==, AI_CIRCUIT_CLOSED);
+}
+
+static void
+test_failover_all_open(void)
+{
+	g_autoptr(TestProvider) only = test_provider_new("only");
+	g_autoptr(AiFailoverProvider) failover = ai_failover_provider_new();
+	ChatData data;
+	guint i;
+
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(only));
+	only->error_code = AI_ERROR_NETWORK_ERROR;
+
+	for (i = 0; i < 5; i++)
+	{
+		run_chat(failover, FALSE, &data);
+		g_assert_error(data.error, AI_ERROR, AI_ERROR_NETWORK_ERROR);
+		chat_data_clear(&data);
+	}
+
+	run_chat(failover, FALSE, &data);
+	g_assert_error(data.error, AI_ERROR, AI_ERROR_SERVICE_UNAVAILABLE);
+	g_assert_cmpuint(only->n_calls, ==, 5);
+	chat_data_clear(&data);
+}
+
+static void
+test_failover_half_open(void)
+{
+	g_autoptr(TestProvider) first = test_provider_new("first");
+	g_autoptr(TestProvider) second = test_provider_new("second");
+	g_autoptr(AiFailoverProvider) failover = ai_failover_provider_new();
+	ChatData data;
+	guint i;
+
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(first));
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(second));
+	ai_failover_provider_set_open_timeout(failover, 0);
+
+	first->error_code = AI_ERROR_TIMEOUT;
+	for (i = 0; i < 5; i++)
+	{
+		run_chat(failover, FALSE, &data);
+		chat_data_clear(&data);
+	}
+
+	/* The timeout has passed, so the next request is the trial */
+	g_assert_cmpint(ai_failover_provider_get_circuit_state(failover, 0), ==,
+	                AI_CIRCUIT_HALF_OPEN);
+
+	/* A failed trial opens the circuit again */
+	run_chat(failover, FALSE, &data);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "second");
+	g_assert_cmpuint(first->n_calls, ==, 6);
+	chat_data_clear(&data);
+
+	/* A successful one closes it */
+	first->error_code = 0;
+	run_chat(failover, FALSE, &data);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "first");
+	g_assert_cmpint(ai_failover_provider_get_circuit_state(failover, 0), ==, AI_CIRCUIT_CLOSED);
+	chat_data_clear(&data);
+}
+
+static void
+test_failover_slow_calls(void)
+{
+	g_autoptr(TestProvider) first = test_provider_new("first");
+	g_autoptr(TestProvider) second = test_provider_new("second");
+	g_autoptr(AiFailoverProvider) failover = ai_failover_provider_new();
+	ChatData data;
+	guint i;
+
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(first));
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(second));
+	ai_failover_provider_set_slow_call_threshold(failover, 10);
+	first->delay = 30;
+
+	/* Slow answers are still returned, but open the circuit */
+	for (i = 0; i < 5; i++)
+	{
+		run_chat(failover, FALSE, &data);
+		g_assert_cmpstr(ai_response_get_id(data.response), ==, "first");
+		chat_data_clear(&data);
+	}
+	g_assert_cmpint(ai_failover_provider_get_circuit_state(failover, 0), ==, AI_CIRCUIT_OPEN);
+
+	run_chat(failover, FALSE, &data);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "second");
+	chat_data_clear(&data);
+}
+
+static void
+on_stale_chat_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	guint *n_pending = user_data;
+	g_autoptr(AiResponse) response = NULL;
+	g_autoptr(GError) error = NULL;
+
+	response = ai_provider_chat_finish(AI_PROVIDER(source), result, &error);
+	g_assert_error(error, AI_ERROR, AI_ERROR_SERVER_ERROR);
+	(*n_pending)--;
+}
+
+static void
+test_failover_stale_outcomes(void)
+{
+	g_autoptr(TestProvider) only = test_provider_new("only");
+	g_autoptr(AiFailoverProvider) failover = ai_failover_provider_new();
+	g_autoptr(AiMessage) msg = ai_message_new_user("Hello");
+	GList messages = { NULL, NULL, NULL };
+	guint n_pending = 5;
+	guint i;
+
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(only));
+	only->error_code = AI_ERROR_SERVER_ERROR;
+	only->delay = 50;
+	messages.data = msg;
+
+	for (i = 0; i < n_pending; i++)
+	{
+		ai_provider_chat_async(AI_PROVIDER(failover), &messages, NULL, 64, NULL,
+		                       NULL, on_stale_chat_done, &n_pending);
+	}
+
+	/* Failures of requests from before the reset do not count after it */
+	ai_failover_provider_reset_circuit(failover, 0);
+	while (n_pending > 0)
+	{
+		g_main_context_iteration(NULL, TRUE);
+	}
+
+	g_assert_cmpint(ai_failover_provider_get_circuit_state(failover, 0), ==, AI_CIRCUIT_CLOSED);
+}
+
+static void
+test_failover_stream(void)
+{
+	g_autoptr(TestProvider) first = test_provider_new("first");
+	g_autoptr(TestProvider) second = test_provider_new("second");
+	g_autoptr(AiFailoverProvider) failover = ai_failover_provider_new();
+	ChatData data;
+
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(first));
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(second));
+
+	/* A failure before any delta moves on to the next provider */
+	first->error_code = AI_ERROR_SERVICE_UNAVAILABLE;
+	run_chat(failover, TRUE, &data);
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "second");
+	g_assert_cmpstr(data.deltas->str, ==, "second");
+	g_assert_cmpuint(data.n_starts, ==, 1);
+	chat_data_clear(&data);
+
+	/* After a delta, the partial answer cannot be replaced */
+	first->error_code = AI_ERROR_STREAMING_ERROR;
+	run_chat(failover, TRUE, &data);
+	g_assert_error(data.error, AI_ERROR, AI_ERROR_STREAMING_ERROR);
+	g_assert_cmpstr(data.deltas->str, ==, "first");
+	g_assert_cmpuint(second->n_calls, ==, 1);
+	chat_data_clear(&data);
+}
+
+static void
+on_concurrent_stream_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	ChatData *data = user_data;
+	g_autoptr(AiResponse) response = NULL;
+
+	response = ai_streamable_chat_stream_finish(AI_STREAMABLE(source), result, &data->error);
+	g_assert_no_error(data->error);
+
+	/* The loop stops after the second of the two requests */
+	if (data->response == NULL)
+	{
+		data->response = g_steal_pointer(&response);
+		return;
+	}
+	g_main_loop_quit(data->loop);
+}
+
+static void
+test_failover_concurrent_streams(void)
+{
+	g_autoptr(TestProvider) only = test_provider_new("only");
+	g_autoptr(AiFailoverProvider) failover = ai_failover_provider_new();
+	g_autoptr(AiMessage) msg = ai_message_new_user("Hello");
+	GList messages = { NULL, NULL, NULL };
+	ChatData data = { NULL, NULL, NULL, NULL, 0 };
+	gulong delta_id;
+	gulong start_id;
+
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(only));
+	messages.data = msg;
+	data.loop = g_main_loop_new(NULL, FALSE);
+	data.deltas = g_string_new(NULL);
+	delta_id = g_signal_connect(failover, "delta", G_CALLBACK(on_delta), &data);
+	start_id = g_signal_connect(failover, "stream-start", G_CALLBACK(on_stream_start), &data);
+
+	/* Two streams on one provider: each delta reaches the caller once */
+	ai_streamable_chat_stream_async(AI_STREAMABLE(failover), &messages, NULL, 64, NULL,
+	                                NULL, on_concurrent_stream_done, &data);
+	ai_streamable_chat_stream_async(AI_STREAMABLE(failover), &messages, NULL, 64, NULL,
+	                                NULL, on_concurrent_stream_done, &data);
+	g_main_loop_run(data.loop);
+	g_main_loop_unref(data.loop);
+
+	g_assert_cmpstr(data.deltas->str, ==, "onlyonly");
+	g_assert_cmpuint(data.n_starts, ==, 2);
+
+	g_signal_handler_disconnect(failover, delta_id);
+	g_signal_handler_disconnect(failover, start_id);
+	chat_data_clear(&data);
+}
+
+static void
+test_failover_options(void)
+{
+	g_autoptr(TestProvider) first = test_provider_new("first");
+	g_autoptr(TestProvider) second = test_provider_new("second");
+	g_autoptr(AiFailoverProvider) failover = ai_failover_provider_new();
+	g_autoptr(AiRequestOptions) options = ai_request_options_new();
+	g_autoptr(AiMessage) msg = ai_message_new_user("Hello");
+	GList messages = { NULL, NULL, NULL };
+	ChatData data = { NULL, NULL, NULL, NULL, 0 };
+
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(first));
+	ai_failover_provider_add_provider(failover, AI_PROVIDER(second));
+	ai_request_options_set_model(options, "test-model");
+	messages.data = msg;
+
+	/* The per-request model reaches every provider tried */
+	first->error_code = AI_ERROR_SERVICE_UNAVAILABLE;
+	data.loop = g_main_loop_new(NULL, FALSE);
+	ai_provider_chat_with_options_async(AI_PROVIDER(failover), &messages, options,
+	                                    NULL, on_chat_done, &data);
+	g_main_loop_run(data.loop);
+
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "second");
+	g_assert_cmpstr(first->model, ==, "test-model");
+	g_assert_cmpstr(second->model, ==, "test-model");
+	g_clear_object(&data.response);
+
+	/* And so it does for streaming requests */
+	g_clear_pointer(&first->model, g_free);
+	g_clear_pointer(&second->model, g_free);
+	ai_streamable_chat_stream_with_options_async(AI_STREAMABLE(failover), &messages, options,
+	                                             NULL, on_stream_done, &data);
+	g_main_loop_run(data.loop);
+	g_main_loop_unref(data.loop);
+
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "second");
+	g_assert_cmpstr(first->model, ==, "test-model");
+	g_assert_cmpstr(second->model, ==, "test-model");
+	g_clear_object(&data.response);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/failover-provider/next-provider", test_failover_next_provider);
+	g_test_add_func("/ai-glib/failover-provider/request-error", test_failover_request_error);
+	g_test_add_func("/ai-glib/failover-provider/circuit-opens", test_failover_circuit_opens);
+	g_test_add_func("/ai-glib/failover-provider/all-open", test_failover_all_open);
+	g_test_add_func("/ai-glib/failover-provider/half-open", test_failover_half_open);
+	g_test_add_func("/ai-glib/failover-provider/slow-calls", test_failover_slow_calls);
+	g_test_add_func("/ai-glib/failover-provider/stale-outcomes", test_failover_stale_outcomes);
+	g_test_add_func("/ai-glib/failover-provider/stream", test_failover_stream);
+	g_test_add_func("/ai-glib/failover-provider/concurrent-streams",
+	                test_failover_concurrent_streams);
+	g_test_add_func("/ai-glib/failover-provider/options", test_failover_options);
+
+	return g_test_run();
+}
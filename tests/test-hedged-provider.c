@@ -0,0 +1,455 @@
+/*
+ * test-hedged-provider.c - Unit tests for AiHedgedProvider
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+
+#include "core/ai-error.h"
+#include "core/ai-hedged-provider.h"
+#include "core/ai-provider.h"
+#include "model/ai-message.h"
+#include "model/ai-response.h"
+
+/*
+ * A provider that answers after a fixed delay with its label as the
+ * response ID, or fails when told to. It remembers the model of the
+ * last request made with options.
+ */
+#define TEST_TYPE_PROVIDER (test_provider_get_type())
+G_DECLARE_FINAL_TYPE(TestProvider, test_provider, TEST, PROVIDER, GObject)
+
+struct _TestProvider
+{
+	GObject parent_instance;
+
+	gchar   *label;
+	gchar   *model;
+	guint    delay;
+	gboolean fail;
+	guint    n_calls;
+	guint    n_cancelled;
+	guint    in_flight;
+};
+
+static void test_provider_iface_init(AiProviderInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(TestProvider, test_provider, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(AI_TYPE_PROVIDER, test_provider_iface_init))
+
+static gboolean
+on_reply_timeout(gpointer user_data)
+{
+	GTask *task = user_data;
+	TestProvider *self = g_task_get_source_object(task);
+
+	self->in_flight--;
+
+	if (g_task_return_error_if_cancelled(task))
+	{
+		self->n_cancelled++;
+	}
+	else if (self->fail)
+	{
+		g_task_return_new_error(task, AI_ERROR, AI_ERROR_SERVER_ERROR, "%s failed", self->label);
+	}
+	else
+	{
+		g_task_return_pointer(task, ai_response_new(self->label, "test"), g_object_unref);
+	}
+
+	g_object_unref(task);
+	return G_SOURCE_REMOVE;
+}
+
+static void
+test_provider_chat_async(
+	AiProvider          *provider,
+	GList               *messages,
+	const gchar         *system_prompt,
+	gint                 max_tokens,
+	GList               *tools,
+	GCancellable        *cancellable,
+	GAsyncReadyCallback  callback,
+	gpointer             user_data
+){
+	TestProvider *self = TEST_PROVIDER(provider);
+	GTask *task;
+
+	task = g_task_new(self, cancellable, callback, user_data);
+
+	self->n_calls++;
+	self->in_flight++;
+	g_timeout_add(self->delay, on_reply_timeout, task);
+}
+
+static void
+test_provider_chat_with_options_async(
+	AiProvider             *provider,
+	GList                  *messages,
+	const AiRequestOptions *options,
+	GCancellable           *cancellable,
+	GAsyncReadyCallback     callback,
+	gpointer                user_data
+){
+	TestProvider *self = TEST_PROVIDER(provider);
+
+	g_free(self->model);
+	self->model = g_strdup(ai_request_options_get_model(options));
+
+	test_provider_chat_async(provider, messages, NULL, 0, NULL,
+	                         cancellable, callback, user_data);
+}
+
+static AiResponse *
+test_provider_chat_finish(
+	AiProvider    *provider,
+	GAsyncResult  *result,
+	GError       **error
+){
+	return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+test_provider_iface_init(AiProviderInterface *iface)
+{
+	iface->chat_async = test_provider_chat_async;
+	iface->chat_with_options_async = test_provider_chat_with_options_async;
+	iface->chat_finish = test_provider_chat_finish;
+}
+
+static void
+test_provider_finalize(GObject *object)
+{
+	g_free(TEST_PROVIDER(object)->label);
+	g_free(TEST_PROVIDER(object)->model);
+
+	G_OBJECT_CLASS(test_provider_parent_class)->finalize(object);
+}
+
+static void
+test_provider_class_init(TestProviderClass *klass)
+{
+	G_OBJECT_CLASS(klass)->finalize = test_provider_finalize;
+}
+
+static void
+test_provider_init(TestProvider *self)
+{
+}
+
+static TestProvider *
+test_provider_new(
+	const gchar *label,
+	guint        delay
+){
+	TestProvider *self = g_object_new(TEST_TYPE_PROVIDER, NULL);
+
+	self->label = g_strdup(label);
+	self->delay = delay;
+
+	return self;
+}
+
+/*
+ * Wait for replies still on their way, so cancelled losers are counted.
+ */
+static void
+drain(TestProvider *provider)
+{
+	while (provider->in_flight > 0)
+	{
+		g_main_context_iteration(NULL, TRUE);
+	}
+}
+
+typedef struct
+{
+	GMainLoop  *loop;
+	AiResponse *response;
+	GError     *error;
+} ChatData;
+
+static void
+on_chat_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	ChatData *data = user_data;
+
+	data->response = ai_provider_chat_finish(AI_PROVIDER(source), result, &data->error);
+	g_main_loop_quit(data->loop);
+}
+
+static void
+run_chat(
+	AiHedgedProvider *hedged,
+	GCancellable     *cancellable,
+	ChatData         *data
+){
+	g_autoptr(AiMessage) msg = ai_message_new_user("Hello");
+	GList messages = { NULL, NULL, NULL };
+
+	messages.data = msg;
+	data->loop = g_main_loop_new(NULL, FALSE);
+	data->response = NULL;
+	data->error = NULL;
+
+	ai_provider_chat_async(AI_PROVIDER(hedged), &messages, NULL, 64, NULL,
+	                       cancellable, on_chat_done, data);
+	g_main_loop_run(data->loop);
+	g_main_loop_unref(data->loop);
+}
+
+static void
+chat_data_clear(ChatData *data)
+{
+	g_clear_object(&data->response);
+	g_clear_error(&data->error);
+}
+
+static void
+test_hedged_new(void)
+{
+	g_autoptr(TestProvider) primary = test_provider_new("primary", 10);
+	g_autoptr(AiHedgedProvider) hedged = NULL;
+
+	hedged = ai_hedged_provider_new(AI_PROVIDER(primary), NULL);
+	g_assert_nonnull(hedged);
+
+	/* Without a backup, hedges go to the primary */
+	g_assert_true(ai_hedged_provider_get_primary(hedged) == AI_PROVIDER(primary));
+	g_assert_true(ai_hedged_provider_get_backup(hedged) == AI_PROVIDER(primary));
+	g_assert_cmpfloat(ai_hedged_provider_get_percentile(hedged), ==,
+	                  AI_HEDGED_PROVIDER_DEFAULT_PERCENTILE);
+	g_assert_cmpuint(ai_hedged_provider_get_hedge_delay(hedged), ==,
+	                 AI_HEDGED_PROVIDER_DEFAULT_INITIAL_DELAY);
+	g_assert_cmpuint(ai_hedged_provider_get_n_hedged(hedged), ==, 0);
+}
+
+static void
+test_hedged_fast_primary(void)
+{
+	g_autoptr(TestProvider) primary = test_provider_new("primary", 10);
+	g_autoptr(TestProvider) backup = test_provider_new("backup", 10);
+	g_autoptr(AiHedgedProvider) hedged = NULL;
+	ChatData data;
+
+	hedged = ai_hedged_provider_new(AI_PROVIDER(primary), AI_PROVIDER(backup));
+	ai_hedged_provider_set_delay_bounds(hedged, 500, 1);
+
+	run_chat(hedged, NULL, &data);
+
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "primary");
+	g_assert_cmpuint(backup->n_calls, ==, 0);
+	g_assert_cmpuint(ai_hedged_provider_get_n_hedged(hedged), ==, 0);
+
+	chat_data_clear(&data);
+}
+
+static void
+test_hedged_slow_primary(void)
+{
+	g_autoptr(TestProvider) primary = test_provider_new("primary", 300);
+	g_autoptr(TestProvider) backup = test_provider_new("backup", 10);
+	g_autoptr(AiHedgedProvider) hedged = NULL;
+	ChatData data;
+
+	hedged = ai_hedged_provider_new(AI_PROVIDER(primary), AI_PROVIDER(backup));
+	ai_hedged_provider_set_delay_bounds(hedged, 30, 1);
+
+	run_chat(hedged, NULL, &data);
+
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "backup");
+	g_assert_cmpuint(ai_hedged_provider_get_n_hedged(hedged), ==, 1);
+	g_assert_cmpuint(ai_hedged_provider_get_n_hedge_wins(hedged), ==, 1);
+
+	/* The losing primary was cancelled */
+	drain(primary);
+	g_assert_cmpuint(primary->n_cancelled, ==, 1);
+
+	chat_data_clear(&data);
+}
+
+static void
+test_hedged_primary_fails(void)
+{
+	g_autoptr(TestProvider) primary = test_provider_new("primary", 100);
+	g_autoptr(TestProvider) backup = test_provider_new("backup", 200);
+	g_autoptr(AiHedgedProvider) hedged = NULL;
+	ChatData data;
+
+	hedged = ai_hedged_provider_new(AI_PROVIDER(primary), AI_PROVIDER(backup));
+	ai_hedged_provider_set_delay_bounds(hedged, 30, 1);
+
+	/* A failing primary waits for the hedge still in flight */
+	primary->fail = TRUE;
+	run_chat(hedged, NULL, &data);
+
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "backup");
+	chat_data_clear(&data);
+
+	/* With both failing, the first error is returned */
+	backup->fail = TRUE;
+	run_chat(hedged, NULL, &data);
+
+	g_assert_error(data.error, AI_ERROR, AI_ERROR_SERVER_ERROR);
+	g_assert_cmpstr(data.error->message, ==, "primary failed");
+	g_assert_null(data.response);
+	chat_data_clear(&data);
+}
+
+static gboolean
+on_cancel_timeout(gpointer user_data)
+{
+	g_cancellable_cancel(G_CANCELLABLE(user_data));
+	return G_SOURCE_REMOVE;
+}
+
+static void
+test_hedged_cancel(void)
+{
+	g_autoptr(TestProvider) primary = test_provider_new("primary", 100);
+	g_autoptr(TestProvider) backup = test_provider_new("backup", 100);
+	g_autoptr(AiHedgedProvider) hedged = NULL;
+	g_autoptr(GCancellable) cancellable = g_cancellable_new();
+	ChatData data;
+
+	hedged = ai_hedged_provider_new(AI_PROVIDER(primary), AI_PROVIDER(backup));
+	ai_hedged_provider_set_delay_bounds(hedged, 30, 1);
+
+	g_timeout_add(50, on_cancel_timeout, cancellable);
+	run_chat(hedged, cancellable, &data);
+
+	g_assert_error(data.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_assert_null(data.response);
+
+	drain(primary);
+	drain(backup);
+	g_assert_cmpuint(primary->n_cancelled, ==, 1);
+	g_assert_cmpuint(backup->n_cancelled, ==, 1);
+
+	chat_data_clear(&data);
+}
+
+static void
+test_hedged_adaptive_delay(void)
+{
+	g_autoptr(TestProvider) primary = test_provider_new("primary", 5);
+	g_autoptr(AiHedgedProvider) hedged = NULL;
+	ChatData data;
+	guint delay;
+	guint i;
+
+	hedged = ai_hedged_provider_new(AI_PROVIDER(primary), NULL);
+	ai_hedged_provider_set_delay_bounds(hedged, 1000, 1);
+
+	for (i = 0; i < 16; i++)
+	{
+		g_assert_cmpuint(ai_hedged_provider_get_hedge_delay(hedged), ==, 1000);
+		run_chat(hedged, NULL, &data);
+		g_assert_no_error(data.error);
+		chat_data_clear(&data);
+	}
+
+	/* Sixteen fast answers bring the delay down to their tail */
+	delay = ai_hedged_provider_get_hedge_delay(hedged);
+	g_assert_cmpuint(delay, >=, 5);
+	g_assert_cmpuint(delay, <, 1000);
+
+	/* The lower bound still applies */
+	ai_hedged_provider_set_delay_bounds(hedged, 1000, 2000);
+	g_assert_cmpuint(ai_hedged_provider_get_hedge_delay(hedged), ==, 2000);
+}
+
+static void
+test_hedged_slow_tail(void)
+{
+	g_autoptr(TestProvider) primary = test_provider_new("primary", 200);
+	g_autoptr(TestProvider) backup = test_provider_new("backup", 5);
+	g_autoptr(AiHedgedProvider) hedged = NULL;
+	ChatData data;
+	guint delay;
+	guint i;
+
+	hedged = ai_hedged_provider_new(AI_PROVIDER(primary), AI_PROVIDER(backup));
+	ai_hedged_provider_set_delay_bounds(hedged, 50, 1);
+
+	for (i = 0; i < 16; i++)
+	{
+		run_chat(hedged, NULL, &data);
+		g_assert_no_error(data.error);
+		g_assert_cmpstr(ai_response_get_id(data.response), ==, "backup");
+		chat_data_clear(&data);
+	}
+
+	/*
+	 * Every answer came from a hedge. Timed from the primary, they keep
+	 * the delay where it was instead of pulling it down to the backup's
+	 * latency, which would hedge ever more requests.
+	 */
+	delay = ai_hedged_provider_get_hedge_delay(hedged);
+	g_assert_cmpuint(delay, >=, 50);
+	g_assert_cmpuint(delay, <, 200);
+
+	drain(primary);
+}
+
+static void
+test_hedged_options(void)
+{
+	g_autoptr(TestProvider) primary = test_provider_new("primary", 300);
+	g_autoptr(TestProvider) backup = test_provider_new("backup", 10);
+	g_autoptr(AiHedgedProvider) hedged = NULL;
+	g_autoptr(AiRequestOptions) options = ai_request_options_new();
+	g_autoptr(AiMessage) msg = ai_message_new_user("Hello");
+	GList messages = { NULL, NULL, NULL };
+	ChatData data = { NULL, NULL, NULL };
+
+	hedged = ai_hedged_provider_new(AI_PROVIDER(primary), AI_PROVIDER(backup));
+	ai_hedged_provider_set_delay_bounds(hedged, 30, 1);
+
+	/* The per-request model reaches both the primary and the hedge */
+	ai_request_options_set_model(options, "test-model");
+	messages.data = msg;
+	data.loop = g_main_loop_new(NULL, FALSE);
+
+	ai_provider_chat_with_options_async(AI_PROVIDER(hedged), &messages, options,
+	                                    NULL, on_chat_done, &data);
+	g_main_loop_run(data.loop);
+	g_main_loop_unref(data.loop);
+
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "backup");
+	g_assert_cmpstr(primary->model, ==, "test-model");
+	g_assert_cmpstr(backup->model, ==, "test-model");
+
+	drain(primary);
+	chat_data_clear(&data);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/hedged-provider/new", test_hedged_new);
+	g_test_add_func("/ai-glib/hedged-provider/fast-primary", test_hedged_fast_primary);
+	g_test_add_func("/ai-glib/hedged-provider/slow-primary", test_hedged_slow_primary);
+	g_test_add_func("/ai-glib/hedged-provider/primary-fails", test_hedged_primary_fails);
+	g_test_add_func("/ai-glib/hedged-provider/cancel", test_hedged_cancel);
+	g_test_add_func("/ai-glib/hedged-provider/adaptive-delay", test_hedged_adaptive_delay);
+	g_test_add_func("/ai-glib/hedged-provider/slow-tail", test_hedged_slow_tail);
+	g_test_add_func("/ai-glib/hedged-provider/options", test_hedged_options);
+
+	return g_test_run();
+}
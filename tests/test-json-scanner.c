@@ -0,0 +1,207 @@
+/*
+ * test-json-scanner.c - Unit tests for the JSON pull scanner
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <glib.h>
+#include <string.h>
+
+#include "core/ai-json-scanner.h"
+
+/*
+ * Scan {"delta":{"type":...,"text":...}} the way the streaming clients
+ * do, skipping every other member. Returns the text, or NULL if the
+ * scan failed.
+ */
+static gchar *
+scan_text_delta(const gchar *json)
+{
+	AiJsonScanner scanner;
+	g_autoptr(GString) text = g_string_new("");
+	const gchar *name;
+	gsize name_len;
+	const gchar *type = NULL;
+	gsize type_len = 0;
+
+	ai_json_scanner_init(&scanner, json, -1);
+	ai_json_scanner_enter_object(&scanner);
+
+	while (ai_json_scanner_next_member(&scanner, &name, &name_len))
+	{
+		if (!AI_JSON_SLICE_IS(name, name_len, "delta"))
+		{
+			ai_json_scanner_skip_value(&scanner);
+			continue;
+		}
+
+		ai_json_scanner_enter_object(&scanner);
+		while (ai_json_scanner_next_member(&scanner, &name, &name_len))
+		{
+			if (AI_JSON_SLICE_IS(name, name_len, "type"))
+			{
+				ai_json_scanner_read_plain_string(&scanner, &type, &type_len);
+			}
+			else if (AI_JSON_SLICE_IS(name, name_len, "text"))
+			{
+				ai_json_scanner_read_string(&scanner, text);
+			}
+			else
+			{
+				ai_json_scanner_skip_value(&scanner);
+			}
+		}
+	}
+
+	if (!ai_json_scanner_at_end(&scanner))
+	{
+		return NULL;
+	}
+
+	g_assert_true(AI_JSON_SLICE_IS(type, type_len, "text_delta"));
+
+	return g_string_free(g_steal_pointer(&text), FALSE);
+}
+
+static void
+test_json_scanner_delta(void)
+{
+	g_autofree gchar *text = NULL;
+
+	text = scan_text_delta("{\"type\":\"content_block_delta\",\"index\":0,"
+	                       "\"delta\":{\"type\":\"text_delta\",\"text\":\"Hello\"}}");
+	g_assert_cmpstr(text, ==, "Hello");
+}
+
+static void
+test_json_scanner_escapes(void)
+{
+	g_autofree gchar *text = NULL;
+	g_autofree gchar *raw = NULL;
+
+	text = scan_text_delta("{\"delta\":{\"type\":\"text_delta\","
+	                       "\"text\":\"a\\\"b\\\\c\\/d\\b\\f\\n\\r\\t\\u00e9\\u20AC\"}}");
+	g_assert_cmpstr(text, ==, "a\"b\\c/d\b\f\n\r\t\xc3\xa9\xe2\x82\xac");
+
+	/* UTF-8 passes through and a surrogate pair is one character */
+	raw = scan_text_delta("{\"delta\":{\"type\":\"text_delta\","
+	                      "\"text\":\"\xc3\xa9 \\ud83d\\ude00\"}}");
+	g_assert_cmpstr(raw, ==, "\xc3\xa9 \xf0\x9f\x98\x80");
+}
+
+static void
+test_json_scanner_skip(void)
+{
+	g_autofree gchar *text = NULL;
+
+	/* Members of every type around the one that is read */
+	text = scan_text_delta(" {\n\t\"id\" : \"msg_1\", \"n\": -12.5e+3, \"ok\": true,"
+	                       " \"none\": null, \"list\": [1, {\"x\": \"]}\"}, []],"
+	                       " \"delta\" : { \"text\" : \"x\", \"type\" : \"text_delta\" },"
+	                       " \"after\": {\"deep\": [[{}]]} } ");
+	g_assert_cmpstr(text, ==, "x");
+}
+
+static void
+test_json_scanner_invalid(void)
+{
+	static const gchar *invalid[] = {
+		"",
+		"[]",
+		"{\"delta\":{\"type\":\"text_delta\",\"text\":\"a\"}",
+		"{\"delta\":{\"type\":\"text_delta\",\"text\":\"a\"},}",
+		"{,\"delta\":{}}",
+		"{\"delta\":{}} x",
+		"{\"d\\u0065lta\":{}}",
+		"{\"delta\":{\"type\":\"text_\\u0064elta\"}}",
+		"{\"delta\":{\"text\":\"lone \\ud83d\"}}",
+		"{\"delta\":{\"text\":\"lone \\ude00\"}}",
+		"{\"delta\":{\"text\":\"nul \\u0000\"}}",
+		"{\"delta\":{\"text\":\"bad \\x\"}}",
+		"{\"delta\":{\"text\":\"raw \x01\"}}",
+		"{\"delta\":{\"text\":\"bad \xff\"}}",
+		"{\"delta\":{\"text\":\"open}}",
+		"{\"x\":nul}",
+		"{\"x\":}",
+		"{\"x\":[1,2}",
+	};
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(invalid); i++)
+	{
+		g_autofree gchar *text = scan_text_delta(invalid[i]);
+
+		g_assert_null(text);
+	}
+}
+
+static void
+test_json_scanner_values(void)
+{
+	AiJsonScanner scanner;
+	const gchar *name;
+	gsize name_len;
+	gboolean value = FALSE;
+	guint n_elements = 0;
+
+	ai_json_scanner_init(&scanner, "{\"done\":true,\"usage\":null,\"choices\":[{},{}]}", -1);
+	g_assert_true(ai_json_scanner_enter_object(&scanner));
+
+	g_assert_true(ai_json_scanner_next_member(&scanner, &name, &name_len));
+	g_assert_true(AI_JSON_SLICE_IS(name, name_len, "done"));
+	g_assert_false(ai_json_scanner_read_null(&scanner));
+	g_assert_true(ai_json_scanner_read_boolean(&scanner, &value));
+	g_assert_true(value);
+
+	g_assert_true(ai_json_scanner_next_member(&scanner, &name, &name_len));
+	g_assert_true(ai_json_scanner_read_null(&scanner));
+
+	g_assert_true(ai_json_scanner_next_member(&scanner, &name, &name_len));
+	g_assert_true(ai_json_scanner_enter_array(&scanner));
+	while (ai_json_scanner_next_element(&scanner))
+	{
+		g_assert_true(ai_json_scanner_enter_object(&scanner));
+		g_assert_false(ai_json_scanner_next_member(&scanner, &name, &name_len));
+		n_elements++;
+	}
+	g_assert_cmpuint(n_elements, ==, 2);
+
+	g_assert_false(ai_json_scanner_next_member(&scanner, &name, &name_len));
+	g_assert_true(ai_json_scanner_at_end(&scanner));
+}
+
+static void
+test_json_scanner_sticky(void)
+{
+	AiJsonScanner scanner;
+	const gchar *name;
+	gsize name_len;
+	gboolean value;
+
+	/* After a failure, reads that would otherwise succeed fail too */
+	ai_json_scanner_init(&scanner, "{\"a\":1,\"b\":true}", -1);
+	g_assert_true(ai_json_scanner_enter_object(&scanner));
+	g_assert_true(ai_json_scanner_next_member(&scanner, &name, &name_len));
+	g_assert_false(ai_json_scanner_read_boolean(&scanner, &value));
+	g_assert_false(ai_json_scanner_skip_value(&scanner));
+	g_assert_false(ai_json_scanner_next_member(&scanner, &name, &name_len));
+	g_assert_false(ai_json_scanner_at_end(&scanner));
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/json-scanner/delta", test_json_scanner_delta);
+	g_test_add_func("/ai-glib/json-scanner/escapes", test_json_scanner_escapes);
+	g_test_add_func("/ai-glib/json-scanner/skip", test_json_scanner_skip);
+	g_test_add_func("/ai-glib/json-scanner/invalid", test_json_scanner_invalid);
+	g_test_add_func("/ai-glib/json-scanner/values", test_json_scanner_values);
+	g_test_add_func("/ai-glib/json-scanner/sticky", test_json_scanner_sticky);
+
+	return g_test_run();
+}
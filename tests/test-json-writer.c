@@ -0,0 +1,187 @@
+/*
+ * test-json-writer.c - Unit tests for the direct JSON writer
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <json-glib/json-glib.h>
+
+#include "core/ai-json-writer.h"
+#include "model/ai-message.h"
+#include "model/ai-text-content.h"
+#include "model/ai-tool-use.h"
+#include "model/ai-tool-result.h"
+
+/*
+ * Parse the writer output; fails the test if it is not valid JSON.
+ */
+static JsonNode *
+parse_bytes(GBytes *bytes)
+{
+	g_autoptr(JsonParser) parser = json_parser_new();
+	g_autoptr(GError) error = NULL;
+	const gchar *data;
+	gsize len;
+
+	data = g_bytes_get_data(bytes, &len);
+	json_parser_load_from_data(parser, data, len, &error);
+	g_assert_no_error(error);
+
+	return json_node_copy(json_parser_get_root(parser));
+}
+
+static void
+test_json_writer_structure(void)
+{
+	g_autoptr(AiJsonWriter) writer = NULL;
+	g_autoptr(GBytes) bytes = NULL;
+	const gchar *data;
+
+	writer = ai_json_writer_new(0);
+	ai_json_writer_begin_object(writer);
+	ai_json_writer_set_member_name(writer, "a");
+	ai_json_writer_add_int_value(writer, 1);
+	ai_json_writer_set_member_name(writer, "b");
+	ai_json_writer_begin_array(writer);
+	ai_json_writer_add_boolean_value(writer, TRUE);
+	ai_json_writer_add_null_value(writer);
+	ai_json_writer_begin_object(writer);
+	ai_json_writer_end_object(writer);
+	ai_json_writer_add_string_value(writer, "x");
+	ai_json_writer_end_array(writer);
+	ai_json_writer_set_member_name(writer, "c");
+	ai_json_writer_add_raw_value(writer, "{\"raw\":[1,2]}", -1);
+	ai_json_writer_end_object(writer);
+
+	bytes = ai_json_writer_free_to_bytes(g_steal_pointer(&writer));
+	data = g_bytes_get_data(bytes, NULL);
+
+	g_assert_cmpstr(data, ==,
+	                "{\"a\":1,\"b\":[true,null,{},\"x\"],\"c\":{\"raw\":[1,2]}}");
+}
+
+static void
+test_json_writer_escape(void)
+{
+	g_autoptr(GString) out = g_string_new(NULL);
+	const gchar *input = "a\"b\\c\nd\te\001f/g\xc3\xa9";
+
+	ai_json_escape_string(out, input, strlen(input));
+	g_assert_cmpstr(out->str, ==,
+	                "\"a\\\"b\\\\c\\nd\\te\\u0001f/g\xc3\xa9\"");
+}
+
+static void
+test_json_writer_escape_long(void)
+{
+	g_autoptr(GString) text = g_string_new(NULL);
+	g_autoptr(AiJsonWriter) writer = NULL;
+	g_autoptr(GBytes) bytes = NULL;
+	g_autoptr(JsonNode) root = NULL;
+	guint i;
+
+	/* Escapes at every offset within a word, and a clean tail */
+	for (i = 0; i < 4096; i++)
+	{
+		switch (i % 37)
+		{
+			case 3:  g_string_append_c(text, '"');  break;
+			case 11: g_string_append_c(text, '\\'); break;
+			case 20: g_string_append_c(text, '\n'); break;
+			case 29: g_string_append_c(text, '\x1f'); break;
+			default: g_string_append_c(text, 'a' + (i % 26)); break;
+		}
+	}
+	g_string_append(text, "tail without escapes");
+
+	writer = ai_json_writer_new(0);
+	ai_json_writer_add_string_value_len(writer, text->str, text->len);
+	bytes = ai_json_writer_free_to_bytes(g_steal_pointer(&writer));
+
+	root = parse_bytes(bytes);
+	g_assert_cmpstr(json_node_get_string(root), ==, text->str);
+}
+
+static void
+test_json_writer_node(void)
+{
+	g_autoptr(JsonParser) parser = json_parser_new();
+	g_autoptr(AiJsonWriter) writer = NULL;
+	g_autoptr(GBytes) bytes = NULL;
+	g_autoptr(JsonNode) root = NULL;
+	g_autoptr(GError) error = NULL;
+	const gchar *json = "{\"s\":\"v\\u00e9\",\"n\":-42,\"d\":0.5,"
+	                    "\"l\":[true,false,null],\"o\":{\"k\":{}}}";
+
+	json_parser_load_from_data(parser, json, -1, &error);
+	g_assert_no_error(error);
+
+	writer = ai_json_writer_new(0);
+	ai_json_writer_add_node(writer, json_parser_get_root(parser));
+	bytes = ai_json_writer_free_to_bytes(g_steal_pointer(&writer));
+
+	root = parse_bytes(bytes);
+	g_assert_true(json_node_equal(root, json_parser_get_root(parser)));
+}
+
+/*
+ * ai_message_write_json() must produce the same JSON as ai_message_to_json().
+ */
+static void
+assert_message_matches(AiMessage *msg)
+{
+	g_autoptr(AiJsonWriter) writer = NULL;
+	g_autoptr(GBytes) bytes = NULL;
+	g_autoptr(JsonNode) written = NULL;
+	g_autoptr(JsonNode) expected = NULL;
+
+	writer = ai_json_writer_new(0);
+	ai_message_write_json(msg, writer);
+	bytes = ai_json_writer_free_to_bytes(g_steal_pointer(&writer));
+
+	written = parse_bytes(bytes);
+	expected = ai_message_to_json(msg);
+
+	g_assert_true(json_node_equal(written, expected));
+}
+
+static void
+test_json_writer_message(void)
+{
+	g_autoptr(AiMessage) text = NULL;
+	g_autoptr(AiMessage) assistant = NULL;
+	g_autoptr(AiMessage) result = NULL;
+	g_autoptr(AiToolUse) tool_use = NULL;
+
+	text = ai_message_new_user("Hello \"world\"\n");
+	assert_message_matches(text);
+
+	assistant = ai_message_new(AI_ROLE_ASSISTANT);
+	ai_message_add_text(assistant, "Let me look.");
+	tool_use = ai_tool_use_new_from_json_string("toolu_1", "read_file",
+	                                            "{\"path\":\"/tmp/a b\",\"depth\":2}");
+	ai_message_add_content_block(assistant, AI_CONTENT_BLOCK(g_steal_pointer(&tool_use)));
+	assert_message_matches(assistant);
+
+	result = ai_message_new_tool_result("toolu_1", "line 1\nline \"2\"\t\\", TRUE);
+	assert_message_matches(result);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/json-writer/structure", test_json_writer_structure);
+	g_test_add_func("/ai-glib/json-writer/escape", test_json_writer_escape);
+	g_test_add_func("/ai-glib/json-writer/escape-long", test_json_writer_escape_long);
+	g_test_add_func("/ai-glib/json-writer/node", test_json_writer_node);
+	g_test_add_func("/ai-glib/json-writer/message", test_json_writer_message);
+
+	return g_test_run();
+}
@@ -10,6 +10,7 @@
 #include "model/ai-message.h"
 #include "model/ai-text-content.h"
 #include "core/ai-enums.h"
+#include "core/ai-json-writer.h"
 
 static void
 test_message_new_user(void)
@@ -96,6 +97,55 @@ test_message_to_json(void)
 	g_assert_cmpstr(json_object_get_string_member(obj, "role"), ==, "user");
 }
 
+/*
+ * Serialize with ai_message_write_json() and return the JSON text.
+ */
+static gchar *
+write_message(AiMessage *msg)
+{
+	g_autoptr(AiJsonWriter) writer = NULL;
+
+	writer = ai_json_writer_new(0);
+	ai_message_write_json(msg, writer);
+
+	return g_strdup(ai_json_writer_get_data(writer, NULL));
+}
+
+static void
+test_message_write_json_cache(void)
+{
+	g_autoptr(AiMessage) msg = NULL;
+	g_autofree gchar *first = NULL;
+	g_autofree gchar *second = NULL;
+	g_autofree gchar *added = NULL;
+	g_autofree gchar *changed = NULL;
+	AiTextContent *text;
+
+	msg = ai_message_new_user("Hello");
+	first = write_message(msg);
+	second = write_message(msg);
+
+	g_assert_cmpstr(first, ==, "{\"role\":\"user\",\"content\":\"Hello\"}");
+	g_assert_cmpstr(second, ==, first);
+
+	/* Adding a block invalidates the cached fragment */
+	ai_message_add_text(msg, "World");
+	added = write_message(msg);
+	g_assert_cmpstr(added, ==,
+	                "{\"role\":\"user\",\"content\":["
+	                "{\"type\":\"text\",\"text\":\"Hello\"},"
+	                "{\"type\":\"text\",\"text\":\"World\"}]}");
+
+	/* So does changing a block in place */
+	text = AI_TEXT_CONTENT(ai_message_get_content_blocks(msg)->data);
+	ai_text_content_set_text(text, "Hi");
+	changed = write_message(msg);
+	g_assert_cmpstr(changed, ==,
+	                "{\"role\":\"user\",\"content\":["
+	                "{\"type\":\"text\",\"text\":\"Hi\"},"
+	                "{\"type\":\"text\",\"text\":\"World\"}]}");
+}
+
 static void
 test_message_gtype(void)
 {
@@ -119,6 +169,7 @@ main(
 	g_test_add_func("/ai-glib/message/content-blocks", test_message_content_blocks);
 	g_test_add_func("/ai-glib/message/get-text", test_message_get_text);
 	g_test_add_func("/ai-glib/message/to-json", test_message_to_json);
+	g_test_add_func("/ai-glib/message/write-json-cache", test_message_write_json_cache);
 	g_test_add_func("/ai-glib/message/gtype", test_message_gtype);
 
 	return g_test_run();
@@ -0,0 +1,267 @@
+/*
+ * test-rate-limiter.c - Unit tests for the client-side rate limiter
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <glib.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "core/ai-enums.h"
+#include "core/ai-retry.h"
+#include "core/ai-rate-limiter.h"
+
+/* 10000 tokens per second, so short waits stay in the milliseconds */
+#define TEST_TOKENS_PER_MINUTE 600000
+
+typedef struct
+{
+	GMainLoop *loop;
+	GString   *order;
+	guint      pending;
+	GError    *error;
+} AcquireData;
+
+static void
+on_acquired(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	AcquireData *data = user_data;
+	GError *error = NULL;
+
+	if (ai_rate_limiter_acquire_finish(AI_RATE_LIMITER(source), result, &error))
+	{
+		g_string_append_c(data->order, 'x');
+	}
+	else if (data->error == NULL)
+	{
+		data->error = error;
+	}
+	else
+	{
+		g_error_free(error);
+	}
+
+	if (--data->pending == 0)
+	{
+		g_main_loop_quit(data->loop);
+	}
+}
+
+static void
+on_acquired_first(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	AcquireData *data = user_data;
+
+	g_string_append_c(data->order, '1');
+	on_acquired(source, result, user_data);
+}
+
+static void
+on_acquired_second(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	AcquireData *data = user_data;
+
+	g_string_append_c(data->order, '2');
+	on_acquired(source, result, user_data);
+}
+
+static void
+test_rate_limiter_unlimited(void)
+{
+	g_autoptr(AiRateLimiter) limiter = ai_rate_limiter_new();
+	g_autoptr(GError) error = NULL;
+
+	g_assert_cmpuint(ai_rate_limiter_get_wait_time(limiter, 1000000, 1000000), ==, 0);
+	g_assert_true(ai_rate_limiter_acquire(limiter, 1000000, 1000000, NULL, &error));
+	g_assert_no_error(error);
+	g_assert_cmpuint(ai_rate_limiter_get_wait_time(limiter, 1000000, 1000000), ==, 0);
+}
+
+static void
+test_rate_limiter_tokens(void)
+{
+	g_autoptr(AiRateLimiter) limiter = ai_rate_limiter_new();
+	g_autoptr(GError) error = NULL;
+	guint wait;
+
+	ai_rate_limiter_set_limits(limiter, 0, TEST_TOKENS_PER_MINUTE, 0);
+	g_assert_cmpuint(ai_rate_limiter_get_wait_time(limiter, 1000, 0), ==, 0);
+
+	/* Drain the bucket; the next 1000 tokens need about 100ms */
+	g_assert_true(ai_rate_limiter_acquire(limiter, TEST_TOKENS_PER_MINUTE, 0, NULL, &error));
+	wait = ai_rate_limiter_get_wait_time(limiter, 1000, 0);
+	g_assert_cmpuint(wait, >, 0);
+	g_assert_cmpuint(wait, <=, 101);
+
+	/* Output tokens are not limited */
+	g_assert_cmpuint(ai_rate_limiter_get_wait_time(limiter, 0, 1000000), ==, 0);
+
+	/* Blocking acquire waits for the refill */
+	g_assert_true(ai_rate_limiter_acquire(limiter, 1000, 0, NULL, &error));
+	g_assert_no_error(error);
+}
+
+static void
+test_rate_limiter_oversized(void)
+{
+	g_autoptr(AiRateLimiter) limiter = ai_rate_limiter_new();
+	g_autoptr(GError) error = NULL;
+
+	/* A request larger than the bucket is clamped, not refused */
+	ai_rate_limiter_set_limits(limiter, 0, TEST_TOKENS_PER_MINUTE, 0);
+	g_assert_cmpuint(ai_rate_limiter_get_wait_time(limiter, TEST_TOKENS_PER_MINUTE * 4, 0), ==, 0);
+	g_assert_true(ai_rate_limiter_acquire(limiter, TEST_TOKENS_PER_MINUTE * 4, 0, NULL, &error));
+	g_assert_no_error(error);
+}
+
+static void
+test_rate_limiter_fifo(void)
+{
+	g_autoptr(AiRateLimiter) limiter = ai_rate_limiter_new();
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+	g_autoptr(GString) order = g_string_new(NULL);
+	AcquireData data = { loop, order, 2, NULL };
+
+	ai_rate_limiter_set_limits(limiter, 0, TEST_TOKENS_PER_MINUTE, 0);
+	g_assert_true(ai_rate_limiter_acquire(limiter, TEST_TOKENS_PER_MINUTE, 0, NULL, NULL));
+
+	/* The large request is first in line, so the small one waits behind it */
+	ai_rate_limiter_acquire_async(limiter, 1000, 0, NULL, on_acquired_first, &data);
+	ai_rate_limiter_acquire_async(limiter, 10, 0, NULL, on_acquired_second, &data);
+	g_assert_cmpuint(ai_rate_limiter_get_queue_length(limiter), ==, 2);
+
+	g_main_loop_run(loop);
+
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(order->str, ==, "1x2x");
+	g_assert_cmpuint(ai_rate_limiter_get_queue_length(limiter), ==, 0);
+}
+
+static gboolean
+cancel_later(gpointer user_data)
+{
+	g_cancellable_cancel(G_CANCELLABLE(user_data));
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+test_rate_limiter_cancel(void)
+{
+	g_autoptr(AiRateLimiter) limiter = ai_rate_limiter_new();
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+	g_autoptr(GString) order = g_string_new(NULL);
+	g_autoptr(GCancellable) cancellable = g_cancellable_new();
+	AcquireData data = { loop, order, 1, NULL };
+
+	/* One request per minute: the second would wait a full minute */
+	ai_rate_limiter_set_limits(limiter, 1, 0, 0);
+	g_assert_true(ai_rate_limiter_acquire(limiter, 0, 0, NULL, NULL));
+
+	ai_rate_limiter_acquire_async(limiter, 0, 0, cancellable, on_acquired, &data);
+	g_assert_cmpuint(ai_rate_limiter_get_queue_length(limiter), ==, 1);
+
+	g_idle_add(cancel_later, cancellable);
+	g_main_loop_run(loop);
+
+	g_assert_error(data.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+	g_clear_error(&data.error);
+	g_assert_cmpstr(order->str, ==, "");
+	g_assert_cmpuint(ai_rate_limiter_get_queue_length(limiter), ==, 0);
+}
+
+static void
+test_rate_limiter_headers(void)
+{
+	g_autoptr(AiRateLimiter) limiter = ai_rate_limiter_new();
+	SoupMessageHeaders *headers;
+	guint wait;
+
+	headers = soup_message_headers_new(SOUP_MESSAGE_HEADERS_RESPONSE);
+
+	/* Limits learned from the server apply without any configuration */
+	soup_message_headers_append(headers, "anthropic-ratelimit-requests-limit", "50");
+	soup_message_headers_append(headers, "anthropic-ratelimit-requests-remaining", "49");
+	ai_rate_limiter_update_from_headers(limiter, headers);
+	g_assert_cmpuint(ai_rate_limiter_get_wait_time(limiter, 0, 0), ==, 0);
+
+	/* An exhausted limit blocks until the reset time */
+	soup_message_headers_clear(headers);
+	soup_message_headers_append(headers, "x-ratelimit-limit-tokens", "30000");
+	soup_message_headers_append(headers, "x-ratelimit-remaining-tokens", "0");
+	soup_message_headers_append(headers, "x-ratelimit-reset-tokens", "20s");
+	ai_rate_limiter_update_from_headers(limiter, headers);
+
+	wait = ai_rate_limiter_get_wait_time(limiter, 1, 0);
+	g_assert_cmpuint(wait, >, 19000);
+	g_assert_cmpuint(wait, <=, 20000);
+
+	soup_message_headers_unref(headers);
+}
+
+static void
+test_rate_limiter_shared(void)
+{
+	g_autoptr(AiRateLimiter) a = NULL;
+	g_autoptr(AiRateLimiter) b = NULL;
+	g_autoptr(AiRateLimiter) other_key = NULL;
+	g_autoptr(AiRateLimiter) other_provider = NULL;
+
+	a = ai_rate_limiter_get_shared(AI_PROVIDER_CLAUDE, "sk-test-1");
+	b = ai_rate_limiter_get_shared(AI_PROVIDER_CLAUDE, "sk-test-1");
+	other_key = ai_rate_limiter_get_shared(AI_PROVIDER_CLAUDE, "sk-test-2");
+	other_provider = ai_rate_limiter_get_shared(AI_PROVIDER_OPENAI, "sk-test-1");
+
+	g_assert_nonnull(a);
+	g_assert_true(a == b);
+	g_assert_true(a != other_key);
+	g_assert_true(a != other_provider);
+}
+
+static void
+test_rate_limiter_parse_reset(void)
+{
+	g_autoptr(GDateTime) now = g_date_time_new_now_utc();
+	g_autoptr(GDateTime) later = g_date_time_add_seconds(now, 30);
+	g_autofree gchar *iso = g_date_time_format_iso8601(later);
+	gint64 delay;
+
+	g_assert_cmpint(ai_retry_parse_reset("6m0s"), ==, 360000);
+	g_assert_cmpint(ai_retry_parse_reset("1.5"), ==, 1500);
+	g_assert_cmpint(ai_retry_parse_reset(NULL), ==, -1);
+	g_assert_cmpint(ai_retry_parse_reset("soon"), ==, -1);
+
+	delay = ai_retry_parse_reset(iso);
+	g_assert_cmpint(delay, >, 28000);
+	g_assert_cmpint(delay, <=, 30000);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/rate-limiter/unlimited", test_rate_limiter_unlimited);
+	g_test_add_func("/ai-glib/rate-limiter/tokens", test_rate_limiter_tokens);
+	g_test_add_func("/ai-glib/rate-limiter/oversized", test_rate_limiter_oversized);
+	g_test_add_func("/ai-glib/rate-limiter/fifo", test_rate_limiter_fifo);
+	g_test_add_func("/ai-glib/rate-limiter/cancel", test_rate_limiter_cancel);
+	g_test_add_func("/ai-glib/rate-limiter/headers", test_rate_limiter_headers);
+	g_test_add_func("/ai-glib/rate-limiter/shared", test_rate_limiter_shared);
+	g_test_add_func("/ai-glib/rate-limiter/parse-reset", test_rate_limiter_parse_reset);
+
+	return g_test_run();
+}
@@ -0,0 +1,188 @@
+/*
+ * test-request-options.c - Unit tests for AiRequestOptions
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <glib.h>
+
+#include "model/ai-request-options.h"
+
+static void
+test_request_options_new(void)
+{
+	g_autoptr(AiRequestOptions) options = NULL;
+
+	options = ai_request_options_new();
+	g_assert_nonnull(options);
+
+	/* Nothing is set */
+	g_assert_null(ai_request_options_get_model(options));
+	g_assert_false(ai_request_options_has_system_prompt(options));
+	g_assert_cmpint(ai_request_options_get_max_tokens(options), ==, 0);
+	g_assert_false(ai_request_options_has_temperature(options));
+	g_assert_cmpfloat(ai_request_options_get_temperature(options), ==, 1.0);
+	g_assert_null(ai_request_options_get_stop_sequences(options));
+	g_assert_null(ai_request_options_get_tools(options));
+	g_assert_cmpint(ai_request_options_get_deadline(options), ==, 0);
+}
+
+static void
+test_request_options_setters(void)
+{
+	g_autoptr(AiRequestOptions) options = NULL;
+
+	options = ai_request_options_new();
+
+	ai_request_options_set_model(options, "test-model");
+	g_assert_cmpstr(ai_request_options_get_model(options), ==, "test-model");
+
+	ai_request_options_set_max_tokens(options, 512);
+	g_assert_cmpint(ai_request_options_get_max_tokens(options), ==, 512);
+
+	ai_request_options_set_max_tokens(options, -1);
+	g_assert_cmpint(ai_request_options_get_max_tokens(options), ==, 0);
+
+	ai_request_options_set_temperature(options, 0.2);
+	g_assert_true(ai_request_options_has_temperature(options));
+	g_assert_cmpfloat(ai_request_options_get_temperature(options), ==, 0.2);
+
+	ai_request_options_set_deadline(options, 123456);
+	g_assert_cmpint(ai_request_options_get_deadline(options), ==, 123456);
+}
+
+static void
+test_request_options_system_prompt(void)
+{
+	g_autoptr(AiRequestOptions) options = NULL;
+
+	options = ai_request_options_new();
+
+	ai_request_options_set_system_prompt(options, "Be brief.");
+	g_assert_true(ai_request_options_has_system_prompt(options));
+	g_assert_cmpstr(ai_request_options_get_system_prompt(options), ==, "Be brief.");
+
+	/* NULL still counts as set: no system prompt for this request */
+	ai_request_options_set_system_prompt(options, NULL);
+	g_assert_true(ai_request_options_has_system_prompt(options));
+	g_assert_null(ai_request_options_get_system_prompt(options));
+}
+
+static void
+test_request_options_stop_sequences(void)
+{
+	g_autoptr(AiRequestOptions) options = NULL;
+	const gchar *stop[] = { "END", "\n\n", NULL };
+	const gchar *empty[] = { NULL };
+	const gchar * const *result;
+
+	options = ai_request_options_new();
+
+	ai_request_options_set_stop_sequences(options, stop);
+	result = ai_request_options_get_stop_sequences(options);
+	g_assert_nonnull(result);
+	g_assert_cmpstr(result[0], ==, "END");
+	g_assert_cmpstr(result[1], ==, "\n\n");
+	g_assert_null(result[2]);
+
+	ai_request_options_set_stop_sequences(options, empty);
+	g_assert_null(ai_request_options_get_stop_sequences(options));
+}
+
+static void
+test_request_options_tools(void)
+{
+	g_autoptr(AiRequestOptions) options = NULL;
+	g_autoptr(AiTool) tool = NULL;
+	GList *tools;
+
+	options = ai_request_options_new();
+	tool = ai_tool_new("get_weather", "Get the weather");
+
+	tools = g_list_append(NULL, tool);
+	ai_request_options_set_tools(options, tools);
+	g_list_free(tools);
+
+	g_assert_cmpuint(g_list_length(ai_request_options_get_tools(options)), ==, 1);
+	g_assert_true(ai_request_options_get_tools(options)->data == tool);
+
+	/* Setting the options' own list keeps the tools alive */
+	ai_request_options_set_tools(options, ai_request_options_get_tools(options));
+	g_assert_cmpuint(g_list_length(ai_request_options_get_tools(options)), ==, 1);
+	g_assert_cmpstr(ai_tool_get_name(ai_request_options_get_tools(options)->data),
+	                ==, "get_weather");
+
+	ai_request_options_set_tools(options, NULL);
+	g_assert_null(ai_request_options_get_tools(options));
+}
+
+static void
+test_request_options_copy(void)
+{
+	g_autoptr(AiRequestOptions) options = NULL;
+	g_autoptr(AiRequestOptions) copy = NULL;
+	g_autoptr(AiTool) tool = NULL;
+	const gchar *stop[] = { "END", NULL };
+	GList *tools;
+
+	options = ai_request_options_new();
+	tool = ai_tool_new("search", "Search the web");
+	tools = g_list_append(NULL, tool);
+
+	ai_request_options_set_model(options, "test-model");
+	ai_request_options_set_system_prompt(options, "Be brief.");
+	ai_request_options_set_max_tokens(options, 256);
+	ai_request_options_set_temperature(options, 0.5);
+	ai_request_options_set_stop_sequences(options, stop);
+	ai_request_options_set_tools(options, tools);
+	ai_request_options_set_deadline(options, 42);
+	g_list_free(tools);
+
+	copy = ai_request_options_copy(options);
+	g_assert_nonnull(copy);
+	g_assert_true(copy != options);
+
+	/* Changing the original leaves the copy alone */
+	ai_request_options_set_model(options, "other-model");
+	ai_request_options_set_stop_sequences(options, NULL);
+	ai_request_options_set_tools(options, NULL);
+
+	g_assert_cmpstr(ai_request_options_get_model(copy), ==, "test-model");
+	g_assert_true(ai_request_options_has_system_prompt(copy));
+	g_assert_cmpstr(ai_request_options_get_system_prompt(copy), ==, "Be brief.");
+	g_assert_cmpint(ai_request_options_get_max_tokens(copy), ==, 256);
+	g_assert_true(ai_request_options_has_temperature(copy));
+	g_assert_cmpfloat(ai_request_options_get_temperature(copy), ==, 0.5);
+	g_assert_cmpstr(ai_request_options_get_stop_sequences(copy)[0], ==, "END");
+	g_assert_cmpuint(g_list_length(ai_request_options_get_tools(copy)), ==, 1);
+	g_assert_cmpint(ai_request_options_get_deadline(copy), ==, 42);
+}
+
+static void
+test_request_options_gtype(void)
+{
+	GType type;
+
+	type = ai_request_options_get_type();
+	g_assert_true(G_TYPE_IS_BOXED(type));
+	g_assert_cmpstr(g_type_name(type), ==, "AiRequestOptions");
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/request-options/new", test_request_options_new);
+	g_test_add_func("/ai-glib/request-options/setters", test_request_options_setters);
+	g_test_add_func("/ai-glib/request-options/system-prompt", test_request_options_system_prompt);
+	g_test_add_func("/ai-glib/request-options/stop-sequences", test_request_options_stop_sequences);
+	g_test_add_func("/ai-glib/request-options/tools", test_request_options_tools);
+	g_test_add_func("/ai-glib/request-options/copy", test_request_options_copy);
+	g_test_add_func("/ai-glib/request-options/gtype", test_request_options_gtype);
+
+	return g_test_run();
+}
@@ -0,0 +1,464 @@
+/*
+ * test-response-cache.c - Unit tests for AiResponseCache
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "core/ai-config.h"
+#include "core/ai-provider.h"
+#include "core/ai-response-cache.h"
+#include "model/ai-message.h"
+#include "model/ai-response.h"
+#include "providers/ai-claude-client.h"
+
+static gchar *
+make_key(const gchar *body)
+{
+	g_autoptr(GBytes) bytes = g_bytes_new(body, strlen(body));
+
+	return ai_response_cache_compute_key("https://api.example.com/v1/messages", bytes);
+}
+
+static void
+store_string(
+	AiResponseCache *cache,
+	const gchar     *key,
+	const gchar     *value
+){
+	g_autoptr(GBytes) bytes = g_bytes_new(value, strlen(value));
+
+	ai_response_cache_store(cache, key, bytes);
+}
+
+static void
+assert_cached(
+	AiResponseCache *cache,
+	const gchar     *key,
+	const gchar     *expected
+){
+	g_autoptr(GBytes) bytes = ai_response_cache_lookup(cache, key);
+
+	if (expected == NULL)
+	{
+		g_assert_null(bytes);
+		return;
+	}
+
+	g_assert_nonnull(bytes);
+	g_assert_cmpmem(g_bytes_get_data(bytes, NULL), g_bytes_get_size(bytes),
+	                expected, strlen(expected));
+}
+
+static void
+test_response_cache_key(void)
+{
+	g_autoptr(GBytes) body = g_bytes_new_static("{}", 2);
+	g_autofree gchar *a = NULL;
+	g_autofree gchar *b = NULL;
+	g_autofree gchar *other_url = NULL;
+	g_autofree gchar *other_body = NULL;
+
+	a = make_key("{\"model\":\"m\"}");
+	b = make_key("{\"model\":\"m\"}");
+	other_body = make_key("{\"model\":\"n\"}");
+	other_url = ai_response_cache_compute_key("https://api.example.com/v2/messages", body);
+
+	g_assert_cmpuint(strlen(a), ==, 64);
+	g_assert_cmpstr(a, ==, b);
+	g_assert_cmpstr(a, !=, other_body);
+	g_assert_cmpstr(a, !=, other_url);
+}
+
+static void
+test_response_cache_memory(void)
+{
+	g_autoptr(AiResponseCache) cache = ai_response_cache_new();
+	g_autofree gchar *key = make_key("request");
+
+	g_assert_null(ai_response_cache_get_directory(cache));
+
+	assert_cached(cache, key, NULL);
+	store_string(cache, key, "response");
+	assert_cached(cache, key, "response");
+
+	g_assert_cmpuint(ai_response_cache_get_hits(cache), ==, 1);
+	g_assert_cmpuint(ai_response_cache_get_misses(cache), ==, 1);
+	g_assert_cmpuint(ai_response_cache_get_memory_size(cache), ==, 8);
+
+	ai_response_cache_clear(cache);
+	assert_cached(cache, key, NULL);
+	g_assert_cmpuint(ai_response_cache_get_memory_size(cache), ==, 0);
+}
+
+static void
+test_response_cache_lru(void)
+{
+	g_autoptr(AiResponseCache) cache = ai_response_cache_new();
+	g_autofree gchar *a = make_key("a");
+	g_autofree gchar *b = make_key("b");
+	g_autofree gchar *c = make_key("c");
+
+	ai_response_cache_set_max_memory_size(cache, 10);
+
+	store_string(cache, a, "aaaa");
+	store_string(cache, b, "bbbb");
+
+	/* Touching a makes b the least recently used */
+	assert_cached(cache, a, "aaaa");
+	store_string(cache, c, "cccc");
+
+	assert_cached(cache, a, "aaaa");
+	assert_cached(cache, b, NULL);
+	assert_cached(cache, c, "cccc");
+	g_assert_cmpuint(ai_response_cache_get_memory_size(cache), ==, 8);
+}
+
+static void
+test_response_cache_ttl(void)
+{
+	g_autoptr(AiResponseCache) cache = ai_response_cache_new();
+	g_autofree gchar *key = make_key("request");
+
+	ai_response_cache_set_ttl(cache, 1);
+	store_string(cache, key, "response");
+	assert_cached(cache, key, "response");
+
+	g_usleep(1100 * 1000);
+	assert_cached(cache, key, NULL);
+	g_assert_cmpuint(ai_response_cache_get_memory_size(cache), ==, 0);
+}
+
+static void
+remove_cache_dir(const gchar *dir)
+{
+	GDir *d = g_dir_open(dir, 0, NULL);
+	const gchar *name;
+
+	while (d != NULL && (name = g_dir_read_name(d)) != NULL)
+	{
+		g_autofree gchar *path = g_build_filename(dir, name, NULL);
+
+		if (g_remove(path) != 0)
+		{
+			g_rmdir(path);
+		}
+	}
+	g_clear_pointer(&d, g_dir_close);
+	g_rmdir(dir);
+}
+
+static void
+test_response_cache_disk(void)
+{
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *dir = NULL;
+	g_autofree gchar *a = make_key("a");
+	g_autofree gchar *b = make_key("b");
+	g_autofree gchar *index = NULL;
+	AiResponseCache *cache;
+	FILE *f;
+
+	dir = g_dir_make_tmp("ai-glib-cache-XXXXXX", &error);
+	g_assert_no_error(error);
+
+	cache = ai_response_cache_new_for_directory(dir, &error);
+	g_assert_no_error(error);
+	g_assert_cmpstr(ai_response_cache_get_directory(cache), ==, dir);
+
+	store_string(cache, a, "first");
+	store_string(cache, a, "second");
+	store_string(cache, b, "other");
+	g_object_unref(cache);
+
+	/* Simulate a crash in the middle of writing an index record */
+	index = g_build_filename(dir, "index", NULL);
+	f = g_fopen(index, "ab");
+	g_assert_nonnull(f);
+	fwrite("torn", 1, 4, f);
+	fclose(f);
+
+	/* A new process sees the latest value for each key */
+	cache = ai_response_cache_new_for_directory(dir, &error);
+	g_assert_no_error(error);
+	g_assert_cmpuint(ai_response_cache_get_memory_size(cache), ==, 0);
+	assert_cached(cache, a, "second");
+	assert_cached(cache, b, "other");
+	g_assert_cmpuint(ai_response_cache_get_memory_size(cache), ==, 11);
+
+	ai_response_cache_clear(cache);
+	assert_cached(cache, a, NULL);
+	g_object_unref(cache);
+
+	cache = ai_response_cache_new_for_directory(dir, &error);
+	g_assert_no_error(error);
+	assert_cached(cache, b, NULL);
+	g_object_unref(cache);
+
+	remove_cache_dir(dir);
+}
+
+static void
+test_response_cache_compaction(void)
+{
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *dir = NULL;
+	gchar *keys[6] = { NULL };
+	AiResponseCache *cache;
+	guint i;
+
+	dir = g_dir_make_tmp("ai-glib-cache-XXXXXX", &error);
+	g_assert_no_error(error);
+
+	cache = ai_response_cache_new_for_directory(dir, &error);
+	g_assert_no_error(error);
+
+	/* 100 bytes on disk: compaction keeps the newest 75 */
+	ai_response_cache_set_max_disk_size(cache, 100);
+	ai_response_cache_set_max_memory_size(cache, 0);
+
+	for (i = 0; i < G_N_ELEMENTS(keys); i++)
+	{
+		g_autofree gchar *name = g_strdup_printf("request-%u", i);
+
+		keys[i] = make_key(name);
+		store_string(cache, keys[i], "0123456789abcdefghij");
+	}
+	g_object_unref(cache);
+
+	cache = ai_response_cache_new_for_directory(dir, &error);
+	g_assert_no_error(error);
+
+	assert_cached(cache, keys[0], NULL);
+	assert_cached(cache, keys[2], NULL);
+	assert_cached(cache, keys[3], "0123456789abcdefghij");
+	assert_cached(cache, keys[5], "0123456789abcdefghij");
+	g_object_unref(cache);
+
+	for (i = 0; i < G_N_ELEMENTS(keys); i++)
+	{
+		g_free(keys[i]);
+	}
+
+	remove_cache_dir(dir);
+}
+
+static void
+test_response_cache_compaction_failure(void)
+{
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *dir = NULL;
+	g_autofree gchar *blocker = NULL;
+	g_autofree gchar *last = make_key("request-last");
+	gchar *keys[6] = { NULL };
+	AiResponseCache *cache;
+	guint i;
+
+	dir = g_dir_make_tmp("ai-glib-cache-XXXXXX", &error);
+	g_assert_no_error(error);
+
+	cache = ai_response_cache_new_for_directory(dir, &error);
+	g_assert_no_error(error);
+	ai_response_cache_set_max_disk_size(cache, 100);
+	ai_response_cache_set_max_memory_size(cache, 0);
+
+	/* A directory where the next blob file goes makes compaction fail */
+	blocker = g_build_filename(dir, "blobs.1", NULL);
+	g_assert_cmpint(g_mkdir(blocker, 0700), ==, 0);
+
+	for (i = 0; i < G_N_ELEMENTS(keys); i++)
+	{
+		g_autofree gchar *name = g_strdup_printf("request-%u", i);
+
+		keys[i] = make_key(name);
+		if (i == G_N_ELEMENTS(keys) - 1)
+		{
+			g_test_expect_message(NULL, G_LOG_LEVEL_WARNING, "Failed to compact*");
+		}
+		store_string(cache, keys[i], "0123456789abcdefghij");
+	}
+	g_test_assert_expected_messages();
+
+	/* The live files stay in use and keep every entry */
+	assert_cached(cache, keys[0], "0123456789abcdefghij");
+	assert_cached(cache, keys[5], "0123456789abcdefghij");
+	g_object_unref(cache);
+
+	cache = ai_response_cache_new_for_directory(dir, &error);
+	g_assert_no_error(error);
+	ai_response_cache_set_max_disk_size(cache, 100);
+	ai_response_cache_set_max_memory_size(cache, 0);
+	for (i = 0; i < G_N_ELEMENTS(keys); i++)
+	{
+		assert_cached(cache, keys[i], "0123456789abcdefghij");
+	}
+
+	/* Once the way is clear, the next store compacts */
+	g_assert_cmpint(g_rmdir(blocker), ==, 0);
+	store_string(cache, last, "0123456789abcdefghij");
+	g_object_unref(cache);
+
+	cache = ai_response_cache_new_for_directory(dir, &error);
+	g_assert_no_error(error);
+	assert_cached(cache, keys[0], NULL);
+	assert_cached(cache, keys[5], "0123456789abcdefghij");
+	assert_cached(cache, last, "0123456789abcdefghij");
+	g_object_unref(cache);
+
+	for (i = 0; i < G_N_ELEMENTS(keys); i++)
+	{
+		g_free(keys[i]);
+	}
+
+	remove_cache_dir(dir);
+}
+
+/*
+ * Local stand-in for the Claude messages endpoint, counting requests.
+ */
+typedef struct
+{
+	GMainLoop  *loop;
+	AiResponse *response;
+	GError     *error;
+	guint       n_requests;
+} ChatFixture;
+
+static const gchar *claude_reply =
+	"{\"id\":\"msg_1\",\"type\":\"message\",\"role\":\"assistant\",\"model\":\"claude-test\","
+	"\"content\":[{\"type\":\"text\",\"text\":\"Hello\"}],\"stop_reason\":\"end_turn\","
+	"\"usage\":{\"input_tokens\":3,\"output_tokens\":1}}";
+
+static void
+on_messages_request(
+	SoupServer        *server,
+	SoupServerMessage *msg,
+	const char        *path,
+	GHashTable        *query,
+	gpointer           user_data
+){
+	ChatFixture *fixture = user_data;
+
+	(void)server;
+	(void)query;
+
+	g_assert_cmpstr(path, ==, "/v1/messages");
+	fixture->n_requests++;
+
+	soup_server_message_set_status(msg, 200, NULL);
+	soup_server_message_set_response(msg, "application/json", SOUP_MEMORY_STATIC,
+	                                 claude_reply, strlen(claude_reply));
+}
+
+static void
+on_chat_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	ChatFixture *fixture = user_data;
+
+	fixture->response = ai_provider_chat_finish(AI_PROVIDER(source), result, &fixture->error);
+	g_main_loop_quit(fixture->loop);
+}
+
+static gchar *
+chat(
+	ChatFixture *fixture,
+	AiProvider  *provider,
+	const gchar *prompt
+){
+	g_autoptr(AiMessage) msg = ai_message_new_user(prompt);
+	GList messages = { NULL, NULL, NULL };
+	gchar *text;
+
+	messages.data = msg;
+	ai_provider_chat_async(provider, &messages, NULL, 64, NULL, NULL, on_chat_done, fixture);
+	g_main_loop_run(fixture->loop);
+
+	g_assert_no_error(fixture->error);
+	g_assert_nonnull(fixture->response);
+
+	text = ai_response_get_text(fixture->response);
+	g_clear_object(&fixture->response);
+
+	return text;
+}
+
+static void
+test_response_cache_client(void)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(SoupServer) server = NULL;
+	g_autoptr(AiConfig) config = NULL;
+	g_autoptr(AiClaudeClient) client = NULL;
+	g_autoptr(AiResponseCache) cache = NULL;
+	g_autofree gchar *base_url = NULL;
+	g_autofree gchar *first = NULL;
+	g_autofree gchar *second = NULL;
+	g_autofree gchar *other = NULL;
+	ChatFixture fixture = { NULL, NULL, NULL, 0 };
+	GSList *uris;
+
+	server = soup_server_new(NULL);
+	soup_server_add_handler(server, NULL, on_messages_request, &fixture, NULL);
+	g_assert_true(soup_server_listen_local(server, 0, SOUP_SERVER_LISTEN_IPV4_ONLY, &error));
+	g_assert_no_error(error);
+
+	uris = soup_server_get_uris(server);
+	base_url = g_strdup_printf("http://127.0.0.1:%d", g_uri_get_port(uris->data));
+	g_slist_free_full(uris, (GDestroyNotify)g_uri_unref);
+
+	config = ai_config_new();
+	ai_config_set_api_key(config, AI_PROVIDER_CLAUDE, "test-key");
+	ai_config_set_base_url(config, AI_PROVIDER_CLAUDE, base_url);
+
+	client = ai_claude_client_new_with_config(config);
+	cache = ai_response_cache_new();
+	ai_client_set_response_cache(AI_CLIENT(client), cache);
+	g_assert_true(ai_client_get_response_cache(AI_CLIENT(client)) == cache);
+
+	fixture.loop = g_main_loop_new(NULL, FALSE);
+
+	/* The repeat is answered from the cache and parsed the same way */
+	first = chat(&fixture, AI_PROVIDER(client), "Say hello");
+	second = chat(&fixture, AI_PROVIDER(client), "Say hello");
+	g_assert_cmpstr(first, ==, "Hello");
+	g_assert_cmpstr(second, ==, "Hello");
+	g_assert_cmpuint(fixture.n_requests, ==, 1);
+	g_assert_cmpuint(ai_response_cache_get_hits(cache), ==, 1);
+
+	/* A different request is a miss */
+	other = chat(&fixture, AI_PROVIDER(client), "Say goodbye");
+	g_assert_cmpstr(other, ==, "Hello");
+	g_assert_cmpuint(fixture.n_requests, ==, 2);
+	g_assert_cmpuint(ai_response_cache_get_misses(cache), ==, 2);
+
+	g_main_loop_unref(fixture.loop);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/response-cache/key", test_response_cache_key);
+	g_test_add_func("/ai-glib/response-cache/memory", test_response_cache_memory);
+	g_test_add_func("/ai-glib/response-cache/lru", test_response_cache_lru);
+	g_test_add_func("/ai-glib/response-cache/ttl", test_response_cache_ttl);
+	g_test_add_func("/ai-glib/response-cache/disk", test_response_cache_disk);
+	g_test_add_func("/ai-glib/response-cache/compaction", test_response_cache_compaction);
+	g_test_add_func("/ai-glib/response-cache/compaction-failure",
+	                test_response_cache_compaction_failure);
+	g_test_add_func("/ai-glib/response-cache/client", test_response_cache_client);
+
+	return g_test_run();
+}
@@ -0,0 +1,350 @@
+/*
+ * test-retry.c - Unit tests for the retry policy
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "core/ai-error.h"
+#include "core/ai-config.h"
+#include "core/ai-retry.h"
+#include "core/ai-client.h"
+
+static void
+test_retry_retryable_status(void)
+{
+	g_assert_true(ai_retry_is_retryable_status(408));
+	g_assert_true(ai_retry_is_retryable_status(429));
+	g_assert_true(ai_retry_is_retryable_status(500));
+	g_assert_true(ai_retry_is_retryable_status(502));
+	g_assert_true(ai_retry_is_retryable_status(503));
+	g_assert_true(ai_retry_is_retryable_status(529));
+
+	g_assert_false(ai_retry_is_retryable_status(200));
+	g_assert_false(ai_retry_is_retryable_status(400));
+	g_assert_false(ai_retry_is_retryable_status(401));
+	g_assert_false(ai_retry_is_retryable_status(404));
+	g_assert_false(ai_retry_is_retryable_status(501));
+	g_assert_false(ai_retry_is_retryable_status(505));
+}
+
+static void
+test_retry_retryable_error(void)
+{
+	g_autoptr(GError) reset = NULL;
+	g_autoptr(GError) cancelled = NULL;
+	g_autoptr(GError) timed_out = NULL;
+
+	reset = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_CONNECTION_CLOSED, "reset");
+	cancelled = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_CANCELLED, "cancelled");
+	timed_out = g_error_new_literal(G_IO_ERROR, G_IO_ERROR_TIMED_OUT, "timed out");
+
+	g_assert_true(ai_retry_is_retryable_error(reset, 0));
+	g_assert_false(ai_retry_is_retryable_error(reset, 200));
+	g_assert_false(ai_retry_is_retryable_error(cancelled, 0));
+	g_assert_false(ai_retry_is_retryable_error(timed_out, 0));
+	g_assert_false(ai_retry_is_retryable_error(NULL, 0));
+}
+
+static void
+test_retry_parse_duration(void)
+{
+	g_assert_cmpint(ai_retry_parse_duration("2"), ==, 2000);
+	g_assert_cmpint(ai_retry_parse_duration("1.5"), ==, 1500);
+	g_assert_cmpint(ai_retry_parse_duration("250ms"), ==, 250);
+	g_assert_cmpint(ai_retry_parse_duration("1m30s"), ==, 90000);
+	g_assert_cmpint(ai_retry_parse_duration("6m0s"), ==, 360000);
+	g_assert_cmpint(ai_retry_parse_duration("1h2m3.5s"), ==, 3723500);
+	g_assert_cmpint(ai_retry_parse_duration(" 3s "), ==, 3000);
+
+	g_assert_cmpint(ai_retry_parse_duration(NULL), ==, -1);
+	g_assert_cmpint(ai_retry_parse_duration(""), ==, -1);
+	g_assert_cmpint(ai_retry_parse_duration("soon"), ==, -1);
+	g_assert_cmpint(ai_retry_parse_duration("5x"), ==, -1);
+	g_assert_cmpint(ai_retry_parse_duration("-1"), ==, -1);
+}
+
+static void
+test_retry_server_delay(void)
+{
+	SoupMessageHeaders *headers;
+
+	headers = soup_message_headers_new(SOUP_MESSAGE_HEADERS_RESPONSE);
+	g_assert_cmpint(ai_retry_get_server_delay(headers), ==, -1);
+
+	/* Retry-After in seconds */
+	soup_message_headers_replace(headers, "Retry-After", "3");
+	g_assert_cmpint(ai_retry_get_server_delay(headers), ==, 3000);
+
+	/* retry-after-ms takes precedence */
+	soup_message_headers_replace(headers, "retry-after-ms", "120");
+	g_assert_cmpint(ai_retry_get_server_delay(headers), ==, 120);
+	soup_message_headers_unref(headers);
+
+	/* Reset headers only count once the limit is exhausted */
+	headers = soup_message_headers_new(SOUP_MESSAGE_HEADERS_RESPONSE);
+	soup_message_headers_replace(headers, "x-ratelimit-remaining-requests", "5");
+	soup_message_headers_replace(headers, "x-ratelimit-reset-requests", "1s");
+	g_assert_cmpint(ai_retry_get_server_delay(headers), ==, -1);
+
+	soup_message_headers_replace(headers, "x-ratelimit-remaining-requests", "0");
+	g_assert_cmpint(ai_retry_get_server_delay(headers), ==, 1000);
+
+	/* The longest exhausted reset wins */
+	soup_message_headers_replace(headers, "x-ratelimit-remaining-tokens", "0");
+	soup_message_headers_replace(headers, "x-ratelimit-reset-tokens", "6m0s");
+	g_assert_cmpint(ai_retry_get_server_delay(headers), ==, 360000);
+	soup_message_headers_unref(headers);
+}
+
+static void
+test_retry_anthropic_reset(void)
+{
+	SoupMessageHeaders *headers;
+	g_autoptr(GDateTime) now = NULL;
+	g_autoptr(GDateTime) reset = NULL;
+	g_autofree gchar *reset_str = NULL;
+	gint64 delay;
+
+	now = g_date_time_new_now_utc();
+	reset = g_date_time_add_seconds(now, 10);
+	reset_str = g_date_time_format_iso8601(reset);
+
+	headers = soup_message_headers_new(SOUP_MESSAGE_HEADERS_RESPONSE);
+	soup_message_headers_replace(headers, "anthropic-ratelimit-requests-remaining", "0");
+	soup_message_headers_replace(headers, "anthropic-ratelimit-requests-reset", reset_str);
+
+	delay = ai_retry_get_server_delay(headers);
+	g_assert_cmpint(delay, >, 8000);
+	g_assert_cmpint(delay, <=, 10000);
+
+	soup_message_headers_unref(headers);
+}
+
+static void
+test_retry_backoff(void)
+{
+	guint attempt;
+	guint i;
+
+	for (attempt = 0; attempt < 8; attempt++)
+	{
+		guint window = MIN(100u << attempt, 2000u);
+
+		for (i = 0; i < 50; i++)
+		{
+			g_assert_cmpuint(ai_retry_compute_backoff(attempt, 100, 2000), <=, window);
+		}
+	}
+
+	g_assert_cmpuint(ai_retry_compute_backoff(3, 0, 1000), ==, 0);
+
+	/* Large attempt counts must not overflow */
+	g_assert_cmpuint(ai_retry_compute_backoff(1000, 500, 60000), <=, 60000);
+	g_assert_cmpuint(ai_retry_get_delay(NULL, 0), <=, AI_RETRY_DEFAULT_BASE_DELAY_MS);
+}
+
+/*
+ * Local server that fails with 503 until a number of requests were made.
+ */
+typedef struct
+{
+	SoupServer *server;
+	GUri       *uri;
+	guint       failures;
+	guint       requests;
+	guint       retry_signals;
+	GMainLoop  *loop;
+	GBytes     *result;
+	GError     *error;
+} RetryFixture;
+
+static void
+on_server_request(
+	SoupServer        *server,
+	SoupServerMessage *msg,
+	const char        *path,
+	GHashTable        *query,
+	gpointer           user_data
+){
+	RetryFixture *fixture = user_data;
+	SoupMessageBody *request_body;
+	static const gchar *ok = "{\"ok\":true}";
+	static const gchar *busy = "{\"error\":{\"message\":\"Overloaded\"}}";
+
+	(void)server;
+	(void)path;
+	(void)query;
+
+	/* Every attempt must carry the request body */
+	request_body = soup_server_message_get_request_body(msg);
+	g_assert_cmpint(request_body->length, ==, 2);
+
+	fixture->requests++;
+
+	if (fixture->requests <= fixture->failures)
+	{
+		soup_message_headers_replace(soup_server_message_get_response_headers(msg),
+		                             "Retry-After", "0");
+		soup_server_message_set_status(msg, 503, NULL);
+		soup_server_message_set_response(msg, "application/json", SOUP_MEMORY_STATIC,
+		                                 busy, strlen(busy));
+		return;
+	}
+
+	soup_server_message_set_status(msg, 200, NULL);
+	soup_server_message_set_response(msg, "application/json", SOUP_MEMORY_STATIC,
+	                                 ok, strlen(ok));
+}
+
+static void
+fixture_setup(RetryFixture *fixture)
+{
+	g_autoptr(GError) error = NULL;
+	GSList *uris;
+
+	memset(fixture, 0, sizeof(*fixture));
+
+	fixture->server = soup_server_new(NULL);
+	soup_server_add_handler(fixture->server, NULL, on_server_request, fixture, NULL);
+	g_assert_true(soup_server_listen_local(fixture->server, 0,
+	                                       SOUP_SERVER_LISTEN_IPV4_ONLY, &error));
+	g_assert_no_error(error);
+
+	uris = soup_server_get_uris(fixture->server);
+	fixture->uri = g_uri_ref(uris->data);
+	g_slist_free_full(uris, (GDestroyNotify)g_uri_unref);
+
+	fixture->loop = g_main_loop_new(NULL, FALSE);
+}
+
+static void
+fixture_teardown(RetryFixture *fixture)
+{
+	g_clear_pointer(&fixture->result, g_bytes_unref);
+	g_clear_error(&fixture->error);
+	g_clear_pointer(&fixture->loop, g_main_loop_unref);
+	g_clear_pointer(&fixture->uri, g_uri_unref);
+	g_clear_object(&fixture->server);
+}
+
+static void
+on_retry(
+	AiClient     *client,
+	guint         attempt,
+	guint         delay_ms,
+	const GError *error,
+	gpointer      user_data
+){
+	RetryFixture *fixture = user_data;
+
+	(void)client;
+	(void)delay_ms;
+
+	fixture->retry_signals++;
+	g_assert_cmpuint(attempt, ==, fixture->retry_signals);
+	g_assert_error(error, AI_ERROR, AI_ERROR_SERVICE_UNAVAILABLE);
+}
+
+static void
+on_send_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	RetryFixture *fixture = user_data;
+
+	fixture->result = ai_client_send_and_read_finish(AI_CLIENT(source), result,
+	                                                 &fixture->error);
+	g_main_loop_quit(fixture->loop);
+}
+
+static void
+run_send(
+	RetryFixture *fixture,
+	AiClient     *client
+){
+	g_autoptr(SoupMessage) msg = NULL;
+	g_autoptr(GBytes) body = NULL;
+
+	body = g_bytes_new_static("{}", 2);
+	msg = soup_message_new_from_uri("POST", fixture->uri);
+
+	ai_client_send_and_read_async(client, msg, body, NULL, on_send_done, fixture);
+	g_main_loop_run(fixture->loop);
+}
+
+static void
+test_retry_send_recovers(void)
+{
+	RetryFixture fixture;
+	g_autoptr(AiConfig) config = NULL;
+	g_autoptr(AiClient) client = NULL;
+
+	fixture_setup(&fixture);
+	fixture.failures = 2;
+
+	config = ai_config_new();
+	ai_config_set_max_retries(config, 3);
+	client = g_object_new(AI_TYPE_CLIENT, "config", config, NULL);
+	g_signal_connect(client, "retry", G_CALLBACK(on_retry), &fixture);
+
+	run_send(&fixture, client);
+
+	g_assert_no_error(fixture.error);
+	g_assert_nonnull(fixture.result);
+	g_assert_cmpuint(fixture.requests, ==, 3);
+	g_assert_cmpuint(fixture.retry_signals, ==, 2);
+	g_assert_cmpuint(ai_client_get_retry_count(client), ==, 2);
+
+	fixture_teardown(&fixture);
+}
+
+static void
+test_retry_send_gives_up(void)
+{
+	RetryFixture fixture;
+	g_autoptr(AiConfig) config = NULL;
+	g_autoptr(AiClient) client = NULL;
+
+	fixture_setup(&fixture);
+	fixture.failures = 10;
+
+	config = ai_config_new();
+	ai_config_set_max_retries(config, 1);
+	client = g_object_new(AI_TYPE_CLIENT, "config", config, NULL);
+
+	run_send(&fixture, client);
+
+	g_assert_null(fixture.result);
+	g_assert_error(fixture.error, AI_ERROR, AI_ERROR_SERVICE_UNAVAILABLE);
+	g_assert_nonnull(strstr(fixture.error->message, "Overloaded"));
+	g_assert_cmpuint(fixture.requests, ==, 2);
+	g_assert_cmpuint(ai_client_get_retry_count(client), ==, 1);
+
+	fixture_teardown(&fixture);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/retry/retryable-status", test_retry_retryable_status);
+	g_test_add_func("/ai-glib/retry/retryable-error", test_retry_retryable_error);
+	g_test_add_func("/ai-glib/retry/parse-duration", test_retry_parse_duration);
+	g_test_add_func("/ai-glib/retry/server-delay", test_retry_server_delay);
+	g_test_add_func("/ai-glib/retry/anthropic-reset", test_retry_anthropic_reset);
+	g_test_add_func("/ai-glib/retry/backoff", test_retry_backoff);
+	g_test_add_func("/ai-glib/retry/send-recovers", test_retry_send_recovers);
+	g_test_add_func("/ai-glib/retry/send-gives-up", test_retry_send_gives_up);
+
+	return g_test_run();
+}
@@ -0,0 +1,418 @@
+/*
+ * test-router-provider.c - Unit tests for AiRouterProvider
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <unistd.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#include "convenience/ai-router-provider.h"
+#include "core/ai-client.h"
+#include "core/ai-config.h"
+#include "core/ai-error.h"
+#include "core/ai-prompt-scorer.h"
+#include "core/ai-provider.h"
+#include "model/ai-message.h"
+#include "model/ai-response.h"
+
+static const gchar *reasoning_prompt =
+	"Prove by induction that the sum of the first n natural "
+	"numbers equals n(n+1)/2. Then derive the formula using "
+	"mathematical reasoning and chain of thought step by step.";
+
+/*
+ * A provider that answers at once with its label as the response ID,
+ * and remembers the token limit it was called with and the model of the
+ * last request made with options.
+ */
+#define TEST_TYPE_PROVIDER (test_provider_get_type())
+G_DECLARE_FINAL_TYPE(TestProvider, test_provider, TEST, PROVIDER, GObject)
+
+struct _TestProvider
+{
+	GObject parent_instance;
+
+	gchar *label;
+	gchar *model;
+	gint   max_tokens;
+	guint  n_calls;
+};
+
+static void test_provider_iface_init(AiProviderInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE(TestProvider, test_provider, G_TYPE_OBJECT,
+                        G_IMPLEMENT_INTERFACE(AI_TYPE_PROVIDER, test_provider_iface_init))
+
+static void
+test_provider_chat_async(
+	AiProvider          *provider,
+	GList               *messages,
+	const gchar         *system_prompt,
+	gint                 max_tokens,
+	GList               *tools,
+	GCancellable        *cancellable,
+	GAsyncReadyCallback  callback,
+	gpointer             user_data
+){
+	TestProvider *self = TEST_PROVIDER(provider);
+	g_autoptr(GTask) task = g_task_new(self, cancellable, callback, user_data);
+
+	self->n_calls++;
+	self->max_tokens = max_tokens;
+	g_task_return_pointer(task, ai_response_new(self->label, "test"), g_object_unref);
+}
+
+static void
+test_provider_chat_with_options_async(
+	AiProvider             *provider,
+	GList                  *messages,
+	const AiRequestOptions *options,
+	GCancellable           *cancellable,
+	GAsyncReadyCallback     callback,
+	gpointer                user_data
+){
+	TestProvider *self = TEST_PROVIDER(provider);
+
+	g_free(self->model);
+	self->model = g_strdup(ai_request_options_get_model(options));
+
+	test_provider_chat_async(provider, messages, NULL,
+	                         ai_request_options_get_max_tokens(options), NULL,
+	                         cancellable, callback, user_data);
+}
+
+static AiResponse *
+test_provider_chat_finish(
+	AiProvider    *provider,
+	GAsyncResult  *result,
+	GError       **error
+){
+	return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+test_provider_iface_init(AiProviderInterface *iface)
+{
+	iface->chat_async = test_provider_chat_async;
+	iface->chat_with_options_async = test_provider_chat_with_options_async;
+	iface->chat_finish = test_provider_chat_finish;
+}
+
+static void
+test_provider_finalize(GObject *object)
+{
+	g_free(TEST_PROVIDER(object)->label);
+	g_free(TEST_PROVIDER(object)->model);
+
+	G_OBJECT_CLASS(test_provider_parent_class)->finalize(object);
+}
+
+static void
+test_provider_class_init(TestProviderClass *klass)
+{
+	G_OBJECT_CLASS(klass)->finalize = test_provider_finalize;
+}
+
+static void
+test_provider_init(TestProvider *self)
+{
+}
+
+static TestProvider *
+test_provider_new(const gchar *label)
+{
+	TestProvider *self = g_object_new(TEST_TYPE_PROVIDER, NULL);
+
+	self->label = g_strdup(label);
+
+	return self;
+}
+
+/*
+ * A router whose classifications are never ambiguous, so tiers follow
+ * the scorer exactly.
+ */
+static AiRouterProvider *
+create_router(void)
+{
+	g_autoptr(AiScorerConfig) scorer = ai_scorer_config_new_defaults();
+	AiRouterProvider *router = ai_router_provider_new();
+
+	ai_scorer_config_set_confidence_threshold(scorer, 0.0);
+	ai_router_provider_set_scorer_config(router, scorer);
+
+	return router;
+}
+
+static AiPromptTier
+select_tier(
+	AiRouterProvider *router,
+	const gchar      *prompt
+){
+	g_autoptr(AiMessage) msg = ai_message_new_user(prompt);
+	GList messages = { NULL, NULL, NULL };
+
+	messages.data = msg;
+
+	return ai_router_provider_select_tier(router, &messages, NULL, NULL);
+}
+
+typedef struct
+{
+	GMainLoop  *loop;
+	AiResponse *response;
+	GError     *error;
+} ChatData;
+
+static void
+on_chat_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	ChatData *data = user_data;
+
+	data->response = ai_provider_chat_finish(AI_PROVIDER(source), result, &data->error);
+	g_main_loop_quit(data->loop);
+}
+
+static void
+run_chat(
+	AiRouterProvider *router,
+	GList            *messages,
+	gint              max_tokens,
+	ChatData         *data
+){
+	data->loop = g_main_loop_new(NULL, FALSE);
+	data->response = NULL;
+	data->error = NULL;
+
+	ai_provider_chat_async(AI_PROVIDER(router), messages, NULL, max_tokens, NULL,
+	                       NULL, on_chat_done, data);
+	g_main_loop_run(data->loop);
+	g_main_loop_unref(data->loop);
+}
+
+static void
+test_router_select_tier(void)
+{
+	g_autoptr(AiRouterProvider) router = create_router();
+	TestProvider *providers[4];
+	gint max_tokens = -1;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(providers); i++)
+	{
+		providers[i] = test_provider_new(ai_prompt_tier_to_string(i));
+		ai_router_provider_set_route(router, i, AI_PROVIDER(providers[i]), 100 * i);
+	}
+	g_assert_true(ai_router_provider_get_route(router, AI_PROMPT_TIER_COMPLEX, &max_tokens) ==
+	              AI_PROVIDER(providers[AI_PROMPT_TIER_COMPLEX]));
+	g_assert_cmpint(max_tokens, ==, 200);
+
+	g_assert_cmpint(select_tier(router, "hello"), ==, AI_PROMPT_TIER_SIMPLE);
+	g_assert_cmpint(select_tier(router, reasoning_prompt), ==, AI_PROMPT_TIER_REASONING);
+
+	for (i = 0; i < G_N_ELEMENTS(providers); i++)
+	{
+		g_object_unref(providers[i]);
+	}
+}
+
+static void
+test_router_ambiguous(void)
+{
+	g_autoptr(AiRouterProvider) router = ai_router_provider_new();
+	g_autoptr(AiScorerConfig) scorer = ai_scorer_config_new_defaults();
+	g_autoptr(TestProvider) small = test_provider_new("small");
+	g_autoptr(TestProvider) medium = test_provider_new("medium");
+	g_autoptr(TestProvider) large = test_provider_new("large");
+
+	ai_router_provider_set_route(router, AI_PROMPT_TIER_SIMPLE, AI_PROVIDER(small), 0);
+	ai_router_provider_set_route(router, AI_PROMPT_TIER_MODERATE, AI_PROVIDER(medium), 0);
+	ai_router_provider_set_route(router, AI_PROMPT_TIER_COMPLEX, AI_PROVIDER(large), 0);
+
+	/*
+	 * Every classification is ambiguous. The scorer reports those as
+	 * moderate, and the router moves them one tier further up.
+	 */
+	ai_scorer_config_set_confidence_threshold(scorer, 1.0);
+	ai_router_provider_set_scorer_config(router, scorer);
+
+	g_assert_cmpint(select_tier(router, "hello"), ==, AI_PROMPT_TIER_COMPLEX);
+}
+
+static void
+test_router_fallback(void)
+{
+	g_autoptr(AiRouterProvider) router = create_router();
+	g_autoptr(TestProvider) large = test_provider_new("large");
+	g_autoptr(TestProvider) small = test_provider_new("small");
+
+	/* A missing tier falls back upwards first */
+	ai_router_provider_set_route(router, AI_PROMPT_TIER_COMPLEX, AI_PROVIDER(large), 0);
+	g_assert_cmpint(select_tier(router, "hello"), ==, AI_PROMPT_TIER_COMPLEX);
+	g_assert_cmpint(select_tier(router, reasoning_prompt), ==, AI_PROMPT_TIER_COMPLEX);
+
+	/* and downwards when nothing higher is routed */
+	ai_router_provider_set_route(router, AI_PROMPT_TIER_COMPLEX, NULL, 0);
+	ai_router_provider_set_route(router, AI_PROMPT_TIER_SIMPLE, AI_PROVIDER(small), 0);
+	g_assert_cmpint(select_tier(router, reasoning_prompt), ==, AI_PROMPT_TIER_SIMPLE);
+}
+
+static void
+test_router_chat(void)
+{
+	g_autoptr(AiRouterProvider) router = create_router();
+	g_autoptr(TestProvider) small = test_provider_new("small");
+	g_autoptr(TestProvider) large = test_provider_new("large");
+	g_autoptr(AiMessage) question = ai_message_new_user(reasoning_prompt);
+	g_autoptr(AiMessage) answer = ai_message_new_assistant("By induction on n ...");
+	g_autoptr(AiMessage) thanks = ai_message_new_user("hello");
+	g_autoptr(GList) messages = NULL;
+	ChatData data;
+
+	ai_router_provider_set_route(router, AI_PROMPT_TIER_SIMPLE, AI_PROVIDER(small), 256);
+	ai_router_provider_set_route(router, AI_PROMPT_TIER_REASONING, AI_PROVIDER(large), 0);
+
+	messages = g_list_append(messages, question);
+	run_chat(router, messages, 4096, &data);
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "large");
+	g_assert_cmpint(large->max_tokens, ==, 4096);
+	g_clear_object(&data.response);
+
+	/* The newest user message decides; the caller's limit wins */
+	messages = g_list_append(messages, answer);
+	messages = g_list_append(messages, thanks);
+	run_chat(router, messages, 4096, &data);
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "small");
+	g_assert_cmpint(small->max_tokens, ==, 4096);
+	g_clear_object(&data.response);
+
+	/* Without one, the route's limit applies */
+	run_chat(router, messages, 0, &data);
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "small");
+	g_assert_cmpint(small->max_tokens, ==, 256);
+	g_clear_object(&data.response);
+}
+
+static void
+test_router_options(void)
+{
+	g_autoptr(AiRouterProvider) router = create_router();
+	g_autoptr(TestProvider) small = test_provider_new("small");
+	g_autoptr(AiRequestOptions) options = ai_request_options_new();
+	g_autoptr(AiMessage) msg = ai_message_new_user("hello");
+	GList messages = { NULL, NULL, NULL };
+	ChatData data = { NULL, NULL, NULL };
+
+	ai_router_provider_set_route(router, AI_PROMPT_TIER_SIMPLE, AI_PROVIDER(small), 0);
+
+	/* The per-request model reaches the route */
+	ai_request_options_set_model(options, "test-model");
+	messages.data = msg;
+	data.loop = g_main_loop_new(NULL, FALSE);
+	ai_provider_chat_with_options_async(AI_PROVIDER(router), &messages, options,
+	                                    NULL, on_chat_done, &data);
+	g_main_loop_run(data.loop);
+	g_main_loop_unref(data.loop);
+
+	g_assert_no_error(data.error);
+	g_assert_cmpstr(ai_response_get_id(data.response), ==, "small");
+	g_assert_cmpstr(small->model, ==, "test-model");
+	g_clear_object(&data.response);
+}
+
+static void
+test_router_no_routes(void)
+{
+	g_autoptr(AiRouterProvider) router = ai_router_provider_new();
+	g_autoptr(AiMessage) msg = ai_message_new_user("hello");
+	GList messages = { NULL, NULL, NULL };
+	ChatData data;
+
+	messages.data = msg;
+	run_chat(router, &messages, 4096, &data);
+	g_assert_error(data.error, AI_ERROR, AI_ERROR_CONFIGURATION_ERROR);
+	g_assert_null(data.response);
+	g_clear_error(&data.error);
+}
+
+static void
+test_router_from_config(void)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(AiConfig) config = ai_config_new();
+	g_autoptr(AiRouterProvider) router = NULL;
+	g_autofree gchar *path = NULL;
+	AiProviderType provider_type;
+	const gchar *model;
+	gint max_tokens;
+	gint fd;
+
+	fd = g_file_open_tmp("ai-glib-routing-XXXXXX.yaml", &path, &error);
+	g_assert_no_error(error);
+	close(fd);
+
+	g_assert_true(g_file_set_contents(path,
+		"routing:\n"
+		"  simple:\n"
+		"    provider: ollama\n"
+		"    model: llama3.2\n"
+		"    max_tokens: 512\n"
+		"  moderate:\n"
+		"    provider: ollama\n"
+		"    model: llama3.2\n"
+		"  complex:\n"
+		"    provider: claude\n"
+		"    model: claude-sonnet-4-5\n", -1, &error));
+	g_assert_true(ai_config_load_from_file(config, path, &error));
+	g_assert_no_error(error);
+	g_unlink(path);
+
+	g_assert_true(ai_config_get_route(config, AI_PROMPT_TIER_SIMPLE,
+	                                  &provider_type, &model, &max_tokens));
+	g_assert_cmpint(provider_type, ==, AI_PROVIDER_OLLAMA);
+	g_assert_cmpstr(model, ==, "llama3.2");
+	g_assert_cmpint(max_tokens, ==, 512);
+	g_assert_false(ai_config_get_route(config, AI_PROMPT_TIER_REASONING, NULL, NULL, NULL));
+
+	router = ai_router_provider_new_from_config(config);
+
+	/* Routes with the same provider and model share one client */
+	g_assert_nonnull(ai_router_provider_get_route(router, AI_PROMPT_TIER_SIMPLE, NULL));
+	g_assert_true(ai_router_provider_get_route(router, AI_PROMPT_TIER_SIMPLE, NULL) ==
+	              ai_router_provider_get_route(router, AI_PROMPT_TIER_MODERATE, NULL));
+	g_assert_true(ai_router_provider_get_route(router, AI_PROMPT_TIER_SIMPLE, NULL) !=
+	              ai_router_provider_get_route(router, AI_PROMPT_TIER_COMPLEX, NULL));
+	g_assert_null(ai_router_provider_get_route(router, AI_PROMPT_TIER_REASONING, NULL));
+
+	g_assert_cmpstr(ai_client_get_model(AI_CLIENT(
+	                    ai_router_provider_get_route(router, AI_PROMPT_TIER_COMPLEX, NULL))),
+	                ==, "claude-sonnet-4-5");
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/router-provider/select-tier", test_router_select_tier);
+	g_test_add_func("/ai-glib/router-provider/ambiguous", test_router_ambiguous);
+	g_test_add_func("/ai-glib/router-provider/fallback", test_router_fallback);
+	g_test_add_func("/ai-glib/router-provider/chat", test_router_chat);
+	g_test_add_func("/ai-glib/router-provider/options", test_router_options);
+	g_test_add_func("/ai-glib/router-provider/no-routes", test_router_no_routes);
+	g_test_add_func("/ai-glib/router-provider/from-config", test_router_from_config);
+
+	return g_test_run();
+}
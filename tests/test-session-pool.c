@@ -0,0 +1,128 @@
+/*
+ * test-session-pool.c - Unit tests for the shared session pool
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <glib.h>
+#include <libsoup/soup.h>
+
+#include "core/ai-session-pool.h"
+
+static void
+test_session_pool_shared(void)
+{
+	g_autoptr(SoupSession) a = NULL;
+	g_autoptr(SoupSession) b = NULL;
+
+	a = ai_session_pool_get_session("https://api.anthropic.com/v1/messages", 120, 8);
+	b = ai_session_pool_get_session("https://api.anthropic.com/v1/messages/batches", 120, 8);
+
+	g_assert_nonnull(a);
+	g_assert_true(a == b);
+	g_assert_cmpuint(soup_session_get_max_conns_per_host(a), ==, 8);
+	g_assert_cmpuint(soup_session_get_timeout(a), ==, 120);
+}
+
+static void
+test_session_pool_keys(void)
+{
+	g_autoptr(SoupSession) base = NULL;
+	g_autoptr(SoupSession) other_host = NULL;
+	g_autoptr(SoupSession) other_port = NULL;
+	g_autoptr(SoupSession) other_timeout = NULL;
+	g_autoptr(SoupSession) other_conns = NULL;
+	g_autoptr(SoupSession) general = NULL;
+
+	base = ai_session_pool_get_session("https://api.openai.com/v1/chat/completions", 120, 8);
+	other_host = ai_session_pool_get_session("https://api.x.ai/v1/chat/completions", 120, 8);
+	other_port = ai_session_pool_get_session("https://api.openai.com:8443/v1", 120, 8);
+	other_timeout = ai_session_pool_get_session("https://api.openai.com/v1", 30, 8);
+	other_conns = ai_session_pool_get_session("https://api.openai.com/v1", 120, 2);
+	general = ai_session_pool_get_session(NULL, 120, 8);
+
+	g_assert_true(base != other_host);
+	g_assert_true(base != other_port);
+	g_assert_true(base != other_timeout);
+	g_assert_true(base != other_conns);
+	g_assert_true(base != general);
+}
+
+static void
+test_session_pool_release(void)
+{
+	SoupSession *session;
+	guint before;
+
+	before = ai_session_pool_get_size();
+
+	session = ai_session_pool_get_session("http://localhost:11434/api/chat", 60, 4);
+	g_assert_cmpuint(ai_session_pool_get_size(), ==, before + 1);
+
+	/* Dropping the last reference removes the session from the pool */
+	g_object_unref(session);
+	g_assert_cmpuint(ai_session_pool_get_size(), ==, before);
+
+	session = ai_session_pool_get_session("http://localhost:11434/api/chat", 60, 4);
+	g_assert_nonnull(session);
+	g_object_unref(session);
+}
+
+static gpointer
+get_thread_local_session(gpointer user_data)
+{
+	SoupSession *session;
+	SoupSession *again;
+
+	(void)user_data;
+
+	g_assert_false(ai_session_pool_get_thread_local());
+	ai_session_pool_set_thread_local(TRUE);
+	g_assert_true(ai_session_pool_get_thread_local());
+
+	session = ai_session_pool_get_session("https://api.anthropic.com/v1/messages", 120, 8);
+	again = ai_session_pool_get_session("https://api.anthropic.com/v1/messages", 120, 8);
+	g_assert_true(session == again);
+	g_object_unref(again);
+
+	/* The thread keeps its sessions until it turns this off */
+	ai_session_pool_set_thread_local(FALSE);
+	g_assert_false(ai_session_pool_get_thread_local());
+
+	return session;
+}
+
+static void
+test_session_pool_thread_local(void)
+{
+	g_autoptr(SoupSession) shared = NULL;
+	g_autoptr(SoupSession) local = NULL;
+	GThread *thread;
+	guint before;
+
+	shared = ai_session_pool_get_session("https://api.anthropic.com/v1/messages", 120, 8);
+	before = ai_session_pool_get_size();
+
+	thread = g_thread_new("thread-local", get_thread_local_session, NULL);
+	local = g_thread_join(thread);
+
+	g_assert_nonnull(local);
+	g_assert_true(local != shared);
+	g_assert_cmpuint(ai_session_pool_get_size(), ==, before);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/session-pool/shared", test_session_pool_shared);
+	g_test_add_func("/ai-glib/session-pool/keys", test_session_pool_keys);
+	g_test_add_func("/ai-glib/session-pool/release", test_session_pool_release);
+	g_test_add_func("/ai-glib/session-pool/thread-local", test_session_pool_thread_local);
+
+	return g_test_run();
+}
@@ -0,0 +1,296 @@
+/*
+ * test-stream-reader.c - Unit tests for SSE and NDJSON framing
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <glib.h>
+#include <string.h>
+#include <gio/gio.h>
+
+#include "core/ai-stream-reader.h"
+
+/*
+ * An input stream that hands out its data at most a few bytes at a
+ * time, so events are split across reads.
+ */
+#define TEST_TYPE_CHUNKED_STREAM (test_chunked_stream_get_type())
+G_DECLARE_FINAL_TYPE(TestChunkedStream, test_chunked_stream, TEST, CHUNKED_STREAM, GInputStream)
+
+struct _TestChunkedStream
+{
+	GInputStream parent_instance;
+
+	GBytes *bytes;
+	gsize   pos;
+	gsize   chunk;
+};
+
+G_DEFINE_TYPE(TestChunkedStream, test_chunked_stream, G_TYPE_INPUT_STREAM)
+
+static gssize
+test_chunked_stream_read(
+	GInputStream  *stream,
+	void          *buffer,
+	gsize          count,
+	GCancellable  *cancellable,
+	GError       **error
+){
+	TestChunkedStream *self = TEST_CHUNKED_STREAM(stream);
+	gsize size;
+	const gchar *data = g_bytes_get_data(self->bytes, &size);
+	gsize n = MIN(MIN(count, self->chunk), size - self->pos);
+
+	(void)cancellable;
+	(void)error;
+
+	memcpy(buffer, data + self->pos, n);
+	self->pos += n;
+
+	return n;
+}
+
+static void
+test_chunked_stream_finalize(GObject *object)
+{
+	TestChunkedStream *self = TEST_CHUNKED_STREAM(object);
+
+	g_bytes_unref(self->bytes);
+
+	G_OBJECT_CLASS(test_chunked_stream_parent_class)->finalize(object);
+}
+
+static void
+test_chunked_stream_class_init(TestChunkedStreamClass *klass)
+{
+	G_OBJECT_CLASS(klass)->finalize = test_chunked_stream_finalize;
+	G_INPUT_STREAM_CLASS(klass)->read_fn = test_chunked_stream_read;
+}
+
+static void
+test_chunked_stream_init(TestChunkedStream *self)
+{
+	(void)self;
+}
+
+static GInputStream *
+chunked_stream_new(
+	const gchar *data,
+	gsize        chunk
+){
+	TestChunkedStream *self = g_object_new(TEST_TYPE_CHUNKED_STREAM, NULL);
+
+	self->bytes = g_bytes_new(data, strlen(data));
+	self->chunk = chunk;
+
+	return G_INPUT_STREAM(self);
+}
+
+typedef struct
+{
+	AiStreamReader *reader;
+	GPtrArray      *events;         /* "type|data" */
+	guint           pause_every;
+	GMainLoop      *loop;
+} ReadState;
+
+static gboolean
+on_event(
+	const AiStreamEvent *event,
+	gpointer             user_data
+){
+	ReadState *state = user_data;
+
+	g_assert_cmpuint(strlen(event->data), ==, event->data_len);
+	if (event->type != NULL)
+	{
+		g_assert_cmpuint(strlen(event->type), ==, event->type_len);
+	}
+
+	g_ptr_array_add(state->events, g_strdup_printf("%s|%s",
+	                                               event->type != NULL ? event->type : "",
+	                                               event->data));
+
+	return state->pause_every == 0 || state->events->len % state->pause_every != 0;
+}
+
+static void
+on_read(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	ReadState *state = user_data;
+	g_autoptr(GError) error = NULL;
+
+	(void)source;
+
+	if (ai_stream_reader_read_finish(state->reader, result, &error))
+	{
+		ai_stream_reader_read_async(state->reader, NULL, on_read, state);
+		return;
+	}
+
+	g_assert_no_error(error);
+	g_main_loop_quit(state->loop);
+}
+
+/*
+ * Frame @input, read @chunk bytes at a time, and return the events.
+ */
+static GPtrArray *
+read_events(
+	const gchar    *input,
+	gsize           chunk,
+	AiStreamFormat  format,
+	guint           pause_every
+){
+	g_autoptr(GInputStream) stream = chunked_stream_new(input, chunk);
+	ReadState state = { NULL, NULL, pause_every, NULL };
+
+	state.events = g_ptr_array_new_with_free_func(g_free);
+	state.loop = g_main_loop_new(NULL, FALSE);
+	state.reader = ai_stream_reader_new(stream, format, on_event, &state);
+
+	ai_stream_reader_read_async(state.reader, NULL, on_read, &state);
+	g_main_loop_run(state.loop);
+
+	ai_stream_reader_free(state.reader);
+	g_main_loop_unref(state.loop);
+
+	return state.events;
+}
+
+static const gchar *sse_input =
+	"event: message_start\n"
+	"data: {\"type\":\"message_start\"}\n"
+	"\n"
+	": keep-alive\n"
+	"\n"
+	"data: one\n"
+	"data: two\n"
+	"\n"
+	"event: no-data\n"
+	"id: 7\n"
+	"\n"
+	"event: crlf\r\n"
+	"data:{}\r\n"
+	"\r\n"
+	"data: [DONE]\n"
+	"\n";
+
+static void
+assert_sse_events(GPtrArray *events)
+{
+	g_assert_cmpuint(events->len, ==, 4);
+	g_assert_cmpstr(g_ptr_array_index(events, 0), ==, "message_start|{\"type\":\"message_start\"}");
+	g_assert_cmpstr(g_ptr_array_index(events, 1), ==, "|one\ntwo");
+	g_assert_cmpstr(g_ptr_array_index(events, 2), ==, "crlf|{}");
+	g_assert_cmpstr(g_ptr_array_index(events, 3), ==, "|[DONE]");
+}
+
+static void
+test_stream_reader_sse(void)
+{
+	g_autoptr(GPtrArray) events = NULL;
+
+	events = read_events(sse_input, G_MAXSIZE, AI_STREAM_FORMAT_SSE, 0);
+	assert_sse_events(events);
+}
+
+static void
+test_stream_reader_sse_split(void)
+{
+	static const gsize chunks[] = { 1, 2, 3, 7, 13 };
+	guint i;
+
+	/* Events that straddle reads come out the same */
+	for (i = 0; i < G_N_ELEMENTS(chunks); i++)
+	{
+		g_autoptr(GPtrArray) events = NULL;
+
+		events = read_events(sse_input, chunks[i], AI_STREAM_FORMAT_SSE, 0);
+		assert_sse_events(events);
+	}
+}
+
+static void
+test_stream_reader_sse_unterminated(void)
+{
+	g_autoptr(GPtrArray) events = NULL;
+
+	/* The last event lacks its blank line and newline */
+	events = read_events("data: a\n\ndata: b", 4, AI_STREAM_FORMAT_SSE, 0);
+	g_assert_cmpuint(events->len, ==, 2);
+	g_assert_cmpstr(g_ptr_array_index(events, 1), ==, "|b");
+}
+
+static void
+test_stream_reader_ndjson(void)
+{
+	g_autoptr(GPtrArray) events = NULL;
+
+	events = read_events("{\"a\":1}\n\n{\"b\":2}\r\n{\"c\":3}", 5,
+	                     AI_STREAM_FORMAT_NDJSON, 0);
+	g_assert_cmpuint(events->len, ==, 3);
+	g_assert_cmpstr(g_ptr_array_index(events, 0), ==, "|{\"a\":1}");
+	g_assert_cmpstr(g_ptr_array_index(events, 1), ==, "|{\"b\":2}");
+	g_assert_cmpstr(g_ptr_array_index(events, 2), ==, "|{\"c\":3}");
+}
+
+static void
+test_stream_reader_large_event(void)
+{
+	g_autoptr(GPtrArray) events = NULL;
+	g_autofree gchar *payload = NULL;
+	g_autofree gchar *input = NULL;
+	g_autofree gchar *expected = NULL;
+	gsize size = 5 * AI_STREAM_READER_BLOCK_SIZE / 2;
+
+	/* An event larger than the buffer makes it grow */
+	payload = g_malloc(size + 1);
+	memset(payload, 'x', size);
+	payload[size] = '\0';
+	input = g_strdup_printf("data: first\n\ndata: %s\n\ndata: last\n\n", payload);
+
+	events = read_events(input, 4096, AI_STREAM_FORMAT_SSE, 0);
+	g_assert_cmpuint(events->len, ==, 3);
+	expected = g_strconcat("|", payload, NULL);
+	g_assert_cmpstr(g_ptr_array_index(events, 1), ==, expected);
+	g_assert_cmpstr(g_ptr_array_index(events, 2), ==, "|last");
+}
+
+static void
+test_stream_reader_pause(void)
+{
+	g_autoptr(GPtrArray) events = NULL;
+	g_autoptr(GPtrArray) all = NULL;
+
+	/* Pausing after every event loses none and keeps their order */
+	events = read_events(sse_input, G_MAXSIZE, AI_STREAM_FORMAT_SSE, 1);
+	assert_sse_events(events);
+
+	all = read_events("{\"a\":1}\n{\"b\":2}\n{\"c\":3}\n", G_MAXSIZE,
+	                  AI_STREAM_FORMAT_NDJSON, 1);
+	g_assert_cmpuint(all->len, ==, 3);
+	g_assert_cmpstr(g_ptr_array_index(all, 2), ==, "|{\"c\":3}");
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/stream-reader/sse", test_stream_reader_sse);
+	g_test_add_func("/ai-glib/stream-reader/sse-split", test_stream_reader_sse_split);
+	g_test_add_func("/ai-glib/stream-reader/sse-unterminated",
+	                test_stream_reader_sse_unterminated);
+	g_test_add_func("/ai-glib/stream-reader/ndjson", test_stream_reader_ndjson);
+	g_test_add_func("/ai-glib/stream-reader/large-event", test_stream_reader_large_event);
+	g_test_add_func("/ai-glib/stream-reader/pause", test_stream_reader_pause);
+
+	return g_test_run();
+}
@@ -0,0 +1,336 @@
+/*
+ * test-stream-tools.c - Unit tests for tool use in streamed responses
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "core/ai-client.h"
+#include "core/ai-config.h"
+#include "core/ai-streamable.h"
+#include "model/ai-message.h"
+#include "model/ai-response.h"
+#include "model/ai-tool-use.h"
+#include "providers/ai-claude-client.h"
+#include "providers/ai-openai-client.h"
+
+/* Text, then two tool calls whose input arrives in pieces */
+static const gchar *claude_stream =
+	"event: message_start\n"
+	"data: {\"type\":\"message_start\",\"message\":{\"id\":\"msg_1\",\"model\":\"claude-test\","
+	"\"usage\":{\"input_tokens\":3,\"output_tokens\":1}}}\n\n"
+	"event: content_block_start\n"
+	"data: {\"type\":\"content_block_start\",\"index\":0,"
+	"\"content_block\":{\"type\":\"text\",\"text\":\"\"}}\n\n"
+	"event: content_block_delta\n"
+	"data: {\"type\":\"content_block_delta\",\"index\":0,"
+	"\"delta\":{\"type\":\"text_delta\",\"text\":\"Checking\"}}\n\n"
+	"event: content_block_stop\n"
+	"data: {\"type\":\"content_block_stop\",\"index\":0}\n\n"
+	"event: content_block_start\n"
+	"data: {\"type\":\"content_block_start\",\"index\":1,\"content_block\":"
+	"{\"type\":\"tool_use\",\"id\":\"toolu_1\",\"name\":\"get_weather\",\"input\":{}}}\n\n"
+	"event: content_block_delta\n"
+	"data: {\"type\":\"content_block_delta\",\"index\":1,"
+	"\"delta\":{\"type\":\"input_json_delta\",\"partial_json\":\"{\\\"city\\\":\"}}\n\n"
+	"event: content_block_delta\n"
+	"data: {\"type\":\"content_block_delta\",\"index\":1,"
+	"\"delta\":{\"type\":\"input_json_delta\",\"partial_json\":\"\\\"Paris\\\"}\"}}\n\n"
+	"event: content_block_stop\n"
+	"data: {\"type\":\"content_block_stop\",\"index\":1}\n\n"
+	"event: content_block_start\n"
+	"data: {\"type\":\"content_block_start\",\"index\":2,\"content_block\":"
+	"{\"type\":\"tool_use\",\"id\":\"toolu_2\",\"name\":\"get_weather\",\"input\":{}}}\n\n"
+	"event: content_block_delta\n"
+	"data: {\"type\":\"content_block_delta\",\"index\":2,"
+	"\"delta\":{\"type\":\"input_json_delta\",\"partial_json\":\"{\\\"city\\\":\\\"Rome\\\"}\"}}\n\n"
+	"event: content_block_stop\n"
+	"data: {\"type\":\"content_block_stop\",\"index\":2}\n\n"
+	"event: message_delta\n"
+	"data: {\"type\":\"message_delta\",\"delta\":{\"stop_reason\":\"tool_use\"},"
+	"\"usage\":{\"output_tokens\":20}}\n\n"
+	"event: message_stop\n"
+	"data: {\"type\":\"message_stop\"}\n\n";
+
+static const gchar *openai_stream =
+	"data: {\"id\":\"chatcmpl-1\",\"model\":\"gpt-test\",\"choices\":[{\"index\":0,"
+	"\"delta\":{\"role\":\"assistant\",\"content\":null,\"tool_calls\":[{\"index\":0,"
+	"\"id\":\"call_1\",\"type\":\"function\","
+	"\"function\":{\"name\":\"get_weather\",\"arguments\":\"\"}}]},\"finish_reason\":null}]}\n\n"
+	"data: {\"id\":\"chatcmpl-1\",\"choices\":[{\"index\":0,\"delta\":{\"tool_calls\":"
+	"[{\"index\":0,\"function\":{\"arguments\":\"{\\\"city\\\":\\\"Paris\\\"}\"}}]},"
+	"\"finish_reason\":null}]}\n\n"
+	"data: {\"id\":\"chatcmpl-1\",\"choices\":[{\"index\":0,\"delta\":{\"tool_calls\":"
+	"[{\"index\":1,\"id\":\"call_2\",\"type\":\"function\","
+	"\"function\":{\"name\":\"get_weather\",\"arguments\":\"{\\\"city\\\":\"}}]},"
+	"\"finish_reason\":null}]}\n\n"
+	"data: {\"id\":\"chatcmpl-1\",\"choices\":[{\"index\":0,\"delta\":{\"tool_calls\":"
+	"[{\"index\":1,\"function\":{\"arguments\":\"\\\"Rome\\\"}\"}}]},"
+	"\"finish_reason\":null}]}\n\n"
+	"data: {\"id\":\"chatcmpl-1\",\"choices\":[{\"index\":0,\"delta\":{},"
+	"\"finish_reason\":\"tool_calls\"}]}\n\n"
+	"data: [DONE]\n\n";
+
+/*
+ * Local stand-in for a provider endpoint that answers every request
+ * with the stream passed as user data.
+ */
+static void
+on_request(
+	SoupServer        *server,
+	SoupServerMessage *msg,
+	const char        *path,
+	GHashTable        *query,
+	gpointer           user_data
+){
+	const gchar *body = user_data;
+
+	(void)server;
+	(void)path;
+	(void)query;
+
+	soup_server_message_set_status(msg, 200, NULL);
+	soup_server_message_set_response(msg, "text/event-stream", SOUP_MEMORY_STATIC,
+	                                 body, strlen(body));
+}
+
+static gchar *
+start_server(
+	SoupServer  *server,
+	const gchar *body
+){
+	g_autoptr(GError) error = NULL;
+	gchar *base_url;
+	GSList *uris;
+
+	soup_server_add_handler(server, NULL, on_request, (gpointer)body, NULL);
+	g_assert_true(soup_server_listen_local(server, 0, SOUP_SERVER_LISTEN_IPV4_ONLY, &error));
+	g_assert_no_error(error);
+
+	uris = soup_server_get_uris(server);
+	base_url = g_strdup_printf("http://127.0.0.1:%d", g_uri_get_port(uris->data));
+	g_slist_free_full(uris, (GDestroyNotify)g_uri_unref);
+
+	return base_url;
+}
+
+/*
+ * Every stream signal, recorded in order as "kind:details".
+ */
+typedef struct
+{
+	GPtrArray  *events;
+	GMainLoop  *loop;
+	AiResponse *response;
+} StreamFixture;
+
+static void
+on_delta(
+	AiStreamable *streamable,
+	const gchar  *text,
+	gpointer      user_data
+){
+	StreamFixture *fixture = user_data;
+
+	(void)streamable;
+
+	g_ptr_array_add(fixture->events, g_strdup_printf("delta:%s", text));
+}
+
+static void
+on_tool_input_delta(
+	AiStreamable *streamable,
+	const gchar  *tool_id,
+	const gchar  *partial_json,
+	gpointer      user_data
+){
+	StreamFixture *fixture = user_data;
+
+	(void)streamable;
+
+	g_ptr_array_add(fixture->events, g_strdup_printf("input:%s:%s", tool_id, partial_json));
+}
+
+static void
+on_tool_use(
+	AiStreamable *streamable,
+	AiToolUse    *tool_use,
+	gpointer      user_data
+){
+	StreamFixture *fixture = user_data;
+
+	(void)streamable;
+
+	g_ptr_array_add(fixture->events,
+	                g_strdup_printf("tool:%s:%s:%s",
+	                                ai_tool_use_get_id(tool_use),
+	                                ai_tool_use_get_name(tool_use),
+	                                ai_tool_use_get_input_string(tool_use, "city")));
+}
+
+static void
+on_stream_end(
+	AiStreamable *streamable,
+	AiResponse   *response,
+	gpointer      user_data
+){
+	StreamFixture *fixture = user_data;
+
+	(void)streamable;
+	(void)response;
+
+	g_ptr_array_add(fixture->events, g_strdup("end"));
+}
+
+static void
+on_stream_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	StreamFixture *fixture = user_data;
+	g_autoptr(GError) error = NULL;
+
+	fixture->response = ai_streamable_chat_stream_finish(AI_STREAMABLE(source), result, &error);
+	g_assert_no_error(error);
+	g_main_loop_quit(fixture->loop);
+}
+
+static void
+run_stream(
+	StreamFixture *fixture,
+	AiStreamable  *client
+){
+	g_autoptr(AiMessage) msg = ai_message_new_user("What is the weather?");
+	GList messages = { NULL, NULL, NULL };
+
+	fixture->events = g_ptr_array_new_with_free_func(g_free);
+	fixture->loop = g_main_loop_new(NULL, FALSE);
+	fixture->response = NULL;
+
+	g_signal_connect(client, "delta", G_CALLBACK(on_delta), fixture);
+	g_signal_connect(client, "tool-input-delta", G_CALLBACK(on_tool_input_delta), fixture);
+	g_signal_connect(client, "tool-use", G_CALLBACK(on_tool_use), fixture);
+	g_signal_connect(client, "stream-end", G_CALLBACK(on_stream_end), fixture);
+
+	messages.data = msg;
+	ai_streamable_chat_stream_async(client, &messages, NULL, 256, NULL, NULL,
+	                                on_stream_done, fixture);
+	g_main_loop_run(fixture->loop);
+}
+
+static void
+stream_fixture_clear(StreamFixture *fixture)
+{
+	g_clear_pointer(&fixture->events, g_ptr_array_unref);
+	g_clear_pointer(&fixture->loop, g_main_loop_unref);
+	g_clear_object(&fixture->response);
+}
+
+static void
+assert_events(
+	StreamFixture *fixture,
+	const gchar   *expected[],
+	guint          n_expected
+){
+	guint i;
+
+	g_assert_cmpuint(fixture->events->len, ==, n_expected);
+	for (i = 0; i < n_expected; i++)
+	{
+		g_assert_cmpstr(g_ptr_array_index(fixture->events, i), ==, expected[i]);
+	}
+}
+
+static void
+assert_response_tools(
+	AiResponse  *response,
+	const gchar *first_id,
+	const gchar *second_id
+){
+	g_autoptr(GList) tool_uses = NULL;
+
+	g_assert_nonnull(response);
+	tool_uses = ai_response_get_tool_uses(response);
+	g_assert_cmpuint(g_list_length(tool_uses), ==, 2);
+	g_assert_cmpstr(ai_tool_use_get_id(tool_uses->data), ==, first_id);
+	g_assert_cmpstr(ai_tool_use_get_id(tool_uses->next->data), ==, second_id);
+}
+
+static void
+test_stream_tools_claude(void)
+{
+	g_autoptr(SoupServer) server = soup_server_new(NULL);
+	g_autoptr(AiConfig) config = ai_config_new();
+	g_autoptr(AiClaudeClient) client = NULL;
+	g_autofree gchar *base_url = NULL;
+	StreamFixture fixture = { NULL, NULL, NULL };
+	const gchar *expected[] = {
+		"delta:Checking",
+		"input:toolu_1:{\"city\":",
+		"input:toolu_1:\"Paris\"}",
+		"tool:toolu_1:get_weather:Paris",
+		"input:toolu_2:{\"city\":\"Rome\"}",
+		"tool:toolu_2:get_weather:Rome",
+		"end",
+	};
+
+	base_url = start_server(server, claude_stream);
+	ai_config_set_api_key(config, AI_PROVIDER_CLAUDE, "test-key");
+	ai_config_set_base_url(config, AI_PROVIDER_CLAUDE, base_url);
+	client = ai_claude_client_new_with_config(config);
+
+	run_stream(&fixture, AI_STREAMABLE(client));
+
+	assert_events(&fixture, expected, G_N_ELEMENTS(expected));
+	assert_response_tools(fixture.response, "toolu_1", "toolu_2");
+	stream_fixture_clear(&fixture);
+}
+
+static void
+test_stream_tools_openai(void)
+{
+	g_autoptr(SoupServer) server = soup_server_new(NULL);
+	g_autoptr(AiConfig) config = ai_config_new();
+	g_autoptr(AiOpenAIClient) client = NULL;
+	g_autofree gchar *base_url = NULL;
+	StreamFixture fixture = { NULL, NULL, NULL };
+	const gchar *expected[] = {
+		"input:call_1:{\"city\":\"Paris\"}",
+		/* The first call is emitted as soon as the second starts */
+		"tool:call_1:get_weather:Paris",
+		"input:call_2:{\"city\":",
+		"input:call_2:\"Rome\"}",
+		"tool:call_2:get_weather:Rome",
+		"end",
+	};
+
+	base_url = start_server(server, openai_stream);
+	ai_config_set_api_key(config, AI_PROVIDER_OPENAI, "test-key");
+	ai_config_set_base_url(config, AI_PROVIDER_OPENAI, base_url);
+	client = ai_openai_client_new_with_config(config);
+
+	run_stream(&fixture, AI_STREAMABLE(client));
+
+	assert_events(&fixture, expected, G_N_ELEMENTS(expected));
+	assert_response_tools(fixture.response, "call_1", "call_2");
+	stream_fixture_clear(&fixture);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/stream-tools/claude", test_stream_tools_claude);
+	g_test_add_func("/ai-glib/stream-tools/openai", test_stream_tools_openai);
+
+	return g_test_run();
+}
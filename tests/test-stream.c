@@ -0,0 +1,424 @@
+/*
+ * test-stream.c - Unit tests for AiStream
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "core/ai-client.h"
+#include "core/ai-config.h"
+#include "core/ai-error.h"
+#include "core/ai-stream.h"
+#include "core/ai-streamable.h"
+#include "model/ai-message.h"
+#include "model/ai-response.h"
+#include "model/ai-tool-use.h"
+#include "model/ai-usage.h"
+#include "providers/ai-claude-client.h"
+
+/* Text, then a tool call whose input arrives in pieces */
+static const gchar *claude_stream =
+	"event: message_start\n"
+	"data: {\"type\":\"message_start\",\"message\":{\"id\":\"msg_1\",\"model\":\"claude-test\","
+	"\"usage\":{\"input_tokens\":3,\"output_tokens\":1}}}\n\n"
+	"event: content_block_start\n"
+	"data: {\"type\":\"content_block_start\",\"index\":0,"
+	"\"content_block\":{\"type\":\"text\",\"text\":\"\"}}\n\n"
+	"event: content_block_delta\n"
+	"data: {\"type\":\"content_block_delta\",\"index\":0,"
+	"\"delta\":{\"type\":\"text_delta\",\"text\":\"Checking\"}}\n\n"
+	"event: content_block_delta\n"
+	"data: {\"type\":\"content_block_delta\",\"index\":0,"
+	"\"delta\":{\"type\":\"text_delta\",\"text\":\" now\"}}\n\n"
+	"event: content_block_stop\n"
+	"data: {\"type\":\"content_block_stop\",\"index\":0}\n\n"
+	"event: content_block_start\n"
+	"data: {\"type\":\"content_block_start\",\"index\":1,\"content_block\":"
+	"{\"type\":\"tool_use\",\"id\":\"toolu_1\",\"name\":\"get_weather\",\"input\":{}}}\n\n"
+	"event: content_block_delta\n"
+	"data: {\"type\":\"content_block_delta\",\"index\":1,"
+	"\"delta\":{\"type\":\"input_json_delta\",\"partial_json\":\"{\\\"city\\\":\"}}\n\n"
+	"event: content_block_delta\n"
+	"data: {\"type\":\"content_block_delta\",\"index\":1,"
+	"\"delta\":{\"type\":\"input_json_delta\",\"partial_json\":\"\\\"Paris\\\"}\"}}\n\n"
+	"event: content_block_stop\n"
+	"data: {\"type\":\"content_block_stop\",\"index\":1}\n\n"
+	"event: message_delta\n"
+	"data: {\"type\":\"message_delta\",\"delta\":{\"stop_reason\":\"tool_use\"},"
+	"\"usage\":{\"output_tokens\":20}}\n\n"
+	"event: message_stop\n"
+	"data: {\"type\":\"message_stop\"}\n\n";
+
+static const gchar *expected_items[] = {
+	"text:Checking",
+	"text: now",
+	"input:toolu_1:{\"city\":",
+	"input:toolu_1:\"Paris\"}",
+	"tool:toolu_1:get_weather",
+	"usage:3:20",
+	"stop",
+};
+
+/*
+ * Local stand-in for the Claude endpoint. A body of NULL answers with
+ * an error.
+ */
+static void
+on_request(
+	SoupServerMessage *msg,
+	const gchar       *body
+){
+	if (body == NULL)
+	{
+		static const gchar *error_body =
+			"{\"type\":\"error\",\"error\":{\"type\":\"authentication_error\","
+			"\"message\":\"invalid x-api-key\"}}";
+
+		soup_server_message_set_status(msg, 401, NULL);
+		soup_server_message_set_response(msg, "application/json", SOUP_MEMORY_STATIC,
+		                                  error_body, strlen(error_body));
+		return;
+	}
+
+	soup_server_message_set_status(msg, 200, NULL);
+	soup_server_message_set_response(msg, "text/event-stream", SOUP_MEMORY_STATIC,
+	                                 body, strlen(body));
+}
+
+static void
+on_server_request(
+	SoupServer        *server,
+	SoupServerMessage *msg,
+	const char        *path,
+	GHashTable        *query,
+	gpointer           user_data
+){
+	(void)server;
+	(void)path;
+	(void)query;
+
+	on_request(msg, user_data);
+}
+
+static AiClaudeClient *
+create_client(
+	SoupServer  *server,
+	const gchar *body
+){
+	g_autoptr(AiConfig) config = ai_config_new();
+	g_autoptr(GError) error = NULL;
+	g_autofree gchar *base_url = NULL;
+	GSList *uris;
+
+	soup_server_add_handler(server, NULL, on_server_request, (gpointer)body, NULL);
+	g_assert_true(soup_server_listen_local(server, 0, SOUP_SERVER_LISTEN_IPV4_ONLY, &error));
+	g_assert_no_error(error);
+
+	uris = soup_server_get_uris(server);
+	base_url = g_strdup_printf("http://127.0.0.1:%d", g_uri_get_port(uris->data));
+	g_slist_free_full(uris, (GDestroyNotify)g_uri_unref);
+
+	ai_config_set_api_key(config, AI_PROVIDER_CLAUDE, "test-key");
+	ai_config_set_base_url(config, AI_PROVIDER_CLAUDE, base_url);
+
+	return ai_claude_client_new_with_config(config);
+}
+
+static AiStream *
+start_stream(
+	AiClaudeClient *client,
+	guint           capacity
+){
+	g_autoptr(AiMessage) msg = ai_message_new_user("What is the weather?");
+	GList messages = { NULL, NULL, NULL };
+
+	messages.data = msg;
+
+	return ai_stream_new(AI_STREAMABLE(client), &messages, NULL, capacity, NULL);
+}
+
+static gchar *
+describe_item(const AiStreamItem *item)
+{
+	switch (item->type)
+	{
+	case AI_STREAM_ITEM_TEXT:
+		return g_strdup_printf("text:%s", item->text);
+	case AI_STREAM_ITEM_TOOL_INPUT:
+		return g_strdup_printf("input:%s:%s", item->tool_id, item->text);
+	case AI_STREAM_ITEM_TOOL_USE:
+		return g_strdup_printf("tool:%s:%s", ai_tool_use_get_id(item->tool_use),
+		                       ai_tool_use_get_name(item->tool_use));
+	case AI_STREAM_ITEM_USAGE:
+		return g_strdup_printf("usage:%d:%d", ai_usage_get_input_tokens(item->usage),
+		                       ai_usage_get_output_tokens(item->usage));
+	case AI_STREAM_ITEM_STOP:
+		g_assert_cmpint(item->stop_reason, ==, AI_STOP_REASON_TOOL_USE);
+		g_assert_true(AI_IS_RESPONSE(item->response));
+		return g_strdup("stop");
+	default:
+		g_assert_not_reached();
+	}
+
+	return NULL;
+}
+
+static void
+assert_items(
+	GPtrArray   *items,
+	const gchar *expected[],
+	guint        n_expected
+){
+	guint i;
+
+	g_assert_cmpuint(items->len, ==, n_expected);
+	for (i = 0; i < n_expected; i++)
+	{
+		g_assert_cmpstr(g_ptr_array_index(items, i), ==, expected[i]);
+	}
+}
+
+/*
+ * A consumer on its own thread, which blocks in ai_stream_next_item()
+ * while the main thread runs the test server.
+ */
+typedef struct
+{
+	AiStream  *stream;
+	GPtrArray *items;
+	GError    *error;
+	gint       done;
+} Consumer;
+
+static gpointer
+consumer_thread(gpointer user_data)
+{
+	Consumer *consumer = user_data;
+	AiStreamItem *item;
+
+	while ((item = ai_stream_next_item(consumer->stream, -1, &consumer->error)) != NULL)
+	{
+		g_ptr_array_add(consumer->items, describe_item(item));
+		ai_stream_item_free(item);
+	}
+
+	g_atomic_int_set(&consumer->done, 1);
+	g_main_context_wakeup(NULL);
+
+	return NULL;
+}
+
+static void
+run_consumer(Consumer *consumer)
+{
+	GThread *thread;
+
+	consumer->items = g_ptr_array_new_with_free_func(g_free);
+	thread = g_thread_new("consumer", consumer_thread, consumer);
+
+	while (!g_atomic_int_get(&consumer->done))
+	{
+		g_main_context_iteration(NULL, TRUE);
+	}
+
+	g_thread_join(thread);
+}
+
+static void
+on_delta(
+	AiStreamable *streamable,
+	const gchar  *text,
+	gpointer      user_data
+){
+	gint *n_deltas = user_data;
+
+	(void)streamable;
+	(void)text;
+
+	g_atomic_int_inc(n_deltas);
+}
+
+static void
+test_stream_blocking(void)
+{
+	g_autoptr(SoupServer) server = soup_server_new(NULL);
+	g_autoptr(AiClaudeClient) client = NULL;
+	Consumer consumer = { NULL, NULL, NULL, 0 };
+	gint n_deltas = 0;
+
+	client = create_client(server, claude_stream);
+	g_signal_connect(client, "delta", G_CALLBACK(on_delta), &n_deltas);
+
+	consumer.stream = start_stream(client, 0);
+	g_assert_cmpuint(ai_stream_get_capacity(consumer.stream), ==, 64);
+	run_consumer(&consumer);
+
+	g_assert_no_error(consumer.error);
+	assert_items(consumer.items, expected_items, G_N_ELEMENTS(expected_items));
+
+	/* The items went to the stream instead of the signals */
+	g_assert_cmpint(g_atomic_int_get(&n_deltas), ==, 0);
+
+	g_object_unref(consumer.stream);
+	g_ptr_array_unref(consumer.items);
+}
+
+static void
+test_stream_backpressure(void)
+{
+	g_autoptr(SoupServer) server = soup_server_new(NULL);
+	g_autoptr(AiClaudeClient) client = NULL;
+	Consumer consumer = { NULL, NULL, NULL, 0 };
+
+	/* With room for one item, the reads pause after nearly every event */
+	client = create_client(server, claude_stream);
+	consumer.stream = start_stream(client, 1);
+	run_consumer(&consumer);
+
+	g_assert_no_error(consumer.error);
+	assert_items(consumer.items, expected_items, G_N_ELEMENTS(expected_items));
+
+	g_object_unref(consumer.stream);
+	g_ptr_array_unref(consumer.items);
+}
+
+static void
+test_stream_error(void)
+{
+	g_autoptr(SoupServer) server = soup_server_new(NULL);
+	g_autoptr(AiClaudeClient) client = NULL;
+	Consumer consumer = { NULL, NULL, NULL, 0 };
+
+	client = create_client(server, NULL);
+	consumer.stream = start_stream(client, 0);
+	run_consumer(&consumer);
+
+	g_assert_error(consumer.error, AI_ERROR, AI_ERROR_INVALID_API_KEY);
+	g_assert_cmpuint(consumer.items->len, ==, 0);
+
+	g_clear_error(&consumer.error);
+	g_object_unref(consumer.stream);
+	g_ptr_array_unref(consumer.items);
+}
+
+static void
+test_stream_timeout(void)
+{
+	g_autoptr(SoupServer) server = soup_server_new(NULL);
+	g_autoptr(AiClaudeClient) client = NULL;
+	g_autoptr(AiStream) stream = NULL;
+	g_autoptr(AiStreamItem) item = NULL;
+	g_autoptr(GError) error = NULL;
+
+	/* The server never runs, so nothing can arrive */
+	client = create_client(server, claude_stream);
+	stream = start_stream(client, 0);
+
+	item = ai_stream_next_item(stream, 10, &error);
+	g_assert_null(item);
+	g_assert_error(error, G_IO_ERROR, G_IO_ERROR_TIMED_OUT);
+}
+
+typedef struct
+{
+	AiStream   *stream;
+	GPtrArray  *items;
+	GMainLoop  *loop;
+} AsyncConsumer;
+
+static void
+on_next_item(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	AsyncConsumer *consumer = user_data;
+	g_autoptr(AiStreamItem) item = NULL;
+	g_autoptr(GError) error = NULL;
+
+	item = ai_stream_next_item_finish(AI_STREAM(source), result, &error);
+	g_assert_no_error(error);
+
+	if (item == NULL)
+	{
+		g_main_loop_quit(consumer->loop);
+		return;
+	}
+
+	g_ptr_array_add(consumer->items, describe_item(item));
+	ai_stream_next_item_async(consumer->stream, NULL, on_next_item, consumer);
+}
+
+static void
+test_stream_async(void)
+{
+	g_autoptr(SoupServer) server = soup_server_new(NULL);
+	g_autoptr(AiClaudeClient) client = NULL;
+	AsyncConsumer first = { NULL, NULL, NULL };
+	AsyncConsumer second = { NULL, NULL, NULL };
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+
+	client = create_client(server, claude_stream);
+
+	/* Two requests on one client are read apart */
+	first.stream = start_stream(client, 0);
+	first.items = g_ptr_array_new_with_free_func(g_free);
+	first.loop = loop;
+	second.stream = start_stream(client, 2);
+	second.items = g_ptr_array_new_with_free_func(g_free);
+	second.loop = loop;
+
+	ai_stream_next_item_async(first.stream, NULL, on_next_item, &first);
+	g_main_loop_run(loop);
+	ai_stream_next_item_async(second.stream, NULL, on_next_item, &second);
+	g_main_loop_run(loop);
+
+	assert_items(first.items, expected_items, G_N_ELEMENTS(expected_items));
+	assert_items(second.items, expected_items, G_N_ELEMENTS(expected_items));
+
+	g_object_unref(first.stream);
+	g_object_unref(second.stream);
+	g_ptr_array_unref(first.items);
+	g_ptr_array_unref(second.items);
+}
+
+static void
+test_stream_item_copy(void)
+{
+	g_autoptr(AiStreamItem) item = NULL;
+	g_autoptr(AiStreamItem) copy = NULL;
+
+	item = ai_stream_item_new(AI_STREAM_ITEM_TOOL_INPUT);
+	item->tool_id = g_strdup("toolu_1");
+	item->text = g_strdup("{\"city\":");
+
+	copy = ai_stream_item_copy(item);
+	g_assert_cmpint(copy->type, ==, AI_STREAM_ITEM_TOOL_INPUT);
+	g_assert_cmpstr(copy->tool_id, ==, "toolu_1");
+	g_assert_cmpstr(copy->text, ==, "{\"city\":");
+	g_assert_true(copy->text != item->text);
+	g_assert_null(copy->tool_use);
+	g_assert_null(copy->response);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/stream/item-copy", test_stream_item_copy);
+	g_test_add_func("/ai-glib/stream/blocking", test_stream_blocking);
+	g_test_add_func("/ai-glib/stream/backpressure", test_stream_backpressure);
+	g_test_add_func("/ai-glib/stream/async", test_stream_async);
+	g_test_add_func("/ai-glib/stream/error", test_stream_error);
+	g_test_add_func("/ai-glib/stream/timeout", test_stream_timeout);
+
+	return g_test_run();
+}
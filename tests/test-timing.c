@@ -0,0 +1,321 @@
+/*
+ * test-timing.c - Unit tests for AiTiming
+ *
+ * Copyright (C) 2025
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <string.h>
+#include <glib.h>
+#include <gio/gio.h>
+#include <libsoup/soup.h>
+
+#include "core/ai-client.h"
+#include "core/ai-config.h"
+#include "core/ai-provider.h"
+#include "model/ai-message.h"
+#include "model/ai-response.h"
+#include "model/ai-timing.h"
+#include "providers/ai-claude-client.h"
+
+static const gchar *claude_reply =
+	"{\"id\":\"msg_1\",\"type\":\"message\",\"role\":\"assistant\",\"model\":\"claude-test\","
+	"\"content\":[{\"type\":\"text\",\"text\":\"Hello\"}],\"stop_reason\":\"end_turn\","
+	"\"usage\":{\"input_tokens\":3,\"output_tokens\":1}}";
+
+static void
+test_timing_durations(void)
+{
+	g_autoptr(AiTiming) timing = ai_timing_new();
+	g_autoptr(AiTiming) copy = NULL;
+
+	g_assert_cmpint(ai_timing_get_duration(timing, AI_TIMING_DNS), ==, 0);
+	g_assert_cmpint(ai_timing_get_start_time(timing), <=, g_get_monotonic_time());
+
+	ai_timing_set_duration(timing, AI_TIMING_DNS, 1500);
+	ai_timing_set_duration(timing, AI_TIMING_TLS, -20);
+	ai_timing_set_bytes(timing, 120, 480);
+	g_assert_cmpint(ai_timing_get_duration(timing, AI_TIMING_DNS), ==, 1500);
+	g_assert_cmpint(ai_timing_get_duration(timing, AI_TIMING_TLS), ==, 0);
+
+	g_usleep(2000);
+	ai_timing_mark(timing, AI_TIMING_TOTAL);
+	g_assert_cmpint(ai_timing_get_duration(timing, AI_TIMING_TOTAL), >=, 2000);
+
+	copy = ai_timing_copy(timing);
+	g_assert_true(copy != timing);
+	g_assert_cmpint(ai_timing_get_start_time(copy), ==, ai_timing_get_start_time(timing));
+	g_assert_cmpint(ai_timing_get_duration(copy, AI_TIMING_DNS), ==, 1500);
+	g_assert_cmpuint(ai_timing_get_request_bytes(copy), ==, 120);
+	g_assert_cmpuint(ai_timing_get_response_bytes(copy), ==, 480);
+}
+
+static void
+test_timing_format_debug(void)
+{
+	g_autoptr(AiTiming) timing = ai_timing_new();
+	g_autofree gchar *debug = NULL;
+
+	ai_timing_set_duration(timing, AI_TIMING_FIRST_BYTE, 12500);
+	ai_timing_set_bytes(timing, 100, 200);
+	debug = ai_timing_format_debug(timing);
+
+	g_assert_nonnull(strstr(debug, "first-byte=12.5ms"));
+	g_assert_nonnull(strstr(debug, "sent=100B received=200B"));
+}
+
+static void
+test_timing_gtype(void)
+{
+	g_assert_true(G_TYPE_IS_BOXED(AI_TYPE_TIMING));
+	g_assert_cmpstr(g_type_name(AI_TYPE_TIMING), ==, "AiTiming");
+	g_assert_true(G_TYPE_IS_ENUM(AI_TYPE_TIMING_PHASE));
+}
+
+/*
+ * Local stand-in for the Claude messages endpoint that answers after
+ * 50 ms, so the wait for the first byte is measurable.
+ */
+static gboolean
+on_reply_timeout(gpointer user_data)
+{
+	SoupServerMessage *msg = user_data;
+
+	soup_server_message_set_status(msg, 200, NULL);
+	soup_server_message_set_response(msg, "application/json", SOUP_MEMORY_STATIC,
+	                                 claude_reply, strlen(claude_reply));
+	soup_server_message_unpause(msg);
+	g_object_unref(msg);
+
+	return G_SOURCE_REMOVE;
+}
+
+static void
+on_messages_request(
+	SoupServer        *server,
+	SoupServerMessage *msg,
+	const char        *path,
+	GHashTable        *query,
+	gpointer           user_data
+){
+	(void)server;
+	(void)path;
+	(void)query;
+	(void)user_data;
+
+	soup_server_message_pause(msg);
+	g_timeout_add(50, on_reply_timeout, g_object_ref(msg));
+}
+
+static AiClaudeClient *
+create_client(SoupServer *server)
+{
+	g_autoptr(GError) error = NULL;
+	g_autoptr(AiConfig) config = ai_config_new();
+	g_autofree gchar *base_url = NULL;
+	GSList *uris;
+
+	soup_server_add_handler(server, NULL, on_messages_request, NULL, NULL);
+	g_assert_true(soup_server_listen_local(server, 0, SOUP_SERVER_LISTEN_IPV4_ONLY, &error));
+	g_assert_no_error(error);
+
+	uris = soup_server_get_uris(server);
+	base_url = g_strdup_printf("http://127.0.0.1:%d", g_uri_get_port(uris->data));
+	g_slist_free_full(uris, (GDestroyNotify)g_uri_unref);
+
+	ai_config_set_api_key(config, AI_PROVIDER_CLAUDE, "test-key");
+	ai_config_set_base_url(config, AI_PROVIDER_CLAUDE, base_url);
+
+	return ai_claude_client_new_with_config(config);
+}
+
+static void
+assert_response_timing(AiResponse *response)
+{
+	AiTiming *timing;
+
+	g_assert_nonnull(response);
+	timing = ai_response_get_timing(response);
+	g_assert_nonnull(timing);
+
+	g_assert_cmpint(ai_timing_get_duration(timing, AI_TIMING_FIRST_BYTE), >=, 40000);
+	g_assert_cmpint(ai_timing_get_duration(timing, AI_TIMING_TOTAL), >=,
+	                ai_timing_get_duration(timing, AI_TIMING_FIRST_BYTE));
+	g_assert_cmpint(ai_timing_get_duration(timing, AI_TIMING_FIRST_TOKEN), ==, 0);
+	g_assert_cmpuint(ai_timing_get_request_bytes(timing), >, 0);
+	g_assert_cmpuint(ai_timing_get_response_bytes(timing), >=, strlen(claude_reply));
+}
+
+static void
+on_chat_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	GMainLoop *loop = user_data;
+	g_autoptr(AiResponse) response = NULL;
+	g_autoptr(GError) error = NULL;
+
+	response = ai_provider_chat_finish(AI_PROVIDER(source), result, &error);
+	g_assert_no_error(error);
+	assert_response_timing(response);
+
+	g_main_loop_quit(loop);
+}
+
+static void
+test_timing_chat_async(void)
+{
+	g_autoptr(SoupServer) server = soup_server_new(NULL);
+	g_autoptr(AiClaudeClient) client = create_client(server);
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+	g_autoptr(AiMessage) msg = ai_message_new_user("Hello");
+	GList messages = { NULL, NULL, NULL };
+
+	messages.data = msg;
+	ai_provider_chat_async(AI_PROVIDER(client), &messages, NULL, 64, NULL,
+	                       NULL, on_chat_done, loop);
+	g_main_loop_run(loop);
+}
+
+static void
+test_timing_chat_async_threaded(void)
+{
+	g_autoptr(SoupServer) server = soup_server_new(NULL);
+	g_autoptr(AiClaudeClient) client = create_client(server);
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+	g_autoptr(AiMessage) msg = ai_message_new_user("Hello");
+	GList messages = { NULL, NULL, NULL };
+
+	/* Every response is parsed in a worker thread; timing still arrives */
+	ai_config_set_parse_thread_threshold(ai_client_get_config(AI_CLIENT(client)), 1);
+
+	messages.data = msg;
+	ai_provider_chat_async(AI_PROVIDER(client), &messages, NULL, 64, NULL,
+	                       NULL, on_chat_done, loop);
+	g_main_loop_run(loop);
+}
+
+static void
+on_prewarm_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	GMainLoop *loop = user_data;
+	g_autoptr(AiTiming) timing = NULL;
+	g_autoptr(GError) error = NULL;
+
+	g_assert_true(ai_client_prewarm_finish(AI_CLIENT(source), result, &error));
+	g_assert_no_error(error);
+
+	timing = ai_client_get_timing(AI_CLIENT(source), result);
+	g_assert_nonnull(timing);
+	g_assert_cmpint(ai_timing_get_duration(timing, AI_TIMING_TOTAL), >, 0);
+	g_assert_cmpint(ai_timing_get_duration(timing, AI_TIMING_FIRST_BYTE), ==, 0);
+
+	g_main_loop_quit(loop);
+}
+
+static void
+on_warm_chat_done(
+	GObject      *source,
+	GAsyncResult *result,
+	gpointer      user_data
+){
+	GMainLoop *loop = user_data;
+	g_autoptr(AiResponse) response = NULL;
+	g_autoptr(GError) error = NULL;
+	AiTiming *timing;
+
+	response = ai_provider_chat_finish(AI_PROVIDER(source), result, &error);
+	g_assert_no_error(error);
+	assert_response_timing(response);
+
+	/* The request went out on the pre-warmed connection */
+	timing = ai_response_get_timing(response);
+	g_assert_cmpint(ai_timing_get_duration(timing, AI_TIMING_CONNECT), ==, 0);
+	g_assert_cmpint(ai_timing_get_duration(timing, AI_TIMING_TLS), ==, 0);
+
+	g_main_loop_quit(loop);
+}
+
+static void
+test_timing_prewarm(void)
+{
+	g_autoptr(SoupServer) server = soup_server_new(NULL);
+	g_autoptr(AiClaudeClient) client = create_client(server);
+	g_autoptr(GMainLoop) loop = g_main_loop_new(NULL, FALSE);
+	g_autoptr(AiMessage) msg = ai_message_new_user("Hello");
+	GList messages = { NULL, NULL, NULL };
+
+	ai_client_prewarm_async(AI_CLIENT(client), NULL, on_prewarm_done, loop);
+	g_main_loop_run(loop);
+
+	messages.data = msg;
+	ai_provider_chat_async(AI_PROVIDER(client), &messages, NULL, 64, NULL,
+	                       NULL, on_warm_chat_done, loop);
+	g_main_loop_run(loop);
+}
+
+typedef struct
+{
+	AiClient   *client;
+	AiResponse *response;
+	gint        done;
+} SyncData;
+
+static gpointer
+chat_sync_thread(gpointer user_data)
+{
+	SyncData *data = user_data;
+	g_autoptr(AiMessage) msg = ai_message_new_user("Hello");
+	GList messages = { NULL, NULL, NULL };
+
+	messages.data = msg;
+	data->response = ai_client_chat_sync(data->client, &messages, NULL, NULL);
+
+	g_atomic_int_set(&data->done, TRUE);
+	g_main_context_wakeup(NULL);
+
+	return NULL;
+}
+
+static void
+test_timing_chat_sync(void)
+{
+	g_autoptr(SoupServer) server = soup_server_new(NULL);
+	g_autoptr(AiClaudeClient) client = create_client(server);
+	SyncData data = { NULL, NULL, FALSE };
+	GThread *thread;
+
+	/* The server answers from this thread's main context */
+	data.client = AI_CLIENT(client);
+	thread = g_thread_new("chat-sync", chat_sync_thread, &data);
+	while (!g_atomic_int_get(&data.done))
+	{
+		g_main_context_iteration(NULL, TRUE);
+	}
+	g_thread_join(thread);
+
+	assert_response_timing(data.response);
+	g_object_unref(data.response);
+}
+
+int
+main(
+	int   argc,
+	char *argv[]
+){
+	g_test_init(&argc, &argv, NULL);
+
+	g_test_add_func("/ai-glib/timing/durations", test_timing_durations);
+	g_test_add_func("/ai-glib/timing/format-debug", test_timing_format_debug);
+	g_test_add_func("/ai-glib/timing/gtype", test_timing_gtype);
+	g_test_add_func("/ai-glib/timing/chat-async", test_timing_chat_async);
+	g_test_add_func("/ai-glib/timing/chat-async-threaded", test_timing_chat_async_threaded);
+	g_test_add_func("/ai-glib/timing/chat-sync", test_timing_chat_sync);
+	g_test_add_func("/ai-glib/timing/prewarm", test_timing_prewarm);
+
+	return g_test_run();
+}
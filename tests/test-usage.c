@@ -45,6 +45,28 @@ test_usage_copy(void)
 	g_assert_cmpint(ai_usage_get_output_tokens(copy), ==, 100);
 }
 
+static void
+test_usage_cache_tokens(void)
+{
+	g_autoptr(AiUsage) usage = NULL;
+	g_autoptr(AiUsage) copy = NULL;
+
+	usage = ai_usage_new(20, 50);
+	g_assert_cmpint(ai_usage_get_cache_creation_input_tokens(usage), ==, 0);
+	g_assert_cmpint(ai_usage_get_cache_read_input_tokens(usage), ==, 0);
+
+	ai_usage_set_cache_tokens(usage, 1500, 3000);
+	g_assert_cmpint(ai_usage_get_cache_creation_input_tokens(usage), ==, 1500);
+	g_assert_cmpint(ai_usage_get_cache_read_input_tokens(usage), ==, 3000);
+
+	/* Cache tokens are not part of the total */
+	g_assert_cmpint(ai_usage_get_total_tokens(usage), ==, 70);
+
+	copy = ai_usage_copy(usage);
+	g_assert_cmpint(ai_usage_get_cache_creation_input_tokens(copy), ==, 1500);
+	g_assert_cmpint(ai_usage_get_cache_read_input_tokens(copy), ==, 3000);
+}
+
 static void
 test_usage_gtype(void)
 {
@@ -65,6 +87,7 @@ main(
 	g_test_add_func("/ai-glib/usage/new", test_usage_new);
 	g_test_add_func("/ai-glib/usage/tokens", test_usage_tokens);
 	g_test_add_func("/ai-glib/usage/copy", test_usage_copy);
+	g_test_add_func("/ai-glib/usage/cache-tokens", test_usage_cache_tokens);
 	g_test_add_func("/ai-glib/usage/gtype", test_usage_gtype);
 
 	return g_test_run();